@@ -20,6 +20,7 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <cerrno>
 #include <cstdint>
 #include <cstring>
@@ -173,12 +174,18 @@ struct MMapRegion {
   uint64_t delta;
 };
 
-arrow::Result<MMapRegion> AlignAndMap(int fd, uint64_t offset, uint64_t length, int prot) {
+// page_size_bytes is the segment's page size when it is larger than the
+// system page (hugetlbfs); offsets and lengths are then rounded to it.
+arrow::Result<MMapRegion> AlignAndMap(int fd, uint64_t offset, uint64_t length, int prot, uint64_t page_size_bytes = 0) {
   const long     page_size      = sysconf(_SC_PAGESIZE);
-  const uint64_t page           = page_size <= 0 ? 4096 : static_cast<uint64_t>(page_size);
+  const uint64_t system_page    = page_size <= 0 ? 4096 : static_cast<uint64_t>(page_size);
+  const uint64_t page           = std::max(system_page, page_size_bytes);
   const uint64_t aligned_offset = (offset / page) * page;
   const uint64_t delta          = offset - aligned_offset;
-  const size_t   map_size       = static_cast<size_t>(delta + length);
+  size_t         map_size       = static_cast<size_t>(delta + length);
+  if (page > system_page) {
+    map_size = static_cast<size_t>((map_size + page - 1) / page * page);
+  }
 
   void* base = mmap(nullptr, map_size, prot, MAP_SHARED, fd, static_cast<off_t>(aligned_offset));
   if (base == MAP_FAILED) {
@@ -187,16 +194,16 @@ arrow::Result<MMapRegion> AlignAndMap(int fd, uint64_t offset, uint64_t length,
   return MMapRegion{base, map_size, delta};
 }
 
-arrow::Result<std::shared_ptr<arrow::Buffer>> MMapReadOnly(int fd, uint64_t offset, uint64_t length) {
+arrow::Result<std::shared_ptr<arrow::Buffer>> MMapReadOnly(int fd, uint64_t offset, uint64_t length, uint64_t page_size_bytes = 0) {
   if (length == 0) return std::make_shared<arrow::Buffer>(nullptr, 0);
-  ARROW_ASSIGN_OR_RAISE(auto r, AlignAndMap(fd, offset, length, PROT_READ));
+  ARROW_ASSIGN_OR_RAISE(auto r, AlignAndMap(fd, offset, length, PROT_READ, page_size_bytes));
   return std::make_shared<ReadOnlyMMapBuffer>(
       reinterpret_cast<const uint8_t*>(r.base) + r.delta, static_cast<int64_t>(length), r.base, r.map_size, fd);
 }
 
-arrow::Result<std::shared_ptr<arrow::MutableBuffer>> MMapMutable(int fd, uint64_t offset, uint64_t length) {
+arrow::Result<std::shared_ptr<arrow::MutableBuffer>> MMapMutable(int fd, uint64_t offset, uint64_t length, uint64_t page_size_bytes = 0) {
   if (length == 0) return std::make_shared<arrow::MutableBuffer>(nullptr, 0);
-  ARROW_ASSIGN_OR_RAISE(auto r, AlignAndMap(fd, offset, length, PROT_READ | PROT_WRITE));
+  ARROW_ASSIGN_OR_RAISE(auto r, AlignAndMap(fd, offset, length, PROT_READ | PROT_WRITE, page_size_bytes));
   return std::make_shared<MutableMMapBuffer>(
       reinterpret_cast<uint8_t*>(r.base) + r.delta, static_cast<int64_t>(length), r.base, r.map_size, fd);
 }
@@ -208,6 +215,15 @@ arrow::Result<int> OpenShm(std::string_view shm_name, bool writable) {
   return fd;
 }
 
+// Huge-page segments are hugetlbfs files named by file_path; everything
+// else is a POSIX shm segment.
+arrow::Result<int> OpenRamSegment(const payload::manager::v1::RamLocation& ram, bool writable) {
+  if (ram.file_path().empty()) return OpenShm(ram.shm_name(), writable);
+  int fd = open(ram.file_path().c_str(), writable ? O_RDWR : O_RDONLY);
+  if (fd < 0) return ErrnoToArrow("open", ram.file_path());
+  return fd;
+}
+
 #if PAYLOAD_CLIENT_ARROW_CUDA
 class MutableCudaIpcBuffer final : public arrow::MutableBuffer {
  public:
@@ -296,6 +312,12 @@ class PendingObjectRegistry {
     return result;
   }
 
+  bool Contains(const PayloadClient* client, const std::string& uuid_hex) {
+    std::lock_guard lock(mutex_);
+    const auto      client_it = registry_.find(client);
+    return client_it != registry_.end() && client_it->second.count(uuid_hex) > 0;
+  }
+
   // Discard all pending uploads for a destroyed/moved-from client.
   void DrainClient(const PayloadClient* client) {
     std::lock_guard lock(mutex_);
@@ -435,20 +457,61 @@ arrow::Result<PayloadClient::WritablePayload> PayloadClient::AllocateWritableBuf
   payload::manager::v1::AllocatePayloadResponse resp;
   auto                                          ctx = MakeContext();
   ARROW_RETURN_NOT_OK(GrpcToArrow(catalog_stub_->AllocatePayload(ctx.get(), req, &resp), "AllocatePayload"));
+  return OpenAllocation(resp.payload_descriptor(), resp.object_upload_path(), size_bytes);
+}
 
-  if (!resp.object_upload_path().empty()) {
+arrow::Result<PayloadClient::WritablePayload> PayloadClient::OpenAllocation(const payload::manager::v1::PayloadDescriptor& descriptor,
+                                                                            const std::string& object_upload_path, uint64_t size_bytes) const {
+  if (!object_upload_path.empty()) {
     // Object-tier: allocate a local heap buffer; the caller writes into it.
     // CommitPayload will upload bytes to object_upload_path then call ImportPayload.
     std::vector<uint8_t> data(size_bytes, 0);
     auto                 owned_buf = std::make_shared<VectorOwningMutableBuffer>(std::move(data));
-    const auto           uuid_hex  = UuidBytesToHex(resp.payload_descriptor().payload_id().value());
-    PendingObjectRegistry::Instance().Insert(this, uuid_hex, PendingObjectUpload{resp.object_upload_path(), owned_buf});
-    return WritablePayload{resp.payload_descriptor(), std::move(owned_buf)};
+    const auto           uuid_hex  = UuidBytesToHex(descriptor.payload_id().value());
+    PendingObjectRegistry::Instance().Insert(this, uuid_hex, PendingObjectUpload{object_upload_path, owned_buf});
+    return WritablePayload{descriptor, std::move(owned_buf)};
   }
 
-  ARROW_RETURN_NOT_OK(ValidateHasLocation(resp.payload_descriptor()));
-  ARROW_ASSIGN_OR_RAISE(auto buffer, OpenMutableBuffer(resp.payload_descriptor()));
-  return WritablePayload{resp.payload_descriptor(), std::move(buffer)};
+  ARROW_RETURN_NOT_OK(ValidateHasLocation(descriptor));
+  ARROW_ASSIGN_OR_RAISE(auto buffer, OpenMutableBuffer(descriptor));
+  return WritablePayload{descriptor, std::move(buffer)};
+}
+
+arrow::Result<std::vector<arrow::Result<PayloadClient::WritablePayload>>> PayloadClient::AllocateWritableBuffers(
+    const std::vector<uint64_t>& sizes_bytes, payload::manager::v1::Tier preferred_tier, uint64_t ttl_ms, bool no_evict) const {
+  payload::manager::v1::AllocatePayloadsRequest req;
+  for (const auto size_bytes : sizes_bytes) {
+    auto* item = req.add_items();
+    item->set_size_bytes(size_bytes);
+    item->set_preferred_tier(preferred_tier);
+    item->set_ttl_ms(ttl_ms);
+    item->set_no_evict(no_evict);
+  }
+
+  ARROW_ASSIGN_OR_RAISE(auto resp, AllocatePayloads(req));
+  if (resp.results_size() != static_cast<int>(sizes_bytes.size())) {
+    return arrow::Status::IOError("AllocatePayloads: expected ", sizes_bytes.size(), " results, got ", resp.results_size());
+  }
+
+  std::vector<arrow::Result<WritablePayload>> out;
+  out.reserve(sizes_bytes.size());
+  for (int i = 0; i < resp.results_size(); ++i) {
+    const auto& result = resp.results(i);
+    if (!result.ok()) {
+      out.emplace_back(arrow::Status::IOError("AllocatePayloads: ", result.error_message()));
+      continue;
+    }
+    out.push_back(OpenAllocation(result.payload_descriptor(), result.object_upload_path(), sizes_bytes[static_cast<std::size_t>(i)]));
+  }
+  return out;
+}
+
+arrow::Result<payload::manager::v1::AllocatePayloadsResponse> PayloadClient::AllocatePayloads(
+    const payload::manager::v1::AllocatePayloadsRequest& request) const {
+  payload::manager::v1::AllocatePayloadsResponse response;
+  auto                                           ctx = MakeContext();
+  ARROW_RETURN_NOT_OK(GrpcToArrow(catalog_stub_->AllocatePayloads(ctx.get(), request, &response), "AllocatePayloads"));
+  return response;
 }
 
 arrow::Result<payload::manager::v1::PayloadID> PayloadClient::PayloadIdFromUuid(std::string_view uuid) {
@@ -461,6 +524,14 @@ arrow::Status PayloadClient::ValidatePayloadId(const payload::manager::v1::Paylo
   return ValidatePayloadIdValue(payload_id);
 }
 
+arrow::Status PayloadClient::ValidateUncompressed(const payload::manager::v1::PayloadDescriptor& descriptor) {
+  if (!descriptor.has_disk()) return arrow::Status::OK();
+  const auto codec = descriptor.disk().codec();
+  if (codec == payload::manager::v1::PAYLOAD_CODEC_UNSPECIFIED || codec == payload::manager::v1::PAYLOAD_CODEC_NONE) return arrow::Status::OK();
+  return arrow::Status::NotImplemented("payload is compressed (", payload::manager::v1::PayloadCodec_Name(codec),
+                                       "); promote to RAM to map it");
+}
+
 arrow::Status PayloadClient::CommitPayload(const payload::manager::v1::PayloadID& payload_id) const {
   ARROW_RETURN_NOT_OK(ValidatePayloadIdValue(payload_id));
 
@@ -496,6 +567,42 @@ arrow::Status PayloadClient::CommitPayload(const payload::manager::v1::PayloadID
   return GrpcToArrow(catalog_stub_->CommitPayload(ctx.get(), req, &resp), "CommitPayload");
 }
 
+arrow::Result<std::vector<arrow::Status>> PayloadClient::CommitPayloads(const std::vector<payload::manager::v1::PayloadID>& payload_ids) const {
+  std::vector<arrow::Status> statuses(payload_ids.size());
+
+  // Ids sent in the batch RPC and their positions in payload_ids.
+  payload::manager::v1::CommitPayloadsRequest req;
+  std::vector<std::size_t>                    batched;
+  for (std::size_t i = 0; i < payload_ids.size(); ++i) {
+    const auto& payload_id = payload_ids[i];
+    statuses[i]            = ValidatePayloadIdValue(payload_id);
+    if (!statuses[i].ok()) continue;
+    if (PendingObjectRegistry::Instance().Contains(this, UuidBytesToHex(payload_id.value()))) {
+      statuses[i] = CommitPayload(payload_id);
+      continue;
+    }
+    *req.add_ids() = payload_id;
+    batched.push_back(i);
+  }
+  if (batched.empty()) {
+    return statuses;
+  }
+
+  payload::manager::v1::CommitPayloadsResponse resp;
+  auto                                         ctx = MakeContext();
+  ARROW_RETURN_NOT_OK(GrpcToArrow(catalog_stub_->CommitPayloads(ctx.get(), req, &resp), "CommitPayloads"));
+  if (resp.results_size() != static_cast<int>(batched.size())) {
+    return arrow::Status::IOError("CommitPayloads: expected ", batched.size(), " results, got ", resp.results_size());
+  }
+  for (int j = 0; j < resp.results_size(); ++j) {
+    const auto& result = resp.results(j);
+    if (!result.ok()) {
+      statuses[batched[static_cast<std::size_t>(j)]] = arrow::Status::IOError("CommitPayloads: ", result.error_message());
+    }
+  }
+  return statuses;
+}
+
 arrow::Result<payload::manager::v1::ResolveSnapshotResponse> PayloadClient::Resolve(const payload::manager::v1::PayloadID& payload_id) const {
   payload::manager::v1::ResolveSnapshotRequest request;
   ARROW_RETURN_NOT_OK(ValidatePayloadIdValue(payload_id));
@@ -537,6 +644,74 @@ arrow::Status PayloadClient::Release(const payload::manager::v1::LeaseID& lease_
   return GrpcToArrow(data_stub_->ReleaseLease(ctx.get(), req, &resp), "ReleaseLease");
 }
 
+arrow::Result<payload::manager::v1::ResolveSnapshotsResponse> PayloadClient::ResolveSnapshots(
+    const std::vector<payload::manager::v1::PayloadID>& payload_ids) const {
+  payload::manager::v1::ResolveSnapshotsRequest request;
+  for (const auto& payload_id : payload_ids) {
+    ARROW_RETURN_NOT_OK(ValidatePayloadIdValue(payload_id));
+    *request.add_ids() = payload_id;
+  }
+
+  payload::manager::v1::ResolveSnapshotsResponse response;
+  auto                                           ctx = MakeContext();
+  ARROW_RETURN_NOT_OK(GrpcToArrow(data_stub_->ResolveSnapshots(ctx.get(), request, &response), "ResolveSnapshots"));
+  return response;
+}
+
+arrow::Result<std::vector<arrow::Result<PayloadClient::ReadablePayload>>> PayloadClient::AcquireReadableBuffers(
+    const std::vector<payload::manager::v1::PayloadID>& payload_ids, payload::manager::v1::Tier min_tier,
+    payload::manager::v1::PromotionPolicy promotion_policy, uint64_t min_lease_duration_ms) const {
+  payload::manager::v1::AcquireReadLeasesRequest req;
+  for (const auto& payload_id : payload_ids) {
+    ARROW_RETURN_NOT_OK(ValidatePayloadIdValue(payload_id));
+    auto* item          = req.add_items();
+    *item->mutable_id() = payload_id;
+    item->set_min_tier(min_tier);
+    item->set_promotion_policy(promotion_policy);
+    item->set_min_lease_duration_ms(min_lease_duration_ms);
+    item->set_mode(payload::manager::v1::LEASE_MODE_READ);
+  }
+
+  payload::manager::v1::AcquireReadLeasesResponse resp;
+  auto                                            ctx = MakeContext();
+  ARROW_RETURN_NOT_OK(GrpcToArrow(data_stub_->AcquireReadLeases(ctx.get(), req, &resp), "AcquireReadLeases"));
+  if (resp.results_size() != static_cast<int>(payload_ids.size())) {
+    return arrow::Status::IOError("AcquireReadLeases: expected ", payload_ids.size(), " results, got ", resp.results_size());
+  }
+
+  std::vector<arrow::Result<ReadablePayload>> out;
+  out.reserve(payload_ids.size());
+  for (const auto& result : resp.results()) {
+    if (!result.ok()) {
+      out.emplace_back(arrow::Status::IOError("AcquireReadLeases: ", result.error_message()));
+      continue;
+    }
+    const auto& lease  = result.lease();
+    auto        opened = [&]() -> arrow::Result<ReadablePayload> {
+      ARROW_RETURN_NOT_OK(ValidateHasLocation(lease.payload_descriptor()));
+      ARROW_ASSIGN_OR_RAISE(auto buffer, OpenReadableBuffer(lease.payload_descriptor()));
+      return ReadablePayload{lease.payload_descriptor(), lease.lease_id(), std::move(buffer)};
+    }();
+    if (!opened.ok()) {
+      // The caller never sees this lease; do not leave it pinning the payload.
+      (void)Release(lease.lease_id());
+    }
+    out.push_back(std::move(opened));
+  }
+  return out;
+}
+
+arrow::Status PayloadClient::ReleaseLeases(const std::vector<payload::manager::v1::LeaseID>& lease_ids) const {
+  payload::manager::v1::ReleaseLeasesRequest req;
+  for (const auto& lease_id : lease_ids) {
+    *req.add_lease_ids() = lease_id;
+  }
+
+  google::protobuf::Empty resp;
+  auto                    ctx = MakeContext();
+  return GrpcToArrow(data_stub_->ReleaseLeases(ctx.get(), req, &resp), "ReleaseLeases");
+}
+
 arrow::Result<payload::manager::v1::PromoteResponse> PayloadClient::Promote(const payload::manager::v1::PromoteRequest& request) const {
   payload::manager::v1::PromoteResponse response;
   auto                                  ctx = MakeContext();
@@ -675,6 +850,7 @@ arrow::Result<payload::manager::v1::GetRangeResponse> PayloadClient::GetRange(co
 arrow::Result<std::shared_ptr<arrow::MutableBuffer>> PayloadClient::OpenMutableBuffer(
     const payload::manager::v1::PayloadDescriptor& descriptor) const {
   ARROW_ASSIGN_OR_RAISE(auto length, DescriptorLengthBytes(descriptor));
+  ARROW_RETURN_NOT_OK(ValidateUncompressed(descriptor));
 
   if (descriptor.has_gpu()) {
 #if PAYLOAD_CLIENT_ARROW_CUDA
@@ -687,11 +863,16 @@ arrow::Result<std::shared_ptr<arrow::MutableBuffer>> PayloadClient::OpenMutableB
   }
 
   if (descriptor.has_ram()) {
-    ARROW_ASSIGN_OR_RAISE(int fd, OpenShm(descriptor.ram().shm_name(), true));
+    const auto& ram = descriptor.ram();
+    ARROW_ASSIGN_OR_RAISE(int fd, OpenRamSegment(ram, true));
+    // Slab arenas are shared and already sized; map just this payload's block.
+    if (ram.slab_id() != 0) return MMapMutable(fd, ram.offset_bytes(), length);
+    // hugetlbfs segments are sized in whole huge pages by the service.
+    if (!ram.file_path().empty()) return MMapMutable(fd, 0, length, ram.page_size_bytes());
     // The service creates the shm segment but defers sizing to the first writer.
     if (ftruncate(fd, static_cast<off_t>(length)) != 0) {
       close(fd);
-      return ErrnoToArrow("ftruncate", descriptor.ram().shm_name());
+      return ErrnoToArrow("ftruncate", ram.shm_name());
     }
     return MMapMutable(fd, 0, length);
   }
@@ -714,6 +895,7 @@ arrow::Result<std::shared_ptr<arrow::MutableBuffer>> PayloadClient::OpenMutableB
 
 arrow::Result<std::shared_ptr<arrow::Buffer>> PayloadClient::OpenReadableBuffer(const payload::manager::v1::PayloadDescriptor& descriptor) const {
   ARROW_ASSIGN_OR_RAISE(auto length, DescriptorLengthBytes(descriptor));
+  ARROW_RETURN_NOT_OK(ValidateUncompressed(descriptor));
 
   if (descriptor.has_gpu()) {
 #if PAYLOAD_CLIENT_ARROW_CUDA
@@ -726,8 +908,9 @@ arrow::Result<std::shared_ptr<arrow::Buffer>> PayloadClient::OpenReadableBuffer(
   }
 
   if (descriptor.has_ram()) {
-    ARROW_ASSIGN_OR_RAISE(int fd, OpenShm(descriptor.ram().shm_name(), false));
-    return MMapReadOnly(fd, 0, length);
+    const auto& ram = descriptor.ram();
+    ARROW_ASSIGN_OR_RAISE(int fd, OpenRamSegment(ram, false));
+    return MMapReadOnly(fd, ram.offset_bytes(), length, ram.page_size_bytes());
   }
 
   if (descriptor.has_disk()) {
@@ -12,6 +12,7 @@
 #include <memory>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include "payload/manager/services/v1/payload_admin_service.grpc.pb.h"
 #include "payload/manager/services/v1/payload_catalog_service.grpc.pb.h"
@@ -85,10 +86,30 @@ class PayloadClient {
   static arrow::Result<payload::manager::v1::PayloadID> PayloadIdFromUuid(std::string_view uuid);
   /// Validate that a PayloadID contains a 16-byte UUID payload.
   static arrow::Status ValidatePayloadId(const payload::manager::v1::PayloadID& payload_id);
+  /// Reject a DISK / OBJECT location that holds a compressed copy (codec other
+  /// than NONE or UNSPECIFIED): its bytes are a codec frame, not the payload.
+  static arrow::Status ValidateUncompressed(const payload::manager::v1::PayloadDescriptor& descriptor);
 
   /// Mark a previously allocated payload as committed.
   arrow::Status CommitPayload(const payload::manager::v1::PayloadID& payload_id) const;
 
+  /// Allocate one payload per entry of sizes_bytes in a single AllocatePayloads
+  /// RPC and open a writable Arrow buffer for each. The outer Result fails only
+  /// if the RPC itself fails; element i reports the outcome for sizes_bytes[i].
+  arrow::Result<std::vector<arrow::Result<WritablePayload>>> AllocateWritableBuffers(
+      const std::vector<uint64_t>& sizes_bytes, payload::manager::v1::Tier preferred_tier = payload::manager::v1::TIER_RAM,
+      uint64_t ttl_ms = 0, bool no_evict = false) const;
+
+  /// Commit several payloads with one CommitPayloads RPC. Object-tier payloads
+  /// allocated by this client still upload and import individually, as in
+  /// CommitPayload(). The outer Result fails only if the batch RPC itself
+  /// fails; element i reports the outcome for payload_ids[i].
+  arrow::Result<std::vector<arrow::Status>> CommitPayloads(const std::vector<payload::manager::v1::PayloadID>& payload_ids) const;
+
+  /// Raw batch allocate: one repository transaction, per-item results.
+  arrow::Result<payload::manager::v1::AllocatePayloadsResponse> AllocatePayloads(
+      const payload::manager::v1::AllocatePayloadsRequest& request) const;
+
   /// Resolve payload metadata for a committed payload.
   arrow::Result<payload::manager::v1::ResolveSnapshotResponse> Resolve(const payload::manager::v1::PayloadID& payload_id) const;
 
@@ -102,6 +123,22 @@ class PayloadClient {
   /// Release a previously acquired read lease.
   arrow::Status Release(const payload::manager::v1::LeaseID& lease_id) const;
 
+  /// Resolve several payloads with one ResolveSnapshots RPC; results are per id.
+  arrow::Result<payload::manager::v1::ResolveSnapshotsResponse> ResolveSnapshots(
+      const std::vector<payload::manager::v1::PayloadID>& payload_ids) const;
+
+  /// Acquire read leases on several payloads with one AcquireReadLeases RPC and
+  /// open a readable buffer for each. The outer Result fails only if the RPC
+  /// itself fails; element i reports the outcome for payload_ids[i].
+  arrow::Result<std::vector<arrow::Result<ReadablePayload>>> AcquireReadableBuffers(
+      const std::vector<payload::manager::v1::PayloadID>& payload_ids,
+      payload::manager::v1::Tier                          min_tier              = payload::manager::v1::TIER_RAM,
+      payload::manager::v1::PromotionPolicy               promotion_policy      = payload::manager::v1::PROMOTION_POLICY_BEST_EFFORT,
+      uint64_t                                            min_lease_duration_ms = 0) const;
+
+  /// Release several leases with one ReleaseLeases RPC. Idempotent.
+  arrow::Status ReleaseLeases(const std::vector<payload::manager::v1::LeaseID>& lease_ids) const;
+
   /// Request promotion to a higher tier.
   arrow::Result<payload::manager::v1::PromoteResponse> Promote(const payload::manager::v1::PromoteRequest& request) const;
 
@@ -169,6 +206,12 @@ class PayloadClient {
   /// Create a ClientContext with optional deadline and injected trace context.
   std::unique_ptr<grpc::ClientContext> MakeContext() const;
 
+  /// Open the writable buffer for a freshly allocated payload. Object-tier
+  /// payloads (non-empty object_upload_path) get a local heap buffer that
+  /// CommitPayload() uploads.
+  arrow::Result<WritablePayload> OpenAllocation(const payload::manager::v1::PayloadDescriptor& descriptor, const std::string& object_upload_path,
+                                                uint64_t size_bytes) const;
+
   /// Open a mutable Arrow buffer from a descriptor location.
   arrow::Result<std::shared_ptr<arrow::MutableBuffer>> OpenMutableBuffer(const payload::manager::v1::PayloadDescriptor& descriptor) const;
   /// Open a read-only Arrow buffer from a descriptor location.
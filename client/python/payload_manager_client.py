@@ -322,6 +322,7 @@ class PayloadClient:
 
     def _OpenMutableBuffer(self, descriptor: placement_pb2.PayloadDescriptor) -> tuple[mmap.mmap, pa.Buffer]:
         length = _descriptor_length_bytes(descriptor)
+        _require_uncompressed(descriptor)
 
         if descriptor.HasField("gpu"):
             gpu_array = _OpenMutableGpuBuffer(descriptor)
@@ -329,9 +330,14 @@ class PayloadClient:
             return None, gpu_array  # type: ignore[return-value]
 
         if descriptor.HasField("ram"):
-            path = _shm_path(descriptor.ram.shm_name)
-            fd = os.open(path, os.O_RDWR)
+            fd = os.open(_ram_path(descriptor.ram), os.O_RDWR)
             try:
+                if descriptor.ram.slab_id:
+                    # Slab arenas are shared and already sized; map just this payload's block.
+                    return _map_slab_block(fd, descriptor.ram, length, mmap.ACCESS_WRITE)
+                if getattr(descriptor.ram, "file_path", ""):
+                    # hugetlbfs segments are sized in whole huge pages by the service.
+                    return _map_huge_segment(fd, descriptor.ram, length, mmap.ACCESS_WRITE)
                 os.ftruncate(fd, length)
                 mapped = mmap.mmap(fd, length, access=mmap.ACCESS_WRITE)
             finally:
@@ -348,15 +354,9 @@ class PayloadClient:
             try:
                 end = descriptor.disk.offset_bytes + length
                 os.ftruncate(fd, end)
-                mapped = mmap.mmap(
-                    fd,
-                    length,
-                    access=mmap.ACCESS_WRITE,
-                    offset=descriptor.disk.offset_bytes,
-                )
+                return _map_span(fd, descriptor.disk.offset_bytes, length, mmap.ACCESS_WRITE)
             finally:
                 os.close(fd)
-            return mapped, pa.py_buffer(mapped)
 
         raise NotImplementedError(
             f"Writable Arrow buffer for tier {types_pb2.Tier.Name(descriptor.tier)} is not supported"
@@ -364,14 +364,19 @@ class PayloadClient:
 
     def _OpenReadableBuffer(self, descriptor: placement_pb2.PayloadDescriptor) -> tuple[mmap.mmap, pa.Buffer]:
         length = _descriptor_length_bytes(descriptor)
+        _require_uncompressed(descriptor)
 
         if descriptor.HasField("gpu"):
             gpu_array = _OpenReadableGpuBuffer(descriptor)
             return None, gpu_array  # type: ignore[return-value]
 
         if descriptor.HasField("ram"):
-            fd = os.open(_shm_path(descriptor.ram.shm_name), os.O_RDONLY)
+            fd = os.open(_ram_path(descriptor.ram), os.O_RDONLY)
             try:
+                if descriptor.ram.slab_id:
+                    return _map_slab_block(fd, descriptor.ram, length, mmap.ACCESS_READ)
+                if getattr(descriptor.ram, "file_path", ""):
+                    return _map_huge_segment(fd, descriptor.ram, length, mmap.ACCESS_READ)
                 mapped = mmap.mmap(fd, length, access=mmap.ACCESS_READ)
             finally:
                 os.close(fd)
@@ -382,15 +387,10 @@ class PayloadClient:
                 return None, _ReadObjectBuffer(descriptor)
             fd = os.open(descriptor.disk.path, os.O_RDONLY)
             try:
-                mapped = mmap.mmap(
-                    fd,
-                    length,
-                    access=mmap.ACCESS_READ,
-                    offset=descriptor.disk.offset_bytes,
-                )
+                # Packed payloads sit at an arbitrary offset inside a segment file.
+                return _map_span(fd, descriptor.disk.offset_bytes, length, mmap.ACCESS_READ)
             finally:
                 os.close(fd)
-            return mapped, pa.py_buffer(mapped)
 
         raise NotImplementedError(
             f"Readable Arrow buffer for tier {types_pb2.Tier.Name(descriptor.tier)} is not supported"
@@ -419,6 +419,15 @@ def _descriptor_length_bytes(descriptor: placement_pb2.PayloadDescriptor) -> int
     return 0
 
 
+def _require_uncompressed(descriptor: placement_pb2.PayloadDescriptor) -> None:
+    """A compressed DISK / OBJECT copy holds a codec frame, not the payload bytes."""
+    if not descriptor.HasField("disk"):
+        return
+    codec = descriptor.disk.codec
+    if codec not in (types_pb2.PAYLOAD_CODEC_UNSPECIFIED, types_pb2.PAYLOAD_CODEC_NONE):
+        raise NotImplementedError(f"payload is compressed ({types_pb2.PayloadCodec.Name(codec)}); promote to RAM to map it")
+
+
 def payload_id_from_uuid(value: PayloadIdLike) -> id_pb2.PayloadID:
     payload_id = id_pb2.PayloadID(value=_uuid_bytes(value))
     return validate_payload_id(payload_id)
@@ -449,6 +458,31 @@ def _shm_path(shm_name: str) -> str:
     return os.path.join("/dev/shm", cleaned)
 
 
+def _ram_path(ram: placement_pb2.RamLocation) -> str:
+    """hugetlbfs file of a huge-page segment, else the POSIX shm path."""
+    return getattr(ram, "file_path", "") or _shm_path(ram.shm_name)
+
+
+def _map_huge_segment(fd: int, ram: placement_pb2.RamLocation, length: int, access: int) -> tuple[mmap.mmap, pa.Buffer]:
+    """Map a hugetlbfs segment; mapping lengths must be whole huge pages."""
+    page = max(ram.page_size_bytes, mmap.PAGESIZE)
+    mapped = mmap.mmap(fd, (length + page - 1) // page * page, access=access)
+    return mapped, pa.py_buffer(mapped).slice(0, length)
+
+
+def _map_slab_block(fd: int, ram: placement_pb2.RamLocation, length: int, access: int) -> tuple[mmap.mmap, pa.Buffer]:
+    """Map the page-aligned span of a slab arena holding one payload's block."""
+    return _map_span(fd, ram.offset_bytes, length, access)
+
+
+def _map_span(fd: int, offset: int, length: int, access: int) -> tuple[mmap.mmap, pa.Buffer]:
+    """Map length bytes at offset; mmap offsets must be multiples of the allocation granularity."""
+    aligned = offset - offset % mmap.ALLOCATIONGRANULARITY
+    delta = offset - aligned
+    mapped = mmap.mmap(fd, delta + length, access=access, offset=aligned)
+    return mapped, pa.py_buffer(mapped).slice(delta, length)
+
+
 def _OpenMutableGpuBuffer(descriptor: placement_pb2.PayloadDescriptor):
     """Open a writable GPU buffer from a descriptor containing a CUDA IPC handle.
 
@@ -403,6 +403,11 @@ int main(int argc, char** argv) {
     std::cout << "disk=" << resp.payloads_disk() << "\n";
     std::cout << "gpu=" << resp.payloads_gpu() << "\n";
     std::cout << "object=" << resp.payloads_object() << "\n";
+    for (const auto& device : resp.disk_devices()) {
+      std::cout << "disk_device=" << device.name() << " used=" << device.used_bytes() << " free=" << device.free_bytes()
+                << " capacity=" << device.capacity_bytes() << " queue=" << device.queue_depth() << " read=" << device.read_bytes()
+                << " written=" << device.written_bytes() << "\n";
+    }
     return 0;
   }
 
@@ -0,0 +1,207 @@
+#include "payload_control_block.hpp"
+
+#include <algorithm>
+#include <mutex>
+
+namespace payload::core {
+
+void PayloadLockWord::lock() {
+  uint32_t v = word_.load(std::memory_order_relaxed);
+  for (;;) {
+    if ((v & (kWriter | kReaderMask)) == 0) {
+      // Free (possibly with waiters flagged): take it, keeping the shared-waiter
+      // bit so our unlock() still wakes them. Other exclusive waiters re-flag
+      // themselves when they next observe the word.
+      if (word_.compare_exchange_weak(v, kWriter | (v & kReaderWaiting), std::memory_order_acquire, std::memory_order_relaxed)) {
+        return;
+      }
+      continue;
+    }
+    if ((v & kWriterWaiting) == 0) {
+      if (!word_.compare_exchange_weak(v, v | kWriterWaiting, std::memory_order_relaxed)) {
+        continue;
+      }
+      v |= kWriterWaiting;
+    }
+    word_.wait(v, std::memory_order_relaxed);
+    v = word_.load(std::memory_order_relaxed);
+  }
+}
+
+bool PayloadLockWord::try_lock() {
+  uint32_t v = word_.load(std::memory_order_relaxed);
+  if ((v & (kWriter | kReaderMask)) != 0) {
+    return false;
+  }
+  return word_.compare_exchange_strong(v, kWriter | (v & kReaderWaiting), std::memory_order_acquire, std::memory_order_relaxed);
+}
+
+void PayloadLockWord::unlock() {
+  const uint32_t prev = word_.exchange(0, std::memory_order_release);
+  if ((prev & (kWriterWaiting | kReaderWaiting)) != 0) {
+    word_.notify_all();
+  }
+}
+
+void PayloadLockWord::lock_shared() {
+  uint32_t v = word_.load(std::memory_order_relaxed);
+  for (;;) {
+    if ((v & (kWriter | kWriterWaiting)) == 0) {
+      if (word_.compare_exchange_weak(v, v + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+        return;
+      }
+      continue;
+    }
+    if ((v & kReaderWaiting) == 0) {
+      if (!word_.compare_exchange_weak(v, v | kReaderWaiting, std::memory_order_relaxed)) {
+        continue;
+      }
+      v |= kReaderWaiting;
+    }
+    word_.wait(v, std::memory_order_relaxed);
+    v = word_.load(std::memory_order_relaxed);
+  }
+}
+
+bool PayloadLockWord::try_lock_shared() {
+  uint32_t v = word_.load(std::memory_order_relaxed);
+  if ((v & (kWriter | kWriterWaiting)) != 0) {
+    return false;
+  }
+  return word_.compare_exchange_strong(v, v + 1, std::memory_order_acquire, std::memory_order_relaxed);
+}
+
+void PayloadLockWord::unlock_shared() {
+  const uint32_t prev = word_.fetch_sub(1, std::memory_order_release);
+  // Last reader out hands the word to a waiting writer.
+  if ((prev & kReaderMask) == 1 && (prev & kWriterWaiting) != 0) {
+    word_.notify_all();
+  }
+}
+
+PayloadControlTable::Ref::Ref(Ref&& other) noexcept : table_(other.table_), slot_(other.slot_) {
+  other.table_ = nullptr;
+  other.slot_  = nullptr;
+}
+
+PayloadControlTable::Ref& PayloadControlTable::Ref::operator=(Ref&& other) noexcept {
+  if (this != &other) {
+    if (slot_) {
+      table_->Release(slot_);
+    }
+    table_       = other.table_;
+    slot_        = other.slot_;
+    other.table_ = nullptr;
+    other.slot_  = nullptr;
+  }
+  return *this;
+}
+
+PayloadControlTable::Ref::~Ref() {
+  if (slot_) {
+    table_->Release(slot_);
+  }
+}
+
+PayloadControlTable::PayloadControlTable()  = default;
+PayloadControlTable::~PayloadControlTable() = default;
+
+std::size_t PayloadControlTable::ShardIndex(const payload::util::UUID& key) {
+  return std::hash<payload::util::UUID>{}(key) % kShardCount;
+}
+
+PayloadControlTable::Ref PayloadControlTable::Acquire(const payload::util::UUID& key) {
+  auto&            shard = shards_[ShardIndex(key)];
+  std::unique_lock lock(shard.mutex);
+  auto             it = shard.index.find(key);
+  if (it == shard.index.end()) {
+    it = shard.index.emplace(key, AllocateLocked(shard, key)).first;
+  }
+  ++it->second->block.refs;
+  return Ref(this, it->second);
+}
+
+void PayloadControlTable::Release(Slot* slot) {
+  auto&            shard = shards_[ShardIndex(slot->block.id)];
+  std::unique_lock lock(shard.mutex);
+  --slot->block.refs;
+  const auto it = shard.index.find(slot->block.id);
+  if (it != shard.index.end()) {
+    ReclaimIfUnusedLocked(shard, it);
+  }
+}
+
+PayloadControlTable::Slot* PayloadControlTable::AllocateLocked(Shard& shard, const payload::util::UUID& key) {
+  if (shard.free_blocks.empty()) {
+    const auto chunk_size = ChunkSize(shard.capacity);
+    shard.chunks.emplace_back(new Slot[chunk_size]);
+    auto* chunk = shard.chunks.back().get();
+    shard.free_blocks.reserve(shard.free_blocks.size() + chunk_size);
+    for (std::size_t i = chunk_size; i > 0; --i) {
+      shard.free_blocks.push_back(&chunk[i - 1]);
+    }
+    shard.capacity += chunk_size;
+  }
+
+  auto* slot = shard.free_blocks.back();
+  shard.free_blocks.pop_back();
+  slot->block.id = key;
+  return slot;
+}
+
+PayloadControlTable::Index::iterator PayloadControlTable::ReclaimIfUnusedLocked(Shard& shard, Index::iterator it) {
+  auto* block = &it->second->block;
+  if (block->refs != 0 || block->tombstones != 0 || (block->flags & PayloadControlBlock::kHasSnapshot) != 0) {
+    return std::next(it);
+  }
+
+  // No Ref is outstanding, so nobody holds (or is waiting on) the lock word.
+  block->version           = 0;
+  block->length_bytes      = 0;
+  block->pin_expires_at_ms = 0;
+  block->last_access.store(0, std::memory_order_relaxed);
+  block->tier         = 0;
+  block->state        = 0;
+  block->spill_target = 0;
+  block->codec        = 0;
+  block->flags        = 0;
+  it->second->location = PayloadLocationBlock{};
+  shard.free_blocks.push_back(it->second);
+  return shard.index.erase(it);
+}
+
+std::size_t PayloadControlTable::Size() const {
+  std::size_t total = 0;
+  for (const auto& shard : shards_) {
+    std::shared_lock lock(shard.mutex);
+    total += shard.index.size();
+  }
+  return total;
+}
+
+std::size_t PayloadControlTable::Capacity() const {
+  std::size_t total = 0;
+  for (const auto& shard : shards_) {
+    std::shared_lock lock(shard.mutex);
+    total += shard.capacity;
+  }
+  return total;
+}
+
+std::size_t PayloadControlTable::MemoryBytes() const {
+  // Index nodes hold the key/value pair, the next pointer and the cached hash.
+  constexpr std::size_t kIndexNodeBytes = sizeof(void*) + sizeof(Index::value_type) + sizeof(std::size_t);
+
+  std::size_t total = sizeof(*this);
+  for (const auto& shard : shards_) {
+    std::shared_lock lock(shard.mutex);
+    total += shard.capacity * sizeof(Slot);
+    total += shard.chunks.capacity() * sizeof(shard.chunks[0]);
+    total += shard.free_blocks.capacity() * sizeof(Slot*);
+    total += shard.index.bucket_count() * sizeof(void*);
+    total += shard.index.size() * kIndexNodeBytes;
+  }
+  return total;
+}
+
+} // namespace payload::core
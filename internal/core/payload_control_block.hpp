@@ -0,0 +1,333 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "internal/util/uuid.hpp"
+
+namespace payload::manager::core::v1 {
+class DiskLocation;
+} // namespace payload::manager::core::v1
+
+namespace payload::core {
+
+/*
+  Reader/writer lock packed into a single 32-bit word.
+
+    bit 31      exclusive holder
+    bit 30      exclusive waiter (blocks new shared holders so writers
+                are not starved by a steady stream of readers)
+    bit 29      shared waiter (tells unlock() it has someone to wake)
+    bits 0..28  shared holder count
+
+  Waiters park on the word with C++20 atomic wait/notify (a futex on
+  Linux), so an uncontended lock costs one CAS and no syscalls. Satisfies
+  Lockable and SharedLockable, so std::unique_lock / std::shared_lock work.
+*/
+class PayloadLockWord {
+ public:
+  void lock();
+  bool try_lock();
+  void unlock();
+
+  void lock_shared();
+  bool try_lock_shared();
+  void unlock_shared();
+
+ private:
+  static constexpr uint32_t kWriter        = 1u << 31;
+  static constexpr uint32_t kWriterWaiting = 1u << 30;
+  static constexpr uint32_t kReaderWaiting = 1u << 29;
+  static constexpr uint32_t kReaderMask    = kReaderWaiting - 1;
+
+  std::atomic<uint32_t> word_{0};
+};
+
+/*
+  Per-payload control block: everything PayloadManager needs on the request
+  path, in one cache line. Descriptors are rebuilt from these fields on
+  demand rather than cached as protobufs.
+
+  Field ownership:
+    lock          per-payload lock word (replaces the shared_mutex table)
+    refs          outstanding PayloadControlTable::Ref handles; guarded by
+                  the owning shard's mutex
+    last_access   recency sequence for LRU victim selection; atomic so a
+                  touch only needs the shard's shared lock
+    everything else is written under the shard's exclusive lock and read
+    under its shared lock.
+*/
+struct alignas(64) PayloadControlBlock {
+  static constexpr uint8_t kHasSnapshot = 1u << 0; // tier/state/version/location are valid
+  static constexpr uint8_t kHasLocation = 1u << 1; // descriptor carries a location
+  static constexpr uint8_t kNoEvict     = 1u << 2; // never chosen as an eviction victim
+  static constexpr uint8_t kPinned      = 1u << 3; // pinned until pin_expires_at_ms (0 = indefinitely)
+  static constexpr uint8_t kSharedBlob  = 1u << 4; // location is a content blob (PayloadManager::shared_blobs_)
+
+  PayloadLockWord               lock;
+  uint32_t                      refs{0};
+  payload::util::UUID           id{};
+  uint64_t                      version{0};
+  uint64_t                      length_bytes{0};
+  uint64_t                      pin_expires_at_ms{0};
+  mutable std::atomic<uint64_t> last_access{0};
+  uint16_t                      tombstones{0}; // in-flight Delete calls
+  uint8_t                       tier{0};
+  uint8_t                       state{0};
+  uint8_t                       spill_target{0}; // 0 = default (TIER_DISK)
+  uint8_t                       flags{0};
+  uint8_t                       codec{0}; // PayloadCodec of a DISK / OBJECT location
+};
+
+static_assert(sizeof(PayloadControlBlock) == 64, "PayloadControlBlock must fit one cache line");
+
+/*
+  Where a payload's bytes sit inside its tier, captured when the snapshot
+  is cached so a resolve hit rebuilds the location without asking the
+  storage backend (whose placement maps sit behind store-wide locks).
+
+  Lives in the cache line after its control block: only resolves read it,
+  so lease and recency paths still touch one line. Guarded like the
+  control block's plain fields.
+*/
+struct alignas(64) PayloadLocationBlock {
+  // RAM: slab block, or a dedicated segment when slab_id is 0.
+  uint32_t slab_id{0};
+  int32_t  numa_node{-1}; // -1 = unknown
+  uint64_t block_index{0};
+  uint64_t offset_bytes{0};
+  bool     huge_pages{false};
+  // DISK / OBJECT: the whole location, valid while the backend's
+  // LocationEpoch() still equals disk_epoch.
+  uint64_t                                                        disk_epoch{0};
+  std::shared_ptr<const payload::manager::core::v1::DiskLocation> disk;
+};
+
+static_assert(sizeof(PayloadLocationBlock) == 64, "PayloadLocationBlock must fit one cache line");
+
+/*
+  Sharded table of PayloadControlBlocks keyed by payload UUID.
+
+  Each shard owns a shared_mutex, an index from UUID to block, and a slab of
+  cache-line-aligned blocks allocated in chunks (freed blocks are recycled
+  through a per-shard free list), so a live payload costs one index node
+  plus one 64-byte control block and the location block after it.
+
+  A block stays in the table while it holds a snapshot, a tombstone, or an
+  outstanding Ref; once none remain it is reclaimed immediately.
+*/
+class PayloadControlTable {
+  struct Slot;
+
+ public:
+  static constexpr std::size_t kShardCount = 64;
+
+  // Keeps a block alive (but not locked) for the lifetime of the handle.
+  class Ref {
+   public:
+    Ref() = default;
+    Ref(Ref&& other) noexcept;
+    Ref& operator=(Ref&& other) noexcept;
+    Ref(const Ref&)            = delete;
+    Ref& operator=(const Ref&) = delete;
+    ~Ref();
+
+    PayloadLockWord& lock() const {
+      return slot_->block.lock;
+    }
+
+   private:
+    friend class PayloadControlTable;
+    Ref(PayloadControlTable* table, Slot* slot) : table_(table), slot_(slot) {
+    }
+
+    PayloadControlTable* table_{nullptr};
+    Slot*                slot_{nullptr};
+  };
+
+  PayloadControlTable();
+  ~PayloadControlTable();
+
+  PayloadControlTable(const PayloadControlTable&)            = delete;
+  PayloadControlTable& operator=(const PayloadControlTable&) = delete;
+
+  // Find-or-create the block for key and take a reference on it.
+  Ref Acquire(const payload::util::UUID& key);
+
+  // Runs fn(const PayloadControlBlock&) under the shard's shared lock.
+  // Returns false (without calling fn) when no block exists.
+  template <typename Fn>
+  bool Read(const payload::util::UUID& key, Fn&& fn) const {
+    const auto&      shard = shards_[ShardIndex(key)];
+    std::shared_lock lock(shard.mutex);
+    const auto       it = shard.index.find(key);
+    if (it == shard.index.end()) {
+      return false;
+    }
+    fn(static_cast<const PayloadControlBlock&>(it->second->block));
+    return true;
+  }
+
+  // Read() that also passes the payload's location block.
+  template <typename Fn>
+  bool ReadLocated(const payload::util::UUID& key, Fn&& fn) const {
+    const auto&      shard = shards_[ShardIndex(key)];
+    std::shared_lock lock(shard.mutex);
+    const auto       it = shard.index.find(key);
+    if (it == shard.index.end()) {
+      return false;
+    }
+    fn(static_cast<const PayloadControlBlock&>(it->second->block), static_cast<const PayloadLocationBlock&>(it->second->location));
+    return true;
+  }
+
+  // Runs fn(PayloadControlBlock&) under the shard's exclusive lock. With
+  // create=true a missing block is allocated first; otherwise returns false
+  // when no block exists. fn must not call back into this table.
+  template <typename Fn>
+  bool Update(const payload::util::UUID& key, bool create, Fn&& fn) {
+    auto&            shard = shards_[ShardIndex(key)];
+    std::unique_lock lock(shard.mutex);
+    auto             it = shard.index.find(key);
+    if (it == shard.index.end()) {
+      if (!create) {
+        return false;
+      }
+      it = shard.index.emplace(key, AllocateLocked(shard, key)).first;
+    }
+    fn(it->second->block);
+    ReclaimIfUnusedLocked(shard, it);
+    return true;
+  }
+
+  // Update() that also passes the payload's location block.
+  template <typename Fn>
+  bool UpdateLocated(const payload::util::UUID& key, bool create, Fn&& fn) {
+    auto&            shard = shards_[ShardIndex(key)];
+    std::unique_lock lock(shard.mutex);
+    auto             it = shard.index.find(key);
+    if (it == shard.index.end()) {
+      if (!create) {
+        return false;
+      }
+      it = shard.index.emplace(key, AllocateLocked(shard, key)).first;
+    }
+    fn(it->second->block, it->second->location);
+    ReclaimIfUnusedLocked(shard, it);
+    return true;
+  }
+
+  // Runs fn(const PayloadControlBlock&) for every block, one shard at a time
+  // under that shard's shared lock.
+  template <typename Fn>
+  void ForEach(Fn&& fn) const {
+    for (const auto& shard : shards_) {
+      std::shared_lock lock(shard.mutex);
+      for (const auto& [key, slot] : shard.index) {
+        fn(static_cast<const PayloadControlBlock&>(slot->block));
+      }
+    }
+  }
+
+  // Runs fn(PayloadControlBlock&) for every block under the shard's
+  // exclusive lock, reclaiming blocks the callback leaves unused.
+  template <typename Fn>
+  void ForEachMutable(Fn&& fn) {
+    for (auto& shard : shards_) {
+      std::unique_lock lock(shard.mutex);
+      for (auto it = shard.index.begin(); it != shard.index.end();) {
+        fn(it->second->block);
+        it = ReclaimIfUnusedLocked(shard, it);
+      }
+    }
+  }
+
+  // Visits slots like a CLOCK hand: starts where the previous Sweep
+  // stopped and walks every shard's slab chunks in order, one shard at a
+  // time under its shared lock. Free slots are visited too (their flags
+  // are 0). Stops once fn(const PayloadControlBlock&) returns false or
+  // every slot has been visited; returns the number of slots visited.
+  template <typename Fn>
+  std::size_t Sweep(Fn&& fn) const {
+    const uint64_t    start        = hand_.load(std::memory_order_relaxed);
+    const std::size_t start_shard  = static_cast<std::size_t>(start / kHandStride) % kShardCount;
+    const std::size_t start_offset = static_cast<std::size_t>(start % kHandStride);
+    std::size_t       visited      = 0;
+    // The start shard comes round again last, for the slots before the hand.
+    for (std::size_t n = 0; n <= kShardCount; ++n) {
+      const std::size_t shard_index = (start_shard + n) % kShardCount;
+      const std::size_t first       = n == 0 ? start_offset : 0;
+      const std::size_t last        = n == kShardCount ? start_offset : static_cast<std::size_t>(-1);
+      const auto&       shard       = shards_[shard_index];
+      std::shared_lock  lock(shard.mutex);
+      std::size_t       base = 0;
+      for (const auto& chunk : shard.chunks) {
+        const std::size_t size = ChunkSize(base);
+        for (std::size_t i = first > base ? first - base : 0; i < size && base + i < last; ++i) {
+          ++visited;
+          if (!fn(static_cast<const PayloadControlBlock&>(chunk[i].block))) {
+            hand_.store(shard_index * kHandStride + base + i + 1, std::memory_order_relaxed);
+            return visited;
+          }
+        }
+        base += size;
+      }
+    }
+    return visited;
+  }
+
+  // Number of live blocks.
+  std::size_t Size() const;
+
+  // Number of slots, live or free; what one full Sweep visits.
+  std::size_t Capacity() const;
+
+  // Approximate heap footprint: slab chunks, index nodes and bucket arrays.
+  std::size_t MemoryBytes() const;
+
+ private:
+  // Slab chunks start small so idle managers stay cheap, then double.
+  static constexpr std::size_t kMinBlocksPerChunk = 16;
+  static constexpr std::size_t kMaxBlocksPerChunk = 4096;
+  // Sweep hand: shard * kHandStride + slot offset within the shard.
+  static constexpr uint64_t kHandStride = uint64_t{1} << 48;
+
+  // Slots in the chunk added when a shard already has `capacity` slots.
+  static constexpr std::size_t ChunkSize(std::size_t capacity) {
+    return std::clamp(capacity, kMinBlocksPerChunk, kMaxBlocksPerChunk);
+  }
+
+  // A control block and its location block, one cache line each.
+  struct Slot {
+    PayloadControlBlock  block;
+    PayloadLocationBlock location;
+  };
+
+  using Index = std::unordered_map<payload::util::UUID, Slot*>;
+
+  struct alignas(64) Shard {
+    mutable std::shared_mutex            mutex;
+    Index                                index;
+    std::vector<std::unique_ptr<Slot[]>> chunks;
+    std::vector<Slot*>                   free_blocks;
+    std::size_t                          capacity{0};
+  };
+
+  static std::size_t ShardIndex(const payload::util::UUID& key);
+
+  Slot*           AllocateLocked(Shard& shard, const payload::util::UUID& key);
+  Index::iterator ReclaimIfUnusedLocked(Shard& shard, Index::iterator it);
+  void            Release(Slot* slot);
+
+  std::array<Shard, kShardCount> shards_;
+  mutable std::atomic<uint64_t>  hand_{0};
+};
+
+} // namespace payload::core
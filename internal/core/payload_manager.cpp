@@ -1,13 +1,22 @@
 #include "payload_manager.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
 #include <mutex>
+#include <shared_mutex>
 #include <stdexcept>
+#include <unordered_set>
 
 #include "internal/core/placement_engine.hpp"
 #include "internal/db/api/result.hpp"
 #include "internal/db/model/payload_record.hpp"
 #include "internal/lease/lease_manager.hpp"
+#include "internal/storage/content_hash.hpp"
+#include "internal/storage/disk/striped_disk_store.hpp"
 #include "internal/storage/object/object_arrow_store.hpp"
+#include "internal/storage/payload_codec.hpp"
 #include "internal/storage/ram/ram_arrow_store.hpp"
 #include "internal/storage/storage_backend.hpp"
 #include "payload/manager/catalog/v1/archive_metadata.pb.h"
@@ -48,46 +57,63 @@ std::string_view TierName(Tier tier) {
 
 } // namespace
 
-void PayloadManager::UpdateTierBytes(Tier tier, int64_t delta) {
-  uint64_t bytes = 0;
-  {
-    std::lock_guard<std::mutex> lock(tier_bytes_guard_);
-    auto&                       val = tier_bytes_[static_cast<int>(tier)];
-    if (delta < 0 && static_cast<uint64_t>(-delta) > val) {
+void PayloadManager::ExportTierMetrics() const {
+  const auto totals = tier_counters_.Read();
+  auto&      metrics = payload::observability::Metrics::Instance();
+  for (const Tier tier : {TIER_RAM, TIER_GPU, TIER_DISK, TIER_OBJECT, TIER_VOID}) {
+    const auto slot  = static_cast<std::size_t>(tier);
+    const auto bytes = totals.bytes[slot];
+    const auto count = totals.count[slot];
+    if (bytes < 0 || count < 0) {
       PAYLOAD_LOG_ERROR(
-          "tier byte accounting underflow: programming error — UpdateTierBytes called with "
-          "delta that exceeds current total; clamping to 0. This indicates a missed Allocate "
-          "accounting call.",
-          {payload::observability::StringField("tier", TierName(tier)), payload::observability::IntField("delta", delta),
-           payload::observability::IntField("current", static_cast<int64_t>(val))});
-      val = 0;
-    } else {
-      val = static_cast<uint64_t>(static_cast<int64_t>(val) + delta);
+          "tier accounting underflow: programming error — more bytes or payloads were removed from a tier than were "
+          "added; reporting 0. This indicates a missed Allocate accounting call.",
+          {payload::observability::StringField("tier", TierName(tier)), payload::observability::IntField("bytes", bytes),
+           payload::observability::IntField("count", count)});
+    }
+    metrics.SetTierOccupancyBytes(TierName(tier), static_cast<uint64_t>(std::max<int64_t>(bytes, 0)));
+    metrics.SetTierPayloadCount(TierName(tier), static_cast<uint64_t>(std::max<int64_t>(count, 0)));
+  }
+
+  if (ram_store_) {
+    const auto segments = ram_store_->SegmentStats();
+    metrics.SetRamSlabBytes("capacity", segments.capacity_bytes);
+    metrics.SetRamSlabBytes("allocated", segments.allocated_bytes);
+    metrics.SetRamSlabBytes("requested", segments.requested_bytes);
+    metrics.SetRamSegmentCount("slab", segments.slab_count);
+    metrics.SetRamSegmentCount("dedicated", segments.dedicated_segments);
+    metrics.SetRamSegmentCount("hugepage", segments.huge_page_segments);
+    for (const auto& usage : ram_store_->NodeUsage()) {
+      metrics.SetRamNumaNodeBytes(usage.node, usage.used_bytes);
     }
-    bytes = val;
   }
-  payload::observability::Metrics::Instance().SetTierOccupancyBytes(TierName(tier), bytes);
-}
 
-void PayloadManager::UpdateTierCount(Tier tier, int64_t delta) {
-  uint64_t count = 0;
-  {
-    std::lock_guard<std::mutex> lock(tier_count_guard_);
-    auto&                       val = tier_count_[static_cast<int>(tier)];
-    if (delta < 0 && static_cast<uint64_t>(-delta) > val) {
-      PAYLOAD_LOG_ERROR(
-          "tier count accounting underflow: programming error — UpdateTierCount called with "
-          "delta that exceeds current total; clamping to 0. This indicates a missed Allocate "
-          "accounting call.",
-          {payload::observability::StringField("tier", TierName(tier)), payload::observability::IntField("delta", delta),
-           payload::observability::IntField("current", static_cast<int64_t>(val))});
-      val = 0;
-    } else {
-      val = static_cast<uint64_t>(static_cast<int64_t>(val) + delta);
+  if (disk_devices_) {
+    for (const auto& device : disk_devices_->DeviceUsage()) {
+      metrics.SetDiskDeviceBytes(device.name, "capacity", device.capacity_bytes);
+      metrics.SetDiskDeviceBytes(device.name, "used", device.used_bytes);
+      metrics.SetDiskDeviceBytes(device.name, "free", device.free_bytes);
+      metrics.SetDiskDeviceQueueDepth(device.name, device.queue_depth);
+      metrics.SetDiskDeviceIoBytes(device.name, "read", device.read_bytes);
+      metrics.SetDiskDeviceIoBytes(device.name, "write", device.written_bytes);
     }
-    count = val;
   }
-  payload::observability::Metrics::Instance().SetTierPayloadCount(TierName(tier), count);
+}
+
+void PayloadManager::SetTransferOptions(const payload::storage::TransferOptions& options) {
+  transfer_options_ = options;
+}
+
+void PayloadManager::SetTierCodec(Tier tier, PayloadCodec codec) {
+  tier_codecs_[tier] = codec;
+}
+
+void PayloadManager::SetDedupOptions(const DedupOptions& options) {
+  dedup_options_ = options;
+}
+
+PayloadManager::DedupCounters PayloadManager::GetDedupCounters() const {
+  return {dedup_lookups_.load(std::memory_order_relaxed), dedup_hits_.load(std::memory_order_relaxed)};
 }
 
 namespace {
@@ -106,6 +132,68 @@ payload::manager::catalog::v1::PayloadArchiveMetadata BuildSidecar(const Payload
   return meta;
 }
 
+// Sidecar tag naming the shared content blob a payload's bytes are stored under.
+constexpr const char* kContentHashTag = "content_hash";
+
+PayloadCodec StoredCodec(const db::model::PayloadRecord& record) {
+  return static_cast<PayloadCodec>(record.stored_codec);
+}
+
+// Key the record's bytes are stored under on its tier: its shared content blob, if any.
+payload::util::UUID StoredKey(const db::model::PayloadRecord& record) {
+  return record.content_hash.empty() ? record.id : payload::util::FromString(record.content_hash);
+}
+
+// A stored blob found by content key stands in for record's bytes only if
+// nothing recorded about the two contradicts it.
+bool SameContent(const db::model::PayloadRecord& stored, const db::model::PayloadRecord& record) {
+  if (stored.size_bytes != record.size_bytes) return false;
+  return !stored.has_checksum || !record.has_checksum || stored.checksum_crc32c == record.checksum_crc32c;
+}
+
+// Publishes the codec work of one spill / promotion and folds its result into record.
+void RecordTranscode(db::model::PayloadRecord* record, PayloadCodec source_codec, PayloadCodec target_codec,
+                     const payload::storage::TranscodeResult& copied) {
+  auto& metrics = payload::observability::Metrics::Instance();
+  if (copied.decode.raw_bytes > 0) {
+    metrics.RecordCompression(payload::storage::CodecName(source_codec), "decode", copied.decode.raw_bytes, copied.decode.stored_bytes,
+                              copied.decode.duration_ms);
+  }
+  if (copied.encode.raw_bytes > 0) {
+    metrics.RecordCompression(payload::storage::CodecName(target_codec), "encode", copied.encode.raw_bytes, copied.encode.stored_bytes,
+                              copied.encode.duration_ms);
+  }
+  const bool compressed     = payload::storage::IsCompressed(target_codec);
+  record->stored_codec      = compressed ? static_cast<int>(target_codec) : 0;
+  record->stored_size_bytes = compressed ? copied.stored_bytes : 0;
+  if (copied.checksum) {
+    record->checksum_crc32c = *copied.checksum;
+    record->has_checksum    = true;
+  }
+}
+
+/*
+  Compares the checksum taken during a copy with the one recorded when the
+  payload was first spilled. On a mismatch the new copy is dropped and
+  DataLoss thrown, leaving the source copy (and record) authoritative.
+*/
+void VerifyChecksum(payload::storage::StorageBackend& target, const PayloadID& id, const db::model::PayloadRecord& record,
+                    const payload::storage::TranscodeResult& copied, const std::string& context) {
+  if (!copied.checksum || !record.has_checksum || *copied.checksum == record.checksum_crc32c) {
+    return;
+  }
+  try {
+    target.Remove(id);
+  } catch (const std::exception& e) {
+    PAYLOAD_LOG_WARN("checksum mismatch: failed to remove the corrupt copy",
+                     {payload::observability::StringField("payload_id", payload::util::ToString(payload::util::FromProto(id))),
+                      payload::observability::StringField("error", e.what())});
+  }
+  char detail[64];
+  std::snprintf(detail, sizeof(detail), "expected crc32c %08x, copied %08x", record.checksum_crc32c, *copied.checksum);
+  throw payload::util::DataLoss(context + ": checksum mismatch (" + detail + "); the source copy does not match the bytes first spilled");
+}
+
 bool IsReadableState(PayloadState state) {
   return state == PAYLOAD_STATE_ACTIVE || state == PAYLOAD_STATE_SPILLING || state == PAYLOAD_STATE_DURABLE;
 }
@@ -146,43 +234,23 @@ db::model::PayloadRecord ToPayloadRecord(const PayloadDescriptor& descriptor) {
   return record;
 }
 
-PayloadDescriptor ToPayloadDescriptor(const db::model::PayloadRecord& record, const std::string& shm_prefix) {
-  PayloadDescriptor descriptor;
-  *descriptor.mutable_payload_id() = payload::util::ToProto(record.id);
-  descriptor.set_tier(record.tier);
-  descriptor.set_state(record.state);
-  descriptor.set_version(record.version);
-  if (record.size_bytes > 0) {
-    switch (record.tier) {
-      case TIER_GPU: {
-        GpuLocation gpu;
-        gpu.set_device_id(0);
-        gpu.set_length_bytes(record.size_bytes);
-        *descriptor.mutable_gpu() = gpu;
-        break;
-      }
-      case TIER_DISK:
-      case TIER_OBJECT: {
-        DiskLocation disk;
-        disk.set_path(payload::util::ToString(record.id) + ".bin");
-        disk.set_offset_bytes(0);
-        disk.set_length_bytes(record.size_bytes);
-        *descriptor.mutable_disk() = disk;
-        break;
-      }
-      case TIER_RAM:
-      default: {
-        RamLocation ram;
-        ram.set_length_bytes(record.size_bytes);
-        ram.set_slab_id(0);
-        ram.set_block_index(0);
-        ram.set_shm_name(payload::storage::RamArrowStore::ShmName(payload::util::ToProto(record.id), shm_prefix));
-        *descriptor.mutable_ram() = ram;
-        break;
-      }
-    }
+// Recency stamp for LRU ordering. A clock read rather than a shared counter
+// so touching a payload never writes a cache line shared with other payloads.
+uint64_t RecencyNow() {
+  return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+}
+
+bool IsPinnedAt(const PayloadControlBlock& block, uint64_t now_ms) {
+  if ((block.flags & PayloadControlBlock::kPinned) == 0) {
+    return false;
   }
-  return descriptor;
+  return block.pin_expires_at_ms == 0 || block.pin_expires_at_ms > now_ms;
+}
+
+void ClearSnapshot(PayloadControlBlock& block) {
+  block.flags             = 0;
+  block.pin_expires_at_ms = 0;
+  block.spill_target      = 0;
 }
 
 } // namespace
@@ -190,65 +258,316 @@ PayloadDescriptor ToPayloadDescriptor(const db::model::PayloadRecord& record, co
 PayloadManager::PayloadManager(payload::storage::StorageFactory::TierMap storage, std::shared_ptr<payload::lease::LeaseManager> lease_mgr,
                                std::shared_ptr<payload::db::Repository> repository, std::shared_ptr<payload::metadata::MetadataCache> metadata_cache)
     : storage_(std::move(storage)), lease_mgr_(std::move(lease_mgr)), repository_(std::move(repository)), metadata_cache_(std::move(metadata_cache)) {
-  // Cache the shm prefix from the RAM backend so descriptor building is consistent.
+  // Keep the RAM backend so descriptors carry its slab placements and shm prefix.
   const auto ram_it = storage_.find(TIER_RAM);
   if (ram_it != storage_.end() && ram_it->second) {
-    if (auto* ram = dynamic_cast<payload::storage::RamArrowStore*>(ram_it->second.get())) {
-      shm_prefix_ = ram->GetShmPrefix();
+    ram_store_ = std::dynamic_pointer_cast<payload::storage::RamArrowStore>(ram_it->second);
+    if (ram_store_) {
+      shm_prefix_ = ram_store_->GetShmPrefix();
+      // Freed slab blocks stay out of reuse while clients hold leases on
+      // them, revoked ones included.
+      if (lease_mgr_) {
+        ram_store_->SetHolderProbe([lease_mgr = lease_mgr_](const PayloadID& id) { return lease_mgr->HasHolders(id); });
+      }
     }
   }
+  const auto disk_it = storage_.find(TIER_DISK);
+  if (disk_it != storage_.end() && disk_it->second) {
+    disk_devices_ = std::dynamic_pointer_cast<payload::storage::StripedDiskStore>(disk_it->second);
+  }
 }
 
-payload::util::UUID PayloadManager::Key(const PayloadID& id) {
-  if (id.value().size() != 16) {
-    throw payload::util::NotFound("payload not found; invalid or missing payload id");
+RamLocation PayloadManager::LocateRam(const PayloadID& id, uint64_t length_bytes) const {
+  if (ram_store_) {
+    return ram_store_->Locate(id, length_bytes);
+  }
+  RamLocation ram;
+  ram.set_length_bytes(length_bytes);
+  ram.set_shm_name(payload::storage::RamArrowStore::ShmName(id, shm_prefix_));
+  return ram;
+}
+
+RamLocation PayloadManager::LocateRam(const PayloadID& id, uint64_t length_bytes, const payload::storage::RamPlacement& placement) const {
+  return ram_store_ ? ram_store_->Locate(id, length_bytes, placement) : LocateRam(id, length_bytes);
+}
+
+void PayloadManager::LocateStored(Tier tier, const payload::util::UUID& key, DiskLocation* location) const {
+  const auto name = payload::util::ToString(key);
+  const auto it   = storage_.find(tier);
+  if (it != storage_.end() && it->second) {
+    it->second->Locate(name, location);
+  } else {
+    location->set_path(name + ".bin");
+    location->set_offset_bytes(0);
   }
-  return payload::util::FromProto(id);
 }
 
-std::shared_ptr<std::shared_mutex> PayloadManager::PayloadMutex(const PayloadID& id) {
-  std::lock_guard<std::mutex> lock(payload_mutexes_guard_);
-  auto&                       payload_mutex = payload_mutexes_[Key(id)];
-  if (!payload_mutex) {
-    payload_mutex = std::make_shared<std::shared_mutex>();
+uint64_t PayloadManager::LocationEpoch(Tier tier) const {
+  const auto it = storage_.find(tier);
+  return it != storage_.end() && it->second ? it->second->LocationEpoch() : 0;
+}
+
+payload::util::UUID PayloadManager::LocatedKey(const PayloadDescriptor& descriptor) const {
+  const auto key = payload::util::FromProto(descriptor.payload_id());
+  if (!descriptor.has_disk()) return key;
+  const auto it = storage_.find(descriptor.tier());
+  if (it == storage_.end() || !it->second) return key;
+  const auto located = it->second->LocatedKey(descriptor.disk());
+  if (!located) return key;
+  try {
+    return payload::util::FromString(*located);
+  } catch (const std::exception&) {
+    return key;
   }
-  return payload_mutex;
 }
 
-bool PayloadManager::IsPinnedLocked(const payload::util::UUID& key, uint64_t now_ms) {
-  const auto it = pins_.find(key);
-  if (it == pins_.end()) {
-    return false;
+void PayloadManager::SetLocation(PayloadDescriptor* descriptor, const payload::util::UUID& id, uint64_t length_bytes, PayloadCodec codec) const {
+  switch (descriptor->tier()) {
+    case TIER_GPU: {
+      GpuLocation gpu;
+      gpu.set_device_id(0);
+      gpu.set_length_bytes(length_bytes);
+      *descriptor->mutable_gpu() = gpu;
+      break;
+    }
+    case TIER_DISK:
+    case TIER_OBJECT: {
+      DiskLocation disk;
+      LocateStored(descriptor->tier(), id, &disk);
+      disk.set_length_bytes(length_bytes);
+      disk.set_codec(codec);
+      *descriptor->mutable_disk() = disk;
+      break;
+    }
+    case TIER_RAM:
+    default: {
+      *descriptor->mutable_ram() = LocateRam(payload::util::ToProto(id), length_bytes);
+      break;
+    }
+  }
+}
+
+PayloadDescriptor PayloadManager::ToPayloadDescriptor(const db::model::PayloadRecord& record) const {
+  PayloadDescriptor descriptor;
+  *descriptor.mutable_payload_id() = payload::util::ToProto(record.id);
+  descriptor.set_tier(record.tier);
+  descriptor.set_state(record.state);
+  descriptor.set_version(record.version);
+  if (record.size_bytes > 0) {
+    // A compressed copy is located by its frame; the codec tells clients it is not the raw payload.
+    const bool compressed = payload::storage::IsCompressed(StoredCodec(record));
+    SetLocation(&descriptor, StoredKey(record), compressed ? record.stored_size_bytes : record.size_bytes, StoredCodec(record));
   }
+  return descriptor;
+}
 
-  if (!it->second.expires_at_ms.has_value()) {
-    return true;
+PayloadCodec PayloadManager::TargetCodec(const db::model::PayloadRecord& record, Tier target) const {
+  if (!IsDurableTier(target)) {
+    return PAYLOAD_CODEC_NONE;
+  }
+  if (record.spill_codec != 0) {
+    return static_cast<PayloadCodec>(record.spill_codec);
   }
+  const auto it = tier_codecs_.find(target);
+  return it != tier_codecs_.end() ? it->second : PAYLOAD_CODEC_NONE;
+}
 
-  if (*it->second.expires_at_ms > now_ms) {
-    return true;
+payload::util::UUID PayloadManager::Key(const PayloadID& id) {
+  if (id.value().size() != 16) {
+    throw payload::util::NotFound("payload not found; invalid or missing payload id");
   }
+  return payload::util::FromProto(id);
+}
 
-  pins_.erase(it);
-  return false;
+PayloadManager::EvictionHints PayloadManager::HintsFromRecord(const db::model::PayloadRecord& record) {
+  using payload::manager::core::v1::EVICTION_PRIORITY_NEVER;
+  EvictionHints hints;
+  hints.no_evict     = record.no_evict || record.eviction_priority == static_cast<int>(EVICTION_PRIORITY_NEVER);
+  hints.spill_target = (record.spill_target != 0) ? static_cast<Tier>(record.spill_target) : TIER_DISK;
+  return hints;
 }
 
-void PayloadManager::SweepExpiredPins() {
-  const uint64_t              now_ms = payload::util::ToUnixMillis(payload::util::Now());
-  std::lock_guard<std::mutex> lock(pins_guard_);
-  for (auto it = pins_.begin(); it != pins_.end();) {
-    const auto& state = it->second;
-    if (state.expires_at_ms.has_value() && *state.expires_at_ms <= now_ms) {
-      it = pins_.erase(it);
+void PayloadManager::MarkDeleting(const payload::util::UUID& key) {
+  controls_.Update(key, /*create=*/true, [](PayloadControlBlock& block) { ++block.tombstones; });
+}
+
+void PayloadManager::ClearDeleting(const payload::util::UUID& key) {
+  controls_.Update(key, /*create=*/false, [](PayloadControlBlock& block) {
+    if (block.tombstones > 0) {
+      --block.tombstones;
+    }
+  });
+}
+
+bool PayloadManager::IsDeleting(const payload::util::UUID& key) const {
+  bool deleting = false;
+  controls_.Read(key, [&](const PayloadControlBlock& block) { deleting = block.tombstones > 0; });
+  return deleting;
+}
+
+void PayloadManager::CacheSnapshot(const PayloadDescriptor& descriptor, const EvictionHints& hints) {
+  const auto key = Key(descriptor.payload_id());
+
+  uint64_t                           length_bytes = 0;
+  uint8_t                            codec        = 0;
+  bool                               has_location = true;
+  std::optional<payload::util::UUID> blob;
+  PayloadLocationBlock               location;
+  if (descriptor.has_ram()) {
+    const auto& ram       = descriptor.ram();
+    length_bytes          = ram.length_bytes();
+    location.slab_id      = ram.slab_id();
+    location.block_index  = ram.block_index();
+    location.offset_bytes = ram.offset_bytes();
+    location.huge_pages   = ram.page_size_bytes() != 0;
+    location.numa_node    = ram.has_numa_node() ? static_cast<int32_t>(ram.numa_node()) : -1;
+  } else if (descriptor.has_gpu()) {
+    length_bytes = descriptor.gpu().length_bytes();
+  } else if (descriptor.has_disk()) {
+    length_bytes      = descriptor.disk().length_bytes();
+    codec             = static_cast<uint8_t>(descriptor.disk().codec());
+    const auto stored = LocatedKey(descriptor);
+    if (stored != key) blob = stored;
+    // Located afresh after reading the epoch: the descriptor's own location
+    // may predate a move that the epoch already counts.
+    location.disk_epoch = LocationEpoch(descriptor.tier());
+    auto disk           = std::make_shared<DiskLocation>(descriptor.disk());
+    LocateStored(descriptor.tier(), stored, disk.get());
+    location.disk = std::move(disk);
+  } else {
+    has_location = false;
+  }
+
+  // Publish the blob key before the flag that tells readers to look it up.
+  if (blob) {
+    std::unique_lock lock(shared_blobs_mutex_);
+    shared_blobs_[key] = *blob;
+  }
+
+  const auto now        = RecencyNow();
+  bool       was_shared = false;
+  controls_.UpdateLocated(key, /*create=*/true, [&](PayloadControlBlock& block, PayloadLocationBlock& located) {
+    was_shared         = (block.flags & PayloadControlBlock::kSharedBlob) != 0;
+    block.tier         = static_cast<uint8_t>(descriptor.tier());
+    block.state        = static_cast<uint8_t>(descriptor.state());
+    block.version      = descriptor.version();
+    block.length_bytes = length_bytes;
+    block.spill_target = static_cast<uint8_t>(hints.spill_target);
+    block.codec        = codec;
+
+    uint8_t flags = (block.flags & PayloadControlBlock::kPinned) | PayloadControlBlock::kHasSnapshot;
+    if (has_location) flags |= PayloadControlBlock::kHasLocation;
+    if (hints.no_evict) flags |= PayloadControlBlock::kNoEvict;
+    if (blob) flags |= PayloadControlBlock::kSharedBlob;
+    block.flags = flags;
+    block.last_access.store(now, std::memory_order_relaxed);
+    located = location;
+  });
+
+  if (was_shared && !blob) {
+    std::unique_lock lock(shared_blobs_mutex_);
+    shared_blobs_.erase(key);
+  }
+}
+
+std::optional<PayloadDescriptor> PayloadManager::FindSnapshot(const payload::util::UUID& key) {
+  // Copy the scalars under the shard lock; the protobuf is built after it is released.
+  bool                                found        = false;
+  bool                                has_location = false;
+  bool                                shared_blob  = false;
+  uint8_t                             tier         = 0;
+  uint8_t                             state        = 0;
+  uint64_t                            version      = 0;
+  uint64_t                            length_bytes = 0;
+  uint8_t                             codec        = 0;
+  payload::storage::RamPlacement      placement;
+  uint64_t                            disk_epoch   = 0;
+  std::shared_ptr<const DiskLocation> disk;
+  controls_.ReadLocated(key, [&](const PayloadControlBlock& block, const PayloadLocationBlock& location) {
+    if ((block.flags & PayloadControlBlock::kHasSnapshot) == 0) {
+      return;
+    }
+    found        = true;
+    has_location = (block.flags & PayloadControlBlock::kHasLocation) != 0;
+    shared_blob  = (block.flags & PayloadControlBlock::kSharedBlob) != 0;
+    tier         = block.tier;
+    state        = block.state;
+    version      = block.version;
+    length_bytes = block.length_bytes;
+    codec        = block.codec;
+
+    placement.slab_id      = location.slab_id;
+    placement.block_index  = location.block_index;
+    placement.offset_bytes = location.offset_bytes;
+    placement.huge_pages   = location.huge_pages;
+    placement.numa_node    = location.numa_node;
+    disk_epoch             = location.disk_epoch;
+    disk                   = location.disk;
+  });
+  if (!found) {
+    return std::nullopt;
+  }
+
+  auto stored = key;
+  if (shared_blob) {
+    std::shared_lock lock(shared_blobs_mutex_);
+    const auto       it = shared_blobs_.find(key);
+    if (it == shared_blobs_.end()) {
+      return std::nullopt; // re-cached concurrently; the miss path rebuilds it
+    }
+    stored = it->second;
+  }
+
+  PayloadDescriptor descriptor;
+  *descriptor.mutable_payload_id() = payload::util::ToProto(key);
+  descriptor.set_tier(static_cast<Tier>(tier));
+  descriptor.set_state(static_cast<PayloadState>(state));
+  descriptor.set_version(version);
+  if (has_location && descriptor.tier() == TIER_RAM) {
+    *descriptor.mutable_ram() = LocateRam(payload::util::ToProto(stored), length_bytes, placement);
+  } else if (has_location && (descriptor.tier() == TIER_DISK || descriptor.tier() == TIER_OBJECT)) {
+    const auto epoch = LocationEpoch(descriptor.tier());
+    if (disk && disk_epoch == epoch) {
+      *descriptor.mutable_disk() = *disk;
     } else {
-      ++it;
+      // Moved since it was cached: locate it once and keep the answer for later hits.
+      SetLocation(&descriptor, stored, length_bytes, static_cast<PayloadCodec>(codec));
+      std::shared_ptr<const DiskLocation> fresh = std::make_shared<DiskLocation>(descriptor.disk());
+      controls_.UpdateLocated(key, /*create=*/false, [&](PayloadControlBlock& block, PayloadLocationBlock& located) {
+        if (block.tier != tier || located.disk != disk) return; // re-cached meanwhile
+        located.disk.swap(fresh);                                 // the old one is released after the shard lock
+        located.disk_epoch = epoch;
+      });
+    }
+  } else if (has_location) {
+    SetLocation(&descriptor, stored, length_bytes, static_cast<PayloadCodec>(codec));
+    // GPU locations carry an IPC handle that only the backend can export.
+    if (descriptor.tier() == TIER_GPU && storage_.count(TIER_GPU) > 0) {
+      try {
+        PopulateLocation(&descriptor);
+      } catch (const std::exception&) {
+        // Keep the length-only location; the handle is re-exported on the next resolve.
+      }
     }
   }
+  return descriptor;
+}
+
+bool PayloadManager::HasSnapshot(const payload::util::UUID& key) const {
+  bool present = false;
+  controls_.Read(key, [&](const PayloadControlBlock& block) { present = (block.flags & PayloadControlBlock::kHasSnapshot) != 0; });
+  return present;
+}
+
+void PayloadManager::DropSnapshot(const payload::util::UUID& key) {
+  controls_.Update(key, /*create=*/false, ClearSnapshot);
+  std::unique_lock lock(shared_blobs_mutex_);
+  shared_blobs_.erase(key);
 }
 
-void PayloadManager::CacheSnapshot(const PayloadDescriptor& descriptor) {
-  std::unique_lock lock(snapshot_cache_mutex_);
-  snapshot_cache_[Key(descriptor.payload_id())] = descriptor;
+void PayloadManager::Touch(const payload::util::UUID& key) {
+  const auto now = RecencyNow();
+  controls_.Read(key, [&](const PayloadControlBlock& block) { block.last_access.store(now, std::memory_order_relaxed); });
 }
 
 void PayloadManager::PopulateLocation(PayloadDescriptor* descriptor) {
@@ -263,35 +582,33 @@ void PayloadManager::PopulateLocation(PayloadDescriptor* descriptor) {
 
   auto&       backend = storage_it->second;
   const auto& id      = descriptor->payload_id();
+  // Durable bytes may be a shared content blob; ToPayloadDescriptor located it.
+  const auto stored = payload::util::ToProto(LocatedKey(*descriptor));
+  // Only the record knows whether the stored bytes are a compressed frame; keep what the caller set.
+  const auto codec = descriptor->has_disk() ? descriptor->disk().codec() : PAYLOAD_CODEC_UNSPECIFIED;
 
   switch (descriptor->tier()) {
     case TIER_RAM: {
-      const auto  size = backend->Size(id);
-      RamLocation ram;
-      ram.set_length_bytes(size);
-      ram.set_slab_id(0);
-      ram.set_block_index(0);
-      ram.set_shm_name(payload::storage::RamArrowStore::ShmName(id, shm_prefix_));
-      *descriptor->mutable_ram() = ram;
+      *descriptor->mutable_ram() = LocateRam(id, backend->Size(id));
       return;
     }
     case TIER_DISK: {
-      const auto   size = backend->Size(id);
+      const auto   size = backend->Size(stored);
       DiskLocation disk;
       disk.set_length_bytes(size);
-      disk.set_offset_bytes(0);
-      disk.set_path(payload::util::ToString(Key(id)) + ".bin");
+      backend->Locate(payload::util::ToString(Key(stored)), &disk);
+      disk.set_codec(codec);
       *descriptor->mutable_disk() = disk;
       return;
     }
     case TIER_OBJECT: {
       // Object storage is exposed via DiskLocation (path-based); the descriptor's
       // tier field distinguishes TIER_OBJECT from TIER_DISK at the client side.
-      const auto   size = backend->Size(id);
+      const auto   size = backend->Size(stored);
       DiskLocation disk;
       disk.set_length_bytes(size);
-      disk.set_offset_bytes(0);
-      disk.set_path(payload::util::ToString(Key(id)) + ".bin");
+      backend->Locate(payload::util::ToString(Key(stored)), &disk);
+      disk.set_codec(codec);
       *descriptor->mutable_disk() = disk;
       return;
     }
@@ -328,8 +645,12 @@ void PayloadManager::PopulateLocation(PayloadDescriptor* descriptor) {
   }
 }
 
-PayloadDescriptor PayloadManager::Allocate(uint64_t size_bytes, Tier preferred, uint64_t ttl_ms, bool no_evict,
-                                           const payload::manager::core::v1::EvictionPolicy& eviction_policy) {
+PayloadManager::PreparedAllocation PayloadManager::PrepareAllocation(const AllocateSpec& spec) {
+  const auto  size_bytes      = spec.size_bytes;
+  const auto  preferred       = spec.preferred;
+  const auto  ttl_ms          = spec.ttl_ms;
+  const auto  no_evict        = spec.no_evict;
+  const auto& eviction_policy = spec.eviction_policy;
   if (size_bytes == 0) {
     throw payload::util::InvalidArgument("allocate payload: size_bytes must be greater than zero");
   }
@@ -351,7 +672,11 @@ PayloadDescriptor PayloadManager::Allocate(uint64_t size_bytes, Tier preferred,
     // No server-side allocation; no location set in the descriptor.
   } else if (storage_it != storage_.end() && storage_it->second) {
     try {
-      storage_it->second->Allocate(desc.payload_id(), size_bytes);
+      if (preferred == TIER_RAM && ram_store_) {
+        ram_store_->Allocate(desc.payload_id(), size_bytes, spec.numa_node);
+      } else {
+        storage_it->second->Allocate(desc.payload_id(), size_bytes);
+      }
     } catch (...) {
       payload::observability::Metrics::Instance().RecordAllocationFailure(TierName(preferred));
       throw;
@@ -367,18 +692,13 @@ PayloadDescriptor PayloadManager::Allocate(uint64_t size_bytes, Tier preferred,
       }
       case TIER_DISK: {
         auto* disk = desc.mutable_disk();
-        disk->set_path(payload::util::ToString(Key(desc.payload_id())) + ".bin");
-        disk->set_offset_bytes(0);
+        LocateStored(TIER_DISK, Key(desc.payload_id()), disk);
         disk->set_length_bytes(size_bytes);
         break;
       }
       case TIER_RAM:
       default: {
-        auto* ram = desc.mutable_ram();
-        ram->set_length_bytes(size_bytes);
-        ram->set_slab_id(0);
-        ram->set_block_index(0);
-        ram->set_shm_name(payload::storage::RamArrowStore::ShmName(desc.payload_id(), shm_prefix_));
+        *desc.mutable_ram() = LocateRam(desc.payload_id(), size_bytes);
         break;
       }
     }
@@ -392,12 +712,13 @@ PayloadDescriptor PayloadManager::Allocate(uint64_t size_bytes, Tier preferred,
   // Always store the requested allocation size, not the backend-reported size.
   // PopulateLocation derives size from backend->Size() which may return 0 for
   // stub or write-only backends; the authoritative accounting size is the
-  // caller-supplied size_bytes used in UpdateTierBytes below.
+  // caller-supplied size_bytes used for tier accounting below.
   record.size_bytes         = size_bytes;
   record.no_evict           = no_evict;
   record.eviction_priority  = static_cast<int>(eviction_policy.priority());
   record.min_residency_tier = static_cast<int>(eviction_policy.min_residency_tier());
   record.require_durable    = eviction_policy.require_durable();
+  record.spill_codec        = static_cast<int>(eviction_policy.spill_codec());
 
   // Determine spill target: use policy hint if set, otherwise fall back to TIER_DISK.
   const Tier spill_tier = (eviction_policy.spill_target() != TIER_UNSPECIFIED) ? eviction_policy.spill_target() : TIER_DISK;
@@ -410,43 +731,99 @@ PayloadDescriptor PayloadManager::Allocate(uint64_t size_bytes, Tier preferred,
     record.expires_at_ms = now_ms + ttl_ms;
   }
 
+  return PreparedAllocation{std::move(desc), std::move(record), EvictionHints{never_evict, spill_tier}};
+}
+
+void PayloadManager::RollbackAllocation(const PreparedAllocation& prepared) {
+  // Release the storage allocation so bytes are not orphaned.
+  const auto storage_it = storage_.find(prepared.descriptor.tier());
+  if (storage_it != storage_.end() && storage_it->second) {
+    try {
+      storage_it->second->Remove(prepared.descriptor.payload_id());
+    } catch (...) {
+    }
+  }
+}
+
+void PayloadManager::PublishAllocation(const PreparedAllocation& prepared) {
+  CacheSnapshot(prepared.descriptor, prepared.hints);
+  tier_counters_.Add(prepared.descriptor.tier(), static_cast<int64_t>(prepared.record.size_bytes), 1);
+}
+
+PayloadDescriptor PayloadManager::Allocate(uint64_t size_bytes, Tier preferred, uint64_t ttl_ms, bool no_evict,
+                                           const payload::manager::core::v1::EvictionPolicy& eviction_policy, std::optional<uint32_t> numa_node) {
+  const auto prepared = PrepareAllocation(AllocateSpec{size_bytes, preferred, ttl_ms, no_evict, eviction_policy, numa_node});
   try {
     auto tx = repository_->Begin();
-    ThrowIfDbError(repository_->InsertPayload(*tx, record), "allocate payload");
+    ThrowIfDbError(repository_->InsertPayload(*tx, prepared.record), "allocate payload");
     tx->Commit();
   } catch (...) {
-    // Roll back the storage allocation so bytes are not orphaned.
-    if (storage_it != storage_.end() && storage_it->second) {
+    RollbackAllocation(prepared);
+    throw;
+  }
+
+  PublishAllocation(prepared);
+  return prepared.descriptor;
+}
+
+std::vector<PayloadManager::BatchResult> PayloadManager::AllocateBatch(const std::vector<AllocateSpec>& items) {
+  std::vector<BatchResult>                        results(items.size());
+  std::vector<std::optional<PreparedAllocation>> prepared(items.size());
+  bool                                            any_prepared = false;
+  for (std::size_t i = 0; i < items.size(); ++i) {
+    try {
+      prepared[i].emplace(PrepareAllocation(items[i]));
+      any_prepared = true;
+    } catch (...) {
+      results[i].error = std::current_exception();
+    }
+  }
+  if (!any_prepared) {
+    return results;
+  }
+
+  try {
+    auto tx = repository_->Begin();
+    for (std::size_t i = 0; i < items.size(); ++i) {
+      if (!prepared[i]) {
+        continue;
+      }
+      // A failed write leaves the transaction aborted on Postgres; rolling
+      // back to the item's savepoint keeps the others' writes committable.
+      // If that rollback itself fails, the whole batch fails below.
+      tx->Savepoint();
       try {
-        storage_it->second->Remove(desc.payload_id());
+        ThrowIfDbError(repository_->InsertPayload(*tx, prepared[i]->record), "allocate payload");
+        tx->ReleaseSavepoint();
       } catch (...) {
+        results[i].error = std::current_exception();
+        tx->RollbackToSavepoint();
+        RollbackAllocation(*prepared[i]);
+        prepared[i].reset();
       }
     }
-    throw;
+    tx->Commit();
+  } catch (...) {
+    const auto error = std::current_exception();
+    for (std::size_t i = 0; i < items.size(); ++i) {
+      if (prepared[i]) {
+        RollbackAllocation(*prepared[i]);
+        results[i].error = error;
+      }
+    }
+    return results;
   }
 
-  const auto key = Key(desc.payload_id());
-  if (never_evict) {
-    std::lock_guard<std::mutex> lock(no_evict_guard_);
-    no_evict_ids_.insert(key);
-  }
-  {
-    std::lock_guard<std::mutex> lock(spill_targets_guard_);
-    spill_targets_[key] = spill_tier;
+  for (std::size_t i = 0; i < items.size(); ++i) {
+    if (prepared[i]) {
+      PublishAllocation(*prepared[i]);
+      results[i].descriptor = std::move(prepared[i]->descriptor);
+    }
   }
-
-  CacheSnapshot(desc);
-  UpdateTierBytes(preferred, static_cast<int64_t>(size_bytes));
-  UpdateTierCount(preferred, 1);
-  return desc;
+  return results;
 }
 
 void PayloadManager::ExpireStale() {
-  // Proactively remove expired pin entries so they don't accumulate indefinitely.
-  // IsPinnedLocked prunes lazily on access, but payloads that are never re-checked
-  // would otherwise hold stale map entries until process restart.
-  SweepExpiredPins();
-
   const uint64_t now_ms = payload::util::ToUnixMillis(payload::util::Now());
 
   auto       tx      = repository_->Begin();
@@ -463,22 +840,24 @@ void PayloadManager::ExpireStale() {
   }
 }
 
-PayloadDescriptor PayloadManager::Commit(const PayloadID& id) {
-  auto tx     = repository_->Begin();
-  auto record = repository_->GetPayload(*tx, Key(id));
+db::model::PayloadRecord PayloadManager::StageCommit(db::Transaction& tx, const payload::util::UUID& key) {
+  auto record = repository_->GetPayload(tx, key);
   if (!record.has_value()) throw payload::util::NotFound("commit payload: payload not found; allocate first and retry");
   if (record->state != PAYLOAD_STATE_ALLOCATED) {
     throw payload::util::InvalidState("commit payload: payload must be in allocated state before commit");
   }
   record->state = IsDurableTier(static_cast<Tier>(record->tier)) ? PAYLOAD_STATE_DURABLE : PAYLOAD_STATE_ACTIVE;
   record->version++;
-  ThrowIfDbError(repository_->UpdatePayload(*tx, *record), "commit payload");
-  const auto parents = repository_->GetParents(*tx, payload::util::ToString(Key(id)));
-  tx->Commit();
-  const auto descriptor = ToPayloadDescriptor(*record, shm_prefix_);
+  ThrowIfDbError(repository_->UpdatePayload(tx, *record), "commit payload");
+  return *record;
+}
+
+PayloadDescriptor PayloadManager::PublishCommit(const PayloadID& id, const db::model::PayloadRecord& record,
+                                                const std::vector<db::model::LineageRecord>& parents) {
+  const auto descriptor = ToPayloadDescriptor(record);
   auto       hydrated   = descriptor;
   PopulateLocation(&hydrated);
-  CacheSnapshot(hydrated);
+  CacheSnapshot(hydrated, HintsFromRecord(record));
   // Write a JSON sidecar alongside the data file for durable tiers so that
   // the stored payload is self-describing independent of the database.
   if (IsDurableTier(hydrated.tier())) {
@@ -507,16 +886,74 @@ PayloadDescriptor PayloadManager::Commit(const PayloadID& id) {
       }
     }
   }
-  // Register with the metadata cache so this payload is a candidate for
-  // LRU-based tier eviction even if UpsertMetadata was never called.
-  if (metadata_cache_) {
-    payload::manager::v1::PayloadMetadata minimal;
-    *minimal.mutable_id() = id;
-    metadata_cache_->Put(id, minimal);
-  }
   return hydrated;
 }
 
+PayloadDescriptor PayloadManager::Commit(const PayloadID& id) {
+  auto       tx      = repository_->Begin();
+  const auto record  = StageCommit(*tx, Key(id));
+  const auto parents = repository_->GetParents(*tx, payload::util::ToString(Key(id)));
+  tx->Commit();
+  return PublishCommit(id, record, parents);
+}
+
+std::vector<PayloadManager::BatchResult> PayloadManager::CommitBatch(const std::vector<PayloadID>& ids) {
+  struct Staged {
+    std::size_t                           index;
+    db::model::PayloadRecord              record;
+    std::vector<db::model::LineageRecord> parents;
+  };
+
+  std::vector<BatchResult> results(ids.size());
+  std::vector<Staged>      staged;
+  staged.reserve(ids.size());
+
+  try {
+    auto                                    tx = repository_->Begin();
+    std::unordered_set<payload::util::UUID> seen;
+    for (std::size_t i = 0; i < ids.size(); ++i) {
+      bool savepoint = false;
+      try {
+        const auto key = Key(ids[i]);
+        if (!seen.insert(key).second) {
+          throw payload::util::InvalidArgument("commit payloads: payload id appears more than once in the batch");
+        }
+        // Same per-item savepoint as AllocateBatch.
+        tx->Savepoint();
+        savepoint    = true;
+        auto record  = StageCommit(*tx, key);
+        auto parents = repository_->GetParents(*tx, payload::util::ToString(key));
+        tx->ReleaseSavepoint();
+        savepoint = false;
+        staged.push_back(Staged{i, std::move(record), std::move(parents)});
+      } catch (...) {
+        results[i].error = std::current_exception();
+        if (savepoint) {
+          tx->RollbackToSavepoint();
+        }
+      }
+    }
+    tx->Commit();
+  } catch (...) {
+    const auto error = std::current_exception();
+    for (auto& result : results) {
+      if (!result.error) {
+        result.error = error;
+      }
+    }
+    return results;
+  }
+
+  for (const auto& item : staged) {
+    try {
+      results[item.index].descriptor = PublishCommit(ids[item.index], item.record, item.parents);
+    } catch (...) {
+      results[item.index].error = std::current_exception();
+    }
+  }
+  return results;
+}
+
 std::string PayloadManager::GetObjectUploadPath(const PayloadID& id) const {
   const auto storage_it = storage_.find(TIER_OBJECT);
   if (storage_it == storage_.end() || !storage_it->second) {
@@ -556,10 +993,10 @@ void PayloadManager::Import(const PayloadID& id, uint64_t size_bytes) {
   const auto parents = repository_->GetParents(*tx, payload::util::ToString(key));
   tx->Commit();
 
-  const auto descriptor = ToPayloadDescriptor(*record, shm_prefix_);
+  const auto descriptor = ToPayloadDescriptor(*record);
   auto       hydrated   = descriptor;
   PopulateLocation(&hydrated);
-  CacheSnapshot(hydrated);
+  CacheSnapshot(hydrated, HintsFromRecord(*record));
 
   const auto storage_it = storage_.find(TIER_OBJECT);
   if (storage_it != storage_.end() && storage_it->second) {
@@ -585,20 +1022,24 @@ void PayloadManager::Import(const PayloadID& id, uint64_t size_bytes) {
     }
   }
 
-  if (metadata_cache_) {
-    payload::manager::v1::PayloadMetadata minimal;
-    *minimal.mutable_id() = id;
-    metadata_cache_->Put(id, minimal);
-  }
-
   if (size_bytes > 0 && size_delta != 0) {
-    UpdateTierBytes(TIER_OBJECT, size_delta);
+    tier_counters_.Add(TIER_OBJECT, size_delta, 0);
   }
 }
 
 void PayloadManager::Delete(const PayloadID& id, bool force) {
-  // Hold delete_mutex_ to prevent new leases from being acquired between the check and the DB mutation.
-  std::lock_guard<std::mutex> delete_lock(delete_mutex_);
+  // Tombstone this payload so lease, promote and pin calls on it back off
+  // between the lease check and the DB mutation. The tombstone is scoped to
+  // the payload: deletes never stall callers working on other payloads.
+  const auto key = Key(id);
+  MarkDeleting(key);
+  struct TombstoneScope {
+    PayloadManager*            manager;
+    const payload::util::UUID& key;
+    ~TombstoneScope() {
+      manager->ClearDeleting(key);
+    }
+  } tombstone_scope{this, key};
 
   if (force) {
     // Invalidate active leases: marks them as invalid so HasActiveLeases
@@ -609,14 +1050,15 @@ void PayloadManager::Delete(const PayloadID& id, bool force) {
     // acquiring payload_lock below.  ResolveSnapshot() also acquires
     // payload_lock (shared), so waiting inside payload_lock would deadlock
     // with a lease holder that calls ResolveSnapshot() before ReleaseLease().
-    // AcquireReadLease() holds delete_mutex_, so no new leases can be granted
-    // while we wait here, making the window safe.
+    // AcquireReadLease() re-checks the tombstone after granting, so any lease
+    // granted from here on is released again instead of outliving the delete.
     constexpr auto kForceDeleteLeaseWaitMs = 5'000u;
     lease_mgr_->WaitUntilNoLeases(id, std::chrono::steady_clock::now() + std::chrono::milliseconds(kForceDeleteLeaseWaitMs));
   }
 
   {
-    std::unique_lock<std::shared_mutex> payload_lock(*PayloadMutex(id));
+    auto                              control = controls_.Acquire(key);
+    std::unique_lock<PayloadLockWord> payload_lock(control.lock());
 
     if (!force && lease_mgr_->HasActiveLeases(id)) {
       throw payload::util::LeaseConflict("delete payload: active lease present; release leases or set force=true");
@@ -628,8 +1070,9 @@ void PayloadManager::Delete(const PayloadID& id, bool force) {
       throw payload::util::NotFound("delete payload: payload not found; verify payload id");
     }
 
-    const Tier     payload_tier = record->tier;
-    const uint64_t payload_size = record->size_bytes;
+    const Tier        payload_tier = record->tier;
+    const uint64_t    payload_size = record->size_bytes;
+    const std::string content_hash = record->content_hash;
     ThrowIfDbError(repository_->DeletePayload(*tx, payload::util::FromProto(id)), "delete payload");
     tx->Commit();
 
@@ -639,7 +1082,7 @@ void PayloadManager::Delete(const PayloadID& id, bool force) {
     const auto storage_it = storage_.find(payload_tier);
     if (storage_it != storage_.end() && storage_it->second) {
       try {
-        storage_it->second->Remove(id);
+        RemoveStored(*storage_it->second, payload_tier, id, content_hash);
       } catch (const std::exception& e) {
         PAYLOAD_LOG_WARN("delete payload: storage removal failed after DB commit (orphaned storage bytes)",
                          {payload::observability::StringField("payload_id", payload::util::ToString(Key(id))),
@@ -647,66 +1090,60 @@ void PayloadManager::Delete(const PayloadID& id, bool force) {
       }
     }
 
-    {
-      std::unique_lock lock(snapshot_cache_mutex_);
-      snapshot_cache_.erase(Key(id));
-    }
-
-    {
-      std::lock_guard<std::mutex> pins_lock(pins_guard_);
-      pins_.erase(Key(id));
-    }
-
-    {
-      std::lock_guard<std::mutex> lock(no_evict_guard_);
-      no_evict_ids_.erase(Key(id));
-    }
-
-    {
-      std::lock_guard<std::mutex> lock(spill_targets_guard_);
-      spill_targets_.erase(Key(id));
-    }
+    // Clears the pin and eviction hints with the snapshot; the control block
+    // is reclaimed once the tombstone and our Ref are gone.
+    DropSnapshot(key);
 
-    UpdateTierBytes(payload_tier, -static_cast<int64_t>(payload_size));
-    UpdateTierCount(payload_tier, -1);
+    tier_counters_.Add(payload_tier, -static_cast<int64_t>(payload_size), -1);
     if (metadata_cache_) {
       metadata_cache_->Remove(id);
     }
   } // payload_lock released
-
-  // Prune the per-payload mutex now that the payload is fully deleted.
-  {
-    std::lock_guard<std::mutex> guard(payload_mutexes_guard_);
-    payload_mutexes_.erase(Key(id));
-  }
 }
 
 PayloadDescriptor PayloadManager::ResolveSnapshot(const PayloadID& id) {
-  std::shared_lock<std::shared_mutex> payload_lock(*PayloadMutex(id));
+  const auto key = Key(id);
 
-  {
-    std::shared_lock lock(snapshot_cache_mutex_);
-    const auto       cached = snapshot_cache_.find(Key(id));
-    if (cached != snapshot_cache_.end()) {
-      return cached->second;
-    }
+  // Hit path: one shard lock held just long enough to copy the control
+  // block's scalars. Mutations publish all fields under that shard lock, so a
+  // reader never needs the per-payload lock to observe a consistent snapshot.
+  if (auto cached = FindSnapshot(key)) {
+    return std::move(*cached);
+  }
+
+  // Miss path: take the payload lock so a concurrent Delete cannot erase the
+  // entry between our repository read and CacheSnapshot (resurrecting it).
+  auto                              control = controls_.Acquire(key);
+  std::shared_lock<PayloadLockWord> payload_lock(control.lock());
+  if (auto cached = FindSnapshot(key)) {
+    return std::move(*cached);
   }
 
-  // Cache miss path: repository remains the durable backing store.
   auto tx     = repository_->Begin();
   auto record = repository_->GetPayload(*tx, payload::util::FromProto(id));
   if (!record.has_value()) throw payload::util::NotFound("resolve snapshot: payload not found; verify payload id");
   tx->Commit();
 
-  auto descriptor = ToPayloadDescriptor(*record, shm_prefix_);
+  auto descriptor = ToPayloadDescriptor(*record);
   PopulateLocation(&descriptor);
-  CacheSnapshot(descriptor);
+  CacheSnapshot(descriptor, HintsFromRecord(*record));
   return descriptor;
 }
 
+std::optional<uint32_t> PayloadManager::GetChecksum(const PayloadID& id) {
+  auto tx     = repository_->Begin();
+  auto record = repository_->GetPayload(*tx, payload::util::FromProto(id));
+  if (!record.has_value()) throw payload::util::NotFound("get checksum: payload not found; verify payload id");
+  tx->Commit();
+  if (!record->has_checksum) return std::nullopt;
+  return record->checksum_crc32c;
+}
+
 AcquireReadLeaseResponse PayloadManager::AcquireReadLease(const PayloadID& id, Tier min_tier, uint64_t min_duration_ms,
                                                           payload::manager::core::v1::PromotionPolicy promotion_policy) {
-  std::lock_guard<std::mutex> delete_lock(delete_mutex_);
+  if (IsDeleting(Key(id))) {
+    throw payload::util::NotFound("acquire lease: payload is being deleted");
+  }
 
   auto desc = ResolveSnapshot(id);
   if (min_tier != TIER_UNSPECIFIED && PlacementEngine::IsHigherTier(min_tier, desc.tier())) {
@@ -721,17 +1158,19 @@ AcquireReadLeaseResponse PayloadManager::AcquireReadLease(const PayloadID& id, T
   }
   auto lease = lease_mgr_->Acquire(id, desc, min_duration_ms);
 
-  // Post-acquire re-check: verify the payload was not deleted between
-  // ResolveSnapshot and Acquire. Both operations hold delete_mutex_ so a
-  // concurrent Delete cannot slip in, but this guard makes the invariant
-  // explicit and protects against future code paths that may skip the lock.
-  {
-    std::shared_lock cache_lock(snapshot_cache_mutex_);
-    if (snapshot_cache_.find(Key(id)) == snapshot_cache_.end()) {
-      lease_mgr_->Release(lease.lease_id);
-      throw payload::util::NotFound("acquire lease: payload was deleted concurrently");
-    }
+  // Post-acquire re-check. Delete tombstones the payload before invalidating
+  // leases, so either this check observes the tombstone (and we back off), or
+  // our lease was granted first and Delete's InvalidateAll/WaitUntilNoLeases
+  // will see it. A delete that already finished has erased the snapshot.
+  if (IsDeleting(Key(id))) {
+    lease_mgr_->Release(lease.lease_id);
+    throw payload::util::NotFound("acquire lease: payload is being deleted");
   }
+  if (!HasSnapshot(Key(id))) {
+    lease_mgr_->Release(lease.lease_id);
+    throw payload::util::NotFound("acquire lease: payload was deleted concurrently");
+  }
+  Touch(Key(id));
 
   AcquireReadLeaseResponse resp;
   *resp.mutable_payload_descriptor() = desc;
@@ -744,37 +1183,227 @@ void PayloadManager::ReleaseLease(const payload::manager::v1::LeaseID& lease_id)
   lease_mgr_->Release(lease_id);
 }
 
-PayloadDescriptor PayloadManager::Promote(const PayloadID& id, Tier target) {
-  std::lock_guard<std::mutex> delete_lock(delete_mutex_);
+std::vector<PayloadManager::BatchResult> PayloadManager::ResolveSnapshots(const std::vector<PayloadID>& ids) {
+  std::vector<BatchResult> results(ids.size());
+
+  // Hits are served lock-free as in ResolveSnapshot. Misses are grouped by key
+  // (ordered, so duplicates share one read and locks are taken in key order).
+  std::map<payload::util::UUID, std::vector<std::size_t>> misses;
+  for (std::size_t i = 0; i < ids.size(); ++i) {
+    try {
+      const auto key = Key(ids[i]);
+      if (auto cached = FindSnapshot(key)) {
+        results[i].descriptor = std::move(*cached);
+      } else {
+        misses[key].push_back(i);
+      }
+    } catch (...) {
+      results[i].error = std::current_exception();
+    }
+  }
+  if (misses.empty()) {
+    return results;
+  }
+
+  // Miss path: hold every missing payload's lock (shared, in ascending key
+  // order so overlapping batches cannot deadlock) so a concurrent Delete
+  // cannot erase an entry between the repository read and CacheSnapshot.
+  std::vector<PayloadControlTable::Ref>                                 controls;
+  std::vector<std::shared_lock<PayloadLockWord>>                        payload_locks;
+  std::vector<std::pair<payload::util::UUID, db::model::PayloadRecord>> loaded;
+  controls.reserve(misses.size());
+  payload_locks.reserve(misses.size());
+  for (const auto& [key, indices] : misses) {
+    controls.push_back(controls_.Acquire(key));
+    payload_locks.emplace_back(controls.back().lock());
+  }
+
+  try {
+    auto tx = repository_->Begin();
+    for (const auto& [key, indices] : misses) {
+      if (HasSnapshot(key)) {
+        continue; // cached by a writer before we took its lock
+      }
+      auto record = repository_->GetPayload(*tx, key);
+      if (!record.has_value()) {
+        const auto error = std::make_exception_ptr(payload::util::NotFound("resolve snapshot: payload not found; verify payload id"));
+        for (const auto i : indices) results[i].error = error;
+        continue;
+      }
+      loaded.emplace_back(key, std::move(*record));
+    }
+    tx->Commit();
+  } catch (...) {
+    const auto error = std::current_exception();
+    for (const auto& [key, indices] : misses) {
+      for (const auto i : indices) results[i].error = error;
+    }
+    return results;
+  }
+
+  for (const auto& [key, record] : loaded) {
+    try {
+      auto descriptor = ToPayloadDescriptor(record);
+      PopulateLocation(&descriptor);
+      CacheSnapshot(descriptor, HintsFromRecord(record));
+    } catch (...) {
+      const auto error = std::current_exception();
+      for (const auto i : misses[key]) results[i].error = error;
+    }
+  }
+  for (const auto& [key, indices] : misses) {
+    if (results[indices.front()].error) {
+      continue;
+    }
+    auto cached = FindSnapshot(key);
+    for (const auto i : indices) {
+      if (cached) {
+        results[i].descriptor = *cached;
+      } else {
+        results[i].error = std::make_exception_ptr(payload::util::NotFound("resolve snapshot: payload was deleted concurrently"));
+      }
+    }
+  }
+  return results;
+}
+
+std::vector<PayloadManager::LeaseBatchResult> PayloadManager::AcquireReadLeases(const std::vector<LeaseSpec>& specs) {
+  std::vector<LeaseBatchResult> results(specs.size());
+
+  // Items that pass the tombstone pre-check, resolved together.
+  std::vector<std::size_t> candidates;
+  std::vector<PayloadID>   candidate_ids;
+  for (std::size_t i = 0; i < specs.size(); ++i) {
+    try {
+      if (IsDeleting(Key(specs[i].id))) {
+        throw payload::util::NotFound("acquire lease: payload is being deleted");
+      }
+      candidates.push_back(i);
+      candidate_ids.push_back(specs[i].id);
+    } catch (...) {
+      results[i].error = std::current_exception();
+    }
+  }
+  auto resolved = ResolveSnapshots(candidate_ids);
+
+  // Per-item checks mirror AcquireReadLease; promotions take one payload lock
+  // at a time and nothing else is held across them.
+  std::vector<std::size_t>                               granted;
+  std::vector<payload::lease::LeaseManager::AcquireSpec> lease_specs;
+  for (std::size_t c = 0; c < candidates.size(); ++c) {
+    const auto  i    = candidates[c];
+    const auto& spec = specs[i];
+    try {
+      if (!resolved[c].ok()) {
+        std::rethrow_exception(resolved[c].error);
+      }
+      auto desc = std::move(resolved[c].descriptor);
+      if (spec.min_tier != TIER_UNSPECIFIED && PlacementEngine::IsHigherTier(spec.min_tier, desc.tier())) {
+        if (spec.promotion_policy == payload::manager::core::v1::PROMOTION_POLICY_BEST_EFFORT) {
+          throw payload::util::InvalidState(
+              "acquire lease: best-effort promotion cannot satisfy min_tier; lower min_tier or change promotion policy to BLOCKING");
+        }
+        desc = PromoteUnlocked(spec.id, spec.min_tier);
+      }
+      if (!IsReadableState(desc.state())) {
+        throw payload::util::InvalidState("acquire lease: payload is not readable; commit or promote payload before leasing");
+      }
+      granted.push_back(i);
+      lease_specs.push_back({spec.id, std::move(desc), spec.min_duration_ms});
+    } catch (...) {
+      results[i].error = std::current_exception();
+    }
+  }
+  if (granted.empty()) {
+    return results;
+  }
+
+  const auto leases = lease_mgr_->AcquireBatch(lease_specs);
+
+  // Post-acquire re-check, as in AcquireReadLease: a lease granted before a
+  // Delete's tombstone is visible to its InvalidateAll/WaitUntilNoLeases.
+  std::vector<payload::manager::v1::LeaseID> revoked;
+  for (std::size_t g = 0; g < granted.size(); ++g) {
+    const auto  i     = granted[g];
+    const auto& lease = leases[g];
+    const auto  key   = Key(specs[i].id);
+    if (IsDeleting(key)) {
+      revoked.push_back(lease.lease_id);
+      results[i].error = std::make_exception_ptr(payload::util::NotFound("acquire lease: payload is being deleted"));
+      continue;
+    }
+    if (!HasSnapshot(key)) {
+      revoked.push_back(lease.lease_id);
+      results[i].error = std::make_exception_ptr(payload::util::NotFound("acquire lease: payload was deleted concurrently"));
+      continue;
+    }
+    Touch(key);
+
+    auto& resp                         = results[i].response;
+    *resp.mutable_payload_descriptor() = lease.payload_descriptor;
+    *resp.mutable_lease_id()           = lease.lease_id;
+    *resp.mutable_lease_expires_at()   = payload::util::ToProto(lease.expires_at);
+  }
+  if (!revoked.empty()) {
+    lease_mgr_->ReleaseBatch(revoked);
+  }
+  return results;
+}
+
+void PayloadManager::ReleaseLeases(const std::vector<payload::manager::v1::LeaseID>& lease_ids) {
+  lease_mgr_->ReleaseBatch(lease_ids);
+}
 
+PayloadDescriptor PayloadManager::Promote(const PayloadID& id, Tier target) {
   return PromoteUnlocked(id, target);
 }
 
 void PayloadManager::Prefetch(const PayloadID& id, Tier target) {
-  std::lock_guard<std::mutex> delete_lock(delete_mutex_);
   (void)PromoteUnlocked(id, target);
 }
 
 void PayloadManager::Pin(const PayloadID& id, uint64_t duration_ms) {
-  std::lock_guard<std::mutex> delete_lock(delete_mutex_);
+  const auto key = Key(id);
+  if (IsDeleting(key)) {
+    throw payload::util::NotFound("pin payload: payload is being deleted");
+  }
 
   (void)ResolveSnapshot(id);
 
-  std::lock_guard<std::mutex> pins_lock(pins_guard_);
-  PinState                    state;
-  if (duration_ms > 0) {
-    state.expires_at_ms = payload::util::ToUnixMillis(payload::util::Now()) + duration_ms;
+  const uint64_t expires_at_ms = duration_ms > 0 ? payload::util::ToUnixMillis(payload::util::Now()) + duration_ms : 0;
+  bool           pinned        = false;
+  controls_.Update(key, /*create=*/false, [&](PayloadControlBlock& block) {
+    // Delete tombstones the block before dropping the snapshot (and the pin
+    // with it), so checking both under the shard lock means no pin can be
+    // published for a payload that is going away.
+    if (block.tombstones != 0 || (block.flags & PayloadControlBlock::kHasSnapshot) == 0) {
+      return;
+    }
+    block.flags |= PayloadControlBlock::kPinned;
+    block.pin_expires_at_ms = expires_at_ms;
+    pinned                  = true;
+  });
+  if (!pinned) {
+    throw payload::util::NotFound("pin payload: payload was deleted concurrently");
   }
-  pins_[Key(id)] = state;
 }
 
 void PayloadManager::Unpin(const PayloadID& id) {
-  std::lock_guard<std::mutex> pins_lock(pins_guard_);
-  pins_.erase(Key(id));
+  controls_.Update(Key(id), /*create=*/false, [](PayloadControlBlock& block) {
+    block.flags &= static_cast<uint8_t>(~PayloadControlBlock::kPinned);
+    block.pin_expires_at_ms = 0;
+  });
 }
 
 PayloadDescriptor PayloadManager::PromoteUnlocked(const PayloadID& id, Tier target) {
-  std::unique_lock<std::shared_mutex> payload_lock(*PayloadMutex(id));
+  auto                              control = controls_.Acquire(Key(id));
+  std::unique_lock<PayloadLockWord> payload_lock(control.lock());
+
+  // A Delete draining leases on this payload has not taken payload_lock yet;
+  // moving bytes now would strand them under a descriptor that is going away.
+  if (IsDeleting(Key(id))) {
+    throw payload::util::NotFound("promote payload: payload is being deleted");
+  }
 
   auto tx     = repository_->Begin();
   auto record = repository_->GetPayload(*tx, payload::util::FromProto(id));
@@ -800,10 +1429,18 @@ PayloadDescriptor PayloadManager::PromoteUnlocked(const PayloadID& id, Tier targ
       throw payload::util::InvalidState("promote payload: target storage tier is not available");
     }
 
-    auto buffer = src_it->second->Read(id);
-    dst_it->second->Write(id, buffer, /*fsync=*/false);
+    const auto source_codec = StoredCodec(*record);
+    const auto target_codec = TargetCodec(*record, target);
+    const auto copied       = payload::storage::TranscodePayload(*src_it->second, payload::util::ToProto(StoredKey(*record)), *dst_it->second, id,
+                                                                 /*fsync=*/false, source_codec, target_codec, transfer_options_);
+    VerifyChecksum(*dst_it->second, id, *record, copied, "promote payload");
+    RecordTranscode(&*record, source_codec, target_codec, copied);
   }
 
+  // The promoted copy is the payload's own; a shared blob is released below.
+  const std::string source_content_hash = source_tier != target ? record->content_hash : std::string();
+  if (source_tier != target) record->content_hash.clear();
+
   record->tier  = target;
   record->state = IsDurableTier(target) ? PAYLOAD_STATE_DURABLE : PAYLOAD_STATE_ACTIVE;
   record->version++;
@@ -818,7 +1455,7 @@ PayloadDescriptor PayloadManager::PromoteUnlocked(const PayloadID& id, Tier targ
     auto src_it = storage_.find(source_tier);
     if (src_it != storage_.end() && src_it->second) {
       try {
-        src_it->second->Remove(id);
+        RemoveStored(*src_it->second, source_tier, id, source_content_hash);
       } catch (const std::exception& e) {
         PAYLOAD_LOG_WARN("promote: source removal failed after DB commit (orphaned source bytes)",
                          {payload::observability::StringField("payload_id", payload::util::ToString(Key(id))),
@@ -827,14 +1464,12 @@ PayloadDescriptor PayloadManager::PromoteUnlocked(const PayloadID& id, Tier targ
     }
   }
 
-  auto descriptor = ToPayloadDescriptor(*record, shm_prefix_);
+  auto descriptor = ToPayloadDescriptor(*record);
   PopulateLocation(&descriptor);
-  CacheSnapshot(descriptor);
+  CacheSnapshot(descriptor, HintsFromRecord(*record));
   if (source_tier != target) {
-    UpdateTierBytes(source_tier, -static_cast<int64_t>(record->size_bytes));
-    UpdateTierBytes(target, static_cast<int64_t>(record->size_bytes));
-    UpdateTierCount(source_tier, -1);
-    UpdateTierCount(target, 1);
+    tier_counters_.Add(source_tier, -static_cast<int64_t>(record->size_bytes), -1);
+    tier_counters_.Add(target, static_cast<int64_t>(record->size_bytes), 1);
   }
   return descriptor;
 }
@@ -844,26 +1479,16 @@ void PayloadManager::HydrateCaches() {
   const auto records = repository_->ListPayloads(*tx);
   tx->Commit();
 
-  using payload::manager::core::v1::EVICTION_PRIORITY_NEVER;
-
-  std::unordered_set<payload::util::UUID>                    new_no_evict;
-  std::unordered_map<payload::util::UUID, Tier>              new_spill_targets;
   std::unordered_map<payload::util::UUID, PayloadDescriptor> new_snapshot_cache;
 
   for (const auto& record : records) {
-    auto descriptor = ToPayloadDescriptor(record, shm_prefix_);
+    auto descriptor = ToPayloadDescriptor(record);
     try {
       PopulateLocation(&descriptor);
     } catch (const std::exception&) {
       // Ignore hydration failures for missing/evicted bytes; descriptor will be rebuilt on demand.
     }
     new_snapshot_cache[record.id] = descriptor;
-
-    if (record.no_evict || record.eviction_priority == static_cast<int>(EVICTION_PRIORITY_NEVER)) {
-      new_no_evict.insert(record.id);
-    }
-
-    new_spill_targets[record.id] = (record.spill_target != 0) ? static_cast<Tier>(record.spill_target) : TIER_DISK;
   }
 
   // Bump the persisted version for every non-terminal payload so that any
@@ -899,60 +1524,95 @@ void PayloadManager::HydrateCaches() {
     bump_tx->Commit();
   }
 
-  {
-    std::unique_lock lock(snapshot_cache_mutex_);
-    snapshot_cache_ = std::move(new_snapshot_cache);
+  // Publish in place so pins and in-flight delete tombstones survive the
+  // refresh, then drop snapshots for payloads the repository no longer has.
+  for (const auto& record : records) {
+    CacheSnapshot(new_snapshot_cache.at(record.id), HintsFromRecord(record));
   }
-  {
-    std::lock_guard<std::mutex> lock(no_evict_guard_);
-    no_evict_ids_ = std::move(new_no_evict);
+  controls_.ForEachMutable([&](PayloadControlBlock& block) {
+    if (new_snapshot_cache.count(block.id) == 0) {
+      ClearSnapshot(block);
+    }
+  });
+
+  TierCounters::Totals totals;
+  for (const auto& record : records) {
+    const auto slot = static_cast<std::size_t>(record.tier);
+    if (slot < TierCounters::kTierSlots) {
+      totals.bytes[slot] += static_cast<int64_t>(record.size_bytes);
+      totals.count[slot] += 1;
+    }
   }
+  tier_counters_.Reset(totals);
+  ExportTierMetrics();
+}
+
+std::size_t PayloadManager::RestoreFromManifests() {
   {
-    std::lock_guard<std::mutex> lock(spill_targets_guard_);
-    spill_targets_ = std::move(new_spill_targets);
-  }
+    auto       tx    = repository_->Begin();
+    const auto count = repository_->CountPayloads(*tx);
+    tx->Commit();
+    if (count > 0) return 0;
+  }
+
+  std::unordered_set<payload::util::UUID> restored;
+  auto                                    tx = repository_->Begin();
+  for (const auto tier : {TIER_DISK, TIER_OBJECT}) {
+    const auto it = storage_.find(tier);
+    if (it == storage_.end() || !it->second) continue;
+    for (const auto& meta : it->second->ReadManifest()) {
+      db::model::PayloadRecord record;
+      record.id = payload::util::FromProto(meta.uuid());
+      if (restored.count(record.id) > 0) continue;
+      record.tier    = tier;
+      record.state   = PAYLOAD_STATE_DURABLE;
+      record.version = meta.payload_descriptor().version();
+      if (const auto tag = meta.tags().find(kContentHashTag); tag != meta.tags().end()) record.content_hash = tag->second;
+      const auto& compression = meta.compression();
+      if (const auto codec = payload::storage::FromArchiveCompression(compression.type()); payload::storage::IsCompressed(codec)) {
+        record.stored_codec = static_cast<int>(codec);
+      }
+      const auto& integrity = meta.integrity();
+      if (integrity.algorithm() == payload::manager::catalog::v1::HASH_CRC32C && integrity.checksum().size() == 4) {
+        for (const char byte : integrity.checksum()) record.checksum_crc32c = (record.checksum_crc32c << 8) | static_cast<uint8_t>(byte);
+        record.has_checksum = true;
+      }
 
-  // Register all active payloads in the metadata cache so they are candidates
-  // for LRU-based tier eviction even if UpsertMetadata was never called.
-  if (metadata_cache_) {
-    for (const auto& record : records) {
-      if (record.state == PAYLOAD_STATE_ACTIVE || record.state == PAYLOAD_STATE_DURABLE) {
-        payload::manager::v1::PayloadID       id = payload::util::ToProto(record.id);
-        payload::manager::v1::PayloadMetadata minimal;
-        *minimal.mutable_id() = id;
-        metadata_cache_->Put(id, minimal);
+      uint64_t stored_bytes = 0;
+      try {
+        stored_bytes = it->second->Size(payload::util::ToProto(StoredKey(record)));
+      } catch (const std::exception& e) {
+        PAYLOAD_LOG_WARN("restore: manifest lists a payload whose bytes are gone; skipped",
+                         {payload::observability::StringField("payload_id", payload::util::ToString(record.id)),
+                          payload::observability::StringField("tier", TierName(tier)), payload::observability::StringField("error", e.what())});
+        continue;
+      }
+      if (payload::storage::IsCompressed(StoredCodec(record))) {
+        record.size_bytes        = compression.uncompressed_size_bytes();
+        record.stored_size_bytes = stored_bytes;
+      } else {
+        record.size_bytes = stored_bytes;
+      }
+
+      if (const auto inserted = repository_->InsertPayload(*tx, record); !inserted) {
+        throw std::runtime_error("restore from manifests: insert " + payload::util::ToString(record.id) + ": " + inserted.message);
       }
+      restored.insert(record.id);
     }
   }
+  tx->Commit();
 
-  std::unordered_map<int, uint64_t> new_tier_bytes;
-  std::unordered_map<int, uint64_t> new_tier_count;
-  for (const auto& record : records) {
-    new_tier_bytes[static_cast<int>(record.tier)] += record.size_bytes;
-    new_tier_count[static_cast<int>(record.tier)] += 1;
-  }
-  std::unordered_map<int, uint64_t> tier_snapshot;
-  {
-    std::lock_guard<std::mutex> lock(tier_bytes_guard_);
-    tier_bytes_   = std::move(new_tier_bytes);
-    tier_snapshot = tier_bytes_;
-  }
-  std::unordered_map<int, uint64_t> count_snapshot;
-  {
-    std::lock_guard<std::mutex> lock(tier_count_guard_);
-    tier_count_    = std::move(new_tier_count);
-    count_snapshot = tier_count_;
-  }
-  for (const auto& [tier_int, bytes] : tier_snapshot) {
-    payload::observability::Metrics::Instance().SetTierOccupancyBytes(TierName(static_cast<Tier>(tier_int)), bytes);
-  }
-  for (const auto& [tier_int, count] : count_snapshot) {
-    payload::observability::Metrics::Instance().SetTierPayloadCount(TierName(static_cast<Tier>(tier_int)), count);
+  if (!restored.empty()) {
+    PAYLOAD_LOG_WARN("startup: repository was empty; restored payload records from durable-tier manifests",
+                     {payload::observability::IntField("payloads", static_cast<int64_t>(restored.size()))});
   }
+  return restored.size();
 }
 
 void PayloadManager::ExecuteSpill(const PayloadID& id, Tier target, bool fsync) {
-  std::unique_lock<std::shared_mutex> payload_lock(*PayloadMutex(id));
+  const auto                        key     = Key(id);
+  auto                              control = controls_.Acquire(key);
+  std::unique_lock<PayloadLockWord> payload_lock(control.lock());
 
   // Read record and validate inside Phase 1 transaction.
   auto tx1    = repository_->Begin();
@@ -962,7 +1622,9 @@ void PayloadManager::ExecuteSpill(const PayloadID& id, Tier target, bool fsync)
     throw payload::util::InvalidState("spill payload: payload is deleted and cannot be spilled");
   }
 
-  const Tier source_tier = record->tier;
+  const Tier        source_tier         = record->tier;
+  const std::string source_content_hash = record->content_hash;
+  const auto        source_id           = payload::util::ToProto(StoredKey(*record));
 
   // Enforce require_durable: if set, only allow spill to a durable tier.
   if (record->require_durable && !IsDurableTier(target)) {
@@ -978,9 +1640,11 @@ void PayloadManager::ExecuteSpill(const PayloadID& id, Tier target, bool fsync)
     }
   }
 
-  {
-    std::lock_guard<std::mutex> pins_lock(pins_guard_);
-    if (source_tier != target && IsPinnedLocked(Key(id), payload::util::ToUnixMillis(payload::util::Now()))) {
+  if (source_tier != target) {
+    const uint64_t now_ms = payload::util::ToUnixMillis(payload::util::Now());
+    bool           pinned = false;
+    controls_.Read(key, [&](const PayloadControlBlock& block) { pinned = IsPinnedAt(block, now_ms); });
+    if (pinned) {
       throw payload::util::LeaseConflict("spill payload: payload is pinned; unpin or wait for pin expiry before spilling");
     }
   }
@@ -1001,7 +1665,7 @@ void PayloadManager::ExecuteSpill(const PayloadID& id, Tier target, bool fsync)
       auto src_it = storage_.find(source_tier);
       if (src_it != storage_.end() && src_it->second) {
         try {
-          src_it->second->Remove(id);
+          RemoveStored(*src_it->second, source_tier, id, record->content_hash);
         } catch (const std::exception& e) {
           PAYLOAD_LOG_WARN("spill void: source removal failed after DB commit (orphaned source bytes)",
                            {payload::observability::StringField("payload_id", payload::util::ToString(Key(id))),
@@ -1009,26 +1673,10 @@ void PayloadManager::ExecuteSpill(const PayloadID& id, Tier target, bool fsync)
         }
       }
 
-      {
-        std::unique_lock lock(snapshot_cache_mutex_);
-        snapshot_cache_.erase(Key(id));
-      }
-      {
-        std::lock_guard<std::mutex> pins_lock(pins_guard_);
-        pins_.erase(Key(id));
-      }
-      {
-        std::lock_guard<std::mutex> lock(no_evict_guard_);
-        no_evict_ids_.erase(Key(id));
-      }
-      {
-        std::lock_guard<std::mutex> lock(spill_targets_guard_);
-        spill_targets_.erase(Key(id));
-      }
+      DropSnapshot(key);
 
       payload::observability::Metrics::Instance().RecordSpillBytes("background", record->size_bytes);
-      UpdateTierBytes(source_tier, -static_cast<int64_t>(record->size_bytes));
-      UpdateTierCount(source_tier, -1);
+      tier_counters_.Add(source_tier, -static_cast<int64_t>(record->size_bytes), -1);
       if (metadata_cache_) {
         metadata_cache_->Remove(id);
       }
@@ -1050,15 +1698,47 @@ void PayloadManager::ExecuteSpill(const PayloadID& id, Tier target, bool fsync)
     ThrowIfDbError(repository_->UpdatePayload(*tx1, *record), "spill payload: phase 1");
     tx1->Commit();
     {
-      auto spilling_descriptor = ToPayloadDescriptor(*record, shm_prefix_);
+      auto spilling_descriptor = ToPayloadDescriptor(*record);
       PopulateLocation(&spilling_descriptor);
-      CacheSnapshot(spilling_descriptor);
+      CacheSnapshot(spilling_descriptor, HintsFromRecord(*record));
     }
 
-    // --- Copy bytes; revert to ACTIVE/DURABLE on failure ---
+    // --- Copy bytes (kernel-side or chunked where the tiers allow, compressed for the target); revert to ACTIVE/DURABLE on failure ---
+    // With dedup, bytes already stored on the target under the same content
+    // key are not copied again; the content lock is held until phase 2 has
+    // committed, so a concurrent spill or release of that key sees the result.
+    const auto                              source_codec = StoredCodec(*record);
+    const auto                              target_codec = TargetCodec(*record, target);
+    payload::storage::TranscodeResult       copied;
+    PayloadControlTable::Ref                content_control;
+    std::unique_lock<PayloadLockWord>       content_lock;
+    std::optional<db::model::PayloadRecord> stored;
+    std::string                             content_hash;
     try {
-      auto buffer = src_it->second->Read(id);
-      dst_it->second->Write(id, buffer, fsync);
+      content_hash = ContentHashFor(*record, *src_it->second, target);
+      if (!content_hash.empty()) {
+        content_control = controls_.Acquire(payload::util::FromString(content_hash));
+        content_lock    = std::unique_lock<PayloadLockWord>(content_control.lock());
+        auto lookup_tx  = repository_->Begin();
+        stored          = repository_->FindContentReference(*lookup_tx, content_hash, target);
+        lookup_tx->Commit();
+        dedup_lookups_.fetch_add(1, std::memory_order_relaxed);
+        if (stored && !SameContent(*stored, *record)) {
+          // Same key, different bytes: keep this payload's own copy rather than touch the blob.
+          PAYLOAD_LOG_WARN("spill: content key matches a stored blob with different size or checksum; not deduplicating",
+                           {payload::observability::StringField("payload_id", payload::util::ToString(key)),
+                            payload::observability::StringField("content_hash", content_hash)});
+          stored.reset();
+          content_hash.clear();
+          content_lock.unlock();
+        }
+      }
+      if (!stored) {
+        const auto target_id = content_hash.empty() ? id : payload::util::ToProto(payload::util::FromString(content_hash));
+        copied = payload::storage::TranscodePayload(*src_it->second, source_id, *dst_it->second, target_id, fsync, source_codec, target_codec,
+                                                    transfer_options_);
+        VerifyChecksum(*dst_it->second, target_id, *record, copied, "spill payload");
+      }
     } catch (...) {
       try {
         auto tx_revert  = repository_->Begin();
@@ -1068,9 +1748,9 @@ void PayloadManager::ExecuteSpill(const PayloadID& id, Tier target, bool fsync)
           revert_rec->version++;
           repository_->UpdatePayload(*tx_revert, *revert_rec);
           tx_revert->Commit();
-          auto reverted_descriptor = ToPayloadDescriptor(*revert_rec, shm_prefix_);
+          auto reverted_descriptor = ToPayloadDescriptor(*revert_rec);
           PopulateLocation(&reverted_descriptor);
-          CacheSnapshot(reverted_descriptor);
+          CacheSnapshot(reverted_descriptor, HintsFromRecord(*revert_rec));
         }
       } catch (const std::exception& revert_err) {
         PAYLOAD_LOG_WARN("spill: failed to revert SPILLING state after copy failure",
@@ -1086,8 +1766,20 @@ void PayloadManager::ExecuteSpill(const PayloadID& id, Tier target, bool fsync)
     record->tier  = target;
     record->state = IsDurableTier(target) ? PAYLOAD_STATE_DURABLE : PAYLOAD_STATE_ACTIVE;
     record->version++;
+    if (stored) {
+      record->stored_codec      = stored->stored_codec;
+      record->stored_size_bytes = stored->stored_size_bytes;
+      if (!record->has_checksum && stored->has_checksum) {
+        record->checksum_crc32c = stored->checksum_crc32c;
+        record->has_checksum    = true;
+      }
+    } else {
+      RecordTranscode(&*record, source_codec, target_codec, copied);
+    }
+    record->content_hash = content_hash;
     ThrowIfDbError(repository_->UpdatePayload(*tx2, *record), "spill payload: phase 2");
     tx2->Commit();
+    if (stored) dedup_hits_.fetch_add(1, std::memory_order_relaxed);
   } else {
     // No-op tier change: just commit without altering state.
     tx1->Commit();
@@ -1100,7 +1792,7 @@ void PayloadManager::ExecuteSpill(const PayloadID& id, Tier target, bool fsync)
     auto src_it = storage_.find(source_tier);
     if (src_it != storage_.end() && src_it->second) {
       try {
-        src_it->second->Remove(id);
+        RemoveStored(*src_it->second, source_tier, id, source_content_hash);
       } catch (const std::exception& e) {
         PAYLOAD_LOG_WARN("spill: source removal failed after DB commit (orphaned source bytes)",
                          {payload::observability::StringField("payload_id", payload::util::ToString(Key(id))),
@@ -1109,15 +1801,30 @@ void PayloadManager::ExecuteSpill(const PayloadID& id, Tier target, bool fsync)
     }
   }
 
-  auto descriptor = ToPayloadDescriptor(*record, shm_prefix_);
+  auto descriptor = ToPayloadDescriptor(*record);
   PopulateLocation(&descriptor);
-  CacheSnapshot(descriptor);
+  CacheSnapshot(descriptor, HintsFromRecord(*record));
   // Write sidecar after a successful spill to a durable tier.
   if (source_tier != target && IsDurableTier(target)) {
     const auto dst_it = storage_.find(target);
     if (dst_it != storage_.end() && dst_it->second) {
       try {
-        dst_it->second->WriteSidecar(id, BuildSidecar(descriptor));
+        auto sidecar = BuildSidecar(descriptor);
+        if (payload::storage::IsCompressed(StoredCodec(*record))) {
+          auto* compression = sidecar.mutable_compression();
+          compression->set_type(payload::storage::ToArchiveCompression(StoredCodec(*record)));
+          compression->set_uncompressed_size_bytes(record->size_bytes);
+          compression->set_compressed_size_bytes(record->stored_size_bytes);
+        }
+        if (record->has_checksum) {
+          const uint32_t crc = record->checksum_crc32c;
+          const char     big_endian[4] = {static_cast<char>(crc >> 24), static_cast<char>(crc >> 16), static_cast<char>(crc >> 8),
+                                          static_cast<char>(crc)};
+          sidecar.mutable_integrity()->set_algorithm(payload::manager::catalog::v1::HASH_CRC32C);
+          sidecar.mutable_integrity()->set_checksum(std::string(big_endian, sizeof(big_endian)));
+        }
+        if (!record->content_hash.empty()) (*sidecar.mutable_tags())[kContentHashTag] = record->content_hash;
+        dst_it->second->WriteSidecar(id, sidecar);
       } catch (const std::exception& e) {
         PAYLOAD_LOG_WARN("spill: sidecar write failed (non-fatal)",
                          {payload::observability::StringField("payload_id", payload::util::ToString(Key(id))),
@@ -1127,38 +1834,142 @@ void PayloadManager::ExecuteSpill(const PayloadID& id, Tier target, bool fsync)
   }
   if (source_tier != target) {
     payload::observability::Metrics::Instance().RecordSpillBytes("background", record->size_bytes);
-    UpdateTierBytes(source_tier, -static_cast<int64_t>(record->size_bytes));
-    UpdateTierBytes(target, static_cast<int64_t>(record->size_bytes));
-    UpdateTierCount(source_tier, -1);
-    UpdateTierCount(target, 1);
+    tier_counters_.Add(source_tier, -static_cast<int64_t>(record->size_bytes), -1);
+    tier_counters_.Add(target, static_cast<int64_t>(record->size_bytes), 1);
+  }
+}
+
+std::string PayloadManager::ContentHashFor(const db::model::PayloadRecord& record, payload::storage::StorageBackend& source, Tier target) const {
+  if (!dedup_options_.enabled || !IsDurableTier(target) || record.size_bytes < dedup_options_.min_bytes) {
+    return {};
+  }
+  // A payload moving between durable tiers keeps the key it was spilled under.
+  if (!record.content_hash.empty()) {
+    return record.content_hash;
+  }
+  // Only RAM is hashed: its bytes are mapped already, so the key costs one
+  // pass at memory bandwidth rather than an extra read of a durable copy.
+  if (record.tier != TIER_RAM) {
+    return {};
+  }
+  const auto bytes = source.Read(payload::util::ToProto(record.id));
+  return payload::util::ToString(payload::storage::ContentKey(bytes->data(), static_cast<uint64_t>(bytes->size())));
+}
+
+void PayloadManager::ReleaseContent(Tier tier, const std::string& content_hash) {
+  const auto                        blob    = payload::util::FromString(content_hash);
+  auto                              control = controls_.Acquire(blob);
+  std::unique_lock<PayloadLockWord> content_lock(control.lock());
+
+  auto       tx         = repository_->Begin();
+  const bool referenced = repository_->FindContentReference(*tx, content_hash, tier).has_value();
+  tx->Commit();
+  if (referenced) {
+    return;
   }
+  const auto storage_it = storage_.find(tier);
+  if (storage_it != storage_.end() && storage_it->second) {
+    storage_it->second->Remove(payload::util::ToProto(blob));
+  }
+}
+
+void PayloadManager::RemoveStored(payload::storage::StorageBackend& backend, Tier tier, const PayloadID& id, const std::string& content_hash) {
+  if (content_hash.empty()) {
+    backend.Remove(id);
+    return;
+  }
+  backend.RemoveSidecar(id);
+  ReleaseContent(tier, content_hash);
 }
 
 std::unordered_map<int, uint64_t> PayloadManager::GetTierBytes() const {
-  std::lock_guard<std::mutex> lock(tier_bytes_guard_);
-  return tier_bytes_;
+  const auto                        totals = tier_counters_.Read();
+  std::unordered_map<int, uint64_t> result;
+  for (std::size_t slot = 1; slot < TierCounters::kTierSlots; ++slot) {
+    result[static_cast<int>(slot)] = static_cast<uint64_t>(std::max<int64_t>(totals.bytes[slot], 0));
+  }
+  return result;
+}
+
+uint64_t PayloadManager::GetTierBytes(Tier tier) const {
+  return static_cast<uint64_t>(std::max<int64_t>(tier_counters_.Bytes(tier), 0));
+}
+
+std::vector<payload::storage::RamNodeUsage> PayloadManager::GetRamNodeUsage() const {
+  return ram_store_ ? ram_store_->NodeUsage() : std::vector<payload::storage::RamNodeUsage>{};
+}
+
+std::vector<payload::storage::DiskDeviceUsage> PayloadManager::GetDiskDeviceUsage() const {
+  return disk_devices_ ? disk_devices_->DeviceUsage() : std::vector<payload::storage::DiskDeviceUsage>{};
+}
+
+std::optional<uint32_t> PayloadManager::GetRamNumaNode(const PayloadID& id) const {
+  return ram_store_ ? ram_store_->NumaNode(id) : std::nullopt;
 }
 
 bool PayloadManager::IsEvictionExempt(const PayloadID& id) const {
-  std::lock_guard<std::mutex> lock(no_evict_guard_);
-  return no_evict_ids_.count(Key(id)) > 0;
+  bool exempt = false;
+  controls_.Read(Key(id), [&](const PayloadControlBlock& block) { exempt = (block.flags & PayloadControlBlock::kNoEvict) != 0; });
+  return exempt;
 }
 
 Tier PayloadManager::GetSpillTarget(const PayloadID& id) const {
-  std::lock_guard<std::mutex> lock(spill_targets_guard_);
-  const auto                  it = spill_targets_.find(Key(id));
-  return (it != spill_targets_.end()) ? it->second : TIER_DISK;
+  Tier target = TIER_DISK;
+  controls_.Read(Key(id), [&](const PayloadControlBlock& block) {
+    if (block.spill_target != 0) {
+      target = static_cast<Tier>(block.spill_target);
+    }
+  });
+  return target;
 }
 
 Tier PayloadManager::GetDiskSpillTarget(const PayloadID& id) const {
-  std::lock_guard<std::mutex> lock(spill_targets_guard_);
-  const auto                  it = spill_targets_.find(Key(id));
   // Honor explicit TIER_VOID overrides; all other cases fall through to TIER_OBJECT
   // since TIER_OBJECT is the only tier below TIER_DISK in the chain.
-  if (it != spill_targets_.end() && it->second == TIER_VOID) {
-    return TIER_VOID;
+  return GetSpillTarget(id) == TIER_VOID ? TIER_VOID : TIER_OBJECT;
+}
+
+std::optional<PayloadID> PayloadManager::LeastRecentlyUsed(Tier tier, const std::function<bool(const PayloadID&)>& include) const {
+  // Sampled LRU: the control table's sweep hand collects the next
+  // kVictimSample candidates and the oldest of them that include accepts
+  // wins, so a tiering tick costs about the same however many payloads
+  // there are. The sweep moves on only when include rejects a whole
+  // sample, and gives up after visiting every slot once.
+  constexpr std::size_t kVictimSample = 16;
+
+  const uint64_t    now_ms = payload::util::ToUnixMillis(payload::util::Now());
+  const std::size_t slots  = controls_.Capacity();
+
+  std::vector<std::pair<uint64_t, payload::util::UUID>> sample;
+  sample.reserve(kVictimSample);
+  for (std::size_t visited = 0; visited < slots;) {
+    sample.clear();
+    visited += controls_.Sweep([&](const PayloadControlBlock& block) {
+      if ((block.flags & PayloadControlBlock::kHasSnapshot) == 0 || (block.flags & PayloadControlBlock::kNoEvict) != 0 || block.tombstones != 0) {
+        return true;
+      }
+      if (block.tier != static_cast<uint8_t>(tier) || IsPinnedAt(block, now_ms)) {
+        return true;
+      }
+      if (block.state != PAYLOAD_STATE_ACTIVE && block.state != PAYLOAD_STATE_DURABLE) {
+        return true;
+      }
+      sample.emplace_back(block.last_access.load(std::memory_order_relaxed), block.id);
+      return sample.size() < kVictimSample;
+    });
+
+    std::sort(sample.begin(), sample.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    for (const auto& [last_access, key] : sample) {
+      auto id = payload::util::ToProto(key);
+      if (!include || include(id)) {
+        return id;
+      }
+    }
+    if (sample.size() < kVictimSample) {
+      break; // the sweep went all the way round
+    }
   }
-  return TIER_OBJECT;
+  return std::nullopt;
 }
 
 } // namespace payload::core
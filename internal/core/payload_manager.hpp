@@ -1,15 +1,20 @@
 #pragma once
 
+#include <atomic>
+#include <exception>
+#include <functional>
 #include <memory>
-#include <mutex>
 #include <optional>
 #include <shared_mutex>
 #include <string>
 #include <unordered_map>
-#include <unordered_set>
+#include <vector>
 
+#include "internal/core/payload_control_block.hpp"
+#include "internal/core/tier_counters.hpp"
 #include "internal/db/api/repository.hpp"
 #include "internal/metadata/metadata_cache.hpp"
+#include "internal/storage/payload_transfer.hpp"
 #include "internal/storage/storage_factory.hpp"
 #include "internal/util/uuid.hpp"
 #include "payload/manager/core/v1/id.pb.h"
@@ -27,6 +32,14 @@ namespace payload::metadata {
 class MetadataCache;
 }
 
+namespace payload::storage {
+class RamArrowStore;
+struct RamNodeUsage;
+struct RamPlacement;
+class StripedDiskStore;
+struct DiskDeviceUsage;
+}
+
 namespace payload::core {
 
 class PayloadManager {
@@ -34,12 +47,44 @@ class PayloadManager {
   PayloadManager(payload::storage::StorageFactory::TierMap storage, std::shared_ptr<payload::lease::LeaseManager> lease_mgr,
                  std::shared_ptr<payload::db::Repository> repository, std::shared_ptr<payload::metadata::MetadataCache> metadata_cache = nullptr);
 
+  // Arguments for one Allocate call; the element type of AllocateBatch.
+  struct AllocateSpec {
+    uint64_t                                   size_bytes{0};
+    payload::manager::v1::Tier                 preferred{payload::manager::v1::TIER_RAM};
+    uint64_t                                   ttl_ms{0};
+    bool                                       no_evict{false};
+    payload::manager::core::v1::EvictionPolicy eviction_policy;
+    std::optional<uint32_t>                    numa_node; // TIER_RAM placement hint
+  };
+
+  // Outcome of one batch item: the descriptor on success, otherwise the
+  // exception the single-item call would have thrown.
+  struct BatchResult {
+    payload::manager::v1::PayloadDescriptor descriptor;
+    std::exception_ptr                      error;
+
+    bool ok() const {
+      return !error;
+    }
+  };
+
   payload::manager::v1::PayloadDescriptor Allocate(uint64_t size_bytes, payload::manager::v1::Tier preferred, uint64_t ttl_ms = 0,
-                                                   bool no_evict = false, const payload::manager::core::v1::EvictionPolicy& eviction_policy = {});
+                                                   bool no_evict = false, const payload::manager::core::v1::EvictionPolicy& eviction_policy = {},
+                                                   std::optional<uint32_t> numa_node = std::nullopt);
   void                                    ExpireStale();
   payload::manager::v1::PayloadDescriptor Commit(const payload::manager::v1::PayloadID& id);
   void                                    Delete(const payload::manager::v1::PayloadID& id, bool force);
 
+  // Batch forms of Allocate and Commit. All items share one repository
+  // transaction; results[i] corresponds to the i-th input. An item that fails
+  // validation, storage allocation or its own repository write is reported
+  // without affecting the others: each item's writes run under a savepoint
+  // that is rolled back when the item fails. If the transaction itself fails
+  // to commit, or a savepoint cannot be rolled back, every remaining item
+  // fails and allocated storage is released.
+  std::vector<BatchResult> AllocateBatch(const std::vector<AllocateSpec>& items);
+  std::vector<BatchResult> CommitBatch(const std::vector<payload::manager::v1::PayloadID>& ids);
+
   // Returns the upload URI for a TIER_OBJECT payload (e.g. "s3://bucket/prefix/<uuid>.bin").
   // Empty string when no object store is configured.
   std::string GetObjectUploadPath(const payload::manager::v1::PayloadID& id) const;
@@ -57,14 +102,93 @@ class PayloadManager {
 
   // Returns a snapshot of per-tier byte totals (keyed by Tier enum int value).
   std::unordered_map<int, uint64_t> GetTierBytes() const;
+  // Byte total for a single tier; cheaper than the map form for periodic polling.
+  uint64_t GetTierBytes(payload::manager::v1::Tier tier) const;
+
+  // Per-NUMA-node RAM usage; empty when the RAM tier is not split across nodes.
+  std::vector<payload::storage::RamNodeUsage> GetRamNodeUsage() const;
+  // NUMA node a RAM-resident payload is bound to, if any.
+  std::optional<uint32_t> GetRamNumaNode(const payload::manager::v1::PayloadID& id) const;
+  // Per-root disk occupancy and traffic; empty unless the disk tier is striped over roots.
+  std::vector<payload::storage::DiskDeviceUsage> GetDiskDeviceUsage() const;
+
+  // Publishes per-tier occupancy gauges, RAM slab and disk root usage. Accounting
+  // updates never touch Metrics inline; a periodic caller (TieringManager)
+  // exports them instead.
+  void ExportTierMetrics() const;
+
+  // Chunk size, depth and checksumming for spill / promotion copies (CopyPayload).
+  void SetTransferOptions(const payload::storage::TransferOptions& options);
+  // Codec for payloads moved onto a durable tier whose eviction policy does
+  // not name one; tiers without an entry store raw bytes.
+  void SetTierCodec(payload::manager::v1::Tier tier, payload::manager::v1::PayloadCodec codec);
+
+  // Content dedup on durable tiers: payloads of at least min_bytes spilled
+  // from RAM are keyed by a hash of their bytes, and payloads with equal
+  // keys share one stored blob, removed with its last referencing payload.
+  struct DedupOptions {
+    bool     enabled{false};
+    uint64_t min_bytes{0};
+  };
+  void SetDedupOptions(const DedupOptions& options);
+
+  // Spills that looked up a content key, and those that found a stored blob.
+  struct DedupCounters {
+    uint64_t lookups{0};
+    uint64_t hits{0};
+  };
+  DedupCounters GetDedupCounters() const;
 
   payload::manager::v1::PayloadDescriptor        ResolveSnapshot(const payload::manager::v1::PayloadID& id);
   payload::manager::v1::AcquireReadLeaseResponse AcquireReadLease(
       const payload::manager::v1::PayloadID& id, payload::manager::v1::Tier min_tier, uint64_t min_duration_ms,
       payload::manager::core::v1::PromotionPolicy promotion_policy = payload::manager::core::v1::PROMOTION_POLICY_UNSPECIFIED);
+  // CRC32C recorded for the payload's bytes, or nullopt before its first
+  // checksummed spill. Reads the repository (not held in the control block).
+  std::optional<uint32_t> GetChecksum(const payload::manager::v1::PayloadID& id);
+
+  // Arguments for one AcquireReadLease call; the element type of AcquireReadLeases.
+  struct LeaseSpec {
+    payload::manager::v1::PayloadID             id;
+    payload::manager::v1::Tier                  min_tier{payload::manager::v1::TIER_UNSPECIFIED};
+    uint64_t                                    min_duration_ms{0};
+    payload::manager::core::v1::PromotionPolicy promotion_policy{payload::manager::core::v1::PROMOTION_POLICY_UNSPECIFIED};
+  };
+
+  struct LeaseBatchResult {
+    payload::manager::v1::AcquireReadLeaseResponse response;
+    std::exception_ptr                             error;
+
+    bool ok() const {
+      return !error;
+    }
+  };
+
+  // Batch forms of ResolveSnapshot / AcquireReadLease / ReleaseLease; results[i]
+  // corresponds to the i-th input and items fail independently. Cache misses
+  // are locked in payload-key order and read in one repository transaction,
+  // and the lease table is locked once per batch.
+  std::vector<BatchResult>      ResolveSnapshots(const std::vector<payload::manager::v1::PayloadID>& ids);
+  std::vector<LeaseBatchResult> AcquireReadLeases(const std::vector<LeaseSpec>& specs);
+  void                          ReleaseLeases(const std::vector<payload::manager::v1::LeaseID>& lease_ids);
 
   void HydrateCaches();
 
+  // Rebuilds repository rows from the durable tiers' manifest segments
+  // when the repository is empty (a fresh database over tiers that kept
+  // their bytes). Each listed payload whose bytes are still on the tier is
+  // restored as DURABLE there, DISK before OBJECT; entries whose bytes are
+  // gone are skipped. Call before HydrateCaches(). Returns the rows added.
+  std::size_t RestoreFromManifests();
+
+  // Least recently accessed payload on `tier` that is not eviction-exempt or
+  // pinned and for which include(id) returns true, chosen from a sample of
+  // candidates the control table's sweep hand collects rather than from
+  // every payload. include runs without any PayloadManager lock held, so it
+  // may call back into the manager.
+  std::optional<payload::manager::v1::PayloadID> LeastRecentlyUsed(
+      payload::manager::v1::Tier tier, const std::function<bool(const payload::manager::v1::PayloadID&)>& include = {}) const;
+
   void                                    ReleaseLease(const payload::manager::v1::LeaseID& lease_id);
   payload::manager::v1::PayloadDescriptor Promote(const payload::manager::v1::PayloadID& id, payload::manager::v1::Tier target);
   void                                    ExecuteSpill(const payload::manager::v1::PayloadID& id, payload::manager::v1::Tier target, bool fsync);
@@ -75,58 +199,114 @@ class PayloadManager {
  private:
   static payload::util::UUID Key(const payload::manager::v1::PayloadID& id);
 
-  void                                    CacheSnapshot(const payload::manager::v1::PayloadDescriptor& descriptor);
-  void                                    PopulateLocation(payload::manager::v1::PayloadDescriptor* descriptor);
-  payload::manager::v1::PayloadDescriptor PromoteUnlocked(const payload::manager::v1::PayloadID& id, payload::manager::v1::Tier target);
-  std::shared_ptr<std::shared_mutex>      PayloadMutex(const payload::manager::v1::PayloadID& id);
+  // Per-payload eviction settings carried alongside a snapshot.
+  struct EvictionHints {
+    bool                       no_evict{false};
+    payload::manager::v1::Tier spill_target{payload::manager::v1::TIER_DISK};
+  };
 
-  payload::storage::StorageFactory::TierMap         storage_;
-  std::shared_ptr<payload::lease::LeaseManager>     lease_mgr_;
-  std::shared_ptr<payload::db::Repository>          repository_;
-  std::shared_ptr<payload::metadata::MetadataCache> metadata_cache_;
-  std::string                                       shm_prefix_{"pm"};
+  static EvictionHints HintsFromRecord(const payload::db::model::PayloadRecord& record);
 
-  // Serializes Delete with AcquireReadLease to prevent TOCTOU on lease checks.
-  mutable std::mutex delete_mutex_;
+  using TierCodecs = std::unordered_map<payload::manager::v1::Tier, payload::manager::v1::PayloadCodec>;
 
-  // Snapshot cache consistency model:
-  // - ResolveSnapshot first serves reads from this cache.
-  // - Repository reads are only used on cache misses and during explicit refresh (HydrateCaches).
-  // - Mutations routed through PayloadManager (Allocate/Commit/Promote/Delete) refresh or invalidate
-  //   cache entries synchronously with successful transaction commits.
-  // - Out-of-band repository writes can be stale until HydrateCaches() is called.
-  mutable std::shared_mutex                                                        snapshot_cache_mutex_;
-  std::unordered_map<payload::util::UUID, payload::manager::v1::PayloadDescriptor> snapshot_cache_;
+  // Allocate split around the repository insert so AllocateBatch can share one
+  // transaction: Prepare validates and reserves storage, Rollback releases it
+  // if the insert does not commit, Publish caches the snapshot and accounts it.
+  struct PreparedAllocation {
+    payload::manager::v1::PayloadDescriptor descriptor;
+    payload::db::model::PayloadRecord       record;
+    EvictionHints                           hints;
+  };
 
-  mutable std::mutex                                                                  payload_mutexes_guard_;
-  mutable std::unordered_map<payload::util::UUID, std::shared_ptr<std::shared_mutex>> payload_mutexes_;
+  PreparedAllocation                      PrepareAllocation(const AllocateSpec& spec);
+  void                                    RollbackAllocation(const PreparedAllocation& prepared);
+  void                                    PublishAllocation(const PreparedAllocation& prepared);
+  payload::db::model::PayloadRecord       StageCommit(payload::db::Transaction& tx, const payload::util::UUID& key);
+  payload::manager::v1::PayloadDescriptor PublishCommit(const payload::manager::v1::PayloadID&                id,
+                                                        const payload::db::model::PayloadRecord&              record,
+                                                        const std::vector<payload::db::model::LineageRecord>& parents);
 
-  struct PinState {
-    std::optional<uint64_t> expires_at_ms;
-  };
+  void                                    CacheSnapshot(const payload::manager::v1::PayloadDescriptor& descriptor, const EvictionHints& hints);
+  void                                    PopulateLocation(payload::manager::v1::PayloadDescriptor* descriptor);
+  payload::manager::v1::RamLocation       LocateRam(const payload::manager::v1::PayloadID& id, uint64_t length_bytes) const;
+  // LocateRam() from the placement cached with the snapshot; takes no store lock.
+  payload::manager::v1::RamLocation       LocateRam(const payload::manager::v1::PayloadID& id, uint64_t length_bytes,
+                                                    const payload::storage::RamPlacement& placement) const;
+  void                                    SetLocation(payload::manager::v1::PayloadDescriptor* descriptor, const payload::util::UUID& id,
+                                                      uint64_t length_bytes, payload::manager::v1::PayloadCodec codec) const;
+  // Path and offset of the bytes stored under key, as tier lays them out.
+  void                                    LocateStored(payload::manager::v1::Tier tier, const payload::util::UUID& key,
+                                                       payload::manager::v1::DiskLocation* location) const;
+  // tier's StorageBackend::LocationEpoch(); read before locating, so a move in between shows as a newer epoch.
+  uint64_t                                LocationEpoch(payload::manager::v1::Tier tier) const;
+  // Key a DISK / OBJECT descriptor's location names (a shared content blob), or the payload's own.
+  payload::util::UUID                     LocatedKey(const payload::manager::v1::PayloadDescriptor& descriptor) const;
+  // Codec a copy of record onto target is stored with.
+  payload::manager::v1::PayloadCodec      TargetCodec(const payload::db::model::PayloadRecord& record, payload::manager::v1::Tier target) const;
+  payload::manager::v1::PayloadDescriptor ToPayloadDescriptor(const payload::db::model::PayloadRecord& record) const;
+  payload::manager::v1::PayloadDescriptor PromoteUnlocked(const payload::manager::v1::PayloadID& id, payload::manager::v1::Tier target);
+
+  // Content key (UUID string) record's bytes dedup under on target, or empty.
+  std::string ContentHashFor(const payload::db::model::PayloadRecord& record, payload::storage::StorageBackend& source,
+                             payload::manager::v1::Tier target) const;
+  // Removes the blob content_hash from tier once no payload there references it.
+  void ReleaseContent(payload::manager::v1::Tier tier, const std::string& content_hash);
+  // Removes id's bytes from tier: its own copy, or its sidecar and its reference to content_hash.
+  void RemoveStored(payload::storage::StorageBackend& backend, payload::manager::v1::Tier tier, const payload::manager::v1::PayloadID& id,
+                    const std::string& content_hash);
 
-  mutable std::mutex                                pins_guard_;
-  std::unordered_map<payload::util::UUID, PinState> pins_;
+  // Rebuilds the cached descriptor from the payload's control block.
+  std::optional<payload::manager::v1::PayloadDescriptor> FindSnapshot(const payload::util::UUID& key);
+  bool                                                   HasSnapshot(const payload::util::UUID& key) const;
+  void                                                   DropSnapshot(const payload::util::UUID& key);
+  void                                                   Touch(const payload::util::UUID& key);
 
-  bool IsPinnedLocked(const payload::util::UUID& key, uint64_t now_ms);
-  void SweepExpiredPins();
+  void MarkDeleting(const payload::util::UUID& key);
+  void ClearDeleting(const payload::util::UUID& key);
+  bool IsDeleting(const payload::util::UUID& key) const;
 
-  // IDs that must never be automatically evicted (no_evict=true or EVICTION_PRIORITY_NEVER).
-  mutable std::mutex                      no_evict_guard_;
-  std::unordered_set<payload::util::UUID> no_evict_ids_;
+  payload::storage::StorageFactory::TierMap           storage_;
+  std::shared_ptr<payload::lease::LeaseManager>       lease_mgr_;
+  std::shared_ptr<payload::db::Repository>            repository_;
+  std::shared_ptr<payload::metadata::MetadataCache>   metadata_cache_;
+  std::shared_ptr<payload::storage::RamArrowStore>    ram_store_; // null when TIER_RAM is not a RamArrowStore
+  std::shared_ptr<payload::storage::StripedDiskStore> disk_devices_; // null when TIER_DISK is not striped
+  std::string                                         shm_prefix_{"pm"};
+  payload::storage::TransferOptions                   transfer_options_;
+  TierCodecs                                          tier_codecs_; // set at startup, read-only afterwards
+  DedupOptions                                        dedup_options_; // set at startup, read-only afterwards
+  std::atomic<uint64_t>                               dedup_lookups_{0};
+  std::atomic<uint64_t>                               dedup_hits_{0};
 
-  // Preferred spill tier per payload (default TIER_DISK when absent).
-  mutable std::mutex                                                  spill_targets_guard_;
-  std::unordered_map<payload::util::UUID, payload::manager::v1::Tier> spill_targets_;
+  // Snapshot cache consistency model:
+  // - ResolveSnapshot first serves reads from the control blocks.
+  // - Repository reads are only used on cache misses and during explicit refresh (HydrateCaches).
+  // - Mutations routed through PayloadManager (Allocate/Commit/Promote/Delete) refresh or invalidate
+  //   control blocks synchronously with successful transaction commits.
+  // - Out-of-band repository writes can be stale until HydrateCaches() is called.
+  //
+  // Per-payload state lives in one 64-byte PayloadControlBlock (tier, state, version, length,
+  // pin expiry, eviction flags, spill target, recency and the lock word) instead of a set of
+  // side tables; descriptors are rebuilt from it on demand.
+  //
+  // Locking strategy:
+  // - The control table is sharded by payload UUID hash; a cache hit takes one shard's shared
+  //   lock just long enough to copy a few scalars and never touches the per-payload lock word.
+  // - Writers hold a PayloadControlTable::Ref for as long as they hold the payload's lock word,
+  //   so the block cannot be reclaimed under them.
+  // - Delete tombstones its payload's block before draining leases. AcquireReadLease,
+  //   Promote, Prefetch and Pin check the tombstone (and re-check after publishing a lease or pin),
+  //   so a delete only stalls callers touching that payload rather than the whole node.
+  PayloadControlTable controls_;
 
-  // Per-tier byte totals and payload counts for occupancy metrics.
-  mutable std::mutex                tier_bytes_guard_;
-  std::unordered_map<int, uint64_t> tier_bytes_;
-  mutable std::mutex                tier_count_guard_;
-  std::unordered_map<int, uint64_t> tier_count_;
+  // Blob key of each snapshot flagged kSharedBlob; the control block has no
+  // room for it. Content keys are also locked through controls_ (they never
+  // collide with payload ids), ordered after the payload's own lock.
+  mutable std::shared_mutex                                    shared_blobs_mutex_;
+  std::unordered_map<payload::util::UUID, payload::util::UUID> shared_blobs_;
 
-  void UpdateTierBytes(payload::manager::v1::Tier tier, int64_t delta);
-  void UpdateTierCount(payload::manager::v1::Tier tier, int64_t delta);
+  // Per-tier byte totals and payload counts for pressure checks and occupancy metrics.
+  TierCounters tier_counters_;
 };
 
 } // namespace payload::core
@@ -0,0 +1,52 @@
+#include "tier_counters.hpp"
+
+#include <sched.h>
+
+namespace payload::core {
+
+std::size_t TierCounters::StripeIndex() {
+  // sched_getcpu() is a vDSO call; a thread that migrates mid-update just
+  // lands on another stripe, which the atomic add tolerates.
+  const int cpu = sched_getcpu();
+  if (cpu >= 0) {
+    return static_cast<std::size_t>(cpu) % kStripeCount;
+  }
+
+  static std::atomic<std::size_t> next_slot{0};
+  static thread_local std::size_t slot = next_slot.fetch_add(1, std::memory_order_relaxed) % kStripeCount;
+  return slot;
+}
+
+TierCounters::Totals TierCounters::Read() const {
+  Totals totals;
+  for (const auto& stripe : stripes_) {
+    for (std::size_t slot = 0; slot < kTierSlots; ++slot) {
+      totals.bytes[slot] += stripe.bytes[slot].load(std::memory_order_relaxed);
+      totals.count[slot] += stripe.count[slot].load(std::memory_order_relaxed);
+    }
+  }
+  return totals;
+}
+
+int64_t TierCounters::Bytes(payload::manager::v1::Tier tier) const {
+  const auto slot = Slot(tier);
+  if (slot >= kTierSlots) {
+    return 0;
+  }
+  int64_t total = 0;
+  for (const auto& stripe : stripes_) {
+    total += stripe.bytes[slot].load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+void TierCounters::Reset(const Totals& totals) {
+  for (std::size_t i = 0; i < kStripeCount; ++i) {
+    for (std::size_t slot = 0; slot < kTierSlots; ++slot) {
+      stripes_[i].bytes[slot].store(i == 0 ? totals.bytes[slot] : 0, std::memory_order_relaxed);
+      stripes_[i].count[slot].store(i == 0 ? totals.count[slot] : 0, std::memory_order_relaxed);
+    }
+  }
+}
+
+} // namespace payload::core
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "payload/manager/v1.hpp"
+
+namespace payload::core {
+
+/*
+  Per-tier byte and payload counters, striped across CPUs.
+
+  Writers add a signed delta with one relaxed fetch_add on the stripe for
+  the CPU they run on, so concurrent Allocate/Delete on different cores
+  never share a cache line. Readers sum every stripe; the sum is exact once
+  writers quiesce and is otherwise a consistent-enough occupancy estimate
+  for pressure checks and gauges.
+
+  An increment and its matching decrement may land on different stripes,
+  so individual stripes can go negative; only the total is meaningful.
+*/
+class TierCounters {
+ public:
+  // Tier enum values are dense and small (TIER_UNSPECIFIED .. TIER_VOID).
+  static constexpr std::size_t kTierSlots = static_cast<std::size_t>(payload::manager::v1::TIER_VOID) + 1;
+
+  struct Totals {
+    std::array<int64_t, kTierSlots> bytes{};
+    std::array<int64_t, kTierSlots> count{};
+  };
+
+  void Add(payload::manager::v1::Tier tier, int64_t bytes_delta, int64_t count_delta) {
+    const auto slot = Slot(tier);
+    if (slot >= kTierSlots) {
+      return;
+    }
+    auto& stripe = stripes_[StripeIndex()];
+    if (bytes_delta != 0) {
+      stripe.bytes[slot].fetch_add(bytes_delta, std::memory_order_relaxed);
+    }
+    if (count_delta != 0) {
+      stripe.count[slot].fetch_add(count_delta, std::memory_order_relaxed);
+    }
+  }
+
+  // Sums all stripes. A total can read transiently negative when a
+  // decrement's stripe is summed before its increment's; callers clamp.
+  Totals Read() const;
+
+  int64_t Bytes(payload::manager::v1::Tier tier) const;
+
+  // Replaces all totals (used when rebuilding from the repository).
+  void Reset(const Totals& totals);
+
+ private:
+  static constexpr std::size_t kStripeCount = 16;
+
+  struct alignas(64) Stripe {
+    std::array<std::atomic<int64_t>, kTierSlots> bytes{};
+    std::array<std::atomic<int64_t>, kTierSlots> count{};
+  };
+
+  static std::size_t Slot(payload::manager::v1::Tier tier) {
+    return static_cast<std::size_t>(tier);
+  }
+
+  static std::size_t StripeIndex();
+
+  std::array<Stripe, kStripeCount> stripes_{};
+};
+
+} // namespace payload::core
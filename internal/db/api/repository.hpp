@@ -64,6 +64,10 @@ class Repository {
 
   virtual std::vector<model::PayloadRecord> ListExpiredPayloads(Transaction&, uint64_t now_ms) = 0;
 
+  // Any payload on tier whose bytes are the shared blob content_hash; the
+  // blob is unreferenced there once this returns nothing.
+  virtual std::optional<model::PayloadRecord> FindContentReference(Transaction&, const std::string& content_hash, payload::manager::v1::Tier tier) = 0;
+
   // ---------------------------------------------------------------------
   // Metadata (current snapshot)
   // ---------------------------------------------------------------------
@@ -11,6 +11,8 @@ namespace payload::db {
   - After Commit() all reads see the change
   - Rollback() discards all writes
   - Destructor MUST rollback if not committed
+  - RollbackToSavepoint() discards only the writes made since Savepoint()
+    and leaves the transaction usable, even after a failed statement
 
   SQLite: BEGIN IMMEDIATE
   Postgres: pqxx::work
@@ -29,6 +31,13 @@ class Transaction {
 
   // true if commit already performed
   virtual bool IsCommitted() const = 0;
+
+  // Savepoints let a batch undo one item's writes without losing the rest of
+  // the transaction; on Postgres a failed statement otherwise aborts it. At
+  // most one savepoint is open at a time; both calls below close it.
+  virtual void Savepoint()           = 0;
+  virtual void RollbackToSavepoint() = 0;
+  virtual void ReleaseSavepoint()    = 0;
 };
 
 } // namespace payload::db
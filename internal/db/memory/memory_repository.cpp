@@ -112,6 +112,14 @@ std::vector<model::PayloadRecord> MemoryRepository::ListExpiredPayloads(Transact
   return out;
 }
 
+std::optional<model::PayloadRecord> MemoryRepository::FindContentReference(Transaction& t, const std::string& content_hash,
+                                                                           payload::manager::v1::Tier tier) {
+  for (const auto& [_, record] : TX(t).View().payloads) {
+    if (record.tier == tier && record.content_hash == content_hash) return record;
+  }
+  return std::nullopt;
+}
+
 Result MemoryRepository::UpsertMetadata(Transaction& t, const model::MetadataRecord& r) {
   auto& tx                    = TX(t);
   tx.Mutable().metadata[r.id] = r;
@@ -71,4 +71,22 @@ void MemoryTransaction::Rollback() {
   rolled_back_ = true;
 }
 
+void MemoryTransaction::Savepoint() {
+  savepoint_ = Mark{working_, modified_payload_ids_, deleted_payload_ids_, modified_metadata_ids_, deleted_metadata_ids_};
+}
+
+void MemoryTransaction::RollbackToSavepoint() {
+  if (!savepoint_) throw std::logic_error("memory transaction: no savepoint to roll back to");
+  working_               = std::move(savepoint_->working);
+  modified_payload_ids_  = std::move(savepoint_->modified_payload_ids);
+  deleted_payload_ids_   = std::move(savepoint_->deleted_payload_ids);
+  modified_metadata_ids_ = std::move(savepoint_->modified_metadata_ids);
+  deleted_metadata_ids_  = std::move(savepoint_->deleted_metadata_ids);
+  savepoint_.reset();
+}
+
+void MemoryTransaction::ReleaseSavepoint() {
+  savepoint_.reset();
+}
+
 } // namespace payload::db::memory
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <optional>
 #include <unordered_set>
 
 #include "internal/db/api/transaction.hpp"
@@ -26,6 +27,9 @@ class MemoryTransaction final : public db::Transaction {
   bool IsCommitted() const override {
     return committed_;
   }
+  void Savepoint() override;
+  void RollbackToSavepoint() override;
+  void ReleaseSavepoint() override;
 
   MemoryRepository::State& Mutable() {
     return working_;
@@ -42,8 +46,19 @@ class MemoryTransaction final : public db::Transaction {
   std::unordered_set<std::string>         deleted_metadata_ids_;
 
  private:
+  // Working state and write sets as of Savepoint(); a copy, like the
+  // snapshot Begin() takes.
+  struct Mark {
+    MemoryRepository::State                 working;
+    std::unordered_set<payload::util::UUID> modified_payload_ids;
+    std::unordered_set<payload::util::UUID> deleted_payload_ids;
+    std::unordered_set<std::string>         modified_metadata_ids;
+    std::unordered_set<std::string>         deleted_metadata_ids;
+  };
+
   MemoryRepository&       repo_;
   MemoryRepository::State working_;
+  std::optional<Mark>     savepoint_;
   bool                    committed_   = false;
   bool                    rolled_back_ = false;
 };
@@ -0,0 +1,10 @@
+-- ============================================================
+-- Add durable-tier compression columns to payload.
+-- spill_codec and stored_codec hold PayloadCodec enum values;
+-- stored_size_bytes is the compressed size (0 = size_bytes).
+-- Safe to run on existing databases: ADD COLUMN IF NOT EXISTS is idempotent.
+-- ============================================================
+
+ALTER TABLE payload ADD COLUMN IF NOT EXISTS spill_codec       SMALLINT NOT NULL DEFAULT 0;
+ALTER TABLE payload ADD COLUMN IF NOT EXISTS stored_codec      SMALLINT NOT NULL DEFAULT 0;
+ALTER TABLE payload ADD COLUMN IF NOT EXISTS stored_size_bytes BIGINT   NOT NULL DEFAULT 0;
@@ -0,0 +1,8 @@
+-- ============================================================
+-- Add the payload integrity column to payload.
+-- checksum_crc32c is the CRC32C of the uncompressed payload
+-- bytes (0 = not computed yet).
+-- Safe to run on existing databases: ADD COLUMN IF NOT EXISTS is idempotent.
+-- ============================================================
+
+ALTER TABLE payload ADD COLUMN IF NOT EXISTS checksum_crc32c BIGINT NOT NULL DEFAULT 0;
@@ -0,0 +1,11 @@
+-- ============================================================
+-- Add the content dedup column to payload.
+-- content_hash is the content key of the shared durable-tier
+-- blob holding the payload bytes ('' = stored under its own id).
+-- The blob is removed once no row on its tier references it.
+-- Safe to run on existing databases: ADD COLUMN IF NOT EXISTS is idempotent.
+-- ============================================================
+
+ALTER TABLE payload ADD COLUMN IF NOT EXISTS content_hash TEXT NOT NULL DEFAULT '';
+
+CREATE INDEX IF NOT EXISTS idx_payload_content_hash ON payload(content_hash);
@@ -0,0 +1,12 @@
+-- ============================================================
+-- Add the checksum presence flag to payload.
+-- has_checksum is 1 when checksum_crc32c holds the CRC32C of
+-- the payload bytes; 0 is a valid CRC, so the value alone
+-- cannot say whether one was taken. Rows written before this
+-- migration used 0 for "not computed yet".
+-- Safe to run on existing databases: ADD COLUMN IF NOT EXISTS is idempotent.
+-- ============================================================
+
+ALTER TABLE payload ADD COLUMN IF NOT EXISTS has_checksum SMALLINT NOT NULL DEFAULT 0;
+
+UPDATE payload SET has_checksum = 1 WHERE has_checksum = 0 AND checksum_crc32c <> 0;
@@ -0,0 +1,12 @@
+-- ============================================================
+-- Add durable-tier compression columns to payload.
+-- spill_codec and stored_codec hold PayloadCodec enum values;
+-- stored_size_bytes is the compressed size (0 = size_bytes).
+-- SQLite does not support IF NOT EXISTS on ALTER TABLE ADD COLUMN
+-- (prior to 3.37.0), so callers must handle SQLITE_ERROR for
+-- "duplicate column name" and treat it as a no-op.
+-- ============================================================
+
+ALTER TABLE payload ADD COLUMN spill_codec       INTEGER NOT NULL DEFAULT 0;
+ALTER TABLE payload ADD COLUMN stored_codec      INTEGER NOT NULL DEFAULT 0;
+ALTER TABLE payload ADD COLUMN stored_size_bytes INTEGER NOT NULL DEFAULT 0;
@@ -0,0 +1,10 @@
+-- ============================================================
+-- Add the payload integrity column to payload.
+-- checksum_crc32c is the CRC32C of the uncompressed payload
+-- bytes (0 = not computed yet).
+-- SQLite does not support IF NOT EXISTS on ALTER TABLE ADD COLUMN
+-- (prior to 3.37.0), so callers must handle SQLITE_ERROR for
+-- "duplicate column name" and treat it as a no-op.
+-- ============================================================
+
+ALTER TABLE payload ADD COLUMN checksum_crc32c INTEGER NOT NULL DEFAULT 0;
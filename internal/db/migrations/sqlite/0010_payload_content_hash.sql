@@ -0,0 +1,13 @@
+-- ============================================================
+-- Add the content dedup column to payload.
+-- content_hash is the content key of the shared durable-tier
+-- blob holding the payload bytes ('' = stored under its own id).
+-- The blob is removed once no row on its tier references it.
+-- SQLite does not support IF NOT EXISTS on ALTER TABLE ADD COLUMN
+-- (prior to 3.37.0), so callers must handle SQLITE_ERROR for
+-- "duplicate column name" and treat it as a no-op.
+-- ============================================================
+
+ALTER TABLE payload ADD COLUMN content_hash TEXT NOT NULL DEFAULT '';
+
+CREATE INDEX IF NOT EXISTS idx_payload_content_hash ON payload(content_hash);
@@ -0,0 +1,14 @@
+-- ============================================================
+-- Add the checksum presence flag to payload.
+-- has_checksum is 1 when checksum_crc32c holds the CRC32C of
+-- the payload bytes; 0 is a valid CRC, so the value alone
+-- cannot say whether one was taken. Rows written before this
+-- migration used 0 for "not computed yet".
+-- SQLite does not support IF NOT EXISTS on ALTER TABLE ADD COLUMN
+-- (prior to 3.37.0), so callers must handle SQLITE_ERROR for
+-- "duplicate column name" and treat it as a no-op.
+-- ============================================================
+
+ALTER TABLE payload ADD COLUMN has_checksum INTEGER NOT NULL DEFAULT 0;
+
+UPDATE payload SET has_checksum = 1 WHERE has_checksum = 0 AND checksum_crc32c <> 0;
@@ -49,6 +49,24 @@ struct PayloadRecord {
 
   // If true, spill target must be a durable tier (DISK or OBJECT).
   bool require_durable = false;
+
+  // Codec requested for spilled copies (PayloadCodec enum; 0 = UNSPECIFIED → the target tier's codec).
+  int spill_codec = 0;
+
+  // Codec of the bytes on the current tier (PayloadCodec enum; 0 or NONE = stored raw).
+  int stored_codec = 0;
+
+  // Bytes occupied on the current tier when stored_codec compresses them (0 = size_bytes).
+  uint64_t stored_size_bytes = 0;
+
+  // CRC32C of the raw payload bytes, taken on the first spill and checked on
+  // every later copy; only meaningful when has_checksum is set (0 is a valid CRC).
+  uint32_t checksum_crc32c = 0;
+  bool     has_checksum    = false;
+
+  // Content key (UUID string) of the shared blob holding this payload's bytes
+  // on its current tier; empty when the payload is stored under its own id.
+  std::string content_hash;
 };
 
 } // namespace payload::db::model
@@ -41,17 +41,18 @@ std::shared_ptr<pqxx::connection> PgPool::Acquire() {
 void PgPool::PrepareStatements(pqxx::connection& conn) {
   conn.prepare("get_payload",
                "SELECT id, tier, state, size_bytes, version, expires_at_ms, no_evict, eviction_priority, spill_target, created_at_ms, "
-               "min_residency_tier, require_durable "
+               "min_residency_tier, require_durable, spill_codec, stored_codec, stored_size_bytes, checksum_crc32c, content_hash, has_checksum "
                "FROM payload WHERE id=$1");
 
   conn.prepare("insert_payload",
                "INSERT INTO payload(id,tier,state,size_bytes,version,expires_at_ms,no_evict,eviction_priority,spill_target,created_at_ms,"
-               "min_residency_tier,require_durable) "
-               "VALUES($1,$2,$3,$4,$5,NULLIF($6::bigint,0),$7,$8,$9,NULLIF($10::bigint,0),$11,$12)");
+               "min_residency_tier,require_durable,spill_codec,stored_codec,stored_size_bytes,checksum_crc32c,content_hash,has_checksum) "
+               "VALUES($1,$2,$3,$4,$5,NULLIF($6::bigint,0),$7,$8,$9,NULLIF($10::bigint,0),$11,$12,$13,$14,$15,$16,$17,$18)");
 
   conn.prepare("update_payload",
                "UPDATE payload SET tier=$2,state=$3,size_bytes=$4,version=$5,expires_at_ms=NULLIF($6::bigint,0),"
-               "no_evict=$7,eviction_priority=$8,spill_target=$9,min_residency_tier=$10,require_durable=$11 WHERE id=$1");
+               "no_evict=$7,eviction_priority=$8,spill_target=$9,min_residency_tier=$10,require_durable=$11,"
+               "spill_codec=$12,stored_codec=$13,stored_size_bytes=$14,checksum_crc32c=$15,content_hash=$16,has_checksum=$17 WHERE id=$1");
 
   conn.prepare("delete_payload", "DELETE FROM payload WHERE id=$1");
 }
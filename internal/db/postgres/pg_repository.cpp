@@ -39,7 +39,9 @@ Result PgRepository::Translate(const std::exception& e) {
 Result PgRepository::InsertPayload(Transaction& t, const model::PayloadRecord& r) {
   try {
     TX(t).Work().exec_prepared("insert_payload", payload::util::ToString(r.id), (int)r.tier, (int)r.state, r.size_bytes, r.version, r.expires_at_ms,
-                               (int)r.no_evict, r.eviction_priority, r.spill_target, r.created_at_ms, r.min_residency_tier, (int)r.require_durable);
+                               (int)r.no_evict, r.eviction_priority, r.spill_target, r.created_at_ms, r.min_residency_tier, (int)r.require_durable,
+                               r.spill_codec, r.stored_codec, r.stored_size_bytes, r.checksum_crc32c, r.content_hash,
+                               (int)r.has_checksum);
     return Result::Ok();
   } catch (const std::exception& e) {
     return Translate(e);
@@ -64,6 +66,12 @@ std::optional<model::PayloadRecord> PgRepository::GetPayload(Transaction& t, con
     r.created_at_ms      = res[0][9].is_null() ? 0 : res[0][9].as<uint64_t>();
     r.min_residency_tier = res[0][10].is_null() ? 0 : res[0][10].as<int>();
     r.require_durable    = res[0][11].is_null() ? false : (res[0][11].as<int>() != 0);
+    r.spill_codec        = res[0][12].is_null() ? 0 : res[0][12].as<int>();
+    r.stored_codec       = res[0][13].is_null() ? 0 : res[0][13].as<int>();
+    r.stored_size_bytes  = res[0][14].is_null() ? 0 : res[0][14].as<uint64_t>();
+    r.checksum_crc32c    = res[0][15].is_null() ? 0 : res[0][15].as<uint32_t>();
+    r.content_hash       = res[0][16].is_null() ? "" : res[0][16].c_str();
+    r.has_checksum       = res[0][17].is_null() ? false : (res[0][17].as<int>() != 0);
     return r;
   } catch (const std::exception& e) {
     throw std::runtime_error(std::string("GetPayload failed: ") + e.what());
@@ -79,14 +87,16 @@ std::vector<model::PayloadRecord> PgRepository::ListPayloads(Transaction& t, pay
     if (tier_filter != payload::manager::v1::TIER_UNSPECIFIED) {
       res = TX(t).Work().exec_params(
           "SELECT "
-          "id,tier,state,size_bytes,version,expires_at_ms,no_evict,eviction_priority,spill_target,created_at_ms,min_residency_tier,require_durable"
-          " FROM payload WHERE tier=$1 ORDER BY created_at_ms DESC LIMIT $2 OFFSET $3;",
+          "id,tier,state,size_bytes,version,expires_at_ms,no_evict,eviction_priority,spill_target,created_at_ms,min_residency_tier,require_durable,"
+          "spill_codec,stored_codec,stored_size_bytes,checksum_crc32c,content_hash,has_checksum FROM payload WHERE tier=$1 "
+          "ORDER BY created_at_ms DESC LIMIT $2 OFFSET $3;",
           static_cast<int>(tier_filter), effective_limit, effective_offset);
     } else {
       res = TX(t).Work().exec_params(
           "SELECT "
-          "id,tier,state,size_bytes,version,expires_at_ms,no_evict,eviction_priority,spill_target,created_at_ms,min_residency_tier,require_durable"
-          " FROM payload ORDER BY created_at_ms DESC LIMIT $1 OFFSET $2;",
+          "id,tier,state,size_bytes,version,expires_at_ms,no_evict,eviction_priority,spill_target,created_at_ms,min_residency_tier,require_durable,"
+          "spill_codec,stored_codec,stored_size_bytes,checksum_crc32c,content_hash,has_checksum FROM payload "
+          "ORDER BY created_at_ms DESC LIMIT $1 OFFSET $2;",
           effective_limit, effective_offset);
     }
 
@@ -106,6 +116,12 @@ std::vector<model::PayloadRecord> PgRepository::ListPayloads(Transaction& t, pay
       r.created_at_ms      = row[9].is_null() ? 0 : row[9].as<uint64_t>();
       r.min_residency_tier = row[10].is_null() ? 0 : row[10].as<int>();
       r.require_durable    = row[11].is_null() ? false : (row[11].as<int>() != 0);
+      r.spill_codec        = row[12].is_null() ? 0 : row[12].as<int>();
+      r.stored_codec       = row[13].is_null() ? 0 : row[13].as<int>();
+      r.stored_size_bytes  = row[14].is_null() ? 0 : row[14].as<uint64_t>();
+      r.checksum_crc32c    = row[15].is_null() ? 0 : row[15].as<uint32_t>();
+      r.content_hash       = row[16].is_null() ? "" : row[16].c_str();
+      r.has_checksum       = row[17].is_null() ? false : (row[17].as<int>() != 0);
       records.push_back(std::move(r));
     }
     return records;
@@ -130,7 +146,9 @@ int32_t PgRepository::CountPayloads(Transaction& t, payload::manager::v1::Tier t
 Result PgRepository::UpdatePayload(Transaction& t, const model::PayloadRecord& r) {
   try {
     TX(t).Work().exec_prepared("update_payload", payload::util::ToString(r.id), (int)r.tier, (int)r.state, r.size_bytes, r.version, r.expires_at_ms,
-                               (int)r.no_evict, r.eviction_priority, r.spill_target, r.min_residency_tier, (int)r.require_durable);
+                               (int)r.no_evict, r.eviction_priority, r.spill_target, r.min_residency_tier, (int)r.require_durable,
+                               r.spill_codec, r.stored_codec, r.stored_size_bytes, r.checksum_crc32c, r.content_hash,
+                               (int)r.has_checksum);
     return Result::Ok();
   } catch (const std::exception& e) {
     return Translate(e);
@@ -141,8 +159,8 @@ std::vector<model::PayloadRecord> PgRepository::ListExpiredPayloads(Transaction&
   try {
     auto res = TX(t).Work().exec_params(
         "SELECT "
-        "id,tier,state,size_bytes,version,expires_at_ms,no_evict,eviction_priority,spill_target,created_at_ms,min_residency_tier,require_durable "
-        "FROM payload"
+        "id,tier,state,size_bytes,version,expires_at_ms,no_evict,eviction_priority,spill_target,created_at_ms,min_residency_tier,require_durable,"
+        "spill_codec,stored_codec,stored_size_bytes,checksum_crc32c,content_hash,has_checksum FROM payload"
         " WHERE expires_at_ms > 0 AND expires_at_ms <= $1;",
         now_ms);
 
@@ -162,6 +180,12 @@ std::vector<model::PayloadRecord> PgRepository::ListExpiredPayloads(Transaction&
       r.created_at_ms      = row[9].is_null() ? 0 : row[9].as<uint64_t>();
       r.min_residency_tier = row[10].is_null() ? 0 : row[10].as<int>();
       r.require_durable    = row[11].is_null() ? false : (row[11].as<int>() != 0);
+      r.spill_codec        = row[12].is_null() ? 0 : row[12].as<int>();
+      r.stored_codec       = row[13].is_null() ? 0 : row[13].as<int>();
+      r.stored_size_bytes  = row[14].is_null() ? 0 : row[14].as<uint64_t>();
+      r.checksum_crc32c    = row[15].is_null() ? 0 : row[15].as<uint32_t>();
+      r.content_hash       = row[16].is_null() ? "" : row[16].c_str();
+      r.has_checksum       = row[17].is_null() ? false : (row[17].as<int>() != 0);
       records.push_back(std::move(r));
     }
     return records;
@@ -170,6 +194,42 @@ std::vector<model::PayloadRecord> PgRepository::ListExpiredPayloads(Transaction&
   }
 }
 
+std::optional<model::PayloadRecord> PgRepository::FindContentReference(Transaction& t, const std::string& content_hash,
+                                                                       payload::manager::v1::Tier tier) {
+  try {
+    auto res = TX(t).Work().exec_params(
+        "SELECT "
+        "id,tier,state,size_bytes,version,expires_at_ms,no_evict,eviction_priority,spill_target,created_at_ms,min_residency_tier,require_durable,"
+        "spill_codec,stored_codec,stored_size_bytes,checksum_crc32c,content_hash,has_checksum FROM payload"
+        " WHERE content_hash=$1 AND tier=$2 LIMIT 1;",
+        content_hash, static_cast<int>(tier));
+    if (res.empty()) return std::nullopt;
+
+    model::PayloadRecord r;
+    r.id                 = payload::util::FromString(res[0][0].c_str());
+    r.tier               = CheckedEnumCast<payload::manager::v1::Tier>(res[0][1].as<int>(), 0, 4, "tier");
+    r.state              = CheckedEnumCast<payload::manager::v1::PayloadState>(res[0][2].as<int>(), 0, 8, "state");
+    r.size_bytes         = res[0][3].as<uint64_t>();
+    r.version            = res[0][4].as<uint64_t>();
+    r.expires_at_ms      = res[0][5].is_null() ? 0 : res[0][5].as<uint64_t>();
+    r.no_evict           = res[0][6].as<int>() != 0;
+    r.eviction_priority  = res[0][7].as<int>();
+    r.spill_target       = res[0][8].as<int>();
+    r.created_at_ms      = res[0][9].is_null() ? 0 : res[0][9].as<uint64_t>();
+    r.min_residency_tier = res[0][10].is_null() ? 0 : res[0][10].as<int>();
+    r.require_durable    = res[0][11].is_null() ? false : (res[0][11].as<int>() != 0);
+    r.spill_codec        = res[0][12].is_null() ? 0 : res[0][12].as<int>();
+    r.stored_codec       = res[0][13].is_null() ? 0 : res[0][13].as<int>();
+    r.stored_size_bytes  = res[0][14].is_null() ? 0 : res[0][14].as<uint64_t>();
+    r.checksum_crc32c    = res[0][15].is_null() ? 0 : res[0][15].as<uint32_t>();
+    r.content_hash       = res[0][16].is_null() ? "" : res[0][16].c_str();
+    r.has_checksum       = res[0][17].is_null() ? false : (res[0][17].as<int>() != 0);
+    return r;
+  } catch (const std::exception& e) {
+    throw std::runtime_error(std::string("FindContentReference failed: ") + e.what());
+  }
+}
+
 Result PgRepository::DeletePayload(Transaction& t, const payload::util::UUID& id) {
   try {
     TX(t).Work().exec_prepared("delete_payload", payload::util::ToString(id));
@@ -21,6 +21,7 @@ class PgRepository final : public db::Repository {
   Result  UpdatePayload(Transaction&, const model::PayloadRecord&) override;
   Result  DeletePayload(Transaction&, const payload::util::UUID&) override;
   std::vector<model::PayloadRecord> ListExpiredPayloads(Transaction&, uint64_t now_ms) override;
+  std::optional<model::PayloadRecord> FindContentReference(Transaction&, const std::string& content_hash, payload::manager::v1::Tier tier) override;
 
   Result                               UpsertMetadata(Transaction&, const model::MetadataRecord&) override;
   std::optional<model::MetadataRecord> GetMetadata(Transaction&, const std::string&) override;
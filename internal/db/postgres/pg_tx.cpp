@@ -26,4 +26,18 @@ void PgTransaction::Rollback() {
   committed_ = true;
 }
 
+void PgTransaction::Savepoint() {
+  tx_->exec("SAVEPOINT payload_item");
+}
+
+void PgTransaction::RollbackToSavepoint() {
+  // Clears the aborted state a failed statement leaves behind.
+  tx_->exec("ROLLBACK TO SAVEPOINT payload_item");
+  tx_->exec("RELEASE SAVEPOINT payload_item");
+}
+
+void PgTransaction::ReleaseSavepoint() {
+  tx_->exec("RELEASE SAVEPOINT payload_item");
+}
+
 } // namespace payload::db::postgres
@@ -22,6 +22,9 @@ class PgTransaction final : public db::Transaction {
   bool IsCommitted() const override {
     return committed_;
   }
+  void Savepoint() override;
+  void RollbackToSavepoint() override;
+  void ReleaseSavepoint() override;
 
  private:
   std::shared_ptr<pqxx::connection> conn_;
@@ -142,8 +142,8 @@ Result SqliteRepository::InsertPayload(Transaction& t, const model::PayloadRecor
   const char* sql =
       "INSERT INTO "
       "payload(id,tier,state,size_bytes,version,expires_at_ms,no_evict,eviction_priority,spill_target,created_at_ms,min_residency_tier,require_"
-      "durable)"
-      " VALUES(?,?,?,?,?,?,?,?,?,?,?,?);";
+      "durable,spill_codec,stored_codec,stored_size_bytes,checksum_crc32c,content_hash,has_checksum)"
+      " VALUES(?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?);";
   sqlite3_stmt* st = nullptr;
   if (sqlite3_prepare_v2(db, sql, -1, &st, nullptr) != SQLITE_OK) return Result::Err(ErrorCode::InternalError, sqlite3_errmsg(db));
 
@@ -163,6 +163,12 @@ Result SqliteRepository::InsertPayload(Transaction& t, const model::PayloadRecor
   BindU64(st, 10, r.created_at_ms);
   BindI32(st, 11, r.min_residency_tier);
   BindI32(st, 12, r.require_durable ? 1 : 0);
+  BindI32(st, 13, r.spill_codec);
+  BindI32(st, 14, r.stored_codec);
+  BindU64(st, 15, r.stored_size_bytes);
+  BindU64(st, 16, r.checksum_crc32c);
+  BindText(st, 17, r.content_hash);
+  BindI32(st, 18, r.has_checksum ? 1 : 0);
 
   int rc = sqlite3_step(st);
   sqlite3_finalize(st);
@@ -175,8 +181,8 @@ std::optional<model::PayloadRecord> SqliteRepository::GetPayload(Transaction& t,
 
   const char* sql =
       "SELECT "
-      "id,tier,state,size_bytes,version,expires_at_ms,no_evict,eviction_priority,spill_target,created_at_ms,min_residency_tier,require_durable FROM "
-      "payload WHERE id=?";
+      "id,tier,state,size_bytes,version,expires_at_ms,no_evict,eviction_priority,spill_target,created_at_ms,min_residency_tier,require_durable,"
+      "spill_codec,stored_codec,stored_size_bytes,checksum_crc32c,content_hash,has_checksum FROM payload WHERE id=?";
   sqlite3_stmt* st = nullptr;
   if (sqlite3_prepare_v2(db, sql, -1, &st, nullptr) != SQLITE_OK)
     throw std::runtime_error(std::string("sqlite prepare failed (GetPayload): ") + sqlite3_errmsg(db));
@@ -202,6 +208,12 @@ std::optional<model::PayloadRecord> SqliteRepository::GetPayload(Transaction& t,
   r.created_at_ms      = sqlite3_column_type(st, 9) != SQLITE_NULL ? ColU64(st, 9) : 0;
   r.min_residency_tier = ColI32(st, 10);
   r.require_durable    = ColI32(st, 11) != 0;
+  r.spill_codec        = ColI32(st, 12);
+  r.stored_codec       = ColI32(st, 13);
+  r.stored_size_bytes  = ColU64(st, 14);
+  r.checksum_crc32c    = static_cast<uint32_t>(ColU64(st, 15));
+  r.content_hash       = ColText(st, 16);
+  r.has_checksum       = ColI32(st, 17) != 0;
 
   sqlite3_finalize(st);
   return r;
@@ -217,11 +229,13 @@ std::vector<model::PayloadRecord> SqliteRepository::ListPayloads(Transaction& t,
   const char* sql =
       filter
           ? "SELECT "
-            "id,tier,state,size_bytes,version,expires_at_ms,no_evict,eviction_priority,spill_target,created_at_ms,min_residency_tier,require_durable"
-            " FROM payload WHERE tier=? ORDER BY created_at_ms DESC LIMIT ? OFFSET ?;"
+            "id,tier,state,size_bytes,version,expires_at_ms,no_evict,eviction_priority,spill_target,created_at_ms,min_residency_tier,require_durable,"
+            "spill_codec,stored_codec,stored_size_bytes,checksum_crc32c,content_hash,has_checksum FROM payload WHERE tier=? "
+            "ORDER BY created_at_ms DESC LIMIT ? OFFSET ?;"
           : "SELECT "
-            "id,tier,state,size_bytes,version,expires_at_ms,no_evict,eviction_priority,spill_target,created_at_ms,min_residency_tier,require_durable"
-            " FROM payload ORDER BY created_at_ms DESC LIMIT ? OFFSET ?;";
+            "id,tier,state,size_bytes,version,expires_at_ms,no_evict,eviction_priority,spill_target,created_at_ms,min_residency_tier,require_durable,"
+            "spill_codec,stored_codec,stored_size_bytes,checksum_crc32c,content_hash,has_checksum FROM payload "
+            "ORDER BY created_at_ms DESC LIMIT ? OFFSET ?;";
 
   sqlite3_stmt* st = nullptr;
   if (sqlite3_prepare_v2(db, sql, -1, &st, nullptr) != SQLITE_OK)
@@ -247,6 +261,13 @@ std::vector<model::PayloadRecord> SqliteRepository::ListPayloads(Transaction& t,
     r.created_at_ms      = sqlite3_column_type(st, 9) != SQLITE_NULL ? ColU64(st, 9) : 0;
     r.min_residency_tier = ColI32(st, 10);
     r.require_durable    = ColI32(st, 11) != 0;
+    r.spill_codec        = ColI32(st, 12);
+    r.stored_codec       = ColI32(st, 13);
+    r.stored_size_bytes  = ColU64(st, 14);
+    r.checksum_crc32c    = static_cast<uint32_t>(ColU64(st, 15));
+    r.content_hash       = ColText(st, 16);
+  r.has_checksum       = ColI32(st, 17) != 0;
+    r.has_checksum       = ColI32(st, 17) != 0;
     records.push_back(std::move(r));
   }
 
@@ -276,8 +297,8 @@ Result SqliteRepository::UpdatePayload(Transaction& t, const model::PayloadRecor
 
   const char* sql =
       "UPDATE payload SET "
-      "tier=?,state=?,size_bytes=?,version=?,expires_at_ms=?,no_evict=?,eviction_priority=?,spill_target=?,min_residency_tier=?,require_durable=? "
-      "WHERE id=?;";
+      "tier=?,state=?,size_bytes=?,version=?,expires_at_ms=?,no_evict=?,eviction_priority=?,spill_target=?,min_residency_tier=?,require_durable=?,"
+      "spill_codec=?,stored_codec=?,stored_size_bytes=?,checksum_crc32c=?,content_hash=?,has_checksum=? WHERE id=?;";
   sqlite3_stmt* st = nullptr;
   if (sqlite3_prepare_v2(db, sql, -1, &st, nullptr) != SQLITE_OK) return Result::Err(ErrorCode::InternalError, sqlite3_errmsg(db));
 
@@ -295,7 +316,13 @@ Result SqliteRepository::UpdatePayload(Transaction& t, const model::PayloadRecor
   BindI32(st, 8, r.spill_target);
   BindI32(st, 9, r.min_residency_tier);
   BindI32(st, 10, r.require_durable ? 1 : 0);
-  BindUuid(st, 11, r.id);
+  BindI32(st, 11, r.spill_codec);
+  BindI32(st, 12, r.stored_codec);
+  BindU64(st, 13, r.stored_size_bytes);
+  BindU64(st, 14, r.checksum_crc32c);
+  BindText(st, 15, r.content_hash);
+  BindI32(st, 16, r.has_checksum ? 1 : 0);
+  BindUuid(st, 17, r.id);
 
   int rc = sqlite3_step(st);
   sqlite3_finalize(st);
@@ -307,8 +334,10 @@ std::vector<model::PayloadRecord> SqliteRepository::ListExpiredPayloads(Transact
   auto* db = TX(t).Handle();
 
   const char* sql =
-      "SELECT id,tier,state,size_bytes,version,expires_at_ms,no_evict,eviction_priority,spill_target,created_at_ms,min_residency_tier,require_durable"
-      " FROM payload WHERE expires_at_ms > 0 AND expires_at_ms <= ?;";
+      "SELECT "
+      "id,tier,state,size_bytes,version,expires_at_ms,no_evict,eviction_priority,spill_target,created_at_ms,min_residency_tier,require_durable,"
+      "spill_codec,stored_codec,stored_size_bytes,checksum_crc32c,content_hash,has_checksum FROM payload "
+      "WHERE expires_at_ms > 0 AND expires_at_ms <= ?;";
   sqlite3_stmt* st = nullptr;
   if (sqlite3_prepare_v2(db, sql, -1, &st, nullptr) != SQLITE_OK)
     throw std::runtime_error(std::string("sqlite prepare failed (ListExpiredPayloads): ") + sqlite3_errmsg(db));
@@ -330,6 +359,13 @@ std::vector<model::PayloadRecord> SqliteRepository::ListExpiredPayloads(Transact
     r.created_at_ms      = sqlite3_column_type(st, 9) != SQLITE_NULL ? ColU64(st, 9) : 0;
     r.min_residency_tier = ColI32(st, 10);
     r.require_durable    = ColI32(st, 11) != 0;
+    r.spill_codec        = ColI32(st, 12);
+    r.stored_codec       = ColI32(st, 13);
+    r.stored_size_bytes  = ColU64(st, 14);
+    r.checksum_crc32c    = static_cast<uint32_t>(ColU64(st, 15));
+    r.content_hash       = ColText(st, 16);
+  r.has_checksum       = ColI32(st, 17) != 0;
+    r.has_checksum       = ColI32(st, 17) != 0;
     records.push_back(std::move(r));
   }
 
@@ -337,6 +373,50 @@ std::vector<model::PayloadRecord> SqliteRepository::ListExpiredPayloads(Transact
   return records;
 }
 
+std::optional<model::PayloadRecord> SqliteRepository::FindContentReference(Transaction& t, const std::string& content_hash,
+                                                                           payload::manager::v1::Tier tier) {
+  auto* db = TX(t).Handle();
+
+  const char* sql =
+      "SELECT "
+      "id,tier,state,size_bytes,version,expires_at_ms,no_evict,eviction_priority,spill_target,created_at_ms,min_residency_tier,require_durable,"
+      "spill_codec,stored_codec,stored_size_bytes,checksum_crc32c,content_hash,has_checksum FROM payload WHERE content_hash=? AND tier=? LIMIT 1;";
+  sqlite3_stmt* st = nullptr;
+  if (sqlite3_prepare_v2(db, sql, -1, &st, nullptr) != SQLITE_OK)
+    throw std::runtime_error(std::string("sqlite prepare failed (FindContentReference): ") + sqlite3_errmsg(db));
+
+  BindText(st, 1, content_hash);
+  BindI32(st, 2, static_cast<int>(tier));
+
+  if (sqlite3_step(st) != SQLITE_ROW) {
+    sqlite3_finalize(st);
+    return std::nullopt;
+  }
+
+  model::PayloadRecord r;
+  r.id                 = ColUuid(st, 0);
+  r.tier               = CheckedEnumCast<payload::manager::v1::Tier>(ColI32(st, 1), 0, 4, "tier");
+  r.state              = CheckedEnumCast<payload::manager::v1::PayloadState>(ColI32(st, 2), 0, 8, "state");
+  r.size_bytes         = ColU64(st, 3);
+  r.version            = ColU64(st, 4);
+  r.expires_at_ms      = sqlite3_column_type(st, 5) != SQLITE_NULL ? ColU64(st, 5) : 0;
+  r.no_evict           = ColI32(st, 6) != 0;
+  r.eviction_priority  = ColI32(st, 7);
+  r.spill_target       = ColI32(st, 8);
+  r.created_at_ms      = sqlite3_column_type(st, 9) != SQLITE_NULL ? ColU64(st, 9) : 0;
+  r.min_residency_tier = ColI32(st, 10);
+  r.require_durable    = ColI32(st, 11) != 0;
+  r.spill_codec        = ColI32(st, 12);
+  r.stored_codec       = ColI32(st, 13);
+  r.stored_size_bytes  = ColU64(st, 14);
+  r.checksum_crc32c    = static_cast<uint32_t>(ColU64(st, 15));
+  r.content_hash       = ColText(st, 16);
+  r.has_checksum       = ColI32(st, 17) != 0;
+
+  sqlite3_finalize(st);
+  return r;
+}
+
 Result SqliteRepository::DeletePayload(Transaction& t, const payload::util::UUID& id) {
   auto* db = TX(t).Handle();
 
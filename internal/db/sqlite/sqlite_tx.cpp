@@ -26,4 +26,17 @@ void SqliteTransaction::Rollback() {
   finalized_ = true;
 }
 
+void SqliteTransaction::Savepoint() {
+  db_->Exec("SAVEPOINT payload_item;");
+}
+
+void SqliteTransaction::RollbackToSavepoint() {
+  // ROLLBACK TO keeps the savepoint open; RELEASE closes it.
+  db_->Exec("ROLLBACK TO payload_item; RELEASE payload_item;");
+}
+
+void SqliteTransaction::ReleaseSavepoint() {
+  db_->Exec("RELEASE payload_item;");
+}
+
 } // namespace payload::db::sqlite
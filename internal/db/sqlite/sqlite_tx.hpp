@@ -28,6 +28,9 @@ class SqliteTransaction final : public db::Transaction {
   bool IsCommitted() const override {
     return committed_;
   }
+  void Savepoint() override;
+  void RollbackToSavepoint() override;
+  void ReleaseSavepoint() override;
 
  private:
   std::shared_ptr<SqliteDB> db_;
@@ -25,6 +25,8 @@
 #include "internal/service/stream_service.hpp"
 #include "internal/spill/spill_scheduler.hpp"
 #include "internal/spill/spill_worker.hpp"
+#include "internal/storage/common/arrow_utils.hpp"
+#include "internal/storage/payload_codec.hpp"
 #include "internal/storage/storage_factory.hpp"
 #include "internal/tiering/pressure_state.hpp"
 #include "internal/tiering/tiering_manager.hpp"
@@ -65,7 +67,9 @@ void BootstrapSqliteSchema(const std::shared_ptr<db::sqlite::SqliteDB>& sqlite_d
       "CREATE TABLE IF NOT EXISTS payload (id BLOB PRIMARY KEY, tier INTEGER NOT NULL, state INTEGER NOT NULL, size_bytes INTEGER NOT NULL, version "
       "INTEGER NOT NULL, expires_at_ms INTEGER, no_evict INTEGER NOT NULL DEFAULT 0, eviction_priority INTEGER NOT NULL DEFAULT 0, spill_target "
       "INTEGER NOT NULL DEFAULT 0, created_at_ms INTEGER NOT NULL DEFAULT (unixepoch() * 1000), "
-      "min_residency_tier INTEGER NOT NULL DEFAULT 0, require_durable INTEGER NOT NULL DEFAULT 0);",
+      "min_residency_tier INTEGER NOT NULL DEFAULT 0, require_durable INTEGER NOT NULL DEFAULT 0, spill_codec INTEGER NOT NULL DEFAULT 0, "
+      "stored_codec INTEGER NOT NULL DEFAULT 0, stored_size_bytes INTEGER NOT NULL DEFAULT 0, checksum_crc32c INTEGER NOT NULL DEFAULT 0, "
+      "content_hash TEXT NOT NULL DEFAULT '', has_checksum INTEGER NOT NULL DEFAULT 0);",
       "CREATE TABLE IF NOT EXISTS payload_metadata (id BLOB PRIMARY KEY, json TEXT NOT NULL, schema TEXT, updated_at_ms INTEGER NOT NULL, FOREIGN "
       "KEY(id) REFERENCES payload(id) ON DELETE CASCADE);",
       "CREATE TABLE IF NOT EXISTS payload_lineage (parent_id BLOB NOT NULL, child_id BLOB NOT NULL, operation TEXT, role TEXT, parameters TEXT, "
@@ -98,6 +102,18 @@ void BootstrapSqliteSchema(const std::shared_ptr<db::sqlite::SqliteDB>& sqlite_d
   // Eviction policy extension: min residency tier and durability requirement.
   TryExecSqlite(sqlite_db, "ALTER TABLE payload ADD COLUMN min_residency_tier INTEGER NOT NULL DEFAULT 0;");
   TryExecSqlite(sqlite_db, "ALTER TABLE payload ADD COLUMN require_durable INTEGER NOT NULL DEFAULT 0;");
+  // Durable-tier compression: requested codec, stored codec and stored size.
+  TryExecSqlite(sqlite_db, "ALTER TABLE payload ADD COLUMN spill_codec INTEGER NOT NULL DEFAULT 0;");
+  TryExecSqlite(sqlite_db, "ALTER TABLE payload ADD COLUMN stored_codec INTEGER NOT NULL DEFAULT 0;");
+  TryExecSqlite(sqlite_db, "ALTER TABLE payload ADD COLUMN stored_size_bytes INTEGER NOT NULL DEFAULT 0;");
+  // Integrity: CRC32C of the payload bytes.
+  TryExecSqlite(sqlite_db, "ALTER TABLE payload ADD COLUMN checksum_crc32c INTEGER NOT NULL DEFAULT 0;");
+  // Content dedup: key of the shared durable blob holding the payload bytes.
+  TryExecSqlite(sqlite_db, "ALTER TABLE payload ADD COLUMN content_hash TEXT NOT NULL DEFAULT '';");
+  sqlite_db->Exec("CREATE INDEX IF NOT EXISTS idx_payload_content_hash ON payload(content_hash);");
+  // Integrity: whether checksum_crc32c holds a checksum. Rows from before the flag used 0 for "none".
+  TryExecSqlite(sqlite_db, "ALTER TABLE payload ADD COLUMN has_checksum INTEGER NOT NULL DEFAULT 0;");
+  sqlite_db->Exec("UPDATE payload SET has_checksum = 1 WHERE has_checksum = 0 AND checksum_crc32c <> 0;");
 
   sqlite_db->Exec("SELECT id,tier,state,size_bytes,version FROM payload LIMIT 1;");
   sqlite_db->Exec("SELECT id,json,schema,updated_at_ms FROM payload_metadata LIMIT 1;");
@@ -116,7 +132,9 @@ void BootstrapPostgresSchema(const std::string& conninfo) {
       "CREATE TABLE IF NOT EXISTS payload (id UUID PRIMARY KEY, tier SMALLINT NOT NULL, state SMALLINT NOT NULL, size_bytes BIGINT NOT NULL, version "
       "BIGINT NOT NULL, expires_at_ms BIGINT, no_evict SMALLINT NOT NULL DEFAULT 0, eviction_priority SMALLINT NOT NULL DEFAULT 0, spill_target "
       "SMALLINT NOT NULL DEFAULT 0, created_at_ms BIGINT NOT NULL DEFAULT 0, "
-      "min_residency_tier SMALLINT NOT NULL DEFAULT 0, require_durable SMALLINT NOT NULL DEFAULT 0);");
+      "min_residency_tier SMALLINT NOT NULL DEFAULT 0, require_durable SMALLINT NOT NULL DEFAULT 0, spill_codec SMALLINT NOT NULL DEFAULT 0, "
+      "stored_codec SMALLINT NOT NULL DEFAULT 0, stored_size_bytes BIGINT NOT NULL DEFAULT 0, checksum_crc32c BIGINT NOT NULL DEFAULT 0, "
+      "content_hash TEXT NOT NULL DEFAULT '', has_checksum SMALLINT NOT NULL DEFAULT 0);");
   // Migrate existing databases that predate the eviction policy columns.
   tx.exec("ALTER TABLE payload ADD COLUMN IF NOT EXISTS no_evict SMALLINT NOT NULL DEFAULT 0;");
   tx.exec("ALTER TABLE payload ADD COLUMN IF NOT EXISTS eviction_priority SMALLINT NOT NULL DEFAULT 0;");
@@ -125,6 +143,18 @@ void BootstrapPostgresSchema(const std::string& conninfo) {
   // Eviction policy extension: min residency tier and durability requirement.
   tx.exec("ALTER TABLE payload ADD COLUMN IF NOT EXISTS min_residency_tier SMALLINT NOT NULL DEFAULT 0;");
   tx.exec("ALTER TABLE payload ADD COLUMN IF NOT EXISTS require_durable SMALLINT NOT NULL DEFAULT 0;");
+  // Durable-tier compression: requested codec, stored codec and stored size.
+  tx.exec("ALTER TABLE payload ADD COLUMN IF NOT EXISTS spill_codec SMALLINT NOT NULL DEFAULT 0;");
+  tx.exec("ALTER TABLE payload ADD COLUMN IF NOT EXISTS stored_codec SMALLINT NOT NULL DEFAULT 0;");
+  tx.exec("ALTER TABLE payload ADD COLUMN IF NOT EXISTS stored_size_bytes BIGINT NOT NULL DEFAULT 0;");
+  // Integrity: CRC32C of the payload bytes.
+  tx.exec("ALTER TABLE payload ADD COLUMN IF NOT EXISTS checksum_crc32c BIGINT NOT NULL DEFAULT 0;");
+  // Content dedup: key of the shared durable blob holding the payload bytes.
+  tx.exec("ALTER TABLE payload ADD COLUMN IF NOT EXISTS content_hash TEXT NOT NULL DEFAULT '';");
+  tx.exec("CREATE INDEX IF NOT EXISTS idx_payload_content_hash ON payload(content_hash);");
+  // Integrity: whether checksum_crc32c holds a checksum. Rows from before the flag used 0 for "none".
+  tx.exec("ALTER TABLE payload ADD COLUMN IF NOT EXISTS has_checksum SMALLINT NOT NULL DEFAULT 0;");
+  tx.exec("UPDATE payload SET has_checksum = 1 WHERE has_checksum = 0 AND checksum_crc32c <> 0;");
   // Rename persist → no_evict for databases created before the field was renamed.
   tx.exec(
       "DO $$ BEGIN "
@@ -276,8 +306,31 @@ Application Build(const payload::runtime::config::RuntimeConfig& config) {
   auto repository     = BuildRepository(config);
 
   auto payload_manager = std::make_shared<core::PayloadManager>(storage_map, lease_mgr, repository, metadata_cache);
+  payload_manager->RestoreFromManifests();
   payload_manager->HydrateCaches();
 
+  storage::TransferOptions transfer_options;
+  if (config.storage().transfer().chunk_bytes() > 0) transfer_options.chunk_bytes = config.storage().transfer().chunk_bytes();
+  if (config.storage().transfer().depth() > 0) transfer_options.depth = config.storage().transfer().depth();
+  if (config.storage().transfer().has_checksum()) transfer_options.checksum = config.storage().transfer().checksum();
+  if (config.storage().disk().kernel_copy() && transfer_options.checksum) {
+    PAYLOAD_LOG_WARN("startup: storage.disk.kernel_copy has no effect while storage.transfer.checksum is on; spills copy through the process");
+  }
+  payload_manager->SetTransferOptions(transfer_options);
+
+  core::PayloadManager::DedupOptions dedup_options;
+  dedup_options.enabled   = config.storage().dedup().enabled();
+  dedup_options.min_bytes = config.storage().dedup().min_bytes();
+  payload_manager->SetDedupOptions(dedup_options);
+
+  // Durable-tier codecs; AUTO resolves by the payload's .bin path, i.e. raw bytes.
+  // A payload's EvictionPolicy.spill_codec overrides these.
+  const auto tier_codec = [](pb::arrow::storage::Compression compression) {
+    return storage::ToPayloadCodec(storage::common::Unwrap(storage::common::ResolveCompression("payload.bin", compression)));
+  };
+  payload_manager->SetTierCodec(payload::manager::v1::TIER_DISK, tier_codec(config.storage().disk().compression()));
+  payload_manager->SetTierCodec(payload::manager::v1::TIER_OBJECT, tier_codec(config.storage().object().compression()));
+
   // ------------------------------------------------------------------
   // Spill system
   // ------------------------------------------------------------------
@@ -308,40 +361,36 @@ Application Build(const payload::runtime::config::RuntimeConfig& config) {
   if (pressure_state->gpu_limit == 0) {
     pressure_state->gpu_limit = std::numeric_limits<uint64_t>::max();
   }
+  for (const auto& node : config.storage().ram().numa_nodes()) {
+    if (node.node() < tiering::PressureState::kMaxNumaNodes) {
+      pressure_state->ram_node_limit[node.node()] = node.capacity_bytes();
+    }
+  }
+  // Striped roots: the sum of their capacities, unbounded if any root is.
   pressure_state->disk_limit = config.storage().disk().capacity_bytes();
+  if (config.storage().disk().roots_size() > 0) {
+    pressure_state->disk_limit = 0;
+    for (const auto& root : config.storage().disk().roots()) {
+      if (root.capacity_bytes() == 0) {
+        pressure_state->disk_limit = 0;
+        break;
+      }
+      pressure_state->disk_limit += root.capacity_bytes();
+    }
+  }
   if (pressure_state->disk_limit == 0) {
     pressure_state->disk_limit = std::numeric_limits<uint64_t>::max();
   }
 
-  auto tiering_policy = std::make_shared<tiering::TieringPolicy>(
-      metadata_cache,
-      // RAM eviction: only consider payloads currently resident in RAM.
-      [pm = payload_manager.get()](const manager::v1::PayloadID& id) {
-        if (pm->IsEvictionExempt(id)) return false;
-        try {
-          return pm->ResolveSnapshot(id).tier() == manager::v1::TIER_RAM;
-        } catch (...) {
-          return false;
-        }
-      },
-      // GPU eviction: only consider payloads currently resident on GPU.
-      [pm = payload_manager.get()](const manager::v1::PayloadID& id) {
-        if (pm->IsEvictionExempt(id)) return false;
-        try {
-          return pm->ResolveSnapshot(id).tier() == manager::v1::TIER_GPU;
-        } catch (...) {
-          return false;
-        }
-      },
-      // Disk eviction: only consider payloads currently resident on disk.
-      [pm = payload_manager.get()](const manager::v1::PayloadID& id) {
-        if (pm->IsEvictionExempt(id)) return false;
-        try {
-          return pm->ResolveSnapshot(id).tier() == manager::v1::TIER_DISK;
-        } catch (...) {
-          return false;
-        }
-      });
+  // Victims come from the payload control blocks, which already restrict
+  // candidates to the requested tier and skip no_evict / pinned payloads.
+  auto tiering_policy = std::make_shared<tiering::TieringPolicy>(tiering::TieringPolicy::LruSource(
+      [pm = payload_manager.get()](manager::v1::Tier tier, const std::function<bool(const manager::v1::PayloadID&)>& include) {
+        return pm->LeastRecentlyUsed(tier, include);
+      }));
+  if (config.storage().ram().numa_nodes_size() > 0) {
+    tiering_policy->SetRamNodeSource([pm = payload_manager.get()](const manager::v1::PayloadID& id) { return pm->GetRamNumaNode(id); });
+  }
 
   auto tiering_manager = std::make_shared<tiering::TieringManager>(tiering_policy, spill_scheduler, payload_manager, pressure_state);
   tiering_manager->Start();
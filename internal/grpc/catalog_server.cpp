@@ -28,6 +28,26 @@ CatalogServer::CatalogServer(std::shared_ptr<payload::service::CatalogService> s
   }
 }
 
+::grpc::Status CatalogServer::AllocatePayloads(::grpc::ServerContext*, const payload::manager::v1::AllocatePayloadsRequest* req,
+                                               payload::manager::v1::AllocatePayloadsResponse* resp) {
+  try {
+    *resp = service_->AllocateBatch(*req);
+    return ::grpc::Status::OK;
+  } catch (const std::exception& e) {
+    return ToStatus(e);
+  }
+}
+
+::grpc::Status CatalogServer::CommitPayloads(::grpc::ServerContext*, const payload::manager::v1::CommitPayloadsRequest* req,
+                                             payload::manager::v1::CommitPayloadsResponse* resp) {
+  try {
+    *resp = service_->CommitBatch(*req);
+    return ::grpc::Status::OK;
+  } catch (const std::exception& e) {
+    return ToStatus(e);
+  }
+}
+
 ::grpc::Status CatalogServer::Delete(::grpc::ServerContext*, const payload::manager::v1::DeleteRequest* req, google::protobuf::Empty*) {
   try {
     service_->Delete(*req);
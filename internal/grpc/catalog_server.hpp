@@ -20,6 +20,12 @@ class CatalogServer final : public payload::manager::v1::PayloadCatalogService::
   ::grpc::Status CommitPayload(::grpc::ServerContext*, const payload::manager::v1::CommitPayloadRequest*,
                                payload::manager::v1::CommitPayloadResponse*) override;
 
+  ::grpc::Status AllocatePayloads(::grpc::ServerContext*, const payload::manager::v1::AllocatePayloadsRequest*,
+                                  payload::manager::v1::AllocatePayloadsResponse*) override;
+
+  ::grpc::Status CommitPayloads(::grpc::ServerContext*, const payload::manager::v1::CommitPayloadsRequest*,
+                                payload::manager::v1::CommitPayloadsResponse*) override;
+
   ::grpc::Status Delete(::grpc::ServerContext*, const payload::manager::v1::DeleteRequest*, google::protobuf::Empty*) override;
 
   ::grpc::Status Promote(::grpc::ServerContext*, const payload::manager::v1::PromoteRequest*, payload::manager::v1::PromoteResponse*) override;
@@ -37,4 +37,33 @@ DataServer::DataServer(std::shared_ptr<payload::service::DataService> svc) : ser
   }
 }
 
+::grpc::Status DataServer::ResolveSnapshots(::grpc::ServerContext*, const payload::manager::v1::ResolveSnapshotsRequest* req,
+                                            payload::manager::v1::ResolveSnapshotsResponse* resp) {
+  try {
+    *resp = service_->ResolveSnapshots(*req);
+    return ::grpc::Status::OK;
+  } catch (const std::exception& e) {
+    return ToStatus(e);
+  }
+}
+
+::grpc::Status DataServer::AcquireReadLeases(::grpc::ServerContext*, const payload::manager::v1::AcquireReadLeasesRequest* req,
+                                             payload::manager::v1::AcquireReadLeasesResponse* resp) {
+  try {
+    *resp = service_->AcquireReadLeases(*req);
+    return ::grpc::Status::OK;
+  } catch (const std::exception& e) {
+    return ToStatus(e);
+  }
+}
+
+::grpc::Status DataServer::ReleaseLeases(::grpc::ServerContext*, const payload::manager::v1::ReleaseLeasesRequest* req, google::protobuf::Empty*) {
+  try {
+    service_->ReleaseLeases(*req);
+    return ::grpc::Status::OK;
+  } catch (const std::exception& e) {
+    return ToStatus(e);
+  }
+}
+
 } // namespace payload::grpc
@@ -23,6 +23,15 @@ class DataServer final : public payload::manager::v1::PayloadDataService::Servic
   ::grpc::Status ReleaseLease(::grpc::ServerContext* ctx, const payload::manager::v1::ReleaseLeaseRequest* req,
                               google::protobuf::Empty* resp) override;
 
+  ::grpc::Status ResolveSnapshots(::grpc::ServerContext* ctx, const payload::manager::v1::ResolveSnapshotsRequest* req,
+                                  payload::manager::v1::ResolveSnapshotsResponse* resp) override;
+
+  ::grpc::Status AcquireReadLeases(::grpc::ServerContext* ctx, const payload::manager::v1::AcquireReadLeasesRequest* req,
+                                   payload::manager::v1::AcquireReadLeasesResponse* resp) override;
+
+  ::grpc::Status ReleaseLeases(::grpc::ServerContext* ctx, const payload::manager::v1::ReleaseLeasesRequest* req,
+                               google::protobuf::Empty* resp) override;
+
  private:
   std::shared_ptr<payload::service::DataService> service_;
 };
@@ -25,6 +25,9 @@ namespace payload::grpc {
   if (dynamic_cast<const InvalidArgument*>(&e)) {
     return {::grpc::StatusCode::INVALID_ARGUMENT, e.what()};
   }
+  if (dynamic_cast<const DataLoss*>(&e)) {
+    return {::grpc::StatusCode::DATA_LOSS, e.what()};
+  }
 
   return {::grpc::StatusCode::INTERNAL, e.what()};
 }
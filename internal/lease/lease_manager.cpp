@@ -12,8 +12,8 @@ payload::manager::v1::LeaseID LeaseManager::GenerateLeaseID() {
   return payload::util::ToLeaseProto(payload::util::GenerateUUID());
 }
 
-Lease LeaseManager::Acquire(const payload::manager::v1::PayloadID& id, const payload::manager::v1::PayloadDescriptor& payload_descriptor,
-                            uint64_t min_duration_ms) {
+Lease LeaseManager::BuildLease(const payload::manager::v1::PayloadID& id, const payload::manager::v1::PayloadDescriptor& payload_descriptor,
+                               uint64_t min_duration_ms) const {
   // Apply default: a caller that passes 0 gets the configured default duration.
   uint64_t duration_ms = (min_duration_ms == 0) ? default_lease_ms_ : min_duration_ms;
 
@@ -27,14 +27,32 @@ Lease LeaseManager::Acquire(const payload::manager::v1::PayloadID& id, const pay
   lease.payload_id         = id;
   lease.payload_descriptor = payload_descriptor;
   lease.expires_at         = std::chrono::system_clock::now() + std::chrono::milliseconds(duration_ms);
+  return lease;
+}
+
+Lease LeaseManager::Acquire(const payload::manager::v1::PayloadID& id, const payload::manager::v1::PayloadDescriptor& payload_descriptor,
+                            uint64_t min_duration_ms) {
+  return table_.Insert(BuildLease(id, payload_descriptor, min_duration_ms));
+}
 
-  return table_.Insert(lease);
+std::vector<Lease> LeaseManager::AcquireBatch(const std::vector<AcquireSpec>& specs) {
+  // Lease ids and expiry are computed before the table lock is taken.
+  std::vector<Lease> leases;
+  leases.reserve(specs.size());
+  for (const auto& spec : specs) {
+    leases.push_back(BuildLease(spec.id, spec.payload_descriptor, spec.min_duration_ms));
+  }
+  return table_.InsertBatch(leases);
 }
 
 void LeaseManager::Release(const payload::manager::v1::LeaseID& lease_id) {
   table_.Remove(lease_id);
 }
 
+void LeaseManager::ReleaseBatch(const std::vector<payload::manager::v1::LeaseID>& lease_ids) {
+  table_.RemoveBatch(lease_ids);
+}
+
 bool LeaseManager::HasActiveLeases(const payload::manager::v1::PayloadID& id) {
   return table_.HasActive(id);
 }
@@ -43,6 +61,10 @@ uint32_t LeaseManager::CountActiveLeases(const payload::manager::v1::PayloadID&
   return table_.CountActive(id);
 }
 
+bool LeaseManager::HasHolders(const payload::manager::v1::PayloadID& id) {
+  return table_.HasAny(id);
+}
+
 void LeaseManager::InvalidateAll(const payload::manager::v1::PayloadID& id) {
   table_.RemoveAll(id);
 }
@@ -3,6 +3,7 @@
 #include <chrono>
 #include <cstdint>
 #include <memory>
+#include <vector>
 
 #include "lease.hpp"
 #include "lease_table.hpp"
@@ -21,9 +22,25 @@ class LeaseManager {
 
   void Release(const payload::manager::v1::LeaseID& lease_id);
 
+  // Arguments for one Acquire call; the element type of AcquireBatch.
+  struct AcquireSpec {
+    payload::manager::v1::PayloadID         id;
+    payload::manager::v1::PayloadDescriptor payload_descriptor;
+    uint64_t                                min_duration_ms{0};
+  };
+
+  // Batch forms of Acquire/Release: the lease table is locked once per call.
+  // AcquireBatch returns leases in the order of specs.
+  std::vector<Lease> AcquireBatch(const std::vector<AcquireSpec>& specs);
+  void               ReleaseBatch(const std::vector<payload::manager::v1::LeaseID>& lease_ids);
+
   bool     HasActiveLeases(const payload::manager::v1::PayloadID& id);
   uint32_t CountActiveLeases(const payload::manager::v1::PayloadID& id);
 
+  // True while any lease on the payload is unreleased and unexpired,
+  // including leases InvalidateAll revoked.
+  bool HasHolders(const payload::manager::v1::PayloadID& id);
+
   void InvalidateAll(const payload::manager::v1::PayloadID& id);
 
   // Block until no active leases remain for the given payload, or deadline is reached.
@@ -36,6 +53,8 @@ class LeaseManager {
   uint64_t   max_lease_ms_;
 
   static payload::manager::v1::LeaseID GenerateLeaseID();
+  Lease                                BuildLease(const payload::manager::v1::PayloadID&         id,
+                                                  const payload::manager::v1::PayloadDescriptor& payload_descriptor, uint64_t min_duration_ms) const;
 };
 
 } // namespace payload::lease
@@ -18,7 +18,20 @@ bool LeaseTable::IsExpired(const Lease& lease, Clock::time_point now) {
 
 Lease LeaseTable::Insert(const Lease& lease) {
   std::lock_guard lock(mutex_);
+  InsertLocked(lease, Clock::now());
+  return lease;
+}
 
+std::vector<Lease> LeaseTable::InsertBatch(const std::vector<Lease>& leases) {
+  std::lock_guard lock(mutex_);
+  const auto      now = Clock::now();
+  for (const auto& lease : leases) {
+    InsertLocked(lease, now);
+  }
+  return leases;
+}
+
+void LeaseTable::InsertLocked(const Lease& lease, Clock::time_point now) {
   const auto lease_key = Key(lease.lease_id);
   if (auto existing = leases_.find(lease_key); existing != leases_.end()) {
     auto old_range = by_payload_.equal_range(Key(existing->second.payload_id));
@@ -32,7 +45,6 @@ Lease LeaseTable::Insert(const Lease& lease) {
 
   // Expire stale leases for this payload only, using equal_range to avoid an
   // O(total_leases) scan over all payloads.
-  const auto now         = Clock::now();
   const auto payload_key = Key(lease.payload_id);
   auto       range       = by_payload_.equal_range(payload_key);
   for (auto it = range.first; it != range.second;) {
@@ -47,30 +59,42 @@ Lease LeaseTable::Insert(const Lease& lease) {
 
   leases_[lease_key] = lease;
   by_payload_.emplace(payload_key, lease_key);
-  return lease;
 }
 
 void LeaseTable::Remove(const payload::manager::v1::LeaseID& lease_id) {
   {
     std::lock_guard lock(mutex_);
+    RemoveLocked(lease_id);
+  }
+  release_cv_.notify_all();
+}
+
+void LeaseTable::RemoveBatch(const std::vector<payload::manager::v1::LeaseID>& lease_ids) {
+  {
+    std::lock_guard lock(mutex_);
+    for (const auto& lease_id : lease_ids) {
+      RemoveLocked(lease_id);
+    }
+  }
+  release_cv_.notify_all();
+}
 
-    const auto lease_key = Key(lease_id);
-    invalidated_leases_.erase(lease_key);
+void LeaseTable::RemoveLocked(const payload::manager::v1::LeaseID& lease_id) {
+  const auto lease_key = Key(lease_id);
+  invalidated_leases_.erase(lease_key);
 
-    auto it = leases_.find(lease_key);
-    if (it == leases_.end()) return;
+  auto it = leases_.find(lease_key);
+  if (it == leases_.end()) return;
 
-    auto range = by_payload_.equal_range(Key(it->second.payload_id));
-    for (auto i = range.first; i != range.second; ++i) {
-      if (i->second == lease_key) {
-        by_payload_.erase(i);
-        break;
-      }
+  auto range = by_payload_.equal_range(Key(it->second.payload_id));
+  for (auto i = range.first; i != range.second; ++i) {
+    if (i->second == lease_key) {
+      by_payload_.erase(i);
+      break;
     }
-
-    leases_.erase(it);
   }
-  release_cv_.notify_all();
+
+  leases_.erase(it);
 }
 
 bool LeaseTable::HasActive(const payload::manager::v1::PayloadID& id) {
@@ -78,6 +102,13 @@ bool LeaseTable::HasActive(const payload::manager::v1::PayloadID& id) {
   return HasActiveLocked(Key(id), Clock::now());
 }
 
+bool LeaseTable::HasAny(const payload::manager::v1::PayloadID& id) {
+  std::lock_guard lock(mutex_);
+  const auto      payload_key = Key(id);
+  HasActiveLocked(payload_key, Clock::now()); // sweep expired entries
+  return HasAnyLocked(payload_key);
+}
+
 uint32_t LeaseTable::CountActive(const payload::manager::v1::PayloadID& id) {
   std::lock_guard lock(mutex_);
 
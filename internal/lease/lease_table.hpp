@@ -17,9 +17,17 @@ class LeaseTable {
 
   void Remove(const payload::manager::v1::LeaseID& lease_id);
 
+  // Batch forms: take the table lock once for all entries.
+  std::vector<Lease> InsertBatch(const std::vector<Lease>& leases);
+  void               RemoveBatch(const std::vector<payload::manager::v1::LeaseID>& lease_ids);
+
   bool     HasActive(const payload::manager::v1::PayloadID& id);
   uint32_t CountActive(const payload::manager::v1::PayloadID& id);
 
+  // Like HasActive, but also counts invalidated leases that are neither
+  // released nor expired: their holders may still be reading.
+  bool HasAny(const payload::manager::v1::PayloadID& id);
+
   // Mark all active leases for the payload as invalidated so that HasActive
   // returns false immediately, but keep them in the table until the lease
   // holders call Remove(). This allows WaitUntilNoLeases to detect when all
@@ -45,6 +53,8 @@ class LeaseTable {
   static std::string Key(const payload::manager::v1::PayloadID& id);
   static std::string Key(const payload::manager::v1::LeaseID& id);
   static bool        IsExpired(const Lease& lease, Clock::time_point now);
+  void               InsertLocked(const Lease& lease, Clock::time_point now);
+  void               RemoveLocked(const payload::manager::v1::LeaseID& lease_id);
   bool               HasActiveLocked(const std::string& payload_key, Clock::time_point now);
   bool               HasAnyLocked(const std::string& payload_key) const;
 };
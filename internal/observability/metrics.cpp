@@ -16,6 +16,7 @@
 #include <chrono>
 #include <cstdlib>
 #include <limits>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <unordered_map>
@@ -134,23 +135,30 @@ void RecordWithAttributes(const opentelemetry::nostd::shared_ptr<Instrument>& in
 
 // Histogram bucket boundaries capped at 1 s (1000 ms) for request-latency
 // and spill-duration metrics.  Prometheus heatmap panels in Grafana reflect
-// these boundaries as the y-axis range.
+// these boundaries as the y-axis range.  Compression ratio and codec
+// throughput get buckets spanning the range real codecs produce.
 std::unique_ptr<sdkmetrics::ViewRegistry> MakeViewRegistry() {
   auto view_registry = std::make_unique<sdkmetrics::ViewRegistry>();
 
   // Sub-millisecond through 1 s, logarithmically spaced.
   const std::vector<double> kMsBuckets = {0.5, 1, 2, 5, 10, 20, 50, 100, 200, 500, 1000};
 
-  auto add_hist_view = [&](const std::string& instrument_name) {
+  const std::vector<double> kRatioBuckets = {1, 1.25, 1.5, 2, 3, 4, 6, 8, 16, 32};
+  const std::vector<double> kMbpsBuckets  = {10, 50, 100, 250, 500, 1000, 2000, 4000, 8000};
+
+  auto add_hist_view = [&](const std::string& instrument_name, const std::string& unit = "ms", const std::vector<double>* buckets = nullptr) {
     auto agg_cfg         = std::make_shared<sdkmetrics::HistogramAggregationConfig>();
-    agg_cfg->boundaries_ = kMsBuckets;
-    view_registry->AddView(std::make_unique<sdkmetrics::InstrumentSelector>(sdkmetrics::InstrumentType::kHistogram, instrument_name, "ms"),
+    agg_cfg->boundaries_ = buckets ? *buckets : kMsBuckets;
+    view_registry->AddView(std::make_unique<sdkmetrics::InstrumentSelector>(sdkmetrics::InstrumentType::kHistogram, instrument_name, unit),
                            std::make_unique<sdkmetrics::MeterSelector>("payload-manager", "0.1.0", ""),
                            std::make_unique<sdkmetrics::View>(instrument_name, "", sdkmetrics::AggregationType::kHistogram, agg_cfg));
   };
 
   add_hist_view("payload.request.latency_ms");
   add_hist_view("payload.spill.duration_ms");
+  add_hist_view("payload.spill.queue_wait_ms");
+  add_hist_view("payload.compression.ratio", "1", &kRatioBuckets);
+  add_hist_view("payload.compression.throughput_mbps", "MBy/s", &kMbpsBuckets);
   return view_registry;
 }
 
@@ -163,16 +171,35 @@ struct Metrics::Impl {
   opentelemetry::nostd::shared_ptr<metrics_api::Histogram<double>>      request_latency_ms;
   opentelemetry::nostd::shared_ptr<metrics_api::Histogram<double>>      spill_duration_ms;
   opentelemetry::nostd::shared_ptr<metrics_api::Counter<std::uint64_t>> spill_bytes_total;
+  opentelemetry::nostd::shared_ptr<metrics_api::Histogram<double>>      spill_queue_wait_ms;
+  opentelemetry::nostd::shared_ptr<metrics_api::Counter<std::uint64_t>> spill_task_count;
+  opentelemetry::nostd::shared_ptr<metrics_api::Histogram<double>>      compression_ratio;
+  opentelemetry::nostd::shared_ptr<metrics_api::Histogram<double>>      compression_throughput_mbps;
   opentelemetry::nostd::shared_ptr<metrics_api::ObservableInstrument>   tier_occupancy_gauge;
   opentelemetry::nostd::shared_ptr<metrics_api::ObservableInstrument>   tier_count_gauge;
   opentelemetry::nostd::shared_ptr<metrics_api::Counter<std::uint64_t>> allocation_failure_count;
   opentelemetry::nostd::shared_ptr<metrics_api::ObservableInstrument>   spill_queue_depth_gauge;
+  opentelemetry::nostd::shared_ptr<metrics_api::ObservableInstrument>   ram_slab_bytes_gauge;
+  opentelemetry::nostd::shared_ptr<metrics_api::ObservableInstrument>   ram_segment_count_gauge;
+  opentelemetry::nostd::shared_ptr<metrics_api::ObservableInstrument>   ram_numa_node_bytes_gauge;
+  opentelemetry::nostd::shared_ptr<metrics_api::ObservableInstrument>   disk_device_bytes_gauge;
+  opentelemetry::nostd::shared_ptr<metrics_api::ObservableInstrument>   disk_device_queue_depth_gauge;
+  opentelemetry::nostd::shared_ptr<metrics_api::ObservableInstrument>   disk_device_io_bytes_counter;
 
   std::mutex                                    tier_occupancy_mutex;
   std::unordered_map<std::string, std::int64_t> tier_occupancy_values;
   std::mutex                                    tier_count_mutex;
   std::unordered_map<std::string, std::int64_t> tier_count_values;
   std::atomic<std::int64_t>                     spill_queue_depth{0};
+  std::mutex                                    ram_slab_mutex;
+  std::unordered_map<std::string, std::int64_t> ram_slab_bytes_values;
+  std::unordered_map<std::string, std::int64_t> ram_segment_count_values;
+  std::unordered_map<std::string, std::int64_t> ram_numa_node_bytes_values;
+  // Keyed by (device, kind / direction).
+  std::mutex                                                  disk_device_mutex;
+  std::map<std::pair<std::string, std::string>, std::int64_t> disk_device_bytes_values;
+  std::unordered_map<std::string, std::int64_t>               disk_device_queue_depth_values;
+  std::map<std::pair<std::string, std::string>, std::int64_t> disk_device_io_bytes_values;
 };
 
 bool InitializeMetrics(const OtlpConfig& config) {
@@ -281,11 +308,31 @@ Metrics::Metrics() : impl_(std::make_unique<Impl>()) {
   impl_->request_latency_ms = impl_->meter->CreateDoubleHistogram("payload.request.latency_ms", "ms", "End-to-end request latency in milliseconds");
   impl_->spill_duration_ms  = impl_->meter->CreateDoubleHistogram("payload.spill.duration_ms", "ms", "Spill operation duration in milliseconds");
   impl_->spill_bytes_total  = impl_->meter->CreateUInt64Counter("payload.spill.bytes_total", "By", "Total bytes moved by spill operations");
+  impl_->spill_queue_wait_ms =
+      impl_->meter->CreateDoubleHistogram("payload.spill.queue_wait_ms", "ms", "Time spill tasks spent queued before a worker took them");
+  impl_->spill_task_count =
+      impl_->meter->CreateUInt64Counter("payload.spill.task_count", "1", "Spill tasks queued, coalesced into another, or cancelled");
+  impl_->compression_ratio =
+      impl_->meter->CreateDoubleHistogram("payload.compression.ratio", "1", "Uncompressed / stored bytes per durable-tier encode or decode");
+  impl_->compression_throughput_mbps = impl_->meter->CreateDoubleHistogram("payload.compression.throughput_mbps", "MBy/s",
+                                                                           "Uncompressed bytes per second through the payload codec");
   impl_->allocation_failure_count =
       impl_->meter->CreateUInt64Counter("payload.allocation.failure_count", "1", "Total number of allocation failures due to tier capacity");
   impl_->tier_occupancy_gauge    = impl_->meter->CreateInt64ObservableGauge("payload.tier.occupancy_bytes", "Current tier occupancy in bytes", "By");
   impl_->tier_count_gauge        = impl_->meter->CreateInt64ObservableGauge("payload.tier.payload_count", "Number of payloads per tier", "1");
   impl_->spill_queue_depth_gauge = impl_->meter->CreateInt64ObservableGauge("payload.spill.queue_depth", "Number of payloads queued for spill", "1");
+  impl_->ram_slab_bytes_gauge =
+      impl_->meter->CreateInt64ObservableGauge("payload.ram.slab_bytes", "RAM slab arena bytes by kind (capacity, allocated, requested)", "By");
+  impl_->ram_segment_count_gauge =
+      impl_->meter->CreateInt64ObservableGauge("payload.ram.segment_count", "RAM segments by kind (slab, dedicated, hugepage)", "1");
+  impl_->ram_numa_node_bytes_gauge =
+      impl_->meter->CreateInt64ObservableGauge("payload.ram.numa_node_bytes", "RAM payload bytes placed on each NUMA node", "By");
+  impl_->disk_device_bytes_gauge =
+      impl_->meter->CreateInt64ObservableGauge("payload.disk.device_bytes", "Disk root bytes by kind (capacity, used, free)", "By");
+  impl_->disk_device_queue_depth_gauge =
+      impl_->meter->CreateInt64ObservableGauge("payload.disk.device_queue_depth", "Reads, writes and streams in flight per disk root", "1");
+  impl_->disk_device_io_bytes_counter = impl_->meter->CreateInt64ObservableCounter(
+      "payload.disk.device_io_bytes", "Payload bytes read / written per disk root since startup (rate gives bandwidth)", "By");
   impl_->spill_queue_depth_gauge->AddCallback(
       [](metrics_api::ObserverResult result, void* state) {
         auto* impl       = static_cast<Impl*>(state);
@@ -323,6 +370,72 @@ Metrics::Metrics() : impl_(std::make_unique<Impl>()) {
         }
       },
       impl_.get());
+  impl_->ram_slab_bytes_gauge->AddCallback(
+      [](metrics_api::ObserverResult result, void* state) {
+        auto*                       impl = static_cast<Impl*>(state);
+        std::lock_guard<std::mutex> lock(impl->ram_slab_mutex);
+        auto int_result = opentelemetry::nostd::get<opentelemetry::nostd::shared_ptr<metrics_api::ObserverResultT<std::int64_t>>>(result);
+        for (const auto& [kind, bytes] : impl->ram_slab_bytes_values) {
+          const std::initializer_list<AttributePair> attributes = {{"kind", kind}};
+          int_result->Observe(bytes, attributes);
+        }
+      },
+      impl_.get());
+  impl_->ram_segment_count_gauge->AddCallback(
+      [](metrics_api::ObserverResult result, void* state) {
+        auto*                       impl = static_cast<Impl*>(state);
+        std::lock_guard<std::mutex> lock(impl->ram_slab_mutex);
+        auto int_result = opentelemetry::nostd::get<opentelemetry::nostd::shared_ptr<metrics_api::ObserverResultT<std::int64_t>>>(result);
+        for (const auto& [kind, count] : impl->ram_segment_count_values) {
+          const std::initializer_list<AttributePair> attributes = {{"kind", kind}};
+          int_result->Observe(count, attributes);
+        }
+      },
+      impl_.get());
+  impl_->ram_numa_node_bytes_gauge->AddCallback(
+      [](metrics_api::ObserverResult result, void* state) {
+        auto*                       impl = static_cast<Impl*>(state);
+        std::lock_guard<std::mutex> lock(impl->ram_slab_mutex);
+        auto int_result = opentelemetry::nostd::get<opentelemetry::nostd::shared_ptr<metrics_api::ObserverResultT<std::int64_t>>>(result);
+        for (const auto& [node, bytes] : impl->ram_numa_node_bytes_values) {
+          const std::initializer_list<AttributePair> attributes = {{"node", node}};
+          int_result->Observe(bytes, attributes);
+        }
+      },
+      impl_.get());
+  impl_->disk_device_bytes_gauge->AddCallback(
+      [](metrics_api::ObserverResult result, void* state) {
+        auto*                       impl = static_cast<Impl*>(state);
+        std::lock_guard<std::mutex> lock(impl->disk_device_mutex);
+        auto int_result = opentelemetry::nostd::get<opentelemetry::nostd::shared_ptr<metrics_api::ObserverResultT<std::int64_t>>>(result);
+        for (const auto& [key, bytes] : impl->disk_device_bytes_values) {
+          const std::initializer_list<AttributePair> attributes = {{"device", key.first}, {"kind", key.second}};
+          int_result->Observe(bytes, attributes);
+        }
+      },
+      impl_.get());
+  impl_->disk_device_queue_depth_gauge->AddCallback(
+      [](metrics_api::ObserverResult result, void* state) {
+        auto*                       impl = static_cast<Impl*>(state);
+        std::lock_guard<std::mutex> lock(impl->disk_device_mutex);
+        auto int_result = opentelemetry::nostd::get<opentelemetry::nostd::shared_ptr<metrics_api::ObserverResultT<std::int64_t>>>(result);
+        for (const auto& [device, depth] : impl->disk_device_queue_depth_values) {
+          const std::initializer_list<AttributePair> attributes = {{"device", device}};
+          int_result->Observe(depth, attributes);
+        }
+      },
+      impl_.get());
+  impl_->disk_device_io_bytes_counter->AddCallback(
+      [](metrics_api::ObserverResult result, void* state) {
+        auto*                       impl = static_cast<Impl*>(state);
+        std::lock_guard<std::mutex> lock(impl->disk_device_mutex);
+        auto int_result = opentelemetry::nostd::get<opentelemetry::nostd::shared_ptr<metrics_api::ObserverResultT<std::int64_t>>>(result);
+        for (const auto& [key, bytes] : impl->disk_device_io_bytes_values) {
+          const std::initializer_list<AttributePair> attributes = {{"device", key.first}, {"direction", key.second}};
+          int_result->Observe(bytes, attributes);
+        }
+      },
+      impl_.get());
 }
 
 Metrics& Metrics::Instance() {
@@ -381,6 +494,22 @@ void Metrics::RecordSpillBytes(std::string_view op, std::uint64_t bytes) {
   AddWithAttributes(impl_->spill_bytes_total, bytes, attributes);
 }
 
+void Metrics::RecordCompression(std::string_view codec, std::string_view direction, std::uint64_t raw_bytes, std::uint64_t stored_bytes,
+                                double duration_ms) {
+  if (!impl_ || !impl_->compression_ratio || !g_metrics_options.spill_metrics_enabled || raw_bytes == 0 || stored_bytes == 0) {
+    return;
+  }
+
+  const opentelemetry::nostd::string_view    codec_sv(codec.data(), codec.size());
+  const opentelemetry::nostd::string_view    direction_sv(direction.data(), direction.size());
+  const std::initializer_list<AttributePair> attributes = {{"codec", codec_sv}, {"direction", direction_sv}};
+  RecordWithAttributes(impl_->compression_ratio, static_cast<double>(raw_bytes) / static_cast<double>(stored_bytes), attributes);
+  if (duration_ms > 0) {
+    const double mbps = static_cast<double>(raw_bytes) / (1024.0 * 1024.0) / (duration_ms / 1000.0);
+    RecordWithAttributes(impl_->compression_throughput_mbps, mbps, attributes);
+  }
+}
+
 void Metrics::RecordAllocationFailure(std::string_view tier) {
   if (!impl_ || !impl_->allocation_failure_count || !g_metrics_options.request_metrics_enabled) {
     return;
@@ -399,6 +528,27 @@ void Metrics::SetSpillQueueDepth(std::size_t depth) {
   impl_->spill_queue_depth.store(static_cast<std::int64_t>(depth));
 }
 
+void Metrics::ObserveSpillQueueWaitMs(std::string_view priority, double wait_ms) {
+  if (!impl_ || !impl_->spill_queue_wait_ms || !g_metrics_options.spill_metrics_enabled) {
+    return;
+  }
+
+  const opentelemetry::nostd::string_view    priority_sv(priority.data(), priority.size());
+  const std::initializer_list<AttributePair> attributes = {{"priority", priority_sv}};
+  RecordWithAttributes(impl_->spill_queue_wait_ms, wait_ms, attributes);
+}
+
+void Metrics::RecordSpillTask(std::string_view priority, std::string_view outcome) {
+  if (!impl_ || !impl_->spill_task_count || !g_metrics_options.spill_metrics_enabled) {
+    return;
+  }
+
+  const opentelemetry::nostd::string_view    priority_sv(priority.data(), priority.size());
+  const opentelemetry::nostd::string_view    outcome_sv(outcome.data(), outcome.size());
+  const std::initializer_list<AttributePair> attributes = {{"priority", priority_sv}, {"outcome", outcome_sv}};
+  AddWithAttributes(impl_->spill_task_count, static_cast<std::uint64_t>(1), attributes);
+}
+
 void Metrics::SetTierOccupancyBytes(std::string_view tier, std::uint64_t bytes) {
   if (!impl_ || !impl_->tier_occupancy_gauge || !g_metrics_options.tier_occupancy_metrics_enabled) {
     return;
@@ -420,6 +570,66 @@ void Metrics::SetTierPayloadCount(std::string_view tier, std::uint64_t count) {
       static_cast<std::int64_t>(std::min(count, static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max())));
 }
 
+void Metrics::SetRamSlabBytes(std::string_view kind, std::uint64_t bytes) {
+  if (!impl_ || !impl_->ram_slab_bytes_gauge || !g_metrics_options.tier_occupancy_metrics_enabled) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(impl_->ram_slab_mutex);
+  impl_->ram_slab_bytes_values[std::string(kind)] =
+      static_cast<std::int64_t>(std::min(bytes, static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max())));
+}
+
+void Metrics::SetRamSegmentCount(std::string_view kind, std::uint64_t count) {
+  if (!impl_ || !impl_->ram_segment_count_gauge || !g_metrics_options.tier_occupancy_metrics_enabled) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(impl_->ram_slab_mutex);
+  impl_->ram_segment_count_values[std::string(kind)] =
+      static_cast<std::int64_t>(std::min(count, static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max())));
+}
+
+void Metrics::SetRamNumaNodeBytes(std::uint32_t node, std::uint64_t bytes) {
+  if (!impl_ || !impl_->ram_numa_node_bytes_gauge || !g_metrics_options.tier_occupancy_metrics_enabled) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(impl_->ram_slab_mutex);
+  impl_->ram_numa_node_bytes_values[std::to_string(node)] =
+      static_cast<std::int64_t>(std::min(bytes, static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max())));
+}
+
+void Metrics::SetDiskDeviceBytes(std::string_view device, std::string_view kind, std::uint64_t bytes) {
+  if (!impl_ || !impl_->disk_device_bytes_gauge || !g_metrics_options.tier_occupancy_metrics_enabled) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(impl_->disk_device_mutex);
+  impl_->disk_device_bytes_values[{std::string(device), std::string(kind)}] =
+      static_cast<std::int64_t>(std::min(bytes, static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max())));
+}
+
+void Metrics::SetDiskDeviceQueueDepth(std::string_view device, std::uint64_t depth) {
+  if (!impl_ || !impl_->disk_device_queue_depth_gauge || !g_metrics_options.tier_occupancy_metrics_enabled) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(impl_->disk_device_mutex);
+  impl_->disk_device_queue_depth_values[std::string(device)] =
+      static_cast<std::int64_t>(std::min(depth, static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max())));
+}
+
+void Metrics::SetDiskDeviceIoBytes(std::string_view device, std::string_view direction, std::uint64_t bytes) {
+  if (!impl_ || !impl_->disk_device_io_bytes_counter || !g_metrics_options.tier_occupancy_metrics_enabled) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(impl_->disk_device_mutex);
+  impl_->disk_device_io_bytes_values[{std::string(device), std::string(direction)}] =
+      static_cast<std::int64_t>(std::min(bytes, static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max())));
+}
+
 } // namespace payload::observability
 
 #endif
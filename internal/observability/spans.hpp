@@ -62,10 +62,26 @@ class Metrics {
   void ObserveRequestLatencyMs(std::string_view route, double latency_ms);
   void ObserveSpillDurationMs(std::string_view op, double duration_ms);
   void RecordSpillBytes(std::string_view op, std::uint64_t bytes);
+  // One durable-tier encode or decode: ratio is raw / stored bytes,
+  // throughput is raw bytes per second through the codec.
+  void RecordCompression(std::string_view codec, std::string_view direction, std::uint64_t raw_bytes, std::uint64_t stored_bytes,
+                         double duration_ms);
   void SetTierOccupancyBytes(std::string_view tier, std::uint64_t bytes);
   void SetTierPayloadCount(std::string_view tier, std::uint64_t count);
+  void SetRamSlabBytes(std::string_view kind, std::uint64_t bytes);
+  void SetRamSegmentCount(std::string_view kind, std::uint64_t count);
+  void SetRamNumaNodeBytes(std::uint32_t node, std::uint64_t bytes);
+  // Per disk root: bytes by kind (capacity, used, free), operations in
+  // flight, and cumulative bytes by direction (read, write).
+  void SetDiskDeviceBytes(std::string_view device, std::string_view kind, std::uint64_t bytes);
+  void SetDiskDeviceQueueDepth(std::string_view device, std::uint64_t depth);
+  void SetDiskDeviceIoBytes(std::string_view device, std::string_view direction, std::uint64_t bytes);
   void RecordAllocationFailure(std::string_view tier);
   void SetSpillQueueDepth(std::size_t depth);
+  // Time a spill task spent queued before a worker took it, by priority class.
+  void ObserveSpillQueueWaitMs(std::string_view priority, double wait_ms);
+  // One spill task queued, coalesced into another, or cancelled, by priority class.
+  void RecordSpillTask(std::string_view priority, std::string_view outcome);
 
  private:
   Metrics();
@@ -143,17 +159,44 @@ inline void Metrics::ObserveSpillDurationMs(std::string_view, double) {
 inline void Metrics::RecordSpillBytes(std::string_view, std::uint64_t) {
 }
 
+inline void Metrics::RecordCompression(std::string_view, std::string_view, std::uint64_t, std::uint64_t, double) {
+}
+
 inline void Metrics::SetTierOccupancyBytes(std::string_view, std::uint64_t) {
 }
 
 inline void Metrics::SetTierPayloadCount(std::string_view, std::uint64_t) {
 }
 
+inline void Metrics::SetRamSlabBytes(std::string_view, std::uint64_t) {
+}
+
+inline void Metrics::SetRamSegmentCount(std::string_view, std::uint64_t) {
+}
+
+inline void Metrics::SetRamNumaNodeBytes(std::uint32_t, std::uint64_t) {
+}
+
+inline void Metrics::SetDiskDeviceBytes(std::string_view, std::string_view, std::uint64_t) {
+}
+
+inline void Metrics::SetDiskDeviceQueueDepth(std::string_view, std::uint64_t) {
+}
+
+inline void Metrics::SetDiskDeviceIoBytes(std::string_view, std::string_view, std::uint64_t) {
+}
+
 inline void Metrics::RecordAllocationFailure(std::string_view) {
 }
 
 inline void Metrics::SetSpillQueueDepth(std::size_t) {
 }
+
+inline void Metrics::ObserveSpillQueueWaitMs(std::string_view, double) {
+}
+
+inline void Metrics::RecordSpillTask(std::string_view, std::string_view) {
+}
 #endif
 
 } // namespace payload::observability
@@ -1,11 +1,15 @@
 #include "admin_service.hpp"
 
 #include <chrono>
+#include <map>
+#include <string>
+#include <utility>
 
 #include "internal/core/payload_manager.hpp"
 #include "internal/db/api/repository.hpp"
 #include "internal/observability/logging.hpp"
 #include "internal/observability/spans.hpp"
+#include "internal/storage/disk/striped_disk_store.hpp"
 #include "payload/manager/v1.hpp"
 
 namespace payload::service {
@@ -29,7 +33,14 @@ StatsResponse AdminService::Stats(const StatsRequest&) {
     uint64_t disk_count   = 0;
     uint64_t gpu_count    = 0;
     uint64_t object_count = 0;
+    // Per (tier, content blob): payloads sharing it and the blob's stored size.
+    std::map<std::pair<int, std::string>, std::pair<uint64_t, uint64_t>> blobs;
     for (const auto& record : records) {
+      if (!record.content_hash.empty()) {
+        auto& blob = blobs[{static_cast<int>(record.tier), record.content_hash}];
+        ++blob.first;
+        blob.second = record.stored_size_bytes > 0 ? record.stored_size_bytes : record.size_bytes;
+      }
       if (record.tier == TIER_RAM) {
         ++ram_count;
       } else if (record.tier == TIER_DISK) {
@@ -56,6 +67,28 @@ StatsResponse AdminService::Stats(const StatsRequest&) {
     resp.set_bytes_gpu(get_bytes(TIER_GPU));
     resp.set_bytes_object(get_bytes(TIER_OBJECT));
 
+    uint64_t bytes_saved = 0;
+    for (const auto& [_, blob] : blobs) {
+      bytes_saved += (blob.first - 1) * blob.second;
+    }
+    const auto dedup = ctx_.manager->GetDedupCounters();
+    resp.set_dedup_lookups(dedup.lookups);
+    resp.set_dedup_hits(dedup.hits);
+    resp.set_dedup_hit_rate(dedup.lookups > 0 ? static_cast<double>(dedup.hits) / static_cast<double>(dedup.lookups) : 0.0);
+    resp.set_dedup_bytes_saved(bytes_saved);
+
+    for (const auto& usage : ctx_.manager->GetDiskDeviceUsage()) {
+      auto* device = resp.add_disk_devices();
+      device->set_name(usage.name);
+      device->set_path(usage.path);
+      device->set_capacity_bytes(usage.capacity_bytes);
+      device->set_used_bytes(usage.used_bytes);
+      device->set_free_bytes(usage.free_bytes);
+      device->set_queue_depth(usage.queue_depth);
+      device->set_read_bytes(usage.read_bytes);
+      device->set_written_bytes(usage.written_bytes);
+    }
+
     payload::observability::Metrics::Instance().RecordRequest("AdminService.Stats", true);
     payload::observability::Metrics::Instance().ObserveRequestLatencyMs(
         "AdminService.Stats", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started_at).count());
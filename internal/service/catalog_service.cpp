@@ -1,9 +1,11 @@
 #include "catalog_service.hpp"
 
 #include <chrono>
+#include <optional>
 #include <queue>
 #include <stdexcept>
 #include <unordered_set>
+#include <vector>
 
 #include "internal/core/payload_manager.hpp"
 #include "internal/db/api/repository.hpp"
@@ -47,6 +49,10 @@ void ThrowIfDbError(const payload::db::Result& result, const std::string& contex
   }
 }
 
+std::optional<uint32_t> NumaHint(const AllocatePayloadRequest& req) {
+  return req.has_numa_node() ? std::optional<uint32_t>(req.numa_node()) : std::nullopt;
+}
+
 LineageEdge ToLineageEdge(const payload::db::model::LineageRecord& record) {
   LineageEdge edge;
   edge.mutable_parent()->set_value(record.parent_id);
@@ -67,7 +73,8 @@ AllocatePayloadResponse CatalogService::Allocate(const AllocatePayloadRequest& r
       throw payload::util::InvalidState("allocate: preferred_tier must be specified");
     }
     AllocatePayloadResponse resp;
-    const auto descriptor = ctx_.manager->Allocate(req.size_bytes(), req.preferred_tier(), req.ttl_ms(), req.no_evict(), req.eviction_policy());
+    const auto descriptor = ctx_.manager->Allocate(req.size_bytes(), req.preferred_tier(), req.ttl_ms(), req.no_evict(), req.eviction_policy(),
+                                                   NumaHint(req));
     *resp.mutable_payload_descriptor() = descriptor;
     if (req.preferred_tier() == TIER_OBJECT) {
       resp.set_object_upload_path(ctx_.manager->GetObjectUploadPath(descriptor.payload_id()));
@@ -84,6 +91,74 @@ CommitPayloadResponse CatalogService::Commit(const CommitPayloadRequest& req) {
   });
 }
 
+AllocatePayloadsResponse CatalogService::AllocateBatch(const AllocatePayloadsRequest& req) {
+  return ObserveRpc("CatalogService.AllocateBatch", nullptr, [&] {
+    AllocatePayloadsResponse resp;
+    for (int i = 0; i < req.items_size(); ++i) {
+      resp.add_results();
+    }
+
+    // Items rejected here never reach the manager; `forwarded` maps each spec
+    // back to its request index.
+    std::vector<payload::core::PayloadManager::AllocateSpec> specs;
+    std::vector<int>                                         forwarded;
+    specs.reserve(req.items_size());
+    forwarded.reserve(req.items_size());
+    for (int i = 0; i < req.items_size(); ++i) {
+      const auto& item = req.items(i);
+      if (item.preferred_tier() == TIER_UNSPECIFIED) {
+        resp.mutable_results(i)->set_error_message("allocate: preferred_tier must be specified");
+        continue;
+      }
+      specs.push_back({item.size_bytes(), item.preferred_tier(), item.ttl_ms(), item.no_evict(), item.eviction_policy(), NumaHint(item)});
+      forwarded.push_back(i);
+    }
+
+    const auto outcomes = ctx_.manager->AllocateBatch(specs);
+    for (std::size_t j = 0; j < outcomes.size(); ++j) {
+      auto* result = resp.mutable_results(forwarded[j]);
+      try {
+        if (!outcomes[j].ok()) {
+          std::rethrow_exception(outcomes[j].error);
+        }
+        result->set_ok(true);
+        *result->mutable_payload_descriptor() = outcomes[j].descriptor;
+        if (outcomes[j].descriptor.tier() == TIER_OBJECT) {
+          result->set_object_upload_path(ctx_.manager->GetObjectUploadPath(outcomes[j].descriptor.payload_id()));
+        }
+      } catch (const std::exception& e) {
+        result->set_ok(false);
+        result->set_error_message(e.what());
+      }
+    }
+    return resp;
+  });
+}
+
+CommitPayloadsResponse CatalogService::CommitBatch(const CommitPayloadsRequest& req) {
+  return ObserveRpc("CatalogService.CommitBatch", nullptr, [&] {
+    const std::vector<PayloadID> ids(req.ids().begin(), req.ids().end());
+    const auto                   outcomes = ctx_.manager->CommitBatch(ids);
+
+    CommitPayloadsResponse resp;
+    for (std::size_t i = 0; i < outcomes.size(); ++i) {
+      auto* result          = resp.add_results();
+      *result->mutable_id() = ids[i];
+      try {
+        if (!outcomes[i].ok()) {
+          std::rethrow_exception(outcomes[i].error);
+        }
+        result->set_ok(true);
+        *result->mutable_payload_descriptor() = outcomes[i].descriptor;
+      } catch (const std::exception& e) {
+        result->set_ok(false);
+        result->set_error_message(e.what());
+      }
+    }
+    return resp;
+  });
+}
+
 PromoteResponse CatalogService::Promote(const PromoteRequest& req) {
   return ObserveRpc("CatalogService.Promote", &req.id(), [&] {
     if (req.target_tier() == TIER_UNSPECIFIED) {
@@ -125,6 +200,7 @@ SpillResponse CatalogService::Spill(const SpillRequest& req) {
           task.id          = id;
           task.target_tier = effective_target;
           task.fsync       = req.fsync();
+          task.priority    = spill::SpillPriority::kExplicit;
           ctx_.spill_scheduler->Enqueue(task);
           result->set_ok(true);
           // No descriptor: data movement has not completed yet.
@@ -224,6 +300,8 @@ GetLineageResponse CatalogService::GetLineage(const GetLineageRequest& req) {
 
 void CatalogService::Delete(const DeleteRequest& req) {
   ObserveRpc("CatalogService.Delete", &req.id(), [&] {
+    // Withdraw any queued spill first so no worker picks up a payload being deleted.
+    if (ctx_.spill_scheduler) ctx_.spill_scheduler->Cancel(req.id());
     // PayloadManager::Delete() handles metadata cache removal internally.
     ctx_.manager->Delete(req.id(), req.force());
   });
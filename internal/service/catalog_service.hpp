@@ -14,6 +14,10 @@ class CatalogService {
 
   payload::manager::v1::CommitPayloadResponse Commit(const payload::manager::v1::CommitPayloadRequest& req);
 
+  payload::manager::v1::AllocatePayloadsResponse AllocateBatch(const payload::manager::v1::AllocatePayloadsRequest& req);
+
+  payload::manager::v1::CommitPayloadsResponse CommitBatch(const payload::manager::v1::CommitPayloadsRequest& req);
+
   void Delete(const payload::manager::v1::DeleteRequest& req);
 
   payload::manager::v1::PromoteResponse Promote(const payload::manager::v1::PromoteRequest& req);
@@ -1,9 +1,11 @@
 #include "data_service.hpp"
 
 #include <stdexcept>
+#include <vector>
 
 #include "internal/core/payload_manager.hpp"
 #include "internal/service/observe_rpc.hpp"
+#include "internal/spill/spill_scheduler.hpp"
 #include "internal/util/errors.hpp"
 #include "internal/util/uuid.hpp"
 #include "payload/manager/v1.hpp"
@@ -19,6 +21,9 @@ ResolveSnapshotResponse DataService::ResolveSnapshot(const ResolveSnapshotReques
   return ObserveRpc("DataService.ResolveSnapshot", &req.id(), [&] {
     ResolveSnapshotResponse resp;
     *resp.mutable_payload_descriptor() = ctx_.manager->ResolveSnapshot(req.id());
+    if (req.include_checksum()) {
+      if (const auto checksum = ctx_.manager->GetChecksum(req.id())) resp.mutable_payload_descriptor()->set_checksum_crc32c(*checksum);
+    }
     return resp;
   });
 }
@@ -29,7 +34,10 @@ AcquireReadLeaseResponse DataService::AcquireReadLease(const AcquireReadLeaseReq
       throw payload::util::InvalidState("acquire lease: unsupported lease mode; use LEASE_MODE_READ");
     }
 
-    return ctx_.manager->AcquireReadLease(req.id(), req.min_tier(), req.min_lease_duration_ms(), req.promotion_policy());
+    auto resp = ctx_.manager->AcquireReadLease(req.id(), req.min_tier(), req.min_lease_duration_ms(), req.promotion_policy());
+    // Leased again, so hot: drop any eviction still queued for it.
+    if (ctx_.spill_scheduler) ctx_.spill_scheduler->CancelEviction(req.id());
+    return resp;
   });
 }
 
@@ -37,4 +45,80 @@ void DataService::ReleaseLease(const ReleaseLeaseRequest& req) {
   ObserveRpc("DataService.ReleaseLease", nullptr, [&] { ctx_.manager->ReleaseLease(req.lease_id()); });
 }
 
+ResolveSnapshotsResponse DataService::ResolveSnapshots(const ResolveSnapshotsRequest& req) {
+  return ObserveRpc("DataService.ResolveSnapshots", nullptr, [&] {
+    const std::vector<PayloadID> ids(req.ids().begin(), req.ids().end());
+    const auto                   outcomes = ctx_.manager->ResolveSnapshots(ids);
+
+    ResolveSnapshotsResponse resp;
+    for (std::size_t i = 0; i < outcomes.size(); ++i) {
+      auto* result          = resp.add_results();
+      *result->mutable_id() = ids[i];
+      try {
+        if (!outcomes[i].ok()) {
+          std::rethrow_exception(outcomes[i].error);
+        }
+        result->set_ok(true);
+        *result->mutable_payload_descriptor() = outcomes[i].descriptor;
+      } catch (const std::exception& e) {
+        result->set_ok(false);
+        result->set_error_message(e.what());
+      }
+    }
+    return resp;
+  });
+}
+
+AcquireReadLeasesResponse DataService::AcquireReadLeases(const AcquireReadLeasesRequest& req) {
+  return ObserveRpc("DataService.AcquireReadLeases", nullptr, [&] {
+    AcquireReadLeasesResponse resp;
+    for (int i = 0; i < req.items_size(); ++i) {
+      resp.add_results();
+    }
+
+    // Items rejected here never reach the manager; `forwarded` maps each spec
+    // back to its request index.
+    std::vector<payload::core::PayloadManager::LeaseSpec> specs;
+    std::vector<int>                                      forwarded;
+    specs.reserve(req.items_size());
+    forwarded.reserve(req.items_size());
+    for (int i = 0; i < req.items_size(); ++i) {
+      const auto& item = req.items(i);
+      if (item.mode() != LEASE_MODE_UNSPECIFIED && item.mode() != LEASE_MODE_READ) {
+        resp.mutable_results(i)->set_error_message("acquire lease: unsupported lease mode; use LEASE_MODE_READ");
+        continue;
+      }
+      specs.push_back({item.id(), item.min_tier(), item.min_lease_duration_ms(), item.promotion_policy()});
+      forwarded.push_back(i);
+    }
+
+    const auto             outcomes = ctx_.manager->AcquireReadLeases(specs);
+    std::vector<PayloadID> leased;
+    leased.reserve(outcomes.size());
+    for (std::size_t j = 0; j < outcomes.size(); ++j) {
+      auto* result = resp.mutable_results(forwarded[j]);
+      try {
+        if (!outcomes[j].ok()) {
+          std::rethrow_exception(outcomes[j].error);
+        }
+        result->set_ok(true);
+        *result->mutable_lease() = outcomes[j].response;
+        leased.push_back(specs[j].id);
+      } catch (const std::exception& e) {
+        result->set_ok(false);
+        result->set_error_message(e.what());
+      }
+    }
+    // Leased again, so hot: drop evictions still queued for the batch in one pass.
+    if (ctx_.spill_scheduler) ctx_.spill_scheduler->CancelEvictions(leased);
+    return resp;
+  });
+}
+
+void DataService::ReleaseLeases(const ReleaseLeasesRequest& req) {
+  ObserveRpc("DataService.ReleaseLeases", nullptr, [&] {
+    ctx_.manager->ReleaseLeases(std::vector<LeaseID>(req.lease_ids().begin(), req.lease_ids().end()));
+  });
+}
+
 } // namespace payload::service
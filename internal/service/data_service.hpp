@@ -16,6 +16,12 @@ class DataService {
 
   void ReleaseLease(const payload::manager::v1::ReleaseLeaseRequest& req);
 
+  payload::manager::v1::ResolveSnapshotsResponse ResolveSnapshots(const payload::manager::v1::ResolveSnapshotsRequest& req);
+
+  payload::manager::v1::AcquireReadLeasesResponse AcquireReadLeases(const payload::manager::v1::AcquireReadLeasesRequest& req);
+
+  void ReleaseLeases(const payload::manager::v1::ReleaseLeasesRequest& req);
+
  private:
   ServiceContext ctx_;
 };
@@ -1,31 +1,220 @@
 #include "spill_scheduler.hpp"
 
+#include <algorithm>
+#include <utility>
+
+#include "internal/observability/spans.hpp"
+
 namespace payload::spill {
 
-void SpillScheduler::Enqueue(const SpillTask& task) {
+namespace {
+
+// Tasks CancelEviction() may withdraw.
+bool Evictable(SpillPriority priority) {
+  return priority != SpillPriority::kExplicit;
+}
+
+} // namespace
+
+bool SpillScheduler::Enqueue(const SpillTask& task) {
+  const std::string& key = task.id.value();
+  bool               added;
+  bool               notify = false;
   {
     std::lock_guard lock(mutex_);
-    queue_.push(task);
+    auto&           slot = slots_[key];
+    if (slot.queued) {
+      slot.task.target_tier     = task.target_tier;
+      slot.task.fsync           = slot.task.fsync || task.fsync;
+      slot.task.wait_for_leases = slot.task.wait_for_leases || task.wait_for_leases;
+      if (task.priority < slot.task.priority) {
+        if (Evictable(task.priority) && !Evictable(slot.task.priority)) {
+          evictable_.fetch_add(1);
+        } else if (!Evictable(task.priority) && Evictable(slot.task.priority)) {
+          evictable_.fetch_sub(1);
+        }
+        slot.task.priority = task.priority;
+        if (!slot.deferred) {
+          Push(key, slot);
+          notify = true;
+        }
+      }
+      added = false;
+    } else if (slot.running && slot.running_target == task.target_tier && (slot.running_fsync || !task.fsync)) {
+      if (!slot.covered) {
+        slot.covered              = task;
+        slot.covered->enqueued_at = std::chrono::steady_clock::now();
+      } else {
+        slot.covered->priority        = std::min(slot.covered->priority, task.priority);
+        slot.covered->wait_for_leases = slot.covered->wait_for_leases || task.wait_for_leases;
+      }
+      added = false;
+    } else {
+      slot.task             = task;
+      slot.task.enqueued_at = std::chrono::steady_clock::now();
+      slot.queued           = true;
+      slot.deferred         = slot.running;
+      if (!slot.deferred) {
+        Push(key, slot);
+        ++ready_;
+        notify = true;
+      }
+      depth_.fetch_add(1);
+      if (Evictable(task.priority)) evictable_.fetch_add(1);
+      added = true;
+    }
   }
-  cv_.notify_one();
+  if (notify) cv_.notify_one();
+
+  (added ? queued_ : coalesced_).fetch_add(1, std::memory_order_relaxed);
+  payload::observability::Metrics::Instance().RecordSpillTask(SpillPriorityName(task.priority), added ? "queued" : "coalesced");
+  return added;
 }
 
 std::optional<SpillTask> SpillScheduler::Dequeue(const std::atomic<bool>& running) {
   std::unique_lock lock(mutex_);
 
-  cv_.wait(lock, [&] { return shutdown_ || !running.load() || !queue_.empty(); });
+  cv_.wait(lock, [&] { return shutdown_ || !running.load() || ready_ > 0; });
+
+  // Stopping or shutting down: drain what is ready, then stop.
+  if (ready_ == 0) return std::nullopt;
 
-  if (!running.load() && queue_.empty()) return std::nullopt;
-  if (shutdown_ && queue_.empty()) return std::nullopt;
+  for (auto& queue : queues_) {
+    while (!queue.empty()) {
+      const Entry entry = std::move(queue.front());
+      queue.pop_front();
 
-  SpillTask task = queue_.front();
-  queue_.pop();
-  return task;
+      const auto it = slots_.find(entry.key);
+      if (it == slots_.end() || !it->second.queued || it->second.generation != entry.generation) {
+        continue; // superseded or cancelled
+      }
+
+      auto& slot          = it->second;
+      slot.queued         = false;
+      slot.running        = true;
+      slot.running_target = slot.task.target_tier;
+      slot.running_fsync  = slot.task.fsync;
+      --ready_;
+      depth_.fetch_sub(1);
+      if (Evictable(slot.task.priority)) evictable_.fetch_sub(1);
+      return slot.task;
+    }
+  }
+  return std::nullopt; // unreachable while ready_ counts live entries
+}
+
+void SpillScheduler::Complete(const SpillTask& task, bool succeeded) {
+  {
+    std::lock_guard lock(mutex_);
+    const auto      it = slots_.find(task.id.value());
+    if (it == slots_.end()) return;
+
+    auto& slot    = it->second;
+    auto  covered = std::exchange(slot.covered, std::nullopt);
+    slot.running  = false;
+    if (!slot.queued) {
+      if (succeeded || !covered) {
+        slots_.erase(it);
+        return;
+      }
+      // Dropped as covered by this move, which failed: it runs after all.
+      slot.task   = std::move(*covered);
+      slot.queued = true;
+      depth_.fetch_add(1);
+      if (Evictable(slot.task.priority)) evictable_.fetch_add(1);
+    }
+    // Queued while it ran; it has waited since then, so it goes first in its class.
+    slot.deferred = false;
+    Push(it->first, slot, /*front=*/true);
+    ++ready_;
+  }
+  cv_.notify_one();
+}
+
+bool SpillScheduler::Cancel(const payload::manager::v1::PayloadID& id) {
+  std::optional<SpillPriority> cancelled;
+  {
+    std::lock_guard lock(mutex_);
+    cancelled = CancelLocked(id.value(), /*keep_explicit=*/false);
+  }
+  if (cancelled) RecordCancelled(*cancelled);
+  return cancelled.has_value();
+}
+
+bool SpillScheduler::CancelEviction(const payload::manager::v1::PayloadID& id) {
+  // Leases arrive far more often than evictions are queued; skip the mutex while there is nothing to withdraw.
+  if (evictable_.load() == 0) return false;
+  std::optional<SpillPriority> cancelled;
+  {
+    std::lock_guard lock(mutex_);
+    cancelled = CancelLocked(id.value(), /*keep_explicit=*/true);
+  }
+  if (cancelled) RecordCancelled(*cancelled);
+  return cancelled.has_value();
+}
+
+std::size_t SpillScheduler::CancelEvictions(const std::vector<payload::manager::v1::PayloadID>& ids) {
+  if (ids.empty() || evictable_.load() == 0) return 0;
+  std::vector<SpillPriority> cancelled;
+  {
+    std::lock_guard lock(mutex_);
+    for (const auto& id : ids) {
+      if (evictable_.load() == 0) break;
+      if (const auto priority = CancelLocked(id.value(), /*keep_explicit=*/true)) cancelled.push_back(*priority);
+    }
+  }
+  for (const auto priority : cancelled) RecordCancelled(priority);
+  return cancelled.size();
+}
+
+std::optional<SpillPriority> SpillScheduler::CancelLocked(const std::string& key, bool keep_explicit) {
+  const auto it = slots_.find(key);
+  if (it == slots_.end()) return std::nullopt;
+
+  auto& slot = it->second;
+  if (slot.covered && (!keep_explicit || Evictable(slot.covered->priority))) slot.covered.reset();
+  if (!slot.queued) return std::nullopt;
+  if (keep_explicit && slot.task.priority == SpillPriority::kExplicit) return std::nullopt;
+
+  const auto priority = slot.task.priority;
+  if (!slot.deferred) --ready_;
+  depth_.fetch_sub(1);
+  if (Evictable(priority)) evictable_.fetch_sub(1);
+  if (slot.running) {
+    slot.queued   = false;
+    slot.deferred = false;
+  } else {
+    slots_.erase(it);
+  }
+  return priority;
+}
+
+void SpillScheduler::RecordCancelled(SpillPriority priority) {
+  cancelled_.fetch_add(1, std::memory_order_relaxed);
+  payload::observability::Metrics::Instance().RecordSpillTask(SpillPriorityName(priority), "cancelled");
+}
+
+void SpillScheduler::Push(const std::string& key, Slot& slot, bool front) {
+  auto& queue = queues_[static_cast<std::size_t>(slot.task.priority)];
+  slot.generation = ++next_generation_;
+  Entry entry{key, slot.generation};
+  if (front) {
+    queue.push_front(std::move(entry));
+  } else {
+    queue.push_back(std::move(entry));
+  }
 }
 
 std::size_t SpillScheduler::QueueDepth() const {
-  std::lock_guard lock(mutex_);
-  return queue_.size();
+  return depth_.load();
+}
+
+SpillScheduler::Stats SpillScheduler::GetStats() const {
+  Stats stats;
+  stats.queued    = queued_.load(std::memory_order_relaxed);
+  stats.coalesced = coalesced_.load(std::memory_order_relaxed);
+  stats.cancelled = cancelled_.load(std::memory_order_relaxed);
+  return stats;
 }
 
 void SpillScheduler::Wakeup() {
@@ -1,37 +1,131 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <mutex>
 #include <optional>
-#include <queue>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "spill_task.hpp"
 
 namespace payload::spill {
 
 /*
-  Thread-safe blocking queue for spill workers.
+  Blocking spill queue shared by the spill workers.
+
+  Tasks are queued per SpillPriority class; Dequeue hands out the oldest
+  task of the most urgent class with work.
+
+  A payload has at most one queued task. Enqueueing it again merges into
+  that task instead: the latest target tier wins, fsync and
+  wait_for_leases are OR-ed, the more urgent priority is kept (moving the
+  task into that class) and it keeps its original enqueue time. A payload
+  a worker is already moving is not handed out again until Complete():
+  a task for the same target (without a stronger fsync) is held as covered
+  by the running one, dropped if that move succeeds and queued in its own
+  right if it fails; any other waits for it to finish.
+
+  Cancel() withdraws a queued task (the payload was deleted);
+  CancelEviction() only withdraws tasks nobody asked for (the payload was
+  leased again, so it is hot). Tasks already handed out run to the end.
+
+  All operations are O(1) under one short-held mutex: superseded and
+  cancelled tasks are left in their class queue and skipped by Dequeue,
+  and QueueDepth() reads an atomic, so producers and many workers only
+  contend for the few instructions that touch the queues. CancelEviction()
+  runs on every lease, so it first checks an atomic count of queued
+  withdrawable tasks and returns without the mutex while it is zero (no
+  memory pressure); a batch of leases cancels under one acquisition with
+  CancelEvictions(). A task queued while the count is being read is not
+  withdrawn, as if it had been queued just after the lease.
 */
 class SpillScheduler {
  public:
-  void Enqueue(const SpillTask& task);
+  struct Stats {
+    uint64_t queued    = 0; // tasks accepted as new
+    uint64_t coalesced = 0; // merged into a queued task or covered by a running one
+    uint64_t cancelled = 0;
+  };
+
+  // Returns true when task was queued as new, false when it was merged or dropped.
+  bool Enqueue(const SpillTask& task);
 
   // Blocks until a task is available, shutdown is requested, or the running
   // flag goes false.  Returns nullopt when the caller should stop.
+  // Every task returned must be passed to Complete() once executed.
   std::optional<SpillTask> Dequeue(const std::atomic<bool>& running);
 
+  // Marks a dequeued task finished, releasing any task queued behind it.
+  // When it failed, a task that was dropped as covered by it is queued.
+  void Complete(const SpillTask& task, bool succeeded = true);
+
+  // Drops id's queued task; false when none was queued.
+  bool Cancel(const payload::manager::v1::PayloadID& id);
+
+  // Drops id's queued task unless its priority is kExplicit.
+  bool CancelEviction(const payload::manager::v1::PayloadID& id);
+
+  // CancelEviction() for each of ids under one lock; returns how many were dropped.
+  std::size_t CancelEvictions(const std::vector<payload::manager::v1::PayloadID>& ids);
+
+  // Tasks queued and not yet handed out.
   std::size_t QueueDepth() const;
 
+  Stats GetStats() const;
+
   // Wake all blocked Dequeue callers without triggering shutdown.
   void Wakeup();
 
   void Shutdown();
 
  private:
-  mutable std::mutex      mutex_;
-  std::condition_variable cv_;
-  std::queue<SpillTask>   queue_;
-  bool                    shutdown_ = false;
+  // Per-payload state; exists while a task is queued or running.
+  struct Slot {
+    SpillTask task; // the queued task, when queued
+    bool      queued  = false;
+    bool      running = false;
+    // Queued behind its own running task rather than in a class queue.
+    bool                       deferred = false;
+    payload::manager::v1::Tier running_target{};
+    bool                       running_fsync = false;
+    // Enqueued while running and covered by it; queued only if the run fails.
+    std::optional<SpillTask> covered;
+    // Matches the slot's live class-queue entry; older entries are skipped.
+    uint64_t generation = 0;
+  };
+
+  struct Entry {
+    std::string key;
+    uint64_t    generation = 0;
+  };
+
+  // Caller holds mutex_. Queues slot in its task's class (at the front when resumed).
+  void Push(const std::string& key, Slot& slot, bool front = false);
+  // Caller holds mutex_. Withdraws key's queued task, returning its priority.
+  std::optional<SpillPriority> CancelLocked(const std::string& key, bool keep_explicit);
+  void                         RecordCancelled(SpillPriority priority);
+
+  mutable std::mutex                                 mutex_;
+  std::condition_variable                            cv_;
+  std::array<std::deque<Entry>, kSpillPriorityCount> queues_;
+  std::unordered_map<std::string, Slot>              slots_;
+  // Queued slots, and those of them in a class queue (not deferred).
+  std::atomic<std::size_t> depth_{0};
+  std::size_t              ready_ = 0;
+  // Queued slots CancelEviction() may withdraw (not kExplicit).
+  std::atomic<std::size_t> evictable_{0};
+  // Unique per class-queue entry, so a cancelled payload queued again never matches its old entry.
+  uint64_t next_generation_ = 0;
+  bool     shutdown_        = false;
+
+  std::atomic<uint64_t> queued_{0};
+  std::atomic<uint64_t> coalesced_{0};
+  std::atomic<uint64_t> cancelled_{0};
 };
 
 } // namespace payload::spill
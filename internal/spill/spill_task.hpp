@@ -1,11 +1,38 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+
 #include "payload/manager/core/v1/id.pb.h"
 #include "payload/manager/core/v1/types.pb.h"
 #include "payload/manager/v1.hpp"
 
 namespace payload::spill {
 
+/*
+  Urgency class of a spill, most urgent first. Workers always take the
+  most urgent class with work queued; within a class, oldest first.
+*/
+enum class SpillPriority : std::uint8_t {
+  // Tier pressure: the tiering loop freeing space.
+  kEviction = 0,
+  // A client asked for it (Spill RPC with SPILL_POLICY_BEST_EFFORT).
+  kExplicit = 1,
+};
+
+inline constexpr std::size_t kSpillPriorityCount = 2;
+
+inline std::string_view SpillPriorityName(SpillPriority priority) {
+  switch (priority) {
+    case SpillPriority::kEviction:
+      return "eviction";
+    case SpillPriority::kExplicit:
+      return "explicit";
+  }
+  return "unknown";
+}
+
 /*
   A scheduled durability request.
 
@@ -18,6 +45,11 @@ struct SpillTask {
 
   bool fsync           = false;
   bool wait_for_leases = false;
+
+  SpillPriority priority = SpillPriority::kExplicit;
+
+  // Set by SpillScheduler when the payload is first queued.
+  std::chrono::steady_clock::time_point enqueued_at{};
 };
 
 } // namespace payload::spill
@@ -5,6 +5,7 @@
 #include "internal/core/payload_manager.hpp"
 #include "internal/observability/logging.hpp"
 #include "internal/observability/spans.hpp"
+#include "internal/util/errors.hpp"
 
 namespace payload::spill {
 
@@ -40,17 +41,26 @@ void SpillWorker::Run() {
     auto task = scheduler_->Dequeue(running_);
     if (!task) break;
 
-    payload::observability::Metrics::Instance().SetSpillQueueDepth(scheduler_->QueueDepth());
+    auto&      metrics = payload::observability::Metrics::Instance();
+    const auto start   = std::chrono::steady_clock::now();
+    metrics.SetSpillQueueDepth(scheduler_->QueueDepth());
+    metrics.ObserveSpillQueueWaitMs(SpillPriorityName(task->priority),
+                                    std::chrono::duration<double, std::milli>(start - task->enqueued_at).count());
 
+    bool succeeded = true;
     try {
-      const auto spill_start = std::chrono::steady_clock::now();
       manager_->ExecuteSpill(task->id, task->target_tier, task->fsync);
-      const auto spill_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - spill_start).count();
-      payload::observability::Metrics::Instance().ObserveSpillDurationMs("background", spill_ms);
+      const auto spill_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+      metrics.ObserveSpillDurationMs("background", spill_ms);
+    } catch (const payload::util::NotFound&) {
+      // Deleted after it was handed out; nothing left to move (or retry).
+      PAYLOAD_LOG_INFO("spill skipped: payload no longer exists", {payload::observability::StringField("payload_id", task->id.value())});
     } catch (const std::exception& e) {
+      succeeded = false;
       PAYLOAD_LOG_ERROR("spill failed", {payload::observability::StringField("payload_id", task->id.value()),
                                          payload::observability::StringField("error", e.what())});
     }
+    scheduler_->Complete(*task, succeeded);
   }
 }
 
@@ -0,0 +1,250 @@
+#include "checksum.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace payload::storage {
+
+namespace {
+
+constexpr uint32_t kPolynomial = 0x82F63B78; // reflected Castagnoli
+
+// Bytes per stream in the three-way interleaved loop; StreamZeros()
+// advances a CRC past this many zero bytes so the streams can be combined.
+constexpr uint64_t kStreamBytes = 8192;
+
+// Copies at least this large use non-temporal stores: the destination is a
+// payload that is not about to be read, so it should not evict the cache.
+constexpr uint64_t kNonTemporalBytes = uint64_t{1} << 20;
+
+// Software CRC over data processed alongside a memcpy, kept small enough
+// that the copied block is still in cache when it is hashed.
+constexpr uint64_t kPortableBlockBytes = 64 * 1024;
+
+using ShiftTable = std::array<std::array<uint32_t, 256>, 4>;
+
+/*
+  Zero-extension operator (Mark Adler's crc32c.c): a 32x32 GF(2) matrix
+  that maps a CRC to the CRC of the same data followed by length zero
+  bytes, folded into byte-indexed tables. length must be a power of two.
+*/
+uint32_t MatrixTimes(const uint32_t* matrix, uint32_t vector) {
+  uint32_t sum = 0;
+  for (; vector != 0; vector >>= 1, ++matrix) {
+    if (vector & 1) sum ^= *matrix;
+  }
+  return sum;
+}
+
+void MatrixSquare(uint32_t* square, const uint32_t* matrix) {
+  for (int n = 0; n < 32; ++n) square[n] = MatrixTimes(matrix, matrix[n]);
+}
+
+ShiftTable ZerosTable(uint64_t length) {
+  uint32_t even[32];
+  uint32_t odd[32];
+  odd[0] = kPolynomial; // operator for one zero bit
+  for (int n = 1; n < 32; ++n) odd[n] = uint32_t{1} << (n - 1);
+  MatrixSquare(even, odd); // two zero bits
+  MatrixSquare(odd, even); // four zero bits
+
+  // Keep squaring: one zero byte, two, four, ... until length is reached.
+  const uint32_t* op = odd;
+  do {
+    MatrixSquare(even, odd);
+    length >>= 1;
+    op = even;
+    if (length == 0) break;
+    MatrixSquare(odd, even);
+    length >>= 1;
+    op = odd;
+  } while (length != 0);
+
+  ShiftTable table{};
+  for (uint32_t n = 0; n < 256; ++n) {
+    table[0][n] = MatrixTimes(op, n);
+    table[1][n] = MatrixTimes(op, n << 8);
+    table[2][n] = MatrixTimes(op, n << 16);
+    table[3][n] = MatrixTimes(op, n << 24);
+  }
+  return table;
+}
+
+uint32_t Shift(const ShiftTable& table, uint32_t crc) {
+  return table[0][crc & 0xFF] ^ table[1][(crc >> 8) & 0xFF] ^ table[2][(crc >> 16) & 0xFF] ^ table[3][crc >> 24];
+}
+
+const ShiftTable& StreamZeros() {
+  static const ShiftTable table = ZerosTable(kStreamBytes);
+  return table;
+}
+
+const std::array<std::array<uint32_t, 256>, 8>& SliceTables() {
+  static const auto tables = [] {
+    std::array<std::array<uint32_t, 256>, 8> t{};
+    for (uint32_t n = 0; n < 256; ++n) {
+      uint32_t crc = n;
+      for (int k = 0; k < 8; ++k) crc = (crc & 1) ? (crc >> 1) ^ kPolynomial : crc >> 1;
+      t[0][n] = crc;
+    }
+    for (uint32_t n = 0; n < 256; ++n) {
+      for (int k = 1; k < 8; ++k) t[k][n] = (t[k - 1][n] >> 8) ^ t[0][t[k - 1][n] & 0xFF];
+    }
+    return t;
+  }();
+  return tables;
+}
+
+// Slice-by-8 over the raw (pre-inverted) register.
+uint32_t PortableRaw(uint32_t crc, const uint8_t* data, uint64_t length) {
+  const auto& t = SliceTables();
+  for (; length >= 8; data += 8, length -= 8) {
+    uint64_t word = 0;
+    std::memcpy(&word, data, 8); // little-endian
+    word ^= crc;
+    crc = t[7][word & 0xFF] ^ t[6][(word >> 8) & 0xFF] ^ t[5][(word >> 16) & 0xFF] ^ t[4][(word >> 24) & 0xFF] ^ t[3][(word >> 32) & 0xFF] ^
+          t[2][(word >> 40) & 0xFF] ^ t[1][(word >> 48) & 0xFF] ^ t[0][word >> 56];
+  }
+  for (; length > 0; ++data, --length) crc = (crc >> 8) ^ t[0][(crc ^ *data) & 0xFF];
+  return crc;
+}
+
+#if defined(__x86_64__)
+
+bool HasSse42() {
+  static const bool supported = __builtin_cpu_supports("sse4.2");
+  return supported;
+}
+
+// One 64-byte line: four 16-byte loads, optionally stored to dst, then
+// eight crc32 steps on the registers already loaded.
+template <bool kCopy, bool kStream>
+__attribute__((target("sse4.2"))) inline uint64_t Line(uint64_t crc, uint8_t* dst, const uint8_t* src) {
+  const __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+  const __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 16));
+  const __m128i v2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 32));
+  const __m128i v3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 48));
+  if constexpr (kCopy && kStream) {
+    _mm_stream_si128(reinterpret_cast<__m128i*>(dst), v0);
+    _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 16), v1);
+    _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 32), v2);
+    _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 48), v3);
+  } else if constexpr (kCopy) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), v0);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 16), v1);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 32), v2);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 48), v3);
+  }
+  crc = _mm_crc32_u64(crc, static_cast<uint64_t>(_mm_cvtsi128_si64(v0)));
+  crc = _mm_crc32_u64(crc, static_cast<uint64_t>(_mm_extract_epi64(v0, 1)));
+  crc = _mm_crc32_u64(crc, static_cast<uint64_t>(_mm_cvtsi128_si64(v1)));
+  crc = _mm_crc32_u64(crc, static_cast<uint64_t>(_mm_extract_epi64(v1, 1)));
+  crc = _mm_crc32_u64(crc, static_cast<uint64_t>(_mm_cvtsi128_si64(v2)));
+  crc = _mm_crc32_u64(crc, static_cast<uint64_t>(_mm_extract_epi64(v2, 1)));
+  crc = _mm_crc32_u64(crc, static_cast<uint64_t>(_mm_cvtsi128_si64(v3)));
+  crc = _mm_crc32_u64(crc, static_cast<uint64_t>(_mm_extract_epi64(v3, 1)));
+  return crc;
+}
+
+// Word-at-a-time tail (and head, before dst is aligned for streaming).
+template <bool kCopy>
+__attribute__((target("sse4.2"))) uint64_t Words(uint64_t crc, uint8_t*& dst, const uint8_t*& src, uint64_t length) {
+  for (; length >= 8; src += 8, length -= 8) {
+    uint64_t word = 0;
+    std::memcpy(&word, src, 8);
+    if constexpr (kCopy) {
+      std::memcpy(dst, &word, 8);
+      dst += 8;
+    }
+    crc = _mm_crc32_u64(crc, word);
+  }
+  for (; length > 0; ++src, --length) {
+    if constexpr (kCopy) *dst++ = *src;
+    crc = _mm_crc32_u8(static_cast<uint32_t>(crc), *src);
+  }
+  return crc;
+}
+
+/*
+  crc32 has a latency of three cycles but issues every cycle, so a single
+  dependency chain runs at a third of its throughput. Three streams
+  kStreamBytes apart are hashed side by side and combined by shifting
+  each partial CRC past the following stream's bytes.
+*/
+template <bool kCopy, bool kStream>
+__attribute__((target("sse4.2"))) uint32_t Hardware(uint32_t crc, uint8_t* dst, const uint8_t* src, uint64_t length) {
+  uint64_t c0 = ~crc;
+  if constexpr (kStream) {
+    const uint64_t head = std::min<uint64_t>(length, (64 - reinterpret_cast<uintptr_t>(dst) % 64) % 64);
+    c0 = Words<kCopy>(c0, dst, src, head);
+    length -= head;
+  }
+
+  const auto& zeros = StreamZeros();
+  for (; length >= 3 * kStreamBytes; length -= 3 * kStreamBytes) {
+    uint64_t       c1  = 0;
+    uint64_t       c2  = 0;
+    const uint8_t* end = src + kStreamBytes;
+    do {
+      c0 = Line<kCopy, kStream>(c0, dst, src);
+      c1 = Line<kCopy, kStream>(c1, kCopy ? dst + kStreamBytes : nullptr, src + kStreamBytes);
+      c2 = Line<kCopy, kStream>(c2, kCopy ? dst + 2 * kStreamBytes : nullptr, src + 2 * kStreamBytes);
+      src += 64;
+      if constexpr (kCopy) dst += 64;
+    } while (src < end);
+    c0 = Shift(zeros, static_cast<uint32_t>(c0)) ^ c1;
+    c0 = Shift(zeros, static_cast<uint32_t>(c0)) ^ c2;
+    src += 2 * kStreamBytes;
+    if constexpr (kCopy) dst += 2 * kStreamBytes;
+  }
+  if constexpr (kStream) _mm_sfence();
+
+  c0 = Words<kCopy>(c0, dst, src, length);
+  return ~static_cast<uint32_t>(c0);
+}
+
+#endif
+
+} // namespace
+
+uint32_t Crc32cPortable(uint32_t crc, const uint8_t* data, uint64_t length) {
+  return ~PortableRaw(~crc, data, length);
+}
+
+void Crc32c::Update(const uint8_t* data, uint64_t length) {
+#if defined(__x86_64__)
+  if (HasSse42()) {
+    crc_ = Hardware</*kCopy=*/false, /*kStream=*/false>(crc_, nullptr, data, length);
+    return;
+  }
+#endif
+  crc_ = Crc32cPortable(crc_, data, length);
+}
+
+void Crc32c::CopyAndUpdate(uint8_t* dst, const uint8_t* src, uint64_t length) {
+#if defined(__x86_64__)
+  if (HasSse42()) {
+    crc_ = length >= kNonTemporalBytes ? Hardware</*kCopy=*/true, /*kStream=*/true>(crc_, dst, src, length)
+                                       : Hardware</*kCopy=*/true, /*kStream=*/false>(crc_, dst, src, length);
+    return;
+  }
+#endif
+  for (uint64_t offset = 0; offset < length; offset += kPortableBlockBytes) {
+    const uint64_t block = std::min(kPortableBlockBytes, length - offset);
+    std::memcpy(dst + offset, src + offset, block);
+    crc_ = Crc32cPortable(crc_, src + offset, block);
+  }
+}
+
+uint32_t Crc32cOf(const uint8_t* data, uint64_t length) {
+  Crc32c crc;
+  crc.Update(data, length);
+  return crc.Value();
+}
+
+} // namespace payload::storage
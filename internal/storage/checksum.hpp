@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+
+namespace payload::storage {
+
+/*
+  CRC32C (Castagnoli) of payload bytes, the integrity check carried from
+  spill through every later copy.
+
+  CRC32C rather than a wider hash because x86-64 computes it with one
+  instruction per 8 bytes (SSE4.2 crc32) without needing AVX2, and
+  three interleaved streams keep that instruction's pipeline full, so
+  hashing runs at memory speed. That is what makes CopyAndUpdate cost
+  about the same as the copy alone: bytes are loaded into registers once,
+  stored to the destination and folded into the checksum before the next
+  load. Without SSE4.2 a slice-by-8 table implementation is used.
+
+  Value() is the standard CRC32C ("123456789" → 0xE3069283); updating in
+  pieces gives the same value as one call over the concatenation.
+*/
+class Crc32c {
+ public:
+  void Update(const uint8_t* data, uint64_t length);
+
+  // memcpy(dst, src, length) and Update(src, length) in one pass. Large
+  // copies bypass the cache on store, so dst is not left resident.
+  void CopyAndUpdate(uint8_t* dst, const uint8_t* src, uint64_t length);
+
+  uint32_t Value() const {
+    return crc_;
+  }
+
+ private:
+  uint32_t crc_ = 0;
+};
+
+uint32_t Crc32cOf(const uint8_t* data, uint64_t length);
+
+// Table-driven CRC32C continuing from crc (a previous Value(), or 0): the
+// path taken without SSE4.2, exposed so tests can check it on any host.
+uint32_t Crc32cPortable(uint32_t crc, const uint8_t* data, uint64_t length);
+
+} // namespace payload::storage
@@ -116,6 +116,9 @@ arrow::Result<std::pair<std::shared_ptr<arrow::fs::FileSystem>, std::string>> Re
       options.tls_ca_file_path        = proto_options.tls_ca_file_path();
       options.tls_ca_dir_path         = proto_options.tls_ca_dir_path();
       options.tls_verify_certificates = proto_options.tls_verify_certificates();
+      if (proto_options.has_retry_max_attempts()) {
+        options.retry_strategy = arrow::fs::S3RetryStrategy::GetAwsStandardRetryStrategy(proto_options.retry_max_attempts());
+      }
 
       // Strip the s3:// scheme prefix to get the bucket/prefix path.
       // Avoid resolve_uri_path() for S3: that helper calls FileSystemFromUri
@@ -269,7 +272,22 @@ arrow::Result<std::pair<std::shared_ptr<arrow::fs::FileSystem>, std::string>> Re
 
 arrow::Result<std::pair<std::shared_ptr<arrow::fs::FileSystem>, std::string>> ResolveFileSystem(
     const std::string& path, const pb::arrow::storage::ObjectStorageConfig& object_storage_config) {
-  return ResolveFileSystem(path, object_storage_config.filesystem(), object_storage_config.filesystem_options());
+  // Parallel multipart uploads on S3 run as background part writes, retried
+  // per request by the SDK.
+  auto        filesystem_options = object_storage_config.filesystem_options();
+  const auto& multipart          = object_storage_config.multipart();
+  if (filesystem_options.has_s3()) {
+    auto* s3 = filesystem_options.mutable_s3();
+    if (multipart.concurrency() != 1) s3->set_background_writes(true);
+    if (multipart.has_part_retries() && !s3->has_retry_max_attempts()) s3->set_retry_max_attempts(static_cast<int32_t>(multipart.part_retries()) + 1);
+  }
+  ARROW_ASSIGN_OR_RAISE(auto resolved, ResolveFileSystem(path, object_storage_config.filesystem(), filesystem_options));
+  if (object_storage_config.read_mode() == pb::arrow::storage::READ_MODE_MMAP && resolved.first->type_name() == "local") {
+    auto options     = arrow::fs::LocalFileSystemOptions::Defaults();
+    options.use_mmap = true;
+    resolved.first   = std::make_shared<arrow::fs::LocalFileSystem>(options);
+  }
+  return resolved;
 }
 
 arrow::Result<arrow::Compression::type> ResolveCompression(const std::string& path, pb::arrow::storage::Compression compression) {
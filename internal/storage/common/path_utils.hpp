@@ -1,9 +1,13 @@
 #pragma once
 
+#include <cstdint>
+#include <cstdio>
 #include <filesystem>
 #include <stdexcept>
 #include <string>
 
+#include "internal/storage/checksum.hpp"
+
 namespace payload::storage::common {
 
 inline void ValidatePayloadId(const std::string& payload_id) {
@@ -25,6 +29,38 @@ inline std::filesystem::path PayloadPath(const std::filesystem::path& root, cons
   return root / (payload_id + ".bin");
 }
 
+/*
+  Directory fan-out: each level is one of 256 subdirectories named by a
+  byte of a hash of the payload id ("3f/a2/<uuid>.bin" at two levels), so
+  no directory grows past a few thousand entries at millions of payloads.
+  The hash (CRC32C of the id string) is part of the on-disk layout.
+*/
+inline constexpr uint32_t kMaxFanoutLevels = 2;
+
+// Index of the payload's leaf directory, in [0, 256^levels).
+inline uint32_t FanoutBucket(const std::string& payload_id, uint32_t levels) {
+  if (levels == 0) return 0;
+  const uint32_t hash = Crc32cOf(reinterpret_cast<const uint8_t*>(payload_id.data()), payload_id.size());
+  return hash & ((uint32_t{1} << (8 * levels)) - 1);
+}
+
+// Leaf directory relative to the tier root; empty for a flat layout.
+inline std::filesystem::path FanoutDir(const std::string& payload_id, uint32_t levels) {
+  const uint32_t        bucket = FanoutBucket(payload_id, levels);
+  std::filesystem::path dir;
+  for (uint32_t level = 0; level < levels; ++level) {
+    char name[3];
+    std::snprintf(name, sizeof(name), "%02x", (bucket >> (8 * level)) & 0xFF);
+    dir /= name;
+  }
+  return dir;
+}
+
+inline std::filesystem::path PayloadPath(const std::filesystem::path& root, const std::string& payload_id, uint32_t fanout_levels) {
+  ValidatePayloadId(payload_id);
+  return root / FanoutDir(payload_id, fanout_levels) / (payload_id + ".bin");
+}
+
 inline std::filesystem::path SidecarPath(const std::filesystem::path& root, const std::string& payload_id) {
   ValidatePayloadId(payload_id);
   return root / (payload_id + ".meta.json");
@@ -0,0 +1,326 @@
+#include "sidecar.hpp"
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <google/protobuf/util/json_util.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "internal/observability/logging.hpp"
+#include "internal/storage/common/arrow_utils.hpp"
+#include "internal/util/uuid.hpp"
+
+namespace payload::storage::common {
+
+using payload::manager::catalog::v1::ManifestEntry;
+using payload::manager::catalog::v1::PayloadArchiveMetadata;
+
+namespace {
+
+constexpr char kSegmentMagic[] = "PMM1";
+
+std::string EntryKey(const payload::manager::v1::PayloadID& id) {
+  return payload::util::ToString(payload::util::FromProto(id));
+}
+
+// "<sequence>-<writer>.manifest", zero-padded so names sort in sequence order.
+std::string SegmentName(uint32_t writer_id, uint64_t sequence) {
+  char name[64];
+  std::snprintf(name, sizeof(name), "%020llu-%08x%s", static_cast<unsigned long long>(sequence), writer_id, kManifestSuffix);
+  return name;
+}
+
+// Segment files under <root>/manifests, in name (sequence) order.
+std::vector<arrow::fs::FileInfo> ListSegments(arrow::fs::FileSystem& fs, const std::string& root) {
+  arrow::fs::FileSelector selector;
+  selector.base_dir        = root.empty() || root.back() == '/' ? root + kManifestDir : root + "/" + kManifestDir;
+  selector.allow_not_found = true;
+
+  std::vector<arrow::fs::FileInfo> segments;
+  for (auto& info : Unwrap(fs.GetFileInfo(selector))) {
+    const auto& name = info.base_name();
+    if (info.IsFile() && name.size() > std::char_traits<char>::length(kManifestSuffix) && name.ends_with(kManifestSuffix)) {
+      segments.push_back(std::move(info));
+    }
+  }
+  std::sort(segments.begin(), segments.end(), [](const auto& a, const auto& b) { return a.base_name() < b.base_name(); });
+  return segments;
+}
+
+ManifestCatalog ApplySegments(arrow::fs::FileSystem& fs, const std::vector<arrow::fs::FileInfo>& segments) {
+  ManifestCatalog catalog;
+  for (const auto& info : segments) {
+    const auto buffer = ReadAll(Unwrap(fs.OpenInputFile(info.path())));
+    try {
+      catalog.Apply(buffer->ToString());
+    } catch (const std::exception& e) {
+      throw std::runtime_error(std::string(e.what()) + " (" + info.path() + ")");
+    }
+  }
+  return catalog;
+}
+
+// One length-delimited ManifestEntry, as it sits in a segment.
+std::string EncodeEntry(const ManifestEntry& entry) {
+  std::string record;
+  google::protobuf::io::StringOutputStream raw(&record);
+  google::protobuf::io::CodedOutputStream  out(&raw);
+  out.WriteVarint32(static_cast<uint32_t>(entry.ByteSizeLong()));
+  entry.SerializeWithCachedSizes(&out);
+  out.Trim();
+  return record;
+}
+
+} // namespace
+
+const char* SidecarSuffix(SidecarFormat format) {
+  return format == SidecarFormat::kBinary ? ".meta.pb" : ".meta.json";
+}
+
+std::string EncodeSidecar(const PayloadArchiveMetadata& meta, SidecarFormat format) {
+  std::string bytes;
+  if (format == SidecarFormat::kBinary) {
+    if (!meta.SerializeToString(&bytes)) {
+      throw std::runtime_error("WriteSidecar: binary serialization failed");
+    }
+    return bytes;
+  }
+
+  google::protobuf::util::JsonPrintOptions opts;
+  opts.add_whitespace = true;
+  auto status         = google::protobuf::util::MessageToJsonString(meta, &bytes, opts);
+  if (!status.ok()) {
+    throw std::runtime_error("WriteSidecar: serialization failed: " + status.ToString());
+  }
+  return bytes;
+}
+
+ManifestWriter::ManifestWriter(SidecarOptions options, SegmentSink sink, uint64_t first_sequence, std::shared_ptr<arrow::fs::FileSystem> fs,
+                               std::string root)
+    : options_(options),
+      sink_(std::move(sink)),
+      writer_id_(std::random_device{}()),
+      fs_(std::move(fs)),
+      root_(std::move(root)),
+      next_segment_(first_sequence) {
+  options_.manifest_max_entries = std::max<uint32_t>(options_.manifest_max_entries, 1);
+  if (fs_) segments_ = ListSegments(*fs_, root_).size();
+  flusher_ = std::thread([this] { FlushLoop(); });
+}
+
+ManifestWriter::~ManifestWriter() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  cv_.notify_all();
+  flusher_.join();
+  try {
+    Flush();
+  } catch (const std::exception&) {
+    // Nowhere left to retry; the repository still has these payloads.
+  }
+}
+
+void ManifestWriter::Put(const PayloadArchiveMetadata& meta) {
+  ManifestEntry entry;
+  *entry.mutable_metadata() = meta;
+  Append(entry, /*removal=*/false);
+}
+
+void ManifestWriter::Remove(const payload::manager::v1::PayloadID& id) {
+  ManifestEntry entry;
+  *entry.mutable_removed() = id;
+  Append(entry, /*removal=*/true);
+}
+
+void ManifestWriter::Append(const ManifestEntry& entry, bool removal) {
+  const std::string record = EncodeEntry(entry);
+
+  bool full = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_ += record;
+    pending_removals_ += removal ? 1 : 0;
+    if (++pending_entries_ == 1) {
+      oldest_ = std::chrono::steady_clock::now();
+      cv_.notify_all();
+    }
+    full = pending_entries_ >= options_.manifest_max_entries;
+  }
+  if (full) Flush();
+}
+
+void ManifestWriter::Flush() {
+  std::lock_guard<std::mutex> flush_lock(flush_mutex_);
+
+  std::string segment;
+  uint64_t    entries  = 0;
+  uint64_t    removals = 0;
+  uint64_t    sequence;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pending_entries_ == 0) return;
+    segment = kSegmentMagic;
+    segment += pending_;
+    entries  = pending_entries_;
+    removals = pending_removals_;
+    sequence = next_segment_;
+    pending_.clear();
+    pending_entries_  = 0;
+    pending_removals_ = 0;
+  }
+
+  try {
+    WriteSegmentLocked(SegmentName(writer_id_, sequence), segment, entries, removals);
+  } catch (...) {
+    // Put the entries back ahead of anything appended meanwhile and wait
+    // out another window before the flusher retries.
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.insert(0, segment, sizeof(kSegmentMagic) - 1);
+    pending_entries_ += entries;
+    pending_removals_ += removals;
+    oldest_ = std::chrono::steady_clock::now();
+    throw;
+  }
+
+  // A removal kills itself and the entry it removes.
+  const double dead      = static_cast<double>(std::min(2 * removals_, written_));
+  const bool   too_many  = options_.manifest_compact_segments > 0 && segments_ >= options_.manifest_compact_segments;
+  const bool   too_stale = options_.manifest_compact_dead_ratio > 0 && dead >= options_.manifest_compact_dead_ratio * static_cast<double>(written_);
+  if (fs_ && segments_ > 1 && (too_many || too_stale)) {
+    try {
+      CompactLocked();
+    } catch (const std::exception& e) {
+      PAYLOAD_LOG_WARN("manifest: compaction failed", {payload::observability::StringField("root", root_),
+                                                       payload::observability::StringField("error", e.what())});
+    }
+  }
+}
+
+void ManifestWriter::WriteSegmentLocked(const std::string& name, const std::string& segment, uint64_t entries, uint64_t removals) {
+  sink_(name, segment);
+  ++segments_;
+  written_ += entries;
+  removals_ += removals;
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++next_segment_;
+}
+
+void ManifestWriter::Compact() {
+  if (!fs_) return;
+  Flush();
+  std::lock_guard<std::mutex> flush_lock(flush_mutex_);
+  CompactLocked();
+}
+
+void ManifestWriter::CompactLocked() {
+  // Only the segments replayed here are deleted; the compacted one is
+  // numbered after all of them.
+  const auto segments = ListSegments(*fs_, root_);
+  const auto catalog  = ApplySegments(*fs_, segments);
+
+  std::string compacted = kSegmentMagic;
+  for (const auto& [key, meta] : catalog.Entries()) {
+    ManifestEntry entry;
+    *entry.mutable_metadata() = meta;
+    compacted += EncodeEntry(entry);
+  }
+  uint64_t sequence;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sequence = next_segment_;
+  }
+  WriteSegmentLocked(SegmentName(writer_id_, sequence), compacted, catalog.Entries().size(), 0);
+  segments_ = 1;
+  written_  = catalog.Entries().size();
+  removals_ = 0;
+
+  for (const auto& info : segments) {
+    const auto status = fs_->DeleteFile(info.path());
+    if (!status.ok()) {
+      // Replays the same with or without it; the next compaction retries.
+      ++segments_;
+      PAYLOAD_LOG_WARN("manifest: could not delete a compacted segment", {payload::observability::StringField("path", info.path()),
+                                                                          payload::observability::StringField("error", status.ToString())});
+    }
+  }
+}
+
+uint64_t ManifestWriter::PendingEntries() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return pending_entries_;
+}
+
+void ManifestWriter::FlushLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopping_) {
+    if (pending_entries_ == 0) {
+      cv_.wait(lock);
+      continue;
+    }
+    const auto due = oldest_ + options_.manifest_window;
+    if (std::chrono::steady_clock::now() < due) {
+      cv_.wait_until(lock, due);
+      continue;
+    }
+    lock.unlock();
+    try {
+      Flush();
+    } catch (const std::exception&) {
+      // Still pending; retried once another window has passed.
+    }
+    lock.lock();
+  }
+}
+
+void ManifestCatalog::Apply(const std::string& segment) {
+  constexpr size_t kMagicBytes = sizeof(kSegmentMagic) - 1;
+  if (segment.compare(0, kMagicBytes, kSegmentMagic) != 0) {
+    throw std::runtime_error("manifest segment: bad magic");
+  }
+
+  google::protobuf::io::CodedInputStream in(reinterpret_cast<const uint8_t*>(segment.data()) + kMagicBytes,
+                                            static_cast<int>(segment.size() - kMagicBytes));
+  while (!in.ExpectAtEnd()) {
+    uint32_t size = 0;
+    if (!in.ReadVarint32(&size)) {
+      throw std::runtime_error("manifest segment: truncated entry length");
+    }
+    const auto    limit = in.PushLimit(static_cast<int>(size));
+    ManifestEntry entry;
+    if (!entry.ParseFromCodedStream(&in) || !in.ConsumedEntireMessage() || in.BytesUntilLimit() != 0) {
+      throw std::runtime_error("manifest segment: malformed entry");
+    }
+    in.PopLimit(limit);
+
+    if (entry.has_metadata()) {
+      entries_[EntryKey(entry.metadata().uuid())] = std::move(*entry.mutable_metadata());
+    } else if (entry.has_removed()) {
+      entries_.erase(EntryKey(entry.removed()));
+    }
+  }
+}
+
+ManifestCatalog ReadManifestCatalog(arrow::fs::FileSystem& fs, const std::string& root) {
+  return ApplySegments(fs, ListSegments(fs, root));
+}
+
+uint64_t NextManifestSequence(arrow::fs::FileSystem& fs, const std::string& root) {
+  uint64_t next = 0;
+  for (const auto& info : ListSegments(fs, root)) {
+    const auto& name    = info.base_name();
+    uint64_t    leading = 0;
+    const auto  parsed  = std::from_chars(name.data(), name.data() + name.size(), leading);
+    if (parsed.ec == std::errc() && parsed.ptr != name.data()) next = std::max(next, leading + 1);
+  }
+  return next;
+}
+
+} // namespace payload::storage::common
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <arrow/filesystem/filesystem.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "internal/storage/common/path_utils.hpp"
+#include "payload/manager/catalog/v1/archive_metadata.pb.h"
+#include "payload/manager/v1.hpp"
+
+namespace payload::storage::common {
+
+enum class SidecarFormat {
+  kJson,     // <uuid>.meta.json, pretty-printed proto JSON
+  kBinary,   // <uuid>.meta.pb, serialized PayloadArchiveMetadata
+  kManifest, // batched into <root>/manifests/<segment>.manifest
+};
+
+struct SidecarOptions {
+  SidecarFormat format = SidecarFormat::kJson;
+  // A manifest segment is written once this many entries are pending...
+  uint32_t manifest_max_entries = 256;
+  // ...or the oldest pending entry has waited this long.
+  std::chrono::milliseconds manifest_window{1000};
+  // Segments are compacted into one once this many are on the tier...
+  uint32_t manifest_compact_segments = 64;
+  // ...or this fraction of the entries written since the last compaction
+  // is dead: removals and the entries they remove.
+  double manifest_compact_dead_ratio = 0.5;
+};
+
+inline constexpr const char* kManifestDir    = "manifests";
+inline constexpr const char* kManifestSuffix = ".manifest";
+
+// ".meta.json" or ".meta.pb"; per-payload formats only.
+const char* SidecarSuffix(SidecarFormat format);
+
+inline std::filesystem::path SidecarPath(const std::filesystem::path& root, const std::string& payload_id, SidecarFormat format,
+                                         uint32_t fanout_levels = 0) {
+  ValidatePayloadId(payload_id);
+  return root / FanoutDir(payload_id, fanout_levels) / (payload_id + SidecarSuffix(format));
+}
+
+// Bytes of a per-payload sidecar in format (kJson or kBinary).
+std::string EncodeSidecar(const payload::manager::catalog::v1::PayloadArchiveMetadata& meta, SidecarFormat format);
+
+/*
+  Batches sidecar metadata into append-only manifest segments.
+
+  Put() and Remove() append a ManifestEntry to an in-memory segment; the
+  segment is handed to the sink once manifest_max_entries entries are
+  pending (on the calling thread) or the oldest has waited manifest_window
+  (on the writer's flusher thread). A tier then does one write — one PUT
+  on object storage — per segment instead of one per payload.
+
+  Segments are written one at a time, in order, and never rewritten. Each
+  is named "<sequence>-<writer>.manifest" with a zero-padded sequence that
+  continues from the highest segment already on the tier
+  (NextManifestSequence), so names sort in write order across restarts
+  whatever the wall clock does. One writer owns a root; the writer id
+  only breaks ties. A segment the sink fails to write stays pending and
+  is retried with the next one under the same sequence. Entries still pending when the
+  process dies are lost: the repository remains the authoritative catalog,
+  manifests are what rebuilds it when the repository is gone.
+
+  Given the tier's filesystem and root, the writer also compacts: after a
+  segment is written and manifest_compact_segments are on the tier, or the
+  dead fraction reaches manifest_compact_dead_ratio, it replays the
+  segments there, writes the live catalog as one new segment through the
+  sink and deletes the segments it replayed. The new segment sorts after
+  them, so a crash before the deletes leaves a catalog that replays the
+  same. A failed compaction is logged and tried again after the next
+  segment.
+
+  Segment layout: "PMM1", then length-delimited ManifestEntry messages.
+*/
+class ManifestWriter {
+ public:
+  // Stores one finished segment under name; throws on failure.
+  using SegmentSink = std::function<void(const std::string& name, const std::string& bytes)>;
+
+  // first_sequence numbers the first segment; see NextManifestSequence.
+  // Segments are compacted only when fs is set; they live under
+  // <root>/manifests on it, where the sink writes them.
+  ManifestWriter(SidecarOptions options, SegmentSink sink, uint64_t first_sequence = 0, std::shared_ptr<arrow::fs::FileSystem> fs = nullptr,
+                 std::string root = {});
+  // Stops the flusher and writes what is pending, best-effort.
+  ~ManifestWriter();
+
+  ManifestWriter(const ManifestWriter&)            = delete;
+  ManifestWriter& operator=(const ManifestWriter&) = delete;
+
+  void Put(const payload::manager::catalog::v1::PayloadArchiveMetadata& meta);
+  void Remove(const payload::manager::v1::PayloadID& id);
+
+  // Writes pending entries as one segment now. Throws if the sink does.
+  void Flush();
+
+  // Flushes, then rewrites the tier's segments as one. Throws if reading,
+  // writing or deleting a segment fails. No-op without a filesystem.
+  void Compact();
+
+  uint64_t PendingEntries() const;
+
+ private:
+  void Append(const payload::manager::catalog::v1::ManifestEntry& entry, bool removal);
+  // Both with flush_mutex_ held.
+  void WriteSegmentLocked(const std::string& name, const std::string& segment, uint64_t entries, uint64_t removals);
+  void CompactLocked();
+  void FlushLoop();
+
+  SidecarOptions                         options_;
+  SegmentSink                            sink_;
+  uint32_t                               writer_id_;
+  std::shared_ptr<arrow::fs::FileSystem> fs_;
+  std::string                            root_;
+
+  // Segments on the tier, and entries and removals written to them since
+  // the last compaction; guarded by flush_mutex_.
+  uint64_t segments_ = 0;
+  uint64_t written_  = 0;
+  uint64_t removals_ = 0;
+
+  // Held across a whole Flush so segments reach the sink in entry order.
+  std::mutex flush_mutex_;
+
+  mutable std::mutex                    mutex_;
+  std::condition_variable               cv_;
+  std::string                           pending_;
+  uint64_t                              pending_entries_  = 0;
+  uint64_t                              pending_removals_ = 0;
+  std::chrono::steady_clock::time_point oldest_;
+  uint64_t                              next_segment_ = 0;
+  bool                                  stopping_     = false;
+  std::thread                           flusher_;
+};
+
+/*
+  Catalog rebuilt from manifest segments: the latest metadata of every
+  payload still present, keyed by payload id (UUID string).
+*/
+class ManifestCatalog {
+ public:
+  // Applies one segment's entries in order. Throws std::runtime_error if
+  // the segment is malformed; entries before the damage stay applied.
+  void Apply(const std::string& segment);
+
+  const std::map<std::string, payload::manager::catalog::v1::PayloadArchiveMetadata>& Entries() const {
+    return entries_;
+  }
+
+ private:
+  std::map<std::string, payload::manager::catalog::v1::PayloadArchiveMetadata> entries_;
+};
+
+// Applies every segment under <root>/manifests on fs, in sequence order.
+ManifestCatalog ReadManifestCatalog(arrow::fs::FileSystem& fs, const std::string& root);
+
+// One past the highest segment sequence under <root>/manifests on fs (0
+// when there are none), for a ManifestWriter taking over the root.
+// Segments named by an older release lead with their write time in ms,
+// so new sequences continue above them.
+uint64_t NextManifestSequence(arrow::fs::FileSystem& fs, const std::string& root);
+
+} // namespace payload::storage::common
@@ -0,0 +1,22 @@
+#include "content_hash.hpp"
+
+#include <cstring>
+
+// Header-only use of the xxHash copy Arrow ships with its headers.
+#define XXH_INLINE_ALL
+#include <arrow/vendored/xxhash.h>
+
+namespace payload::storage {
+
+payload::util::UUID ContentKey(const uint8_t* data, uint64_t length) {
+  XXH128_canonical_t canonical;
+  XXH128_canonicalFromHash(&canonical, XXH3_128bits(data, static_cast<size_t>(length)));
+
+  payload::util::UUID key{};
+  std::memcpy(key.data(), canonical.digest, key.size());
+  key[6] = (key[6] & 0x0fu) | 0x80u; // version 8 (custom)
+  key[8] = (key[8] & 0x3fu) | 0x80u; // RFC4122 variant
+  return key;
+}
+
+} // namespace payload::storage
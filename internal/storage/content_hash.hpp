@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+
+#include "internal/util/uuid.hpp"
+
+namespace payload::storage {
+
+/*
+  Content key of a payload's bytes, for deduplicating durable copies.
+
+  The 128-bit XXH3 hash of the bytes (SSE2 / AVX2 vectorized, running at
+  memory bandwidth), shaped as an RFC 9562 version-8 UUID: six bits are
+  overwritten with the version and variant, so the key never equals a
+  version-4 payload id and a content blob is stored on any tier under it
+  like an ordinary payload.
+*/
+payload::util::UUID ContentKey(const uint8_t* data, uint64_t length);
+
+} // namespace payload::storage
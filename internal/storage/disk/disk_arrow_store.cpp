@@ -1,18 +1,28 @@
 #include "disk_arrow_store.hpp"
 
+#include <arrow/filesystem/localfs.h>
 #include <arrow/io/file.h>
 #include <fcntl.h>
-#include <google/protobuf/util/json_util.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <cctype>
 #include <cerrno>
 #include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <functional>
+#include <string_view>
+#include <utility>
+#include <vector>
 
+#include "internal/observability/logging.hpp"
 #include "internal/storage/common/arrow_utils.hpp"
 #include "internal/storage/common/path_utils.hpp"
+#include "internal/util/errors.hpp"
 #include "internal/util/uuid.hpp"
 #include "payload/manager/v1.hpp"
 
@@ -34,33 +44,552 @@ std::string Key(const PayloadID& id) {
   return id.value();
 }
 
+// Small metadata files (sidecars, manifest segments): write-to-tmp + rename.
+void WriteFileAtomic(const std::filesystem::path& path, const std::string& bytes) {
+  const auto tmp = path.string() + ".tmp";
+  {
+    std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+    if (!out) {
+      throw std::runtime_error("WriteSidecar: open failed for " + tmp + ": " + std::strerror(errno));
+    }
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    if (!out.flush()) {
+      throw std::runtime_error("WriteSidecar: write failed for " + tmp);
+    }
+  }
+
+  try {
+    std::filesystem::rename(tmp, path);
+  } catch (...) {
+    std::error_code ec;
+    std::filesystem::remove(tmp, ec);
+    throw;
+  }
+}
+
+constexpr const char* kPackDir = "packs";
+
+// "ab": a hashed fan-out directory.
+bool IsFanoutDir(const std::filesystem::path& dir) {
+  const auto name = dir.filename().string();
+  return name.size() == 2 && std::isxdigit(static_cast<unsigned char>(name[0])) && std::isxdigit(static_cast<unsigned char>(name[1]));
+}
+
+// Subtracts bytes from used, stopping at zero.
+void Subtract(std::atomic<uint64_t>& used, uint64_t bytes) {
+  uint64_t current = used.load(std::memory_order_relaxed);
+  while (!used.compare_exchange_weak(current, current - std::min(current, bytes), std::memory_order_relaxed)) {
+  }
+}
+
+/*
+  Bytes held against the tier's capacity for one write. Released when the
+  reservation is dropped unless Keep() was called once the payload landed.
+*/
+class Reservation {
+ public:
+  Reservation() = default;
+  Reservation(std::atomic<uint64_t>* used, uint64_t bytes) : used_(used), bytes_(bytes) {
+  }
+  Reservation(Reservation&& other) noexcept : used_(other.used_), bytes_(std::exchange(other.bytes_, 0)) {
+  }
+  Reservation& operator=(Reservation&&) = delete;
+
+  ~Reservation() {
+    if (bytes_ > 0) Subtract(*used_, bytes_);
+  }
+
+  // Re-sizes the reservation to the bytes actually written; a writer's
+  // size is only a hint (a compressed frame usually lands smaller).
+  void Settle(uint64_t bytes) {
+    if (!used_) return;
+    if (bytes > bytes_) {
+      used_->fetch_add(bytes - bytes_, std::memory_order_relaxed);
+    } else {
+      Subtract(*used_, bytes_ - bytes);
+    }
+    bytes_ = bytes;
+  }
+
+  void Keep() {
+    bytes_ = 0;
+  }
+
+ private:
+  std::atomic<uint64_t>* used_  = nullptr;
+  uint64_t               bytes_ = 0;
+};
+
+// Adds bytes to used unless that passes capacity; no-op without a capacity.
+Reservation Reserve(std::atomic<uint64_t>& used, uint64_t capacity, uint64_t bytes) {
+  if (capacity == 0) return {};
+  uint64_t current = used.load(std::memory_order_relaxed);
+  do {
+    if (bytes > capacity - std::min(current, capacity)) {
+      throw payload::util::ResourceExhausted("disk tier full: " + std::to_string(bytes) + " bytes requested, " + std::to_string(current) + " of " +
+                                             std::to_string(capacity) + " in use");
+    }
+  } while (!used.compare_exchange_weak(current, current + bytes, std::memory_order_relaxed));
+  return Reservation(&used, bytes);
+}
+
+/*
+  Allocates real extents for the first length bytes of fd. keep_size
+  leaves the file size to the writes that follow. Returns false, leaving
+  the file sparse, on filesystems without fallocate; running out of space
+  is ResourceExhausted, raised before any payload byte is written.
+*/
+bool Preallocate(int fd, uint64_t length, bool keep_size, const std::string& path) {
+  if (length == 0) return true;
+  int rc = 0;
+  do {
+    rc = fallocate(fd, keep_size ? FALLOC_FL_KEEP_SIZE : 0, 0, static_cast<off_t>(length));
+  } while (rc != 0 && errno == EINTR);
+  if (rc == 0) return true;
+  if (errno == EOPNOTSUPP || errno == ENOSYS) {
+    static std::atomic<bool> warned{false};
+    if (!warned.exchange(true)) {
+      PAYLOAD_LOG_WARN("disk tier: filesystem does not support fallocate; payload files stay sparse",
+                       {payload::observability::StringField("path", path)});
+    }
+    return false;
+  }
+  if (errno == ENOSPC) {
+    throw payload::util::ResourceExhausted("disk allocate: no space for " + std::to_string(length) + " bytes at " + path);
+  }
+  throw std::runtime_error("disk allocate: fallocate failed for " + path + ": " + std::strerror(errno));
+}
+
+// Per-call cap for copy_file_range / sendfile (both stop short of 2 GiB).
+constexpr uint64_t kKernelCopyChunk = uint64_t{1} << 30;
+
+// How far ahead of a streaming reader POSIX_FADV_WILLNEED is issued.
+constexpr uint64_t kReadaheadWindow = uint64_t{64} << 20;
+
+uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+// pread / pwrite the whole range, retrying short transfers and EINTR.
+void PreadFully(int fd, uint8_t* out, uint64_t length, uint64_t offset, const std::string& path) {
+  for (uint64_t done = 0; done < length;) {
+    const ssize_t n = pread(fd, out + done, static_cast<size_t>(length - done), static_cast<off_t>(offset + done));
+    if (n < 0 && errno == EINTR) continue;
+    if (n < 0) throw std::runtime_error("disk read: pread failed for " + path + ": " + std::strerror(errno));
+    if (n == 0) throw std::runtime_error("disk read: " + path + " ended before offset " + std::to_string(offset + length));
+    done += static_cast<uint64_t>(n);
+  }
+}
+
+void PwriteFully(int fd, const uint8_t* data, uint64_t length, uint64_t offset, const std::string& path) {
+  for (uint64_t done = 0; done < length;) {
+    const ssize_t n = pwrite(fd, data + done, static_cast<size_t>(length - done), static_cast<off_t>(offset + done));
+    if (n < 0 && errno == EINTR) continue;
+    if (n < 0) throw std::runtime_error("disk write: pwrite failed for " + path + ": " + std::strerror(errno));
+    done += static_cast<uint64_t>(n);
+  }
+}
+
+/*
+  Streams a payload file front to back. The kernel is told the access is
+  sequential, and WILLNEED keeps readahead up to kReadaheadWindow (or the
+  whole payload, if smaller) ahead of the reader so reads overlap the
+  consumer's copy.
+*/
+class DiskPayloadReader final : public PayloadReader {
+ public:
+  DiskPayloadReader(int fd, uint64_t size, std::string path, IoUringEngine* engine)
+      : fd_(fd), size_(size), path_(std::move(path)), engine_(engine) {
+    (void)posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+    AdviseUpTo(std::min(size_, kReadaheadWindow));
+  }
+
+  ~DiskPayloadReader() override {
+    close(fd_);
+  }
+
+  uint64_t Size() const override {
+    return size_;
+  }
+
+  void ReadAt(uint64_t offset, uint8_t* out, uint64_t length) override {
+    AdviseUpTo(std::min(size_, offset + length + kReadaheadWindow));
+    if (engine_) {
+      engine_->Read(fd_, out, length, /*direct=*/false, offset);
+    } else {
+      PreadFully(fd_, out, length, offset, path_);
+    }
+  }
+
+ private:
+  // Hints are advisory; failures are ignored.
+  void AdviseUpTo(uint64_t end) {
+    if (end > advised_) {
+      (void)posix_fadvise(fd_, static_cast<off_t>(advised_), static_cast<off_t>(end - advised_), POSIX_FADV_WILLNEED);
+      advised_ = end;
+    }
+  }
+
+  int            fd_;
+  uint64_t       size_;
+  std::string    path_;
+  IoUringEngine* engine_;
+  uint64_t       advised_ = 0;
+};
+
+/*
+  Appends into <uuid>.bin.tmp; Commit fsyncs (when asked) and renames it
+  over the final path, the same protocol as DiskArrowStore::Write, then
+  keeps the capacity reservation and runs committed.
+*/
+class DiskPayloadWriter final : public PayloadWriter {
+ public:
+  DiskPayloadWriter(int fd, std::string tmp_path, std::filesystem::path final_path, bool fsync, IoUringEngine* engine, Reservation reservation,
+                    std::function<void()> committed)
+      : fd_(fd),
+        tmp_path_(std::move(tmp_path)),
+        final_path_(std::move(final_path)),
+        fsync_(fsync),
+        engine_(engine),
+        reservation_(std::move(reservation)),
+        committed_(std::move(committed)) {
+  }
+
+  ~DiskPayloadWriter() override {
+    if (fd_ >= 0) {
+      close(fd_);
+      std::error_code ec;
+      std::filesystem::remove(tmp_path_, ec);
+    }
+  }
+
+  void Append(const uint8_t* data, uint64_t length) override {
+    if (engine_) {
+      engine_->Write(fd_, data, length, /*direct=*/false, written_);
+    } else {
+      PwriteFully(fd_, data, length, written_, tmp_path_);
+    }
+    written_ += length;
+  }
+
+  void Commit() override {
+    if (fsync_ && ::fsync(fd_) != 0) {
+      throw std::runtime_error("disk write: fsync failed for " + tmp_path_ + ": " + std::strerror(errno));
+    }
+    const int fd = std::exchange(fd_, -1);
+    if (close(fd) != 0) {
+      const int       saved = errno;
+      std::error_code ec;
+      std::filesystem::remove(tmp_path_, ec);
+      throw std::runtime_error("disk write: close failed for " + tmp_path_ + ": " + std::strerror(saved));
+    }
+    try {
+      std::filesystem::rename(tmp_path_, final_path_);
+    } catch (...) {
+      std::error_code ec;
+      std::filesystem::remove(tmp_path_, ec);
+      throw;
+    }
+    reservation_.Settle(written_);
+    reservation_.Keep();
+    if (committed_) committed_();
+  }
+
+ private:
+  int                   fd_;
+  std::string           tmp_path_;
+  std::filesystem::path final_path_;
+  bool                  fsync_;
+  IoUringEngine*        engine_;
+  Reservation           reservation_;
+  std::function<void()> committed_;
+  uint64_t              written_ = 0;
+};
+
+/*
+  Collects a payload small enough to pack in a heap buffer (offered as the
+  destination); Commit appends it as one record.
+*/
+class PackedPayloadWriter final : public PayloadWriter {
+ public:
+  PackedPayloadWriter(uint64_t size_bytes, Reservation reservation, std::function<void(const std::vector<uint8_t>&)> publish)
+      : reservation_(std::move(reservation)), publish_(std::move(publish)), bytes_(static_cast<size_t>(size_bytes)) {
+  }
+
+  void Append(const uint8_t* data, uint64_t length) override {
+    if (written_ + length > bytes_.size()) bytes_.resize(static_cast<size_t>(written_ + length));
+    std::memcpy(bytes_.data() + written_, data, static_cast<size_t>(length));
+    written_ += length;
+  }
+
+  uint8_t* Destination() override {
+    return bytes_.empty() ? nullptr : bytes_.data();
+  }
+
+  void Commit() override {
+    if (written_ > 0) bytes_.resize(static_cast<size_t>(written_));
+    publish_(bytes_);
+    reservation_.Settle(bytes_.size());
+    reservation_.Keep();
+  }
+
+ private:
+  Reservation                                       reservation_;
+  std::function<void(const std::vector<uint8_t>&)> publish_;
+  std::vector<uint8_t>                              bytes_;
+  uint64_t                                          written_ = 0;
+};
+
 } // namespace
 
-DiskArrowStore::DiskArrowStore(std::filesystem::path root) : root_(std::move(root)) {
+DiskArrowStore::DiskArrowStore(std::filesystem::path root, DiskStoreOptions options) : root_(std::move(root)), options_(std::move(options)) {
+  if (options_.fanout_levels > kMaxFanoutLevels) {
+    throw std::invalid_argument("disk store: fanout_levels must be at most " + std::to_string(kMaxFanoutLevels));
+  }
   std::filesystem::create_directories(root_);
+  if (options_.fanout_levels > 0) {
+    fanout_made_ = std::make_unique<std::atomic<bool>[]>(size_t{1} << (8 * options_.fanout_levels));
+  }
+  MigrateLayout();
+  if (options_.pack.enabled) {
+    pack_ = std::make_unique<PackStore>(root_ / kPackDir, options_.pack);
+  }
+  if (options_.capacity_bytes > 0) {
+    used_bytes_ = ScanUsedBytes();
+  }
+  if (options_.io_uring.enabled) {
+    io_engine_ = IoUringEngine::Create(options_.io_uring);
+  }
+  if (options_.sidecars.format == SidecarFormat::kManifest) {
+    const auto manifest_dir = root_ / kManifestDir;
+    std::filesystem::create_directories(manifest_dir);
+    auto local      = std::make_shared<arrow::fs::LocalFileSystem>();
+    manifest_       = std::make_unique<ManifestWriter>(
+        options_.sidecars, [manifest_dir](const std::string& name, const std::string& bytes) { WriteFileAtomic(manifest_dir / name, bytes); },
+        NextManifestSequence(*local, root_.string()), local, root_.string());
+  }
+}
+
+DiskArrowStore::~DiskArrowStore() = default;
+
+std::filesystem::path DiskArrowStore::DataPath(const PayloadID& id) const {
+  return PayloadPath(root_, Key(id), options_.fanout_levels);
+}
+
+std::filesystem::path DiskArrowStore::SidecarFile(const PayloadID& id) const {
+  return SidecarPath(root_, Key(id), options_.sidecars.format, options_.fanout_levels);
+}
+
+std::filesystem::path DiskArrowStore::WritableDataPath(const PayloadID& id) {
+  MakeFanoutDir(Key(id));
+  return DataPath(id);
+}
+
+std::filesystem::path DiskArrowStore::WritableSidecarFile(const PayloadID& id) {
+  MakeFanoutDir(Key(id));
+  return SidecarFile(id);
+}
+
+/*
+  A packed payload is located in its segment file ("packs/<segment>.pack")
+  at the offset of its first byte.
+*/
+void DiskArrowStore::Locate(const std::string& key, DiskLocation* location) const {
+  if (pack_) {
+    if (const auto packed = pack_->Find(key)) {
+      location->set_path(std::string(kPackDir) + "/" + PackStore::SegmentName(packed->segment));
+      location->set_offset_bytes(packed->offset);
+      return;
+    }
+  }
+  location->set_path((FanoutDir(key, options_.fanout_levels) / (key + ".bin")).string());
+  location->set_offset_bytes(0);
+}
+
+uint64_t DiskArrowStore::LocationEpoch() const {
+  return pack_ ? pack_->Relocations() : 0;
+}
+
+std::optional<std::string> DiskArrowStore::LocatedKey(const DiskLocation& location) const {
+  const std::string prefix = std::string(kPackDir) + "/";
+  if (!pack_ || location.path().compare(0, prefix.size(), prefix) != 0) {
+    return StorageBackend::LocatedKey(location);
+  }
+  try {
+    return pack_->KeyAt(std::stoull(location.path().substr(prefix.size()), nullptr, 16), location.offset_bytes());
+  } catch (const std::exception&) {
+    return std::nullopt;
+  }
+}
+
+/*
+  Payload bytes already in the root when the store opens: every payload
+  file in the configured layout plus the live packed records.
+*/
+uint64_t DiskArrowStore::ScanUsedBytes() const {
+  uint64_t total = pack_ ? pack_->GetStats().payload_bytes : 0;
+  for (auto it = std::filesystem::recursive_directory_iterator(root_); it != std::filesystem::recursive_directory_iterator(); ++it) {
+    if (it->is_directory()) {
+      if (it.depth() >= static_cast<int>(kMaxFanoutLevels) || !IsFanoutDir(it->path())) it.disable_recursion_pending();
+      continue;
+    }
+    std::error_code ec;
+    if (it->path().extension() == ".bin") total += it->file_size(ec);
+  }
+  return total;
+}
+
+std::vector<std::string> DiskArrowStore::StoredKeys() const {
+  auto keys = pack_ ? pack_->Keys() : std::vector<std::string>{};
+  for (auto it = std::filesystem::recursive_directory_iterator(root_); it != std::filesystem::recursive_directory_iterator(); ++it) {
+    if (it->is_directory()) {
+      if (it.depth() >= static_cast<int>(kMaxFanoutLevels) || !IsFanoutDir(it->path())) it.disable_recursion_pending();
+      continue;
+    }
+    if (it->path().extension() == ".bin") keys.push_back(it->path().stem().string());
+  }
+  return keys;
+}
+
+uint64_t DiskArrowStore::AccountedBytes(const PayloadID& id) const {
+  if (options_.capacity_bytes == 0) return 0;
+  if (pack_) {
+    if (const auto packed = pack_->Find(Key(id))) return packed->length;
+  }
+  std::error_code ec;
+  const auto      size = std::filesystem::file_size(DataPath(id), ec);
+  return ec ? 0 : size;
+}
+
+void DiskArrowStore::Release(uint64_t bytes) {
+  Subtract(used_bytes_, bytes);
+}
+
+bool DiskArrowStore::Packed(uint64_t size_bytes) const {
+  return pack_ && size_bytes <= options_.pack.max_payload_bytes;
+}
+
+void DiskArrowStore::WritePacked(const PayloadID& id, const uint8_t* data, uint64_t length, bool fsync) {
+  pack_->Put(Key(id), data, length, fsync);
+  std::error_code ec;
+  std::filesystem::remove(DataPath(id), ec);
+}
+
+void DiskArrowStore::DropPacked(const PayloadID& id) {
+  if (pack_) pack_->Remove(Key(id));
+}
+
+/*
+  Leaf directories are created on the first write into them rather than
+  up front (65,536 of them at two levels); after that the flag saves the
+  mkdir on every write.
+*/
+void DiskArrowStore::MakeFanoutDir(const std::string& key) {
+  if (!fanout_made_) return;
+  auto& made = fanout_made_[FanoutBucket(key, options_.fanout_levels)];
+  if (made.load(std::memory_order_acquire)) return;
+  std::filesystem::create_directories(root_ / FanoutDir(key, options_.fanout_levels));
+  made.store(true, std::memory_order_release);
+}
+
+/*
+  Moves payload and sidecar files written under another fan-out setting
+  (a flat root, or a different number of levels) to where this one puts
+  them. <root>/.layout records the setting the files are in; it is
+  rewritten once every file has moved, so an interrupted migration simply
+  runs again on the next start. A root whose setting did not change is
+  not walked.
+*/
+void DiskArrowStore::MigrateLayout() {
+  const auto marker  = root_ / ".layout";
+  uint32_t   current = 0;
+  {
+    std::ifstream in(marker);
+    std::string   field;
+    if (in >> field >> current && field != "fanout_levels") current = 0;
+  }
+  if (current == options_.fanout_levels) return;
+
+  std::vector<std::filesystem::path> files;
+  std::vector<std::filesystem::path> old_dirs;
+  for (auto it = std::filesystem::recursive_directory_iterator(root_); it != std::filesystem::recursive_directory_iterator(); ++it) {
+    if (it->is_directory()) {
+      if (it.depth() >= static_cast<int>(kMaxFanoutLevels) || !IsFanoutDir(it->path())) {
+        it.disable_recursion_pending();
+      }
+      if (IsFanoutDir(it->path())) old_dirs.push_back(it->path());
+      continue;
+    }
+    files.push_back(it->path());
+  }
+
+  for (const auto& path : files) {
+    const auto  name = path.filename().string();
+    std::string key;
+    for (const char* suffix : {".bin", ".meta.json", ".meta.pb"}) {
+      const std::string_view s(suffix);
+      if (name.size() > s.size() && name.compare(name.size() - s.size(), s.size(), s) == 0) {
+        key = name.substr(0, name.size() - s.size());
+        break;
+      }
+    }
+    if (key.empty()) continue;
+
+    const auto target = root_ / FanoutDir(key, options_.fanout_levels) / name;
+    if (path == target) continue;
+    std::filesystem::create_directories(target.parent_path());
+    std::filesystem::rename(path, target);
+    ++migrated_files_;
+  }
+
+  // Fan-out directories the move emptied, deepest first.
+  std::sort(old_dirs.begin(), old_dirs.end(), [](const auto& a, const auto& b) { return a.string().size() > b.string().size(); });
+  for (const auto& dir : old_dirs) {
+    std::error_code ec;
+    if (std::filesystem::is_empty(dir, ec) && !ec) std::filesystem::remove(dir, ec);
+  }
+
+  WriteFileAtomic(marker, "fanout_levels " + std::to_string(options_.fanout_levels) + "\n");
+  if (migrated_files_ > 0) {
+    PAYLOAD_LOG_INFO("disk tier: moved payload files to the configured fan-out layout",
+                     {payload::observability::StringField("root", root_.string()),
+                      payload::observability::IntField("from_levels", current),
+                      payload::observability::IntField("to_levels", options_.fanout_levels),
+                      payload::observability::IntField("files", static_cast<int64_t>(migrated_files_))});
+  }
 }
 
 /*
   Pre-allocate the backing file so the client can mmap it writable.
-  Uses open(O_CREAT|O_EXCL) + ftruncate to reserve space atomically.
+  The size is reserved against capacity_bytes first, so a full tier
+  fails here rather than part-way through the client's write. Then
+  open(O_CREAT|O_EXCL) and either fallocate (real extents, with
+  preallocate) or ftruncate (sparse) to the size.
   The return value is unused by PayloadManager::Allocate.
 */
 std::shared_ptr<arrow::Buffer> DiskArrowStore::Allocate(const PayloadID& id, uint64_t size_bytes) {
-  const auto path = PayloadPath(root_, Key(id));
+  auto       reservation = Reserve(used_bytes_, options_.capacity_bytes, size_bytes);
+  const auto path        = WritableDataPath(id);
 
   int fd = open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
   if (fd < 0) {
     throw std::runtime_error("disk allocate: open failed for " + path.string() + ": " + std::strerror(errno));
   }
 
-  if (size_bytes > 0 && ftruncate(fd, static_cast<off_t>(size_bytes)) != 0) {
-    const int saved = errno;
+  try {
+    const bool extents = options_.preallocate && Preallocate(fd, size_bytes, /*keep_size=*/false, path.string());
+    if (!extents && size_bytes > 0 && ftruncate(fd, static_cast<off_t>(size_bytes)) != 0) {
+      throw std::runtime_error("disk allocate: ftruncate failed for " + path.string() + ": " + std::strerror(errno));
+    }
+  } catch (...) {
     close(fd);
-    std::filesystem::remove(path);
-    throw std::runtime_error("disk allocate: ftruncate failed for " + path.string() + ": " + std::strerror(saved));
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+    throw;
   }
 
   close(fd);
+  reservation.Keep();
   return nullptr;
 }
 
@@ -68,26 +597,69 @@ std::shared_ptr<arrow::Buffer> DiskArrowStore::Allocate(const PayloadID& id, uin
   Read entire payload from disk.
 */
 std::shared_ptr<arrow::Buffer> DiskArrowStore::Read(const PayloadID& id) {
-  auto path = PayloadPath(root_, Key(id));
+  if (pack_) {
+    if (auto packed = pack_->Read(Key(id))) return packed;
+  }
+  auto path = DataPath(id);
+  if (options_.mmap_reads) {
+    return ReadMapped(path);
+  }
+  if (io_engine_) {
+    return ReadWithEngine(path);
+  }
 
   auto file = Unwrap(arrow::io::ReadableFile::Open(path.string()));
   return ReadAll(file);
 }
 
 uint64_t DiskArrowStore::Size(const PayloadID& id) {
-  return static_cast<uint64_t>(std::filesystem::file_size(PayloadPath(root_, Key(id))));
+  if (pack_) {
+    if (const auto packed = pack_->Find(Key(id))) return packed->length;
+  }
+  return static_cast<uint64_t>(std::filesystem::file_size(DataPath(id)));
+}
+
+bool DiskArrowStore::Contains(const PayloadID& id) const {
+  if (pack_ && pack_->Find(Key(id))) return true;
+  std::error_code ec;
+  return std::filesystem::exists(DataPath(id), ec);
 }
 
 /*
   Atomic write:
       write tmp → flush → rename
+  or, for a payload small enough to pack, one appended record.
+  The size is reserved against capacity_bytes before anything is written;
+  what the payload held before is released once the new bytes are in.
 */
 void DiskArrowStore::Write(const PayloadID& id, const std::shared_ptr<arrow::Buffer>& buffer, bool fsync) {
-  auto final_path = PayloadPath(root_, Key(id));
+  const auto length      = static_cast<uint64_t>(buffer->size());
+  auto       reservation = Reserve(used_bytes_, options_.capacity_bytes, length);
+  const auto replaced    = AccountedBytes(id);
+  if (Packed(length)) {
+    WritePacked(id, buffer->data(), length, fsync);
+    reservation.Keep();
+    Release(replaced);
+    return;
+  }
+
+  auto final_path = WritableDataPath(id);
   auto tmp_path   = final_path.string() + ".tmp";
 
-  {
+  if (io_engine_) {
+    WriteWithEngine(tmp_path, buffer, fsync);
+  } else {
     auto out = Unwrap(arrow::io::FileOutputStream::Open(tmp_path));
+    if (options_.preallocate) {
+      try {
+        Preallocate(out->file_descriptor(), length, /*keep_size=*/true, tmp_path);
+      } catch (...) {
+        (void)out->Close();
+        std::error_code ec;
+        std::filesystem::remove(tmp_path, ec);
+        throw;
+      }
+    }
     Unwrap(out->Write(buffer->data(), buffer->size()));
 
     if (fsync) Unwrap(out->Flush());
@@ -102,49 +674,302 @@ void DiskArrowStore::Write(const PayloadID& id, const std::shared_ptr<arrow::Buf
     std::filesystem::remove(tmp_path, ec);
     throw;
   }
+  DropPacked(id);
+  reservation.Keep();
+  Release(replaced);
 }
 
 /*
-  Remove payload from disk. Sidecar is cleaned up best-effort.
+  mmap read: the returned buffer is a slice of a read-only mapping and
+  keeps it alive. Payload files are only ever replaced by rename, never
+  truncated in place, so a held mapping stays valid after Write / Remove.
+  The kernel is told access will be sequential so faults read ahead.
 */
-void DiskArrowStore::Remove(const PayloadID& id) {
-  std::filesystem::remove(PayloadPath(root_, Key(id)));
-  std::error_code ec;
-  std::filesystem::remove(SidecarPath(root_, Key(id)), ec);
+std::shared_ptr<arrow::Buffer> DiskArrowStore::ReadMapped(const std::filesystem::path& path) {
+  auto file   = Unwrap(arrow::io::MemoryMappedFile::Open(path.string(), arrow::io::FileMode::READ));
+  auto size   = Unwrap(file->GetSize());
+  auto buffer = Unwrap(file->Read(size));
+  if (size > 0) {
+    // The slice starts at file offset 0, i.e. the page-aligned mapping base.
+    (void)madvise(const_cast<uint8_t*>(buffer->data()), static_cast<size_t>(size), MADV_SEQUENTIAL);
+  }
+  return buffer;
 }
 
 /*
-  Write <uuid>.meta.json alongside the data file.
-  Uses write-to-tmp + atomic rename for crash safety.
+  io_uring read: the destination is allocated at the O_DIRECT alignment
+  (and rounded up to it for a direct read) so the engine reads straight
+  into it; the returned buffer is sliced to the file size.
 */
-void DiskArrowStore::WriteSidecar(const PayloadID& id, const payload::manager::catalog::v1::PayloadArchiveMetadata& meta) {
-  google::protobuf::util::JsonPrintOptions opts;
-  opts.add_whitespace = true;
+std::shared_ptr<arrow::Buffer> DiskArrowStore::ReadWithEngine(const std::filesystem::path& path) {
+  const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    throw std::runtime_error("disk read: open failed for " + path.string() + ": " + std::strerror(errno));
+  }
+
+  std::shared_ptr<arrow::Buffer> buffer;
+  uint64_t                       length = 0;
+  try {
+    struct stat st {};
+    if (fstat(fd, &st) != 0) {
+      throw std::runtime_error("disk read: fstat failed for " + path.string() + ": " + std::strerror(errno));
+    }
+    length = static_cast<uint64_t>(st.st_size);
+
+    // O_DIRECT is switched on after the size is known; filesystems that
+    // refuse it keep the buffered descriptor.
+    const bool direct = io_engine_->UseDirect(length) && fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_DIRECT) == 0;
+
+    const auto capacity  = direct ? AlignUp(length, IoUringEngine::kDirectAlignment) : length;
+    auto       allocated = arrow::AllocateBuffer(static_cast<int64_t>(capacity), static_cast<int64_t>(IoUringEngine::kDirectAlignment));
+    if (!allocated.ok()) {
+      throw std::runtime_error(allocated.status().ToString());
+    }
+    buffer = std::move(*allocated);
+    io_engine_->Read(fd, buffer->mutable_data(), length, direct);
+  } catch (...) {
+    close(fd);
+    throw;
+  }
+  close(fd);
+  return length == static_cast<uint64_t>(buffer->size()) ? buffer : arrow::SliceBuffer(buffer, 0, static_cast<int64_t>(length));
+}
 
-  std::string json;
-  auto        status = google::protobuf::util::MessageToJsonString(meta, &json, opts);
-  if (!status.ok()) {
-    throw std::runtime_error("WriteSidecar: serialization failed for " + Key(id) + ": " + status.ToString());
+/*
+  io_uring write into tmp_path. A direct write covers whole alignment
+  blocks, so the file is truncated back to the payload size.
+*/
+void DiskArrowStore::WriteWithEngine(const std::string& tmp_path, const std::shared_ptr<arrow::Buffer>& buffer, bool fsync) {
+  const int fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+  if (fd < 0) {
+    throw std::runtime_error("disk write: open failed for " + tmp_path + ": " + std::strerror(errno));
   }
 
-  const auto path = SidecarPath(root_, Key(id));
-  const auto tmp  = path.string() + ".tmp";
+  try {
+    const auto length = static_cast<uint64_t>(buffer->size());
+    const bool direct = io_engine_->UseDirect(length) && fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_DIRECT) == 0;
 
-  {
-    std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
-    if (!out) {
-      throw std::runtime_error("WriteSidecar: open failed for " + tmp + ": " + std::strerror(errno));
+    if (options_.preallocate) Preallocate(fd, length, /*keep_size=*/true, tmp_path);
+    io_engine_->Write(fd, buffer->data(), length, direct);
+    if (direct && ftruncate(fd, static_cast<off_t>(length)) != 0) {
+      throw std::runtime_error("disk write: ftruncate failed for " + tmp_path + ": " + std::strerror(errno));
+    }
+    if (fsync && ::fsync(fd) != 0) {
+      throw std::runtime_error("disk write: fsync failed for " + tmp_path + ": " + std::strerror(errno));
     }
-    out.write(json.data(), static_cast<std::streamsize>(json.size()));
+  } catch (...) {
+    close(fd);
+    std::error_code ec;
+    std::filesystem::remove(tmp_path, ec);
+    throw;
+  }
+  if (close(fd) != 0) {
+    const int       saved = errno;
+    std::error_code ec;
+    std::filesystem::remove(tmp_path, ec);
+    throw std::runtime_error("disk write: close failed for " + tmp_path + ": " + std::strerror(saved));
+  }
+}
+
+/*
+  Kernel-side write from another file (RAM shm → disk spill).
+
+  copy_file_range first; it refuses to cross filesystems (EXDEV) on current
+  kernels, so tmpfs → ext4 falls back to sendfile, which still copies page
+  cache to page cache without a user-space buffer. Same tmp → rename
+  protocol as Write; with fsync the data is fsync'ed before the rename.
+  Returns false before any byte is copied when kernel_copy is off or
+  neither call supports the source file, and for payloads small enough
+  to pack (Write appends those).
+*/
+bool DiskArrowStore::WriteFromFile(const PayloadID& id, int fd, uint64_t offset, uint64_t length, bool fsync) {
+  if (!options_.kernel_copy || Packed(length)) {
+    return false;
+  }
+  auto       reservation = Reserve(used_bytes_, options_.capacity_bytes, length);
+  const auto replaced    = AccountedBytes(id);
+
+  const auto final_path = WritableDataPath(id);
+  const auto tmp_path   = final_path.string() + ".tmp";
+
+  const int out = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+  if (out < 0) {
+    throw std::runtime_error("disk write: open failed for " + tmp_path + ": " + std::strerror(errno));
+  }
+  auto discard = [&] {
+    close(out);
+    std::error_code ec;
+    std::filesystem::remove(tmp_path, ec);
+  };
+  auto fail = [&](const std::string& what, int error) {
+    discard();
+    throw std::runtime_error("disk write: " + what + " failed for " + tmp_path + ": " + std::strerror(error));
+  };
+  if (options_.preallocate) {
+    try {
+      Preallocate(out, length, /*keep_size=*/true, tmp_path);
+    } catch (...) {
+      discard();
+      throw;
+    }
+  }
+
+  auto     in_offset    = static_cast<off_t>(offset);
+  uint64_t copied       = 0;
+  bool     use_sendfile = false;
+  while (copied < length) {
+    const auto chunk = static_cast<size_t>(std::min(length - copied, kKernelCopyChunk));
+    ssize_t    n     = 0;
+    if (!use_sendfile) {
+      n = copy_file_range(fd, &in_offset, out, nullptr, chunk, 0);
+      if (n < 0 && copied == 0 && (errno == EXDEV || errno == EINVAL || errno == ENOSYS || errno == EOPNOTSUPP)) {
+        use_sendfile = true;
+        continue;
+      }
+    } else {
+      n = sendfile(out, fd, &in_offset, chunk);
+      if (n < 0 && copied == 0 && (errno == EINVAL || errno == ENOSYS)) {
+        discard();
+        return false;
+      }
+    }
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0) {
+      fail(use_sendfile ? "sendfile" : "copy_file_range", errno);
+    }
+    if (n == 0) {
+      fail("copy (source ended at " + std::to_string(copied) + " of " + std::to_string(length) + " bytes)", EIO);
+    }
+    copied += static_cast<uint64_t>(n);
+  }
+
+  if (fsync && ::fsync(out) != 0) {
+    fail("fsync", errno);
+  }
+  if (close(out) != 0) {
+    const int saved = errno;
+    std::error_code ec;
+    std::filesystem::remove(tmp_path, ec);
+    throw std::runtime_error("disk write: close failed for " + tmp_path + ": " + std::strerror(saved));
   }
 
   try {
-    std::filesystem::rename(tmp, path);
+    std::filesystem::rename(tmp_path, final_path);
   } catch (...) {
     std::error_code ec;
-    std::filesystem::remove(tmp, ec);
+    std::filesystem::remove(tmp_path, ec);
     throw;
   }
+  DropPacked(id);
+  reservation.Keep();
+  Release(replaced);
+  return true;
+}
+
+std::unique_ptr<PayloadReader> DiskArrowStore::OpenReader(const PayloadID& id) {
+  // Packed payloads are small enough that Read() is the better transfer.
+  if (pack_ && pack_->Find(Key(id))) {
+    return nullptr;
+  }
+  const auto path = DataPath(id);
+  const int  fd   = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    throw std::runtime_error("disk read: open failed for " + path.string() + ": " + std::strerror(errno));
+  }
+  struct stat st {};
+  if (fstat(fd, &st) != 0) {
+    const int saved = errno;
+    close(fd);
+    throw std::runtime_error("disk read: fstat failed for " + path.string() + ": " + std::strerror(saved));
+  }
+  return std::make_unique<DiskPayloadReader>(fd, static_cast<uint64_t>(st.st_size), path.string(), io_engine_.get());
+}
+
+/*
+  size_bytes is reserved against capacity_bytes (and preallocated) when
+  the writer opens; a writer dropped without Commit gives it back.
+*/
+std::unique_ptr<PayloadWriter> DiskArrowStore::OpenWriter(const PayloadID& id, uint64_t size_bytes, bool fsync) {
+  auto       reservation = Reserve(used_bytes_, options_.capacity_bytes, size_bytes);
+  const auto replaced    = AccountedBytes(id);
+  if (Packed(size_bytes)) {
+    return std::make_unique<PackedPayloadWriter>(size_bytes, std::move(reservation),
+                                                 [this, id, fsync, replaced](const std::vector<uint8_t>& bytes) {
+                                                   WritePacked(id, bytes.data(), bytes.size(), fsync);
+                                                   Release(replaced);
+                                                 });
+  }
+
+  auto      final_path = WritableDataPath(id);
+  auto      tmp_path   = final_path.string() + ".tmp";
+  const int fd         = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+  if (fd < 0) {
+    throw std::runtime_error("disk write: open failed for " + tmp_path + ": " + std::strerror(errno));
+  }
+  if (options_.preallocate) {
+    try {
+      Preallocate(fd, size_bytes, /*keep_size=*/true, tmp_path);
+    } catch (...) {
+      close(fd);
+      std::error_code ec;
+      std::filesystem::remove(tmp_path, ec);
+      throw;
+    }
+  }
+  return std::make_unique<DiskPayloadWriter>(fd, std::move(tmp_path), std::move(final_path), fsync, io_engine_.get(), std::move(reservation),
+                                             [this, id, replaced] {
+                                               DropPacked(id);
+                                               Release(replaced);
+                                             });
+}
+
+/*
+  Remove payload from disk, releasing its bytes from the capacity
+  reservation. Sidecar is cleaned up best-effort.
+*/
+void DiskArrowStore::Remove(const PayloadID& id) {
+  const auto bytes = AccountedBytes(id);
+  DropPacked(id);
+  std::filesystem::remove(DataPath(id));
+  Release(bytes);
+  RemoveSidecar(id);
+}
+
+void DiskArrowStore::RemoveSidecar(const PayloadID& id) {
+  if (manifest_) {
+    manifest_->Remove(id);
+    return;
+  }
+  std::error_code ec;
+  std::filesystem::remove(SidecarFile(id), ec);
+}
+
+/*
+  Write <uuid>.meta.json (or .meta.pb) alongside the data file, or queue
+  the metadata for the next manifest segment.
+  Files use write-to-tmp + atomic rename for crash safety.
+*/
+void DiskArrowStore::WriteSidecar(const PayloadID& id, const payload::manager::catalog::v1::PayloadArchiveMetadata& meta) {
+  if (manifest_) {
+    manifest_->Put(meta);
+    return;
+  }
+  WriteFileAtomic(WritableSidecarFile(id), EncodeSidecar(meta, options_.sidecars.format));
+}
+
+void DiskArrowStore::FlushSidecars() {
+  if (manifest_) manifest_->Flush();
+}
+
+std::vector<payload::manager::catalog::v1::PayloadArchiveMetadata> DiskArrowStore::ReadManifest() {
+  if (!manifest_) return {};
+  arrow::fs::LocalFileSystem                                         local;
+  const auto                                                         catalog = ReadManifestCatalog(local, root_.string());
+  std::vector<payload::manager::catalog::v1::PayloadArchiveMetadata> entries;
+  for (const auto& [key, meta] : catalog.Entries()) entries.push_back(meta);
+  return entries;
 }
 
 } // namespace payload::storage
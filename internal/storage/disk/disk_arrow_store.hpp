@@ -2,25 +2,67 @@
 
 #include <arrow/buffer.h>
 
+#include <atomic>
 #include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
 
+#include "internal/storage/common/sidecar.hpp"
+#include "internal/storage/disk/io_uring_engine.hpp"
+#include "internal/storage/disk/pack_store.hpp"
 #include "internal/storage/storage_backend.hpp"
 #include "payload/manager/v1.hpp"
 
 namespace payload::storage {
 
+struct DiskStoreOptions {
+  // Accept WriteFromFile (kernel-side copies); otherwise it declines and
+  // callers fall back to Read + Write.
+  bool kernel_copy = false;
+  // Payload reads and writes go through an io_uring engine when enabled
+  // and available; otherwise through blocking Arrow file IO.
+  IoUringOptions io_uring;
+  // Read() returns a buffer over a read-only mapping of the payload file
+  // instead of a heap copy; takes precedence over io_uring for reads.
+  bool mmap_reads = false;
+  // Sidecar format; manifest segments go to <root>/manifests.
+  common::SidecarOptions sidecars;
+  // Hashed subdirectory levels (0-2) payload and sidecar files are spread
+  // over. Files left by a different setting are moved on construction.
+  uint32_t fanout_levels = 0;
+  // Pack payloads up to pack.max_payload_bytes into segment files under
+  // <root>/packs. Allocate() always creates a file of the payload's own.
+  PackOptions pack;
+  // Back payload files with real extents (fallocate) instead of sparse
+  // ones, so a client writing through its mapping cannot run out of space
+  // part-way. Filesystems without fallocate stay sparse.
+  bool preallocate = false;
+  // Payload bytes the tier may hold; 0 is unlimited. Allocate and writes
+  // reserve against it up front and fail with ResourceExhausted.
+  uint64_t capacity_bytes = 0;
+};
+
 /*
   Durable disk storage using Arrow IO.
 
   Properties:
     - atomic replace writes
     - optional fsync
-    - mmap friendly reads later
+    - optional mmap reads: Read() returns a zero-copy view of the file
+    - kernel-side copies from file-backed tiers (WriteFromFile)
+    - optional io_uring engine: chunked I/O, many in flight, O_DIRECT
+    - streaming reader / writer for chunked transfers
+    - JSON, binary or batched manifest sidecars
+    - optional hashed directory fan-out (ab/cd/<uuid>.bin)
+    - optional packing of small payloads into compacted segment files
+    - optional preallocated extents and an atomic capacity reservation
 */
 
 class DiskArrowStore final : public StorageBackend {
  public:
-  explicit DiskArrowStore(std::filesystem::path root);
+  explicit DiskArrowStore(std::filesystem::path root, DiskStoreOptions options = {});
+  ~DiskArrowStore() override;
 
   std::shared_ptr<arrow::Buffer> Allocate(const payload::manager::v1::PayloadID& id, uint64_t size_bytes) override;
 
@@ -28,18 +70,92 @@ class DiskArrowStore final : public StorageBackend {
 
   uint64_t Size(const payload::manager::v1::PayloadID& id) override;
 
+  // Whether id is stored here, packed or in a file of its own.
+  bool Contains(const payload::manager::v1::PayloadID& id) const;
+
+  // Keys of every payload stored here (walks the root).
+  std::vector<std::string> StoredKeys() const;
+
   void Write(const payload::manager::v1::PayloadID& id, const std::shared_ptr<arrow::Buffer>& buffer, bool fsync) override;
 
+  bool WriteFromFile(const payload::manager::v1::PayloadID& id, int fd, uint64_t offset, uint64_t length, bool fsync) override;
+
+  std::unique_ptr<PayloadReader> OpenReader(const payload::manager::v1::PayloadID& id) override;
+
+  std::unique_ptr<PayloadWriter> OpenWriter(const payload::manager::v1::PayloadID& id, uint64_t size_bytes, bool fsync) override;
+
   void Remove(const payload::manager::v1::PayloadID& id) override;
 
   void WriteSidecar(const payload::manager::v1::PayloadID& id, const payload::manager::catalog::v1::PayloadArchiveMetadata& meta) override;
+  void RemoveSidecar(const payload::manager::v1::PayloadID& id) override;
+  void FlushSidecars() override;
+  std::vector<payload::manager::catalog::v1::PayloadArchiveMetadata> ReadManifest() override;
+
+  void                       Locate(const std::string& key, payload::manager::v1::DiskLocation* location) const override;
+  std::optional<std::string> LocatedKey(const payload::manager::v1::DiskLocation& location) const override;
+  uint64_t                   LocationEpoch() const override;
 
   payload::manager::v1::Tier TierType() const override {
     return payload::manager::v1::TIER_DISK;
   }
 
+  const std::filesystem::path& Root() const {
+    return root_;
+  }
+
+  // Payload and sidecar files moved by the layout migration on construction.
+  uint64_t MigratedFiles() const {
+    return migrated_files_;
+  }
+
+  // Payload bytes reserved against capacity_bytes: everything stored plus
+  // writes in progress, starting from the files found at construction.
+  // Not tracked (0) without a capacity.
+  uint64_t UsedBytes() const {
+    return used_bytes_.load(std::memory_order_relaxed);
+  }
+
+  // Null unless packing is enabled.
+  PackStore* Packs() const {
+    return pack_.get();
+  }
+
+  // True when reads and writes go through io_uring.
+  bool UsesIoUring() const {
+    return io_engine_ != nullptr;
+  }
+
  private:
-  std::filesystem::path root_;
+  std::shared_ptr<arrow::Buffer> ReadMapped(const std::filesystem::path& path);
+  std::shared_ptr<arrow::Buffer> ReadWithEngine(const std::filesystem::path& path);
+  void                           WriteWithEngine(const std::string& tmp_path, const std::shared_ptr<arrow::Buffer>& buffer, bool fsync);
+  std::filesystem::path          DataPath(const payload::manager::v1::PayloadID& id) const;
+  std::filesystem::path          SidecarFile(const payload::manager::v1::PayloadID& id) const;
+  // DataPath / SidecarFile for a file about to be created: makes its fan-out directory.
+  std::filesystem::path          WritableDataPath(const payload::manager::v1::PayloadID& id);
+  std::filesystem::path          WritableSidecarFile(const payload::manager::v1::PayloadID& id);
+  void                           MakeFanoutDir(const std::string& key);
+  void                           MigrateLayout();
+  bool                           Packed(uint64_t size_bytes) const;
+  // Packs a payload, dropping any file of its own.
+  void                           WritePacked(const payload::manager::v1::PayloadID& id, const uint8_t* data, uint64_t length, bool fsync);
+  // Drops a packed copy once the payload has been written to a file of its own.
+  void                           DropPacked(const payload::manager::v1::PayloadID& id);
+  // Bytes id holds against capacity_bytes (packed or in its own file); 0 without a capacity.
+  uint64_t                       AccountedBytes(const payload::manager::v1::PayloadID& id) const;
+  void                           Release(uint64_t bytes);
+  uint64_t                       ScanUsedBytes() const;
+
+  std::filesystem::path                   root_;
+  DiskStoreOptions                        options_;
+  std::unique_ptr<IoUringEngine>          io_engine_;
+  // One flag per leaf directory known to exist.
+  std::unique_ptr<std::atomic<bool>[]>    fanout_made_;
+  uint64_t                                migrated_files_ = 0;
+  std::atomic<uint64_t>                   used_bytes_{0};
+  // Set for SidecarFormat::kManifest.
+  std::unique_ptr<common::ManifestWriter> manifest_;
+  std::unique_ptr<PackStore>              pack_;
 };
 
 } // namespace payload::storage
@@ -0,0 +1,381 @@
+#include "io_uring_engine.hpp"
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <string>
+
+#include "internal/observability/logging.hpp"
+
+namespace payload::storage {
+
+namespace {
+
+constexpr int32_t  kNeedsBuffer   = -2;                // Op::buffer until a bounce buffer is claimed
+constexpr uint32_t kMaxQueueDepth = 4096;              // IORING_MAX_ENTRIES is 32768; more buys nothing here
+constexpr uint64_t kMaxChunkBytes = uint64_t{1} << 30; // sqe->len is 32-bit
+constexpr unsigned kProbeOps      = 256;
+
+uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+int Setup(unsigned entries, io_uring_params* params) {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int Enter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+  return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+int Register(int ring_fd, unsigned opcode, void* arg, unsigned nr_args) {
+  return static_cast<int>(syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args));
+}
+
+unsigned LoadAcquire(unsigned* value) {
+  return std::atomic_ref<unsigned>(*value).load(std::memory_order_acquire);
+}
+
+void StoreRelease(unsigned* value, unsigned next) {
+  std::atomic_ref<unsigned>(*value).store(next, std::memory_order_release);
+}
+
+} // namespace
+
+IoUringEngine::IoUringEngine(const IoUringOptions& options) : options_(options) {
+  options_.queue_depth = std::clamp<uint32_t>(options_.queue_depth, 1, kMaxQueueDepth);
+  options_.chunk_bytes = std::clamp<uint64_t>(AlignUp(options_.chunk_bytes, kDirectAlignment), kDirectAlignment, kMaxChunkBytes);
+  if (options_.direct_io && options_.registered_buffers == 0) {
+    options_.registered_buffers = 1; // padded tails always need one
+  }
+}
+
+std::unique_ptr<IoUringEngine> IoUringEngine::Create(const IoUringOptions& options) {
+  std::unique_ptr<IoUringEngine> engine(new IoUringEngine(options));
+  if (!engine->Init()) {
+    return nullptr;
+  }
+  return engine;
+}
+
+IoUringEngine::~IoUringEngine() {
+  if (buffers_ != nullptr) {
+    munmap(buffers_, buffers_bytes_);
+  }
+  if (sqes_ != nullptr) {
+    munmap(sqes_, sqes_bytes_);
+  }
+  if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+    munmap(cq_ring_, cq_bytes_);
+  }
+  if (sq_ring_ != nullptr) {
+    munmap(sq_ring_, sq_bytes_);
+  }
+  if (ring_fd_ >= 0) {
+    close(ring_fd_);
+  }
+}
+
+/*
+  Set up the ring, map its SQ / CQ / SQE areas, check that the kernel has
+  the opcodes used here (5.6+), and register the bounce buffers. Failing
+  to register buffers (RLIMIT_MEMLOCK on older kernels) only disables
+  O_DIRECT; failing anything else disables the engine.
+*/
+bool IoUringEngine::Init() {
+  auto unavailable = [](const char* step, int error) {
+    PAYLOAD_LOG_WARN("io_uring unavailable; disk tier uses blocking I/O",
+                     {payload::observability::StringField("step", step), payload::observability::StringField("error", std::strerror(error))});
+    return false;
+  };
+
+  io_uring_params params{};
+  ring_fd_ = Setup(options_.queue_depth, &params);
+  if (ring_fd_ < 0) {
+    return unavailable("io_uring_setup", errno);
+  }
+  sq_entries_ = params.sq_entries;
+
+  sq_bytes_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_bytes_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0) {
+    sq_bytes_ = cq_bytes_ = std::max(sq_bytes_, cq_bytes_);
+  }
+  void* sq_ring = mmap(nullptr, sq_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+  if (sq_ring == MAP_FAILED) {
+    return unavailable("mmap sq ring", errno);
+  }
+  sq_ring_ = sq_ring;
+  if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0) {
+    cq_ring_ = sq_ring_;
+  } else {
+    void* cq_ring = mmap(nullptr, cq_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+    if (cq_ring == MAP_FAILED) {
+      return unavailable("mmap cq ring", errno);
+    }
+    cq_ring_ = cq_ring;
+  }
+  sqes_bytes_ = params.sq_entries * sizeof(io_uring_sqe);
+  void* sqes  = mmap(nullptr, sqes_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    return unavailable("mmap sqes", errno);
+  }
+  sqes_ = sqes;
+
+  auto* sq  = static_cast<uint8_t*>(sq_ring_);
+  auto* cq  = static_cast<uint8_t*>(cq_ring_);
+  sq_tail_  = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+  sq_mask_  = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+  cq_head_  = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+  cq_tail_  = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+  cq_mask_  = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+  cqes_     = cq + params.cq_off.cqes;
+
+  std::vector<uint8_t> probe_bytes(sizeof(io_uring_probe) + kProbeOps * sizeof(io_uring_probe_op));
+  auto*                probe = reinterpret_cast<io_uring_probe*>(probe_bytes.data());
+  if (Register(ring_fd_, IORING_REGISTER_PROBE, probe, kProbeOps) != 0) {
+    return unavailable("probe", errno);
+  }
+  for (const int opcode : {IORING_OP_READ, IORING_OP_WRITE, IORING_OP_READ_FIXED, IORING_OP_WRITE_FIXED}) {
+    if (opcode > probe->last_op || (probe->ops[opcode].flags & IO_URING_OP_SUPPORTED) == 0) {
+      return unavailable("probe", EOPNOTSUPP);
+    }
+  }
+
+  if (options_.registered_buffers > 0) {
+    buffers_bytes_ = static_cast<size_t>(options_.registered_buffers * options_.chunk_bytes);
+    void* buffers  = mmap(nullptr, buffers_bytes_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    int   error    = buffers == MAP_FAILED ? errno : 0;
+    if (buffers != MAP_FAILED) {
+      buffers_ = static_cast<uint8_t*>(buffers);
+      std::vector<iovec> iovecs(options_.registered_buffers);
+      for (uint32_t i = 0; i < options_.registered_buffers; ++i) {
+        iovecs[i].iov_base = buffers_ + i * options_.chunk_bytes;
+        iovecs[i].iov_len  = static_cast<size_t>(options_.chunk_bytes);
+        free_buffers_.push_back(static_cast<int32_t>(i));
+      }
+      if (Register(ring_fd_, IORING_REGISTER_BUFFERS, iovecs.data(), options_.registered_buffers) != 0) {
+        error = errno;
+      }
+    }
+    if (error != 0) {
+      PAYLOAD_LOG_WARN("io_uring buffer registration failed; O_DIRECT disabled",
+                       {payload::observability::StringField("error", std::strerror(error))});
+      if (buffers_ != nullptr) {
+        munmap(buffers_, buffers_bytes_);
+        buffers_ = nullptr;
+      }
+      free_buffers_.clear();
+      options_.registered_buffers = 0;
+      options_.direct_io          = false;
+    }
+  }
+  return true;
+}
+
+void IoUringEngine::Write(int fd, const uint8_t* data, uint64_t length, bool direct, uint64_t file_offset) {
+  std::vector<Op> ops;
+  ops.reserve(static_cast<size_t>((length + options_.chunk_bytes - 1) / options_.chunk_bytes));
+  for (uint64_t offset = 0; offset < length; offset += options_.chunk_bytes) {
+    Op op;
+    op.write    = true;
+    op.fd       = fd;
+    op.offset   = file_offset + offset;
+    op.required = std::min(options_.chunk_bytes, length - offset);
+    op.length   = op.required;
+    op.addr     = const_cast<uint8_t*>(data + offset); // only read by IORING_OP_WRITE
+    if (direct) {
+      op.length = AlignUp(op.required, kDirectAlignment);
+      if (op.length != op.required || reinterpret_cast<uintptr_t>(op.addr) % kDirectAlignment != 0) {
+        op.buffer = kNeedsBuffer;
+      }
+    }
+    ops.push_back(op);
+  }
+  Run(ops);
+}
+
+void IoUringEngine::Read(int fd, uint8_t* data, uint64_t length, bool direct, uint64_t file_offset) {
+  std::vector<Op> ops;
+  ops.reserve(static_cast<size_t>((length + options_.chunk_bytes - 1) / options_.chunk_bytes));
+  for (uint64_t offset = 0; offset < length; offset += options_.chunk_bytes) {
+    Op op;
+    op.fd       = fd;
+    op.offset   = file_offset + offset;
+    op.required = std::min(options_.chunk_bytes, length - offset);
+    op.length   = direct ? AlignUp(op.required, kDirectAlignment) : op.required;
+    op.addr     = data + offset;
+    ops.push_back(op);
+  }
+  Run(ops);
+}
+
+/*
+  Submit ops and wait for all of them.
+
+  Each pass claims ring slots (and bounce buffers) for as many remaining
+  ops as fit, stages bounce copies outside the lock, pushes the SQEs, then
+  either enters the kernel to submit and reap, or — when another caller is
+  already in the kernel — waits for it to hand over completions. A caller
+  only enters the kernel while some pushed I/O is outstanding, so the wait
+  for one completion always ends.
+*/
+void IoUringEngine::Run(std::vector<Op>& ops) {
+  Batch batch;
+  for (auto& op : ops) {
+    op.batch = &batch;
+  }
+
+  std::unique_lock lock(mutex_);
+  std::size_t      next = 0;
+  while (next < ops.size() || batch.pending > 0) {
+    const std::size_t first = next;
+    while (next < ops.size() && in_flight_ < sq_entries_) {
+      Op& op = ops[next];
+      if (op.buffer == kNeedsBuffer) {
+        if (free_buffers_.empty()) {
+          break;
+        }
+        op.buffer = free_buffers_.back();
+        free_buffers_.pop_back();
+      }
+      ++in_flight_;
+      ++batch.pending;
+      ++next;
+    }
+
+    if (next > first) {
+      const bool staged = std::any_of(ops.begin() + first, ops.begin() + next, [](const Op& op) { return op.buffer >= 0; });
+      if (staged) {
+        staging_ += static_cast<unsigned>(next - first);
+        lock.unlock();
+        for (std::size_t i = first; i < next; ++i) {
+          Op& op = ops[i];
+          if (op.buffer < 0) {
+            continue;
+          }
+          uint8_t* bounce = buffers_ + op.buffer * options_.chunk_bytes;
+          std::memcpy(bounce, op.addr, static_cast<size_t>(op.required));
+          std::memset(bounce + op.required, 0, static_cast<size_t>(op.length - op.required));
+          op.addr = bounce;
+        }
+        lock.lock();
+        staging_ -= static_cast<unsigned>(next - first);
+      }
+      for (std::size_t i = first; i < next; ++i) {
+        PushLocked(ops[i]);
+      }
+      if (staged) {
+        cv_.notify_all();
+      }
+    }
+
+    // Waiting in the kernel needs a pushed I/O to complete; when every
+    // slot belongs to another caller's staging, wait for its push instead.
+    if (reaping_ || in_flight_ == staging_) {
+      cv_.wait(lock);
+      continue;
+    }
+    reaping_                 = true;
+    const unsigned to_submit = unsubmitted_;
+    lock.unlock();
+    const int result = Enter(ring_fd_, to_submit, 1, IORING_ENTER_GETEVENTS);
+    const int error  = result < 0 ? errno : 0;
+    lock.lock();
+    reaping_ = false;
+    if (result > 0) {
+      unsubmitted_ -= static_cast<unsigned>(result);
+    }
+    if (result < 0 && error != EINTR && error != EAGAIN && error != EBUSY) {
+      // Only reachable through a bug here (bad fd, bad ring state); SQEs
+      // still point at callers' stacks, so there is no safe way to unwind.
+      PAYLOAD_LOG_ERROR("io_uring_enter failed", {payload::observability::StringField("error", std::strerror(error))});
+      std::terminate();
+    }
+    ReapLocked();
+    cv_.notify_all();
+  }
+  lock.unlock();
+
+  if (batch.error != 0) {
+    const bool write = !ops.empty() && ops.front().write;
+    throw std::runtime_error(std::string("io_uring ") + (write ? "write" : "read") + " failed: " + std::strerror(batch.error));
+  }
+}
+
+void IoUringEngine::PushLocked(Op& op) {
+  // Only this engine writes the SQ tail, always under mutex_; in_flight_
+  // never exceeds sq_entries_, so the slot is free.
+  const unsigned tail  = *sq_tail_;
+  const unsigned index = tail & *sq_mask_;
+  auto*          sqe   = static_cast<io_uring_sqe*>(sqes_) + index;
+  std::memset(sqe, 0, sizeof(*sqe));
+
+  const bool fixed = op.buffer >= 0;
+  if (op.write) {
+    sqe->opcode = fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+  } else {
+    sqe->opcode = fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+  }
+  sqe->fd        = op.fd;
+  sqe->addr      = reinterpret_cast<uint64_t>(op.addr);
+  sqe->len       = static_cast<uint32_t>(op.length);
+  sqe->off       = op.offset;
+  sqe->user_data = reinterpret_cast<uint64_t>(&op);
+  if (fixed) {
+    sqe->buf_index = static_cast<uint16_t>(op.buffer);
+  }
+  sq_array_[index] = index;
+  StoreRelease(sq_tail_, tail + 1);
+  ++unsubmitted_;
+}
+
+void IoUringEngine::ReapLocked() {
+  unsigned       head = *cq_head_;
+  const unsigned tail = LoadAcquire(cq_tail_);
+  while (head != tail) {
+    const auto& cqe = static_cast<io_uring_cqe*>(cqes_)[head & *cq_mask_];
+    auto*       op  = reinterpret_cast<Op*>(cqe.user_data);
+    const int   res = cqe.res;
+    ++head;
+    CompleteLocked(*op, res);
+  }
+  StoreRelease(cq_head_, head);
+}
+
+void IoUringEngine::CompleteLocked(Op& op, int result) {
+  if (result == -EINTR || result == -EAGAIN) {
+    PushLocked(op);
+    return;
+  }
+  if (result > 0 && static_cast<uint64_t>(result) < op.required) {
+    // Short transfer: resubmit the rest.
+    op.addr += result;
+    op.offset += static_cast<uint64_t>(result);
+    op.length -= static_cast<uint64_t>(result);
+    op.required -= static_cast<uint64_t>(result);
+    PushLocked(op);
+    return;
+  }
+  if (result <= 0 && op.batch->error == 0) {
+    op.batch->error = result < 0 ? -result : EIO; // 0: file ended early
+  }
+  if (op.buffer >= 0) {
+    free_buffers_.push_back(op.buffer);
+    op.buffer = -1;
+  }
+  --in_flight_;
+  --op.batch->pending;
+}
+
+} // namespace payload::storage
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace payload::storage {
+
+struct IoUringOptions {
+  bool enabled = false;
+  // Submission queue entries; also the cap on I/Os in flight across all callers.
+  uint32_t queue_depth = 64;
+  // Transfers are split into chunks of this size, each its own I/O.
+  // Rounded up to a multiple of kDirectAlignment.
+  uint64_t chunk_bytes = uint64_t{1} << 20;
+  // chunk_bytes bounce buffers registered with the ring. O_DIRECT writes
+  // stage unaligned source data and the padded tail through them.
+  uint32_t registered_buffers = 16;
+  // Open payload files with O_DIRECT for transfers of at least
+  // direct_io_min_bytes, bypassing the page cache.
+  bool     direct_io           = false;
+  uint64_t direct_io_min_bytes = uint64_t{4} << 20;
+};
+
+/*
+  io_uring I/O engine for the disk tier.
+
+  One ring is shared by every thread using a DiskArrowStore. Read and
+  Write split a transfer into chunk_bytes I/Os and keep up to queue_depth
+  of them in flight across all callers, so concurrent spill workers fill
+  the device queue instead of each waiting on one blocking syscall.
+  Callers block until their own I/Os complete; whichever waiter is in the
+  kernel reaps completions for everyone.
+
+  Talks to the kernel through the raw io_uring syscalls (no liburing).
+  Create returns null when the kernel or a seccomp policy refuses
+  io_uring, and the store keeps its blocking Arrow path.
+
+  Thread safety:
+    - Read / Write may be called concurrently
+*/
+class IoUringEngine {
+ public:
+  static constexpr uint64_t kDirectAlignment = 4096;
+
+  static std::unique_ptr<IoUringEngine> Create(const IoUringOptions& options);
+  ~IoUringEngine();
+
+  IoUringEngine(const IoUringEngine&)            = delete;
+  IoUringEngine& operator=(const IoUringEngine&) = delete;
+
+  // Writes data[0, length) at file_offset. With direct, fd is O_DIRECT,
+  // file_offset is aligned, and the file is written in whole alignment
+  // blocks; the caller truncates it afterwards.
+  void Write(int fd, const uint8_t* data, uint64_t length, bool direct, uint64_t file_offset = 0);
+
+  // Reads file bytes [file_offset, file_offset + length) into data. With
+  // direct, fd is O_DIRECT, file_offset and data are kDirectAlignment-
+  // aligned, and data has room for length rounded up to kDirectAlignment.
+  // Throws when the file is shorter.
+  void Read(int fd, uint8_t* data, uint64_t length, bool direct, uint64_t file_offset = 0);
+
+  // Whether a transfer of length bytes should use O_DIRECT.
+  bool UseDirect(uint64_t length) const {
+    return options_.direct_io && length >= options_.direct_io_min_bytes;
+  }
+
+  const IoUringOptions& Options() const {
+    return options_;
+  }
+
+ private:
+  struct Batch;
+
+  // One chunk; requeued with its pointers advanced after a short transfer.
+  struct Op {
+    Batch*   batch     = nullptr;
+    bool     write     = false;
+    int      fd        = -1;
+    uint8_t* addr      = nullptr;
+    uint64_t length    = 0; // bytes submitted
+    uint64_t required  = 0; // bytes that must transfer (< length for a padded direct read)
+    uint64_t offset    = 0;
+    int32_t  buffer    = -1; // registered bounce buffer, or -1
+  };
+
+  struct Batch {
+    std::size_t pending = 0;
+    int         error   = 0; // first errno seen
+  };
+
+  explicit IoUringEngine(const IoUringOptions& options);
+
+  bool Init();
+  void Run(std::vector<Op>& ops);
+  void PushLocked(Op& op);
+  void ReapLocked();
+  void CompleteLocked(Op& op, int result);
+
+  IoUringOptions options_;
+
+  int      ring_fd_    = -1;
+  void*    sq_ring_    = nullptr;
+  void*    cq_ring_    = nullptr;
+  void*    sqes_       = nullptr;
+  size_t   sq_bytes_   = 0;
+  size_t   cq_bytes_   = 0;
+  size_t   sqes_bytes_ = 0;
+  unsigned sq_entries_ = 0;
+
+  // Pointers into the mapped rings.
+  unsigned* sq_tail_  = nullptr;
+  unsigned* sq_mask_  = nullptr;
+  unsigned* sq_array_ = nullptr;
+  unsigned* cq_head_  = nullptr;
+  unsigned* cq_tail_  = nullptr;
+  unsigned* cq_mask_  = nullptr;
+  void*     cqes_     = nullptr;
+
+  uint8_t*             buffers_       = nullptr; // registered_buffers x chunk_bytes
+  size_t               buffers_bytes_ = 0;
+  std::vector<int32_t> free_buffers_;
+
+  std::mutex              mutex_;
+  std::condition_variable cv_;
+  unsigned                in_flight_   = 0; // pushed, not yet completed
+  unsigned                unsubmitted_ = 0; // pushed, not yet passed to io_uring_enter
+  unsigned                staging_     = 0; // slot claimed, bounce copy in progress
+  bool                    reaping_     = false;
+};
+
+} // namespace payload::storage
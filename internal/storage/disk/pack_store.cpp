@@ -0,0 +1,609 @@
+#include "pack_store.hpp"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "internal/observability/logging.hpp"
+#include "internal/storage/checksum.hpp"
+
+namespace payload::storage {
+
+namespace {
+
+constexpr uint32_t kRecordMagic = 0x31524b50; // "PKR1"
+constexpr uint8_t  kPut         = 1;
+constexpr uint8_t  kTombstone   = 2;
+constexpr char     kSuffix[]    = ".pack";
+
+struct RecordHeader {
+  uint32_t magic;
+  uint32_t crc; // CRC32C of the rest of the header, the key and the data
+  uint64_t length;
+  uint16_t key_length;
+  uint8_t  kind;
+  uint8_t  reserved[5];
+};
+static_assert(sizeof(RecordHeader) == 24, "pack record header layout");
+
+// Bytes after the crc field that it covers.
+constexpr size_t kCrcSkip = offsetof(RecordHeader, length);
+
+uint64_t RecordBytes(size_t key_length, uint64_t length) {
+  return sizeof(RecordHeader) + key_length + length;
+}
+
+// Log order of two records' data offsets, which is also replay order.
+bool Before(const PackStore::Location& a, const PackStore::Location& b) {
+  return a.segment < b.segment || (a.segment == b.segment && a.offset < b.offset);
+}
+
+void PreadFully(int fd, uint8_t* out, uint64_t length, uint64_t offset, const std::string& path) {
+  for (uint64_t done = 0; done < length;) {
+    const ssize_t n = pread(fd, out + done, static_cast<size_t>(length - done), static_cast<off_t>(offset + done));
+    if (n < 0 && errno == EINTR) continue;
+    if (n < 0) throw std::runtime_error("pack read: pread failed for " + path + ": " + std::strerror(errno));
+    if (n == 0) throw std::runtime_error("pack read: " + path + " ended before offset " + std::to_string(offset + length));
+    done += static_cast<uint64_t>(n);
+  }
+}
+
+void PwriteFully(int fd, const uint8_t* data, uint64_t length, uint64_t offset, const std::string& path) {
+  for (uint64_t done = 0; done < length;) {
+    const ssize_t n = pwrite(fd, data + done, static_cast<size_t>(length - done), static_cast<off_t>(offset + done));
+    if (n < 0 && errno == EINTR) continue;
+    if (n < 0) throw std::runtime_error("pack write: pwrite failed for " + path + ": " + std::strerror(errno));
+    done += static_cast<uint64_t>(n);
+  }
+}
+
+// head, then data, at offset; a short pwritev is finished piecewise.
+void WriteRecord(int fd, const std::string& head, const uint8_t* data, uint64_t length, uint64_t offset, const std::string& path) {
+  iovec iov[2] = {{const_cast<char*>(head.data()), head.size()}, {const_cast<uint8_t*>(data), static_cast<size_t>(length)}};
+  ssize_t n;
+  do {
+    n = pwritev(fd, iov, length > 0 ? 2 : 1, static_cast<off_t>(offset));
+  } while (n < 0 && errno == EINTR);
+  if (n < 0) throw std::runtime_error("pack write: pwritev failed for " + path + ": " + std::strerror(errno));
+
+  const auto written = static_cast<uint64_t>(n);
+  if (written < head.size()) {
+    PwriteFully(fd, reinterpret_cast<const uint8_t*>(head.data()) + written, head.size() - written, offset + written, path);
+  }
+  const auto data_written = written > head.size() ? written - head.size() : 0;
+  PwriteFully(fd, data + data_written, length - data_written, offset + head.size() + data_written, path);
+}
+
+/*
+  One record read back from a segment: header, key and data, checked
+  against the header's CRC. Anything else is a hole or a torn tail.
+*/
+struct Record {
+  uint8_t              kind = 0;
+  std::string          key;
+  std::vector<uint8_t> data;
+  uint64_t             start       = 0;
+  uint64_t             data_offset = 0;
+  uint64_t             end         = 0;
+};
+
+bool ReadRecord(int fd, uint64_t offset, uint64_t file_size, const std::string& path, Record* record) {
+  RecordHeader header{};
+  if (offset + sizeof(header) > file_size) return false;
+  PreadFully(fd, reinterpret_cast<uint8_t*>(&header), sizeof(header), offset, path);
+  if (header.magic != kRecordMagic || (header.kind != kPut && header.kind != kTombstone)) return false;
+  if (header.length > file_size || offset + RecordBytes(header.key_length, header.length) > file_size) return false;
+
+  std::vector<uint8_t> body(header.key_length + header.length);
+  PreadFully(fd, body.data(), body.size(), offset + sizeof(header), path);
+  Crc32c crc;
+  crc.Update(reinterpret_cast<const uint8_t*>(&header) + kCrcSkip, sizeof(header) - kCrcSkip);
+  crc.Update(body.data(), body.size());
+  if (crc.Value() != header.crc) return false;
+
+  record->kind = header.kind;
+  record->key.assign(reinterpret_cast<const char*>(body.data()), header.key_length);
+  record->data.assign(body.begin() + header.key_length, body.end());
+  record->start       = offset;
+  record->data_offset = offset + sizeof(header) + header.key_length;
+  record->end         = offset + RecordBytes(header.key_length, header.length);
+  return true;
+}
+
+/*
+  The record at offset, or else the first one after it that reads back
+  whole: a hole left by a write that failed or was cut short (writes land
+  out of order) is skipped by scanning for the next record magic whose
+  CRC checks out. False when nothing valid follows.
+*/
+bool NextRecord(int fd, uint64_t offset, uint64_t file_size, const std::string& path, Record* record) {
+  if (ReadRecord(fd, offset, file_size, path, record)) return true;
+
+  constexpr uint64_t   kWindow = uint64_t{1} << 20;
+  std::vector<uint8_t> window;
+  for (uint64_t base = offset + 1; base + sizeof(RecordHeader) <= file_size; base += kWindow) {
+    // Windows overlap by a partial magic, so one split across them is still seen.
+    const auto length = std::min<uint64_t>(kWindow + sizeof(kRecordMagic) - 1, file_size - base);
+    window.resize(length);
+    PreadFully(fd, window.data(), length, base, path);
+    for (uint64_t i = 0; i < kWindow && i + sizeof(kRecordMagic) <= length; ++i) {
+      if (std::memcmp(window.data() + i, &kRecordMagic, sizeof(kRecordMagic)) == 0 && ReadRecord(fd, base + i, file_size, path, record)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void WarnSkipped(const std::string& path, uint64_t offset, uint64_t bytes, const char* message) {
+  PAYLOAD_LOG_WARN(message, {payload::observability::StringField("path", path),
+                             payload::observability::IntField("offset", static_cast<int64_t>(offset)),
+                             payload::observability::IntField("bytes", static_cast<int64_t>(bytes))});
+}
+
+} // namespace
+
+struct PackStore::Segment {
+  uint64_t    id = 0;
+  std::string path;
+  int         fd = -1;
+  // Bytes of records reserved (or recovered); appends go here.
+  uint64_t size = 0;
+  // Reserved records still being written; compaction waits for none.
+  uint32_t writers = 0;
+  // Bytes of the records the index points at.
+  uint64_t live_bytes = 0;
+
+  ~Segment() {
+    if (fd >= 0) close(fd);
+  }
+};
+
+PackStore::PackStore(std::filesystem::path dir, PackOptions options) : dir_(std::move(dir)), options_(options) {
+  std::filesystem::create_directories(dir_);
+  Recover();
+  if (options_.compaction_interval.count() > 0) {
+    compactor_ = std::thread([this] { CompactionLoop(); });
+  }
+}
+
+PackStore::~PackStore() {
+  {
+    std::lock_guard lock(mutex_);
+    stopping_ = true;
+  }
+  cv_.notify_all();
+  if (compactor_.joinable()) compactor_.join();
+  UnlinkRetired(/*all=*/true);
+}
+
+std::string PackStore::SegmentName(uint64_t segment) {
+  char name[32];
+  std::snprintf(name, sizeof(name), "%016llx%s", static_cast<unsigned long long>(segment), kSuffix);
+  return name;
+}
+
+/*
+  Replays every segment in id order. Segments found on disk are sealed:
+  holes and a torn tail stay unreadable garbage (compaction reclaims it)
+  and appends go to a fresh segment.
+*/
+void PackStore::Recover() {
+  std::map<uint64_t, std::filesystem::path> found;
+  for (const auto& entry : std::filesystem::directory_iterator(dir_)) {
+    const auto name = entry.path().filename().string();
+    if (!entry.is_regular_file() || name.size() != 16 + sizeof(kSuffix) - 1 || !name.ends_with(kSuffix)) continue;
+    try {
+      found.emplace(std::stoull(name.substr(0, 16), nullptr, 16), entry.path());
+    } catch (const std::exception&) {
+      continue;
+    }
+  }
+
+  for (const auto& [id, path] : found) {
+    auto segment  = std::make_shared<Segment>();
+    segment->id   = id;
+    segment->path = path.string();
+    segment->fd   = open(segment->path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (segment->fd < 0) {
+      throw std::runtime_error("pack store: open failed for " + segment->path + ": " + std::strerror(errno));
+    }
+    segment->size = std::filesystem::file_size(path);
+    segments_[id] = segment;
+    next_segment_ = id + 1;
+
+    Record   record;
+    uint64_t offset = 0;
+    while (offset < segment->size && NextRecord(segment->fd, offset, segment->size, segment->path, &record)) {
+      if (record.start != offset) {
+        WarnSkipped(segment->path, offset, record.start - offset, "pack store: skipping damaged records in segment");
+      }
+      if (record.kind == kPut) {
+        const Location location{id, record.data_offset, record.data.size()};
+        auto&          entry = index_[record.key];
+        if (entry.live) Drop(record.key, entry.location);
+        entry.location = location;
+        entry.live     = true;
+        Count(record.key, location);
+        keys_at_[{id, record.data_offset}] = record.key;
+      } else if (const auto it = index_.find(record.key); it != index_.end()) {
+        Drop(record.key, it->second.location);
+        index_.erase(it);
+      }
+      offset = record.end;
+    }
+    if (offset < segment->size) {
+      WarnSkipped(segment->path, offset, segment->size - offset, "pack store: ignoring damaged tail of segment");
+    }
+  }
+}
+
+/*
+  The file is created with the lock dropped, so hits and other writers do
+  not wait on it. Should another writer install a segment meanwhile, this
+  one stays empty and the next compaction pass retires it.
+*/
+PackStore::SegmentPtr PackStore::ActiveSegment(std::unique_lock<std::shared_mutex>& lock) {
+  while (!active_) {
+    auto segment  = std::make_shared<Segment>();
+    segment->id   = next_segment_++;
+    segment->path = (dir_ / SegmentName(segment->id)).string();
+    lock.unlock();
+    segment->fd      = open(segment->path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    const auto error = errno;
+    lock.lock();
+    if (segment->fd < 0) {
+      throw std::runtime_error("pack store: open failed for " + segment->path + ": " + std::strerror(error));
+    }
+    segments_[segment->id] = segment;
+    if (!active_) active_ = segment;
+  }
+  return active_;
+}
+
+PackStore::Reservation PackStore::Reserve(const SegmentPtr& segment, const std::string& key, uint64_t length) {
+  const Reservation reservation{segment, segment->size};
+  segment->size += RecordBytes(key.size(), length);
+  ++segment->writers;
+  if (segment->size >= options_.segment_bytes) active_.reset();
+  return reservation;
+}
+
+/*
+  Header and key are written together with the caller's data in one
+  pwritev, so the data is not staged. A failed write leaves a hole that
+  replay and compaction skip.
+*/
+PackStore::Location PackStore::WriteReserved(const Reservation& reservation, uint8_t kind, const std::string& key, const uint8_t* data,
+                                             uint64_t length) {
+  RecordHeader header{};
+  header.magic      = kRecordMagic;
+  header.length     = length;
+  header.key_length = static_cast<uint16_t>(key.size());
+  header.kind       = kind;
+
+  Crc32c crc;
+  crc.Update(reinterpret_cast<const uint8_t*>(&header) + kCrcSkip, sizeof(header) - kCrcSkip);
+  crc.Update(reinterpret_cast<const uint8_t*>(key.data()), key.size());
+  crc.Update(data, length);
+  header.crc = crc.Value();
+
+  std::string head(reinterpret_cast<const char*>(&header), sizeof(header));
+  head += key;
+  WriteRecord(reservation.segment->fd, head, data, length, reservation.offset, reservation.segment->path);
+  return Location{reservation.segment->id, reservation.offset + head.size(), length};
+}
+
+void PackStore::PublishPut(Entry& entry, const std::string& key, const Location& location) {
+  if (!Before(entry.location, location)) return; // the later record stands; this one is dead
+  if (entry.live) Drop(key, entry.location);
+  entry.location = location;
+  entry.live     = true;
+  Count(key, location);
+  keys_at_[{location.segment, location.offset}] = key;
+}
+
+void PackStore::Finish(const std::string& key, const SegmentPtr& segment) {
+  --segment->writers;
+  const auto it = index_.find(key);
+  if (it != index_.end() && --it->second.pending == 0 && !it->second.live) index_.erase(it);
+}
+
+void PackStore::Count(const std::string& key, const Location& location) {
+  segments_.at(location.segment)->live_bytes += RecordBytes(key.size(), location.length);
+  payload_bytes_ += location.length;
+  ++live_records_;
+}
+
+void PackStore::Drop(const std::string& key, const Location& location) {
+  if (const auto it = segments_.find(location.segment); it != segments_.end()) {
+    it->second->live_bytes -= RecordBytes(key.size(), location.length);
+  }
+  payload_bytes_ -= location.length;
+  --live_records_;
+}
+
+PackStore::Location PackStore::Put(const std::string& key, const uint8_t* data, uint64_t length, bool fsync) {
+  if (key.size() > UINT16_MAX) {
+    throw std::invalid_argument("pack store: key too long");
+  }
+  Reservation reservation;
+  {
+    std::unique_lock lock(mutex_);
+    reservation = Reserve(ActiveSegment(lock), key, length);
+    ++index_[key].pending;
+  }
+
+  Location location;
+  try {
+    location = WriteReserved(reservation, kPut, key, data, length);
+  } catch (...) {
+    std::lock_guard lock(mutex_);
+    Finish(key, reservation.segment);
+    throw;
+  }
+  {
+    std::lock_guard lock(mutex_);
+    PublishPut(index_.at(key), key, location);
+    Finish(key, reservation.segment);
+  }
+  if (fsync && fdatasync(reservation.segment->fd) != 0) {
+    throw std::runtime_error("pack write: fdatasync failed for " + reservation.segment->path + ": " + std::strerror(errno));
+  }
+  return location;
+}
+
+std::optional<PackStore::Location> PackStore::Find(const std::string& key) const {
+  std::shared_lock lock(mutex_);
+  const auto       it = index_.find(key);
+  if (it == index_.end() || !it->second.live) return std::nullopt;
+  return it->second.location;
+}
+
+std::vector<std::string> PackStore::Keys() const {
+  std::shared_lock         lock(mutex_);
+  std::vector<std::string> keys;
+  keys.reserve(live_records_);
+  for (const auto& [key, entry] : index_) {
+    if (entry.live) keys.push_back(key);
+  }
+  return keys;
+}
+
+/*
+  The segment is pinned while it is read, so compaction may retire and
+  unlink it meanwhile without invalidating the descriptor.
+*/
+std::shared_ptr<arrow::Buffer> PackStore::Read(const std::string& key) const {
+  SegmentPtr segment;
+  Location   location;
+  {
+    std::shared_lock lock(mutex_);
+    const auto       it = index_.find(key);
+    if (it == index_.end() || !it->second.live) return nullptr;
+    location = it->second.location;
+    segment  = segments_.at(location.segment);
+  }
+
+  auto allocated = arrow::AllocateBuffer(static_cast<int64_t>(location.length));
+  if (!allocated.ok()) {
+    throw std::runtime_error(allocated.status().ToString());
+  }
+  std::shared_ptr<arrow::Buffer> buffer = std::move(*allocated);
+  PreadFully(segment->fd, buffer->mutable_data(), location.length, location.offset, segment->path);
+  return buffer;
+}
+
+/*
+  The key stays readable until its tombstone is on disk; a put placed
+  after the tombstone (but finished first) keeps it alive.
+*/
+bool PackStore::Remove(const std::string& key) {
+  Reservation reservation;
+  {
+    std::unique_lock lock(mutex_);
+    const auto       live = [&] {
+      const auto it = index_.find(key);
+      return it != index_.end() && it->second.live;
+    };
+    if (!live()) return false;
+    const auto segment = ActiveSegment(lock);
+    if (!live()) return false; // removed while a segment was opened
+    reservation = Reserve(segment, key, 0);
+    ++index_.at(key).pending;
+  }
+
+  Location tombstone;
+  try {
+    tombstone = WriteReserved(reservation, kTombstone, key, nullptr, 0);
+  } catch (...) {
+    std::lock_guard lock(mutex_);
+    Finish(key, reservation.segment);
+    throw;
+  }
+  std::lock_guard lock(mutex_);
+  auto&           entry = index_.at(key);
+  if (Before(entry.location, tombstone)) {
+    if (entry.live) Drop(key, entry.location);
+    entry.location = tombstone;
+    entry.live     = false;
+  }
+  Finish(key, reservation.segment);
+  return true;
+}
+
+std::optional<std::string> PackStore::KeyAt(uint64_t segment, uint64_t offset) const {
+  std::shared_lock lock(mutex_);
+  const auto       it = keys_at_.find({segment, offset});
+  if (it == keys_at_.end()) return std::nullopt;
+  return it->second;
+}
+
+uint64_t PackStore::Compact() {
+  std::lock_guard<std::mutex> compact_lock(compact_mutex_);
+  UnlinkRetired(/*all=*/false);
+
+  std::vector<SegmentPtr> candidates;
+  {
+    std::lock_guard lock(mutex_);
+    for (const auto& [id, segment] : segments_) {
+      // Sealed segments only, once every write reserved in them has landed.
+      if (segment == active_ || retired_.count(id) || segment->writers > 0) continue;
+      if (segment->size == 0) {
+        retired_[id] = std::chrono::steady_clock::now(); // opened by a writer that lost the race
+        continue;
+      }
+      const auto dead = segment->size - segment->live_bytes;
+      if (dead > 0 && static_cast<double>(dead) >= options_.compact_garbage_ratio * static_cast<double>(segment->size)) {
+        candidates.push_back(segment);
+      }
+    }
+  }
+  for (const auto& segment : candidates) CompactSegment(segment);
+  return candidates.size();
+}
+
+/*
+  Records are read outside the lock (a sealed segment with no writes in
+  flight never changes). Each one is re-checked and its copy reserved
+  under the lock, written outside it, and published only if the index
+  still points at the original, so a Put or Remove racing the copy wins
+  and the copy is left dead. Keys with writes in flight are not copied:
+  the copy would land after them in the log and replay would resurrect
+  the older bytes. A tombstone is carried forward only while an older
+  segment might still hold a put it cancels. The copies are flushed
+  before the segment is retired.
+*/
+void PackStore::CompactSegment(const SegmentPtr& segment) {
+  std::map<uint64_t, SegmentPtr> written;
+  uint64_t                       moved  = 0;
+  Record                         record;
+  uint64_t                       offset = 0;
+  const auto                     movable = [&] {
+    const auto it = index_.find(record.key);
+    if (record.kind != kPut) return it == index_.end() && segments_.begin()->first < segment->id;
+    return it != index_.end() && it->second.live && it->second.pending == 0 && it->second.location.segment == segment->id &&
+           it->second.location.offset == record.data_offset;
+  };
+  while (offset < segment->size && NextRecord(segment->fd, offset, segment->size, segment->path, &record)) {
+    if (record.start != offset) {
+      WarnSkipped(segment->path, offset, record.start - offset, "pack compaction: skipping damaged records in segment");
+    }
+    offset = record.end;
+
+    std::unique_lock lock(mutex_);
+    if (!movable()) continue;
+    const auto target = ActiveSegment(lock);
+    if (!movable()) continue; // changed while a segment was opened
+    const auto reservation = Reserve(target, record.key, record.data.size());
+    lock.unlock();
+
+    Location copy;
+    try {
+      copy = WriteReserved(reservation, record.kind, record.key, record.data.data(), record.data.size());
+    } catch (...) {
+      lock.lock();
+      --target->writers;
+      throw;
+    }
+    lock.lock();
+    --target->writers;
+    written.emplace(copy.segment, target);
+    if (record.kind != kPut) continue;
+
+    const auto it = index_.find(record.key);
+    if (it == index_.end() || !it->second.live || it->second.location.segment != segment->id || it->second.location.offset != record.data_offset) {
+      continue; // replaced or removed while it was copied
+    }
+    Drop(record.key, it->second.location);
+    it->second.location = copy;
+    Count(record.key, copy);
+    keys_at_[{copy.segment, copy.offset}] = record.key;
+    ++moved;
+  }
+  if (offset < segment->size) {
+    WarnSkipped(segment->path, offset, segment->size - offset, "pack compaction: ignoring damaged tail of segment");
+  }
+
+  for (const auto& [id, target] : written) {
+    if (fdatasync(target->fd) != 0) {
+      throw std::runtime_error("pack compaction: fdatasync failed for " + target->path + ": " + std::strerror(errno));
+    }
+  }
+
+  {
+    std::lock_guard lock(mutex_);
+    retired_[segment->id] = std::chrono::steady_clock::now();
+    ++compacted_segments_;
+  }
+  if (moved > 0) relocations_.fetch_add(1, std::memory_order_release);
+  PAYLOAD_LOG_INFO("pack store: compacted segment", {payload::observability::StringField("path", segment->path),
+                                                     payload::observability::IntField("moved_records", static_cast<int64_t>(moved)),
+                                                     payload::observability::IntField("segment_bytes", static_cast<int64_t>(segment->size))});
+}
+
+void PackStore::UnlinkRetired(bool all) {
+  std::vector<SegmentPtr> unlinked;
+  {
+    std::lock_guard lock(mutex_);
+    const auto      now = std::chrono::steady_clock::now();
+    for (auto it = retired_.begin(); it != retired_.end();) {
+      if (!all && now - it->second < options_.retire_grace) {
+        ++it;
+        continue;
+      }
+      const auto id = it->first;
+      unlinked.push_back(segments_.at(id));
+      segments_.erase(id);
+      keys_at_.erase(keys_at_.lower_bound({id, 0}), keys_at_.lower_bound({id + 1, 0}));
+      it = retired_.erase(it);
+    }
+  }
+  // Readers still holding a segment keep its descriptor open past the unlink.
+  for (const auto& segment : unlinked) {
+    std::error_code ec;
+    std::filesystem::remove(segment->path, ec);
+  }
+}
+
+void PackStore::CompactionLoop() {
+  std::unique_lock lock(mutex_);
+  while (!stopping_) {
+    cv_.wait_for(lock, options_.compaction_interval, [this] { return stopping_; });
+    if (stopping_) break;
+    lock.unlock();
+    try {
+      Compact();
+    } catch (const std::exception& e) {
+      PAYLOAD_LOG_WARN("pack store: compaction failed", {payload::observability::StringField("path", dir_.string()),
+                                                         payload::observability::StringField("error", e.what())});
+    }
+    lock.lock();
+  }
+}
+
+PackStore::Stats PackStore::GetStats() const {
+  std::shared_lock lock(mutex_);
+  Stats            stats;
+  stats.segments           = segments_.size();
+  stats.live_records       = live_records_;
+  stats.payload_bytes      = payload_bytes_;
+  stats.compacted_segments = compacted_segments_;
+  for (const auto& [id, segment] : segments_) {
+    if (retired_.count(id)) continue;
+    stats.live_bytes += segment->live_bytes;
+    stats.dead_bytes += segment->size - segment->live_bytes;
+  }
+  return stats;
+}
+
+} // namespace payload::storage
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <arrow/buffer.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace payload::storage {
+
+struct PackOptions {
+  bool enabled = false;
+  // Payloads up to this size are packed; larger ones keep a file of their own.
+  uint64_t max_payload_bytes = uint64_t{64} << 10;
+  // The active segment is sealed once it grows past this size.
+  uint64_t segment_bytes = uint64_t{256} << 20;
+  // A sealed segment is compacted once this fraction of it is dead records.
+  double compact_garbage_ratio = 0.5;
+  // How often the background thread looks for segments to compact.
+  std::chrono::milliseconds compaction_interval{30000};
+  // A compacted segment stays readable this long before it is unlinked, so
+  // descriptors handed out before the move still resolve.
+  std::chrono::milliseconds retire_grace{60000};
+};
+
+/*
+  Log-structured store for small payloads: appends them to large segment
+  files under <dir>/<segment>.pack instead of creating a file per payload.
+
+  Each record is a fixed header, the key (payload UUID string) and the
+  data; a removal appends a tombstone. The in-memory index maps a key to
+  its latest record's (segment, offset, length), where offset is the
+  first data byte, so a segment file can be mapped or read at it directly.
+  The index is rebuilt on construction by replaying segments in order,
+  and appends always start a new segment. A record that fails its CRC32C
+  is a hole (a write that failed or was cut short): replay scans past it
+  for the next record that checks out.
+
+  A write reserves its record's bytes at the end of the active segment
+  under the lock, then computes the CRC and writes outside it, and
+  publishes to the index last. Records of one key are ordered by where
+  they sit in the log (segment, offset), which is also replay order: a
+  write that finishes after a later-placed one for the same key leaves
+  the index alone. Find, Read and KeyAt take the lock shared.
+
+  Compaction copies the live records of a sealed segment whose dead
+  fraction reached compact_garbage_ratio into the active segment and
+  retires it; retired segments are unlinked after retire_grace. It runs
+  on a background thread every compaction_interval, or on Compact(), and
+  waits out writes still landing in a segment. Relocations() counts the
+  passes that moved records, for callers caching Find() results.
+
+  Record layout: RecordHeader, key bytes, data bytes.
+*/
+class PackStore {
+ public:
+  struct Location {
+    uint64_t segment = 0;
+    uint64_t offset  = 0;
+    uint64_t length  = 0;
+  };
+
+  struct Stats {
+    uint64_t segments           = 0;
+    uint64_t live_records       = 0;
+    uint64_t payload_bytes      = 0; // data bytes of live records
+    uint64_t live_bytes         = 0; // whole live records
+    uint64_t dead_bytes         = 0;
+    uint64_t compacted_segments = 0;
+  };
+
+  PackStore(std::filesystem::path dir, PackOptions options);
+  // Stops compaction; retired segments not yet unlinked are removed.
+  ~PackStore();
+
+  PackStore(const PackStore&)            = delete;
+  PackStore& operator=(const PackStore&) = delete;
+
+  // Appends key's bytes, replacing any earlier record; fsync flushes the segment.
+  // Puts and Removes of different keys (or the same one) may run concurrently.
+  Location Put(const std::string& key, const uint8_t* data, uint64_t length, bool fsync);
+
+  std::optional<Location> Find(const std::string& key) const;
+
+  // Keys with a live record.
+  std::vector<std::string> Keys() const;
+
+  // Copy of key's bytes, or null when key is not packed.
+  std::shared_ptr<arrow::Buffer> Read(const std::string& key) const;
+
+  // Appends a tombstone; false (and nothing written) when key is not packed.
+  bool Remove(const std::string& key);
+
+  // Key whose record starts its data at (segment, offset), for locations
+  // handed out earlier; covers retired segments until they are unlinked.
+  std::optional<std::string> KeyAt(uint64_t segment, uint64_t offset) const;
+
+  // Segment file name relative to the store directory.
+  static std::string SegmentName(uint64_t segment);
+
+  // One compaction pass: returns the number of segments compacted.
+  uint64_t Compact();
+
+  // Bumped after compaction moves records; a location found before the
+  // bump may name a retired segment.
+  uint64_t Relocations() const {
+    return relocations_.load(std::memory_order_acquire);
+  }
+
+  Stats GetStats() const;
+
+ private:
+  struct Segment;
+  using SegmentPtr = std::shared_ptr<Segment>;
+
+  // A key's latest record, plus writes for it that are still landing. An
+  // entry that is not live (removed, or its first put still in flight)
+  // stays only while writes are pending.
+  struct Entry {
+    Location location;
+    bool     live    = false;
+    uint32_t pending = 0;
+  };
+
+  // Bytes reserved for one record; offset is where its header starts.
+  struct Reservation {
+    SegmentPtr segment;
+    uint64_t   offset = 0;
+  };
+
+  void        Recover();
+  // The segment appends go to; caller holds mutex_ exclusively, which is
+  // dropped while a new segment file is created.
+  SegmentPtr  ActiveSegment(std::unique_lock<std::shared_mutex>& lock);
+  // Claims space for a record in segment; caller holds mutex_ exclusively.
+  Reservation Reserve(const SegmentPtr& segment, const std::string& key, uint64_t length);
+  // Writes a reserved record; called without mutex_.
+  Location    WriteReserved(const Reservation& reservation, uint8_t kind, const std::string& key, const uint8_t* data, uint64_t length);
+  // Points key at a put record that now sits on disk, unless a later-placed
+  // record for it was published first; caller holds mutex_ exclusively.
+  void        PublishPut(Entry& entry, const std::string& key, const Location& location);
+  // Ends one pending write of key; caller holds mutex_ exclusively.
+  void        Finish(const std::string& key, const SegmentPtr& segment);
+  // Adds a record the index now points at to the live byte counts...
+  void        Count(const std::string& key, const Location& location);
+  // ...and takes a replaced or removed one out of them.
+  void        Drop(const std::string& key, const Location& location);
+  void        CompactSegment(const SegmentPtr& segment);
+  void        UnlinkRetired(bool all);
+  void        CompactionLoop();
+
+  std::filesystem::path dir_;
+  PackOptions           options_;
+
+  mutable std::shared_mutex                                 mutex_;
+  std::map<uint64_t, SegmentPtr>                            segments_;
+  // Null once sealed; the next append opens a new segment.
+  SegmentPtr                                                active_;
+  uint64_t                                                  next_segment_ = 1;
+  std::unordered_map<std::string, Entry>                    index_;
+  // Every put record still on disk, by (segment, data offset).
+  std::map<std::pair<uint64_t, uint64_t>, std::string>      keys_at_;
+  // Compacted segments and when they were retired.
+  std::map<uint64_t, std::chrono::steady_clock::time_point> retired_;
+  uint64_t                                                  live_records_       = 0;
+  uint64_t                                                  payload_bytes_      = 0;
+  uint64_t                                                  compacted_segments_ = 0;
+  std::atomic<uint64_t>                                     relocations_{0};
+
+  // Serializes compaction passes.
+  std::mutex                  compact_mutex_;
+  std::condition_variable_any cv_;
+  bool                        stopping_ = false;
+  std::thread                 compactor_;
+};
+
+} // namespace payload::storage
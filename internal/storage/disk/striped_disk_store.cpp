@@ -0,0 +1,407 @@
+#include "striped_disk_store.hpp"
+
+#include <sys/statvfs.h>
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+#include "internal/observability/logging.hpp"
+#include "internal/util/errors.hpp"
+#include "internal/util/uuid.hpp"
+
+namespace payload::storage {
+
+using namespace payload::manager::v1;
+
+namespace {
+
+// Same key the per-root stores file a payload under.
+std::string Key(const PayloadID& id) {
+  if (id.value().size() == 16) {
+    payload::util::UUID uuid{};
+    std::memcpy(uuid.data(), id.value().data(), sizeof(uuid));
+    return payload::util::ToString(uuid);
+  }
+  return id.value();
+}
+
+struct FsSpace {
+  uint64_t total = 0;
+  uint64_t free  = 0;
+};
+
+FsSpace SpaceOf(const std::filesystem::path& root) {
+  struct statvfs vfs{};
+  if (statvfs(root.c_str(), &vfs) != 0) return {};
+  return {static_cast<uint64_t>(vfs.f_blocks) * vfs.f_frsize, static_cast<uint64_t>(vfs.f_bavail) * vfs.f_frsize};
+}
+
+} // namespace
+
+struct StripedDiskStore::Root {
+  std::size_t                     index = 0;
+  std::string                     name;
+  std::filesystem::path           path;
+  uint64_t                        capacity_bytes = 0;
+  std::unique_ptr<DiskArrowStore> store;
+  std::atomic<uint64_t>           in_flight{0};
+  std::atomic<uint64_t>           read_bytes{0};
+  std::atomic<uint64_t>           written_bytes{0};
+};
+
+// Counts one operation or open stream against a root's queue depth.
+class StripedDiskStore::InFlight {
+ public:
+  explicit InFlight(Root& root) : root_(root) {
+    root_.in_flight.fetch_add(1, std::memory_order_relaxed);
+  }
+  ~InFlight() {
+    root_.in_flight.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  InFlight(const InFlight&)            = delete;
+  InFlight& operator=(const InFlight&) = delete;
+
+ private:
+  Root& root_;
+};
+
+class StripedDiskStore::CountingReader final : public PayloadReader {
+ public:
+  CountingReader(Root& root, std::unique_ptr<PayloadReader> inner) : root_(root), in_flight_(root), inner_(std::move(inner)) {
+  }
+
+  uint64_t Size() const override {
+    return inner_->Size();
+  }
+
+  void ReadAt(uint64_t offset, uint8_t* out, uint64_t length) override {
+    inner_->ReadAt(offset, out, length);
+    root_.read_bytes.fetch_add(length, std::memory_order_relaxed);
+  }
+
+  uint64_t PreferredReadBytes() const override {
+    return inner_->PreferredReadBytes();
+  }
+
+ private:
+  Root&                          root_;
+  InFlight                       in_flight_;
+  std::unique_ptr<PayloadReader> inner_;
+};
+
+/*
+  Counts the payload's bytes as written on Commit (its full size when the
+  caller filled Destination() instead of appending), then runs committed.
+*/
+class StripedDiskStore::CountingWriter final : public PayloadWriter {
+ public:
+  CountingWriter(Root& root, std::unique_ptr<PayloadWriter> inner, uint64_t size_bytes, std::function<void()> committed)
+      : root_(root), in_flight_(root), inner_(std::move(inner)), size_bytes_(size_bytes), committed_(std::move(committed)) {
+  }
+
+  void Append(const uint8_t* data, uint64_t length) override {
+    inner_->Append(data, length);
+    appended_ += length;
+  }
+
+  uint8_t* Destination() override {
+    return inner_->Destination();
+  }
+
+  void Commit() override {
+    inner_->Commit();
+    root_.written_bytes.fetch_add(appended_ > 0 ? appended_ : size_bytes_, std::memory_order_relaxed);
+    committed_();
+  }
+
+ private:
+  Root&                          root_;
+  InFlight                       in_flight_;
+  std::unique_ptr<PayloadWriter> inner_;
+  uint64_t                       size_bytes_;
+  uint64_t                       appended_ = 0;
+  std::function<void()>          committed_;
+};
+
+StripedDiskStore::StripedDiskStore(std::vector<DiskRoot> roots, DiskStoreOptions options) {
+  if (roots.empty()) {
+    throw std::invalid_argument("disk tier: at least one root is required");
+  }
+  for (auto& config : roots) {
+    auto root            = std::make_unique<Root>();
+    root->index          = devices_.size();
+    root->path           = std::filesystem::absolute(config.path).lexically_normal();
+    root->name           = config.name.empty() ? root->path.string() : std::move(config.name);
+    root->capacity_bytes = config.capacity_bytes;
+    for (const auto& other : devices_) {
+      if (other->path == root->path) {
+        throw std::invalid_argument("disk tier: root " + root->path.string() + " is listed twice");
+      }
+    }
+
+    auto per_root           = options;
+    per_root.capacity_bytes = config.capacity_bytes;
+    root->store             = std::make_unique<DiskArrowStore>(root->path, per_root);
+    devices_.push_back(std::move(root));
+  }
+
+  // The only time roots are probed: from here on the index is authoritative.
+  std::size_t indexed = 0;
+  for (const auto& root : devices_) {
+    for (auto& key : root->store->StoredKeys()) {
+      const auto [it, inserted] = index_.emplace(std::move(key), root->index);
+      if (inserted) {
+        ++indexed;
+      } else {
+        PAYLOAD_LOG_WARN("disk tier: payload found on several roots; using the first",
+                         {payload::observability::StringField("payload_id", it->first),
+                          payload::observability::StringField("root", devices_[it->second]->name),
+                          payload::observability::StringField("ignored_root", root->name)});
+      }
+    }
+  }
+
+  PAYLOAD_LOG_INFO("disk tier striped over roots", {payload::observability::IntField("roots", static_cast<int64_t>(devices_.size())),
+                                                    payload::observability::IntField("payloads", static_cast<int64_t>(indexed))});
+}
+
+StripedDiskStore::~StripedDiskStore() = default;
+
+DiskArrowStore& StripedDiskStore::Device(std::size_t index) const {
+  return *devices_.at(index)->store;
+}
+
+std::optional<std::size_t> StripedDiskStore::DeviceOf(const PayloadID& id) const {
+  return Find(Key(id));
+}
+
+std::optional<std::size_t> StripedDiskStore::Find(const std::string& key) const {
+  std::shared_lock lock(index_mutex_);
+  if (const auto it = index_.find(key); it != index_.end()) return it->second;
+  return std::nullopt;
+}
+
+std::size_t StripedDiskStore::Home(const std::string& key) const {
+  return std::hash<std::string>{}(key) % devices_.size();
+}
+
+std::size_t StripedDiskStore::HomeOrHolder(const std::string& key) const {
+  const auto held = Find(key);
+  return held ? *held : Home(key);
+}
+
+void StripedDiskStore::Remember(const std::string& key, std::size_t index) const {
+  std::unique_lock lock(index_mutex_);
+  index_[key] = index;
+}
+
+void StripedDiskStore::Forget(const std::string& key) {
+  std::unique_lock lock(index_mutex_);
+  index_.erase(key);
+}
+
+uint64_t StripedDiskStore::FreeBytes(const Root& root) const {
+  const auto space = SpaceOf(root.path);
+  if (root.capacity_bytes == 0) return space.free;
+  const auto used = root.store->UsedBytes();
+  return std::min(root.capacity_bytes - std::min(used, root.capacity_bytes), space.free);
+}
+
+std::optional<std::size_t> StripedDiskStore::Place(uint64_t size_bytes, const std::vector<bool>& tried) const {
+  std::optional<std::size_t> best;
+  double                     best_score = -1.0;
+  for (std::size_t i = 0; i < devices_.size(); ++i) {
+    if (tried[i]) continue;
+    const auto free = FreeBytes(*devices_[i]);
+    if (free < size_bytes) continue;
+    const auto score = static_cast<double>(free) / static_cast<double>(1 + devices_[i]->in_flight.load(std::memory_order_relaxed));
+    if (score > best_score) {
+      best       = i;
+      best_score = score;
+    }
+  }
+  return best;
+}
+
+void StripedDiskStore::Store(const std::string& key, uint64_t size_bytes, const std::function<bool(Root&)>& store) {
+  if (const auto held = Find(key)) {
+    store(*devices_[*held]);
+    return;
+  }
+
+  std::vector<bool> tried(devices_.size(), false);
+  for (;;) {
+    const auto index = Place(size_bytes, tried);
+    if (!index) {
+      throw payload::util::ResourceExhausted("disk tier full: no root has " + std::to_string(size_bytes) + " bytes free");
+    }
+    try {
+      if (store(*devices_[*index])) Remember(key, *index);
+      return;
+    } catch (const payload::util::ResourceExhausted&) {
+      // Lost the space to a concurrent writer, or the filesystem is fuller than it reported.
+      tried[*index] = true;
+    }
+  }
+}
+
+std::shared_ptr<arrow::Buffer> StripedDiskStore::Allocate(const PayloadID& id, uint64_t size_bytes) {
+  std::shared_ptr<arrow::Buffer> buffer;
+  Store(Key(id), size_bytes, [&](Root& root) {
+    InFlight in_flight(root);
+    buffer = root.store->Allocate(id, size_bytes);
+    return true;
+  });
+  return buffer;
+}
+
+std::shared_ptr<arrow::Buffer> StripedDiskStore::Read(const PayloadID& id) {
+  auto&    root = *devices_[HomeOrHolder(Key(id))];
+  InFlight in_flight(root);
+  auto     buffer = root.store->Read(id);
+  root.read_bytes.fetch_add(static_cast<uint64_t>(buffer->size()), std::memory_order_relaxed);
+  return buffer;
+}
+
+uint64_t StripedDiskStore::Size(const PayloadID& id) {
+  return devices_[HomeOrHolder(Key(id))]->store->Size(id);
+}
+
+void StripedDiskStore::Write(const PayloadID& id, const std::shared_ptr<arrow::Buffer>& buffer, bool fsync) {
+  const auto length = static_cast<uint64_t>(buffer->size());
+  Store(Key(id), length, [&](Root& root) {
+    InFlight in_flight(root);
+    root.store->Write(id, buffer, fsync);
+    root.written_bytes.fetch_add(length, std::memory_order_relaxed);
+    return true;
+  });
+}
+
+bool StripedDiskStore::WriteFromFile(const PayloadID& id, int fd, uint64_t offset, uint64_t length, bool fsync) {
+  bool copied = false;
+  Store(Key(id), length, [&](Root& root) {
+    InFlight in_flight(root);
+    copied = root.store->WriteFromFile(id, fd, offset, length, fsync);
+    if (copied) root.written_bytes.fetch_add(length, std::memory_order_relaxed);
+    return copied;
+  });
+  return copied;
+}
+
+std::unique_ptr<PayloadReader> StripedDiskStore::OpenReader(const PayloadID& id) {
+  auto& root  = *devices_[HomeOrHolder(Key(id))];
+  auto  inner = root.store->OpenReader(id);
+  if (!inner) return nullptr;
+  return std::make_unique<CountingReader>(root, std::move(inner));
+}
+
+/*
+  The root is chosen (and its capacity reserved) when the writer opens;
+  it is remembered on Commit.
+*/
+std::unique_ptr<PayloadWriter> StripedDiskStore::OpenWriter(const PayloadID& id, uint64_t size_bytes, bool fsync) {
+  const auto                     key = Key(id);
+  std::unique_ptr<PayloadWriter> writer;
+  Store(key, size_bytes, [&](Root& root) {
+    auto inner = root.store->OpenWriter(id, size_bytes, fsync);
+    if (!inner) return false;
+    writer = std::make_unique<CountingWriter>(root, std::move(inner), size_bytes, [this, key, index = root.index] { Remember(key, index); });
+    return false;
+  });
+  return writer;
+}
+
+void StripedDiskStore::Remove(const PayloadID& id) {
+  const auto key  = Key(id);
+  const auto held = Find(key);
+  devices_[held ? *held : Home(key)]->store->Remove(id);
+  Forget(key);
+}
+
+void StripedDiskStore::WriteSidecar(const PayloadID& id, const payload::manager::catalog::v1::PayloadArchiveMetadata& meta) {
+  devices_[HomeOrHolder(Key(id))]->store->WriteSidecar(id, meta);
+}
+
+void StripedDiskStore::RemoveSidecar(const PayloadID& id) {
+  devices_[HomeOrHolder(Key(id))]->store->RemoveSidecar(id);
+}
+
+// Flushes every root; the first failure is rethrown once all were tried.
+void StripedDiskStore::FlushSidecars() {
+  std::exception_ptr failure;
+  for (const auto& root : devices_) {
+    try {
+      root->store->FlushSidecars();
+    } catch (...) {
+      if (!failure) failure = std::current_exception();
+    }
+  }
+  if (failure) std::rethrow_exception(failure);
+}
+
+// Each root keeps its own manifest; a payload is listed by the root holding it.
+std::vector<payload::manager::catalog::v1::PayloadArchiveMetadata> StripedDiskStore::ReadManifest() {
+  std::vector<payload::manager::catalog::v1::PayloadArchiveMetadata> entries;
+  for (const auto& root : devices_) {
+    auto listed = root->store->ReadManifest();
+    entries.insert(entries.end(), std::make_move_iterator(listed.begin()), std::make_move_iterator(listed.end()));
+  }
+  return entries;
+}
+
+void StripedDiskStore::Locate(const std::string& key, DiskLocation* location) const {
+  const auto& root = *devices_[HomeOrHolder(key)];
+  root.store->Locate(key, location);
+  location->set_path((root.path / location->path()).string());
+}
+
+// Each root only ever moves forward, so the sum moves whenever one does.
+uint64_t StripedDiskStore::LocationEpoch() const {
+  uint64_t epoch = 0;
+  for (const auto& root : devices_) epoch += root->store->LocationEpoch();
+  return epoch;
+}
+
+std::optional<std::string> StripedDiskStore::LocatedKey(const DiskLocation& location) const {
+  const std::filesystem::path path(location.path());
+  for (const auto& root : devices_) {
+    const auto relative = path.lexically_relative(root->path);
+    if (relative.empty() || *relative.begin() == "..") continue;
+    auto under = location;
+    under.set_path(relative.string());
+    return root->store->LocatedKey(under);
+  }
+  return std::nullopt;
+}
+
+std::vector<DiskDeviceUsage> StripedDiskStore::DeviceUsage() const {
+  std::vector<DiskDeviceUsage> usage;
+  usage.reserve(devices_.size());
+  for (const auto& root : devices_) {
+    DiskDeviceUsage device;
+    device.name  = root->name;
+    device.path  = root->path.string();
+    const auto space = SpaceOf(root->path);
+    if (root->capacity_bytes > 0) {
+      device.capacity_bytes = root->capacity_bytes;
+      device.used_bytes     = root->store->UsedBytes();
+    } else {
+      device.capacity_bytes = space.total;
+      device.used_bytes     = space.total - std::min(space.free, space.total);
+    }
+    device.free_bytes    = FreeBytes(*root);
+    device.queue_depth   = root->in_flight.load(std::memory_order_relaxed);
+    device.read_bytes    = root->read_bytes.load(std::memory_order_relaxed);
+    device.written_bytes = root->written_bytes.load(std::memory_order_relaxed);
+    usage.push_back(std::move(device));
+  }
+  return usage;
+}
+
+} // namespace payload::storage
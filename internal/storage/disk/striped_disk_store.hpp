@@ -0,0 +1,140 @@
+#pragma once
+
+#include <arrow/buffer.h>
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "internal/storage/disk/disk_arrow_store.hpp"
+#include "internal/storage/storage_backend.hpp"
+#include "payload/manager/v1.hpp"
+
+namespace payload::storage {
+
+struct DiskRoot {
+  std::filesystem::path path;
+  // Payload bytes this root may hold; 0 leaves it bounded by its filesystem.
+  uint64_t capacity_bytes = 0;
+  // Label in metrics and Stats; defaults to the path.
+  std::string name;
+};
+
+// Occupancy and traffic of one disk root.
+struct DiskDeviceUsage {
+  std::string name;
+  std::string path;
+  // The configured capacity, or the filesystem's size without one.
+  uint64_t capacity_bytes = 0;
+  // Payload bytes reserved with a capacity, else the filesystem's used space.
+  uint64_t used_bytes = 0;
+  uint64_t free_bytes = 0;
+  // Reads, writes and open streams in flight.
+  uint64_t queue_depth = 0;
+  // Payload bytes moved since startup; two snapshots give the bandwidth.
+  uint64_t read_bytes    = 0;
+  uint64_t written_bytes = 0;
+};
+
+/*
+  Disk tier over several roots (one per device), each a DiskArrowStore
+  with the shared options and its own capacity.
+
+  A new payload goes to the root with the most free space per operation
+  in flight (free / (1 + queue depth)) among those with room for it, so
+  roots fill in proportion to their free space and concurrent spills land
+  on different devices. A root whose reservation still fails is skipped
+  for the next best; when none has room, ResourceExhausted. A payload
+  that is rewritten stays on its root.
+
+  Which root holds a payload is kept in an in-memory index, filled by
+  scanning every root at construction and updated as payloads are placed
+  and removed; lookups never probe the roots. Sidecars
+  live next to their payload, or on a root picked by hashing the id when
+  its bytes live elsewhere (a shared content blob).
+
+  DiskLocation.path is absolute (the root joined with the file's path
+  under it), so clients open it without knowing the roots.
+*/
+class StripedDiskStore final : public StorageBackend {
+ public:
+  // options apply to every root; each root's capacity_bytes replaces options.capacity_bytes.
+  StripedDiskStore(std::vector<DiskRoot> roots, DiskStoreOptions options = {});
+  ~StripedDiskStore() override;
+
+  std::shared_ptr<arrow::Buffer> Allocate(const payload::manager::v1::PayloadID& id, uint64_t size_bytes) override;
+
+  std::shared_ptr<arrow::Buffer> Read(const payload::manager::v1::PayloadID& id) override;
+
+  uint64_t Size(const payload::manager::v1::PayloadID& id) override;
+
+  void Write(const payload::manager::v1::PayloadID& id, const std::shared_ptr<arrow::Buffer>& buffer, bool fsync) override;
+
+  bool WriteFromFile(const payload::manager::v1::PayloadID& id, int fd, uint64_t offset, uint64_t length, bool fsync) override;
+
+  std::unique_ptr<PayloadReader> OpenReader(const payload::manager::v1::PayloadID& id) override;
+
+  std::unique_ptr<PayloadWriter> OpenWriter(const payload::manager::v1::PayloadID& id, uint64_t size_bytes, bool fsync) override;
+
+  void Remove(const payload::manager::v1::PayloadID& id) override;
+
+  void WriteSidecar(const payload::manager::v1::PayloadID& id, const payload::manager::catalog::v1::PayloadArchiveMetadata& meta) override;
+  void RemoveSidecar(const payload::manager::v1::PayloadID& id) override;
+  void FlushSidecars() override;
+  std::vector<payload::manager::catalog::v1::PayloadArchiveMetadata> ReadManifest() override;
+
+  void                       Locate(const std::string& key, payload::manager::v1::DiskLocation* location) const override;
+  std::optional<std::string> LocatedKey(const payload::manager::v1::DiskLocation& location) const override;
+  uint64_t                   LocationEpoch() const override;
+
+  payload::manager::v1::Tier TierType() const override {
+    return payload::manager::v1::TIER_DISK;
+  }
+
+  std::size_t DeviceCount() const {
+    return devices_.size();
+  }
+
+  DiskArrowStore& Device(std::size_t index) const;
+
+  // Root holding id, or nullopt when no root has it.
+  std::optional<std::size_t> DeviceOf(const payload::manager::v1::PayloadID& id) const;
+
+  std::vector<DiskDeviceUsage> DeviceUsage() const;
+
+ private:
+  struct Root;
+  class InFlight;
+  class CountingReader;
+  class CountingWriter;
+
+  std::optional<std::size_t> Find(const std::string& key) const;
+  // Root for sidecars (and lookups) of an id no root holds.
+  std::size_t                Home(const std::string& key) const;
+  std::size_t                HomeOrHolder(const std::string& key) const;
+  uint64_t                   FreeBytes(const Root& root) const;
+  // Best root not yet tried with room for size_bytes, or nullopt.
+  std::optional<std::size_t> Place(uint64_t size_bytes, const std::vector<bool>& tried) const;
+  /*
+    Runs store on the root holding key, else on the best placed root,
+    moving on to the next best when it throws ResourceExhausted. store
+    returns whether it stored the payload; the root is then remembered.
+  */
+  void                       Store(const std::string& key, uint64_t size_bytes, const std::function<bool(Root&)>& store);
+  void                       Remember(const std::string& key, std::size_t index) const;
+  void                       Forget(const std::string& key);
+
+  std::vector<std::unique_ptr<Root>> devices_;
+
+  mutable std::shared_mutex                            index_mutex_;
+  mutable std::unordered_map<std::string, std::size_t> index_;
+};
+
+} // namespace payload::storage
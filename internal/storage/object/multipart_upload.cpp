@@ -0,0 +1,141 @@
+#include "multipart_upload.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <utility>
+
+namespace payload::storage {
+
+namespace {
+
+// Helpers of one RunParts call still able to touch its stack.
+struct Helpers {
+  std::mutex              mutex;
+  std::condition_variable done;
+  bool                    closed = false;
+  uint32_t                active = 0;
+};
+
+void RunParts(uint64_t size, uint64_t part_bytes, uint32_t concurrency, uint32_t retries, const std::function<void(uint64_t, uint64_t)>& run_part,
+              PartExecutor* executor) {
+  part_bytes = std::max<uint64_t>(part_bytes, 1);
+  const uint64_t parts = (size + part_bytes - 1) / part_bytes;
+
+  std::atomic<uint64_t> next_part{0};
+  std::atomic<bool>     failed{false};
+  std::mutex            error_mutex;
+  std::exception_ptr    error;
+
+  auto worker = [&] {
+    while (!failed.load(std::memory_order_relaxed)) {
+      const uint64_t part = next_part.fetch_add(1, std::memory_order_relaxed);
+      if (part >= parts) return;
+
+      const uint64_t offset = part * part_bytes;
+      const uint64_t length = std::min(part_bytes, size - offset);
+      for (uint32_t attempt = 0;; ++attempt) {
+        try {
+          run_part(offset, length);
+          break;
+        } catch (...) {
+          if (attempt < retries && !failed.load(std::memory_order_relaxed)) continue;
+          std::lock_guard lock(error_mutex);
+          if (!error) error = std::current_exception();
+          failed.store(true, std::memory_order_relaxed);
+          return;
+        }
+      }
+    }
+  };
+
+  const uint64_t workers = std::min<uint64_t>(std::max<uint32_t>(concurrency, 1), parts);
+  if (workers <= 1) {
+    worker();
+    if (error) std::rethrow_exception(error);
+    return;
+  }
+
+  // Queued helpers may start after this call returns; they only reach its
+  // stack while it is open, and it stays until the ones that did are done.
+  auto  helpers = std::make_shared<Helpers>();
+  auto& pool    = executor ? *executor : PartExecutor::Shared();
+  for (uint64_t i = 1; i < workers; ++i) {
+    pool.Submit([helpers, &worker] {
+      {
+        std::lock_guard lock(helpers->mutex);
+        if (helpers->closed) return;
+        ++helpers->active;
+      }
+      worker();
+      std::lock_guard lock(helpers->mutex);
+      if (--helpers->active == 0) helpers->done.notify_all();
+    });
+  }
+  worker();
+  {
+    std::unique_lock lock(helpers->mutex);
+    helpers->closed = true;
+    helpers->done.wait(lock, [&] { return helpers->active == 0; });
+  }
+  if (error) std::rethrow_exception(error);
+}
+
+} // namespace
+
+PartExecutor::PartExecutor(uint32_t threads) {
+  for (uint32_t i = 0; i < std::max<uint32_t>(threads, 1); ++i) {
+    threads_.emplace_back([this] { Loop(); });
+  }
+}
+
+PartExecutor::~PartExecutor() {
+  {
+    std::lock_guard lock(mutex_);
+    stopping_ = true;
+  }
+  cv_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+void PartExecutor::Submit(std::function<void()> task) {
+  {
+    std::lock_guard lock(mutex_);
+    tasks_.push_back(std::move(task));
+  }
+  cv_.notify_one();
+}
+
+PartExecutor& PartExecutor::Shared() {
+  static PartExecutor shared(std::max(std::thread::hardware_concurrency(), 4u));
+  return shared;
+}
+
+void PartExecutor::Loop() {
+  for (;;) {
+    std::function<void()> task;
+    {
+      std::unique_lock lock(mutex_);
+      cv_.wait(lock, [&] { return stopping_ || !tasks_.empty(); });
+      if (stopping_) return;
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+  }
+}
+
+void UploadParts(uint64_t size, const MultipartOptions& options, const std::function<void(uint64_t offset, uint64_t length)>& upload_part,
+                 PartExecutor* executor) {
+  RunParts(size, options.part_bytes, options.concurrency, options.part_retries, upload_part, executor);
+}
+
+void FetchRanges(uint64_t size, const RangedReadOptions& options, const std::function<void(uint64_t offset, uint64_t length)>& fetch_range,
+                 PartExecutor* executor) {
+  RunParts(size, options.range_bytes, options.concurrency, options.range_retries, fetch_range, executor);
+}
+
+} // namespace payload::storage
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace payload::storage {
+
+struct MultipartOptions {
+  // Payloads larger than this upload as parts of this size.
+  uint64_t part_bytes = uint64_t{16} << 20;
+  // Parts in flight at once.
+  uint32_t concurrency = 4;
+  // Extra attempts for a failed part before the upload fails.
+  uint32_t part_retries = 2;
+};
+
+struct RangedReadOptions {
+  // Reads larger than this are split into concurrent range requests.
+  uint64_t range_bytes = uint64_t{16} << 20;
+  // Ranges in flight at once; range_bytes * concurrency bounds the bytes
+  // outstanding per read.
+  uint32_t concurrency = 4;
+  // Extra attempts for a failed range before the read fails.
+  uint32_t range_retries = 2;
+};
+
+/*
+  Fixed set of threads that run the parts of uploads and ranged reads, so
+  concurrent transfers share them instead of each starting its own. Tasks
+  run in submission order; those still queued at destruction are dropped.
+*/
+class PartExecutor {
+ public:
+  explicit PartExecutor(uint32_t threads);
+  ~PartExecutor();
+
+  PartExecutor(const PartExecutor&)            = delete;
+  PartExecutor& operator=(const PartExecutor&) = delete;
+
+  void Submit(std::function<void()> task);
+
+  // Process-wide executor for callers without one of their own.
+  static PartExecutor& Shared();
+
+ private:
+  void Loop();
+
+  std::mutex                        mutex_;
+  std::condition_variable           cv_;
+  std::deque<std::function<void()>> tasks_;
+  bool                              stopping_ = false;
+  std::vector<std::thread>          threads_;
+};
+
+/*
+  Runs upload_part(offset, length) for every part_bytes slice of a
+  size-byte payload, up to concurrency at once: the caller works through
+  parts itself and up to concurrency - 1 helpers join it on executor
+  (PartExecutor::Shared() when null). A payload of one part runs entirely
+  on the caller, and helpers that only start once every part is taken
+  return at once, so the caller never waits on the executor's queue. A
+  part that throws is retried up to part_retries times; once a part runs
+  out of attempts no new parts start, and that part's last exception is
+  rethrown after in-flight parts finish.
+*/
+void UploadParts(uint64_t size, const MultipartOptions& options, const std::function<void(uint64_t offset, uint64_t length)>& upload_part,
+                 PartExecutor* executor = nullptr);
+
+// Same scheduling for reads: fetch_range(offset, length) per range_bytes
+// range, up to concurrency at once, each retried up to range_retries times.
+void FetchRanges(uint64_t size, const RangedReadOptions& options, const std::function<void(uint64_t offset, uint64_t length)>& fetch_range,
+                 PartExecutor* executor = nullptr);
+
+} // namespace payload::storage
@@ -3,8 +3,15 @@
 #include <arrow/filesystem/s3fs.h>
 #include <arrow/io/interfaces.h>
 #include <arrow/result.h>
-#include <google/protobuf/util/json_util.h>
+#include <fcntl.h>
 #include <spdlog/spdlog.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <vector>
 
 #include "internal/storage/common/arrow_utils.hpp"
 #include "internal/storage/common/path_utils.hpp"
@@ -18,6 +25,9 @@ using namespace payload::manager::v1;
 
 namespace {
 
+// S3 rejects multipart parts smaller than this (except the last).
+constexpr uint64_t kMinS3PartBytes = uint64_t{5} << 20;
+
 // Convert a PayloadID to its hex-string key, handling binary (16-byte) UUIDs.
 std::string Key(const PayloadID& id) {
   if (id.value().size() == 16) {
@@ -29,13 +39,121 @@ std::string Key(const PayloadID& id) {
   return id.value();
 }
 
+// Reads exactly length bytes at offset, as one range request.
+void ReadRange(arrow::io::RandomAccessFile& input, const std::string& path, uint64_t offset, uint8_t* out, uint64_t length) {
+  const auto n = Unwrap(input.ReadAt(static_cast<int64_t>(offset), static_cast<int64_t>(length), out));
+  if (static_cast<uint64_t>(n) != length) {
+    throw std::runtime_error("object read: " + path + " ended before offset " + std::to_string(offset + length));
+  }
+}
+
+/*
+  Each ReadAt is split into range_bytes ranges fetched concurrently (on the
+  store's part executor) straight into the caller's buffer.
+*/
+class ObjectPayloadReader final : public PayloadReader {
+ public:
+  ObjectPayloadReader(std::shared_ptr<arrow::io::RandomAccessFile> input, uint64_t size, std::string path, const RangedReadOptions& ranged_reads,
+                      std::shared_ptr<PartExecutor> parts)
+      : input_(std::move(input)), size_(size), path_(std::move(path)), ranged_reads_(ranged_reads), parts_(std::move(parts)) {
+  }
+
+  uint64_t Size() const override {
+    return size_;
+  }
+
+  void ReadAt(uint64_t offset, uint8_t* out, uint64_t length) override {
+    FetchRanges(
+        length, ranged_reads_,
+        [&](uint64_t range_offset, uint64_t range_length) { ReadRange(*input_, path_, offset + range_offset, out + range_offset, range_length); },
+        parts_.get());
+  }
+
+  uint64_t PreferredReadBytes() const override {
+    return ranged_reads_.range_bytes * ranged_reads_.concurrency;
+  }
+
+ private:
+  std::shared_ptr<arrow::io::RandomAccessFile> input_;
+  uint64_t                                     size_;
+  std::string                                  path_;
+  RangedReadOptions                            ranged_reads_;
+  std::shared_ptr<PartExecutor>                parts_;
+};
+
+/*
+  Streams chunks into one output stream (S3 uploads them as multipart
+  parts). Every window_bytes (0 = never) it flushes, waiting for the parts
+  uploading in the background. An uncommitted writer aborts the stream and
+  deletes whatever the filesystem already made visible.
+*/
+class ObjectPayloadWriter final : public PayloadWriter {
+ public:
+  ObjectPayloadWriter(std::shared_ptr<arrow::fs::FileSystem> fs, std::shared_ptr<arrow::io::OutputStream> out, std::string path,
+                      uint64_t window_bytes)
+      : fs_(std::move(fs)), out_(std::move(out)), path_(std::move(path)), window_bytes_(window_bytes) {
+  }
+
+  ~ObjectPayloadWriter() override {
+    if (!committed_) {
+      (void)out_->Abort();
+      (void)fs_->DeleteFile(path_);
+    }
+  }
+
+  void Append(const uint8_t* data, uint64_t length) override {
+    Unwrap(out_->Write(data, static_cast<int64_t>(length)));
+    unflushed_ += length;
+    if (window_bytes_ > 0 && unflushed_ >= window_bytes_) {
+      Unwrap(out_->Flush());
+      unflushed_ = 0;
+    }
+  }
+
+  void Commit() override {
+    Unwrap(out_->Close());
+    committed_ = true;
+  }
+
+ private:
+  std::shared_ptr<arrow::fs::FileSystem>   fs_;
+  std::shared_ptr<arrow::io::OutputStream> out_;
+  std::string                              path_;
+  uint64_t                                 window_bytes_;
+  uint64_t                                 unflushed_ = 0;
+  bool                                     committed_ = false;
+};
+
 } // namespace
 
-ObjectArrowStore::ObjectArrowStore(std::shared_ptr<arrow::fs::FileSystem> fs, std::string root_path, bool is_s3)
-    : fs_(std::move(fs)), root_path_(std::move(root_path)), is_s3_(is_s3) {
+ObjectArrowStore::ObjectArrowStore(std::shared_ptr<arrow::fs::FileSystem> fs, std::string root_path, bool is_s3, MultipartOptions multipart,
+                                   RangedReadOptions ranged_reads, SidecarOptions sidecars)
+    : fs_(std::move(fs)),
+      root_path_(std::move(root_path)),
+      is_s3_(is_s3),
+      local_(fs_->type_name() == "local"),
+      multipart_(multipart),
+      ranged_reads_(ranged_reads),
+      sidecars_(sidecars),
+      parts_(std::make_shared<PartExecutor>(std::max(multipart_.concurrency, ranged_reads_.concurrency))) {
+  if (is_s3_) multipart_.part_bytes = std::max(multipart_.part_bytes, kMinS3PartBytes);
+  if (sidecars_.format == SidecarFormat::kManifest) {
+    const auto manifest_dir = RootedPath(kManifestDir);
+    if (local_) Unwrap(fs_->CreateDir(manifest_dir));
+    manifest_ = std::make_unique<ManifestWriter>(
+        sidecars_,
+        [this, manifest_dir](const std::string& name, const std::string& bytes) {
+          auto out = Unwrap(fs_->OpenOutputStream(manifest_dir + "/" + name));
+          Unwrap(out->Write(bytes.data(), static_cast<int64_t>(bytes.size())));
+          Unwrap(out->Close());
+        },
+        NextManifestSequence(*fs_, root_path_), fs_, root_path_);
+  }
 }
 
 ObjectArrowStore::~ObjectArrowStore() {
+  // Pending manifest entries go out while the filesystem is still alive.
+  manifest_.reset();
   fs_.reset();
   if (is_s3_) {
     (void)arrow::fs::EnsureS3Finalized();
@@ -45,36 +163,33 @@ ObjectArrowStore::~ObjectArrowStore() {
 /*
   Object key layout:
 
-      <root_path>/<uuid>.bin       — payload data
-      <root_path>/<uuid>.meta.json — sidecar metadata
+      <root_path>/<uuid>.bin                — payload data
+      <root_path>/<uuid>.meta.json (.pb)    — sidecar metadata
+      <root_path>/manifests/<seg>.manifest  — batched sidecar metadata
 */
+std::string ObjectArrowStore::RootedPath(const std::string& name) const {
+  if (!root_path_.empty() && root_path_.back() == '/') {
+    return root_path_ + name;
+  }
+  return root_path_ + "/" + name;
+}
+
 std::string ObjectArrowStore::ObjectPath(const PayloadID& id) const {
   const auto key = Key(id);
   common::ValidatePayloadId(key);
-  if (!root_path_.empty() && root_path_.back() == '/') {
-    return root_path_ + key + ".bin";
-  }
-  return root_path_ + "/" + key + ".bin";
+  return RootedPath(key + ".bin");
 }
 
 std::string ObjectArrowStore::SidecarObjectPath(const PayloadID& id) const {
   const auto key = Key(id);
   common::ValidatePayloadId(key);
-  if (!root_path_.empty() && root_path_.back() == '/') {
-    return root_path_ + key + ".meta.json";
-  }
-  return root_path_ + "/" + key + ".meta.json";
+  return RootedPath(key + SidecarSuffix(sidecars_.format));
 }
 
 std::string ObjectArrowStore::GetUploadUri(const PayloadID& id) const {
   const auto key = Key(id);
   common::ValidatePayloadId(key);
-  std::string path;
-  if (!root_path_.empty() && root_path_.back() == '/') {
-    path = root_path_ + key + ".bin";
-  } else {
-    path = root_path_ + "/" + key + ".bin";
-  }
+  const auto path = RootedPath(key + ".bin");
   return is_s3_ ? ("s3://" + path) : path;
 }
 
@@ -86,12 +201,29 @@ std::shared_ptr<arrow::Buffer> ObjectArrowStore::Allocate(const PayloadID&, uint
 }
 
 /*
-  Download full object
+  Download full object.
+
+  Objects larger than one range are fetched as concurrent range reads into
+  one buffer; zero-copy inputs (mmap) return a slice of the mapping.
 */
 std::shared_ptr<arrow::Buffer> ObjectArrowStore::Read(const PayloadID& id) {
-  auto input = Unwrap(fs_->OpenInputFile(ObjectPath(id)));
-  auto size  = Unwrap(input->GetSize());
-  return Unwrap(input->Read(size));
+  const auto path  = ObjectPath(id);
+  auto       input = Unwrap(fs_->OpenInputFile(path));
+  auto       size  = Unwrap(input->GetSize());
+  if (input->supports_zero_copy() || static_cast<uint64_t>(size) <= ranged_reads_.range_bytes) {
+    return Unwrap(input->Read(size));
+  }
+
+  auto allocated = arrow::AllocateBuffer(size);
+  if (!allocated.ok()) {
+    throw std::runtime_error("object read: " + allocated.status().ToString());
+  }
+  std::shared_ptr<arrow::Buffer> buffer(std::move(*allocated));
+  uint8_t*                       out = buffer->mutable_data();
+  FetchRanges(
+      static_cast<uint64_t>(size), ranged_reads_, [&](uint64_t offset, uint64_t length) { ReadRange(*input, path, offset, out + offset, length); },
+      parts_.get());
+  return buffer;
 }
 
 uint64_t ObjectArrowStore::Size(const PayloadID& id) {
@@ -102,42 +234,144 @@ uint64_t ObjectArrowStore::Size(const PayloadID& id) {
 /*
   Upload buffer as object.
 
+  Payloads larger than one part go up in parts sliced from the source
+  buffer: on the local filesystem they are written in parallel into a
+  temporary file that is renamed into place; elsewhere each slice is handed
+  to the output stream as its own part (S3 uploads them in the background,
+  without copying, and waits for each window of concurrency parts before
+  handing out more, so one upload never holds more than that many of the
+  IO pool's threads).
+
   fsync flag ignored — object stores are atomic per PUT.
 */
 void ObjectArrowStore::Write(const PayloadID& id, const std::shared_ptr<arrow::Buffer>& buffer, bool /*fsync*/) {
   const auto path = ObjectPath(id);
   spdlog::debug("[obj] Write begin path={} size={}", path, buffer ? buffer->size() : -1L);
-  auto out = Unwrap(fs_->OpenOutputStream(path));
-  Unwrap(out->Write(buffer->data(), buffer->size()));
-  Unwrap(out->Close());
+  if (local_ && static_cast<uint64_t>(buffer->size()) > multipart_.part_bytes) {
+    WriteLocalParts(path, buffer);
+  } else {
+    WriteStreamed(path, buffer);
+  }
   spdlog::debug("[obj] Write closed OK path={}", path);
 }
 
+void ObjectArrowStore::WriteStreamed(const std::string& path, const std::shared_ptr<arrow::Buffer>& buffer) {
+  auto       out  = Unwrap(fs_->OpenOutputStream(path));
+  const auto size = static_cast<uint64_t>(buffer->size());
+  try {
+    uint32_t in_flight = 0;
+    for (uint64_t offset = 0; offset < size; offset += multipart_.part_bytes) {
+      const auto length = std::min(multipart_.part_bytes, size - offset);
+      Unwrap(out->Write(arrow::SliceBuffer(buffer, static_cast<int64_t>(offset), static_cast<int64_t>(length))));
+      if (is_s3_ && ++in_flight >= multipart_.concurrency) {
+        Unwrap(out->Flush());
+        in_flight = 0;
+      }
+    }
+    Unwrap(out->Close());
+  } catch (...) {
+    (void)out->Abort();
+    throw;
+  }
+}
+
+void ObjectArrowStore::WriteLocalParts(const std::string& path, const std::shared_ptr<arrow::Buffer>& buffer) {
+  const auto tmp = path + ".tmp";
+  const int  fd  = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    throw std::runtime_error("object write: open " + tmp + ": " + std::strerror(errno));
+  }
+
+  const auto size = static_cast<uint64_t>(buffer->size());
+  try {
+    if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+      throw std::runtime_error("object write: ftruncate " + tmp + ": " + std::strerror(errno));
+    }
+    UploadParts(
+        size, multipart_,
+        [&](uint64_t offset, uint64_t length) {
+          while (length > 0) {
+            const auto n = ::pwrite(fd, buffer->data() + offset, length, static_cast<off_t>(offset));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+              throw std::runtime_error("object write: pwrite " + tmp + ": " + std::strerror(errno));
+            }
+            offset += static_cast<uint64_t>(n);
+            length -= static_cast<uint64_t>(n);
+          }
+        },
+        parts_.get());
+  } catch (...) {
+    ::close(fd);
+    ::unlink(tmp.c_str());
+    throw;
+  }
+
+  if (::close(fd) != 0 || std::rename(tmp.c_str(), path.c_str()) != 0) {
+    const int err = errno;
+    ::unlink(tmp.c_str());
+    throw std::runtime_error("object write: commit " + path + ": " + std::strerror(err));
+  }
+}
+
+std::unique_ptr<PayloadReader> ObjectArrowStore::OpenReader(const PayloadID& id) {
+  auto path  = ObjectPath(id);
+  auto input = Unwrap(fs_->OpenInputFile(path));
+  auto size  = Unwrap(input->GetSize());
+  return std::make_unique<ObjectPayloadReader>(std::move(input), static_cast<uint64_t>(size), std::move(path), ranged_reads_, parts_);
+}
+
+/*
+  fsync flag ignored, as in Write.
+*/
+std::unique_ptr<PayloadWriter> ObjectArrowStore::OpenWriter(const PayloadID& id, uint64_t /*size_bytes*/, bool /*fsync*/) {
+  auto           path   = ObjectPath(id);
+  auto           out    = Unwrap(fs_->OpenOutputStream(path));
+  const uint64_t window = is_s3_ ? multipart_.part_bytes * std::max<uint32_t>(multipart_.concurrency, 1) : 0;
+  return std::make_unique<ObjectPayloadWriter>(fs_, std::move(out), std::move(path), window);
+}
+
 /*
   Delete object and sidecar (sidecar removal is best-effort).
 */
 void ObjectArrowStore::Remove(const PayloadID& id) {
   Unwrap(fs_->DeleteFile(ObjectPath(id)));
+  RemoveSidecar(id);
+}
+
+void ObjectArrowStore::RemoveSidecar(const PayloadID& id) {
+  if (manifest_) {
+    manifest_->Remove(id);
+    return;
+  }
   (void)fs_->DeleteFile(SidecarObjectPath(id));
 }
 
 /*
-  Write <uuid>.meta.json to object storage.
+  Write <uuid>.meta.json (or .meta.pb) to object storage, or queue the
+  metadata for the next manifest segment.
 */
 void ObjectArrowStore::WriteSidecar(const PayloadID& id, const payload::manager::catalog::v1::PayloadArchiveMetadata& meta) {
-  google::protobuf::util::JsonPrintOptions opts;
-  opts.add_whitespace = true;
-
-  std::string json;
-  auto        status = google::protobuf::util::MessageToJsonString(meta, &json, opts);
-  if (!status.ok()) {
-    throw std::runtime_error("WriteSidecar: serialization failed: " + status.ToString());
+  if (manifest_) {
+    manifest_->Put(meta);
+    return;
   }
-
-  const auto path = SidecarObjectPath(id);
-  auto       out  = Unwrap(fs_->OpenOutputStream(path));
-  Unwrap(out->Write(json.data(), static_cast<int64_t>(json.size())));
+  const auto bytes = EncodeSidecar(meta, sidecars_.format);
+  auto       out   = Unwrap(fs_->OpenOutputStream(SidecarObjectPath(id)));
+  Unwrap(out->Write(bytes.data(), static_cast<int64_t>(bytes.size())));
   Unwrap(out->Close());
 }
 
+void ObjectArrowStore::FlushSidecars() {
+  if (manifest_) manifest_->Flush();
+}
+
+std::vector<payload::manager::catalog::v1::PayloadArchiveMetadata> ObjectArrowStore::ReadManifest() {
+  if (!manifest_) return {};
+  const auto                                                         catalog = ReadManifestCatalog(*fs_, root_path_);
+  std::vector<payload::manager::catalog::v1::PayloadArchiveMetadata> entries;
+  for (const auto& [key, meta] : catalog.Entries()) entries.push_back(meta);
+  return entries;
+}
+
 } // namespace payload::storage
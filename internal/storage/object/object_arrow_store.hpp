@@ -6,6 +6,8 @@
 #include <memory>
 #include <string>
 
+#include "internal/storage/common/sidecar.hpp"
+#include "internal/storage/object/multipart_upload.hpp"
 #include "internal/storage/storage_backend.hpp"
 #include "payload/manager/v1.hpp"
 
@@ -19,11 +21,15 @@ namespace payload::storage {
     - eventual durability
     - no allocation
     - no fsync semantics
+    - payloads larger than one part upload as parallel parts
+    - large reads fetch byte ranges in parallel
+    - manifest sidecars: one PUT per segment instead of per payload
 */
 
 class ObjectArrowStore final : public StorageBackend {
  public:
-  ObjectArrowStore(std::shared_ptr<arrow::fs::FileSystem> fs, std::string root_path, bool is_s3 = false);
+  ObjectArrowStore(std::shared_ptr<arrow::fs::FileSystem> fs, std::string root_path, bool is_s3 = false, MultipartOptions multipart = {},
+                   RangedReadOptions ranged_reads = {}, common::SidecarOptions sidecars = {});
   ~ObjectArrowStore() override;
 
   std::shared_ptr<arrow::Buffer> Allocate(const payload::manager::v1::PayloadID& id, uint64_t size_bytes) override;
@@ -34,9 +40,17 @@ class ObjectArrowStore final : public StorageBackend {
 
   void Write(const payload::manager::v1::PayloadID& id, const std::shared_ptr<arrow::Buffer>& buffer, bool fsync) override;
 
+  // Ranged reads and a streaming upload for chunked transfers.
+  std::unique_ptr<PayloadReader> OpenReader(const payload::manager::v1::PayloadID& id) override;
+
+  std::unique_ptr<PayloadWriter> OpenWriter(const payload::manager::v1::PayloadID& id, uint64_t size_bytes, bool fsync) override;
+
   void Remove(const payload::manager::v1::PayloadID& id) override;
 
   void WriteSidecar(const payload::manager::v1::PayloadID& id, const payload::manager::catalog::v1::PayloadArchiveMetadata& meta) override;
+  void RemoveSidecar(const payload::manager::v1::PayloadID& id) override;
+  void FlushSidecars() override;
+  std::vector<payload::manager::catalog::v1::PayloadArchiveMetadata> ReadManifest() override;
 
   payload::manager::v1::Tier TierType() const override {
     return payload::manager::v1::TIER_OBJECT;
@@ -50,10 +64,22 @@ class ObjectArrowStore final : public StorageBackend {
  private:
   std::string ObjectPath(const payload::manager::v1::PayloadID& id) const;
   std::string SidecarObjectPath(const payload::manager::v1::PayloadID& id) const;
-
-  std::shared_ptr<arrow::fs::FileSystem> fs_;
-  std::string                            root_path_;
-  bool                                   is_s3_;
+  std::string RootedPath(const std::string& name) const;
+
+  void WriteStreamed(const std::string& path, const std::shared_ptr<arrow::Buffer>& buffer);
+  void WriteLocalParts(const std::string& path, const std::shared_ptr<arrow::Buffer>& buffer);
+
+  std::shared_ptr<arrow::fs::FileSystem>  fs_;
+  std::string                             root_path_;
+  bool                                    is_s3_;
+  bool                                    local_;
+  MultipartOptions                        multipart_;
+  RangedReadOptions                       ranged_reads_;
+  common::SidecarOptions                  sidecars_;
+  // Runs the parts of this store's uploads and ranged reads; shared with its readers.
+  std::shared_ptr<PartExecutor>           parts_;
+  // Set for SidecarFormat::kManifest.
+  std::unique_ptr<common::ManifestWriter> manifest_;
 };
 
 } // namespace payload::storage
@@ -0,0 +1,452 @@
+#include "payload_codec.hpp"
+
+#include <arrow/util/compression.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace payload::storage {
+
+using payload::manager::v1::PayloadCodec;
+
+namespace {
+
+constexpr uint64_t kFrameHeaderBytes = sizeof(uint64_t);
+
+arrow::Compression::type ToArrow(PayloadCodec codec) {
+  switch (codec) {
+    case payload::manager::v1::PAYLOAD_CODEC_LZ4:
+      return arrow::Compression::LZ4_FRAME;
+    case payload::manager::v1::PAYLOAD_CODEC_ZSTD:
+      return arrow::Compression::ZSTD;
+    case payload::manager::v1::PAYLOAD_CODEC_SNAPPY:
+      return arrow::Compression::SNAPPY;
+    case payload::manager::v1::PAYLOAD_CODEC_GZIP:
+      return arrow::Compression::GZIP;
+    case payload::manager::v1::PAYLOAD_CODEC_BROTLI:
+      return arrow::Compression::BROTLI;
+    default:
+      throw std::runtime_error("payload codec " + std::to_string(static_cast<int>(codec)) + " is not a compressing codec");
+  }
+}
+
+std::unique_ptr<arrow::util::Codec> MakeCodec(PayloadCodec codec) {
+  auto created = arrow::util::Codec::Create(ToArrow(codec));
+  if (!created.ok()) {
+    throw std::runtime_error("create " + std::string(CodecName(codec)) + " codec: " + created.status().ToString());
+  }
+  return std::move(*created);
+}
+
+double ElapsedMs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+template <typename T>
+T Check(arrow::Result<T> result, const char* what, PayloadCodec codec) {
+  if (!result.ok()) throw std::runtime_error(std::string(what) + " (" + std::string(CodecName(codec)) + "): " + result.status().ToString());
+  return std::move(*result);
+}
+
+// Arrow's Snappy codec is one-shot only (no streaming compressor).
+bool Streams(PayloadCodec codec) {
+  return codec != payload::manager::v1::PAYLOAD_CODEC_SNAPPY;
+}
+
+/*
+  Sequential view of a stored payload: its PayloadReader when the backend
+  has one, else the buffer Read() returns (a mapping for RAM), so the
+  transcode never stages the whole payload.
+*/
+class ChunkedSource {
+ public:
+  ChunkedSource(StorageBackend& backend, const payload::manager::v1::PayloadID& id) : reader_(backend.OpenReader(id)) {
+    if (!reader_) buffer_ = backend.Read(id);
+  }
+
+  uint64_t Size() const {
+    return reader_ ? reader_->Size() : static_cast<uint64_t>(buffer_->size());
+  }
+
+  uint64_t PreferredReadBytes() const {
+    return reader_ ? reader_->PreferredReadBytes() : 0;
+  }
+
+  // length bytes at offset: in place in the buffer, or read into scratch.
+  const uint8_t* At(uint64_t offset, uint64_t length, std::vector<uint8_t>& scratch) {
+    if (!reader_) return buffer_->data() + offset;
+    scratch.resize(static_cast<size_t>(length));
+    reader_->ReadAt(offset, scratch.data(), length);
+    return scratch.data();
+  }
+
+ private:
+  std::unique_ptr<PayloadReader> reader_;
+  std::shared_ptr<arrow::Buffer> buffer_;
+};
+
+// Compresses raw bytes into a frame on writer as they arrive.
+class FrameEncoder {
+ public:
+  FrameEncoder(PayloadCodec codec, uint64_t raw_bytes, uint64_t chunk_bytes, PayloadWriter& writer) : codec_(codec), writer_(writer) {
+    auto impl   = MakeCodec(codec);
+    compressor_ = Check(impl->MakeCompressor(), "encode payload", codec);
+    out_.resize(static_cast<size_t>(impl->MaxCompressedLen(static_cast<int64_t>(chunk_bytes), nullptr)));
+    stats_.raw_bytes = raw_bytes;
+    // Little-endian on every platform the manager builds for.
+    Emit(reinterpret_cast<const uint8_t*>(&raw_bytes), kFrameHeaderBytes);
+  }
+
+  void Append(const uint8_t* data, uint64_t length) {
+    const auto start = std::chrono::steady_clock::now();
+    while (length > 0) {
+      const auto done = Check(compressor_->Compress(static_cast<int64_t>(length), data, static_cast<int64_t>(out_.size()), out_.data()),
+                              "encode payload", codec_);
+      Emit(out_.data(), static_cast<uint64_t>(done.bytes_written));
+      data += done.bytes_read;
+      length -= static_cast<uint64_t>(done.bytes_read);
+      if (done.bytes_read == 0) out_.resize(out_.size() * 2);
+    }
+    stats_.duration_ms += ElapsedMs(start);
+  }
+
+  // Flushes the codec's tail; returns the whole frame's stats.
+  CodecStats Finish() {
+    const auto start = std::chrono::steady_clock::now();
+    for (;;) {
+      const auto done = Check(compressor_->End(static_cast<int64_t>(out_.size()), out_.data()), "encode payload", codec_);
+      Emit(out_.data(), static_cast<uint64_t>(done.bytes_written));
+      if (!done.should_retry) break;
+      if (done.bytes_written == 0) out_.resize(out_.size() * 2);
+    }
+    stats_.duration_ms += ElapsedMs(start);
+    return stats_;
+  }
+
+ private:
+  void Emit(const uint8_t* data, uint64_t length) {
+    if (length == 0) return;
+    writer_.Append(data, length);
+    stats_.stored_bytes += length;
+  }
+
+  PayloadCodec                              codec_;
+  PayloadWriter&                            writer_;
+  std::shared_ptr<arrow::util::Compressor> compressor_;
+  std::vector<uint8_t>                      out_;
+  CodecStats                                stats_;
+};
+
+// Uncompressed length in the header of source's frame.
+uint64_t FrameRawBytes(ChunkedSource& source) {
+  if (source.Size() < kFrameHeaderBytes) throw std::runtime_error("decode payload: frame is shorter than its header");
+  std::vector<uint8_t> scratch;
+  uint64_t             raw_bytes = 0;
+  std::memcpy(&raw_bytes, source.At(0, kFrameHeaderBytes, scratch), kFrameHeaderBytes);
+  return raw_bytes;
+}
+
+/*
+  Decompresses source's frame chunk by chunk, handing each run of raw
+  bytes to emit. With destination set (raw_bytes long) it decodes straight
+  into it and emit sees the bytes in place.
+*/
+CodecStats DecodeFrame(ChunkedSource& source, PayloadCodec codec, uint64_t raw_bytes, uint64_t chunk_bytes, uint8_t* destination,
+                       const std::function<void(const uint8_t*, uint64_t)>& emit) {
+  CodecStats stats;
+  stats.raw_bytes    = raw_bytes;
+  stats.stored_bytes = source.Size();
+
+  auto                 decompressor = Check(MakeCodec(codec)->MakeDecompressor(), "decode payload", codec);
+  std::vector<uint8_t> in_scratch;
+  std::vector<uint8_t> out_scratch(destination ? 0 : static_cast<size_t>(chunk_bytes));
+  uint64_t             offset   = kFrameHeaderBytes;
+  uint64_t             produced = 0;
+  const uint8_t*       in       = nullptr;
+  uint64_t             in_left  = 0;
+  bool                 drain    = false; // the codec holds output back for more room (Brotli)
+  while (!decompressor->IsFinished()) {
+    if (in_left == 0 && !drain) {
+      if (offset == stats.stored_bytes) throw std::runtime_error("decode payload: frame ends early");
+      in_left = std::min(chunk_bytes, stats.stored_bytes - offset);
+      in      = source.At(offset, in_left, in_scratch);
+      offset += in_left;
+    }
+    uint8_t*       out  = destination ? destination + produced : out_scratch.data();
+    const uint64_t room = destination ? raw_bytes - produced : out_scratch.size();
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto done  = Check(decompressor->Decompress(static_cast<int64_t>(in_left), in, static_cast<int64_t>(room), out), "decode payload", codec);
+    stats.duration_ms += ElapsedMs(start);
+
+    const auto written = static_cast<uint64_t>(done.bytes_written);
+    if (produced + written > raw_bytes || (done.need_more_output && destination && produced + written == raw_bytes)) {
+      throw std::runtime_error("decode payload: frame decodes past its " + std::to_string(raw_bytes) + " bytes");
+    }
+    if (done.bytes_read == 0 && written == 0 && !done.need_more_output) throw std::runtime_error("decode payload: codec made no progress");
+    in += done.bytes_read;
+    in_left -= static_cast<uint64_t>(done.bytes_read);
+    if (written > 0) emit(out, written);
+    produced += written;
+    drain = done.need_more_output;
+  }
+  if (produced != raw_bytes) {
+    throw std::runtime_error("decode payload: frame decoded to " + std::to_string(produced) + " of " + std::to_string(raw_bytes) + " bytes");
+  }
+  return stats;
+}
+
+// The transcode with the whole payload in memory, for codecs that cannot
+// stream and targets without a writer.
+TranscodeResult TranscodeWhole(StorageBackend& source, const payload::manager::v1::PayloadID& source_id, StorageBackend& target,
+                               const payload::manager::v1::PayloadID& target_id, bool fsync, PayloadCodec source_codec, PayloadCodec target_codec,
+                               Crc32c* checksum) {
+  TranscodeResult result;
+  auto            stored = source.Read(source_id);
+  if (!IsCompressed(source_codec)) {
+    if (checksum) checksum->Update(stored->data(), static_cast<uint64_t>(stored->size()));
+    auto frame = EncodePayload(*stored, target_codec, &result.encode);
+    target.Write(target_id, frame, fsync);
+    result.stored_bytes = static_cast<uint64_t>(frame->size());
+    return result;
+  }
+
+  auto raw = DecodePayload(*stored, source_codec, &result.decode);
+  if (checksum) checksum->Update(raw->data(), static_cast<uint64_t>(raw->size()));
+  if (!IsCompressed(target_codec)) {
+    target.Write(target_id, raw, fsync);
+    return result;
+  }
+  auto frame = EncodePayload(*raw, target_codec, &result.encode);
+  target.Write(target_id, frame, fsync);
+  result.stored_bytes = static_cast<uint64_t>(frame->size());
+  return result;
+}
+
+} // namespace
+
+bool IsCompressed(PayloadCodec codec) {
+  return codec != payload::manager::v1::PAYLOAD_CODEC_UNSPECIFIED && codec != payload::manager::v1::PAYLOAD_CODEC_NONE;
+}
+
+std::string_view CodecName(PayloadCodec codec) {
+  switch (codec) {
+    case payload::manager::v1::PAYLOAD_CODEC_LZ4:
+      return "lz4";
+    case payload::manager::v1::PAYLOAD_CODEC_ZSTD:
+      return "zstd";
+    case payload::manager::v1::PAYLOAD_CODEC_SNAPPY:
+      return "snappy";
+    case payload::manager::v1::PAYLOAD_CODEC_GZIP:
+      return "gzip";
+    case payload::manager::v1::PAYLOAD_CODEC_BROTLI:
+      return "brotli";
+    default:
+      return "none";
+  }
+}
+
+PayloadCodec ToPayloadCodec(arrow::Compression::type type) {
+  PayloadCodec codec = payload::manager::v1::PAYLOAD_CODEC_NONE;
+  switch (type) {
+    case arrow::Compression::UNCOMPRESSED:
+      return payload::manager::v1::PAYLOAD_CODEC_NONE;
+    case arrow::Compression::LZ4:
+    case arrow::Compression::LZ4_FRAME:
+      codec = payload::manager::v1::PAYLOAD_CODEC_LZ4;
+      break;
+    case arrow::Compression::ZSTD:
+      codec = payload::manager::v1::PAYLOAD_CODEC_ZSTD;
+      break;
+    case arrow::Compression::SNAPPY:
+      codec = payload::manager::v1::PAYLOAD_CODEC_SNAPPY;
+      break;
+    case arrow::Compression::GZIP:
+      codec = payload::manager::v1::PAYLOAD_CODEC_GZIP;
+      break;
+    case arrow::Compression::BROTLI:
+      codec = payload::manager::v1::PAYLOAD_CODEC_BROTLI;
+      break;
+    default:
+      throw std::runtime_error("compression " + arrow::util::Codec::GetCodecAsString(type) + " is not supported for payloads");
+  }
+  if (!arrow::util::Codec::IsAvailable(ToArrow(codec))) {
+    throw std::runtime_error("compression " + std::string(CodecName(codec)) + " is not available in this Arrow build");
+  }
+  return codec;
+}
+
+payload::manager::catalog::v1::CompressionType ToArchiveCompression(PayloadCodec codec) {
+  switch (codec) {
+    case payload::manager::v1::PAYLOAD_CODEC_LZ4:
+      return payload::manager::catalog::v1::COMPRESSION_LZ4;
+    case payload::manager::v1::PAYLOAD_CODEC_ZSTD:
+      return payload::manager::catalog::v1::COMPRESSION_ZSTD;
+    case payload::manager::v1::PAYLOAD_CODEC_SNAPPY:
+      return payload::manager::catalog::v1::COMPRESSION_SNAPPY;
+    case payload::manager::v1::PAYLOAD_CODEC_GZIP:
+      return payload::manager::catalog::v1::COMPRESSION_GZIP;
+    case payload::manager::v1::PAYLOAD_CODEC_BROTLI:
+      return payload::manager::catalog::v1::COMPRESSION_BROTLI;
+    default:
+      return payload::manager::catalog::v1::COMPRESSION_NONE;
+  }
+}
+
+PayloadCodec FromArchiveCompression(payload::manager::catalog::v1::CompressionType type) {
+  switch (type) {
+    case payload::manager::catalog::v1::COMPRESSION_LZ4:
+      return payload::manager::v1::PAYLOAD_CODEC_LZ4;
+    case payload::manager::catalog::v1::COMPRESSION_ZSTD:
+      return payload::manager::v1::PAYLOAD_CODEC_ZSTD;
+    case payload::manager::catalog::v1::COMPRESSION_SNAPPY:
+      return payload::manager::v1::PAYLOAD_CODEC_SNAPPY;
+    case payload::manager::catalog::v1::COMPRESSION_GZIP:
+      return payload::manager::v1::PAYLOAD_CODEC_GZIP;
+    case payload::manager::catalog::v1::COMPRESSION_BROTLI:
+      return payload::manager::v1::PAYLOAD_CODEC_BROTLI;
+    default:
+      return payload::manager::v1::PAYLOAD_CODEC_NONE;
+  }
+}
+
+std::shared_ptr<arrow::Buffer> EncodePayload(const arrow::Buffer& raw, PayloadCodec codec, CodecStats* stats) {
+  const auto start      = std::chrono::steady_clock::now();
+  auto       compressor = MakeCodec(codec);
+  const auto raw_bytes  = static_cast<uint64_t>(raw.size());
+  const auto max_bytes  = static_cast<uint64_t>(compressor->MaxCompressedLen(raw.size(), raw.data()));
+
+  auto allocated = arrow::AllocateBuffer(static_cast<int64_t>(kFrameHeaderBytes + max_bytes));
+  if (!allocated.ok()) throw std::runtime_error("encode payload: " + allocated.status().ToString());
+  std::shared_ptr<arrow::Buffer> frame(std::move(*allocated));
+
+  // Little-endian on every platform the manager builds for.
+  std::memcpy(frame->mutable_data(), &raw_bytes, kFrameHeaderBytes);
+  auto compressed = compressor->Compress(raw.size(), raw.data(), static_cast<int64_t>(max_bytes), frame->mutable_data() + kFrameHeaderBytes);
+  if (!compressed.ok()) throw std::runtime_error("encode payload (" + std::string(CodecName(codec)) + "): " + compressed.status().ToString());
+
+  // Slice rather than shrink: the frame is written and dropped, so the slack is short-lived.
+  frame = arrow::SliceBuffer(frame, 0, static_cast<int64_t>(kFrameHeaderBytes) + *compressed);
+  if (stats) {
+    stats->raw_bytes    = raw_bytes;
+    stats->stored_bytes = static_cast<uint64_t>(frame->size());
+    stats->duration_ms  = ElapsedMs(start);
+  }
+  return frame;
+}
+
+uint64_t DecodedSize(const arrow::Buffer& frame) {
+  if (static_cast<uint64_t>(frame.size()) < kFrameHeaderBytes) {
+    throw std::runtime_error("decode payload: frame is shorter than its header");
+  }
+  uint64_t raw_bytes = 0;
+  std::memcpy(&raw_bytes, frame.data(), kFrameHeaderBytes);
+  return raw_bytes;
+}
+
+void DecodePayload(const arrow::Buffer& frame, PayloadCodec codec, uint8_t* out, uint64_t out_bytes, CodecStats* stats) {
+  const auto start     = std::chrono::steady_clock::now();
+  const auto raw_bytes = DecodedSize(frame);
+  if (raw_bytes != out_bytes) {
+    throw std::runtime_error("decode payload: frame holds " + std::to_string(raw_bytes) + " bytes, destination " + std::to_string(out_bytes));
+  }
+
+  auto decompressor = MakeCodec(codec);
+  auto decompressed = decompressor->Decompress(frame.size() - static_cast<int64_t>(kFrameHeaderBytes), frame.data() + kFrameHeaderBytes,
+                                               static_cast<int64_t>(out_bytes), out);
+  if (!decompressed.ok()) {
+    throw std::runtime_error("decode payload (" + std::string(CodecName(codec)) + "): " + decompressed.status().ToString());
+  }
+  if (static_cast<uint64_t>(*decompressed) != raw_bytes) {
+    throw std::runtime_error("decode payload: frame decoded to " + std::to_string(*decompressed) + " of " + std::to_string(raw_bytes) + " bytes");
+  }
+  if (stats) {
+    stats->raw_bytes    = raw_bytes;
+    stats->stored_bytes = static_cast<uint64_t>(frame.size());
+    stats->duration_ms  = ElapsedMs(start);
+  }
+}
+
+std::shared_ptr<arrow::Buffer> DecodePayload(const arrow::Buffer& frame, PayloadCodec codec, CodecStats* stats) {
+  const auto raw_bytes = DecodedSize(frame);
+  auto       allocated = arrow::AllocateBuffer(static_cast<int64_t>(raw_bytes));
+  if (!allocated.ok()) throw std::runtime_error("decode payload: " + allocated.status().ToString());
+  std::shared_ptr<arrow::Buffer> raw(std::move(*allocated));
+  DecodePayload(frame, codec, raw->mutable_data(), raw_bytes, stats);
+  return raw;
+}
+
+TranscodeResult TranscodePayload(StorageBackend& source, const payload::manager::v1::PayloadID& source_id, StorageBackend& target,
+                                 const payload::manager::v1::PayloadID& target_id, bool fsync, PayloadCodec source_codec, PayloadCodec target_codec,
+                                 const TransferOptions& options) {
+  TranscodeResult result;
+  Crc32c          crc;
+  Crc32c*         checksum          = options.checksum ? &crc : nullptr;
+  const bool      source_compressed = IsCompressed(source_codec);
+  const bool      target_compressed = IsCompressed(target_codec);
+  if (source_codec == target_codec || (!source_compressed && !target_compressed)) {
+    // A frame copied as-is is never decoded, so there is no raw checksum to take.
+    if (target_compressed) checksum = nullptr;
+    if (source_id.value() == target_id.value()) {
+      CopyPayload(source, target, source_id, fsync, options, checksum);
+    } else {
+      CopyPayload(source, source_id, target, target_id, fsync, options, checksum);
+    }
+    if (target_compressed) result.stored_bytes = source.Size(source_id);
+    if (checksum) result.checksum = checksum->Value();
+    return result;
+  }
+
+  if (!Streams(source_codec) || !Streams(target_codec)) {
+    result = TranscodeWhole(source, source_id, target, target_id, fsync, source_codec, target_codec, checksum);
+    if (checksum) result.checksum = checksum->Value();
+    return result;
+  }
+
+  ChunkedSource  input(source, source_id);
+  const uint64_t chunk_bytes = std::max({options.chunk_bytes, input.PreferredReadBytes(), uint64_t{1}});
+  const uint64_t raw_bytes   = source_compressed ? FrameRawBytes(input) : input.Size();
+  // Sized for the raw payload; a disk target settles its reservation on the frame actually written.
+  auto writer = target.OpenWriter(target_id, raw_bytes, fsync);
+  if (!writer) {
+    result = TranscodeWhole(source, source_id, target, target_id, fsync, source_codec, target_codec, checksum);
+    if (checksum) result.checksum = checksum->Value();
+    return result;
+  }
+
+  if (!source_compressed) {
+    FrameEncoder         encoder(target_codec, raw_bytes, chunk_bytes, *writer);
+    std::vector<uint8_t> scratch;
+    for (uint64_t offset = 0; offset < raw_bytes; offset += chunk_bytes) {
+      const uint64_t length = std::min(chunk_bytes, raw_bytes - offset);
+      const uint8_t* data   = input.At(offset, length, scratch);
+      if (checksum) checksum->Update(data, length);
+      encoder.Append(data, length);
+    }
+    result.encode = encoder.Finish();
+  } else if (!target_compressed) {
+    uint8_t* destination = writer->Destination();
+    result.decode        = DecodeFrame(input, source_codec, raw_bytes, chunk_bytes, destination, [&](const uint8_t* data, uint64_t length) {
+      if (checksum) checksum->Update(data, length);
+      if (!destination) writer->Append(data, length);
+    });
+  } else {
+    FrameEncoder encoder(target_codec, raw_bytes, chunk_bytes, *writer);
+    result.decode = DecodeFrame(input, source_codec, raw_bytes, chunk_bytes, nullptr, [&](const uint8_t* data, uint64_t length) {
+      if (checksum) checksum->Update(data, length);
+      encoder.Append(data, length);
+    });
+    result.encode = encoder.Finish();
+  }
+  writer->Commit();
+  if (target_compressed) result.stored_bytes = result.encode.stored_bytes;
+  if (checksum) result.checksum = checksum->Value();
+  return result;
+}
+
+} // namespace payload::storage
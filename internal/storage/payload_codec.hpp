@@ -0,0 +1,103 @@
+#pragma once
+
+#include <arrow/buffer.h>
+#include <arrow/util/type_fwd.h>
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+#include "payload/manager/v1.hpp"
+#include "payload_transfer.hpp"
+#include "storage_backend.hpp"
+
+namespace payload::storage {
+
+/*
+  Durable-tier payload compression.
+
+  A compressed payload is stored as one frame:
+
+    [8-byte little-endian uncompressed length][codec output]
+
+  so decoding knows the output size before it starts and can write straight
+  into a destination allocated up front. UNSPECIFIED and NONE store the raw
+  bytes with no frame.
+*/
+
+// Time and bytes of one encode or decode, for the compression metrics.
+struct CodecStats {
+  uint64_t raw_bytes    = 0;
+  uint64_t stored_bytes = 0;
+  double   duration_ms  = 0;
+};
+
+// True when codec stores a frame rather than the raw bytes.
+bool IsCompressed(payload::manager::v1::PayloadCodec codec);
+
+// Lowercase codec name ("none", "lz4", "zstd", ...) for logs and metric labels.
+std::string_view CodecName(payload::manager::v1::PayloadCodec codec);
+
+// Maps a resolved Arrow compression onto a payload codec; UNCOMPRESSED is
+// NONE. Throws std::runtime_error for codecs without one-shot support (LZO,
+// BZ2) or that Arrow was built without.
+payload::manager::v1::PayloadCodec ToPayloadCodec(arrow::Compression::type type);
+
+// Sidecar CompressionType for codec, and back.
+payload::manager::catalog::v1::CompressionType ToArchiveCompression(payload::manager::v1::PayloadCodec codec);
+payload::manager::v1::PayloadCodec             FromArchiveCompression(payload::manager::catalog::v1::CompressionType type);
+
+// Compresses raw into a frame. Throws std::runtime_error on codec failure.
+std::shared_ptr<arrow::Buffer> EncodePayload(const arrow::Buffer& raw, payload::manager::v1::PayloadCodec codec, CodecStats* stats = nullptr);
+
+// Uncompressed length recorded in a frame's header.
+uint64_t DecodedSize(const arrow::Buffer& frame);
+
+// Decompresses frame into out, which must hold exactly DecodedSize(frame)
+// bytes. Throws std::runtime_error on a truncated or corrupt frame.
+void DecodePayload(const arrow::Buffer& frame, payload::manager::v1::PayloadCodec codec, uint8_t* out, uint64_t out_bytes,
+                   CodecStats* stats = nullptr);
+
+std::shared_ptr<arrow::Buffer> DecodePayload(const arrow::Buffer& frame, payload::manager::v1::PayloadCodec codec, CodecStats* stats = nullptr);
+
+struct TranscodeResult {
+  // Frame bytes now on the target; 0 when it holds the raw payload.
+  uint64_t   stored_bytes = 0;
+  // Set when the copy decoded / encoded (raw_bytes == 0 otherwise).
+  CodecStats decode;
+  CodecStats encode;
+  // CRC32C of the raw payload, when options.checksum is set and the copy
+  // saw raw bytes (not for a compressed payload copied as-is).
+  std::optional<uint32_t> checksum;
+};
+
+/*
+  Copy one payload from source to target (spill / promote), converting it
+  from source_codec to target_codec. source_id and target_id differ when
+  one side is a content-addressed blob.
+
+  When both sides store the same bytes (equal codecs, or both raw) this is
+  CopyPayload, so kernel-side and chunked copies still apply. Otherwise the
+  payload streams through the codec in options.chunk_bytes chunks: read
+  via the source's PayloadReader (or in place from Read(), a mapping for
+  RAM), compressed or decompressed chunk by chunk, and appended to the
+  target's PayloadWriter, so memory stays bounded by a few chunks whatever
+  the payload size. A raw target that places the payload in memory up
+  front (RAM) is decoded straight into its mapping. Snappy, which Arrow
+  can only run one-shot, and targets without a writer fall back to
+  transcoding the whole payload in memory.
+
+  With options.checksum the raw bytes are hashed on the way: fused with
+  the copy when no codec is involved (see CopyPayload), otherwise over
+  each chunk handed to the encoder or produced by the decoder, whose own
+  pass dominates.
+
+  Throws whatever the backends or codecs throw; a failed copy leaves
+  nothing in the target.
+*/
+TranscodeResult TranscodePayload(StorageBackend& source, const payload::manager::v1::PayloadID& source_id, StorageBackend& target,
+                                 const payload::manager::v1::PayloadID& target_id, bool fsync, payload::manager::v1::PayloadCodec source_codec,
+                                 payload::manager::v1::PayloadCodec target_codec, const TransferOptions& options);
+
+} // namespace payload::storage
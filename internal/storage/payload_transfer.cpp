@@ -0,0 +1,194 @@
+#include "payload_transfer.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace payload::storage {
+
+namespace {
+
+// Checksummed copies move bytes in slices this size so each slice is still
+// in cache when the second touch (hash, append, or fused copy) reads it.
+constexpr uint64_t kHashSliceBytes = uint64_t{1} << 20;
+
+struct Chunk {
+  std::size_t slot   = 0;
+  uint64_t    length = 0;
+};
+
+void CopySerial(PayloadReader& reader, PayloadWriter& writer, uint64_t size, uint64_t chunk_bytes, Crc32c* checksum) {
+  auto buffer = std::make_unique_for_overwrite<uint8_t[]>(static_cast<std::size_t>(std::min(size, chunk_bytes)));
+  for (uint64_t offset = 0; offset < size; offset += chunk_bytes) {
+    const uint64_t length = std::min(chunk_bytes, size - offset);
+    reader.ReadAt(offset, buffer.get(), length);
+    if (checksum) checksum->Update(buffer.get(), length);
+    writer.Append(buffer.get(), length);
+  }
+}
+
+/*
+  Reads into the target's mapping. With a checksum, a reader without a
+  preferred read size (a local file) is staged through one cache-sized
+  slice and copied in with the fused kernel, so the destination is written
+  once and never read back; a ranged reader keeps its large reads and each
+  chunk is hashed as it lands.
+*/
+void CopyToDestination(PayloadReader& reader, uint8_t* destination, uint64_t size, uint64_t chunk_bytes, Crc32c* checksum) {
+  if (checksum && reader.PreferredReadBytes() == 0) {
+    auto staging = std::make_unique_for_overwrite<uint8_t[]>(static_cast<std::size_t>(std::min(size, kHashSliceBytes)));
+    for (uint64_t offset = 0; offset < size; offset += kHashSliceBytes) {
+      const uint64_t length = std::min(kHashSliceBytes, size - offset);
+      reader.ReadAt(offset, staging.get(), length);
+      checksum->CopyAndUpdate(destination + offset, staging.get(), length);
+    }
+    return;
+  }
+  for (uint64_t offset = 0; offset < size; offset += chunk_bytes) {
+    const uint64_t length = std::min(chunk_bytes, size - offset);
+    reader.ReadAt(offset, destination + offset, length);
+    if (checksum) checksum->Update(destination + offset, length);
+  }
+}
+
+void CopyBuffer(const std::shared_ptr<arrow::Buffer>& buffer, StorageBackend& target, const payload::manager::v1::PayloadID& id, bool fsync,
+                Crc32c* checksum) {
+  auto writer = checksum ? target.OpenWriter(id, static_cast<uint64_t>(buffer->size()), fsync) : nullptr;
+  if (!writer) {
+    if (checksum) checksum->Update(buffer->data(), static_cast<uint64_t>(buffer->size()));
+    target.Write(id, buffer, fsync);
+    return;
+  }
+
+  const auto size = static_cast<uint64_t>(buffer->size());
+  if (uint8_t* destination = writer->Destination()) {
+    checksum->CopyAndUpdate(destination, buffer->data(), size);
+  } else {
+    for (uint64_t offset = 0; offset < size; offset += kHashSliceBytes) {
+      const uint64_t length = std::min(kHashSliceBytes, size - offset);
+      checksum->Update(buffer->data() + offset, length);
+      writer->Append(buffer->data() + offset, length);
+    }
+  }
+  writer->Commit();
+}
+
+/*
+  Producer / consumer over depth chunk buffers: a helper thread reads into
+  free slots, the calling thread appends filled slots in order. Either side
+  failing stops the other; the reader's exception wins if both fail.
+*/
+void CopyPipelined(PayloadReader& reader, PayloadWriter& writer, uint64_t size, uint64_t chunk_bytes, uint32_t depth, Crc32c* checksum) {
+  std::vector<std::unique_ptr<uint8_t[]>> slots(depth);
+  std::vector<std::size_t>                free_slots;
+  for (std::size_t i = 0; i < depth; ++i) {
+    free_slots.push_back(i);
+  }
+
+  std::mutex              mutex;
+  std::condition_variable cv;
+  std::deque<Chunk>       filled;
+  bool                    reading_done = false;
+  bool                    stop         = false;
+  std::exception_ptr      read_error;
+
+  std::thread producer([&] {
+    try {
+      for (uint64_t offset = 0; offset < size; offset += chunk_bytes) {
+        std::size_t slot = 0;
+        {
+          std::unique_lock lock(mutex);
+          cv.wait(lock, [&] { return stop || !free_slots.empty(); });
+          if (stop) break;
+          slot = free_slots.back();
+          free_slots.pop_back();
+        }
+        if (!slots[slot]) {
+          slots[slot] = std::make_unique_for_overwrite<uint8_t[]>(static_cast<std::size_t>(chunk_bytes));
+        }
+        const uint64_t length = std::min(chunk_bytes, size - offset);
+        reader.ReadAt(offset, slots[slot].get(), length);
+        if (checksum) checksum->Update(slots[slot].get(), length);
+
+        std::lock_guard lock(mutex);
+        filled.push_back({slot, length});
+        cv.notify_all();
+      }
+    } catch (...) {
+      std::lock_guard lock(mutex);
+      read_error = std::current_exception();
+    }
+    std::lock_guard lock(mutex);
+    reading_done = true;
+    cv.notify_all();
+  });
+
+  std::exception_ptr write_error;
+  for (uint64_t written = 0; written < size;) {
+    Chunk chunk;
+    {
+      std::unique_lock lock(mutex);
+      cv.wait(lock, [&] { return reading_done || !filled.empty(); });
+      if (filled.empty()) break; // reader failed
+      chunk = filled.front();
+      filled.pop_front();
+    }
+    try {
+      writer.Append(slots[chunk.slot].get(), chunk.length);
+    } catch (...) {
+      write_error = std::current_exception();
+      std::lock_guard lock(mutex);
+      stop = true;
+      cv.notify_all();
+      break;
+    }
+    written += chunk.length;
+
+    std::lock_guard lock(mutex);
+    free_slots.push_back(chunk.slot);
+    cv.notify_all();
+  }
+
+  producer.join();
+  if (read_error) std::rethrow_exception(read_error);
+  if (write_error) std::rethrow_exception(write_error);
+}
+
+} // namespace
+
+void CopyPayload(StorageBackend& source, StorageBackend& target, const payload::manager::v1::PayloadID& id, bool fsync,
+                 const TransferOptions& options, Crc32c* checksum) {
+  if (!checksum && source.TransferTo(target, id, fsync)) {
+    return;
+  }
+  CopyPayload(source, id, target, id, fsync, options, checksum);
+}
+
+void CopyPayload(StorageBackend& source, const payload::manager::v1::PayloadID& source_id, StorageBackend& target,
+                 const payload::manager::v1::PayloadID& target_id, bool fsync, const TransferOptions& options, Crc32c* checksum) {
+  auto reader = source.OpenReader(source_id);
+  auto writer = reader ? target.OpenWriter(target_id, reader->Size(), fsync) : nullptr;
+  if (!writer) {
+    CopyBuffer(source.Read(source_id), target, target_id, fsync, checksum);
+    return;
+  }
+
+  const uint64_t size        = reader->Size();
+  const uint64_t chunk_bytes = std::max<uint64_t>({options.chunk_bytes, reader->PreferredReadBytes(), 1});
+  if (uint8_t* destination = writer->Destination()) {
+    CopyToDestination(*reader, destination, size, chunk_bytes, checksum);
+  } else if (size <= chunk_bytes) {
+    CopySerial(*reader, *writer, size, chunk_bytes, checksum);
+  } else {
+    CopyPipelined(*reader, *writer, size, chunk_bytes, std::max<uint32_t>(options.depth, 2), checksum);
+  }
+  writer->Commit();
+}
+
+} // namespace payload::storage
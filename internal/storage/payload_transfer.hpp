@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+
+#include "checksum.hpp"
+#include "payload/manager/v1.hpp"
+#include "storage_backend.hpp"
+
+namespace payload::storage {
+
+struct TransferOptions {
+  // Size of each staged chunk.
+  uint64_t chunk_bytes = uint64_t{8} << 20;
+  // Chunk buffers per transfer (at least 2: one being read, one written).
+  // Bounds transient memory at chunk_bytes * depth (chunk_bytes grows to
+  // the reader's PreferredReadBytes() when that is larger).
+  uint32_t depth = 4;
+  // Checksum the raw bytes of each spill / promotion (TranscodePayload) so
+  // corruption on a durable tier is caught when the payload comes back.
+  bool checksum = true;
+};
+
+/*
+  Copy one payload from source to target (spill / promote).
+
+  Tries, in order:
+    1. source.TransferTo(target)        — kernel-side copy
+    2. source.OpenReader + OpenWriter   — chunked copy:
+       a. into writer->Destination()    — reads land in the target's
+                                          mapping (DISK → RAM promotion)
+       b. through staging buffers       — pipelined
+    3. target.Write(source.Read())      — whole-payload buffer
+
+  2a reads chunk by chunk straight into the destination, so each byte is
+  copied once. 2b reads chunk N+1 on a helper thread while chunk N is
+  appended to the target, holding at most depth chunk buffers. Neither
+  materializes the payload in heap memory; payloads that fit in one chunk
+  are copied on the calling thread. Chunks grow to the reader's
+  PreferredReadBytes() when that is larger, so a reader that splits each
+  ReadAt into parallel range requests keeps all of them busy.
+
+  With a checksum the bytes are also folded into it as they move rather
+  than in a second pass over the payload: copies into
+  writer->Destination() from a local reader or a buffer go through
+  Crc32c::CopyAndUpdate, chunks from a ranged reader or bound for Append
+  are hashed while still in cache. The kernel-side copy (1) is skipped
+  since it never surfaces the bytes.
+
+  Throws whatever the backends throw; a failed chunked copy leaves nothing
+  in the target.
+*/
+void CopyPayload(StorageBackend& source, StorageBackend& target, const payload::manager::v1::PayloadID& id, bool fsync,
+                 const TransferOptions& options, Crc32c* checksum = nullptr);
+
+// As above, with the payload stored under different keys on the two tiers
+// (a content-addressed blob on one side). Skips the kernel-side copy,
+// which assumes one key.
+void CopyPayload(StorageBackend& source, const payload::manager::v1::PayloadID& source_id, StorageBackend& target,
+                 const payload::manager::v1::PayloadID& target_id, bool fsync, const TransferOptions& options, Crc32c* checksum = nullptr);
+
+} // namespace payload::storage
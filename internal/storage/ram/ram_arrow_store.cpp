@@ -3,15 +3,26 @@
 #include <arrow/buffer.h>
 #include <arrow/memory_pool.h>
 #include <fcntl.h>
+#include <linux/mempolicy.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/vfs.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <bit>
 #include <cerrno>
 #include <cstring>
+#include <filesystem>
+#include <limits>
 #include <stdexcept>
 #include <string>
+#include <system_error>
+#include <utility>
 
+#include "internal/observability/logging.hpp"
+#include "internal/util/errors.hpp"
 #include "internal/util/uuid.hpp"
 #include "payload/manager/v1.hpp"
 
@@ -20,19 +31,21 @@ namespace payload::storage {
 using namespace payload::manager::v1;
 
 // ---------------------------------------------------------------------------
-// ShmBuffer — Arrow buffer backed by a POSIX shm mmap.
+// ShmBuffer — Arrow buffer backed by a POSIX shm (or hugetlbfs) mmap.
 // Closes fd and munmaps on destruction; does NOT unlink (caller's job).
+// The mapping may be longer than the buffer (huge-page rounding).
 // ---------------------------------------------------------------------------
 namespace {
 
 class ShmBuffer final : public arrow::MutableBuffer {
  public:
-  ShmBuffer(void* ptr, int64_t size, int fd) : arrow::MutableBuffer(static_cast<uint8_t*>(ptr), size), ptr_(ptr), size_(size), fd_(fd) {
+  ShmBuffer(void* ptr, int64_t size, size_t mapped_size, int fd)
+      : arrow::MutableBuffer(static_cast<uint8_t*>(ptr), size), ptr_(ptr), mapped_size_(mapped_size), fd_(fd) {
   }
 
   ~ShmBuffer() override {
     if (ptr_ && ptr_ != MAP_FAILED) {
-      munmap(ptr_, static_cast<size_t>(size_));
+      munmap(ptr_, mapped_size_);
     }
     if (fd_ >= 0) {
       close(fd_);
@@ -40,9 +53,100 @@ class ShmBuffer final : public arrow::MutableBuffer {
   }
 
  private:
-  void*   ptr_;
-  int64_t size_;
-  int     fd_;
+  void*  ptr_;
+  size_t mapped_size_;
+  int    fd_;
+};
+
+constexpr long kHugetlbfsMagic = 0x958458f6;
+
+// ---------------------------------------------------------------------------
+// Slab arena layout
+//
+//   [SlabHeader][BlockRecord x block_count][pad to page][block 0][block 1]...
+//
+// A BlockRecord with length_bytes == 0 marks a free block.
+// ---------------------------------------------------------------------------
+constexpr uint64_t kSlabMagic       = 0x3130424c41534d50ull; // "PMSLAB01"
+constexpr uint64_t kSlabHeaderBytes = 64;
+constexpr uint64_t kSlabPageBytes   = 4096;
+
+struct SlabHeader {
+  uint64_t magic;
+  uint64_t block_bytes;
+  uint64_t block_count;
+  uint64_t data_offset;
+  uint64_t numa_node; // bound node + 1; 0 = unbound
+};
+static_assert(sizeof(SlabHeader) <= kSlabHeaderBytes, "slab header must fit its reserved bytes");
+
+struct BlockRecord {
+  uint8_t  payload_id[16];
+  uint64_t length_bytes;
+};
+static_assert(sizeof(BlockRecord) == 24, "slab block records are packed");
+
+uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+uint8_t* ArenaBase(const std::shared_ptr<arrow::Buffer>& mapping) {
+  return reinterpret_cast<uint8_t*>(mapping->mutable_data());
+}
+
+BlockRecord* RecordAt(const std::shared_ptr<arrow::Buffer>& mapping, uint64_t block_index) {
+  return reinterpret_cast<BlockRecord*>(ArenaBase(mapping) + kSlabHeaderBytes) + block_index;
+}
+
+/*
+  Fills a segment placed by Allocate (DISK → RAM promotion without a
+  whole-payload heap buffer), either by Append or by the source reading
+  into Destination(). Until Commit the placement is removed again on
+  destruction.
+*/
+class RamPayloadWriter final : public PayloadWriter {
+ public:
+  RamPayloadWriter(RamArrowStore& store, PayloadID id, std::shared_ptr<arrow::Buffer> buffer)
+      : store_(store), id_(std::move(id)), buffer_(std::move(buffer)) {
+  }
+
+  ~RamPayloadWriter() override {
+    if (!committed_) {
+      try {
+        store_.Remove(id_);
+      } catch (const std::exception&) {
+        // Leaves an orphaned segment; nothing in the catalog points at it.
+      }
+    }
+  }
+
+  void Append(const uint8_t* data, uint64_t length) override {
+    if (length > static_cast<uint64_t>(buffer_->size()) - written_) {
+      throw std::runtime_error("ram write: append past the allocated " + std::to_string(buffer_->size()) + " bytes");
+    }
+    std::memcpy(buffer_->mutable_data() + written_, data, static_cast<size_t>(length));
+    written_ += length;
+  }
+
+  uint8_t* Destination() override {
+    filled_in_place_ = true;
+    return buffer_->mutable_data();
+  }
+
+  void Commit() override {
+    if (!filled_in_place_ && written_ != static_cast<uint64_t>(buffer_->size())) {
+      throw std::runtime_error("ram write: " + std::to_string(written_) + " of " + std::to_string(buffer_->size()) + " bytes written");
+    }
+    committed_ = true;
+  }
+
+ private:
+  RamArrowStore&                 store_;
+  PayloadID                      id_;
+  std::shared_ptr<arrow::Buffer> buffer_;
+  uint64_t                       written_         = 0;
+  bool                           filled_in_place_ = false;
+  bool                           committed_       = false;
 };
 
 } // namespace
@@ -51,6 +155,42 @@ class ShmBuffer final : public arrow::MutableBuffer {
 // Helpers
 // ---------------------------------------------------------------------------
 
+RamArrowStore::RamArrowStore(std::string shm_prefix, RamSlabOptions slab_options, RamHugePageOptions huge_page_options,
+                             RamNumaOptions numa_options)
+    : shm_prefix_(std::move(shm_prefix)),
+      slab_options_(slab_options),
+      huge_page_mount_(std::move(huge_page_options.mount_path)),
+      numa_nodes_(std::move(numa_options.nodes)) {
+  for (std::size_t i = 0; i < numa_nodes_.size(); ++i) {
+    const auto node = numa_nodes_[i].node;
+    if (node >= kMaxNumaNodes) {
+      throw std::invalid_argument("RAM NUMA node " + std::to_string(node) + " is out of range (max " + std::to_string(kMaxNumaNodes - 1) + ")");
+    }
+    if (NodeIndex(static_cast<int32_t>(node)) != i) {
+      throw std::invalid_argument("RAM NUMA node " + std::to_string(node) + " is configured twice");
+    }
+  }
+  node_used_bytes_.resize(numa_nodes_.size());
+
+  if (slab_options_.enabled && slab_options_.max_block_bytes >= kMinBlockBytes) {
+    const auto max_block = std::bit_ceil(slab_options_.max_block_bytes);
+    size_class_count_    = static_cast<std::size_t>(std::countr_zero(max_block) - std::countr_zero(kMinBlockBytes)) + 1;
+  }
+  open_slabs_.resize(size_class_count_ * std::max<std::size_t>(numa_nodes_.size(), 1));
+  RecoverSlabs();
+
+  if (huge_page_options.enabled) {
+    // statfs on a hugetlbfs mount reports its huge page size as the block size.
+    struct statfs fs {};
+    if (statfs(huge_page_mount_.c_str(), &fs) == 0 && static_cast<long>(fs.f_type) == kHugetlbfsMagic && fs.f_bsize > 0) {
+      huge_page_bytes_ = static_cast<uint64_t>(fs.f_bsize);
+    } else {
+      PAYLOAD_LOG_WARN("huge pages requested but the mount is not hugetlbfs; RAM segments use base pages",
+                       {payload::observability::StringField("path", huge_page_mount_)});
+    }
+  }
+}
+
 /*static*/
 std::string RamArrowStore::Key(const PayloadID& id) {
   if (id.value().size() == 16) {
@@ -71,11 +211,16 @@ std::string RamArrowStore::ShmName(const PayloadID& id, const std::string& prefi
   return "/" + prefix + "-" + Key(id);
 }
 
+std::string RamArrowStore::SlabName(uint32_t slab_id) const {
+  return "/" + shm_prefix_ + "-slab-" + std::to_string(slab_id);
+}
+
 /*static*/
-std::shared_ptr<arrow::Buffer> RamArrowStore::OpenShm(const std::string& name, size_t size_bytes, bool writable) {
-  int fd = -1;
+std::shared_ptr<arrow::Buffer> RamArrowStore::OpenShm(const std::string& name, size_t size_bytes, ShmMode mode) {
+  const bool writable = mode != ShmMode::kReadOnly;
+  int        fd       = -1;
 
-  if (writable) {
+  if (mode == ShmMode::kCreate) {
     fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0666);
     if (fd < 0) {
       throw std::runtime_error("shm_open(create) failed for " + name + ": " + strerror(errno));
@@ -93,7 +238,7 @@ std::shared_ptr<arrow::Buffer> RamArrowStore::OpenShm(const std::string& name, s
       throw std::runtime_error("ftruncate failed for " + name + ": " + strerror(saved));
     }
   } else {
-    fd = shm_open(name.c_str(), O_RDONLY, 0);
+    fd = shm_open(name.c_str(), writable ? O_RDWR : O_RDONLY, 0);
     if (fd < 0) {
       throw std::runtime_error("shm_open(read) failed for " + name + ": " + strerror(errno));
     }
@@ -118,72 +263,730 @@ std::shared_ptr<arrow::Buffer> RamArrowStore::OpenShm(const std::string& name, s
     throw std::runtime_error("mmap failed for " + name + ": " + strerror(saved));
   }
 
-  return std::make_shared<ShmBuffer>(ptr, static_cast<int64_t>(size_bytes), fd);
+  return std::make_shared<ShmBuffer>(ptr, static_cast<int64_t>(size_bytes), size_bytes, fd);
 }
 
 // ---------------------------------------------------------------------------
-// StorageBackend implementation
+// Huge pages
 // ---------------------------------------------------------------------------
 
+std::string RamArrowStore::HugePagePath(const PayloadID& id) const {
+  return huge_page_mount_ + ShmName(id);
+}
+
+bool RamArrowStore::UsesHugePages(uint64_t size_bytes) const {
+  // Below one huge page the rounding would waste more than the TLB saves.
+  return huge_page_bytes_ != 0 && size_bytes >= huge_page_bytes_;
+}
+
+std::shared_ptr<arrow::Buffer> RamArrowStore::OpenHugePageSegment(const PayloadID& id, uint64_t size_bytes, ShmMode mode, int32_t numa_node) {
+  const auto path     = HugePagePath(id);
+  const bool writable = mode != ShmMode::kReadOnly;
+
+  // hugetlbfs files must be sized in whole huge pages; the last 8 bytes hold
+  // the payload length so a re-open recovers it.
+  uint64_t mapped_bytes = 0;
+  int      fd           = -1;
+  if (mode == ShmMode::kCreate) {
+    mapped_bytes = AlignUp(size_bytes + sizeof(uint64_t), huge_page_bytes_);
+    fd           = open(path.c_str(), O_CREAT | O_RDWR, 0666);
+    if (fd >= 0) {
+      (void)fchmod(fd, 0666);
+      if (ftruncate(fd, static_cast<off_t>(mapped_bytes)) != 0) {
+        close(fd);
+        fd = -1;
+      }
+    }
+  } else {
+    fd = open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+    struct stat st {};
+    if (fd >= 0 && fstat(fd, &st) == 0) {
+      mapped_bytes = static_cast<uint64_t>(st.st_size);
+    }
+  }
+
+  // MAP_SHARED on hugetlbfs reserves the pages up front, so an exhausted
+  // pool fails here rather than with SIGBUS on first touch.
+  void* ptr = MAP_FAILED;
+  if (fd >= 0 && mapped_bytes > sizeof(uint64_t)) {
+    ptr = mmap(nullptr, mapped_bytes, writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd, 0);
+  }
+  if (ptr == MAP_FAILED) {
+    const int saved = errno;
+    if (fd >= 0) {
+      close(fd);
+    }
+    if (mode == ShmMode::kCreate) {
+      unlink(path.c_str());
+      if (huge_page_fallbacks_.fetch_add(1, std::memory_order_relaxed) == 0) {
+        PAYLOAD_LOG_WARN("huge page segment unavailable; falling back to base pages",
+                         {payload::observability::StringField("path", path), payload::observability::StringField("error", strerror(saved))});
+      }
+    }
+    return nullptr;
+  }
+
+  auto* footer = static_cast<uint8_t*>(ptr) + mapped_bytes - sizeof(uint64_t);
+  if (mode == ShmMode::kCreate) {
+    BindToNode(ptr, mapped_bytes, numa_node);
+    std::memcpy(footer, &size_bytes, sizeof(size_bytes));
+  } else {
+    std::memcpy(&size_bytes, footer, sizeof(size_bytes));
+    if (size_bytes == 0 || size_bytes > mapped_bytes - sizeof(uint64_t)) {
+      munmap(ptr, mapped_bytes);
+      close(fd);
+      return nullptr;
+    }
+  }
+  return std::make_shared<ShmBuffer>(ptr, static_cast<int64_t>(size_bytes), static_cast<size_t>(mapped_bytes), fd);
+}
+
+void RamArrowStore::UnlinkDedicated(const PayloadID& id, bool huge_pages) const {
+  // best-effort; ignore error if already gone
+  if (huge_pages) {
+    unlink(HugePagePath(id).c_str());
+  } else {
+    shm_unlink(ShmName(id).c_str());
+  }
+}
+
+RamArrowStore::Entry RamArrowStore::CreateDedicated(const PayloadID& id, uint64_t size_bytes, int32_t numa_node) {
+  Entry entry;
+  entry.numa_node = numa_node;
+  if (UsesHugePages(size_bytes)) {
+    entry.buffer     = OpenHugePageSegment(id, size_bytes, ShmMode::kCreate, numa_node);
+    entry.huge_pages = entry.buffer != nullptr;
+  }
+  if (!entry.buffer) {
+    entry.buffer = OpenShm(ShmName(id), static_cast<size_t>(size_bytes), ShmMode::kCreate);
+    BindToNode(entry.buffer->mutable_data(), static_cast<std::size_t>(size_bytes), numa_node);
+  }
+  return entry;
+}
+
+// ---------------------------------------------------------------------------
+// NUMA placement
+// ---------------------------------------------------------------------------
+
+std::optional<std::size_t> RamArrowStore::NodeIndex(int32_t numa_node) const {
+  for (std::size_t i = 0; i < numa_nodes_.size(); ++i) {
+    if (static_cast<int32_t>(numa_nodes_[i].node) == numa_node) {
+      return i;
+    }
+  }
+  return std::nullopt;
+}
+
+int32_t RamArrowStore::SelectNodeLocked(std::optional<uint32_t> hint) const {
+  if (numa_nodes_.empty()) {
+    return kNoNumaNode;
+  }
+  if (hint) {
+    if (*hint >= kMaxNumaNodes || !NodeIndex(static_cast<int32_t>(*hint))) {
+      throw payload::util::InvalidArgument("allocate payload: numa_node " + std::to_string(*hint) + " is not a configured RAM node");
+    }
+    return static_cast<int32_t>(*hint);
+  }
+
+  // Unhinted payloads go where the most capacity is left.
+  std::size_t best      = 0;
+  int64_t     best_free = std::numeric_limits<int64_t>::min();
+  for (std::size_t i = 0; i < numa_nodes_.size(); ++i) {
+    const auto free_bytes = static_cast<int64_t>(numa_nodes_[i].capacity_bytes) - static_cast<int64_t>(node_used_bytes_[i]);
+    if (free_bytes > best_free) {
+      best      = i;
+      best_free = free_bytes;
+    }
+  }
+  return static_cast<int32_t>(numa_nodes_[best].node);
+}
+
 /*
-  Allocate: create the shm segment so the client can map and write into it.
-  The server holds the mmap'd buffer so spill/promotion can read it.
+  Sets a preferred-node policy on [addr, addr + length). On shm and
+  hugetlbfs mappings the policy belongs to the shared object, so pages
+  faulted later by a client mapping land on the node too. Preferred rather
+  than strict binding: a full node spills to another instead of the
+  faulting process taking SIGBUS.
 */
+void RamArrowStore::BindToNode(void* addr, std::size_t length, int32_t numa_node) const {
+  if (numa_node < 0 || length == 0) {
+    return;
+  }
+  const unsigned long mask = 1ul << numa_node;
+  // maxnode counts bits plus one; see mbind(2).
+  if (syscall(SYS_mbind, addr, length, MPOL_PREFERRED, &mask, sizeof(mask) * 8 + 1, 0) != 0 && !bind_failure_logged_.exchange(true)) {
+    PAYLOAD_LOG_WARN("mbind failed; RAM segments are not NUMA-bound",
+                     {payload::observability::IntField("node", numa_node), payload::observability::StringField("error", strerror(errno))});
+  }
+}
+
+int32_t RamArrowStore::ResidentNode(const std::shared_ptr<arrow::Buffer>& buffer) const {
+  if (numa_nodes_.empty() || !buffer || buffer->size() == 0) {
+    return kNoNumaNode;
+  }
+  int node = kNoNumaNode;
+  if (syscall(SYS_get_mempolicy, &node, nullptr, 0, buffer->data(), MPOL_F_NODE | MPOL_F_ADDR) != 0) {
+    return kNoNumaNode;
+  }
+  return node;
+}
+
+void RamArrowStore::AccountNodeLocked(const Entry& entry, int sign) {
+  const auto index = NodeIndex(entry.numa_node);
+  if (!index || !entry.buffer) {
+    return;
+  }
+  const auto bytes = static_cast<uint64_t>(entry.buffer->size());
+  if (sign > 0) {
+    node_used_bytes_[*index] += bytes;
+  } else {
+    node_used_bytes_[*index] -= std::min(bytes, node_used_bytes_[*index]);
+  }
+}
+
+std::vector<RamNodeUsage> RamArrowStore::NodeUsage() const {
+  std::vector<RamNodeUsage> usage;
+  usage.reserve(numa_nodes_.size());
+  std::shared_lock lock(mutex_);
+  for (std::size_t i = 0; i < numa_nodes_.size(); ++i) {
+    usage.push_back({numa_nodes_[i].node, numa_nodes_[i].capacity_bytes, node_used_bytes_[i]});
+  }
+  return usage;
+}
+
+std::optional<uint32_t> RamArrowStore::NumaNode(const PayloadID& id) const {
+  std::shared_lock lock(mutex_);
+  const auto       it = entries_.find(Key(id));
+  if (it == entries_.end() || it->second.numa_node < 0) {
+    return std::nullopt;
+  }
+  return static_cast<uint32_t>(it->second.numa_node);
+}
+
+// ---------------------------------------------------------------------------
+// Slab allocator
+// ---------------------------------------------------------------------------
+
+std::size_t RamArrowStore::BlockSizeClass(uint64_t block_bytes) const {
+  if (block_bytes < kMinBlockBytes || !std::has_single_bit(block_bytes)) {
+    return kNoSizeClass;
+  }
+  const auto size_class = static_cast<std::size_t>(std::countr_zero(block_bytes) - std::countr_zero(kMinBlockBytes));
+  return size_class < size_class_count_ ? size_class : kNoSizeClass;
+}
+
+std::size_t RamArrowStore::SizeClass(const PayloadID& id, uint64_t size_bytes) const {
+  // Block records store the raw 16-byte id, so only binary UUIDs live in slabs.
+  if (size_class_count_ == 0 || size_bytes == 0 || id.value().size() != 16) {
+    return kNoSizeClass;
+  }
+  return BlockSizeClass(std::bit_ceil(std::max(size_bytes, kMinBlockBytes)));
+}
+
+std::vector<uint32_t>& RamArrowStore::OpenSlabsLocked(std::size_t size_class, int32_t numa_node) {
+  return open_slabs_[NodeIndex(numa_node).value_or(0) * size_class_count_ + size_class];
+}
+
+uint32_t RamArrowStore::CreateSlabLocked(std::size_t size_class, int32_t numa_node) {
+  const uint64_t block_bytes = kMinBlockBytes << size_class;
+  const uint64_t arena_bytes = slab_options_.arena_bytes;
+
+  // Size the directory for the most blocks that could fit, then hand the
+  // page-aligned remainder to blocks.
+  const uint64_t max_blocks  = arena_bytes > kSlabHeaderBytes ? (arena_bytes - kSlabHeaderBytes) / (block_bytes + sizeof(BlockRecord)) : 0;
+  const uint64_t data_offset = AlignUp(kSlabHeaderBytes + max_blocks * sizeof(BlockRecord), kSlabPageBytes);
+  const uint64_t block_count = arena_bytes > data_offset ? std::min(max_blocks, (arena_bytes - data_offset) / block_bytes) : 0;
+  if (block_count == 0) {
+    throw std::runtime_error("slab arena of " + std::to_string(arena_bytes) + " bytes cannot hold a " + std::to_string(block_bytes) +
+                             "-byte block");
+  }
+
+  const uint32_t slab_id = next_slab_id_++;
+  const uint64_t size    = data_offset + block_count * block_bytes;
+  auto           mapping = OpenShm(SlabName(slab_id), size, ShmMode::kCreate);
+  BindToNode(mapping->mutable_data(), size, numa_node);
+
+  // ftruncate keeps the bytes of a stale segment with this name; start from
+  // an empty directory. A fresh segment is already zero-filled.
+  auto* base = ArenaBase(mapping);
+  if (std::any_of(base, base + kSlabHeaderBytes, [](uint8_t byte) { return byte != 0; })) {
+    std::memset(base, 0, data_offset);
+  }
+  auto* header        = reinterpret_cast<SlabHeader*>(base);
+  header->block_bytes = block_bytes;
+  header->block_count = block_count;
+  header->data_offset = data_offset;
+  header->numa_node   = static_cast<uint64_t>(numa_node + 1);
+  header->magic       = kSlabMagic;
+
+  Slab slab;
+  slab.mapping     = std::move(mapping);
+  slab.size_class  = size_class;
+  slab.numa_node   = numa_node;
+  slab.block_bytes = block_bytes;
+  slab.block_count = block_count;
+  slab.data_offset = data_offset;
+  slab.open        = true;
+  slabs_.emplace(slab_id, std::move(slab));
+  OpenSlabsLocked(size_class, numa_node).push_back(slab_id);
+  return slab_id;
+}
+
+RamArrowStore::Entry RamArrowStore::AllocateBlockLocked(const PayloadID& id, uint64_t size_bytes, std::size_t size_class, int32_t numa_node) {
+  if (!quarantine_.empty()) {
+    ReclaimQuarantineLocked();
+  }
+  auto&          open    = OpenSlabsLocked(size_class, numa_node);
+  const uint32_t slab_id = open.empty() ? CreateSlabLocked(size_class, numa_node) : open.back();
+  auto&          slab    = slabs_.at(slab_id);
+
+  uint64_t block_index = 0;
+  if (!slab.free_blocks.empty()) {
+    block_index = slab.free_blocks.back();
+    slab.free_blocks.pop_back();
+  } else {
+    block_index = slab.next_unused++;
+  }
+  ++slab.used_blocks;
+  slab.requested_bytes += size_bytes;
+  if (!slab.HasFreeBlock()) {
+    slab.open = false;
+    open.pop_back();
+  }
+
+  auto* record = RecordAt(slab.mapping, block_index);
+  std::memcpy(record->payload_id, id.value().data(), sizeof(record->payload_id));
+  record->length_bytes = size_bytes;
+
+  Entry entry;
+  entry.slab_id      = slab_id;
+  entry.block_index  = block_index;
+  entry.offset_bytes = slab.data_offset + block_index * slab.block_bytes;
+  entry.numa_node    = slab.numa_node;
+  entry.buffer       = arrow::SliceMutableBuffer(slab.mapping, static_cast<int64_t>(entry.offset_bytes), static_cast<int64_t>(size_bytes));
+  return entry;
+}
+
+void RamArrowStore::FreeBlockLocked(const Entry& entry) {
+  const auto it = slabs_.find(entry.slab_id);
+  if (it == slabs_.end()) {
+    return;
+  }
+  auto& slab = it->second;
+
+  auto*     record = RecordAt(slab.mapping, entry.block_index);
+  PayloadID id;
+  id.set_value(std::string(reinterpret_cast<const char*>(record->payload_id), sizeof(record->payload_id)));
+  record->length_bytes = 0;
+  if (HeldLocked(id, entry.buffer)) {
+    quarantine_.push_back(QuarantinedBlock{entry.slab_id, entry.block_index, std::move(id), entry.buffer});
+  } else {
+    slab.free_blocks.push_back(entry.block_index);
+  }
+  slab.requested_bytes -= static_cast<uint64_t>(entry.buffer->size());
+  --slab.used_blocks;
+
+  const bool served = slab.size_class != kNoSizeClass;
+  if (slab.used_blocks == 0) {
+    // Keep one empty arena per size class so alternating allocate/free does
+    // not create and unlink a segment each time.
+    const std::size_t other_open = served ? OpenSlabsLocked(slab.size_class, slab.numa_node).size() - (slab.open ? 1 : 0) : 0;
+    if (!served || other_open > 0) {
+      if (slab.open) {
+        auto& open = OpenSlabsLocked(slab.size_class, slab.numa_node);
+        open.erase(std::find(open.begin(), open.end(), entry.slab_id));
+      }
+      // Buffers still referencing the arena keep their mapping alive.
+      shm_unlink(SlabName(entry.slab_id).c_str());
+      slabs_.erase(it);
+      return;
+    }
+  }
+  if (served && !slab.open && slab.HasFreeBlock()) {
+    slab.open = true;
+    OpenSlabsLocked(slab.size_class, slab.numa_node).push_back(entry.slab_id);
+  }
+}
+
+// buffer is the one reference its holder owns (the entry being freed, or
+// the quarantine's copy); any other belongs to a reader.
+bool RamArrowStore::HeldLocked(const PayloadID& id, const std::shared_ptr<arrow::Buffer>& buffer) const {
+  return buffer.use_count() > 1 || (holder_probe_ && holder_probe_(id));
+}
+
+/*
+  Returns quarantined blocks whose readers are gone to their slab's free
+  list. Looks at no more than kReclaimBatch blocks, oldest first, so an
+  allocation's cost does not grow with the quarantine; blocks still held
+  go to the back.
+*/
+void RamArrowStore::ReclaimQuarantineLocked() {
+  for (std::size_t n = std::min(quarantine_.size(), kReclaimBatch); n > 0; --n) {
+    auto block = std::move(quarantine_.front());
+    quarantine_.pop_front();
+    const auto it = slabs_.find(block.slab_id);
+    if (it == slabs_.end()) {
+      continue; // arena already unlinked; clients keep their own mappings
+    }
+    if (HeldLocked(block.id, block.buffer)) {
+      quarantine_.push_back(std::move(block));
+      continue;
+    }
+    auto& slab = it->second;
+    slab.free_blocks.push_back(block.block_index);
+    if (slab.size_class != kNoSizeClass && !slab.open) {
+      slab.open = true;
+      OpenSlabsLocked(slab.size_class, slab.numa_node).push_back(block.slab_id);
+    }
+  }
+}
+
+void RamArrowStore::SetHolderProbe(HolderProbe probe) {
+  std::unique_lock lock(mutex_);
+  holder_probe_ = std::move(probe);
+}
+
+void RamArrowStore::PlaceLocked(const PayloadID& id, Entry entry) {
+  auto& slot = entries_[Key(id)];
+  if (slot.slab_id != 0) {
+    FreeBlockLocked(slot);
+  } else if (slot.buffer && (entry.slab_id != 0 || entry.huge_pages != slot.huge_pages)) {
+    UnlinkDedicated(id, slot.huge_pages);
+  }
+  if (slot.huge_pages) {
+    --huge_page_segments_;
+  }
+  if (entry.huge_pages) {
+    ++huge_page_segments_;
+  }
+  AccountNodeLocked(slot, -1);
+  AccountNodeLocked(entry, +1);
+  slot = std::move(entry);
+}
+
+/*
+  Rebuilds slab placements from arenas a previous server left in /dev/shm.
+  Segments without a valid header are left untouched.
+*/
+void RamArrowStore::RecoverSlabs() {
+  const std::string stem = shm_prefix_ + "-slab-";
+
+  std::error_code                     ec;
+  std::filesystem::directory_iterator it("/dev/shm", ec);
+  for (; !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+    const auto file = it->path().filename().string();
+    if (file.rfind(stem, 0) != 0 || file.size() == stem.size() ||
+        !std::all_of(file.begin() + static_cast<std::ptrdiff_t>(stem.size()), file.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+      continue;
+    }
+    uint32_t slab_id = 0;
+    try {
+      slab_id = static_cast<uint32_t>(std::stoul(file.substr(stem.size())));
+    } catch (const std::exception&) {
+      continue;
+    }
+    if (slab_id == 0) {
+      continue;
+    }
+
+    std::shared_ptr<arrow::Buffer> mapping;
+    try {
+      mapping = OpenShm("/" + file, 0, ShmMode::kReadWrite);
+    } catch (const std::exception&) {
+      continue;
+    }
+
+    const auto  size   = static_cast<uint64_t>(mapping->size());
+    const auto* header = reinterpret_cast<const SlabHeader*>(mapping->data());
+    if (size < kSlabHeaderBytes || header->magic != kSlabMagic || header->block_bytes == 0 || header->data_offset > size ||
+        header->block_count > size / sizeof(BlockRecord) || header->data_offset < kSlabHeaderBytes + header->block_count * sizeof(BlockRecord) ||
+        header->block_count > (size - header->data_offset) / header->block_bytes) {
+      continue;
+    }
+
+    Slab slab;
+    slab.mapping     = mapping;
+    slab.size_class  = BlockSizeClass(header->block_bytes);
+    slab.block_bytes = header->block_bytes;
+    slab.block_count = header->block_count;
+    slab.data_offset = header->data_offset;
+    slab.next_unused = slab.block_count;
+    const uint64_t stored_node = header->numa_node; // node + 1
+    if (stored_node != 0 && stored_node <= kMaxNumaNodes && NodeIndex(static_cast<int32_t>(stored_node) - 1)) {
+      slab.numa_node = static_cast<int32_t>(stored_node) - 1;
+    } else if (!numa_nodes_.empty()) {
+      // Not bound to a configured node: keep serving its payloads but place
+      // nothing new in it.
+      slab.size_class = kNoSizeClass;
+    }
+
+    // Walk backwards so the free list hands out low block indexes first.
+    for (uint64_t i = slab.block_count; i > 0; --i) {
+      const uint64_t block_index = i - 1;
+      auto*          record      = RecordAt(mapping, block_index);
+      if (record->length_bytes == 0 || record->length_bytes > slab.block_bytes) {
+        record->length_bytes = 0;
+        slab.free_blocks.push_back(block_index);
+        continue;
+      }
+
+      PayloadID id;
+      id.set_value(std::string(reinterpret_cast<const char*>(record->payload_id), sizeof(record->payload_id)));
+
+      Entry entry;
+      entry.slab_id      = slab_id;
+      entry.block_index  = block_index;
+      entry.offset_bytes = slab.data_offset + block_index * slab.block_bytes;
+      entry.numa_node    = slab.numa_node;
+      entry.buffer = arrow::SliceMutableBuffer(mapping, static_cast<int64_t>(entry.offset_bytes), static_cast<int64_t>(record->length_bytes));
+      const auto length        = record->length_bytes;
+      auto [placed, inserted] = entries_.emplace(Key(id), std::move(entry));
+      if (!inserted) {
+        // A crash mid-replacement can leave two blocks claiming one payload.
+        record->length_bytes = 0;
+        slab.free_blocks.push_back(block_index);
+        continue;
+      }
+      AccountNodeLocked(placed->second, +1);
+      ++slab.used_blocks;
+      slab.requested_bytes += length;
+    }
+
+    if (slab.size_class != kNoSizeClass && slab.HasFreeBlock()) {
+      slab.open = true;
+      OpenSlabsLocked(slab.size_class, slab.numa_node).push_back(slab_id);
+    }
+    next_slab_id_ = std::max(next_slab_id_, slab_id + 1);
+    slabs_.emplace(slab_id, std::move(slab));
+  }
+}
+
+RamLocation RamArrowStore::Locate(const PayloadID& id, uint64_t length_bytes) const {
+  RamPlacement placement;
+  {
+    std::shared_lock lock(mutex_);
+    const auto       it = entries_.find(Key(id));
+    if (it != entries_.end()) {
+      placement.slab_id      = it->second.slab_id;
+      placement.block_index  = it->second.block_index;
+      placement.offset_bytes = it->second.offset_bytes;
+      placement.huge_pages   = it->second.huge_pages;
+      placement.numa_node    = it->second.numa_node;
+    }
+  }
+  return Locate(id, length_bytes, placement);
+}
+
+RamLocation RamArrowStore::Locate(const PayloadID& id, uint64_t length_bytes, const RamPlacement& placement) const {
+  RamLocation location;
+  location.set_length_bytes(length_bytes);
+  if (placement.slab_id != 0) {
+    location.set_slab_id(placement.slab_id);
+    location.set_block_index(placement.block_index);
+    location.set_offset_bytes(placement.offset_bytes);
+    location.set_shm_name(SlabName(placement.slab_id));
+  } else {
+    location.set_shm_name(ShmName(id));
+    if (placement.huge_pages && huge_page_bytes_ != 0) {
+      location.set_page_size_bytes(huge_page_bytes_);
+      location.set_file_path(HugePagePath(id));
+    }
+  }
+  if (placement.numa_node >= 0) {
+    location.set_numa_node(static_cast<uint32_t>(placement.numa_node));
+  }
+  return location;
+}
+
+RamSegmentStats RamArrowStore::SegmentStats() const {
+  RamSegmentStats  stats;
+  uint64_t         slab_entries = 0;
+  std::shared_lock lock(mutex_);
+  stats.slab_count = slabs_.size();
+  for (const auto& [slab_id, slab] : slabs_) {
+    stats.capacity_bytes += slab.block_count * slab.block_bytes;
+    stats.allocated_bytes += slab.used_blocks * slab.block_bytes;
+    stats.requested_bytes += slab.requested_bytes;
+    slab_entries += slab.used_blocks;
+  }
+  for (const auto& block : quarantine_) {
+    stats.quarantined_blocks += slabs_.contains(block.slab_id) ? 1 : 0;
+  }
+  stats.huge_page_segments  = huge_page_segments_;
+  stats.dedicated_segments  = entries_.size() - slab_entries - huge_page_segments_;
+  stats.huge_page_fallbacks = huge_page_fallbacks_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+// ---------------------------------------------------------------------------
+// StorageBackend implementation
+// ---------------------------------------------------------------------------
+
 std::shared_ptr<arrow::Buffer> RamArrowStore::Allocate(const PayloadID& id, uint64_t size_bytes) {
-  const auto name = ShmName(id);
-  auto       buf  = OpenShm(name, size_bytes, /*writable=*/true);
+  return Allocate(id, size_bytes, std::nullopt);
+}
+
+/*
+  Allocate: carve a slab block, or create a dedicated shm segment, so the
+  client can map and write into it. The server holds the mmap'd buffer so
+  spill/promotion can read it.
+*/
+std::shared_ptr<arrow::Buffer> RamArrowStore::Allocate(const PayloadID& id, uint64_t size_bytes, std::optional<uint32_t> numa_node) {
+  const auto size_class = SizeClass(id, size_bytes);
+  if (size_class != kNoSizeClass) {
+    std::unique_lock lock(mutex_);
+    auto             entry = AllocateBlockLocked(id, size_bytes, size_class, SelectNodeLocked(numa_node));
+    auto             buf   = entry.buffer;
+    PlaceLocked(id, std::move(entry));
+    return buf;
+  }
 
+  int32_t node = kNoNumaNode;
+  {
+    std::shared_lock lock(mutex_);
+    node = SelectNodeLocked(numa_node);
+  }
+  auto entry = CreateDedicated(id, size_bytes, node);
+
+  auto             buf = entry.buffer;
   std::unique_lock lock(mutex_);
-  buffers_[Key(id)] = buf;
+  PlaceLocked(id, std::move(entry));
   return buf;
 }
 
 /*
   Read: return the cached mmap buffer. If not cached (after a restart, the
-  shm segment persists), re-open and cache it.
+  shm segment persists), re-open and cache it. Slab placements were
+  already rebuilt at construction.
 */
 std::shared_ptr<arrow::Buffer> RamArrowStore::Read(const PayloadID& id) {
   {
     std::shared_lock lock(mutex_);
-    auto             it = buffers_.find(Key(id));
-    if (it != buffers_.end()) {
-      return it->second;
+    auto             it = entries_.find(Key(id));
+    if (it != entries_.end()) {
+      return it->second.buffer;
     }
   }
 
   // Re-open after restart
-  const auto name = ShmName(id);
-  auto       buf  = OpenShm(name, 0, /*writable=*/false);
+  Entry entry;
+  if (huge_page_bytes_ != 0) {
+    entry.buffer     = OpenHugePageSegment(id, 0, ShmMode::kReadOnly);
+    entry.huge_pages = entry.buffer != nullptr;
+  }
+  if (!entry.buffer) {
+    entry.buffer = OpenShm(ShmName(id), 0, ShmMode::kReadOnly);
+  }
+  entry.numa_node = ResidentNode(entry.buffer);
 
   std::unique_lock lock(mutex_);
-  buffers_[Key(id)] = buf;
-  return buf;
+  auto [it, inserted] = entries_.try_emplace(Key(id), std::move(entry));
+  if (inserted) {
+    huge_page_segments_ += it->second.huge_pages ? 1 : 0;
+    AccountNodeLocked(it->second, +1);
+  }
+  return it->second.buffer;
 }
 
 /*
-  Write: used for promotions (DISK → RAM). Create shm and copy data in.
+  Write: used for promotions (DISK → RAM). Place the payload and copy data
+  in; the copy runs outside the lock and the placement is published after.
 */
 void RamArrowStore::Write(const PayloadID& id, const std::shared_ptr<arrow::Buffer>& buffer, bool /*fsync*/) {
-  const auto name       = ShmName(id);
-  const auto size_bytes = static_cast<size_t>(buffer->size());
-  auto       buf        = OpenShm(name, size_bytes, /*writable=*/true);
+  const auto size_bytes = static_cast<uint64_t>(buffer->size());
+  const auto size_class = SizeClass(id, size_bytes);
+
+  Entry entry;
+  if (size_class != kNoSizeClass) {
+    std::unique_lock lock(mutex_);
+    entry = AllocateBlockLocked(id, size_bytes, size_class, SelectNodeLocked(std::nullopt));
+  } else {
+    int32_t node = kNoNumaNode;
+    {
+      std::shared_lock lock(mutex_);
+      node = SelectNodeLocked(std::nullopt);
+    }
+    entry = CreateDedicated(id, size_bytes, node);
+  }
 
-  std::memcpy(reinterpret_cast<uint8_t*>(buf->mutable_data()), buffer->data(), size_bytes);
+  std::memcpy(entry.buffer->mutable_data(), buffer->data(), static_cast<size_t>(size_bytes));
 
   std::unique_lock lock(mutex_);
-  buffers_[Key(id)] = buf;
+  PlaceLocked(id, std::move(entry));
+}
+
+std::unique_ptr<PayloadWriter> RamArrowStore::OpenWriter(const PayloadID& id, uint64_t size_bytes, bool /*fsync*/) {
+  return std::make_unique<RamPayloadWriter>(*this, id, Allocate(id, size_bytes, std::nullopt));
 }
 
 /*
-  Remove: unlink the shm segment and drop the cached buffer.
-  Existing client mappings continue to work until they munmap.
+  TransferTo: let the kernel copy the bytes out of the backing file (RAM →
+  DISK spill). A slab payload passes the arena fd and its block offset.
+  The fd is opened by name; the caller holds the payload lock, so the
+  segment cannot be removed meanwhile.
 */
-void RamArrowStore::Remove(const PayloadID& id) {
-  const auto name = ShmName(id);
-  shm_unlink(name.c_str()); // best-effort; ignore error if already gone
+bool RamArrowStore::TransferTo(StorageBackend& target, const PayloadID& id, bool fsync) {
+  const auto length = static_cast<uint64_t>(Read(id)->size()); // re-opens after a restart
 
+  std::string path;
+  bool        huge_pages = false;
+  uint64_t    offset     = 0;
+  {
+    std::shared_lock lock(mutex_);
+    const auto       it = entries_.find(Key(id));
+    if (it == entries_.end()) {
+      return false;
+    }
+    huge_pages = it->second.huge_pages;
+    offset     = it->second.offset_bytes;
+    path       = it->second.slab_id != 0 ? SlabName(it->second.slab_id) : huge_pages ? HugePagePath(id) : ShmName(id);
+  }
+
+  const int fd = huge_pages ? open(path.c_str(), O_RDONLY | O_CLOEXEC) : shm_open(path.c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    return false;
+  }
+  bool transferred = false;
+  try {
+    transferred = target.WriteFromFile(id, fd, offset, length, fsync);
+  } catch (...) {
+    close(fd);
+    throw;
+  }
+  close(fd);
+  return transferred;
+}
+
+/*
+  Remove: release the slab block, or unlink the dedicated segment, and
+  drop the cached buffer. Existing client mappings of a dedicated segment
+  continue to work until they munmap.
+*/
+void RamArrowStore::Remove(const PayloadID& id) {
   std::unique_lock lock(mutex_);
-  buffers_.erase(Key(id));
+  const auto       it = entries_.find(Key(id));
+  if (it == entries_.end()) {
+    lock.unlock();
+    // Not opened since a restart; it may live in either place.
+    UnlinkDedicated(id, /*huge_pages=*/false);
+    if (huge_page_bytes_ != 0) {
+      UnlinkDedicated(id, /*huge_pages=*/true);
+    }
+    return;
+  }
+
+  const Entry entry = std::move(it->second);
+  entries_.erase(it);
+  AccountNodeLocked(entry, -1);
+  if (entry.slab_id != 0) {
+    FreeBlockLocked(entry);
+    return;
+  }
+  if (entry.huge_pages) {
+    --huge_page_segments_;
+  }
+  lock.unlock();
+  UnlinkDedicated(id, entry.huge_pages);
 }
 
 } // namespace payload::storage
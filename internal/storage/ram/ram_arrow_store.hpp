@@ -2,23 +2,130 @@
 
 #include <arrow/buffer.h>
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
 #include <memory>
+#include <optional>
 #include <shared_mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "internal/storage/storage_backend.hpp"
 #include "payload/manager/v1.hpp"
 
 namespace payload::storage {
 
+struct RamSlabOptions {
+  bool enabled = true;
+  // Largest payload served from a slab; rounded up to a power of two.
+  uint64_t max_block_bytes = uint64_t{256} << 10;
+  // Size of each slab arena segment.
+  uint64_t arena_bytes = uint64_t{64} << 20;
+};
+
+struct RamHugePageOptions {
+  bool enabled = false;
+  // hugetlbfs mount that huge-page segments are created on.
+  std::string mount_path = "/dev/hugepages";
+};
+
+struct RamNumaNode {
+  uint32_t node           = 0;
+  uint64_t capacity_bytes = 0; // this node's share of the RAM tier
+};
+
+struct RamNumaOptions {
+  // Empty: segments are not bound and land wherever they are first touched.
+  // Node ids must be below 64 (the bind mask is one word).
+  std::vector<RamNumaNode> nodes;
+};
+
+// Payload bytes placed on one configured NUMA node.
+struct RamNodeUsage {
+  uint32_t node           = 0;
+  uint64_t capacity_bytes = 0;
+  uint64_t used_bytes     = 0;
+};
+
+// Where a payload sits in the RAM tier: a slab block, or its dedicated
+// segment when slab_id is 0.
+struct RamPlacement {
+  uint32_t slab_id      = 0;
+  uint64_t block_index  = 0;
+  uint64_t offset_bytes = 0;
+  bool     huge_pages   = false; // dedicated segment on hugetlbfs
+  int32_t  numa_node    = -1;    // -1 = unknown
+};
+
+/*
+  Segment and slab occupancy snapshot.
+
+  Blocks are power-of-two sized, so a payload wastes up to half of its
+  block (internal fragmentation); blocks that are free inside mapped arenas
+  are external fragmentation.
+*/
+struct RamSegmentStats {
+  uint64_t slab_count          = 0;
+  uint64_t dedicated_segments  = 0; // base-page segments of one payload each
+  uint64_t huge_page_segments  = 0; // hugetlbfs segments of one payload each
+  uint64_t huge_page_fallbacks = 0; // huge-page allocations served from base pages instead
+  uint64_t capacity_bytes      = 0; // block bytes across all arenas
+  uint64_t allocated_bytes     = 0; // bytes of blocks handed out
+  uint64_t requested_bytes     = 0; // payload bytes stored in those blocks
+  uint64_t quarantined_blocks  = 0; // freed blocks not reusable until their readers are gone
+
+  double InternalFragmentation() const {
+    return allocated_bytes == 0 ? 0.0 : 1.0 - static_cast<double>(requested_bytes) / static_cast<double>(allocated_bytes);
+  }
+
+  double ExternalFragmentation() const {
+    return capacity_bytes == 0 ? 0.0 : 1.0 - static_cast<double>(allocated_bytes) / static_cast<double>(capacity_bytes);
+  }
+};
+
 /*
   RAM storage tier.
 
   Backed by POSIX shared memory (shm_open / mmap) so that both the server
   and local C++ clients can map the same pages without copying.
 
-  Each payload gets its own shm segment named "/<prefix>-<uuid-hex>".
+  Large payloads get their own shm segment named "/<prefix>-<uuid-hex>".
+  Payloads up to RamSlabOptions::max_block_bytes are carved out of shared
+  slab arenas named "/<prefix>-slab-<slab_id>" instead, so millions of
+  small payloads cost neither an fd nor an mmap region each. An arena is
+  split into equal power-of-two blocks of one size class; a payload is
+  described by (slab_id, block_index, offset_bytes).
+
+  Every arena starts with a header and a block directory recording which
+  payload owns each block, so a restarted server rebuilds its slab
+  placements the same way it re-opens dedicated segments.
+
+  A freed block is not handed out again while its payload may still be
+  read: while the store's buffer for it is referenced in-process, or while
+  the holder probe reports leases on it, including leases a forced delete
+  revoked that their holders have not released or let expire. Such blocks
+  wait in a quarantine that each slab allocation re-checks a few entries
+  of, oldest first.
+
+  With huge pages enabled, dedicated segments of at least one huge page are
+  created as files on a hugetlbfs mount instead, sized up to a whole number
+  of huge pages with the payload length stored in the last 8 bytes so a
+  restarted server can re-open them. RamLocation.file_path and
+  page_size_bytes tell clients to open that file and map at huge-page
+  alignment. When the mount is missing or its page pool is exhausted the
+  segment falls back to ordinary shm. Slab arenas always use base pages.
+
+  With NUMA nodes configured, every dedicated segment and slab arena is
+  bound (preferred policy) to one node before its pages are first touched,
+  so the pages stay there no matter which CPU faults them in. Slab arenas
+  are per node. Allocate takes an optional node hint; without one the
+  node with the most unused capacity is chosen. NodeUsage reports bytes
+  placed per node for pressure checks.
 
   Thread safety:
     - shared reads
@@ -27,8 +134,10 @@ namespace payload::storage {
 
 class RamArrowStore final : public StorageBackend {
  public:
-  explicit RamArrowStore(std::string shm_prefix = "pm") : shm_prefix_(std::move(shm_prefix)) {
+  explicit RamArrowStore(std::string shm_prefix = "pm") : RamArrowStore(std::move(shm_prefix), RamSlabOptions{}) {
   }
+  RamArrowStore(std::string shm_prefix, RamSlabOptions slab_options, RamHugePageOptions huge_page_options = {},
+                RamNumaOptions numa_options = {});
   ~RamArrowStore() override = default;
 
   // StorageBackend interface
@@ -40,10 +149,38 @@ class RamArrowStore final : public StorageBackend {
 
   void Remove(const payload::manager::v1::PayloadID& id) override;
 
+  // Hands the segment (or slab arena) fd to target.WriteFromFile.
+  bool TransferTo(StorageBackend& target, const payload::manager::v1::PayloadID& id, bool fsync) override;
+
+  // Places the payload up front and fills it chunk by chunk. No reader:
+  // Read() already returns the mapping without copying.
+  std::unique_ptr<PayloadWriter> OpenWriter(const payload::manager::v1::PayloadID& id, uint64_t size_bytes, bool fsync) override;
+
+  // Allocate on a specific NUMA node. The hint is ignored when no nodes are
+  // configured; a node that is not configured throws InvalidArgument.
+  std::shared_ptr<arrow::Buffer> Allocate(const payload::manager::v1::PayloadID& id, uint64_t size_bytes, std::optional<uint32_t> numa_node);
+
   payload::manager::v1::Tier TierType() const override {
     return payload::manager::v1::TIER_RAM;
   }
 
+  // Where a client maps the payload: its slab block if it has one,
+  // otherwise its dedicated segment.
+  payload::manager::v1::RamLocation Locate(const payload::manager::v1::PayloadID& id, uint64_t length_bytes) const;
+
+  // Locate() for a placement read from an earlier location (PayloadManager
+  // keeps one per cached snapshot). Takes no lock.
+  payload::manager::v1::RamLocation Locate(const payload::manager::v1::PayloadID& id, uint64_t length_bytes,
+                                           const RamPlacement& placement) const;
+
+  RamSegmentStats SegmentStats() const;
+
+  // One element per configured node, in configuration order.
+  std::vector<RamNodeUsage> NodeUsage() const;
+
+  // Node the payload's pages are bound to, if known.
+  std::optional<uint32_t> NumaNode(const payload::manager::v1::PayloadID& id) const;
+
   // Returns the POSIX shm segment name for a payload ID (starts with '/').
   // Format: /<prefix>-<uuid>.
   std::string ShmName(const payload::manager::v1::PayloadID& id) const;
@@ -51,23 +188,136 @@ class RamArrowStore final : public StorageBackend {
   // Static overload for use when only a prefix string is available.
   static std::string ShmName(const payload::manager::v1::PayloadID& id, const std::string& prefix);
 
+  // Segment name of a slab arena: /<prefix>-slab-<slab_id>.
+  std::string SlabName(uint32_t slab_id) const;
+
+  // hugetlbfs file of a huge-page segment: <mount>/<prefix>-<uuid>.
+  std::string HugePagePath(const payload::manager::v1::PayloadID& id) const;
+
+  // Huge page size in bytes, or 0 when huge pages are disabled or unavailable.
+  uint64_t HugePageBytes() const {
+    return huge_page_bytes_;
+  }
+
   const std::string& GetShmPrefix() const {
     return shm_prefix_;
   }
 
+  // Whether clients may still be mapping a payload's bytes. PayloadManager
+  // answers from its lease table; without a probe only in-process buffer
+  // references keep a freed block out of reuse.
+  using HolderProbe = std::function<bool(const payload::manager::v1::PayloadID&)>;
+  void SetHolderProbe(HolderProbe probe);
+
  private:
   using UUID = std::string;
 
+  static constexpr uint64_t    kMinBlockBytes = 256;
+  static constexpr std::size_t kNoSizeClass   = static_cast<std::size_t>(-1);
+  static constexpr int32_t     kNoNumaNode    = -1;
+  static constexpr uint32_t    kMaxNumaNodes  = 64; // bits in the mbind node mask
+  static constexpr std::size_t kReclaimBatch  = 8;  // quarantined blocks re-checked per slab allocation
+
+  enum class ShmMode { kCreate, kReadOnly, kReadWrite };
+
+  struct Entry {
+    std::shared_ptr<arrow::Buffer> buffer;
+    uint32_t                       slab_id      = 0; // 0 = dedicated segment
+    uint64_t                       block_index  = 0;
+    uint64_t                       offset_bytes = 0;
+    bool                           huge_pages   = false; // dedicated segment on hugetlbfs
+    int32_t                        numa_node    = kNoNumaNode;
+  };
+
+  struct Slab {
+    std::shared_ptr<arrow::Buffer> mapping;
+    std::size_t                    size_class      = kNoSizeClass;
+    int32_t                        numa_node       = kNoNumaNode;
+    uint64_t                       block_bytes     = 0;
+    uint64_t                       block_count     = 0;
+    uint64_t                       data_offset     = 0;
+    uint64_t                       next_unused     = 0; // blocks at or past this index were never handed out
+    uint64_t                       used_blocks     = 0;
+    uint64_t                       requested_bytes = 0;
+    std::vector<uint64_t>          free_blocks;
+    bool                           open = false; // listed in OpenSlabsLocked
+
+    bool HasFreeBlock() const {
+      return !free_blocks.empty() || next_unused < block_count;
+    }
+  };
+
+  // A freed slab block whose payload may still be read. buffer is the
+  // store's own reference; any other reference means a reader in-process.
+  struct QuarantinedBlock {
+    uint32_t                        slab_id     = 0;
+    uint64_t                        block_index = 0;
+    payload::manager::v1::PayloadID id;
+    std::shared_ptr<arrow::Buffer>  buffer;
+  };
+
   static UUID Key(const payload::manager::v1::PayloadID& id);
 
   // Open (or create) a shm segment, mmap it, and return an Arrow buffer.
-  // writable=true → O_CREAT|O_RDWR + ftruncate; false → O_RDONLY.
-  static std::shared_ptr<arrow::Buffer> OpenShm(const std::string& name, size_t size_bytes, bool writable);
+  // kCreate → O_CREAT|O_RDWR + ftruncate; kReadOnly / kReadWrite map an
+  // existing segment, sized from fstat when size_bytes is 0.
+  static std::shared_ptr<arrow::Buffer> OpenShm(const std::string& name, size_t size_bytes, ShmMode mode);
+
+  // Creates (kCreate) or re-opens a hugetlbfs segment. Returns null instead
+  // of throwing so the caller can fall back to OpenShm.
+  std::shared_ptr<arrow::Buffer> OpenHugePageSegment(const payload::manager::v1::PayloadID& id, uint64_t size_bytes, ShmMode mode,
+                                                     int32_t numa_node = kNoNumaNode);
+  bool                           UsesHugePages(uint64_t size_bytes) const;
+  void                           UnlinkDedicated(const payload::manager::v1::PayloadID& id, bool huge_pages) const;
+
+  // Size class serving size_bytes, or kNoSizeClass for a dedicated segment.
+  std::size_t SizeClass(const payload::manager::v1::PayloadID& id, uint64_t size_bytes) const;
+  std::size_t BlockSizeClass(uint64_t block_bytes) const;
+
+  // Dedicated segment on huge pages when eligible, otherwise shm.
+  Entry CreateDedicated(const payload::manager::v1::PayloadID& id, uint64_t size_bytes, int32_t numa_node);
+
+  // Reserves a block and records its owner; the caller publishes it with PlaceLocked.
+  Entry                  AllocateBlockLocked(const payload::manager::v1::PayloadID& id, uint64_t size_bytes, std::size_t size_class,
+                                             int32_t numa_node);
+  void                   FreeBlockLocked(const Entry& entry);
+  bool                   HeldLocked(const payload::manager::v1::PayloadID& id, const std::shared_ptr<arrow::Buffer>& buffer) const;
+  void                   ReclaimQuarantineLocked();
+  uint32_t               CreateSlabLocked(std::size_t size_class, int32_t numa_node);
+  std::vector<uint32_t>& OpenSlabsLocked(std::size_t size_class, int32_t numa_node);
+
+  // NUMA placement; a node index is a position in numa_nodes_. SelectNodeLocked
+  // returns kNoNumaNode when no nodes are configured.
+  int32_t                    SelectNodeLocked(std::optional<uint32_t> hint) const;
+  std::optional<std::size_t> NodeIndex(int32_t numa_node) const;
+  void                       BindToNode(void* addr, std::size_t length, int32_t numa_node) const;
+  int32_t                    ResidentNode(const std::shared_ptr<arrow::Buffer>& buffer) const;
+  // Adds (+1) or removes (-1) entry's bytes from its node's usage.
+  void AccountNodeLocked(const Entry& entry, int sign);
+  // Publishes entry for id, releasing whatever placement id had before.
+  void PlaceLocked(const payload::manager::v1::PayloadID& id, Entry entry);
+  void RecoverSlabs();
+
+  std::string    shm_prefix_;
+  RamSlabOptions slab_options_;
+  std::size_t    size_class_count_ = 0;
+  std::string    huge_page_mount_;
+  uint64_t       huge_page_bytes_ = 0;
+
+  std::vector<RamNumaNode> numa_nodes_;
 
-  std::string shm_prefix_;
+  std::atomic<uint64_t>     huge_page_fallbacks_{0};
+  mutable std::atomic<bool> bind_failure_logged_{false};
 
-  mutable std::shared_mutex                                mutex_;
-  std::unordered_map<UUID, std::shared_ptr<arrow::Buffer>> buffers_;
+  mutable std::shared_mutex          mutex_;
+  std::unordered_map<UUID, Entry>    entries_;
+  std::map<uint32_t, Slab>           slabs_;
+  std::vector<std::vector<uint32_t>> open_slabs_; // per (node, size class): slabs with a free block
+  std::vector<uint64_t>              node_used_bytes_; // parallel to numa_nodes_
+  std::deque<QuarantinedBlock>       quarantine_;
+  HolderProbe                        holder_probe_;
+  uint32_t                           next_slab_id_       = 1;
+  uint64_t                           huge_page_segments_ = 0;
 };
 
 } // namespace payload::storage
@@ -2,8 +2,11 @@
 
 #include <arrow/buffer.h>
 
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
+#include <vector>
 
 #include "payload/manager/core/v1/id.pb.h"
 #include "payload/manager/core/v1/types.pb.h"
@@ -24,6 +27,46 @@ namespace payload::storage {
     GPU      → (future) Arrow CUDA buffers
 */
 
+/*
+  Sequential access to one stored payload, for transfers that move it in
+  bounded chunks instead of one buffer. See StorageBackend::OpenReader /
+  OpenWriter and CopyPayload (payload_transfer.hpp).
+*/
+class PayloadReader {
+ public:
+  virtual ~PayloadReader() = default;
+
+  virtual uint64_t Size() const = 0;
+
+  // Reads exactly length bytes starting at offset; throws when the payload
+  // ends early. May be called from a thread other than the opener's.
+  virtual void ReadAt(uint64_t offset, uint8_t* out, uint64_t length) = 0;
+
+  // Smallest ReadAt length that gets the reader's full throughput (for
+  // example, one range per parallel request), or 0 for no preference.
+  virtual uint64_t PreferredReadBytes() const {
+    return 0;
+  }
+};
+
+class PayloadWriter {
+ public:
+  // Destroying a writer that was not committed discards what was written.
+  virtual ~PayloadWriter() = default;
+
+  virtual void Append(const uint8_t* data, uint64_t length) = 0;
+
+  // Writable mapping of the whole payload when the target placed it in
+  // memory up front, or null. A caller that fills it instead of calling
+  // Append lets the source read straight into the destination.
+  virtual uint8_t* Destination() {
+    return nullptr;
+  }
+
+  // Publishes the payload the way Write() would (atomic replace, fsync).
+  virtual void Commit() = 0;
+};
+
 class StorageBackend {
  public:
   virtual ~StorageBackend() = default;
@@ -75,6 +118,48 @@ class StorageBackend {
   */
   virtual void Write(const payload::manager::v1::PayloadID& id, const std::shared_ptr<arrow::Buffer>& buffer, bool fsync) = 0;
 
+  // ------------------------------------------------------------------
+  // Transfer
+  // ------------------------------------------------------------------
+  /*
+    Copy a payload into another tier without staging it in user space.
+
+    Returns false when this pair of backends has no fast path; the caller
+    then falls back to Read() + target.Write(). Nothing is left in the
+    target when false is returned.
+  */
+  virtual bool TransferTo(StorageBackend& /*target*/, const payload::manager::v1::PayloadID& /*id*/, bool /*fsync*/) {
+    return false;
+  }
+
+  /*
+    Persist length bytes of an open file, starting at offset, the same way
+    Write() persists a buffer. Lets a file-backed source hand its fd to a
+    file-backed target so the kernel moves the bytes.
+
+    Returns false, having written nothing, when the kernel cannot copy
+    between the two files.
+  */
+  virtual bool WriteFromFile(const payload::manager::v1::PayloadID& /*id*/, int /*fd*/, uint64_t /*offset*/, uint64_t /*length*/, bool /*fsync*/) {
+    return false;
+  }
+
+  // ------------------------------------------------------------------
+  // Streaming
+  // ------------------------------------------------------------------
+  /*
+    Chunked access for multi-GB transfers. Return null when the backend
+    has nothing better than Read() / Write(): RAM's Read() is already a
+    zero-copy mapping, so it offers a writer but no reader.
+  */
+  virtual std::unique_ptr<PayloadReader> OpenReader(const payload::manager::v1::PayloadID& /*id*/) {
+    return nullptr;
+  }
+
+  virtual std::unique_ptr<PayloadWriter> OpenWriter(const payload::manager::v1::PayloadID& /*id*/, uint64_t /*size_bytes*/, bool /*fsync*/) {
+    return nullptr;
+  }
+
   // ------------------------------------------------------------------
   // Delete
   // ------------------------------------------------------------------
@@ -89,13 +174,73 @@ class StorageBackend {
   // Sidecar metadata
   // ------------------------------------------------------------------
   /*
-    Write a JSON sidecar (<uuid>.meta.json) alongside the payload data.
+    Write sidecar metadata for the payload: by default a JSON
+    <uuid>.meta.json alongside the payload data; durable tiers can be
+    configured for binary <uuid>.meta.pb files or batched manifest segments.
 
     Only implemented by durable tiers (disk, object).  RAM/GPU ignore it.
   */
   virtual void WriteSidecar(const payload::manager::v1::PayloadID&, const payload::manager::catalog::v1::PayloadArchiveMetadata&) {
   }
 
+  /*
+    Remove only the sidecar, for a payload whose bytes live in a shared
+    content blob rather than under its own id. Best-effort.
+  */
+  virtual void RemoveSidecar(const payload::manager::v1::PayloadID&) {
+  }
+
+  /*
+    Write sidecar metadata still batched in memory (manifest segments).
+    Throws if the write fails; the metadata stays pending.
+  */
+  virtual void FlushSidecars() {
+  }
+
+  /*
+    Latest sidecar metadata of every payload the tier's manifest segments
+    still list (removed payloads dropped); empty unless sidecars are
+    batched into manifests. What rebuilds the repository when it is lost.
+  */
+  virtual std::vector<payload::manager::catalog::v1::PayloadArchiveMetadata> ReadManifest() {
+    return {};
+  }
+
+  // ------------------------------------------------------------------
+  // Location
+  // ------------------------------------------------------------------
+  /*
+    Where the payload stored under key (its UUID string) lives: the file
+    relative to the tier root, and the offset of its first byte in it.
+  */
+  virtual void Locate(const std::string& key, payload::manager::v1::DiskLocation* location) const {
+    location->set_path(key + ".bin");
+    location->set_offset_bytes(0);
+  }
+
+  /*
+    Inverse of Locate for a location handed out earlier: the key it names,
+    or nullopt. By default the key is the file name ("[ab/cd/]<uuid>.bin").
+  */
+  virtual std::optional<std::string> LocatedKey(const payload::manager::v1::DiskLocation& location) const {
+    constexpr size_t kName = 36 + 4;
+    const auto&      path  = location.path();
+    if (location.offset_bytes() != 0 || path.size() < kName || !path.ends_with(".bin")) return std::nullopt;
+    const auto start = path.size() - kName;
+    if (start > 0 && path[start - 1] != '/') return std::nullopt;
+    return path.substr(start, 36);
+  }
+
+  /*
+    Moves whenever Locate() may answer differently for a payload that was
+    not written again (disk: a packed segment compacted). Callers caching
+    locations re-locate once it changes; 0 for backends that never move
+    their payloads.
+  */
+  virtual uint64_t LocationEpoch() const {
+    return 0;
+  }
+
   // ------------------------------------------------------------------
   // Tier type
   // ------------------------------------------------------------------
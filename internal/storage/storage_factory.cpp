@@ -1,9 +1,14 @@
 #include "storage_factory.hpp"
 
+#include <algorithm>
+#include <chrono>
 #include <filesystem>
+#include <vector>
 
 #include "common/arrow_utils.hpp"
 #include "disk/disk_arrow_store.hpp"
+#include "disk/striped_disk_store.hpp"
+#include "internal/observability/logging.hpp"
 #include "object/object_arrow_store.hpp"
 #include "ram/ram_arrow_store.hpp"
 #if PAYLOAD_MANAGER_ARROW_CUDA
@@ -12,21 +17,122 @@
 
 namespace payload::storage {
 
+namespace {
+
+std::chrono::milliseconds Millis(const google::protobuf::Duration& duration) {
+  return std::chrono::milliseconds(duration.seconds() * 1000 + duration.nanos() / 1'000'000);
+}
+
+common::SidecarOptions SidecarOptionsFrom(const payload::runtime::config::SidecarConfig& cfg) {
+  common::SidecarOptions options;
+  switch (cfg.format()) {
+    case payload::runtime::config::SIDECAR_FORMAT_BINARY:
+      options.format = common::SidecarFormat::kBinary;
+      break;
+    case payload::runtime::config::SIDECAR_FORMAT_MANIFEST:
+      options.format = common::SidecarFormat::kManifest;
+      break;
+    default:
+      options.format = common::SidecarFormat::kJson;
+      break;
+  }
+  if (cfg.manifest_max_entries() > 0) options.manifest_max_entries = cfg.manifest_max_entries();
+  if (Millis(cfg.manifest_window()).count() > 0) options.manifest_window = Millis(cfg.manifest_window());
+  if (cfg.manifest_compact_segments() > 0) options.manifest_compact_segments = cfg.manifest_compact_segments();
+  if (cfg.manifest_compact_dead_ratio() > 0) options.manifest_compact_dead_ratio = cfg.manifest_compact_dead_ratio();
+  return options;
+}
+
+PackOptions PackOptionsFrom(const payload::runtime::config::DiskPackConfig& cfg) {
+  PackOptions options;
+  options.enabled = cfg.enabled();
+  if (cfg.max_payload_bytes() > 0) options.max_payload_bytes = cfg.max_payload_bytes();
+  if (cfg.segment_bytes() > 0) options.segment_bytes = cfg.segment_bytes();
+  if (cfg.compact_garbage_ratio() > 0) options.compact_garbage_ratio = cfg.compact_garbage_ratio();
+  if (Millis(cfg.compaction_interval()).count() > 0) options.compaction_interval = Millis(cfg.compaction_interval());
+  if (Millis(cfg.retire_grace()).count() > 0) options.retire_grace = Millis(cfg.retire_grace());
+  return options;
+}
+
+} // namespace
+
 StorageFactory::TierMap StorageFactory::Build(const payload::runtime::config::StorageConfig& cfg) {
   StorageFactory::TierMap stores;
+  const auto              sidecars = SidecarOptionsFrom(cfg.sidecars());
 
   const std::string shm_prefix = cfg.ram().shm_prefix().empty() ? "pm" : cfg.ram().shm_prefix();
-  stores.emplace(payload::manager::v1::TIER_RAM, std::make_shared<RamArrowStore>(shm_prefix));
+  RamSlabOptions    slab_options;
+  slab_options.enabled = !cfg.ram().disable_slabs();
+  if (cfg.ram().slab_max_block_bytes() > 0) {
+    slab_options.max_block_bytes = cfg.ram().slab_max_block_bytes();
+  }
+  if (cfg.ram().slab_arena_bytes() > 0) {
+    slab_options.arena_bytes = cfg.ram().slab_arena_bytes();
+  }
+  RamHugePageOptions huge_page_options;
+  huge_page_options.enabled = cfg.ram().use_hugepages();
+  if (!cfg.ram().hugetlbfs_path().empty()) {
+    huge_page_options.mount_path = cfg.ram().hugetlbfs_path();
+  }
+  RamNumaOptions numa_options;
+  for (const auto& node : cfg.ram().numa_nodes()) {
+    numa_options.nodes.push_back({node.node(), node.capacity_bytes()});
+  }
+  stores.emplace(payload::manager::v1::TIER_RAM, std::make_shared<RamArrowStore>(shm_prefix, slab_options, huge_page_options, numa_options));
 
   std::filesystem::path disk_root =
       cfg.disk().root_path().empty() ? std::filesystem::path{"/tmp/payload-manager"} : std::filesystem::path{cfg.disk().root_path()};
-  stores.emplace(payload::manager::v1::TIER_DISK, std::make_shared<DiskArrowStore>(std::move(disk_root)));
+  DiskStoreOptions disk_options;
+  disk_options.kernel_copy    = cfg.disk().kernel_copy();
+  disk_options.mmap_reads     = cfg.disk().read_mode() == pb::arrow::storage::READ_MODE_MMAP;
+  disk_options.sidecars       = sidecars;
+  disk_options.fanout_levels  = cfg.disk().fanout_levels();
+  disk_options.pack           = PackOptionsFrom(cfg.disk().pack());
+  disk_options.preallocate    = cfg.disk().allocation() == payload::runtime::config::DISK_ALLOCATION_PREALLOCATED;
+  disk_options.capacity_bytes = cfg.disk().capacity_bytes();
+
+  const auto& io_uring            = cfg.disk().io_uring();
+  disk_options.io_uring.enabled   = io_uring.enabled();
+  disk_options.io_uring.direct_io = io_uring.direct_io();
+  if (io_uring.queue_depth() > 0) disk_options.io_uring.queue_depth = io_uring.queue_depth();
+  if (io_uring.chunk_bytes() > 0) disk_options.io_uring.chunk_bytes = io_uring.chunk_bytes();
+  if (io_uring.registered_buffers() > 0) disk_options.io_uring.registered_buffers = io_uring.registered_buffers();
+  if (io_uring.direct_io_min_bytes() > 0) disk_options.io_uring.direct_io_min_bytes = io_uring.direct_io_min_bytes();
+  if (cfg.disk().roots_size() > 0) {
+    std::vector<DiskRoot> roots;
+    for (const auto& root : cfg.disk().roots()) {
+      roots.push_back({root.path(), root.capacity_bytes(), root.name()});
+    }
+    // root_path may already hold payloads: keep it as one more root rather than dropping them.
+    if (!cfg.disk().root_path().empty()) {
+      const auto normal = [](const std::filesystem::path& path) { return std::filesystem::absolute(path).lexically_normal(); };
+      const bool listed = std::any_of(roots.begin(), roots.end(), [&](const DiskRoot& root) { return normal(root.path) == normal(disk_root); });
+      if (!listed) roots.push_back({disk_root, cfg.disk().capacity_bytes(), ""});
+      PAYLOAD_LOG_WARN(listed ? "disk.root_path is also listed in disk.roots; striping over disk.roots"
+                              : "disk.root_path is set alongside disk.roots; striping over it as one more root",
+                       {payload::observability::StringField("root_path", disk_root.string())});
+    }
+    stores.emplace(payload::manager::v1::TIER_DISK, std::make_shared<StripedDiskStore>(std::move(roots), disk_options));
+  } else {
+    stores.emplace(payload::manager::v1::TIER_DISK, std::make_shared<DiskArrowStore>(std::move(disk_root), disk_options));
+  }
 
   if (!cfg.object().root_path().empty()) {
     const bool is_s3 = cfg.object().filesystem() == pb::arrow::storage::FILE_SYSTEM_S3 || cfg.object().filesystem_options().has_s3();
     auto [object_fs, object_root] =
         payload::storage::common::Unwrap(payload::storage::common::ResolveFileSystem(cfg.object().root_path(), cfg.object()));
-    stores.emplace(payload::manager::v1::TIER_OBJECT, std::make_shared<ObjectArrowStore>(std::move(object_fs), std::move(object_root), is_s3));
+    MultipartOptions multipart;
+    const auto&      multipart_cfg = cfg.object().multipart();
+    if (multipart_cfg.part_size_bytes() > 0) multipart.part_bytes = multipart_cfg.part_size_bytes();
+    if (multipart_cfg.concurrency() > 0) multipart.concurrency = multipart_cfg.concurrency();
+    if (multipart_cfg.has_part_retries()) multipart.part_retries = multipart_cfg.part_retries();
+    RangedReadOptions ranged_reads;
+    const auto&       ranged_cfg = cfg.object().ranged_reads();
+    if (ranged_cfg.range_size_bytes() > 0) ranged_reads.range_bytes = ranged_cfg.range_size_bytes();
+    if (ranged_cfg.concurrency() > 0) ranged_reads.concurrency = ranged_cfg.concurrency();
+    if (ranged_cfg.has_range_retries()) ranged_reads.range_retries = ranged_cfg.range_retries();
+    stores.emplace(payload::manager::v1::TIER_OBJECT,
+                   std::make_shared<ObjectArrowStore>(std::move(object_fs), std::move(object_root), is_s3, multipart, ranged_reads, sidecars));
   }
 
 #if PAYLOAD_MANAGER_ARROW_CUDA
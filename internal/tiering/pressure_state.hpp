@@ -1,14 +1,24 @@
 #pragma once
 
+#include <array>
 #include <atomic>
+#include <cstddef>
 #include <cstdint>
 
 namespace payload::tiering {
 
 /*
   Live capacity accounting used by eviction decisions.
+
+  When the RAM tier is split across NUMA nodes, ram_node_bytes and
+  ram_node_limit are indexed by node id; a node with a zero limit is not
+  tracked. A node over its limit is RAM pressure even while the tier as a
+  whole is under ram_limit.
 */
 struct PressureState {
+  // Matches the one-word node mask RamArrowStore binds segments with.
+  static constexpr std::size_t kMaxNumaNodes = 64;
+
   std::atomic<uint64_t> ram_bytes{0};
   std::atomic<uint64_t> gpu_bytes{0};
   std::atomic<uint64_t> disk_bytes{0};
@@ -17,9 +27,27 @@ struct PressureState {
   uint64_t gpu_limit{0};
   uint64_t disk_limit{0};
 
-  bool RamPressure() const {
+  std::array<std::atomic<uint64_t>, kMaxNumaNodes> ram_node_bytes{};
+  std::array<uint64_t, kMaxNumaNodes>              ram_node_limit{};
+
+  bool RamNodePressure(std::size_t node) const {
+    return node < kMaxNumaNodes && ram_node_limit[node] != 0 && ram_node_bytes[node].load() > ram_node_limit[node];
+  }
+  bool AnyRamNodePressure() const {
+    for (std::size_t node = 0; node < kMaxNumaNodes; ++node) {
+      if (RamNodePressure(node)) {
+        return true;
+      }
+    }
+    return false;
+  }
+  bool RamTierPressure() const {
     return ram_bytes.load() > ram_limit;
   }
+
+  bool RamPressure() const {
+    return RamTierPressure() || AnyRamNodePressure();
+  }
   bool GpuPressure() const {
     return gpu_bytes.load() > gpu_limit;
   }
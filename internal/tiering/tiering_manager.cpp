@@ -5,6 +5,7 @@
 #include "internal/core/payload_manager.hpp"
 #include "internal/observability/logging.hpp"
 #include "internal/observability/spans.hpp"
+#include "internal/storage/ram/ram_arrow_store.hpp"
 #include "payload/manager/v1.hpp"
 
 namespace payload::tiering {
@@ -40,23 +41,33 @@ void TieringManager::Stop() {
 }
 
 void TieringManager::Loop() {
+  // Occupancy gauges are exported from here rather than on every accounting
+  // update, which keeps Metrics off the Allocate/Delete/spill hot paths.
+  constexpr auto kTierMetricsExportInterval = 1s;
+  auto           next_metrics_export        = std::chrono::steady_clock::now();
+
   while (running_) {
     // Sync live byte counts into the pressure state so eviction thresholds
     // are evaluated against current occupancy.
-    {
-      const auto tier_bytes = manager_->GetTierBytes();
-      auto       it_ram     = tier_bytes.find(static_cast<int>(payload::manager::v1::TIER_RAM));
-      auto       it_gpu     = tier_bytes.find(static_cast<int>(payload::manager::v1::TIER_GPU));
-      auto       it_disk    = tier_bytes.find(static_cast<int>(payload::manager::v1::TIER_DISK));
-      state_->ram_bytes.store(it_ram != tier_bytes.end() ? it_ram->second : 0);
-      state_->gpu_bytes.store(it_gpu != tier_bytes.end() ? it_gpu->second : 0);
-      state_->disk_bytes.store(it_disk != tier_bytes.end() ? it_disk->second : 0);
+    state_->ram_bytes.store(manager_->GetTierBytes(payload::manager::v1::TIER_RAM));
+    state_->gpu_bytes.store(manager_->GetTierBytes(payload::manager::v1::TIER_GPU));
+    state_->disk_bytes.store(manager_->GetTierBytes(payload::manager::v1::TIER_DISK));
+    for (const auto& usage : manager_->GetRamNodeUsage()) {
+      if (usage.node < PressureState::kMaxNumaNodes) {
+        state_->ram_node_bytes[usage.node].store(usage.used_bytes);
+      }
+    }
+
+    if (const auto now = std::chrono::steady_clock::now(); now >= next_metrics_export) {
+      manager_->ExportTierMetrics();
+      next_metrics_export = now + kTierMetricsExportInterval;
     }
 
     if (auto victim = policy_->ChooseRamEviction(*state_)) {
       spill::SpillTask task;
       task.id          = *victim;
       task.target_tier = manager_->GetSpillTarget(*victim);
+      task.priority    = spill::SpillPriority::kEviction;
       scheduler_->Enqueue(task);
       payload::observability::Metrics::Instance().SetSpillQueueDepth(scheduler_->QueueDepth());
     }
@@ -65,6 +76,7 @@ void TieringManager::Loop() {
       spill::SpillTask task;
       task.id          = *victim;
       task.target_tier = payload::manager::v1::TIER_RAM;
+      task.priority    = spill::SpillPriority::kEviction;
       scheduler_->Enqueue(task);
       payload::observability::Metrics::Instance().SetSpillQueueDepth(scheduler_->QueueDepth());
     }
@@ -73,6 +85,7 @@ void TieringManager::Loop() {
       spill::SpillTask task;
       task.id          = *victim;
       task.target_tier = manager_->GetDiskSpillTarget(*victim);
+      task.priority    = spill::SpillPriority::kEviction;
       scheduler_->Enqueue(task);
       payload::observability::Metrics::Instance().SetSpillQueueDepth(scheduler_->QueueDepth());
     }
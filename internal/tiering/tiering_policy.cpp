@@ -15,6 +15,14 @@ TieringPolicy::TieringPolicy(std::shared_ptr<payload::metadata::MetadataCache>
       is_disk_evictable_(std::move(is_disk_evictable)) {
 }
 
+TieringPolicy::TieringPolicy(LruSource                                                   lru_source,
+                             std::function<bool(const payload::manager::v1::PayloadID&)> is_ram_evictable,
+                             std::function<bool(const payload::manager::v1::PayloadID&)> is_gpu_evictable,
+                             std::function<bool(const payload::manager::v1::PayloadID&)> is_disk_evictable)
+    : lru_source_(std::move(lru_source)), is_ram_evictable_(std::move(is_ram_evictable)), is_gpu_evictable_(std::move(is_gpu_evictable)),
+      is_disk_evictable_(std::move(is_disk_evictable)) {
+}
+
 namespace {
 
 std::optional<PayloadID> ChooseVictimFromMetadataCache(const std::shared_ptr<payload::metadata::MetadataCache>&           cache,
@@ -32,22 +40,41 @@ std::optional<PayloadID> ChooseVictimFromMetadataCache(const std::shared_ptr<pay
 
 } // namespace
 
+std::optional<PayloadID> TieringPolicy::ChooseVictim(Tier tier, const std::function<bool(const payload::manager::v1::PayloadID&)>& predicate) {
+  if (lru_source_) {
+    return lru_source_(tier, predicate);
+  }
+  return ChooseVictimFromMetadataCache(cache_, predicate);
+}
+
 std::optional<PayloadID> TieringPolicy::ChooseRamEviction(const PressureState& state) {
   if (!state.RamPressure()) return std::nullopt;
 
-  return ChooseVictimFromMetadataCache(cache_, is_ram_evictable_);
+  if (ram_node_of_) {
+    for (std::size_t node = 0; node < PressureState::kMaxNumaNodes; ++node) {
+      if (!state.RamNodePressure(node)) continue;
+      const auto on_node = [&](const PayloadID& id) {
+        return (!is_ram_evictable_ || is_ram_evictable_(id)) && ram_node_of_(id) == static_cast<uint32_t>(node);
+      };
+      if (auto victim = ChooseVictim(TIER_RAM, on_node)) return victim;
+    }
+    // Node pressure alone never evicts from another node.
+    if (!state.RamTierPressure()) return std::nullopt;
+  }
+
+  return ChooseVictim(TIER_RAM, is_ram_evictable_);
 }
 
 std::optional<PayloadID> TieringPolicy::ChooseGpuEviction(const PressureState& state) {
   if (!state.GpuPressure()) return std::nullopt;
 
-  return ChooseVictimFromMetadataCache(cache_, is_gpu_evictable_);
+  return ChooseVictim(TIER_GPU, is_gpu_evictable_);
 }
 
 std::optional<PayloadID> TieringPolicy::ChooseDiskEviction(const PressureState& state) {
   if (!state.DiskPressure()) return std::nullopt;
 
-  return ChooseVictimFromMetadataCache(cache_, is_disk_evictable_);
+  return ChooseVictim(TIER_DISK, is_disk_evictable_);
 }
 
 } // namespace payload::tiering
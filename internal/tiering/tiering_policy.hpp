@@ -1,6 +1,7 @@
 #pragma once
 
 #include <functional>
+#include <memory>
 #include <optional>
 
 #include "payload/manager/core/v1/id.pb.h"
@@ -18,6 +19,11 @@ namespace payload::tiering {
 */
 class TieringPolicy {
  public:
+  // Returns the least recently used payload on the given tier that is a valid
+  // eviction candidate and satisfies the predicate (when set).
+  using LruSource = std::function<std::optional<payload::manager::v1::PayloadID>(
+      payload::manager::v1::Tier, const std::function<bool(const payload::manager::v1::PayloadID&)>&)>;
+
   // is_ram_evictable: returns true if the given payload may be evicted from RAM.
   // is_gpu_evictable: returns true if the given payload may be evicted from GPU.
   // Both predicates should additionally check that the payload is on the
@@ -27,15 +33,36 @@ class TieringPolicy {
                 std::function<bool(const payload::manager::v1::PayloadID&)> is_gpu_evictable  = {},
                 std::function<bool(const payload::manager::v1::PayloadID&)> is_disk_evictable = {});
 
+  // Selects victims from an LRU source that already filters by tier and
+  // eviction exemption (e.g. PayloadManager::LeastRecentlyUsed).
+  TieringPolicy(LruSource                                                   lru_source,
+                std::function<bool(const payload::manager::v1::PayloadID&)> is_ram_evictable  = {},
+                std::function<bool(const payload::manager::v1::PayloadID&)> is_gpu_evictable  = {},
+                std::function<bool(const payload::manager::v1::PayloadID&)> is_disk_evictable = {});
+
+  // NUMA node a RAM payload is bound to; unset when unknown.
+  using RamNodeSource = std::function<std::optional<uint32_t>(const payload::manager::v1::PayloadID&)>;
+
+  // Enables per-node RAM eviction: a node over its limit evicts payloads
+  // bound to it before the tier-wide LRU is consulted.
+  void SetRamNodeSource(RamNodeSource ram_node_of) {
+    ram_node_of_ = std::move(ram_node_of);
+  }
+
   std::optional<payload::manager::v1::PayloadID> ChooseRamEviction(const PressureState& state);
   std::optional<payload::manager::v1::PayloadID> ChooseGpuEviction(const PressureState& state);
   std::optional<payload::manager::v1::PayloadID> ChooseDiskEviction(const PressureState& state);
 
  private:
+  std::optional<payload::manager::v1::PayloadID> ChooseVictim(payload::manager::v1::Tier                                         tier,
+                                                              const std::function<bool(const payload::manager::v1::PayloadID&)>& predicate);
+
   std::shared_ptr<payload::metadata::MetadataCache>           cache_;
+  LruSource                                                   lru_source_;
   std::function<bool(const payload::manager::v1::PayloadID&)> is_ram_evictable_;
   std::function<bool(const payload::manager::v1::PayloadID&)> is_gpu_evictable_;
   std::function<bool(const payload::manager::v1::PayloadID&)> is_disk_evictable_;
+  RamNodeSource                                               ram_node_of_;
 };
 
 } // namespace payload::tiering
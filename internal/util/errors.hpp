@@ -47,4 +47,10 @@ class InvalidArgument : public std::runtime_error {
   }
 };
 
+class DataLoss : public std::runtime_error {
+ public:
+  explicit DataLoss(const std::string& msg) : std::runtime_error(msg) {
+  }
+};
+
 } // namespace payload::util
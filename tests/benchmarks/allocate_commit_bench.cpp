@@ -8,14 +8,23 @@
     - MemoryRepository InsertPayload tx
     - PayloadManager::Commit (state transition + snapshot cache write)
     - PayloadMutex map growth under repeated allocation
+
+  The batch sweep compares per-item Allocate/Commit against AllocateBatch /
+  CommitBatch (the AllocatePayloads / CommitPayloads RPC paths) for batch
+  sizes 1..1024, reporting payloads/s for each and the batched speedup. Every
+  configuration ingests the same number of payloads into a fresh fixture.
 */
 
+#include <chrono>
+#include <iomanip>
 #include <iostream>
+#include <vector>
 
 #include "common/bench_fixture.hpp"
 #include "payload/manager/v1.hpp"
 
 using namespace payload::bench;
+using payload::core::PayloadManager;
 using payload::manager::v1::TIER_RAM;
 
 // ---------------------------------------------------------------------------
@@ -64,6 +73,65 @@ static void BenchAllocateCommitDelete(size_t payload_bytes) {
   PrintResult(result);
 }
 
+// ---------------------------------------------------------------------------
+// Bench: per-item vs batched Allocate + Commit across batch sizes
+// ---------------------------------------------------------------------------
+static double IngestPerItem(size_t payload_bytes, size_t total) {
+  BenchFixture                                 fix{};
+  std::vector<payload::manager::v1::PayloadID> ids;
+  ids.reserve(total);
+
+  const auto t0 = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < total; ++i) {
+    auto desc = fix.manager->Allocate(payload_bytes, TIER_RAM);
+    ids.push_back(fix.manager->Commit(desc.payload_id()).payload_id());
+  }
+  const auto elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+  for (const auto& id : ids) fix.manager->Delete(id, /*force=*/true);
+  return static_cast<double>(total) / elapsed_s;
+}
+
+static double IngestBatched(size_t payload_bytes, size_t total, size_t batch_size) {
+  BenchFixture                                 fix{};
+  std::vector<payload::manager::v1::PayloadID> ids;
+  ids.reserve(total);
+
+  std::vector<PayloadManager::AllocateSpec> specs(batch_size);
+  for (auto& spec : specs) {
+    spec.size_bytes = payload_bytes;
+    spec.preferred  = TIER_RAM;
+  }
+
+  const auto t0 = std::chrono::steady_clock::now();
+  for (size_t done = 0; done < total; done += batch_size) {
+    std::vector<payload::manager::v1::PayloadID> batch;
+    batch.reserve(batch_size);
+    for (const auto& result : fix.manager->AllocateBatch(specs)) {
+      if (result.ok()) batch.push_back(result.descriptor.payload_id());
+    }
+    fix.manager->CommitBatch(batch);
+    ids.insert(ids.end(), batch.begin(), batch.end());
+  }
+  const auto elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+  for (const auto& id : ids) fix.manager->Delete(id, /*force=*/true);
+  return static_cast<double>(ids.size()) / elapsed_s;
+}
+
+static void BenchBatchSweep(size_t payload_bytes, size_t total) {
+  std::cout << "\nbatch sweep: " << total << " x " << payload_bytes << " B payloads, allocate+commit RAM\n"
+            << std::left << std::setw(12) << "batch" << std::setw(20) << "per-item ops/s" << std::setw(20) << "batched ops/s" << "speedup\n"
+            << std::string(60, '-') << "\n";
+
+  const auto per_item = IngestPerItem(payload_bytes, total);
+  for (size_t batch_size = 1; batch_size <= 1024; batch_size *= 2) {
+    const auto batched = IngestBatched(payload_bytes, total, batch_size);
+    std::cout << std::left << std::setw(12) << batch_size << std::fixed << std::setprecision(0) << std::setw(20) << per_item << std::setw(20)
+              << batched << std::setprecision(2) << batched / per_item << "x\n";
+  }
+}
+
 int main() {
   PrintHeader();
 
@@ -77,5 +145,7 @@ int main() {
 
   for (size_t size : {256UL, 4096UL, 65536UL}) BenchAllocateCommitDelete(size);
 
+  BenchBatchSweep(4096, 4096);
+
   return 0;
 }
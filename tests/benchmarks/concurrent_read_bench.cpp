@@ -6,8 +6,9 @@
   Two paths are benchmarked:
 
   1. ResolveSnapshot (snapshot cache hit)
-     - Acquires shared lock on PayloadManager::snapshot_cache_mutex_
-     - No storage backend involved
+     - Acquires shared lock on one control-table shard in PayloadManager
+     - The location (slab block or segment) comes from the payload's
+       location block, so RamArrowStore::mutex_ is never taken
      - Models: multiple consumers reading descriptor metadata
 
   2. RamArrowStore::Read (direct storage read)
@@ -115,7 +116,7 @@ int main() {
 
   const size_t payload_bytes = 1048576; // 1 MB — large enough that lock overhead is visible
 
-  std::cout << "-- ResolveSnapshot (snapshot_cache_mutex shared lock)\n";
+  std::cout << "-- ResolveSnapshot (control-table shard shared lock, no store lock)\n";
   for (int threads : {1, 2, 4, 8, 16}) BenchConcurrentSnapshotResolve(payload_bytes, threads);
 
   std::cout << "\n-- RamArrowStore::Read (ram store shared_mutex)\n";
@@ -0,0 +1,166 @@
+/*
+  control_block_bench.cpp
+
+  Reports the per-payload memory cost of PayloadManager's in-memory state.
+
+  control table:  one 64-byte PayloadControlBlock per payload in the
+                  sharded PayloadControlTable (what PayloadManager keeps
+                  today). Measured at 1M and 10M payloads.
+
+  side tables:    the layout it replaced — a cached PayloadDescriptor
+                  protobuf behind a shared_ptr, a shared_ptr<shared_mutex>
+                  per payload, a spill-target map and a MetadataCache
+                  recency entry. Measured at 1M payloads only; at 10M it
+                  needs several GB.
+
+  Each configuration runs in a forked child so its RSS delta is not skewed
+  by memory the allocator retained from a previous run. Reported per
+  configuration: build time, table-reported bytes/payload (control table
+  only) and resident bytes/payload from /proc/self/statm.
+
+  Usage: payload_manager_bench_control_block [max_payloads]
+*/
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "internal/core/payload_control_block.hpp"
+#include "internal/metadata/metadata_cache.hpp"
+#include "internal/storage/ram/ram_arrow_store.hpp"
+#include "internal/util/uuid.hpp"
+#include "payload/manager/v1.hpp"
+
+using payload::core::PayloadControlBlock;
+using payload::core::PayloadControlTable;
+using payload::manager::v1::PayloadDescriptor;
+using payload::manager::v1::TIER_DISK;
+using payload::manager::v1::TIER_RAM;
+
+namespace {
+
+uint64_t ResidentBytes() {
+  std::ifstream statm("/proc/self/statm");
+  uint64_t      size_pages = 0;
+  uint64_t      rss_pages  = 0;
+  statm >> size_pages >> rss_pages;
+  return rss_pages * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+}
+
+void PrintRow(const std::string& name, uint64_t n, double build_s, double table_bytes, double rss_bytes) {
+  std::cout << std::left << std::setw(28) << name << std::setw(12) << n << std::setw(12) << std::fixed << std::setprecision(2) << build_s
+            << std::setw(18) << std::setprecision(1);
+  if (table_bytes > 0) {
+    std::cout << table_bytes;
+  } else {
+    std::cout << "-";
+  }
+  std::cout << std::setw(18) << rss_bytes << "\n";
+}
+
+// Runs fn in a child process and waits for it, so each measurement starts
+// from a fresh heap.
+template <typename Fn>
+void RunIsolated(Fn&& fn) {
+  std::cout.flush();
+  const pid_t pid = fork();
+  if (pid == 0) {
+    fn();
+    std::cout.flush();
+    _exit(0);
+  }
+  int status = 0;
+  waitpid(pid, &status, 0);
+}
+
+// ---------------------------------------------------------------------------
+// Bench: PayloadControlTable
+// ---------------------------------------------------------------------------
+void BenchControlTable(uint64_t n) {
+  const auto rss_before = ResidentBytes();
+  const auto t0         = std::chrono::steady_clock::now();
+
+  auto table = std::make_unique<PayloadControlTable>();
+  for (uint64_t i = 0; i < n; ++i) {
+    table->Update(payload::util::GenerateUUID(), /*create=*/true, [&](PayloadControlBlock& block) {
+      block.tier         = static_cast<uint8_t>(TIER_RAM);
+      block.state        = static_cast<uint8_t>(payload::manager::v1::PAYLOAD_STATE_ACTIVE);
+      block.version      = 2;
+      block.length_bytes = 4096;
+      block.spill_target = static_cast<uint8_t>(TIER_DISK);
+      block.flags        = PayloadControlBlock::kHasSnapshot | PayloadControlBlock::kHasLocation;
+      block.last_access.store(i, std::memory_order_relaxed);
+    });
+  }
+
+  const auto build_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  const auto rss     = ResidentBytes() - rss_before;
+  PrintRow("control table", n, build_s, static_cast<double>(table->MemoryBytes()) / static_cast<double>(n),
+           static_cast<double>(rss) / static_cast<double>(n));
+}
+
+// ---------------------------------------------------------------------------
+// Bench: the per-payload side tables the control table replaced
+// ---------------------------------------------------------------------------
+void BenchSideTables(uint64_t n) {
+  const auto rss_before = ResidentBytes();
+  const auto t0         = std::chrono::steady_clock::now();
+
+  std::unordered_map<payload::util::UUID, std::shared_ptr<const PayloadDescriptor>> snapshots;
+  std::unordered_map<payload::util::UUID, std::shared_ptr<std::shared_mutex>>       mutexes;
+  std::unordered_map<payload::util::UUID, payload::manager::v1::Tier>               spill_targets;
+  payload::metadata::MetadataCache                                                  recency;
+
+  for (uint64_t i = 0; i < n; ++i) {
+    const auto key = payload::util::GenerateUUID();
+    const auto id  = payload::util::ToProto(key);
+
+    PayloadDescriptor descriptor;
+    *descriptor.mutable_payload_id() = id;
+    descriptor.set_tier(TIER_RAM);
+    descriptor.set_state(payload::manager::v1::PAYLOAD_STATE_ACTIVE);
+    descriptor.set_version(2);
+    auto* ram = descriptor.mutable_ram();
+    ram->set_length_bytes(4096);
+    ram->set_shm_name(payload::storage::RamArrowStore::ShmName(id, "pm"));
+    snapshots.emplace(key, std::make_shared<const PayloadDescriptor>(std::move(descriptor)));
+
+    mutexes.emplace(key, std::make_shared<std::shared_mutex>());
+    spill_targets.emplace(key, TIER_DISK);
+
+    payload::manager::v1::PayloadMetadata minimal;
+    *minimal.mutable_id() = id;
+    recency.Put(id, minimal);
+  }
+
+  const auto build_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  const auto rss     = ResidentBytes() - rss_before;
+  PrintRow("side tables (previous)", n, build_s, 0, static_cast<double>(rss) / static_cast<double>(n));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const uint64_t max_payloads = argc > 1 ? std::stoull(argv[1]) : 10'000'000;
+
+  std::cout << std::left << std::setw(28) << "benchmark" << std::setw(12) << "payloads" << std::setw(12) << "build (s)" << std::setw(18)
+            << "table B/payload" << std::setw(18) << "RSS B/payload" << "\n"
+            << std::string(88, '-') << "\n";
+
+  for (const uint64_t n : {uint64_t{1'000'000}, uint64_t{10'000'000}}) {
+    if (n > max_payloads) break;
+    RunIsolated([n] { BenchControlTable(n); });
+  }
+  RunIsolated([&] { BenchSideTables(std::min<uint64_t>(max_payloads, 1'000'000)); });
+  return 0;
+}
@@ -0,0 +1,122 @@
+/*
+  delete_storm_bench.cpp
+
+  Companion to concurrent_read_bench: measures AcquireReadLease latency for
+  readers of healthy payloads while a "delete storm" force-deletes other
+  payloads that still have a lease outstanding.
+
+  Each storm delete must wait in WaitUntilNoLeases until the slow holder of
+  the victim's lease releases it (kHolderMs). Delete coordination is scoped
+  to the payload being deleted, so readers of unrelated payloads should see
+  the same latency distribution with and without the storm; a process-wide
+  delete lock would instead push their tail latency up to kHolderMs.
+
+  Reported per configuration: lease acquire+release count and p50 / p99 /
+  max latency in microseconds across all reader threads.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "common/bench_fixture.hpp"
+#include "payload/manager/v1.hpp"
+
+using namespace payload::bench;
+using payload::manager::v1::TIER_RAM;
+
+namespace {
+
+constexpr auto kHolderMs      = std::chrono::milliseconds(20);
+constexpr auto kRunDuration   = std::chrono::milliseconds(1000);
+constexpr int  kLeaseDuration = 5'000;
+
+double PercentileUs(std::vector<double>& samples_ns, double p) {
+  if (samples_ns.empty()) return 0.0;
+  const auto idx = static_cast<size_t>(p * static_cast<double>(samples_ns.size() - 1));
+  std::nth_element(samples_ns.begin(), samples_ns.begin() + static_cast<std::ptrdiff_t>(idx), samples_ns.end());
+  return samples_ns[idx] / 1e3;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Bench: lease acquire latency on healthy payloads, with/without delete storm
+// ---------------------------------------------------------------------------
+static void BenchLeaseLatencyUnderDeleteStorm(int n_readers, bool storm) {
+  BenchFixture fix{};
+
+  std::vector<payload::manager::v1::PayloadID> reader_ids;
+  reader_ids.reserve(n_readers);
+  for (int i = 0; i < n_readers; ++i) reader_ids.push_back(fix.MakeRamPayload(4096).payload_id());
+
+  std::atomic<bool> stop{false};
+  std::atomic<int>  deletes{0};
+
+  std::thread storm_thread;
+  if (storm) {
+    storm_thread = std::thread([&] {
+      while (!stop.load(std::memory_order_relaxed)) {
+        const auto victim = fix.MakeRamPayload(4096).payload_id();
+        const auto lease  = fix.manager->AcquireReadLease(victim, TIER_RAM, kLeaseDuration);
+
+        // Slow holder: keeps the victim's lease for kHolderMs, so the force
+        // delete below blocks in WaitUntilNoLeases for that long.
+        std::thread holder([&] {
+          std::this_thread::sleep_for(kHolderMs);
+          fix.manager->ReleaseLease(lease.lease_id());
+        });
+        fix.manager->Delete(victim, /*force=*/true);
+        holder.join();
+        deletes.fetch_add(1, std::memory_order_relaxed);
+      }
+    });
+    // Let the first delete start draining before readers begin.
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+
+  std::vector<std::vector<double>> samples(n_readers);
+  std::vector<std::thread>         readers;
+  readers.reserve(n_readers);
+  const auto deadline = std::chrono::steady_clock::now() + kRunDuration;
+  for (int t = 0; t < n_readers; ++t) {
+    readers.emplace_back([&, t] {
+      auto& out = samples[t];
+      while (std::chrono::steady_clock::now() < deadline) {
+        const auto t0    = std::chrono::steady_clock::now();
+        const auto lease = fix.manager->AcquireReadLease(reader_ids[t], TIER_RAM, kLeaseDuration);
+        fix.manager->ReleaseLease(lease.lease_id());
+        const auto t1 = std::chrono::steady_clock::now();
+        out.push_back(static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count()));
+      }
+    });
+  }
+  for (auto& th : readers) th.join();
+  stop.store(true);
+  if (storm_thread.joinable()) storm_thread.join();
+
+  std::vector<double> all;
+  for (auto& s : samples) all.insert(all.end(), s.begin(), s.end());
+  const auto ops    = all.size();
+  const auto max_us = all.empty() ? 0.0 : *std::max_element(all.begin(), all.end()) / 1e3;
+  const auto p50    = PercentileUs(all, 0.50);
+  const auto p99    = PercentileUs(all, 0.99);
+
+  const auto name = std::string(storm ? "lease+release storm" : "lease+release idle") + " readers=" + std::to_string(n_readers);
+  std::cout << std::left << std::setw(36) << name << std::setw(10) << ops << std::setw(10) << (storm ? deletes.load() : 0) << std::setw(12)
+            << std::fixed << std::setprecision(2) << p50 << std::setw(12) << p99 << std::setw(12) << max_us << "\n";
+}
+
+int main() {
+  std::cout << std::left << std::setw(36) << "benchmark" << std::setw(10) << "ops" << std::setw(10) << "deletes" << std::setw(12) << "p50 (µs)"
+            << std::setw(12) << "p99 (µs)" << std::setw(12) << "max (µs)" << "\n"
+            << std::string(92, '-') << "\n";
+
+  for (int readers : {1, 4, 16}) {
+    BenchLeaseLatencyUnderDeleteStorm(readers, /*storm=*/false);
+    BenchLeaseLatencyUnderDeleteStorm(readers, /*storm=*/true);
+  }
+  return 0;
+}
@@ -0,0 +1,65 @@
+/*
+  disk_pack_bench.cpp
+
+  Per-payload cost of writing, reading and removing small payloads on the
+  disk tier, one file each versus packed into shared segment files.
+
+  Rows per payload size:
+    files   — <uuid>.bin per payload (tmp + rename on write)
+    packed  — one appended record per payload, pread on read, tombstone on remove
+
+  Usage: payload_manager_bench_disk_pack [iterations]
+*/
+
+#include <unistd.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/bench_fixture.hpp"
+#include "internal/storage/disk/disk_arrow_store.hpp"
+#include "internal/util/uuid.hpp"
+
+using namespace payload::bench;
+
+namespace {
+
+void BenchLayout(bool packed, size_t payload_bytes, int iterations) {
+  const auto root = std::filesystem::temp_directory_path() / ("pm-pack-bench-" + std::to_string(getpid()));
+
+  payload::storage::DiskStoreOptions options;
+  options.pack.enabled             = packed;
+  options.pack.compaction_interval = std::chrono::milliseconds(0);
+  auto store                       = std::make_unique<payload::storage::DiskArrowStore>(root, options);
+
+  const auto                                   buffer = arrow::Buffer::FromString(std::string(payload_bytes, 'p'));
+  std::vector<payload::manager::v1::PayloadID> ids;
+  for (int i = 0; i < iterations + 3; ++i) ids.push_back(payload::util::ToProto(payload::util::GenerateUUID()));
+
+  const std::string layout = packed ? "packed" : "files";
+  size_t            next   = 0;
+  PrintResult(TimedRun("disk Write (" + layout + ")", payload_bytes, iterations, [&] { store->Write(ids[next++], buffer, /*fsync=*/false); }));
+  next = 0;
+  PrintResult(TimedRun("disk Read (" + layout + ")", payload_bytes, iterations, [&] { store->Read(ids[next++]); }));
+  next = 0;
+  PrintResult(TimedRun("disk Remove (" + layout + ")", payload_bytes, iterations, [&] { store->Remove(ids[next++]); }));
+
+  store.reset();
+  std::filesystem::remove_all(root);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const int iterations = argc > 1 ? std::atoi(argv[1]) : 4096;
+
+  PrintHeader();
+  for (const size_t size : {size_t{1} << 10, size_t{16} << 10, size_t{64} << 10}) {
+    BenchLayout(/*packed=*/false, size, iterations);
+    BenchLayout(/*packed=*/true, size, iterations);
+  }
+  return 0;
+}
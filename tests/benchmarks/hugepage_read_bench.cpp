@@ -0,0 +1,129 @@
+/*
+  hugepage_read_bench.cpp
+
+  Compares read throughput of a RAM-tier payload backed by base pages
+  (POSIX shm, 4 KiB) against one backed by huge pages (hugetlbfs, 2 MiB).
+
+  sequential:  sums the payload front to back as 64-bit words.
+  random:      loads one 64-byte line at a pseudo-random offset per step,
+               so most steps miss the TLB on base pages.
+
+  Each segment is written once before timing so page faults are excluded;
+  the difference left is TLB reach. When the hugetlbfs mount is missing or
+  its page pool is too small the 2 MiB row reports why instead.
+
+  Usage: payload_manager_bench_hugepage_read [payload_mib] [hugetlbfs_path]
+*/
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "internal/storage/ram/ram_arrow_store.hpp"
+#include "internal/util/uuid.hpp"
+#include "payload/manager/v1.hpp"
+
+using payload::storage::RamArrowStore;
+using payload::storage::RamHugePageOptions;
+using payload::storage::RamSlabOptions;
+
+namespace {
+
+constexpr int      kRounds       = 5;
+constexpr uint64_t kRandomLoads  = 16'000'000;
+constexpr uint64_t kLineBytes    = 64;
+constexpr uint64_t kSeqWordBytes = sizeof(uint64_t);
+
+volatile uint64_t g_sink = 0;
+
+double SequentialGiBps(const uint8_t* data, uint64_t size) {
+  const auto* words = reinterpret_cast<const uint64_t*>(data);
+  const auto  count = size / kSeqWordBytes;
+  uint64_t    sum   = 0;
+
+  const auto t0 = std::chrono::steady_clock::now();
+  for (int round = 0; round < kRounds; ++round) {
+    for (uint64_t i = 0; i < count; ++i) {
+      sum += words[i];
+    }
+  }
+  const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  g_sink             = sum;
+  return static_cast<double>(size) * kRounds / elapsed / static_cast<double>(1ull << 30);
+}
+
+double RandomNsPerLoad(const uint8_t* data, uint64_t size) {
+  const uint64_t  lines = size / kLineBytes;
+  std::mt19937_64 rng(42);
+  uint64_t        x   = rng();
+  uint64_t        sum = 0;
+
+  const auto t0 = std::chrono::steady_clock::now();
+  for (uint64_t i = 0; i < kRandomLoads; ++i) {
+    // xorshift keeps the index generator out of the measurement.
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    sum += *reinterpret_cast<const uint64_t*>(data + (x % lines) * kLineBytes);
+  }
+  const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  g_sink             = sum;
+  return elapsed * 1e9 / static_cast<double>(kRandomLoads);
+}
+
+void PrintRow(const std::string& name, uint64_t page_bytes, double seq_gibps, double random_ns) {
+  std::cout << std::left << std::setw(12) << name << std::setw(14) << page_bytes << std::setw(18) << std::fixed << std::setprecision(2)
+            << seq_gibps << std::setw(18) << random_ns << "\n";
+}
+
+void Run(const std::string& name, uint64_t size, const RamHugePageOptions& huge_pages) {
+  RamSlabOptions no_slabs;
+  no_slabs.enabled = false;
+  RamArrowStore store("pm-bench-hugepage-" + std::to_string(getpid()), no_slabs, huge_pages);
+
+  const auto id       = payload::util::ToProto(payload::util::GenerateUUID());
+  auto       buf      = store.Allocate(id, size);
+  const auto location = store.Locate(id, size);
+  if (huge_pages.enabled && location.page_size_bytes() == 0) {
+    std::cout << std::left << std::setw(12) << name << "unavailable: "
+              << (store.HugePageBytes() == 0 ? huge_pages.mount_path + " is not a hugetlbfs mount" : "huge page pool exhausted") << "\n";
+    store.Remove(id);
+    return;
+  }
+
+  // Fault every page in before timing.
+  std::memset(buf->mutable_data(), 0x5A, size);
+
+  const auto page_bytes = location.page_size_bytes() != 0 ? location.page_size_bytes() : static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+  PrintRow(name, page_bytes, SequentialGiBps(buf->data(), size), RandomNsPerLoad(buf->data(), size));
+
+  buf.reset();
+  store.Remove(id);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const uint64_t size = (argc > 1 ? std::stoull(argv[1]) : 1024) << 20;
+
+  RamHugePageOptions huge_pages;
+  huge_pages.enabled = true;
+  if (argc > 2) {
+    huge_pages.mount_path = argv[2];
+  }
+
+  std::cout << "payload " << (size >> 20) << " MiB, " << kRounds << " sequential passes, " << kRandomLoads << " random loads\n"
+            << std::left << std::setw(12) << "pages" << std::setw(14) << "page bytes" << std::setw(18) << "sequential GiB/s" << std::setw(18)
+            << "random ns/load" << "\n"
+            << std::string(62, '-') << "\n";
+
+  Run("4K (shm)", size, RamHugePageOptions{});
+  Run("2M (huge)", size, huge_pages);
+  return 0;
+}
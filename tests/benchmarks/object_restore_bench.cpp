@@ -0,0 +1,101 @@
+/*
+  object_restore_bench.cpp
+
+  OBJECT -> RAM restore time as ranged-read concurrency grows.
+
+  CopyPayload opens an ObjectPayloadReader whose ReadAt splits each chunk
+  into range_bytes requests issued concurrently, writing straight into the
+  destination shm segment. Concurrency 1 is a single sequential stream.
+
+  On the local filesystem stand-in the object stays in the page cache, so
+  the numbers only show what this host's cores add; point root_uri at
+  MinIO to measure per-connection limits.
+
+  Usage: payload_manager_bench_object_restore [payload_mib] [root_uri]
+
+    root_uri defaults to a temporary local directory; for MinIO pass e.g.
+    s3://bucket/prefix?endpoint_override=localhost:9000&scheme=http
+*/
+
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "common/bench_fixture.hpp"
+#include "internal/storage/common/arrow_utils.hpp"
+#include "internal/storage/object/object_arrow_store.hpp"
+#include "internal/storage/payload_transfer.hpp"
+#include "internal/storage/ram/ram_arrow_store.hpp"
+#include "internal/util/uuid.hpp"
+#include "payload/manager/v1.hpp"
+
+using namespace payload::bench;
+using payload::storage::ObjectArrowStore;
+using payload::storage::RamArrowStore;
+using payload::storage::RangedReadOptions;
+
+namespace {
+
+constexpr uint64_t kRangeBytes = uint64_t{8} << 20;
+
+void BenchRestore(const std::string& root_uri, size_t payload_bytes, uint32_t concurrency) {
+  auto [fs, root] =
+      payload::storage::common::Unwrap(payload::storage::common::ResolveFileSystem(root_uri, pb::arrow::storage::FILE_SYSTEM_AUTO, {}));
+  (void)fs->CreateDir(root);
+
+  RangedReadOptions ranged_reads;
+  ranged_reads.range_bytes = kRangeBytes;
+  ranged_reads.concurrency = concurrency;
+  ObjectArrowStore object(fs, root, root_uri.rfind("s3://", 0) == 0, {}, ranged_reads);
+  RamArrowStore    ram("pm-bench-restore-" + std::to_string(getpid()));
+
+  const auto id = payload::util::ToProto(payload::util::GenerateUUID());
+  {
+    auto allocated = arrow::AllocateBuffer(static_cast<int64_t>(payload_bytes));
+    if (!allocated.ok()) throw std::runtime_error(allocated.status().ToString());
+    std::memset((*allocated)->mutable_data(), 0x5A, payload_bytes);
+    object.Write(id, std::shared_ptr<arrow::Buffer>(std::move(*allocated)), false);
+  }
+
+  const payload::storage::TransferOptions transfer;
+  const int                               iterations = IterationsFor(payload_bytes, 2048ULL * 1024 * 1024, 50);
+
+  auto result = TimedRun("Restore OBJECT->RAM x" + std::to_string(concurrency) + " (8 MB ranges)", payload_bytes, iterations, [&] {
+    payload::storage::CopyPayload(object, ram, id, false, transfer);
+    ram.Remove(id);
+  });
+  PrintResult(result);
+  const double ms_per_gb = result.total_ns / result.iterations / 1e6 * (1024.0 * 1024 * 1024 / static_cast<double>(payload_bytes));
+  std::cout << "  ms per GB: " << std::fixed << std::setprecision(1) << ms_per_gb << "\n";
+
+  object.Remove(id);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const size_t payload_bytes = (argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 256) << 20;
+
+  std::filesystem::path local_root;
+  std::string           root_uri;
+  if (argc > 2) {
+    root_uri = argv[2];
+  } else {
+    local_root = std::filesystem::temp_directory_path() / ("payload_bench_object_restore_" + std::to_string(getpid()));
+    std::filesystem::create_directories(local_root);
+    root_uri = local_root.string();
+  }
+
+  PrintHeader();
+  std::cout << "\n-- Object tier restore, " << root_uri << "\n";
+  for (uint32_t concurrency : {1u, 2u, 4u, 8u}) BenchRestore(root_uri, payload_bytes, concurrency);
+
+  if (!local_root.empty()) std::filesystem::remove_all(local_root);
+  return 0;
+}
@@ -0,0 +1,90 @@
+/*
+  object_upload_bench.cpp
+
+  ObjectArrowStore::Write throughput as upload concurrency grows.
+
+  The payload is cut into part_bytes slices of the source buffer and the
+  parts are uploaded concurrently: the local filesystem stand-in pwrites
+  them into one temporary file, S3 (MinIO) uploads them as background
+  multipart parts. Concurrency 1 is the old single-stream upload.
+
+  Each iteration overwrites the same object. On the local filesystem the
+  target stays in the page cache, so the numbers show how far parallel
+  copies into the page cache scale on this host, not device bandwidth.
+
+  Usage: payload_manager_bench_object_upload [payload_mib] [root_uri]
+
+    root_uri defaults to a temporary local directory; for MinIO pass e.g.
+    s3://bucket/prefix?endpoint_override=localhost:9000&scheme=http
+*/
+
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "common/bench_fixture.hpp"
+#include "internal/storage/common/arrow_utils.hpp"
+#include "internal/storage/object/object_arrow_store.hpp"
+#include "internal/util/uuid.hpp"
+#include "payload/manager/v1.hpp"
+
+using namespace payload::bench;
+using payload::storage::MultipartOptions;
+using payload::storage::ObjectArrowStore;
+
+namespace {
+
+constexpr uint64_t kPartBytes = uint64_t{8} << 20;
+
+void BenchUpload(const std::string& root_uri, size_t payload_bytes, uint32_t concurrency) {
+  auto [fs, root] =
+      payload::storage::common::Unwrap(payload::storage::common::ResolveFileSystem(root_uri, pb::arrow::storage::FILE_SYSTEM_AUTO, {}));
+  (void)fs->CreateDir(root);
+
+  MultipartOptions multipart;
+  multipart.part_bytes  = kPartBytes;
+  multipart.concurrency = concurrency;
+  ObjectArrowStore object(fs, root, root_uri.rfind("s3://", 0) == 0, multipart);
+
+  auto allocated = arrow::AllocateBuffer(static_cast<int64_t>(payload_bytes));
+  if (!allocated.ok()) throw std::runtime_error(allocated.status().ToString());
+  std::memset((*allocated)->mutable_data(), 0x5A, payload_bytes);
+  const std::shared_ptr<arrow::Buffer> buffer(std::move(*allocated));
+
+  const auto id         = payload::util::ToProto(payload::util::GenerateUUID());
+  const int  iterations = IterationsFor(payload_bytes, 2048ULL * 1024 * 1024, 50);
+
+  auto result = TimedRun("Object upload x" + std::to_string(concurrency) + " (8 MB parts)", payload_bytes, iterations,
+                         [&] { object.Write(id, buffer, false); });
+  PrintResult(result);
+
+  object.Remove(id);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const size_t payload_bytes = (argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 256) << 20;
+
+  std::filesystem::path local_root;
+  std::string           root_uri;
+  if (argc > 2) {
+    root_uri = argv[2];
+  } else {
+    local_root = std::filesystem::temp_directory_path() / ("payload_bench_object_upload_" + std::to_string(getpid()));
+    std::filesystem::create_directories(local_root);
+    root_uri = local_root.string();
+  }
+
+  PrintHeader();
+  std::cout << "\n-- Object tier upload, " << root_uri << "\n";
+  for (uint32_t concurrency : {1u, 2u, 4u, 8u}) BenchUpload(root_uri, payload_bytes, concurrency);
+
+  if (!local_root.empty()) std::filesystem::remove_all(local_root);
+  return 0;
+}
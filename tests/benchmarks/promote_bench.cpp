@@ -0,0 +1,111 @@
+/*
+  promote_bench.cpp
+
+  DISK -> RAM promotion latency per GB on the real stores.
+
+  Read + Write     DiskArrowStore::Read into a heap buffer, then
+                   RamArrowStore::Write copies it into a new shm segment:
+                   two copies and a payload-sized heap allocation.
+  in place         CopyPayload: the RAM tier places the segment first and
+                   the disk reader preads straight into the mapping, one
+                   chunk at a time, under sequential / WILLNEED hints.
+  in place + uring Same, with reads going through the io_uring engine.
+
+  Each iteration promotes the same file and removes the segment again, so
+  segment creation and page faults are included. The source file stays in
+  the page cache after the first pass; drop caches between runs
+  (echo 1 > /proc/sys/vm/drop_caches) to measure cold reads.
+
+  Usage: payload_manager_bench_promote [max_payload_mib]
+*/
+
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "common/bench_fixture.hpp"
+#include "internal/storage/disk/disk_arrow_store.hpp"
+#include "internal/storage/payload_transfer.hpp"
+#include "internal/storage/ram/ram_arrow_store.hpp"
+#include "internal/util/uuid.hpp"
+#include "payload/manager/v1.hpp"
+
+using namespace payload::bench;
+using payload::storage::DiskArrowStore;
+using payload::storage::DiskStoreOptions;
+using payload::storage::RamArrowStore;
+
+namespace {
+
+enum class Mode { kReadWrite, kInPlace, kInPlaceUring };
+
+const char* ModeName(Mode mode) {
+  switch (mode) {
+    case Mode::kReadWrite:
+      return "Promote DISK->RAM Read+Write";
+    case Mode::kInPlace:
+      return "Promote DISK->RAM in place";
+    case Mode::kInPlaceUring:
+      return "Promote DISK->RAM in place + uring";
+  }
+  return "";
+}
+
+void BenchPromote(size_t payload_bytes, Mode mode) {
+  const std::filesystem::path disk_root = std::filesystem::temp_directory_path() / "payload_bench_promote";
+  std::filesystem::create_directories(disk_root);
+
+  DiskStoreOptions disk_options;
+  disk_options.io_uring.enabled = mode == Mode::kInPlaceUring;
+  DiskArrowStore disk(disk_root, disk_options);
+  if (mode == Mode::kInPlaceUring && !disk.UsesIoUring()) {
+    std::cout << std::left << std::setw(44) << ModeName(mode) << "skipped: io_uring unavailable\n";
+    return;
+  }
+  RamArrowStore ram("pm-bench-promote-" + std::to_string(getpid()));
+
+  const auto id = payload::util::ToProto(payload::util::GenerateUUID());
+  {
+    auto src = ram.Allocate(id, payload_bytes);
+    std::memset(src->mutable_data(), 0x5A, payload_bytes);
+    disk.Write(id, src, false);
+    ram.Remove(id);
+  }
+
+  const payload::storage::TransferOptions transfer;
+  const int                               iterations = IterationsFor(payload_bytes, 1024ULL * 1024 * 1024, 200);
+
+  auto result = TimedRun(ModeName(mode), payload_bytes, iterations, [&] {
+    if (mode == Mode::kReadWrite) {
+      ram.Write(id, disk.Read(id), false);
+    } else {
+      payload::storage::CopyPayload(disk, ram, id, false, transfer);
+    }
+    ram.Remove(id);
+  });
+
+  PrintResult(result);
+  const double ms_per_gb = result.total_ns / result.iterations / 1e6 * (1024.0 * 1024 * 1024 / static_cast<double>(payload_bytes));
+  std::cout << "  ms per GB: " << std::fixed << std::setprecision(1) << ms_per_gb << "\n";
+
+  disk.Remove(id);
+  std::filesystem::remove_all(disk_root);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const size_t max_bytes = (argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 256) << 20;
+
+  PrintHeader();
+  std::cout << "\n-- DISK -> RAM promotion (page-cache-warm source)\n";
+  for (size_t size = 1 << 20; size <= max_bytes; size *= 4) {
+    for (Mode mode : {Mode::kReadWrite, Mode::kInPlace, Mode::kInPlaceUring}) BenchPromote(size, mode);
+  }
+  return 0;
+}
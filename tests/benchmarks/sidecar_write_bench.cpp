@@ -0,0 +1,111 @@
+/*
+  sidecar_write_bench.cpp
+
+  Per-payload cost of WriteSidecar on the disk and object tiers, by format.
+
+  Rows per tier:
+    json      — pretty-printed <uuid>.meta.json, one file per payload
+    binary    — <uuid>.meta.pb, one file per payload
+    manifest  — batched into segments of 256 entries, one file per segment
+
+  The object tier runs over Arrow's LocalFileSystem, so it shows the
+  serialization and file costs but not the request round trip a real
+  object store adds to every per-payload sidecar.
+
+  Usage: payload_manager_bench_sidecar_write [iterations]
+*/
+
+#include <arrow/filesystem/localfs.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/bench_fixture.hpp"
+#include "internal/storage/common/sidecar.hpp"
+#include "internal/storage/disk/disk_arrow_store.hpp"
+#include "internal/storage/object/object_arrow_store.hpp"
+#include "internal/util/uuid.hpp"
+#include "payload/manager/catalog/v1/archive_metadata.pb.h"
+
+using namespace payload::bench;
+using payload::storage::common::SidecarFormat;
+using payload::storage::common::SidecarOptions;
+
+namespace {
+
+// Metadata as BuildSidecar produces it for a spilled payload.
+payload::manager::catalog::v1::PayloadArchiveMetadata Metadata(const payload::manager::v1::PayloadID& id) {
+  payload::manager::catalog::v1::PayloadArchiveMetadata meta;
+  *meta.mutable_uuid() = id;
+  meta.set_metadata_version(1);
+  meta.mutable_archived_at()->set_seconds(1700000000);
+  auto* descriptor                  = meta.mutable_payload_descriptor();
+  *descriptor->mutable_payload_id() = id;
+  descriptor->set_tier(payload::manager::v1::TIER_DISK);
+  descriptor->mutable_disk()->set_path(payload::util::ToString(payload::util::FromProto(id)) + ".bin");
+  descriptor->mutable_disk()->set_length_bytes(4096);
+  meta.mutable_integrity()->set_algorithm(payload::manager::catalog::v1::HASH_CRC32C);
+  meta.mutable_integrity()->set_checksum(std::string("\x12\x34\x56\x78", 4));
+  return meta;
+}
+
+const char* FormatName(SidecarFormat format) {
+  switch (format) {
+    case SidecarFormat::kBinary:
+      return "binary";
+    case SidecarFormat::kManifest:
+      return "manifest";
+    default:
+      return "json";
+  }
+}
+
+void BenchTier(const std::string& tier, int iterations) {
+  for (const auto format : {SidecarFormat::kJson, SidecarFormat::kBinary, SidecarFormat::kManifest}) {
+    const auto root = std::filesystem::temp_directory_path() / ("pm-sidecar-bench-" + std::to_string(getpid()));
+    std::filesystem::create_directories(root);
+
+    SidecarOptions options;
+    options.format               = format;
+    options.manifest_max_entries = 256;
+
+    std::shared_ptr<payload::storage::StorageBackend> store;
+    if (tier == "disk") {
+      payload::storage::DiskStoreOptions disk_options;
+      disk_options.sidecars = options;
+      store                 = std::make_shared<payload::storage::DiskArrowStore>(root, disk_options);
+    } else {
+      store = std::make_shared<payload::storage::ObjectArrowStore>(std::make_shared<arrow::fs::LocalFileSystem>(), root.string(), /*is_s3=*/false,
+                                                                   payload::storage::MultipartOptions{}, payload::storage::RangedReadOptions{},
+                                                                   options);
+    }
+
+    std::vector<payload::manager::catalog::v1::PayloadArchiveMetadata> metas;
+    for (int i = 0; i < iterations + 3; ++i) metas.push_back(Metadata(payload::util::ToProto(payload::util::GenerateUUID())));
+
+    size_t next = 0;
+    PrintResult(TimedRun(tier + " WriteSidecar (" + FormatName(format) + ")", 0, iterations, [&] {
+      const auto& meta = metas[next++];
+      store->WriteSidecar(meta.uuid(), meta);
+    }));
+
+    store.reset();
+    std::filesystem::remove_all(root);
+  }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const int iterations = argc > 1 ? std::atoi(argv[1]) : 4096;
+
+  PrintHeader();
+  BenchTier("disk", iterations);
+  BenchTier("object", iterations);
+  return 0;
+}
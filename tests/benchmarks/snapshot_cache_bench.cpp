@@ -3,8 +3,10 @@
 
   Measures ResolveSnapshot latency for cache hits vs cache misses.
 
-  Cache hit:   snapshot_cache_ populated on Commit — served from an
-               unordered_map under a shared_mutex. Should be very fast.
+  Cache hit:   control block populated on Commit — the descriptor is
+               rebuilt from one of 64 control-table shards under that
+               shard's shared_mutex, without touching the per-payload
+               lock word. Should be very fast.
 
   Cache miss:  HydrateCaches() clears and rebuilds the cache from the
                repository. After clearing, the first ResolveSnapshot per
@@ -12,10 +14,18 @@
                cost after a restart or a forced cache invalidation.
 
   Also measures how cache lookup time degrades as the number of live
-  payloads grows (hash map overhead at scale).
+  payloads grows (hash map overhead at scale), and how aggregate hit
+  throughput scales with reader thread count:
+
+  spread:  each thread resolves its own slice of payloads, so readers land
+           on different shards (the common multi-tenant read pattern).
+  hot:     every thread resolves the same payload, so all readers share
+           one shard (worst case for any lock word on the hit path).
 */
 
+#include <atomic>
 #include <iostream>
+#include <thread>
 #include <vector>
 
 #include "common/bench_fixture.hpp"
@@ -68,6 +78,47 @@ static void BenchSnapshotCacheMiss(int n_payloads) {
             << std::setprecision(3) << result.per_op_us() << "\n";
 }
 
+// ---------------------------------------------------------------------------
+// Bench: ResolveSnapshot hit throughput vs reader thread count
+// ---------------------------------------------------------------------------
+static void BenchSnapshotCacheScaling(int n_threads, bool hot) {
+  constexpr int kPayloadsPerThread = 64;
+  constexpr int kResolvesPerThread = 200000;
+  BenchFixture  fix{};
+
+  std::vector<payload::manager::v1::PayloadID> ids;
+  ids.reserve(static_cast<size_t>(n_threads) * kPayloadsPerThread);
+  for (int i = 0; i < n_threads * kPayloadsPerThread; ++i) ids.push_back(fix.MakeRamPayload(4096).payload_id());
+
+  std::atomic<int>         ready{0};
+  std::atomic<bool>        go{false};
+  std::vector<std::thread> threads;
+  threads.reserve(n_threads);
+  for (int t = 0; t < n_threads; ++t) {
+    threads.emplace_back([&, t] {
+      const auto* slice = hot ? &ids.front() : &ids[static_cast<size_t>(t) * kPayloadsPerThread];
+      ready.fetch_add(1);
+      while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+      for (int i = 0; i < kResolvesPerThread; ++i) {
+        fix.manager->ResolveSnapshot(slice[hot ? 0 : i % kPayloadsPerThread]);
+      }
+    });
+  }
+  while (ready.load() < n_threads) std::this_thread::yield();
+
+  auto t0 = std::chrono::steady_clock::now();
+  go.store(true, std::memory_order_release);
+  for (auto& th : threads) th.join();
+  auto t1 = std::chrono::steady_clock::now();
+
+  const double total_ops = static_cast<double>(n_threads) * kResolvesPerThread;
+  const double total_s   = std::chrono::duration<double>(t1 - t0).count();
+  const auto   name      = std::string("ResolveSnapshot ") + (hot ? "hot" : "spread") + " threads=" + std::to_string(n_threads);
+  std::cout << std::left << std::setw(42) << name << std::setw(10) << "-" << std::setw(8) << static_cast<int>(total_ops) << std::setw(14)
+            << std::fixed << std::setprecision(3) << (total_s * 1e6 / total_ops * n_threads) << std::setw(12) << std::setprecision(2)
+            << (total_ops / total_s / 1e6) << "\n";
+}
+
 int main() {
   std::cout << std::left << std::setw(42) << "benchmark" << std::setw(10) << "size" << std::setw(8) << "iters" << std::setw(14) << "per-op (µs)"
             << "\n"
@@ -79,5 +130,11 @@ int main() {
   std::cout << "\n-- HydrateCaches (full rebuild from repository)\n";
   for (int n : {10, 100, 1000, 5000}) BenchSnapshotCacheMiss(n);
 
+  const int max_threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+  for (bool hot : {false, true}) {
+    std::cout << "\n-- Hit throughput vs threads (" << (hot ? "hot payload" : "spread payloads") << "; last column = Mops/s)\n";
+    for (int n = 1; n <= max_threads; n *= 2) BenchSnapshotCacheScaling(n, hot);
+  }
+
   return 0;
 }
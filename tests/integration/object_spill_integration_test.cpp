@@ -186,21 +186,24 @@ PayloadDescriptor AllocateAndFillAndCommit(PayloadCatalogService::Stub& catalog,
   ASSERT_EQ(length, size_bytes);
 
   // Open the shm segment the server created and write the fill pattern.
-  // The client always mmaps at offset 0 (block_index is an internal
-  // accounting field, not a byte offset into the shm file).
+  // Small payloads live in a shared slab arena at offset_bytes; the arena is
+  // already sized, so only a dedicated segment (slab_id 0) is truncated.
   int fd = shm_open(shm.c_str(), O_RDWR, S_IRUSR | S_IWUSR);
   ASSERT_TRUE(fd >= 0);
-  if (ftruncate(fd, static_cast<off_t>(length)) != 0) {
+  if (ram.slab_id() == 0 && ftruncate(fd, static_cast<off_t>(length)) != 0) {
     close(fd);
     std::cerr << "FAIL: ftruncate on shm " << shm << " failed: " << std::strerror(errno) << '\n';
     std::exit(1);
   }
 
-  void* base = mmap(nullptr, static_cast<size_t>(length), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  const uint64_t page       = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+  const uint64_t map_offset = ram.offset_bytes() / page * page;
+  const size_t   map_size   = static_cast<size_t>(ram.offset_bytes() - map_offset + length);
+  void*          base       = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, static_cast<off_t>(map_offset));
   ASSERT_TRUE(base != MAP_FAILED);
 
-  std::memset(base, fill, static_cast<size_t>(length));
-  munmap(base, static_cast<size_t>(length));
+  std::memset(static_cast<uint8_t*>(base) + (ram.offset_bytes() - map_offset), fill, static_cast<size_t>(length));
+  munmap(base, map_size);
   close(fd);
 
   // Commit makes the payload visible and immutable.
@@ -413,7 +413,9 @@ BackendFactory MakeSqliteFactory() {
         "CREATE TABLE IF NOT EXISTS payload (id TEXT PRIMARY KEY, tier INTEGER NOT NULL, state INTEGER NOT NULL, size_bytes INTEGER NOT NULL, "
         "version INTEGER NOT NULL, expires_at_ms INTEGER, no_evict INTEGER NOT NULL DEFAULT 0, eviction_priority INTEGER NOT NULL DEFAULT 0, "
         "spill_target INTEGER NOT NULL DEFAULT 0, created_at_ms INTEGER NOT NULL DEFAULT (unixepoch() * 1000), "
-        "min_residency_tier INTEGER NOT NULL DEFAULT 0, require_durable INTEGER NOT NULL DEFAULT 0);");
+        "min_residency_tier INTEGER NOT NULL DEFAULT 0, require_durable INTEGER NOT NULL DEFAULT 0, spill_codec INTEGER NOT NULL DEFAULT 0, "
+        "stored_codec INTEGER NOT NULL DEFAULT 0, stored_size_bytes INTEGER NOT NULL DEFAULT 0, checksum_crc32c INTEGER NOT NULL DEFAULT 0, "
+        "content_hash TEXT NOT NULL DEFAULT '', has_checksum INTEGER NOT NULL DEFAULT 0);");
     db->Exec(
         "CREATE TABLE IF NOT EXISTS payload_metadata (id TEXT PRIMARY KEY, json TEXT NOT NULL, schema TEXT, updated_at_ms INTEGER NOT NULL, FOREIGN "
         "KEY(id) REFERENCES payload(id) ON DELETE CASCADE);");
@@ -464,7 +466,10 @@ BackendFactory MakePostgresFactory() {
     tx.exec(
         "CREATE TABLE IF NOT EXISTS payload (id TEXT PRIMARY KEY, tier SMALLINT NOT NULL, state SMALLINT NOT NULL, size_bytes BIGINT NOT NULL, "
         "version BIGINT NOT NULL, expires_at_ms BIGINT, no_evict SMALLINT NOT NULL DEFAULT 0, eviction_priority SMALLINT NOT NULL DEFAULT 0, "
-        "spill_target SMALLINT NOT NULL DEFAULT 0, created_at_ms BIGINT NOT NULL DEFAULT 0);");
+        "spill_target SMALLINT NOT NULL DEFAULT 0, created_at_ms BIGINT NOT NULL DEFAULT 0, min_residency_tier SMALLINT NOT NULL DEFAULT 0, "
+        "require_durable SMALLINT NOT NULL DEFAULT 0, spill_codec SMALLINT NOT NULL DEFAULT 0, stored_codec SMALLINT NOT NULL DEFAULT 0, "
+        "stored_size_bytes BIGINT NOT NULL DEFAULT 0, checksum_crc32c BIGINT NOT NULL DEFAULT 0, "
+        "content_hash TEXT NOT NULL DEFAULT '', has_checksum SMALLINT NOT NULL DEFAULT 0);");
     tx.exec(
         "CREATE TABLE IF NOT EXISTS payload_metadata (id TEXT PRIMARY KEY REFERENCES payload(id) ON DELETE CASCADE, json JSONB NOT NULL, schema "
         "TEXT, updated_at_ms BIGINT NOT NULL);");
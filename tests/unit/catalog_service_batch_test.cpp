@@ -0,0 +1,384 @@
+/*
+  Tests for the batched AllocatePayloads / CommitPayloads paths.
+
+  Each batch runs in one repository transaction but items fail independently:
+  a bad item is reported in its own result slot and leaves the rest of the
+  batch (and tier accounting) untouched. That includes a failed repository
+  write on a backend that, like Postgres, aborts the whole transaction on a
+  failed statement until it is rolled back to a savepoint.
+*/
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "internal/core/payload_manager.hpp"
+#include "internal/db/memory/memory_repository.hpp"
+#include "internal/lease/lease_manager.hpp"
+#include "internal/service/catalog_service.hpp"
+#include "internal/service/service_context.hpp"
+#include "internal/storage/storage_backend.hpp"
+#include "internal/util/uuid.hpp"
+#include "payload/manager/v1.hpp"
+
+namespace {
+
+using payload::core::PayloadManager;
+using payload::lease::LeaseManager;
+using payload::manager::v1::AllocatePayloadsRequest;
+using payload::manager::v1::CommitPayloadsRequest;
+using payload::manager::v1::PAYLOAD_STATE_ACTIVE;
+using payload::manager::v1::TIER_RAM;
+using payload::manager::v1::TIER_UNSPECIFIED;
+
+class SimpleBackend final : public payload::storage::StorageBackend {
+ public:
+  std::shared_ptr<arrow::Buffer> Allocate(const payload::manager::v1::PayloadID& id, uint64_t size) override {
+    auto r = arrow::AllocateBuffer(size);
+    if (!r.ok()) throw std::runtime_error("alloc");
+    std::shared_ptr<arrow::Buffer> buf(std::move(*r));
+    if (size > 0) std::memset(buf->mutable_data(), 0, size);
+    bufs_[id.value()] = buf;
+    return buf;
+  }
+  std::shared_ptr<arrow::Buffer> Read(const payload::manager::v1::PayloadID& id) override {
+    return bufs_.at(id.value());
+  }
+  void Write(const payload::manager::v1::PayloadID& id, const std::shared_ptr<arrow::Buffer>& b, bool) override {
+    bufs_[id.value()] = b;
+  }
+  void Remove(const payload::manager::v1::PayloadID& id) override {
+    bufs_.erase(id.value());
+  }
+  std::size_t Count() const {
+    return bufs_.size();
+  }
+  payload::manager::v1::Tier TierType() const override {
+    return TIER_RAM;
+  }
+
+ private:
+  std::unordered_map<std::string, std::shared_ptr<arrow::Buffer>> bufs_;
+};
+
+struct Fixture {
+  std::shared_ptr<LeaseManager>                          lease_mgr = std::make_shared<LeaseManager>();
+  std::shared_ptr<payload::db::memory::MemoryRepository> repo      = std::make_shared<payload::db::memory::MemoryRepository>();
+  std::shared_ptr<SimpleBackend>                         ram       = std::make_shared<SimpleBackend>();
+  std::shared_ptr<PayloadManager>                        manager{[&] {
+    payload::storage::StorageFactory::TierMap s;
+    s[TIER_RAM] = ram;
+    return std::make_shared<PayloadManager>(s, lease_mgr, repo);
+  }()};
+  payload::service::ServiceContext                       ctx{[&] {
+    payload::service::ServiceContext c;
+    c.manager    = manager;
+    c.repository = repo;
+    c.lease_mgr  = lease_mgr;
+    return c;
+  }()};
+  payload::service::CatalogService                       catalog{ctx};
+};
+
+// Wraps MemoryRepository with Postgres failure semantics and a unique key on
+// size_bytes: a colliding insert fails, every later statement fails until the
+// transaction rolls back to a savepoint, and committing it discards its writes.
+class AbortingRepository final : public payload::db::Repository {
+ public:
+  std::unique_ptr<payload::db::Transaction> Begin() override {
+    return std::make_unique<AbortingTx>(inner_->Begin());
+  }
+
+  payload::db::Result InsertPayload(payload::db::Transaction& t, const payload::db::model::PayloadRecord& r) override {
+    auto& inner = Unwrap(t);
+    for (const auto& existing : inner_->ListPayloads(inner)) {
+      if (existing.size_bytes == r.size_bytes) {
+        static_cast<AbortingTx&>(t).aborted = true;
+        return payload::db::Result::Err(payload::db::ErrorCode::AlreadyExists, "duplicate key value violates unique constraint");
+      }
+    }
+    return inner_->InsertPayload(inner, r);
+  }
+  std::optional<payload::db::model::PayloadRecord> GetPayload(payload::db::Transaction& t, const payload::util::UUID& id) override {
+    return inner_->GetPayload(Unwrap(t), id);
+  }
+  std::vector<payload::db::model::PayloadRecord> ListPayloads(payload::db::Transaction&  t,
+                                                              payload::manager::v1::Tier tier_filter = payload::manager::v1::TIER_UNSPECIFIED,
+                                                              int32_t limit = 0, int32_t offset = 0) override {
+    return inner_->ListPayloads(Unwrap(t), tier_filter, limit, offset);
+  }
+  int32_t CountPayloads(payload::db::Transaction& t, payload::manager::v1::Tier tier_filter = payload::manager::v1::TIER_UNSPECIFIED) override {
+    return inner_->CountPayloads(Unwrap(t), tier_filter);
+  }
+  payload::db::Result UpdatePayload(payload::db::Transaction& t, const payload::db::model::PayloadRecord& r) override {
+    return inner_->UpdatePayload(Unwrap(t), r);
+  }
+  payload::db::Result DeletePayload(payload::db::Transaction& t, const payload::util::UUID& id) override {
+    return inner_->DeletePayload(Unwrap(t), id);
+  }
+  std::vector<payload::db::model::PayloadRecord> ListExpiredPayloads(payload::db::Transaction& t, uint64_t now_ms) override {
+    return inner_->ListExpiredPayloads(Unwrap(t), now_ms);
+  }
+  std::optional<payload::db::model::PayloadRecord> FindContentReference(payload::db::Transaction& t, const std::string& content_hash,
+                                                                         payload::manager::v1::Tier tier) override {
+    return inner_->FindContentReference(Unwrap(t), content_hash, tier);
+  }
+  payload::db::Result UpsertMetadata(payload::db::Transaction& t, const payload::db::model::MetadataRecord& r) override {
+    return inner_->UpsertMetadata(Unwrap(t), r);
+  }
+  std::optional<payload::db::model::MetadataRecord> GetMetadata(payload::db::Transaction& t, const std::string& id) override {
+    return inner_->GetMetadata(Unwrap(t), id);
+  }
+  payload::db::Result InsertMetadataEvent(payload::db::Transaction& t, const payload::db::model::MetadataEventRecord& r) override {
+    return inner_->InsertMetadataEvent(Unwrap(t), r);
+  }
+  payload::db::Result InsertLineage(payload::db::Transaction& t, const payload::db::model::LineageRecord& r) override {
+    return inner_->InsertLineage(Unwrap(t), r);
+  }
+  std::vector<payload::db::model::LineageRecord> GetParents(payload::db::Transaction& t, const std::string& id) override {
+    return inner_->GetParents(Unwrap(t), id);
+  }
+  std::vector<payload::db::model::LineageRecord> GetChildren(payload::db::Transaction& t, const std::string& id) override {
+    return inner_->GetChildren(Unwrap(t), id);
+  }
+  payload::db::Result CreateStream(payload::db::Transaction& t, payload::db::model::StreamRecord& r) override {
+    return inner_->CreateStream(Unwrap(t), r);
+  }
+  std::optional<payload::db::model::StreamRecord> GetStreamByName(payload::db::Transaction& t, const std::string& ns, const std::string& n) override {
+    return inner_->GetStreamByName(Unwrap(t), ns, n);
+  }
+  std::optional<payload::db::model::StreamRecord> GetStreamById(payload::db::Transaction& t, uint64_t id) override {
+    return inner_->GetStreamById(Unwrap(t), id);
+  }
+  payload::db::Result DeleteStreamByName(payload::db::Transaction& t, const std::string& ns, const std::string& n) override {
+    return inner_->DeleteStreamByName(Unwrap(t), ns, n);
+  }
+  payload::db::Result DeleteStreamById(payload::db::Transaction& t, uint64_t id) override {
+    return inner_->DeleteStreamById(Unwrap(t), id);
+  }
+  payload::db::Result AppendStreamEntries(payload::db::Transaction& t, uint64_t sid, std::vector<payload::db::model::StreamEntryRecord>& e) override {
+    return inner_->AppendStreamEntries(Unwrap(t), sid, e);
+  }
+  std::vector<payload::db::model::StreamEntryRecord> ReadStreamEntries(payload::db::Transaction& t, uint64_t sid, uint64_t so,
+                                                                       std::optional<uint64_t> me, std::optional<uint64_t> mt) override {
+    return inner_->ReadStreamEntries(Unwrap(t), sid, so, me, mt);
+  }
+  std::optional<uint64_t> GetMaxStreamOffset(payload::db::Transaction& t, uint64_t sid) override {
+    return inner_->GetMaxStreamOffset(Unwrap(t), sid);
+  }
+  std::vector<payload::db::model::StreamEntryRecord> ReadStreamEntriesRange(payload::db::Transaction& t, uint64_t sid, uint64_t so,
+                                                                            uint64_t eo) override {
+    return inner_->ReadStreamEntriesRange(Unwrap(t), sid, so, eo);
+  }
+  payload::db::Result TrimStreamEntriesToMaxCount(payload::db::Transaction& t, uint64_t sid, uint64_t me) override {
+    return inner_->TrimStreamEntriesToMaxCount(Unwrap(t), sid, me);
+  }
+  payload::db::Result DeleteStreamEntriesOlderThan(payload::db::Transaction& t, uint64_t sid, uint64_t mt) override {
+    return inner_->DeleteStreamEntriesOlderThan(Unwrap(t), sid, mt);
+  }
+  payload::db::Result CommitConsumerOffset(payload::db::Transaction& t, const payload::db::model::StreamConsumerOffsetRecord& r) override {
+    return inner_->CommitConsumerOffset(Unwrap(t), r);
+  }
+  std::optional<payload::db::model::StreamConsumerOffsetRecord> GetConsumerOffset(payload::db::Transaction& t, uint64_t sid,
+                                                                                  const std::string& cg) override {
+    return inner_->GetConsumerOffset(Unwrap(t), sid, cg);
+  }
+
+ private:
+  struct AbortingTx final : public payload::db::Transaction {
+    explicit AbortingTx(std::unique_ptr<payload::db::Transaction> tx) : inner(std::move(tx)) {
+    }
+
+    // Like COMMIT on an aborted Postgres transaction: a silent rollback.
+    void Commit() override {
+      if (aborted) {
+        inner->Rollback();
+      } else {
+        inner->Commit();
+      }
+    }
+    void Rollback() override {
+      inner->Rollback();
+    }
+    bool IsCommitted() const override {
+      return inner->IsCommitted();
+    }
+    void Savepoint() override {
+      Check();
+      inner->Savepoint();
+    }
+    void RollbackToSavepoint() override {
+      inner->RollbackToSavepoint();
+      aborted = false;
+    }
+    void ReleaseSavepoint() override {
+      Check();
+      inner->ReleaseSavepoint();
+    }
+    void Check() const {
+      if (aborted) throw std::runtime_error("current transaction is aborted, commands ignored until end of transaction block");
+    }
+
+    std::unique_ptr<payload::db::Transaction> inner;
+    bool                                      aborted = false;
+  };
+
+  static payload::db::Transaction& Unwrap(payload::db::Transaction& t) {
+    auto& tx = static_cast<AbortingTx&>(t);
+    tx.Check();
+    return *tx.inner;
+  }
+
+  std::shared_ptr<payload::db::memory::MemoryRepository> inner_ = std::make_shared<payload::db::memory::MemoryRepository>();
+};
+
+void AddItem(AllocatePayloadsRequest* req, uint64_t size_bytes, payload::manager::v1::Tier tier = TIER_RAM) {
+  auto* item = req->add_items();
+  item->set_size_bytes(size_bytes);
+  item->set_preferred_tier(tier);
+}
+
+} // namespace
+
+TEST(CatalogServiceBatch, AllocateReportsFailuresPerItem) {
+  Fixture f;
+
+  AllocatePayloadsRequest req;
+  AddItem(&req, 64);
+  AddItem(&req, 0);                    // rejected by PayloadManager
+  AddItem(&req, 32, TIER_UNSPECIFIED); // rejected by CatalogService
+  AddItem(&req, 128);
+
+  const auto resp = f.catalog.AllocateBatch(req);
+  ASSERT_EQ(resp.results_size(), 4);
+  EXPECT_TRUE(resp.results(0).ok());
+  EXPECT_FALSE(resp.results(1).ok());
+  EXPECT_FALSE(resp.results(1).error_message().empty());
+  EXPECT_FALSE(resp.results(2).ok());
+  EXPECT_FALSE(resp.results(2).error_message().empty());
+  EXPECT_TRUE(resp.results(3).ok());
+
+  EXPECT_EQ(resp.results(0).payload_descriptor().ram().length_bytes(), 64u);
+  EXPECT_EQ(resp.results(3).payload_descriptor().ram().length_bytes(), 128u);
+  EXPECT_FALSE(resp.results(1).has_payload_descriptor());
+
+  EXPECT_EQ(f.ram->Count(), 2u);
+  EXPECT_EQ(f.manager->GetTierBytes(TIER_RAM), 192u);
+}
+
+TEST(CatalogServiceBatch, CommitReportsFailuresPerItem) {
+  Fixture f;
+
+  AllocatePayloadsRequest alloc;
+  AddItem(&alloc, 64);
+  AddItem(&alloc, 64);
+  const auto allocated = f.catalog.AllocateBatch(alloc);
+  ASSERT_TRUE(allocated.results(0).ok());
+  ASSERT_TRUE(allocated.results(1).ok());
+  const auto first  = allocated.results(0).payload_descriptor().payload_id();
+  const auto second = allocated.results(1).payload_descriptor().payload_id();
+
+  CommitPayloadsRequest req;
+  *req.add_ids() = first;
+  *req.add_ids() = payload::util::ToProto(payload::util::GenerateUUID()); // unknown
+  *req.add_ids() = first;                                                 // duplicate in batch
+  *req.add_ids() = second;
+
+  const auto resp = f.catalog.CommitBatch(req);
+  ASSERT_EQ(resp.results_size(), 4);
+  EXPECT_TRUE(resp.results(0).ok());
+  EXPECT_FALSE(resp.results(1).ok());
+  EXPECT_FALSE(resp.results(2).ok());
+  EXPECT_TRUE(resp.results(3).ok());
+  EXPECT_EQ(resp.results(3).id().value(), second.value());
+
+  EXPECT_EQ(f.manager->ResolveSnapshot(first).state(), PAYLOAD_STATE_ACTIVE);
+  EXPECT_EQ(f.manager->ResolveSnapshot(second).state(), PAYLOAD_STATE_ACTIVE);
+
+  // Committing again fails per item: both payloads have left ALLOCATED.
+  CommitPayloadsRequest again;
+  *again.add_ids() = first;
+  *again.add_ids() = second;
+  const auto retry = f.catalog.CommitBatch(again);
+  ASSERT_EQ(retry.results_size(), 2);
+  EXPECT_FALSE(retry.results(0).ok());
+  EXPECT_FALSE(retry.results(1).ok());
+}
+
+TEST(CatalogServiceBatch, ManagerBatchMatchesSingleItemCalls) {
+  Fixture f;
+
+  std::vector<PayloadManager::AllocateSpec> specs(8);
+  for (auto& spec : specs) {
+    spec.size_bytes = 256;
+  }
+  const auto allocated = f.manager->AllocateBatch(specs);
+  ASSERT_EQ(allocated.size(), specs.size());
+
+  std::vector<payload::manager::v1::PayloadID> ids;
+  for (const auto& result : allocated) {
+    ASSERT_TRUE(result.ok());
+    ids.push_back(result.descriptor.payload_id());
+  }
+
+  const auto committed = f.manager->CommitBatch(ids);
+  ASSERT_EQ(committed.size(), ids.size());
+  for (std::size_t i = 0; i < committed.size(); ++i) {
+    ASSERT_TRUE(committed[i].ok());
+    EXPECT_EQ(committed[i].descriptor.state(), PAYLOAD_STATE_ACTIVE);
+    EXPECT_EQ(committed[i].descriptor.version(), 2u);
+    EXPECT_EQ(f.manager->ResolveSnapshot(ids[i]).version(), 2u);
+  }
+  EXPECT_EQ(f.manager->GetTierBytes(TIER_RAM), 8u * 256u);
+}
+
+TEST(CatalogServiceBatch, FailedWriteDoesNotAbortTheBatch) {
+  auto lease_mgr = std::make_shared<LeaseManager>();
+  auto repo      = std::make_shared<AbortingRepository>();
+  auto ram       = std::make_shared<SimpleBackend>();
+
+  payload::storage::StorageFactory::TierMap tiers;
+  tiers[TIER_RAM] = ram;
+  PayloadManager manager(tiers, lease_mgr, repo);
+
+  // The third item collides with the first on the unique key.
+  std::vector<PayloadManager::AllocateSpec> specs(4);
+  specs[0].size_bytes = 64;
+  specs[1].size_bytes = 128;
+  specs[2].size_bytes = 64;
+  specs[3].size_bytes = 256;
+  const auto allocated = manager.AllocateBatch(specs);
+  ASSERT_EQ(allocated.size(), specs.size());
+  EXPECT_TRUE(allocated[0].ok());
+  EXPECT_TRUE(allocated[1].ok());
+  EXPECT_FALSE(allocated[2].ok());
+  EXPECT_TRUE(allocated[3].ok());
+  EXPECT_EQ(ram->Count(), 3u);
+  EXPECT_EQ(manager.GetTierBytes(TIER_RAM), 448u);
+
+  // Every item reported ok was persisted, before and after the collision.
+  std::vector<payload::manager::v1::PayloadID> ids;
+  {
+    auto tx = repo->Begin();
+    for (const std::size_t i : {0u, 1u, 3u}) {
+      ids.push_back(allocated[i].descriptor.payload_id());
+      EXPECT_TRUE(repo->GetPayload(*tx, payload::util::FromProto(ids.back())).has_value()) << "item " << i;
+    }
+    tx->Commit();
+  }
+
+  const auto committed = manager.CommitBatch(ids);
+  ASSERT_EQ(committed.size(), ids.size());
+  auto tx = repo->Begin();
+  for (std::size_t i = 0; i < ids.size(); ++i) {
+    EXPECT_TRUE(committed[i].ok());
+    const auto record = repo->GetPayload(*tx, payload::util::FromProto(ids[i]));
+    ASSERT_TRUE(record.has_value());
+    EXPECT_EQ(record->state, PAYLOAD_STATE_ACTIVE);
+  }
+}
@@ -0,0 +1,291 @@
+/*
+  Payload checksum tests.
+
+  Covers CRC32C against published vectors, the fused copy and piecewise
+  updates agreeing with one pass over the bytes (hardware and portable
+  paths, misaligned and odd sizes), CopyPayload hashing on each of its
+  paths, and PayloadManager recording the checksum on spill (repository,
+  sidecar, ResolveSnapshot with include_checksum), verifying it on
+  promotion and refusing a corrupted disk copy with DataLoss, also when
+  the payload's CRC is 0.
+*/
+
+#include <google/protobuf/util/json_util.h>
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "internal/core/payload_manager.hpp"
+#include "internal/db/memory/memory_repository.hpp"
+#include "internal/lease/lease_manager.hpp"
+#include "internal/lineage/lineage_graph.hpp"
+#include "internal/metadata/metadata_cache.hpp"
+#include "internal/service/data_service.hpp"
+#include "internal/service/service_context.hpp"
+#include "internal/storage/checksum.hpp"
+#include "internal/storage/common/path_utils.hpp"
+#include "internal/storage/disk/disk_arrow_store.hpp"
+#include "internal/storage/payload_transfer.hpp"
+#include "internal/storage/ram/ram_arrow_store.hpp"
+#include "internal/util/errors.hpp"
+#include "internal/util/uuid.hpp"
+#include "payload/manager/v1.hpp"
+
+namespace {
+
+using payload::core::PayloadManager;
+using payload::manager::v1::PayloadID;
+using payload::manager::v1::TIER_DISK;
+using payload::manager::v1::TIER_RAM;
+using payload::storage::Crc32c;
+using payload::storage::Crc32cOf;
+using payload::storage::Crc32cPortable;
+using payload::storage::DiskArrowStore;
+using payload::storage::RamArrowStore;
+
+struct Scratch {
+  std::string           prefix;
+  std::filesystem::path disk_root;
+
+  Scratch() {
+    static std::atomic<int> next{0};
+    prefix    = "pm-checksum-test-" + std::to_string(getpid()) + "-" + std::to_string(next.fetch_add(1));
+    disk_root = std::filesystem::temp_directory_path() / prefix;
+  }
+
+  ~Scratch() {
+    std::error_code ec;
+    std::filesystem::remove_all(disk_root, ec);
+    for (std::filesystem::directory_iterator it("/dev/shm", ec); !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+      const auto file = it->path().filename().string();
+      if (file.rfind(prefix + "-", 0) == 0) {
+        shm_unlink(("/" + file).c_str());
+      }
+    }
+  }
+};
+
+std::vector<uint8_t> Pattern(uint64_t size) {
+  std::vector<uint8_t> bytes(size);
+  for (uint64_t i = 0; i < size; ++i) {
+    bytes[i] = static_cast<uint8_t>(i * 131 + 7);
+  }
+  return bytes;
+}
+
+std::shared_ptr<arrow::Buffer> PatternBuffer(uint64_t size) {
+  const auto bytes = Pattern(size);
+  return arrow::Buffer::FromString(std::string(bytes.begin(), bytes.end()));
+}
+
+uint32_t Crc(const std::vector<uint8_t>& bytes) {
+  return Crc32cOf(bytes.data(), bytes.size());
+}
+
+// RAM + DISK manager over a repository the test can inspect.
+struct Manager {
+  std::shared_ptr<RamArrowStore>                         ram;
+  std::shared_ptr<payload::db::memory::MemoryRepository> repository = std::make_shared<payload::db::memory::MemoryRepository>();
+  std::shared_ptr<PayloadManager>                        manager;
+
+  explicit Manager(const Scratch& scratch) : ram(std::make_shared<RamArrowStore>(scratch.prefix)) {
+    payload::storage::StorageFactory::TierMap storage;
+    storage[TIER_RAM]  = ram;
+    storage[TIER_DISK] = std::make_shared<DiskArrowStore>(scratch.disk_root);
+    manager            = std::make_shared<PayloadManager>(storage, std::make_shared<payload::lease::LeaseManager>(), repository);
+  }
+
+  PayloadID Put(const std::vector<uint8_t>& bytes) {
+    const auto allocated = manager->Allocate(bytes.size(), TIER_RAM);
+    std::memcpy(ram->Read(allocated.payload_id())->mutable_data(), bytes.data(), bytes.size());
+    return manager->Commit(allocated.payload_id()).payload_id();
+  }
+
+  payload::db::model::PayloadRecord Record(const PayloadID& id) {
+    auto tx     = repository->Begin();
+    auto record = repository->GetPayload(*tx, payload::util::FromProto(id));
+    tx->Commit();
+    return *record;
+  }
+};
+
+} // namespace
+
+TEST(Checksum, MatchesPublishedVectors) {
+  const std::string check = "123456789";
+  EXPECT_EQ(Crc32cOf(reinterpret_cast<const uint8_t*>(check.data()), check.size()), 0xE3069283u);
+  EXPECT_EQ(Crc32cPortable(0, reinterpret_cast<const uint8_t*>(check.data()), check.size()), 0xE3069283u);
+  EXPECT_EQ(Crc32cOf(nullptr, 0), 0u);
+
+  // RFC 3720 (iSCSI) B.4.
+  const std::vector<uint8_t> zeros(32, 0x00);
+  const std::vector<uint8_t> ones(32, 0xFF);
+  EXPECT_EQ(Crc(zeros), 0x8A9136AAu);
+  EXPECT_EQ(Crc(ones), 0x62A8AB43u);
+}
+
+TEST(Checksum, FusedCopyAndPiecesMatchOnePass) {
+  // Sizes straddle the three-stream block (24 KiB) and the streaming-store threshold (1 MiB).
+  for (const uint64_t size : {uint64_t{1}, uint64_t{63}, uint64_t{24575}, uint64_t{24576}, uint64_t{100003}, uint64_t{(1 << 20) + 13},
+                              uint64_t{5} << 20}) {
+    const auto source   = Pattern(size + 1);
+    const auto expected = Crc32cPortable(0, source.data() + 1, size);
+    EXPECT_EQ(Crc32cOf(source.data() + 1, size), expected) << size;
+
+    std::vector<uint8_t> copy(size + 3);
+    Crc32c               fused;
+    fused.CopyAndUpdate(copy.data() + 3, source.data() + 1, size);
+    EXPECT_EQ(fused.Value(), expected) << size;
+    EXPECT_EQ(std::memcmp(copy.data() + 3, source.data() + 1, size), 0) << size;
+
+    Crc32c pieces;
+    pieces.Update(source.data() + 1, size / 3);
+    pieces.CopyAndUpdate(copy.data(), source.data() + 1 + size / 3, size - size / 3);
+    EXPECT_EQ(pieces.Value(), expected) << size;
+    EXPECT_EQ(Crc32cPortable(Crc32cPortable(0, source.data() + 1, size / 3), source.data() + 1 + size / 3, size - size / 3), expected);
+  }
+}
+
+TEST(Checksum, CopyPayloadHashesEveryPath) {
+  Scratch        scratch;
+  RamArrowStore  ram(scratch.prefix);
+  DiskArrowStore disk(scratch.disk_root);
+  DiskArrowStore other(scratch.disk_root / "other");
+
+  const uint64_t size     = (uint64_t{3} << 20) + 5;
+  const auto     payload  = PatternBuffer(size);
+  const auto     expected = Crc32cOf(payload->data(), size);
+  const auto     id       = payload::util::ToProto(payload::util::GenerateUUID());
+  auto           segment  = ram.Allocate(id, size);
+  std::memcpy(segment->mutable_data(), payload->data(), size);
+
+  payload::storage::TransferOptions small_chunks;
+  small_chunks.chunk_bytes = 1 << 20;
+
+  // RAM → DISK: whole buffer hashed slice by slice into the disk writer.
+  Crc32c to_disk;
+  payload::storage::CopyPayload(ram, disk, id, /*fsync=*/false, small_chunks, &to_disk);
+  EXPECT_EQ(to_disk.Value(), expected);
+  ram.Remove(id);
+
+  // DISK → DISK: pipelined chunks hashed before they are appended.
+  Crc32c between_disks;
+  payload::storage::CopyPayload(disk, other, id, /*fsync=*/false, small_chunks, &between_disks);
+  EXPECT_EQ(between_disks.Value(), expected);
+  EXPECT_TRUE(other.Read(id)->Equals(*payload));
+
+  // DISK → RAM: staged slices copied into the segment with the fused kernel.
+  Crc32c to_ram;
+  payload::storage::CopyPayload(disk, ram, id, /*fsync=*/false, payload::storage::TransferOptions{}, &to_ram);
+  EXPECT_EQ(to_ram.Value(), expected);
+  EXPECT_TRUE(ram.Read(id)->Equals(*payload));
+  ram.Remove(id);
+}
+
+TEST(Checksum, SpillRecordsAndPromotionVerifies) {
+  Scratch    scratch;
+  Manager    m(scratch);
+  const auto pattern = Pattern((uint64_t{2} << 20) + 77);
+  const auto id      = m.Put(pattern);
+  EXPECT_FALSE(m.Record(id).has_checksum);
+  EXPECT_FALSE(m.manager->GetChecksum(id).has_value());
+
+  m.manager->ExecuteSpill(id, TIER_DISK, /*fsync=*/false);
+  EXPECT_TRUE(m.Record(id).has_checksum);
+  EXPECT_EQ(m.Record(id).checksum_crc32c, Crc(pattern));
+  EXPECT_EQ(m.manager->GetChecksum(id), Crc(pattern));
+
+  const auto uuid = payload::util::ToString(payload::util::FromProto(id));
+  std::ifstream                                         sidecar_in(payload::storage::common::SidecarPath(scratch.disk_root, uuid));
+  const std::string                                     json((std::istreambuf_iterator<char>(sidecar_in)), std::istreambuf_iterator<char>());
+  payload::manager::catalog::v1::PayloadArchiveMetadata sidecar;
+  ASSERT_TRUE(google::protobuf::util::JsonStringToMessage(json, &sidecar).ok());
+  EXPECT_EQ(sidecar.integrity().algorithm(), payload::manager::catalog::v1::HASH_CRC32C);
+  const uint32_t crc = Crc(pattern);
+  EXPECT_EQ(sidecar.integrity().checksum(), std::string({static_cast<char>(crc >> 24), static_cast<char>(crc >> 16), static_cast<char>(crc >> 8),
+                                                         static_cast<char>(crc)}));
+
+  // The checksum survives the round trip and is checked again on the next spill.
+  m.manager->Promote(id, TIER_RAM);
+  EXPECT_EQ(m.Record(id).checksum_crc32c, Crc(pattern));
+  m.manager->ExecuteSpill(id, TIER_DISK, /*fsync=*/false);
+  EXPECT_EQ(m.Record(id).checksum_crc32c, Crc(pattern));
+}
+
+TEST(Checksum, CorruptDiskCopyFailsPromotion) {
+  Scratch    scratch;
+  Manager    m(scratch);
+  const auto pattern = Pattern(uint64_t{1} << 20);
+  const auto id      = m.Put(pattern);
+  m.manager->ExecuteSpill(id, TIER_DISK, /*fsync=*/false);
+
+  const auto path = payload::storage::common::PayloadPath(scratch.disk_root, payload::util::ToString(payload::util::FromProto(id)));
+  {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(12345);
+    file.put(static_cast<char>(pattern[12345] ^ 0x01));
+  }
+
+  EXPECT_THROW(m.manager->Promote(id, TIER_RAM), payload::util::DataLoss);
+  const auto record = m.Record(id);
+  EXPECT_EQ(record.tier, TIER_DISK);
+  EXPECT_EQ(record.checksum_crc32c, Crc(pattern));
+  EXPECT_TRUE(std::filesystem::exists(path));
+  EXPECT_THROW(m.ram->Read(id), std::exception);
+}
+
+TEST(Checksum, ZeroChecksumIsStillVerified) {
+  Scratch scratch;
+  Manager m(scratch);
+  // The last four bytes force the CRC32C of the whole payload to 0.
+  const std::string          text = "crc32c zero \x86\x4c\x06\x05";
+  const std::vector<uint8_t> pattern(text.begin(), text.end());
+  ASSERT_EQ(Crc(pattern), 0u);
+  const auto id = m.Put(pattern);
+  m.manager->ExecuteSpill(id, TIER_DISK, /*fsync=*/false);
+  EXPECT_TRUE(m.Record(id).has_checksum);
+  EXPECT_EQ(m.manager->GetChecksum(id), 0u);
+
+  const auto path = payload::storage::common::PayloadPath(scratch.disk_root, payload::util::ToString(payload::util::FromProto(id)));
+  {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(3);
+    file.put(static_cast<char>(pattern[3] ^ 0x01));
+  }
+  EXPECT_THROW(m.manager->Promote(id, TIER_RAM), payload::util::DataLoss);
+  EXPECT_EQ(m.Record(id).tier, TIER_DISK);
+}
+
+TEST(Checksum, ResolveSnapshotReturnsChecksumOnRequest) {
+  Scratch    scratch;
+  Manager    m(scratch);
+  const auto pattern = Pattern(4096);
+  const auto id      = m.Put(pattern);
+  m.manager->ExecuteSpill(id, TIER_DISK, /*fsync=*/false);
+
+  payload::service::ServiceContext ctx;
+  ctx.manager    = m.manager;
+  ctx.repository = m.repository;
+  ctx.metadata   = std::make_shared<payload::metadata::MetadataCache>();
+  ctx.lineage    = std::make_shared<payload::lineage::LineageGraph>();
+  payload::service::DataService data(ctx);
+
+  payload::manager::v1::ResolveSnapshotRequest request;
+  *request.mutable_id() = id;
+  EXPECT_FALSE(data.ResolveSnapshot(request).payload_descriptor().has_checksum_crc32c());
+
+  request.set_include_checksum(true);
+  const auto descriptor = data.ResolveSnapshot(request).payload_descriptor();
+  ASSERT_TRUE(descriptor.has_checksum_crc32c());
+  EXPECT_EQ(descriptor.checksum_crc32c(), Crc(pattern));
+}
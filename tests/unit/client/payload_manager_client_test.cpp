@@ -117,6 +117,26 @@ TEST(PayloadClient, ValidatePayloadIdDoesNotInspectContent) {
   EXPECT_TRUE(PayloadClient::ValidatePayloadId(id).ok());
 }
 
+TEST(PayloadClient, ValidateUncompressedRejectsCompressedCopies) {
+  payload::manager::v1::PayloadDescriptor descriptor;
+  descriptor.set_tier(payload::manager::v1::TIER_DISK);
+  descriptor.mutable_disk()->set_path("/nonexistent/payload.bin");
+  descriptor.mutable_disk()->set_length_bytes(64);
+  EXPECT_TRUE(PayloadClient::ValidateUncompressed(descriptor).ok());
+
+  descriptor.mutable_disk()->set_codec(payload::manager::v1::PAYLOAD_CODEC_NONE);
+  EXPECT_TRUE(PayloadClient::ValidateUncompressed(descriptor).ok());
+
+  descriptor.mutable_disk()->set_codec(payload::manager::v1::PAYLOAD_CODEC_ZSTD);
+  const auto compressed = PayloadClient::ValidateUncompressed(descriptor);
+  EXPECT_TRUE(compressed.IsNotImplemented());
+  EXPECT_NE(compressed.message().find("promote to RAM"), std::string::npos);
+
+  descriptor.set_tier(payload::manager::v1::TIER_OBJECT);
+  descriptor.mutable_disk()->set_codec(payload::manager::v1::PAYLOAD_CODEC_LZ4);
+  EXPECT_TRUE(PayloadClient::ValidateUncompressed(descriptor).IsNotImplemented());
+}
+
 TEST(PayloadClient, RpcHelpersRejectInvalidPayloadIdBeforeGrpcCall) {
   auto          channel = grpc::CreateChannel("dns:///127.0.0.1:1", grpc::InsecureChannelCredentials());
   PayloadClient client(channel);
@@ -146,3 +166,14 @@ TEST(PayloadClient, RpcHelpersRejectEmptyPayloadIdBeforeGrpcCall) {
   EXPECT_TRUE(client.Resolve(empty_id).status().IsInvalid());
   EXPECT_TRUE(client.AcquireReadableBuffer(empty_id).status().IsInvalid());
 }
+
+TEST(PayloadClient, CommitPayloadsReportsInvalidIdsPerItemWithoutGrpcCall) {
+  auto          channel = grpc::CreateChannel("dns:///127.0.0.1:1", grpc::InsecureChannelCredentials());
+  PayloadClient client(channel);
+
+  const auto statuses = client.CommitPayloads({MakePayloadIdOfSize(8), MakePayloadIdOfSize(0)});
+  ASSERT_TRUE(statuses.ok());
+  ASSERT_EQ(statuses->size(), 2u);
+  EXPECT_TRUE((*statuses)[0].IsInvalid());
+  EXPECT_TRUE((*statuses)[1].IsInvalid());
+}
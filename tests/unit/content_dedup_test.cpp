@@ -0,0 +1,239 @@
+/*
+  Content dedup tests.
+
+  Covers the content key (equal bytes, equal key; a version-8 UUID), and
+  PayloadManager with dedup enabled: identical payloads spilled RAM → DISK
+  sharing one blob that descriptors point at, the blob outliving all but
+  the last delete or promotion, payloads below min_bytes keeping their own
+  copy, and AdminService::Stats reporting hits and bytes saved.
+*/
+
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "internal/core/payload_manager.hpp"
+#include "internal/db/memory/memory_repository.hpp"
+#include "internal/lease/lease_manager.hpp"
+#include "internal/lineage/lineage_graph.hpp"
+#include "internal/metadata/metadata_cache.hpp"
+#include "internal/service/admin_service.hpp"
+#include "internal/service/service_context.hpp"
+#include "internal/storage/common/path_utils.hpp"
+#include "internal/storage/content_hash.hpp"
+#include "internal/storage/disk/disk_arrow_store.hpp"
+#include "internal/storage/ram/ram_arrow_store.hpp"
+#include "internal/util/uuid.hpp"
+#include "payload/manager/v1.hpp"
+
+namespace {
+
+using payload::core::PayloadManager;
+using payload::manager::v1::PayloadID;
+using payload::manager::v1::TIER_DISK;
+using payload::manager::v1::TIER_RAM;
+using payload::storage::DiskArrowStore;
+using payload::storage::RamArrowStore;
+
+struct Scratch {
+  std::string           prefix;
+  std::filesystem::path disk_root;
+
+  Scratch() {
+    static std::atomic<int> next{0};
+    prefix    = "pm-dedup-test-" + std::to_string(getpid()) + "-" + std::to_string(next.fetch_add(1));
+    disk_root = std::filesystem::temp_directory_path() / prefix;
+  }
+
+  ~Scratch() {
+    std::error_code ec;
+    std::filesystem::remove_all(disk_root, ec);
+    for (std::filesystem::directory_iterator it("/dev/shm", ec); !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+      const auto file = it->path().filename().string();
+      if (file.rfind(prefix + "-", 0) == 0) {
+        shm_unlink(("/" + file).c_str());
+      }
+    }
+  }
+
+  // Payload data files (<uuid>.bin) under the disk root.
+  int BinFiles() const {
+    int             count = 0;
+    std::error_code ec;
+    for (std::filesystem::directory_iterator it(disk_root, ec); !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+      if (it->path().extension() == ".bin") ++count;
+    }
+    return count;
+  }
+};
+
+std::vector<uint8_t> Pattern(uint64_t size, uint8_t seed) {
+  std::vector<uint8_t> bytes(size);
+  for (uint64_t i = 0; i < size; ++i) {
+    bytes[i] = static_cast<uint8_t>(i * 131 + seed);
+  }
+  return bytes;
+}
+
+// RAM + DISK manager with dedup enabled, over a repository the test can inspect.
+struct Manager {
+  std::shared_ptr<RamArrowStore>                         ram;
+  std::shared_ptr<payload::db::memory::MemoryRepository> repository = std::make_shared<payload::db::memory::MemoryRepository>();
+  std::shared_ptr<PayloadManager>                        manager;
+
+  explicit Manager(const Scratch& scratch, uint64_t min_bytes = 0) : ram(std::make_shared<RamArrowStore>(scratch.prefix)) {
+    payload::storage::StorageFactory::TierMap storage;
+    storage[TIER_RAM]  = ram;
+    storage[TIER_DISK] = std::make_shared<DiskArrowStore>(scratch.disk_root);
+    manager            = std::make_shared<PayloadManager>(storage, std::make_shared<payload::lease::LeaseManager>(), repository);
+    manager->SetDedupOptions({/*enabled=*/true, min_bytes});
+  }
+
+  PayloadID Put(const std::vector<uint8_t>& bytes) {
+    const auto allocated = manager->Allocate(bytes.size(), TIER_RAM);
+    std::memcpy(ram->Read(allocated.payload_id())->mutable_data(), bytes.data(), bytes.size());
+    return manager->Commit(allocated.payload_id()).payload_id();
+  }
+
+  payload::db::model::PayloadRecord Record(const PayloadID& id) {
+    auto tx     = repository->Begin();
+    auto record = repository->GetPayload(*tx, payload::util::FromProto(id));
+    tx->Commit();
+    return *record;
+  }
+};
+
+std::string BlobKey(const std::vector<uint8_t>& bytes) {
+  return payload::util::ToString(payload::storage::ContentKey(bytes.data(), bytes.size()));
+}
+
+} // namespace
+
+TEST(ContentDedup, ContentKeyDependsOnlyOnBytes) {
+  auto       bytes = Pattern(1 << 16, 7);
+  const auto key   = payload::storage::ContentKey(bytes.data(), bytes.size());
+  EXPECT_EQ(payload::storage::ContentKey(bytes.data(), bytes.size()), key);
+  EXPECT_EQ(key[6] >> 4, 0x8); // version 8
+  EXPECT_EQ(key[8] >> 6, 0x2); // RFC 4122 variant
+
+  bytes[bytes.size() / 2] ^= 1;
+  EXPECT_NE(payload::storage::ContentKey(bytes.data(), bytes.size()), key);
+}
+
+TEST(ContentDedup, IdenticalPayloadsShareOneBlob) {
+  Scratch    scratch;
+  Manager    m(scratch);
+  const auto bytes = Pattern(uint64_t{1} << 20, 7);
+  const auto first = m.Put(bytes);
+  const auto again = m.Put(bytes);
+  const auto other = m.Put(Pattern(uint64_t{1} << 20, 9));
+  for (const auto& id : {first, again, other}) m.manager->ExecuteSpill(id, TIER_DISK, /*fsync=*/false);
+
+  const auto blob = BlobKey(bytes);
+  EXPECT_EQ(m.Record(first).content_hash, blob);
+  EXPECT_EQ(m.Record(again).content_hash, blob);
+  EXPECT_NE(m.Record(other).content_hash, blob);
+  EXPECT_EQ(scratch.BinFiles(), 2);
+  EXPECT_TRUE(std::filesystem::exists(payload::storage::common::PayloadPath(scratch.disk_root, blob)));
+
+  // Both from the repository (first resolve) and from the control block (second).
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_EQ(m.manager->ResolveSnapshot(again).disk().path(), blob + ".bin");
+    EXPECT_EQ(m.manager->ResolveSnapshot(again).disk().length_bytes(), bytes.size());
+  }
+
+  const auto counters = m.manager->GetDedupCounters();
+  EXPECT_EQ(counters.lookups, 3u);
+  EXPECT_EQ(counters.hits, 1u);
+}
+
+TEST(ContentDedup, BlobIsRemovedWithItsLastReference) {
+  Scratch    scratch;
+  Manager    m(scratch);
+  const auto bytes = Pattern(64 * 1024, 7);
+  const auto first = m.Put(bytes);
+  const auto again = m.Put(bytes);
+  m.manager->ExecuteSpill(first, TIER_DISK, /*fsync=*/false);
+  m.manager->ExecuteSpill(again, TIER_DISK, /*fsync=*/false);
+
+  const auto blob_path = payload::storage::common::PayloadPath(scratch.disk_root, BlobKey(bytes));
+  const auto sidecar   = payload::storage::common::SidecarPath(scratch.disk_root, payload::util::ToString(payload::util::FromProto(first)));
+  EXPECT_TRUE(std::filesystem::exists(sidecar));
+
+  m.manager->Delete(first, /*force=*/false);
+  EXPECT_TRUE(std::filesystem::exists(blob_path));
+  EXPECT_FALSE(std::filesystem::exists(sidecar));
+
+  m.manager->Delete(again, /*force=*/false);
+  EXPECT_FALSE(std::filesystem::exists(blob_path));
+  EXPECT_EQ(scratch.BinFiles(), 0);
+}
+
+TEST(ContentDedup, PromotionReadsTheSharedBlob) {
+  Scratch    scratch;
+  Manager    m(scratch);
+  const auto bytes = Pattern(uint64_t{1} << 20, 7);
+  const auto first = m.Put(bytes);
+  const auto again = m.Put(bytes);
+  m.manager->ExecuteSpill(first, TIER_DISK, /*fsync=*/false);
+  m.manager->ExecuteSpill(again, TIER_DISK, /*fsync=*/false);
+  const auto blob_path = payload::storage::common::PayloadPath(scratch.disk_root, BlobKey(bytes));
+
+  EXPECT_EQ(m.manager->Promote(first, TIER_RAM).tier(), TIER_RAM);
+  const auto in_ram = m.ram->Read(first);
+  ASSERT_EQ(static_cast<uint64_t>(in_ram->size()), bytes.size());
+  EXPECT_EQ(std::memcmp(in_ram->data(), bytes.data(), bytes.size()), 0);
+  EXPECT_TRUE(m.Record(first).content_hash.empty());
+  EXPECT_TRUE(std::filesystem::exists(blob_path));
+
+  m.manager->Promote(again, TIER_RAM);
+  EXPECT_FALSE(std::filesystem::exists(blob_path));
+
+  // Spilled again, the payload finds no blob and stores a fresh one.
+  m.manager->ExecuteSpill(first, TIER_DISK, /*fsync=*/false);
+  EXPECT_TRUE(std::filesystem::exists(blob_path));
+  EXPECT_EQ(m.manager->GetDedupCounters().hits, 1u);
+}
+
+TEST(ContentDedup, PayloadsBelowMinBytesKeepTheirOwnCopy) {
+  Scratch    scratch;
+  Manager    m(scratch, /*min_bytes=*/1 << 20);
+  const auto bytes = Pattern(4096, 7);
+  const auto first = m.Put(bytes);
+  const auto again = m.Put(bytes);
+  m.manager->ExecuteSpill(first, TIER_DISK, /*fsync=*/false);
+  m.manager->ExecuteSpill(again, TIER_DISK, /*fsync=*/false);
+
+  EXPECT_TRUE(m.Record(first).content_hash.empty());
+  EXPECT_EQ(scratch.BinFiles(), 2);
+  EXPECT_EQ(m.manager->GetDedupCounters().lookups, 0u);
+}
+
+TEST(ContentDedup, StatsReportHitRateAndBytesSaved) {
+  Scratch    scratch;
+  Manager    m(scratch);
+  const auto bytes = Pattern(256 * 1024, 7);
+  for (int i = 0; i < 3; ++i) m.manager->ExecuteSpill(m.Put(bytes), TIER_DISK, /*fsync=*/false);
+  m.manager->ExecuteSpill(m.Put(Pattern(256 * 1024, 9)), TIER_DISK, /*fsync=*/false);
+
+  payload::service::ServiceContext ctx;
+  ctx.manager    = m.manager;
+  ctx.repository = m.repository;
+  ctx.metadata   = std::make_shared<payload::metadata::MetadataCache>();
+  ctx.lineage    = std::make_shared<payload::lineage::LineageGraph>();
+  payload::service::AdminService admin(ctx);
+
+  const auto stats = admin.Stats({});
+  EXPECT_EQ(stats.payloads_disk(), 4u);
+  EXPECT_EQ(stats.dedup_lookups(), 4u);
+  EXPECT_EQ(stats.dedup_hits(), 2u);
+  EXPECT_DOUBLE_EQ(stats.dedup_hit_rate(), 0.5);
+  EXPECT_EQ(stats.dedup_bytes_saved(), 2u * bytes.size());
+}
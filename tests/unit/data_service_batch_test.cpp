@@ -0,0 +1,193 @@
+/*
+  Tests for the batched ResolveSnapshots / AcquireReadLeases / ReleaseLeases
+  data-plane paths: per-item results, cache-miss resolution through one
+  repository transaction, and lease table batch entry points.
+*/
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include "internal/core/payload_manager.hpp"
+#include "internal/db/memory/memory_repository.hpp"
+#include "internal/lease/lease_manager.hpp"
+#include "internal/service/data_service.hpp"
+#include "internal/service/service_context.hpp"
+#include "internal/storage/storage_backend.hpp"
+#include "internal/util/uuid.hpp"
+#include "payload/manager/v1.hpp"
+
+namespace {
+
+using payload::core::PayloadManager;
+using payload::lease::LeaseManager;
+using payload::manager::v1::AcquireReadLeasesRequest;
+using payload::manager::v1::LEASE_MODE_READ;
+using payload::manager::v1::ReleaseLeasesRequest;
+using payload::manager::v1::ResolveSnapshotsRequest;
+using payload::manager::v1::TIER_RAM;
+
+class SimpleBackend final : public payload::storage::StorageBackend {
+ public:
+  std::shared_ptr<arrow::Buffer> Allocate(const payload::manager::v1::PayloadID& id, uint64_t size) override {
+    auto r = arrow::AllocateBuffer(size);
+    if (!r.ok()) throw std::runtime_error("alloc");
+    std::shared_ptr<arrow::Buffer> buf(std::move(*r));
+    if (size > 0) std::memset(buf->mutable_data(), 0, size);
+    std::lock_guard lock(mu_);
+    bufs_[id.value()] = buf;
+    return buf;
+  }
+  std::shared_ptr<arrow::Buffer> Read(const payload::manager::v1::PayloadID& id) override {
+    std::lock_guard lock(mu_);
+    return bufs_.at(id.value());
+  }
+  void Write(const payload::manager::v1::PayloadID& id, const std::shared_ptr<arrow::Buffer>& b, bool) override {
+    std::lock_guard lock(mu_);
+    bufs_[id.value()] = b;
+  }
+  void Remove(const payload::manager::v1::PayloadID& id) override {
+    std::lock_guard lock(mu_);
+    bufs_.erase(id.value());
+  }
+  payload::manager::v1::Tier TierType() const override {
+    return TIER_RAM;
+  }
+
+ private:
+  std::mutex                                                      mu_;
+  std::unordered_map<std::string, std::shared_ptr<arrow::Buffer>> bufs_;
+};
+
+struct Fixture {
+  std::shared_ptr<LeaseManager>                          lease_mgr = std::make_shared<LeaseManager>();
+  std::shared_ptr<payload::db::memory::MemoryRepository> repo      = std::make_shared<payload::db::memory::MemoryRepository>();
+  std::shared_ptr<SimpleBackend>                         ram       = std::make_shared<SimpleBackend>();
+  std::shared_ptr<PayloadManager>                        manager   = MakeManager();
+  payload::service::DataService                          data{[&] {
+    payload::service::ServiceContext c;
+    c.manager    = manager;
+    c.repository = repo;
+    c.lease_mgr  = lease_mgr;
+    return c;
+  }()};
+
+  // A second manager over the same repository and storage starts with an
+  // empty snapshot cache, so every resolve through it is a cache miss.
+  std::shared_ptr<PayloadManager> MakeManager() {
+    payload::storage::StorageFactory::TierMap s;
+    s[TIER_RAM] = ram;
+    return std::make_shared<PayloadManager>(s, lease_mgr, repo);
+  }
+
+  payload::manager::v1::PayloadID MakeCommitted() {
+    return manager->Commit(manager->Allocate(64, TIER_RAM).payload_id()).payload_id();
+  }
+};
+
+} // namespace
+
+TEST(DataServiceBatch, ResolveSnapshotsReportsPerItem) {
+  Fixture    f;
+  const auto first  = f.MakeCommitted();
+  const auto second = f.MakeCommitted();
+
+  ResolveSnapshotsRequest req;
+  *req.add_ids() = first;
+  *req.add_ids() = payload::util::ToProto(payload::util::GenerateUUID()); // unknown
+  *req.add_ids() = second;
+  req.add_ids()->set_value("short");                                      // malformed
+  *req.add_ids() = first;                                                 // duplicate
+
+  const auto resp = f.data.ResolveSnapshots(req);
+  ASSERT_EQ(resp.results_size(), 5);
+  EXPECT_TRUE(resp.results(0).ok());
+  EXPECT_FALSE(resp.results(1).ok());
+  EXPECT_FALSE(resp.results(1).error_message().empty());
+  EXPECT_TRUE(resp.results(2).ok());
+  EXPECT_FALSE(resp.results(3).ok());
+  EXPECT_TRUE(resp.results(4).ok());
+  EXPECT_EQ(resp.results(2).id().value(), second.value());
+  EXPECT_EQ(resp.results(2).payload_descriptor().payload_id().value(), second.value());
+  EXPECT_EQ(resp.results(4).payload_descriptor().version(), resp.results(0).payload_descriptor().version());
+}
+
+TEST(DataServiceBatch, ResolveSnapshotsFillsCacheMissesFromRepository) {
+  Fixture                                      f;
+  std::vector<payload::manager::v1::PayloadID> ids;
+  for (int i = 0; i < 16; ++i) ids.push_back(f.MakeCommitted());
+  ids.push_back(ids.front()); // duplicate miss shares one read
+
+  auto       cold    = f.MakeManager();
+  const auto results = cold->ResolveSnapshots(ids);
+  ASSERT_EQ(results.size(), ids.size());
+  for (std::size_t i = 0; i < ids.size(); ++i) {
+    ASSERT_TRUE(results[i].ok()) << i;
+    EXPECT_EQ(results[i].descriptor.payload_id().value(), ids[i].value());
+    EXPECT_EQ(results[i].descriptor.state(), f.manager->ResolveSnapshot(ids[i]).state());
+    EXPECT_EQ(results[i].descriptor.ram().length_bytes(), 64u);
+  }
+  // Misses were cached: the cold manager now serves LRU candidates for them.
+  EXPECT_TRUE(cold->LeastRecentlyUsed(TIER_RAM).has_value());
+}
+
+TEST(DataServiceBatch, AcquireAndReleaseLeasesPerItem) {
+  Fixture    f;
+  const auto first       = f.MakeCommitted();
+  const auto second      = f.MakeCommitted();
+  const auto uncommitted = f.manager->Allocate(64, TIER_RAM).payload_id();
+
+  AcquireReadLeasesRequest req;
+  for (const auto& id : {first, uncommitted, second}) {
+    auto* item          = req.add_items();
+    *item->mutable_id() = id;
+    item->set_mode(LEASE_MODE_READ);
+  }
+  auto* bad_mode          = req.add_items();
+  *bad_mode->mutable_id() = first;
+  bad_mode->set_mode(static_cast<payload::manager::v1::LeaseMode>(LEASE_MODE_READ + 7));
+
+  const auto resp = f.data.AcquireReadLeases(req);
+  ASSERT_EQ(resp.results_size(), 4);
+  EXPECT_TRUE(resp.results(0).ok());
+  EXPECT_FALSE(resp.results(1).ok()); // not readable until committed
+  EXPECT_TRUE(resp.results(2).ok());
+  EXPECT_FALSE(resp.results(3).ok());
+  EXPECT_FALSE(resp.results(3).error_message().empty());
+  EXPECT_EQ(resp.results(2).lease().payload_descriptor().payload_id().value(), second.value());
+  EXPECT_TRUE(resp.results(2).lease().has_lease_expires_at());
+
+  EXPECT_EQ(f.lease_mgr->CountActiveLeases(first), 1u);
+  EXPECT_EQ(f.lease_mgr->CountActiveLeases(second), 1u);
+  EXPECT_EQ(f.lease_mgr->CountActiveLeases(uncommitted), 0u);
+
+  ReleaseLeasesRequest release;
+  *release.add_lease_ids() = resp.results(0).lease().lease_id();
+  *release.add_lease_ids() = resp.results(2).lease().lease_id();
+  f.data.ReleaseLeases(release);
+  f.data.ReleaseLeases(release); // idempotent
+
+  EXPECT_FALSE(f.lease_mgr->HasActiveLeases(first));
+  EXPECT_FALSE(f.lease_mgr->HasActiveLeases(second));
+}
+
+TEST(DataServiceBatch, AcquireReadLeasesSkipsPayloadsBeingDeleted) {
+  Fixture    f;
+  const auto kept    = f.MakeCommitted();
+  const auto deleted = f.MakeCommitted();
+  f.manager->Delete(deleted, /*force=*/true);
+
+  std::vector<PayloadManager::LeaseSpec> specs(2);
+  specs[0].id = kept;
+  specs[1].id = deleted;
+  const auto results = f.manager->AcquireReadLeases(specs);
+  ASSERT_EQ(results.size(), 2u);
+  EXPECT_TRUE(results[0].ok());
+  EXPECT_FALSE(results[1].ok());
+  EXPECT_EQ(f.lease_mgr->CountActiveLeases(deleted), 0u);
+}
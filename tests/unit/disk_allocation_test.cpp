@@ -0,0 +1,253 @@
+/*
+  Disk allocation tests.
+
+  Covers preallocated versus sparse payload files, reserving against the
+  tier capacity at allocate time (failing fast with ResourceExhausted),
+  the reservation following writes, rewrites, packed payloads, removals
+  and abandoned writers, the used bytes rebuilt from the root on restart,
+  and concurrent allocations never overcommitting the tier.
+*/
+
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "internal/core/payload_manager.hpp"
+#include "internal/db/memory/memory_repository.hpp"
+#include "internal/lease/lease_manager.hpp"
+#include "internal/storage/disk/disk_arrow_store.hpp"
+#include "internal/storage/ram/ram_arrow_store.hpp"
+#include "internal/util/errors.hpp"
+#include "internal/util/uuid.hpp"
+#include "payload/manager/v1.hpp"
+
+namespace {
+
+using payload::core::PayloadManager;
+using payload::manager::v1::DiskLocation;
+using payload::manager::v1::PayloadID;
+using payload::manager::v1::TIER_DISK;
+using payload::manager::v1::TIER_RAM;
+using payload::storage::DiskArrowStore;
+using payload::storage::DiskStoreOptions;
+using payload::storage::RamArrowStore;
+using payload::util::ResourceExhausted;
+
+struct Scratch {
+  std::string           prefix;
+  std::filesystem::path root;
+
+  Scratch() {
+    static std::atomic<int> next{0};
+    prefix = "pm-allocation-test-" + std::to_string(getpid()) + "-" + std::to_string(next.fetch_add(1));
+    root   = std::filesystem::temp_directory_path() / prefix;
+  }
+
+  ~Scratch() {
+    std::error_code ec;
+    std::filesystem::remove_all(root, ec);
+    for (std::filesystem::directory_iterator it("/dev/shm", ec); !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+      const auto file = it->path().filename().string();
+      if (file.rfind(prefix + "-", 0) == 0) {
+        shm_unlink(("/" + file).c_str());
+      }
+    }
+  }
+
+  // Whether the scratch filesystem implements fallocate at all.
+  bool SupportsFallocate() const {
+    std::filesystem::create_directories(root);
+    const auto probe = (root / "probe").string();
+    const int  fd    = open(probe.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if (fd < 0) return false;
+    const bool supported = fallocate(fd, 0, 0, 4096) == 0 || (errno != EOPNOTSUPP && errno != ENOSYS);
+    close(fd);
+    std::filesystem::remove(probe);
+    return supported;
+  }
+};
+
+DiskStoreOptions Options(uint64_t capacity_bytes, bool preallocate = false) {
+  DiskStoreOptions options;
+  options.capacity_bytes = capacity_bytes;
+  options.preallocate    = preallocate;
+  return options;
+}
+
+PayloadID NewId() {
+  return payload::util::ToProto(payload::util::GenerateUUID());
+}
+
+std::filesystem::path FileOf(const std::filesystem::path& root, const DiskArrowStore& store, const PayloadID& id) {
+  DiskLocation location;
+  store.Locate(payload::util::ToString(payload::util::FromProto(id)), &location);
+  return root / location.path();
+}
+
+uint64_t AllocatedBytes(const std::filesystem::path& path) {
+  struct stat st{};
+  EXPECT_EQ(stat(path.c_str(), &st), 0) << path;
+  return static_cast<uint64_t>(st.st_blocks) * 512;
+}
+
+std::shared_ptr<arrow::Buffer> Bytes(uint64_t size) {
+  return arrow::Buffer::FromString(std::string(size, 'x'));
+}
+
+} // namespace
+
+TEST(DiskAllocation, PreallocatedFilesOwnTheirExtents) {
+  Scratch scratch;
+  if (!scratch.SupportsFallocate()) GTEST_SKIP() << "fallocate not supported under " << scratch.root;
+  constexpr uint64_t kSize = uint64_t{4} << 20;
+
+  const auto     dense_root = scratch.root / "preallocated";
+  DiskArrowStore preallocated(dense_root, Options(0, /*preallocate=*/true));
+  const auto     dense = NewId();
+  preallocated.Allocate(dense, kSize);
+  const auto dense_file = FileOf(dense_root, preallocated, dense);
+  EXPECT_EQ(std::filesystem::file_size(dense_file), kSize);
+  EXPECT_GE(AllocatedBytes(dense_file), kSize);
+
+  const auto     hole_root = scratch.root / "sparse";
+  DiskArrowStore sparse(hole_root, Options(0));
+  const auto     hole = NewId();
+  sparse.Allocate(hole, kSize);
+  const auto hole_file = FileOf(hole_root, sparse, hole);
+  EXPECT_EQ(std::filesystem::file_size(hole_file), kSize);
+  EXPECT_LT(AllocatedBytes(hole_file), kSize);
+}
+
+TEST(DiskAllocation, CapacityRejectsAtAllocate) {
+  Scratch        scratch;
+  DiskArrowStore store(scratch.root, Options(1000));
+
+  const auto first = NewId();
+  store.Allocate(first, 600);
+  EXPECT_EQ(store.UsedBytes(), 600u);
+
+  const auto second = NewId();
+  EXPECT_THROW(store.Allocate(second, 500), ResourceExhausted);
+  EXPECT_FALSE(std::filesystem::exists(FileOf(scratch.root, store, second)));
+  EXPECT_EQ(store.UsedBytes(), 600u);
+  EXPECT_THROW(store.Write(second, Bytes(500), /*fsync=*/false), ResourceExhausted);
+  EXPECT_THROW(store.OpenWriter(second, 500, /*fsync=*/false), ResourceExhausted);
+
+  store.Remove(first);
+  EXPECT_EQ(store.UsedBytes(), 0u);
+  store.Allocate(second, 500);
+  EXPECT_EQ(store.UsedBytes(), 500u);
+}
+
+TEST(DiskAllocation, ReservationFollowsWritesAndRemovals) {
+  Scratch          scratch;
+  DiskStoreOptions options         = Options(1 << 20);
+  options.pack.enabled             = true;
+  options.pack.max_payload_bytes   = 256;
+  options.pack.compaction_interval = std::chrono::milliseconds(0);
+  DiskArrowStore store(scratch.root, options);
+
+  const auto file = NewId();
+  store.Write(file, Bytes(4096), /*fsync=*/false);
+  EXPECT_EQ(store.UsedBytes(), 4096u);
+  store.Write(file, Bytes(1000), /*fsync=*/false);
+  EXPECT_EQ(store.UsedBytes(), 1000u);
+
+  // Shrinking into the pack moves the bytes rather than adding them.
+  store.Write(file, Bytes(100), /*fsync=*/false);
+  EXPECT_EQ(store.UsedBytes(), 100u);
+  const auto packed = NewId();
+  store.Write(packed, Bytes(200), /*fsync=*/false);
+  EXPECT_EQ(store.UsedBytes(), 300u);
+
+  {
+    auto writer = store.OpenWriter(NewId(), 8192, /*fsync=*/false);
+    EXPECT_EQ(store.UsedBytes(), 8492u);
+  }
+  EXPECT_EQ(store.UsedBytes(), 300u) << "an abandoned writer gives its reservation back";
+
+  const auto streamed = NewId();
+  auto       writer   = store.OpenWriter(streamed, 2048, /*fsync=*/false);
+  const auto chunk    = Bytes(2048);
+  writer->Append(chunk->data(), chunk->size());
+  writer->Commit();
+  EXPECT_EQ(store.UsedBytes(), 2348u);
+
+  store.Remove(file);
+  store.Remove(packed);
+  store.Remove(streamed);
+  EXPECT_EQ(store.UsedBytes(), 0u);
+}
+
+TEST(DiskAllocation, RestartCountsExistingPayloads) {
+  Scratch          scratch;
+  DiskStoreOptions options         = Options(1 << 20);
+  options.fanout_levels            = 2;
+  options.pack.enabled             = true;
+  options.pack.max_payload_bytes   = 256;
+  options.pack.compaction_interval = std::chrono::milliseconds(0);
+  {
+    DiskArrowStore store(scratch.root, options);
+    store.Write(NewId(), Bytes(5000), /*fsync=*/false);
+    store.Write(NewId(), Bytes(128), /*fsync=*/false);
+    store.Allocate(NewId(), 3000);
+  }
+  DiskArrowStore reopened(scratch.root, options);
+  EXPECT_EQ(reopened.UsedBytes(), 8128u);
+
+  // Untracked without a capacity.
+  EXPECT_EQ(DiskArrowStore(scratch.root, Options(0)).UsedBytes(), 0u);
+}
+
+TEST(DiskAllocation, ConcurrentAllocationsNeverOvercommit) {
+  Scratch            scratch;
+  constexpr uint64_t kChunk    = 4096;
+  constexpr uint64_t kCapacity = kChunk * 10;
+  DiskArrowStore     store(scratch.root, Options(kCapacity));
+
+  std::atomic<int>         admitted{0};
+  std::atomic<int>         rejected{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < 8; ++i) {
+        try {
+          store.Allocate(NewId(), kChunk);
+          admitted.fetch_add(1);
+        } catch (const ResourceExhausted&) {
+          rejected.fetch_add(1);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  EXPECT_EQ(admitted.load(), 10);
+  EXPECT_EQ(rejected.load(), 54);
+  EXPECT_EQ(store.UsedBytes(), kCapacity);
+}
+
+TEST(DiskAllocation, ManagerAllocateFailsFastWhenTierIsFull) {
+  Scratch scratch;
+  auto    disk = std::make_shared<DiskArrowStore>(scratch.root, Options(1024));
+
+  payload::storage::StorageFactory::TierMap storage;
+  storage[TIER_RAM]  = std::make_shared<RamArrowStore>(scratch.prefix);
+  storage[TIER_DISK] = disk;
+  PayloadManager manager(storage, std::make_shared<payload::lease::LeaseManager>(), std::make_shared<payload::db::memory::MemoryRepository>());
+
+  manager.Allocate(1000, TIER_DISK);
+  EXPECT_THROW(manager.Allocate(1000, TIER_DISK), ResourceExhausted);
+  EXPECT_EQ(disk->UsedBytes(), 1000u);
+}
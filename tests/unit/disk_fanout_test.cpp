@@ -0,0 +1,219 @@
+/*
+  Disk fan-out layout tests.
+
+  Covers the hashed directory for a payload id, DiskArrowStore placing
+  data and sidecar files under it, DiskLocation.path naming the file
+  relative to the root (for payloads and shared content blobs), and the
+  startup migration between flat and fanned-out roots.
+*/
+
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "internal/core/payload_manager.hpp"
+#include "internal/db/memory/memory_repository.hpp"
+#include "internal/lease/lease_manager.hpp"
+#include "internal/storage/common/path_utils.hpp"
+#include "internal/storage/disk/disk_arrow_store.hpp"
+#include "internal/storage/ram/ram_arrow_store.hpp"
+#include "internal/util/uuid.hpp"
+#include "payload/manager/catalog/v1/archive_metadata.pb.h"
+#include "payload/manager/v1.hpp"
+
+namespace {
+
+using payload::core::PayloadManager;
+using payload::manager::v1::PayloadID;
+using payload::manager::v1::TIER_DISK;
+using payload::manager::v1::TIER_RAM;
+using payload::storage::DiskArrowStore;
+using payload::storage::DiskStoreOptions;
+using payload::storage::RamArrowStore;
+using payload::storage::common::FanoutDir;
+
+struct Scratch {
+  std::string           prefix;
+  std::filesystem::path root;
+
+  Scratch() {
+    static std::atomic<int> next{0};
+    prefix = "pm-fanout-test-" + std::to_string(getpid()) + "-" + std::to_string(next.fetch_add(1));
+    root   = std::filesystem::temp_directory_path() / prefix;
+  }
+
+  ~Scratch() {
+    std::error_code ec;
+    std::filesystem::remove_all(root, ec);
+    for (std::filesystem::directory_iterator it("/dev/shm", ec); !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+      const auto file = it->path().filename().string();
+      if (file.rfind(prefix + "-", 0) == 0) {
+        shm_unlink(("/" + file).c_str());
+      }
+    }
+  }
+
+  // Files directly under the root with this extension.
+  int TopLevel(const std::string& extension) const {
+    int             count = 0;
+    std::error_code ec;
+    for (std::filesystem::directory_iterator it(root, ec); !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+      if (it->is_regular_file() && it->path().extension() == extension) ++count;
+    }
+    return count;
+  }
+};
+
+std::shared_ptr<DiskArrowStore> Store(const Scratch& scratch, uint32_t levels) {
+  DiskStoreOptions options;
+  options.fanout_levels = levels;
+  return std::make_shared<DiskArrowStore>(scratch.root, options);
+}
+
+std::string Name(const PayloadID& id) {
+  return payload::util::ToString(payload::util::FromProto(id));
+}
+
+std::string LocatedPath(const DiskArrowStore& store, const std::string& key) {
+  payload::manager::v1::DiskLocation location;
+  store.Locate(key, &location);
+  return location.path();
+}
+
+std::shared_ptr<arrow::Buffer> Bytes(const std::string& text) {
+  return arrow::Buffer::FromString(text);
+}
+
+payload::manager::catalog::v1::PayloadArchiveMetadata Meta(const PayloadID& id) {
+  payload::manager::catalog::v1::PayloadArchiveMetadata meta;
+  *meta.mutable_uuid() = id;
+  meta.set_metadata_version(1);
+  return meta;
+}
+
+} // namespace
+
+TEST(DiskFanout, DirectoryIsAStableHashOfTheId) {
+  const std::string id = "0f8e2b7c-4d1a-4e55-9a3b-6c2d1e0f9a88";
+  EXPECT_TRUE(FanoutDir(id, 0).empty());
+  const auto one = FanoutDir(id, 1).string();
+  const auto two = FanoutDir(id, 2).string();
+  ASSERT_EQ(one.size(), 2u);
+  ASSERT_EQ(two.size(), 5u);
+  EXPECT_EQ(two.substr(0, 3), one + "/");
+  EXPECT_EQ(FanoutDir(id, 2), FanoutDir(id, 2));
+  EXPECT_EQ(payload::storage::common::PayloadPath("/r", id, 2), std::filesystem::path("/r") / two / (id + ".bin"));
+
+  // Ids spread over the leaf directories.
+  std::vector<int> buckets(256, 0);
+  for (int i = 0; i < 4096; ++i) {
+    ++buckets[payload::storage::common::FanoutBucket(payload::util::ToString(payload::util::GenerateUUID()), 1)];
+  }
+  for (int count : buckets) EXPECT_GT(count, 0);
+}
+
+TEST(DiskFanout, StorePlacesFilesInHashedDirectories) {
+  Scratch    scratch;
+  auto       store = Store(scratch, 2);
+  const auto id    = payload::util::ToProto(payload::util::GenerateUUID());
+  const auto dir   = scratch.root / FanoutDir(Name(id), 2);
+
+  store->Write(id, Bytes("fanned out"), /*fsync=*/false);
+  store->WriteSidecar(id, Meta(id));
+  EXPECT_TRUE(std::filesystem::exists(dir / (Name(id) + ".bin")));
+  EXPECT_TRUE(std::filesystem::exists(dir / (Name(id) + ".meta.json")));
+  EXPECT_EQ(scratch.TopLevel(".bin"), 0);
+  EXPECT_EQ(store->Read(id)->ToString(), "fanned out");
+  EXPECT_EQ(store->Size(id), 10u);
+  EXPECT_EQ(LocatedPath(*store, Name(id)), (FanoutDir(Name(id), 2) / (Name(id) + ".bin")).string());
+
+  const auto other = payload::util::ToProto(payload::util::GenerateUUID());
+  store->Allocate(other, 64);
+  EXPECT_EQ(std::filesystem::file_size(scratch.root / LocatedPath(*store, Name(other))), 64u);
+
+  store->Remove(id);
+  EXPECT_FALSE(std::filesystem::exists(dir / (Name(id) + ".bin")));
+  EXPECT_FALSE(std::filesystem::exists(dir / (Name(id) + ".meta.json")));
+}
+
+TEST(DiskFanout, MigratesBetweenLayoutsAtStartup) {
+  Scratch                scratch;
+  std::vector<PayloadID> ids;
+  {
+    auto flat = Store(scratch, 0);
+    for (int i = 0; i < 20; ++i) {
+      ids.push_back(payload::util::ToProto(payload::util::GenerateUUID()));
+      flat->Write(ids.back(), Bytes("payload " + std::to_string(i)), /*fsync=*/false);
+      flat->WriteSidecar(ids.back(), Meta(ids.back()));
+    }
+    EXPECT_EQ(flat->MigratedFiles(), 0u);
+  }
+  EXPECT_EQ(scratch.TopLevel(".bin"), 20);
+
+  {
+    auto fanned = Store(scratch, 2);
+    EXPECT_EQ(fanned->MigratedFiles(), 40u);
+    EXPECT_EQ(scratch.TopLevel(".bin"), 0);
+    EXPECT_EQ(scratch.TopLevel(".json"), 0);
+    for (int i = 0; i < 20; ++i) {
+      EXPECT_EQ(fanned->Read(ids[i])->ToString(), "payload " + std::to_string(i));
+      EXPECT_TRUE(std::filesystem::exists(scratch.root / FanoutDir(Name(ids[i]), 2) / (Name(ids[i]) + ".meta.json")));
+    }
+  }
+  // Recorded in .layout: an unchanged setting does not walk the root again.
+  EXPECT_EQ(Store(scratch, 2)->MigratedFiles(), 0u);
+
+  auto flat = Store(scratch, 0);
+  EXPECT_EQ(flat->MigratedFiles(), 40u);
+  EXPECT_EQ(scratch.TopLevel(".bin"), 20);
+  EXPECT_EQ(flat->Read(ids[3])->ToString(), "payload 3");
+  for (std::filesystem::directory_iterator it(scratch.root); it != std::filesystem::directory_iterator(); ++it) {
+    EXPECT_FALSE(it->is_directory() && it->path().filename().string().size() == 2) << "emptied fan-out directory left behind: " << it->path();
+  }
+}
+
+TEST(DiskFanout, RejectsMoreThanTwoLevels) {
+  Scratch scratch;
+  EXPECT_THROW(Store(scratch, 3), std::invalid_argument);
+}
+
+TEST(DiskFanout, DescriptorsNameTheFannedOutFile) {
+  Scratch scratch;
+  auto    ram  = std::make_shared<RamArrowStore>(scratch.prefix);
+  auto    disk = Store(scratch, 2);
+
+  payload::storage::StorageFactory::TierMap storage;
+  storage[TIER_RAM]  = ram;
+  storage[TIER_DISK] = disk;
+  auto manager       = std::make_shared<PayloadManager>(storage, std::make_shared<payload::lease::LeaseManager>(),
+                                                        std::make_shared<payload::db::memory::MemoryRepository>());
+  manager->SetDedupOptions({/*enabled=*/true, /*min_bytes=*/0});
+
+  const std::string text = "spilled into a hashed directory";
+  auto              put  = [&] {
+    const auto allocated = manager->Allocate(text.size(), TIER_RAM);
+    std::memcpy(ram->Read(allocated.payload_id())->mutable_data(), text.data(), text.size());
+    return manager->Commit(allocated.payload_id()).payload_id();
+  };
+  const auto first = put();
+  const auto again = put();
+  manager->ExecuteSpill(first, TIER_DISK, /*fsync=*/false);
+  manager->ExecuteSpill(again, TIER_DISK, /*fsync=*/false);
+
+  // Both resolve to the shared blob's file, which clients open relative to the root.
+  const auto path = manager->ResolveSnapshot(first).disk().path();
+  EXPECT_EQ(path.find('/'), 2u);
+  EXPECT_EQ(manager->ResolveSnapshot(again).disk().path(), path);
+  EXPECT_EQ(std::filesystem::file_size(scratch.root / path), text.size());
+
+  EXPECT_EQ(manager->Promote(again, TIER_RAM).tier(), TIER_RAM);
+  EXPECT_EQ(ram->Read(again)->ToString(), text);
+}
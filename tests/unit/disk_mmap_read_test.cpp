@@ -0,0 +1,142 @@
+/*
+  Memory-mapped read tests.
+
+  With read_mode = mmap, DiskArrowStore::Read (and the object tier on the
+  local filesystem) returns a buffer over a mapping of the payload file
+  rather than a heap copy. Checks the mapping shows up in /proc/self/maps,
+  survives the payload being replaced or removed, and handles empty
+  payloads; pread mode still returns a private copy.
+*/
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include "internal/storage/common/arrow_utils.hpp"
+#include "internal/storage/common/path_utils.hpp"
+#include "internal/storage/disk/disk_arrow_store.hpp"
+#include "internal/storage/object/object_arrow_store.hpp"
+#include "internal/util/uuid.hpp"
+
+namespace {
+
+using payload::manager::v1::PayloadID;
+using payload::storage::DiskArrowStore;
+using payload::storage::DiskStoreOptions;
+
+struct Scratch {
+  std::filesystem::path root;
+
+  Scratch() {
+    static std::atomic<int> next{0};
+    root = std::filesystem::temp_directory_path() / ("pm-mmap-test-" + std::to_string(getpid()) + "-" + std::to_string(next.fetch_add(1)));
+    std::filesystem::create_directories(root);
+  }
+
+  ~Scratch() {
+    std::error_code ec;
+    std::filesystem::remove_all(root, ec);
+  }
+};
+
+std::shared_ptr<arrow::Buffer> Filled(uint64_t size, uint8_t value) {
+  return arrow::Buffer::FromString(std::string(size, static_cast<char>(value)));
+}
+
+// True when a mapping of path (or of a deleted file that was at path) exists.
+bool Mapped(const std::filesystem::path& path) {
+  std::ifstream maps("/proc/self/maps");
+  std::string   line;
+  while (std::getline(maps, line)) {
+    if (line.find(path.string()) != std::string::npos) return true;
+  }
+  return false;
+}
+
+bool AllEqual(const arrow::Buffer& buffer, uint8_t value) {
+  for (int64_t i = 0; i < buffer.size(); ++i) {
+    if (buffer.data()[i] != value) return false;
+  }
+  return true;
+}
+
+PayloadID NewId() {
+  return payload::util::ToProto(payload::util::GenerateUUID());
+}
+
+std::filesystem::path DiskPath(const std::filesystem::path& root, const PayloadID& id) {
+  return payload::storage::common::PayloadPath(root, payload::util::ToString(payload::util::FromProto(id)));
+}
+
+} // namespace
+
+TEST(DiskMmapRead, ReadReturnsAMappingThatOutlivesTheFile) {
+  Scratch          scratch;
+  DiskStoreOptions options;
+  options.mmap_reads = true;
+  DiskArrowStore disk(scratch.root, options);
+
+  const auto id = NewId();
+  disk.Write(id, Filled(3 << 20, 0x11), /*fsync=*/false);
+
+  auto mapped = disk.Read(id);
+  ASSERT_EQ(mapped->size(), 3 << 20);
+  EXPECT_TRUE(AllEqual(*mapped, 0x11));
+  EXPECT_TRUE(Mapped(DiskPath(scratch.root, id)));
+
+  // Replacing the payload renames a new file into place; the old mapping
+  // keeps the old bytes rather than faulting.
+  disk.Write(id, Filled(1 << 20, 0x22), /*fsync=*/false);
+  EXPECT_TRUE(AllEqual(*mapped, 0x11));
+  EXPECT_TRUE(AllEqual(*disk.Read(id), 0x22));
+
+  disk.Remove(id);
+  EXPECT_TRUE(AllEqual(*mapped, 0x11));
+
+  mapped.reset();
+  EXPECT_FALSE(Mapped(DiskPath(scratch.root, id)));
+}
+
+TEST(DiskMmapRead, EmptyPayload) {
+  Scratch          scratch;
+  DiskStoreOptions options;
+  options.mmap_reads = true;
+  DiskArrowStore disk(scratch.root, options);
+
+  const auto id = NewId();
+  disk.Write(id, Filled(0, 0), /*fsync=*/false);
+  EXPECT_EQ(disk.Read(id)->size(), 0);
+}
+
+TEST(DiskMmapRead, PreadModeCopies) {
+  Scratch        scratch;
+  DiskArrowStore disk(scratch.root);
+
+  const auto id = NewId();
+  disk.Write(id, Filled(1 << 20, 0x33), /*fsync=*/false);
+  auto copy = disk.Read(id);
+  EXPECT_TRUE(AllEqual(*copy, 0x33));
+  EXPECT_FALSE(Mapped(DiskPath(scratch.root, id)));
+}
+
+TEST(DiskMmapRead, ObjectTierOnLocalFilesystemMaps) {
+  Scratch                                 scratch;
+  pb::arrow::storage::ObjectStorageConfig config;
+  config.set_root_path(scratch.root.string());
+  config.set_filesystem(pb::arrow::storage::FILE_SYSTEM_LOCAL);
+  config.set_read_mode(pb::arrow::storage::READ_MODE_MMAP);
+
+  auto [fs, root] = payload::storage::common::Unwrap(payload::storage::common::ResolveFileSystem(config.root_path(), config));
+  payload::storage::ObjectArrowStore object(fs, root);
+
+  const auto id = NewId();
+  object.Write(id, Filled(1 << 20, 0x44), /*fsync=*/false);
+  auto mapped = object.Read(id);
+  EXPECT_TRUE(AllEqual(*mapped, 0x44));
+  EXPECT_TRUE(Mapped(scratch.root / (payload::util::ToString(payload::util::FromProto(id)) + ".bin")));
+}
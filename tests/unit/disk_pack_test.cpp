@@ -0,0 +1,450 @@
+/*
+  Packed disk layout tests.
+
+  Covers small payloads appended to shared segment files and located by
+  (segment, offset), the size threshold keeping large payloads in files
+  of their own, tombstones and the index surviving a restart, a torn
+  segment tail and a hole mid-segment, compaction reclaiming dead records
+  (on demand and on the background thread), concurrent writers, readers
+  and compaction agreeing with replay, and PayloadManager handing out
+  packed locations (following them after compaction).
+*/
+
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "internal/core/payload_manager.hpp"
+#include "internal/db/memory/memory_repository.hpp"
+#include "internal/lease/lease_manager.hpp"
+#include "internal/storage/disk/disk_arrow_store.hpp"
+#include "internal/storage/ram/ram_arrow_store.hpp"
+#include "internal/util/uuid.hpp"
+#include "payload/manager/v1.hpp"
+
+namespace {
+
+using payload::core::PayloadManager;
+using payload::manager::v1::DiskLocation;
+using payload::manager::v1::PayloadID;
+using payload::manager::v1::TIER_DISK;
+using payload::manager::v1::TIER_RAM;
+using payload::storage::DiskArrowStore;
+using payload::storage::DiskStoreOptions;
+using payload::storage::PackOptions;
+using payload::storage::PackStore;
+using payload::storage::RamArrowStore;
+
+struct Scratch {
+  std::string           prefix;
+  std::filesystem::path root;
+
+  Scratch() {
+    static std::atomic<int> next{0};
+    prefix = "pm-pack-test-" + std::to_string(getpid()) + "-" + std::to_string(next.fetch_add(1));
+    root   = std::filesystem::temp_directory_path() / prefix;
+  }
+
+  ~Scratch() {
+    std::error_code ec;
+    std::filesystem::remove_all(root, ec);
+    for (std::filesystem::directory_iterator it("/dev/shm", ec); !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+      const auto file = it->path().filename().string();
+      if (file.rfind(prefix + "-", 0) == 0) {
+        shm_unlink(("/" + file).c_str());
+      }
+    }
+  }
+
+  // Files under the root (recursively) with this extension.
+  int Files(const std::string& extension) const {
+    int             count = 0;
+    std::error_code ec;
+    for (std::filesystem::recursive_directory_iterator it(root, ec); !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+      if (it->is_regular_file() && it->path().extension() == extension) ++count;
+    }
+    return count;
+  }
+
+  std::string Contents(const std::filesystem::path& relative, uint64_t offset, uint64_t length) const {
+    std::ifstream in(root / relative, std::ios::binary);
+    in.seekg(static_cast<std::streamoff>(offset));
+    std::string bytes(length, '\0');
+    in.read(bytes.data(), static_cast<std::streamsize>(length));
+    return bytes;
+  }
+};
+
+DiskStoreOptions Packing(uint64_t max_payload_bytes = 1024, uint64_t segment_bytes = uint64_t{1} << 20) {
+  DiskStoreOptions options;
+  options.pack.enabled             = true;
+  options.pack.max_payload_bytes   = max_payload_bytes;
+  options.pack.segment_bytes       = segment_bytes;
+  options.pack.compaction_interval = std::chrono::milliseconds(0);
+  options.pack.retire_grace        = std::chrono::milliseconds(0);
+  return options;
+}
+
+std::string Name(const PayloadID& id) {
+  return payload::util::ToString(payload::util::FromProto(id));
+}
+
+PayloadID NewId() {
+  return payload::util::ToProto(payload::util::GenerateUUID());
+}
+
+std::shared_ptr<arrow::Buffer> Bytes(const std::string& text) {
+  return arrow::Buffer::FromString(text);
+}
+
+DiskLocation Located(const DiskArrowStore& store, const PayloadID& id) {
+  DiskLocation location;
+  store.Locate(Name(id), &location);
+  return location;
+}
+
+} // namespace
+
+TEST(DiskPack, SmallPayloadsShareASegment) {
+  Scratch        scratch;
+  DiskArrowStore store(scratch.root, Packing());
+
+  std::vector<PayloadID> ids;
+  for (int i = 0; i < 100; ++i) {
+    ids.push_back(NewId());
+    store.Write(ids.back(), Bytes("small payload " + std::to_string(i)), /*fsync=*/i == 0);
+  }
+  EXPECT_EQ(scratch.Files(".bin"), 0);
+  EXPECT_EQ(scratch.Files(".pack"), 1);
+
+  for (int i = 0; i < 100; ++i) {
+    const auto text = "small payload " + std::to_string(i);
+    EXPECT_EQ(store.Read(ids[i])->ToString(), text);
+    EXPECT_EQ(store.Size(ids[i]), text.size());
+
+    // Clients open the segment at the offset; the location maps back to the key.
+    const auto location = Located(store, ids[i]);
+    EXPECT_EQ(location.path(), "packs/" + PackStore::SegmentName(1));
+    EXPECT_EQ(scratch.Contents(location.path(), location.offset_bytes(), text.size()), text);
+    EXPECT_EQ(store.LocatedKey(location), Name(ids[i]));
+  }
+  EXPECT_EQ(store.OpenReader(ids[0]), nullptr);
+  EXPECT_EQ(store.Packs()->GetStats().live_records, 100u);
+}
+
+TEST(DiskPack, LargePayloadsKeepTheirOwnFile) {
+  Scratch        scratch;
+  DiskArrowStore store(scratch.root, Packing(/*max_payload_bytes=*/16));
+  const auto     id = NewId();
+
+  store.Write(id, Bytes(std::string(64, 'L')), /*fsync=*/false);
+  EXPECT_EQ(scratch.Files(".bin"), 1);
+  EXPECT_EQ(Located(store, id).path(), Name(id) + ".bin");
+  EXPECT_EQ(Located(store, id).offset_bytes(), 0u);
+  EXPECT_EQ(store.LocatedKey(Located(store, id)), Name(id));
+
+  // Rewritten under the threshold: packed, and the file goes away...
+  store.Write(id, Bytes("tiny"), /*fsync=*/false);
+  EXPECT_EQ(scratch.Files(".bin"), 0);
+  EXPECT_EQ(store.Read(id)->ToString(), "tiny");
+
+  // ...and back over it through a streaming writer: the packed copy goes away.
+  auto writer = store.OpenWriter(id, 32, /*fsync=*/false);
+  writer->Append(reinterpret_cast<const uint8_t*>(std::string(32, 'S').data()), 32);
+  writer->Commit();
+  EXPECT_FALSE(store.Packs()->Find(Name(id)));
+  EXPECT_EQ(store.Read(id)->ToString(), std::string(32, 'S'));
+
+  // Small payloads are declined for kernel copies so Write packs them.
+  DiskStoreOptions options = Packing(/*max_payload_bytes=*/16);
+  options.kernel_copy      = true;
+  DiskArrowStore copying(scratch.root / "copying", options);
+  EXPECT_FALSE(copying.WriteFromFile(NewId(), /*fd=*/-1, 0, 8, /*fsync=*/false));
+}
+
+TEST(DiskPack, PackedWriterFillsTheDestination) {
+  Scratch        scratch;
+  DiskArrowStore store(scratch.root, Packing());
+  const auto     id = NewId();
+
+  auto writer = store.OpenWriter(id, 5, /*fsync=*/false);
+  ASSERT_NE(writer->Destination(), nullptr);
+  std::memcpy(writer->Destination(), "filled", 5);
+  writer->Commit();
+  EXPECT_EQ(store.Read(id)->ToString(), "fille");
+  EXPECT_EQ(scratch.Files(".bin"), 0);
+}
+
+TEST(DiskPack, IndexSurvivesRestart) {
+  Scratch                scratch;
+  std::vector<PayloadID> ids;
+  {
+    DiskArrowStore store(scratch.root, Packing());
+    for (int i = 0; i < 10; ++i) {
+      ids.push_back(NewId());
+      store.Write(ids.back(), Bytes("v1-" + std::to_string(i)), /*fsync=*/false);
+    }
+    store.Write(ids[0], Bytes("v2-0"), /*fsync=*/false);
+    store.Remove(ids[1]);
+  }
+
+  DiskArrowStore store(scratch.root, Packing());
+  EXPECT_EQ(store.Read(ids[0])->ToString(), "v2-0");
+  EXPECT_FALSE(store.Packs()->Find(Name(ids[1])));
+  for (int i = 2; i < 10; ++i) EXPECT_EQ(store.Read(ids[i])->ToString(), "v1-" + std::to_string(i));
+
+  // Appends after a restart start a new segment.
+  store.Write(NewId(), Bytes("after restart"), /*fsync=*/false);
+  EXPECT_EQ(scratch.Files(".pack"), 2);
+}
+
+TEST(DiskPack, TornTailIsIgnored) {
+  Scratch   scratch;
+  PayloadID kept  = NewId();
+  PayloadID torn  = NewId();
+  const auto path = scratch.root / "packs" / PackStore::SegmentName(1);
+  {
+    DiskArrowStore store(scratch.root, Packing());
+    store.Write(kept, Bytes("complete record"), /*fsync=*/false);
+    store.Write(torn, Bytes("record cut short by a crash"), /*fsync=*/false);
+  }
+  std::filesystem::resize_file(path, std::filesystem::file_size(path) - 5);
+
+  DiskArrowStore store(scratch.root, Packing());
+  EXPECT_EQ(store.Read(kept)->ToString(), "complete record");
+  EXPECT_FALSE(store.Packs()->Find(Name(torn)));
+  EXPECT_GT(store.Packs()->GetStats().dead_bytes, 0u);
+}
+
+TEST(DiskPack, HoleMidSegmentIsSkipped) {
+  Scratch   scratch;
+  PayloadID before = NewId();
+  PayloadID hole   = NewId();
+  PayloadID after  = NewId();
+  const auto path  = scratch.root / "packs" / PackStore::SegmentName(1);
+  uint64_t   hole_offset;
+  {
+    DiskArrowStore store(scratch.root, Packing());
+    store.Write(before, Bytes("written before"), /*fsync=*/false);
+    store.Write(hole, Bytes("never finished"), /*fsync=*/false);
+    store.Write(after, Bytes("written after"), /*fsync=*/false);
+    hole_offset = store.Packs()->Find(Name(hole))->offset;
+  }
+  // Clobber the middle record's data, as a write that failed part way would.
+  {
+    std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(static_cast<std::streamoff>(hole_offset));
+    file.write("xxxx", 4);
+  }
+
+  DiskArrowStore store(scratch.root, Packing());
+  EXPECT_EQ(store.Read(before)->ToString(), "written before");
+  EXPECT_FALSE(store.Packs()->Find(Name(hole)));
+  EXPECT_EQ(store.Read(after)->ToString(), "written after");
+}
+
+TEST(DiskPack, CompactionReclaimsDeadRecords) {
+  Scratch                scratch;
+  std::vector<PayloadID> ids;
+  {
+    // ~4 records per segment.
+    DiskArrowStore store(scratch.root, Packing(/*max_payload_bytes=*/1024, /*segment_bytes=*/1024));
+    for (int i = 0; i < 40; ++i) {
+      ids.push_back(NewId());
+      store.Write(ids.back(), Bytes(std::string(200, static_cast<char>('a' + i % 26))), /*fsync=*/false);
+    }
+    const auto segments = scratch.Files(".pack");
+    EXPECT_GE(segments, 8);
+    for (int i = 0; i < 40; ++i) {
+      if (i % 4 != 0) store.Remove(ids[i]);
+    }
+    const auto before = store.Packs()->GetStats();
+
+    const auto locations_before = Located(store, ids[4]);
+    EXPECT_GT(store.Packs()->Compact(), 0u);
+    const auto after = store.Packs()->GetStats();
+    EXPECT_LT(after.dead_bytes, before.dead_bytes);
+    EXPECT_EQ(after.live_records, 10u);
+    EXPECT_NE(Located(store, ids[4]).path(), locations_before.path());
+
+    // Retired segments are unlinked by the next pass once the grace is over.
+    store.Packs()->Compact();
+    EXPECT_LT(scratch.Files(".pack"), segments);
+    for (int i = 0; i < 40; i += 4) {
+      EXPECT_EQ(store.Read(ids[i])->ToString(), std::string(200, static_cast<char>('a' + i % 26)));
+    }
+  }
+
+  // Removals carried forward as tombstones stay removed after a restart.
+  DiskArrowStore store(scratch.root, Packing(/*max_payload_bytes=*/1024, /*segment_bytes=*/1024));
+  EXPECT_EQ(store.Packs()->GetStats().live_records, 10u);
+  for (int i = 0; i < 40; ++i) {
+    EXPECT_EQ(static_cast<bool>(store.Packs()->Find(Name(ids[i]))), i % 4 == 0) << i;
+  }
+}
+
+TEST(DiskPack, BackgroundCompaction) {
+  Scratch          scratch;
+  DiskStoreOptions options         = Packing(/*max_payload_bytes=*/1024, /*segment_bytes=*/512);
+  options.pack.compaction_interval = std::chrono::milliseconds(10);
+  DiskArrowStore store(scratch.root, options);
+
+  std::vector<PayloadID> ids;
+  for (int i = 0; i < 12; ++i) {
+    ids.push_back(NewId());
+    store.Write(ids.back(), Bytes(std::string(200, 'b')), /*fsync=*/false);
+  }
+  for (int i = 0; i < 11; ++i) store.Remove(ids[i]);
+  for (int i = 0; i < 500 && store.Packs()->GetStats().compacted_segments == 0; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_GT(store.Packs()->GetStats().compacted_segments, 0u);
+  EXPECT_EQ(store.Read(ids[11])->ToString(), std::string(200, 'b'));
+}
+
+TEST(DiskPack, ConcurrentWritersMatchReplay) {
+  constexpr int kWriters = 4;
+  constexpr int kKeys    = 64;
+  constexpr int kRounds  = 20;
+  Scratch       scratch;
+  const auto    dir = scratch.root / "packs";
+
+  // Writer w owns keys w, w + kWriters, ...; round r leaves value r or removes it.
+  auto value = [](int key, int round) { return std::to_string(key) + ":" + std::to_string(round) + std::string(40 + key % 50, 'v'); };
+  auto kept  = [](int key, int round) { return (key + round) % 5 != 0; };
+  std::vector<std::string> keys;
+  for (int k = 0; k < kKeys; ++k) keys.push_back(Name(NewId()));
+
+  PackOptions options;
+  options.enabled             = true;
+  options.segment_bytes       = 4096;
+  options.compaction_interval = std::chrono::milliseconds(0);
+  options.retire_grace        = std::chrono::milliseconds(0);
+  {
+    PackStore                store(dir, options);
+    std::atomic<bool>        writing{true};
+    std::vector<std::thread> threads;
+    for (int w = 0; w < kWriters; ++w) {
+      threads.emplace_back([&, w] {
+        for (int r = 0; r < kRounds; ++r) {
+          for (int k = w; k < kKeys; k += kWriters) {
+            const auto bytes = value(k, r);
+            store.Put(keys[k], reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size(), /*fsync=*/false);
+            if (!kept(k, r)) EXPECT_TRUE(store.Remove(keys[k]));
+          }
+        }
+      });
+    }
+    std::thread reader([&] {
+      while (writing.load()) {
+        for (int k = 0; k < kKeys; ++k) {
+          // Whatever a read sees is some round's complete value.
+          if (const auto buffer = store.Read(keys[k])) EXPECT_EQ(buffer->ToString().rfind(std::to_string(k) + ":", 0), 0u);
+        }
+      }
+    });
+    std::thread compactor([&] {
+      while (writing.load()) store.Compact();
+    });
+    for (auto& thread : threads) thread.join();
+    writing = false;
+    reader.join();
+    compactor.join();
+    store.Compact();
+
+    for (int k = 0; k < kKeys; ++k) {
+      const auto buffer = store.Read(keys[k]);
+      ASSERT_EQ(static_cast<bool>(buffer), kept(k, kRounds - 1)) << k;
+      if (buffer) EXPECT_EQ(buffer->ToString(), value(k, kRounds - 1));
+    }
+  }
+
+  // Replay reaches the same index.
+  PackStore store(dir, options);
+  for (int k = 0; k < kKeys; ++k) {
+    const auto buffer = store.Read(keys[k]);
+    ASSERT_EQ(static_cast<bool>(buffer), kept(k, kRounds - 1)) << k;
+    if (buffer) EXPECT_EQ(buffer->ToString(), value(k, kRounds - 1));
+  }
+}
+
+TEST(DiskPack, DescriptorsLocatePackedPayloads) {
+  Scratch scratch;
+  auto    ram  = std::make_shared<RamArrowStore>(scratch.prefix);
+  auto    disk = std::make_shared<DiskArrowStore>(scratch.root, Packing());
+
+  payload::storage::StorageFactory::TierMap storage;
+  storage[TIER_RAM]  = ram;
+  storage[TIER_DISK] = disk;
+  auto manager       = std::make_shared<PayloadManager>(storage, std::make_shared<payload::lease::LeaseManager>(),
+                                                        std::make_shared<payload::db::memory::MemoryRepository>());
+  manager->SetDedupOptions({/*enabled=*/true, /*min_bytes=*/0});
+
+  auto put = [&](const std::string& text) {
+    const auto allocated = manager->Allocate(text.size(), TIER_RAM);
+    std::memcpy(ram->Read(allocated.payload_id())->mutable_data(), text.data(), text.size());
+    const auto id = manager->Commit(allocated.payload_id()).payload_id();
+    manager->ExecuteSpill(id, TIER_DISK, /*fsync=*/false);
+    return id;
+  };
+  const std::string text   = "packed next to its neighbours";
+  const auto        first  = put("an earlier payload");
+  const auto        second = put(text);
+  const auto        again  = put(text);
+
+  const auto location = manager->ResolveSnapshot(second).disk();
+  EXPECT_EQ(location.path().rfind("packs/", 0), 0u);
+  EXPECT_GT(location.offset_bytes(), manager->ResolveSnapshot(first).disk().offset_bytes());
+  EXPECT_EQ(scratch.Contents(location.path(), location.offset_bytes(), location.length_bytes()), text);
+
+  // The duplicate resolves to the shared blob's record, and promotes from it.
+  const auto shared = manager->ResolveSnapshot(again).disk();
+  EXPECT_EQ(shared.path(), location.path());
+  EXPECT_EQ(shared.offset_bytes(), location.offset_bytes());
+  EXPECT_EQ(manager->Promote(again, TIER_RAM).tier(), TIER_RAM);
+  EXPECT_EQ(ram->Read(again)->ToString(), text);
+  EXPECT_EQ(scratch.Files(".bin"), 0);
+}
+
+TEST(DiskPack, ResolveHitsFollowCompaction) {
+  Scratch scratch;
+  auto    ram  = std::make_shared<RamArrowStore>(scratch.prefix);
+  auto    disk = std::make_shared<DiskArrowStore>(scratch.root, Packing(/*max_payload_bytes=*/1024, /*segment_bytes=*/1024));
+
+  payload::storage::StorageFactory::TierMap storage;
+  storage[TIER_RAM]  = ram;
+  storage[TIER_DISK] = disk;
+  auto manager       = std::make_shared<PayloadManager>(storage, std::make_shared<payload::lease::LeaseManager>(),
+                                                        std::make_shared<payload::db::memory::MemoryRepository>());
+
+  std::vector<PayloadID> ids;
+  for (int i = 0; i < 8; ++i) {
+    const std::string text(200, static_cast<char>('a' + i));
+    const auto        allocated = manager->Allocate(text.size(), TIER_RAM);
+    std::memcpy(ram->Read(allocated.payload_id())->mutable_data(), text.data(), text.size());
+    ids.push_back(manager->Commit(allocated.payload_id()).payload_id());
+    manager->ExecuteSpill(ids.back(), TIER_DISK, /*fsync=*/false);
+  }
+  const auto before = manager->ResolveSnapshot(ids[0]).disk();
+  EXPECT_EQ(manager->ResolveSnapshot(ids[0]).disk().offset_bytes(), before.offset_bytes());
+  for (int i = 1; i < 8; ++i) manager->Delete(ids[i], /*force=*/true);
+  ASSERT_GT(disk->Packs()->Compact(), 0u);
+
+  // The cached location is stale once compaction moved the record; the hit re-locates it.
+  const auto after = manager->ResolveSnapshot(ids[0]).disk();
+  EXPECT_NE(after.path(), before.path());
+  EXPECT_EQ(after.path(), Located(*disk, ids[0]).path());
+  EXPECT_EQ(after.offset_bytes(), Located(*disk, ids[0]).offset_bytes());
+  EXPECT_EQ(scratch.Contents(after.path(), after.offset_bytes(), after.length_bytes()), std::string(200, 'a'));
+}
@@ -0,0 +1,308 @@
+/*
+  Striped disk tier tests.
+
+  Covers placing payloads over several roots in proportion to their free
+  space, skipping full roots (ResourceExhausted once all are), spreading
+  concurrent writes by queue depth, absolute DiskLocation paths that map
+  back to their payload, finding payloads from an earlier run (indexed by
+  one scan at startup, never probed afterwards), StorageFactory keeping
+  disk.root_path as a root next to disk.roots, per-root traffic counters,
+  and PayloadManager spilling onto striped roots.
+*/
+
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "internal/core/payload_manager.hpp"
+#include "internal/db/memory/memory_repository.hpp"
+#include "internal/lease/lease_manager.hpp"
+#include "internal/storage/disk/striped_disk_store.hpp"
+#include "internal/storage/storage_factory.hpp"
+#include "internal/storage/ram/ram_arrow_store.hpp"
+#include "internal/util/errors.hpp"
+#include "internal/util/uuid.hpp"
+#include "payload/manager/v1.hpp"
+
+namespace {
+
+using payload::core::PayloadManager;
+using payload::manager::v1::DiskLocation;
+using payload::manager::v1::PayloadID;
+using payload::manager::v1::TIER_DISK;
+using payload::manager::v1::TIER_RAM;
+using payload::storage::DiskArrowStore;
+using payload::storage::DiskRoot;
+using payload::storage::DiskStoreOptions;
+using payload::storage::RamArrowStore;
+using payload::storage::StripedDiskStore;
+using payload::util::ResourceExhausted;
+
+struct Scratch {
+  std::string           prefix;
+  std::filesystem::path root;
+
+  Scratch() {
+    static std::atomic<int> next{0};
+    prefix = "pm-striping-test-" + std::to_string(getpid()) + "-" + std::to_string(next.fetch_add(1));
+    root   = std::filesystem::temp_directory_path() / prefix;
+  }
+
+  ~Scratch() {
+    std::error_code ec;
+    std::filesystem::remove_all(root, ec);
+    for (std::filesystem::directory_iterator it("/dev/shm", ec); !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+      const auto file = it->path().filename().string();
+      if (file.rfind(prefix + "-", 0) == 0) {
+        shm_unlink(("/" + file).c_str());
+      }
+    }
+  }
+
+  // One root per capacity, named nvme<i>.
+  std::vector<DiskRoot> Roots(const std::vector<uint64_t>& capacities) const {
+    std::vector<DiskRoot> roots;
+    for (std::size_t i = 0; i < capacities.size(); ++i) {
+      roots.push_back({root / ("nvme" + std::to_string(i)), capacities[i], "nvme" + std::to_string(i)});
+    }
+    return roots;
+  }
+};
+
+PayloadID NewId() {
+  return payload::util::ToProto(payload::util::GenerateUUID());
+}
+
+std::string Name(const PayloadID& id) {
+  return payload::util::ToString(payload::util::FromProto(id));
+}
+
+std::shared_ptr<arrow::Buffer> Bytes(uint64_t size, char fill = 'x') {
+  return arrow::Buffer::FromString(std::string(size, fill));
+}
+
+} // namespace
+
+TEST(DiskStriping, FillsRootsInProportionToFreeSpace) {
+  Scratch scratch;
+  EXPECT_THROW(StripedDiskStore({}), std::invalid_argument);
+
+  constexpr uint64_t kChunk = uint64_t{16} << 10;
+  constexpr uint64_t kMiB   = uint64_t{1} << 20;
+  StripedDiskStore   store(scratch.Roots({kMiB, 3 * kMiB}));
+  for (int i = 0; i < 192; ++i) {
+    store.Write(NewId(), Bytes(kChunk), /*fsync=*/false);
+  }
+
+  // The larger root takes everything until both have 1 MiB free, then they alternate.
+  const auto small = store.Device(0).UsedBytes();
+  const auto large = store.Device(1).UsedBytes();
+  EXPECT_EQ(small + large, 3 * kMiB);
+  EXPECT_NEAR(static_cast<double>(small), static_cast<double>(kMiB / 2), static_cast<double>(kChunk));
+  EXPECT_NEAR(static_cast<double>(large), static_cast<double>(5 * kMiB / 2), static_cast<double>(kChunk));
+}
+
+TEST(DiskStriping, SkipsFullRootsAndFailsWhenAllAreFull) {
+  Scratch            scratch;
+  constexpr uint64_t kSize = uint64_t{64} << 10;
+  StripedDiskStore   store(scratch.Roots({kSize, kSize}));
+
+  const auto first  = NewId();
+  const auto second = NewId();
+  store.Allocate(first, kSize);
+  store.Allocate(second, kSize);
+  ASSERT_TRUE(store.DeviceOf(first).has_value());
+  ASSERT_TRUE(store.DeviceOf(second).has_value());
+  EXPECT_NE(*store.DeviceOf(first), *store.DeviceOf(second));
+
+  const auto third = NewId();
+  EXPECT_THROW(store.Allocate(third, kSize), ResourceExhausted);
+  EXPECT_THROW(store.Write(third, Bytes(kSize), /*fsync=*/false), ResourceExhausted);
+  EXPECT_FALSE(store.DeviceOf(third).has_value());
+
+  const auto freed = *store.DeviceOf(first);
+  store.Remove(first);
+  EXPECT_FALSE(store.DeviceOf(first).has_value());
+  store.Allocate(third, kSize);
+  EXPECT_EQ(store.DeviceOf(third), freed);
+}
+
+TEST(DiskStriping, QueueDepthSpreadsConcurrentWrites) {
+  Scratch            scratch;
+  constexpr uint64_t kMiB = uint64_t{1} << 20;
+  StripedDiskStore   store(scratch.Roots({8 * kMiB, 8 * kMiB}));
+
+  // Equal free space: the open stream on one root sends the next write to the other.
+  const auto streamed = NewId();
+  auto       writer   = store.OpenWriter(streamed, kMiB, /*fsync=*/false);
+  const auto usage    = store.DeviceUsage();
+  ASSERT_EQ(usage.size(), 2u);
+  EXPECT_EQ(usage[0].queue_depth + usage[1].queue_depth, 1u);
+  const std::size_t busy = usage[0].queue_depth == 1 ? 0 : 1;
+
+  const auto other = NewId();
+  store.Write(other, Bytes(kMiB), /*fsync=*/false);
+  EXPECT_EQ(store.DeviceOf(other), 1 - busy);
+
+  const auto chunk = Bytes(kMiB);
+  writer->Append(chunk->data(), chunk->size());
+  writer->Commit();
+  writer.reset();
+  EXPECT_EQ(store.DeviceOf(streamed), busy);
+  EXPECT_EQ(store.Read(streamed)->size(), static_cast<int64_t>(kMiB));
+  for (const auto& device : store.DeviceUsage()) EXPECT_EQ(device.queue_depth, 0u);
+}
+
+TEST(DiskStriping, LocationsAreAbsoluteAndMapBack) {
+  Scratch          scratch;
+  DiskStoreOptions options;
+  options.fanout_levels            = 1;
+  options.pack.enabled             = true;
+  options.pack.max_payload_bytes   = 256;
+  options.pack.compaction_interval = std::chrono::milliseconds(0);
+  StripedDiskStore store(scratch.Roots({0, 0}), options);
+
+  const auto file   = NewId();
+  const auto packed = NewId();
+  store.Write(file, Bytes(4096, 'f'), /*fsync=*/false);
+  store.Write(packed, Bytes(100, 'p'), /*fsync=*/false);
+
+  for (const auto& id : {file, packed}) {
+    DiskLocation location;
+    store.Locate(Name(id), &location);
+    const std::filesystem::path path(location.path());
+    EXPECT_TRUE(path.is_absolute()) << path;
+    const auto root = (scratch.root / ("nvme" + std::to_string(*store.DeviceOf(id)))).string();
+    EXPECT_EQ(location.path().rfind(root + "/", 0), 0u) << path;
+    EXPECT_TRUE(std::filesystem::exists(path));
+    EXPECT_EQ(store.LocatedKey(location), Name(id));
+  }
+
+  DiskLocation foreign;
+  foreign.set_path("/elsewhere/" + Name(file) + ".bin");
+  EXPECT_FALSE(store.LocatedKey(foreign).has_value());
+}
+
+TEST(DiskStriping, FindsPayloadsFromAnEarlierRun) {
+  Scratch                  scratch;
+  std::vector<PayloadID>   ids;
+  std::vector<std::size_t> placed;
+  {
+    StripedDiskStore store(scratch.Roots({uint64_t{1} << 20, uint64_t{1} << 20, uint64_t{1} << 20}));
+    for (int i = 0; i < 12; ++i) {
+      ids.push_back(NewId());
+      store.Write(ids.back(), arrow::Buffer::FromString("payload " + std::to_string(i)), /*fsync=*/false);
+      placed.push_back(*store.DeviceOf(ids.back()));
+    }
+  }
+
+  StripedDiskStore reopened(scratch.Roots({uint64_t{1} << 20, uint64_t{1} << 20, uint64_t{1} << 20}));
+  for (int i = 0; i < 12; ++i) {
+    EXPECT_EQ(reopened.Read(ids[i])->ToString(), "payload " + std::to_string(i));
+    EXPECT_EQ(reopened.DeviceOf(ids[i]), placed[i]);
+  }
+  reopened.Remove(ids[0]);
+  EXPECT_FALSE(reopened.DeviceOf(ids[0]).has_value());
+}
+
+TEST(DiskStriping, IndexesRootsOnceAtStartup) {
+  Scratch          scratch;
+  const auto       id = NewId();
+  StripedDiskStore store(scratch.Roots({0, 0}));
+
+  // Written behind the striped store's back: not looked for until the next startup.
+  DiskArrowStore(scratch.root / "nvme1").Write(id, arrow::Buffer::FromString("late"), /*fsync=*/false);
+  EXPECT_FALSE(store.DeviceOf(id).has_value());
+
+  StripedDiskStore reopened(scratch.Roots({0, 0}));
+  EXPECT_EQ(reopened.DeviceOf(id), 1u);
+  EXPECT_EQ(reopened.Read(id)->ToString(), "late");
+}
+
+TEST(DiskStriping, FactoryKeepsRootPathAsARoot) {
+  Scratch    scratch;
+  const auto id = NewId();
+  DiskArrowStore(scratch.root / "legacy").Write(id, arrow::Buffer::FromString("before striping"), /*fsync=*/false);
+
+  payload::runtime::config::StorageConfig cfg;
+  cfg.mutable_ram()->set_shm_prefix(scratch.prefix);
+  cfg.mutable_disk()->set_root_path((scratch.root / "legacy").string());
+  for (const auto* name : {"nvme0", "nvme1"}) cfg.mutable_disk()->add_roots()->set_path((scratch.root / name).string());
+
+  auto stores = payload::storage::StorageFactory::Build(cfg);
+  auto disk   = std::dynamic_pointer_cast<StripedDiskStore>(stores.at(TIER_DISK));
+  ASSERT_NE(disk, nullptr);
+  EXPECT_EQ(disk->DeviceCount(), 3u);
+  EXPECT_EQ(disk->DeviceOf(id), 2u);
+  EXPECT_EQ(disk->Read(id)->ToString(), "before striping");
+
+  // Listing it among the roots as well does not stripe over it twice.
+  cfg.mutable_disk()->add_roots()->set_path((scratch.root / "nvme0" / ".." / "legacy").string());
+  stores = payload::storage::StorageFactory::Build(cfg);
+  EXPECT_EQ(std::dynamic_pointer_cast<StripedDiskStore>(stores.at(TIER_DISK))->DeviceCount(), 3u);
+}
+
+TEST(DiskStriping, CountsTrafficPerDevice) {
+  Scratch            scratch;
+  constexpr uint64_t kChunk = uint64_t{64} << 10;
+  StripedDiskStore   store(scratch.Roots({0, 0, 0, 0}));
+
+  std::vector<PayloadID> ids(64);
+  for (auto& id : ids) id = NewId();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&, t] {
+      for (int i = t; i < 64; i += 8) store.Write(ids[i], Bytes(kChunk), /*fsync=*/false);
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  for (const auto& id : ids) EXPECT_EQ(store.Read(id)->size(), static_cast<int64_t>(kChunk));
+
+  uint64_t read    = 0;
+  uint64_t written = 0;
+  for (const auto& device : store.DeviceUsage()) {
+    EXPECT_EQ(device.name.rfind("nvme", 0), 0u);
+    EXPECT_GT(device.capacity_bytes, 0u);
+    EXPECT_EQ(device.queue_depth, 0u);
+    read += device.read_bytes;
+    written += device.written_bytes;
+  }
+  EXPECT_EQ(read, 64 * kChunk);
+  EXPECT_EQ(written, 64 * kChunk);
+}
+
+TEST(DiskStriping, ManagerSpillsOntoStripedRoots) {
+  Scratch scratch;
+  auto    ram  = std::make_shared<RamArrowStore>(scratch.prefix);
+  auto    disk = std::make_shared<StripedDiskStore>(scratch.Roots({uint64_t{1} << 20, uint64_t{1} << 20}));
+
+  payload::storage::StorageFactory::TierMap storage;
+  storage[TIER_RAM]  = ram;
+  storage[TIER_DISK] = disk;
+  PayloadManager manager(storage, std::make_shared<payload::lease::LeaseManager>(), std::make_shared<payload::db::memory::MemoryRepository>());
+
+  const std::string text      = "spilled onto a striped root";
+  const auto        allocated = manager.Allocate(text.size(), TIER_RAM);
+  std::memcpy(ram->Read(allocated.payload_id())->mutable_data(), text.data(), text.size());
+  const auto id = manager.Commit(allocated.payload_id()).payload_id();
+  manager.ExecuteSpill(id, TIER_DISK, /*fsync=*/false);
+
+  const auto path = manager.ResolveSnapshot(id).disk().path();
+  EXPECT_TRUE(std::filesystem::path(path).is_absolute()) << path;
+  EXPECT_EQ(std::filesystem::file_size(path), text.size());
+  EXPECT_EQ(manager.GetDiskDeviceUsage().size(), 2u);
+
+  EXPECT_EQ(manager.Promote(id, TIER_RAM).tier(), TIER_RAM);
+  EXPECT_EQ(ram->Read(id)->ToString(), text);
+  EXPECT_FALSE(disk->DeviceOf(id).has_value());
+}
@@ -177,3 +177,25 @@ TEST(LeaseTable, SecondaryIndexCleanupOnInsertAndRemoveAll) {
   EXPECT_TRUE(table.HasActive(payload_a));
   EXPECT_FALSE(table.HasActive(payload_b));
 }
+
+TEST(LeaseTable, BatchInsertAndRemoveSpanPayloads) {
+  LeaseTable table;
+  const auto first  = MakePayloadID("payload-batch-a");
+  const auto second = MakePayloadID("payload-batch-b");
+  const auto later  = std::chrono::system_clock::now() + std::chrono::seconds(30);
+
+  const auto inserted =
+      table.InsertBatch({MakeLease("lease-a1", first, later), MakeLease("lease-a2", first, later), MakeLease("lease-b1", second, later)});
+  ASSERT_EQ(inserted.size(), 3u);
+  EXPECT_EQ(inserted[2].lease_id.value(), "lease-b1");
+  EXPECT_EQ(table.CountActive(first), 2u);
+  EXPECT_EQ(table.CountActive(second), 1u);
+
+  // Unknown ids are ignored, matching Remove().
+  table.RemoveBatch({MakeLeaseID("lease-a1"), MakeLeaseID("lease-b1"), MakeLeaseID("lease-missing")});
+  EXPECT_EQ(table.CountActive(first), 1u);
+  EXPECT_FALSE(table.HasActive(second));
+
+  table.RemoveBatch({MakeLeaseID("lease-a2")});
+  EXPECT_TRUE(table.WaitUntilNoLeases(first, std::chrono::steady_clock::now()));
+}
@@ -0,0 +1,189 @@
+/*
+  Multipart object upload and ranged read tests.
+
+  UploadParts (and FetchRanges, which shares its scheduling) must cover
+  every byte exactly once, keep no more than concurrency parts in flight,
+  retry a failing part up to part_retries times and surface the error once
+  it runs out; parts run on the caller and a shared PartExecutor, so
+  repeated calls reuse its threads and a single part never leaves the
+  caller. ObjectArrowStore on the local filesystem writes payloads
+  larger than one part in parallel and reads them back as parallel ranges;
+  checks the object round-trips, no temporary file is left behind, and a
+  promotion into RAM assembles the ranges in the shm segment.
+*/
+
+#include <arrow/filesystem/localfs.h>
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "internal/storage/object/multipart_upload.hpp"
+#include "internal/storage/object/object_arrow_store.hpp"
+#include "internal/storage/payload_transfer.hpp"
+#include "internal/storage/ram/ram_arrow_store.hpp"
+#include "internal/util/uuid.hpp"
+
+namespace {
+
+using payload::storage::MultipartOptions;
+using payload::storage::PartExecutor;
+using payload::storage::ObjectArrowStore;
+using payload::storage::RangedReadOptions;
+using payload::storage::UploadParts;
+
+struct Scratch {
+  std::filesystem::path root;
+
+  Scratch() {
+    static std::atomic<int> next{0};
+    root = std::filesystem::temp_directory_path() / ("pm-multipart-test-" + std::to_string(getpid()) + "-" + std::to_string(next.fetch_add(1)));
+    std::filesystem::create_directories(root);
+  }
+
+  ~Scratch() {
+    std::error_code ec;
+    std::filesystem::remove_all(root, ec);
+  }
+};
+
+MultipartOptions Options(uint64_t part_bytes, uint32_t concurrency, uint32_t part_retries = 0) {
+  MultipartOptions options;
+  options.part_bytes   = part_bytes;
+  options.concurrency  = concurrency;
+  options.part_retries = part_retries;
+  return options;
+}
+
+RangedReadOptions Ranges(uint64_t range_bytes, uint32_t concurrency) {
+  RangedReadOptions options;
+  options.range_bytes   = range_bytes;
+  options.concurrency   = concurrency;
+  options.range_retries = 0;
+  return options;
+}
+
+std::shared_ptr<arrow::Buffer> Pattern(uint64_t size) {
+  std::string bytes(size, '\0');
+  for (uint64_t i = 0; i < size; ++i) bytes[i] = static_cast<char>(i * 31 + 7);
+  return arrow::Buffer::FromString(std::move(bytes));
+}
+
+} // namespace
+
+TEST(MultipartUpload, CoversEveryByteOnce) {
+  std::mutex                   mutex;
+  std::map<uint64_t, uint64_t> parts;
+  UploadParts(10 * 1000 + 7, Options(1000, 4), [&](uint64_t offset, uint64_t length) {
+    std::lock_guard lock(mutex);
+    EXPECT_TRUE(parts.emplace(offset, length).second);
+  });
+
+  ASSERT_EQ(parts.size(), 11u);
+  uint64_t expected = 0;
+  for (const auto& [offset, length] : parts) {
+    EXPECT_EQ(offset, expected);
+    expected += length;
+  }
+  EXPECT_EQ(expected, 10 * 1000 + 7);
+  EXPECT_EQ(parts.rbegin()->second, 7u);
+
+  bool called = false;
+  UploadParts(0, Options(1000, 4), [&](uint64_t, uint64_t) { called = true; });
+  EXPECT_FALSE(called);
+}
+
+TEST(MultipartUpload, BoundsPartsInFlight) {
+  std::atomic<int> in_flight{0};
+  std::atomic<int> peak{0};
+  UploadParts(32, Options(1, 4), [&](uint64_t, uint64_t) {
+    const int now = in_flight.fetch_add(1) + 1;
+    int       seen = peak.load();
+    while (now > seen && !peak.compare_exchange_weak(seen, now)) {
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    in_flight.fetch_sub(1);
+  });
+  EXPECT_GT(peak.load(), 1);
+  EXPECT_LE(peak.load(), 4);
+}
+
+TEST(MultipartUpload, RunsPartsOnASharedExecutor) {
+  PartExecutor                executor(2);
+  std::mutex                  mutex;
+  std::set<std::thread::id>   threads;
+  const auto                  record = [&](uint64_t, uint64_t) {
+    std::lock_guard lock(mutex);
+    threads.insert(std::this_thread::get_id());
+  };
+  for (int i = 0; i < 50; ++i) UploadParts(8, Options(1, 4), record, &executor);
+  // The caller plus the executor's two threads, however many calls ran.
+  EXPECT_LE(threads.size(), 3u);
+  EXPECT_TRUE(threads.count(std::this_thread::get_id()));
+
+  threads.clear();
+  UploadParts(1000, Options(1000, 4), record, &executor);
+  EXPECT_EQ(threads, std::set<std::thread::id>{std::this_thread::get_id()});
+}
+
+TEST(MultipartUpload, RetriesAFailingPart) {
+  std::atomic<int> attempts{0};
+  UploadParts(4, Options(1, 2, /*part_retries=*/2), [&](uint64_t offset, uint64_t) {
+    if (offset == 2 && attempts.fetch_add(1) < 2) throw std::runtime_error("transient");
+  });
+  EXPECT_EQ(attempts.load(), 3);
+}
+
+TEST(MultipartUpload, FailsOnceRetriesRunOut) {
+  std::atomic<int> attempts{0};
+  EXPECT_THROW(UploadParts(4, Options(1, 1, /*part_retries=*/2),
+                           [&](uint64_t offset, uint64_t) {
+                             if (offset == 1) {
+                               attempts.fetch_add(1);
+                               throw std::runtime_error("down");
+                             }
+                           }),
+               std::runtime_error);
+  EXPECT_EQ(attempts.load(), 3);
+}
+
+TEST(MultipartUpload, LocalObjectStoreRoundTrip) {
+  Scratch          scratch;
+  ObjectArrowStore object(std::make_shared<arrow::fs::LocalFileSystem>(), scratch.root.string(), false, Options(1 << 20, 4), Ranges(1 << 20, 4));
+
+  for (uint64_t size : {uint64_t{0}, uint64_t{(1 << 20) - 1}, uint64_t{3 * (1 << 20) + 7}}) {
+    const auto id      = payload::util::ToProto(payload::util::GenerateUUID());
+    const auto payload = Pattern(size);
+    object.Write(id, payload, /*fsync=*/false);
+    EXPECT_TRUE(object.Read(id)->Equals(*payload)) << "size " << size;
+    EXPECT_EQ(object.Size(id), size);
+  }
+
+  for (const auto& entry : std::filesystem::directory_iterator(scratch.root)) {
+    EXPECT_NE(entry.path().extension(), ".tmp") << entry.path();
+  }
+}
+
+TEST(MultipartUpload, PromotionAssemblesRangesInRam) {
+  Scratch                         scratch;
+  ObjectArrowStore                object(std::make_shared<arrow::fs::LocalFileSystem>(), scratch.root.string(), false, {}, Ranges(256 * 1024, 4));
+  payload::storage::RamArrowStore ram("pm-multipart-promote-" + std::to_string(getpid()));
+
+  const auto id      = payload::util::ToProto(payload::util::GenerateUUID());
+  const auto payload = Pattern(3 * (1 << 20) + 7);
+  object.Write(id, payload, /*fsync=*/false);
+  EXPECT_EQ(object.OpenReader(id)->PreferredReadBytes(), 1u << 20);
+
+  payload::storage::CopyPayload(object, ram, id, /*fsync=*/false, payload::storage::TransferOptions{});
+  EXPECT_TRUE(ram.Read(id)->Equals(*payload));
+  ram.Remove(id);
+}
@@ -0,0 +1,312 @@
+/*
+  Durable-tier payload compression tests.
+
+  Covers the frame codec (round trip for every codec this Arrow build
+  provides, corrupt frames, codecs payloads cannot use), transcodes
+  streamed in small chunks between RAM and DISK and between codecs, and
+  PayloadManager compressing a RAM → DISK spill with the tier's codec,
+  recording the stored codec and size in the repository, descriptor and
+  sidecar, and decompressing on promotion back to RAM. An eviction
+  policy's spill_codec overrides the tier's. A repository lost under a
+  DISK tier with manifest sidecars is rebuilt from the manifests, codec
+  and checksum included.
+*/
+
+#include <arrow/util/compression.h>
+#include <google/protobuf/util/json_util.h>
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "internal/core/payload_manager.hpp"
+#include "internal/db/memory/memory_repository.hpp"
+#include "internal/lease/lease_manager.hpp"
+#include "internal/storage/checksum.hpp"
+#include "internal/storage/common/path_utils.hpp"
+#include "internal/storage/disk/disk_arrow_store.hpp"
+#include "internal/storage/payload_codec.hpp"
+#include "internal/storage/ram/ram_arrow_store.hpp"
+#include "internal/util/uuid.hpp"
+#include "payload/manager/v1.hpp"
+
+namespace {
+
+using payload::core::PayloadManager;
+using payload::manager::v1::PayloadCodec;
+using payload::manager::v1::PayloadID;
+using payload::manager::v1::TIER_DISK;
+using payload::manager::v1::TIER_RAM;
+using payload::storage::DiskArrowStore;
+using payload::storage::RamArrowStore;
+
+struct Scratch {
+  std::string           prefix;
+  std::filesystem::path disk_root;
+
+  Scratch() {
+    static std::atomic<int> next{0};
+    prefix    = "pm-codec-test-" + std::to_string(getpid()) + "-" + std::to_string(next.fetch_add(1));
+    disk_root = std::filesystem::temp_directory_path() / prefix;
+  }
+
+  ~Scratch() {
+    std::error_code ec;
+    std::filesystem::remove_all(disk_root, ec);
+    for (std::filesystem::directory_iterator it("/dev/shm", ec); !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+      const auto file = it->path().filename().string();
+      if (file.rfind(prefix + "-", 0) == 0) {
+        shm_unlink(("/" + file).c_str());
+      }
+    }
+  }
+};
+
+// Compressible: short runs of a slowly changing byte.
+std::vector<uint8_t> Pattern(uint64_t size) {
+  std::vector<uint8_t> bytes(size);
+  for (uint64_t i = 0; i < size; ++i) {
+    bytes[i] = static_cast<uint8_t>((i / 64) * 7 + (i % 3));
+  }
+  return bytes;
+}
+
+std::shared_ptr<arrow::Buffer> PatternBuffer(uint64_t size) {
+  const auto bytes = Pattern(size);
+  return arrow::Buffer::FromString(std::string(bytes.begin(), bytes.end()));
+}
+
+std::vector<uint8_t> FileBytes(const std::filesystem::path& path) {
+  std::ifstream in(path, std::ios::binary);
+  return std::vector<uint8_t>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+PayloadID NewId() {
+  return payload::util::ToProto(payload::util::GenerateUUID());
+}
+
+std::vector<PayloadCodec> AvailableCodecs() {
+  std::vector<PayloadCodec> codecs;
+  for (const auto type : {arrow::Compression::LZ4_FRAME, arrow::Compression::ZSTD, arrow::Compression::SNAPPY, arrow::Compression::GZIP,
+                          arrow::Compression::BROTLI}) {
+    if (arrow::util::Codec::IsAvailable(type)) codecs.push_back(payload::storage::ToPayloadCodec(type));
+  }
+  return codecs;
+}
+
+// RAM + DISK manager over a repository the test can inspect.
+struct Manager {
+  std::shared_ptr<RamArrowStore>                         ram;
+  std::shared_ptr<payload::db::memory::MemoryRepository> repository = std::make_shared<payload::db::memory::MemoryRepository>();
+  std::optional<PayloadManager>                          manager;
+
+  explicit Manager(const Scratch& scratch, payload::storage::DiskStoreOptions disk_options = {})
+      : ram(std::make_shared<RamArrowStore>(scratch.prefix)) {
+    payload::storage::StorageFactory::TierMap storage;
+    storage[TIER_RAM]  = ram;
+    storage[TIER_DISK] = std::make_shared<DiskArrowStore>(scratch.disk_root, std::move(disk_options));
+    manager.emplace(storage, std::make_shared<payload::lease::LeaseManager>(), repository);
+  }
+
+  PayloadID Put(const std::vector<uint8_t>& bytes, const payload::manager::core::v1::EvictionPolicy& policy = {}) {
+    const auto allocated = manager->Allocate(bytes.size(), TIER_RAM, 0, false, policy);
+    std::memcpy(ram->Read(allocated.payload_id())->mutable_data(), bytes.data(), bytes.size());
+    return manager->Commit(allocated.payload_id()).payload_id();
+  }
+
+  payload::db::model::PayloadRecord Record(const PayloadID& id) {
+    auto tx     = repository->Begin();
+    auto record = repository->GetPayload(*tx, payload::util::FromProto(id));
+    tx->Commit();
+    return *record;
+  }
+};
+
+} // namespace
+
+TEST(PayloadCodec, RoundTripsEveryAvailableCodec) {
+  const auto raw = PatternBuffer(uint64_t{1} << 20);
+  ASSERT_FALSE(AvailableCodecs().empty());
+  for (const auto codec : AvailableCodecs()) {
+    payload::storage::CodecStats encoded;
+    const auto                   frame = payload::storage::EncodePayload(*raw, codec, &encoded);
+    EXPECT_LT(frame->size(), raw->size()) << payload::storage::CodecName(codec);
+    EXPECT_EQ(encoded.raw_bytes, static_cast<uint64_t>(raw->size()));
+    EXPECT_EQ(encoded.stored_bytes, static_cast<uint64_t>(frame->size()));
+    EXPECT_EQ(payload::storage::DecodedSize(*frame), static_cast<uint64_t>(raw->size()));
+    EXPECT_TRUE(payload::storage::DecodePayload(*frame, codec)->Equals(*raw)) << payload::storage::CodecName(codec);
+  }
+}
+
+TEST(PayloadCodec, RejectsCorruptFramesAndUnsupportedCodecs) {
+  const auto codec = AvailableCodecs().front();
+  const auto frame = payload::storage::EncodePayload(*PatternBuffer(4096), codec);
+
+  EXPECT_THROW(payload::storage::DecodePayload(*arrow::SliceBuffer(frame, 0, 4), codec), std::runtime_error);
+  std::vector<uint8_t> small(100);
+  EXPECT_THROW(payload::storage::DecodePayload(*frame, codec, small.data(), small.size()), std::runtime_error);
+  EXPECT_THROW(payload::storage::ToPayloadCodec(arrow::Compression::LZO), std::runtime_error);
+  EXPECT_EQ(payload::storage::ToPayloadCodec(arrow::Compression::UNCOMPRESSED), payload::manager::v1::PAYLOAD_CODEC_NONE);
+}
+
+TEST(PayloadCodec, TranscodesStreamInChunks) {
+  Scratch        scratch;
+  RamArrowStore  ram(scratch.prefix);
+  DiskArrowStore disk(scratch.disk_root);
+  const auto     raw = PatternBuffer((uint64_t{1} << 20) + 123);
+
+  payload::storage::TransferOptions options;
+  options.chunk_bytes   = 4096; // hundreds of chunks through the codec
+  const auto expect_crc = payload::storage::Crc32cOf(raw->data(), static_cast<uint64_t>(raw->size()));
+  const auto none       = payload::manager::v1::PAYLOAD_CODEC_NONE;
+  const auto source     = NewId();
+  std::memcpy(ram.Allocate(source, static_cast<uint64_t>(raw->size()))->mutable_data(), raw->data(), static_cast<size_t>(raw->size()));
+
+  for (const auto codec : AvailableCodecs()) {
+    SCOPED_TRACE(std::string(payload::storage::CodecName(codec)));
+    // RAM → DISK: encode; the frame decodes with the one-shot decoder.
+    const auto frame_id = NewId();
+    auto       spilled  = payload::storage::TranscodePayload(ram, source, disk, frame_id, false, none, codec, options);
+    const auto frame    = disk.Read(frame_id);
+    EXPECT_EQ(spilled.stored_bytes, static_cast<uint64_t>(frame->size()));
+    EXPECT_EQ(spilled.encode.raw_bytes, static_cast<uint64_t>(raw->size()));
+    EXPECT_EQ(spilled.checksum, expect_crc);
+    EXPECT_TRUE(payload::storage::DecodePayload(*frame, codec)->Equals(*raw));
+
+    // DISK → RAM: decode straight into the destination mapping.
+    const auto promoted = NewId();
+    auto       restored = payload::storage::TranscodePayload(disk, frame_id, ram, promoted, false, codec, none, options);
+    EXPECT_EQ(restored.checksum, expect_crc);
+    EXPECT_EQ(restored.decode.raw_bytes, static_cast<uint64_t>(raw->size()));
+    EXPECT_TRUE(ram.Read(promoted)->Equals(*raw));
+
+    // DISK → DISK raw: decode through Append.
+    const auto unpacked = NewId();
+    payload::storage::TranscodePayload(disk, frame_id, disk, unpacked, false, codec, none, options);
+    EXPECT_TRUE(disk.Read(unpacked)->Equals(*raw));
+
+    // Recode into every other codec without materializing the payload.
+    for (const auto other : AvailableCodecs()) {
+      if (other == codec) continue;
+      const auto recoded = NewId();
+      auto       result  = payload::storage::TranscodePayload(disk, frame_id, disk, recoded, false, codec, other, options);
+      EXPECT_EQ(result.checksum, expect_crc);
+      EXPECT_TRUE(payload::storage::DecodePayload(*disk.Read(recoded), other)->Equals(*raw)) << payload::storage::CodecName(other);
+    }
+  }
+}
+
+TEST(PayloadCodec, SpillCompressesAndPromotionRestores) {
+  Scratch    scratch;
+  Manager    m(scratch);
+  const auto codec = AvailableCodecs().front();
+  m.manager->SetTierCodec(TIER_DISK, codec);
+
+  const uint64_t size    = uint64_t{2} << 20;
+  const auto     pattern = Pattern(size);
+  const auto     id      = m.Put(pattern);
+  m.manager->ExecuteSpill(id, TIER_DISK, /*fsync=*/false);
+
+  const auto record = m.Record(id);
+  EXPECT_EQ(record.stored_codec, static_cast<int>(codec));
+  EXPECT_GT(record.stored_size_bytes, 0u);
+  EXPECT_LT(record.stored_size_bytes, size);
+  EXPECT_EQ(record.size_bytes, size);
+
+  const auto uuid    = payload::util::ToString(payload::util::FromProto(id));
+  const auto on_disk = FileBytes(payload::storage::common::PayloadPath(scratch.disk_root, uuid));
+  const auto spilled = m.manager->ResolveSnapshot(id);
+  EXPECT_EQ(on_disk.size(), record.stored_size_bytes);
+  EXPECT_EQ(spilled.disk().codec(), codec);
+  EXPECT_EQ(spilled.disk().length_bytes(), record.stored_size_bytes);
+
+  std::ifstream                                         sidecar_in(payload::storage::common::SidecarPath(scratch.disk_root, uuid));
+  const std::string                                     json((std::istreambuf_iterator<char>(sidecar_in)), std::istreambuf_iterator<char>());
+  payload::manager::catalog::v1::PayloadArchiveMetadata sidecar;
+  ASSERT_TRUE(google::protobuf::util::JsonStringToMessage(json, &sidecar).ok());
+  EXPECT_EQ(sidecar.compression().type(), payload::storage::ToArchiveCompression(codec));
+  EXPECT_EQ(sidecar.compression().uncompressed_size_bytes(), size);
+  EXPECT_EQ(sidecar.compression().compressed_size_bytes(), record.stored_size_bytes);
+
+  const auto promoted = m.manager->Promote(id, TIER_RAM);
+  EXPECT_EQ(promoted.tier(), TIER_RAM);
+  const auto in_ram = m.ram->Read(id);
+  ASSERT_EQ(static_cast<uint64_t>(in_ram->size()), size);
+  EXPECT_EQ(std::memcmp(in_ram->data(), pattern.data(), size), 0);
+  EXPECT_EQ(m.Record(id).stored_codec, 0);
+  EXPECT_EQ(m.Record(id).stored_size_bytes, 0u);
+}
+
+TEST(PayloadCodec, PolicyCodecOverridesTierCodec) {
+  Scratch scratch;
+  Manager m(scratch);
+  m.manager->SetTierCodec(TIER_DISK, AvailableCodecs().front());
+
+  payload::manager::core::v1::EvictionPolicy policy;
+  policy.set_spill_codec(payload::manager::v1::PAYLOAD_CODEC_NONE);
+  const auto pattern = Pattern(uint64_t{1} << 20);
+  const auto id      = m.Put(pattern, policy);
+  m.manager->ExecuteSpill(id, TIER_DISK, /*fsync=*/false);
+
+  EXPECT_EQ(m.Record(id).stored_codec, 0);
+  EXPECT_EQ(FileBytes(payload::storage::common::PayloadPath(scratch.disk_root, payload::util::ToString(payload::util::FromProto(id)))), pattern);
+  EXPECT_EQ(m.manager->ResolveSnapshot(id).disk().length_bytes(), pattern.size());
+}
+
+TEST(PayloadCodec, RestoresRecordsFromManifestsIntoAnEmptyRepository) {
+  Scratch                            scratch;
+  payload::storage::DiskStoreOptions options;
+  options.sidecars.format = payload::storage::common::SidecarFormat::kManifest;
+  const auto codec        = AvailableCodecs().front();
+  const auto pattern      = Pattern(uint64_t{1} << 20);
+
+  PayloadID                         compressed, raw, in_ram;
+  payload::db::model::PayloadRecord spilled;
+  {
+    Manager before(scratch, options);
+    before.manager->SetTierCodec(TIER_DISK, codec);
+    compressed = before.Put(pattern);
+    before.manager->ExecuteSpill(compressed, TIER_DISK, /*fsync=*/false);
+    payload::manager::core::v1::EvictionPolicy policy;
+    policy.set_spill_codec(payload::manager::v1::PAYLOAD_CODEC_NONE);
+    raw = before.Put(pattern, policy);
+    before.manager->ExecuteSpill(raw, TIER_DISK, /*fsync=*/false);
+    in_ram  = before.Put(pattern);
+    spilled = before.Record(compressed);
+    ASSERT_TRUE(spilled.has_checksum);
+  } // the manifest is flushed as the DISK tier goes away
+
+  Manager after(scratch, options);
+  EXPECT_EQ(after.manager->RestoreFromManifests(), 2u);
+  EXPECT_EQ(after.manager->RestoreFromManifests(), 0u) << "only an empty repository is rebuilt";
+  after.manager->HydrateCaches();
+
+  const auto restored = after.Record(compressed);
+  EXPECT_EQ(restored.tier, TIER_DISK);
+  EXPECT_EQ(restored.state, payload::manager::v1::PAYLOAD_STATE_DURABLE);
+  EXPECT_EQ(restored.size_bytes, pattern.size());
+  EXPECT_EQ(restored.stored_codec, static_cast<int>(codec));
+  EXPECT_EQ(restored.stored_size_bytes, spilled.stored_size_bytes);
+  EXPECT_TRUE(restored.has_checksum);
+  EXPECT_EQ(restored.checksum_crc32c, spilled.checksum_crc32c);
+  EXPECT_EQ(after.Record(raw).stored_codec, 0);
+  EXPECT_EQ(after.Record(raw).size_bytes, pattern.size());
+  auto tx = after.repository->Begin();
+  EXPECT_FALSE(after.repository->GetPayload(*tx, payload::util::FromProto(in_ram)).has_value());
+  tx->Commit();
+
+  after.manager->Promote(compressed, TIER_RAM);
+  const auto bytes = after.ram->Read(compressed);
+  ASSERT_EQ(static_cast<uint64_t>(bytes->size()), pattern.size());
+  EXPECT_EQ(std::memcmp(bytes->data(), pattern.data(), pattern.size()), 0);
+}
@@ -209,6 +209,42 @@ TEST(PayloadManagerConcurrency, DeleteAndResolveConcurrentlyNoUB) {
   EXPECT_EQ(resolve_success.load() + resolve_notfound.load(), kReaders);
 }
 
+// ---------------------------------------------------------------------------
+// Cache-miss resolves racing a Delete must not resurrect the deleted
+// payload's snapshot: once Delete returns, ResolveSnapshot throws NotFound.
+// ---------------------------------------------------------------------------
+TEST(PayloadManagerConcurrency, ColdResolveDoesNotResurrectDeletedSnapshot) {
+  constexpr int kRounds  = 50;
+  constexpr int kReaders = 4;
+
+  for (int round = 0; round < kRounds; ++round) {
+    Env  env;
+    auto id = env.manager->Commit(env.manager->Allocate(64, TIER_RAM).payload_id()).payload_id();
+
+    // A fresh manager over the same repository starts with an empty snapshot
+    // cache, so every resolve below goes through the repository miss path.
+    payload::storage::StorageFactory::TierMap s;
+    s[TIER_RAM]  = env.ram;
+    s[TIER_DISK] = env.disk;
+    auto cold    = std::make_shared<PayloadManager>(s, env.lease_mgr, env.repo);
+
+    std::vector<std::thread> threads;
+    threads.reserve(kReaders + 1);
+    for (int i = 0; i < kReaders; ++i) {
+      threads.emplace_back([&] {
+        try {
+          (void)cold->ResolveSnapshot(id);
+        } catch (const payload::util::NotFound&) {
+        }
+      });
+    }
+    threads.emplace_back([&] { cold->Delete(id, true); });
+    for (auto& t : threads) t.join();
+
+    EXPECT_THROW((void)cold->ResolveSnapshot(id), payload::util::NotFound) << "round " << round;
+  }
+}
+
 // ---------------------------------------------------------------------------
 // Concurrent Allocate from N threads — every successful allocation must
 // produce a unique ID.  Threads that hit an OCC conflict are skipped;
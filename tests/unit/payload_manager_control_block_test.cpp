@@ -0,0 +1,306 @@
+/*
+  PayloadControlBlock / PayloadControlTable tests.
+
+  Covers the compact per-payload state that replaced PayloadManager's side
+  tables: the packed lock word, block reclamation in the control table (a
+  reused block starts clean), the table's resumable sweep hand, and the
+  sampled LRU victim selection PayloadManager serves from control blocks.
+*/
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "internal/core/payload_control_block.hpp"
+#include "internal/core/payload_manager.hpp"
+#include "internal/db/memory/memory_repository.hpp"
+#include "internal/lease/lease_manager.hpp"
+#include "internal/storage/storage_backend.hpp"
+#include "internal/util/uuid.hpp"
+#include "payload/manager/v1.hpp"
+
+namespace {
+
+using payload::core::PayloadControlBlock;
+using payload::core::PayloadControlTable;
+using payload::core::PayloadLockWord;
+using payload::core::PayloadManager;
+using payload::lease::LeaseManager;
+using payload::manager::v1::TIER_DISK;
+using payload::manager::v1::TIER_RAM;
+
+class SimpleBackend final : public payload::storage::StorageBackend {
+ public:
+  explicit SimpleBackend(payload::manager::v1::Tier tier) : tier_(tier) {
+  }
+
+  std::shared_ptr<arrow::Buffer> Allocate(const payload::manager::v1::PayloadID& id, uint64_t size) override {
+    auto r = arrow::AllocateBuffer(size);
+    if (!r.ok()) throw std::runtime_error("alloc");
+    std::shared_ptr<arrow::Buffer> buf(std::move(*r));
+    if (size > 0) std::memset(buf->mutable_data(), 0, size);
+    std::lock_guard lock(mu_);
+    bufs_[id.value()] = buf;
+    return buf;
+  }
+
+  std::shared_ptr<arrow::Buffer> Read(const payload::manager::v1::PayloadID& id) override {
+    std::lock_guard lock(mu_);
+    auto            it = bufs_.find(id.value());
+    if (it == bufs_.end()) throw std::runtime_error("not found: " + id.value());
+    return it->second;
+  }
+
+  void Write(const payload::manager::v1::PayloadID& id, const std::shared_ptr<arrow::Buffer>& b, bool) override {
+    std::lock_guard lock(mu_);
+    bufs_[id.value()] = b;
+  }
+
+  void Remove(const payload::manager::v1::PayloadID& id) override {
+    std::lock_guard lock(mu_);
+    bufs_.erase(id.value());
+  }
+
+  payload::manager::v1::Tier TierType() const override {
+    return tier_;
+  }
+
+ private:
+  payload::manager::v1::Tier                                      tier_;
+  mutable std::mutex                                              mu_;
+  std::unordered_map<std::string, std::shared_ptr<arrow::Buffer>> bufs_;
+};
+
+struct Env {
+  std::shared_ptr<payload::lease::LeaseManager>          lease_mgr = std::make_shared<LeaseManager>();
+  std::shared_ptr<payload::db::memory::MemoryRepository> repo      = std::make_shared<payload::db::memory::MemoryRepository>();
+  std::shared_ptr<SimpleBackend>                         ram       = std::make_shared<SimpleBackend>(TIER_RAM);
+  std::shared_ptr<SimpleBackend>                         disk      = std::make_shared<SimpleBackend>(TIER_DISK);
+  std::shared_ptr<PayloadManager>                        manager{[&] {
+    payload::storage::StorageFactory::TierMap s;
+    s[TIER_RAM]  = ram;
+    s[TIER_DISK] = disk;
+    return std::make_shared<PayloadManager>(s, lease_mgr, repo);
+  }()};
+
+  payload::manager::v1::PayloadID MakeRam() {
+    return manager->Commit(manager->Allocate(64, TIER_RAM).payload_id()).payload_id();
+  }
+};
+
+} // namespace
+
+TEST(PayloadControlBlock, FitsOneCacheLine) {
+  EXPECT_EQ(sizeof(PayloadControlBlock), 64u);
+  EXPECT_EQ(alignof(PayloadControlBlock), 64u);
+}
+
+TEST(PayloadLockWord, ExclusiveLockSerializesWriters) {
+  PayloadLockWord lock;
+  int             counter = 0;
+
+  constexpr int            kThreads    = 4;
+  constexpr int            kIterations = 20'000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < kIterations; ++i) {
+        std::unique_lock<PayloadLockWord> guard(lock);
+        ++counter;
+      }
+    });
+  }
+  for (auto& th : threads) th.join();
+  EXPECT_EQ(counter, kThreads * kIterations);
+}
+
+TEST(PayloadLockWord, SharedHoldersExcludeWriter) {
+  PayloadLockWord lock;
+  lock.lock_shared();
+  EXPECT_TRUE(lock.try_lock_shared());
+  EXPECT_FALSE(lock.try_lock());
+  lock.unlock_shared();
+  lock.unlock_shared();
+
+  ASSERT_TRUE(lock.try_lock());
+  EXPECT_FALSE(lock.try_lock_shared());
+  lock.unlock();
+  EXPECT_TRUE(lock.try_lock_shared());
+  lock.unlock_shared();
+}
+
+TEST(PayloadControlTable, BlockWithoutSnapshotIsReclaimedWhenLastRefDrops) {
+  PayloadControlTable table;
+  const auto          key = payload::util::GenerateUUID();
+  {
+    auto ref = table.Acquire(key);
+    EXPECT_EQ(table.Size(), 1u);
+  }
+  EXPECT_EQ(table.Size(), 0u);
+
+  table.Update(key, /*create=*/true, [](PayloadControlBlock& block) { block.flags |= PayloadControlBlock::kHasSnapshot; });
+  EXPECT_EQ(table.Size(), 1u);
+
+  table.Update(key, /*create=*/false, [](PayloadControlBlock& block) { block.flags = 0; });
+  EXPECT_EQ(table.Size(), 0u);
+  EXPECT_FALSE(table.Read(key, [](const PayloadControlBlock&) {}));
+}
+
+TEST(PayloadControlTable, ReclaimedBlockComesBackClean) {
+  PayloadControlTable table;
+  const auto          key = payload::util::GenerateUUID();
+  table.Update(key, /*create=*/true, [](PayloadControlBlock& block) {
+    block.flags |= PayloadControlBlock::kHasSnapshot;
+    block.tier         = 2;
+    block.spill_target = 3;
+    block.codec        = 4;
+  });
+  table.Update(key, /*create=*/false, [](PayloadControlBlock& block) { block.flags = 0; });
+  ASSERT_EQ(table.Size(), 0u);
+
+  // The freed slot is handed out again for the next block in its shard.
+  auto ref = table.Acquire(key);
+  EXPECT_TRUE(table.Read(key, [](const PayloadControlBlock& block) {
+    EXPECT_EQ(block.tier, 0);
+    EXPECT_EQ(block.spill_target, 0);
+    EXPECT_EQ(block.codec, 0);
+  }));
+}
+
+TEST(PayloadControlTable, TombstoneKeepsBlockAlive) {
+  PayloadControlTable table;
+  const auto          key = payload::util::GenerateUUID();
+
+  table.Update(key, /*create=*/true, [](PayloadControlBlock& block) { ++block.tombstones; });
+  EXPECT_EQ(table.Size(), 1u);
+  table.Update(key, /*create=*/false, [](PayloadControlBlock& block) { --block.tombstones; });
+  EXPECT_EQ(table.Size(), 0u);
+}
+
+TEST(PayloadControlTable, SweepResumesWhereItStopped) {
+  PayloadControlTable table;
+  for (int i = 0; i < 100; ++i) {
+    table.Update(payload::util::GenerateUUID(), /*create=*/true, [](PayloadControlBlock& block) { block.flags = PayloadControlBlock::kHasSnapshot; });
+  }
+
+  // Two partial sweeps see different blocks.
+  std::unordered_set<payload::util::UUID> first;
+  std::unordered_set<payload::util::UUID> second;
+  const auto                              take = [](std::unordered_set<payload::util::UUID>& seen) {
+    return [&seen](const PayloadControlBlock& block) {
+      if (block.flags != 0) seen.insert(block.id);
+      return seen.size() < 10;
+    };
+  };
+  table.Sweep(take(first));
+  table.Sweep(take(second));
+  ASSERT_EQ(first.size(), 10u);
+  ASSERT_EQ(second.size(), 10u);
+  for (const auto& key : second) {
+    EXPECT_FALSE(first.contains(key));
+  }
+
+  // A sweep that never stops visits every slot once and every block once.
+  std::size_t live    = 0;
+  const auto  visited = table.Sweep([&](const PayloadControlBlock& block) {
+    live += block.flags != 0 ? 1 : 0;
+    return true;
+  });
+  EXPECT_EQ(visited, table.Capacity());
+  EXPECT_EQ(live, 100u);
+}
+
+TEST(PayloadManagerControlBlock, LeastRecentlyUsedFollowsLeaseAccess) {
+  Env        env;
+  const auto first  = env.MakeRam();
+  const auto second = env.MakeRam();
+
+  auto victim = env.manager->LeastRecentlyUsed(TIER_RAM);
+  ASSERT_TRUE(victim.has_value());
+  EXPECT_EQ(victim->value(), first.value());
+
+  const auto lease = env.manager->AcquireReadLease(first, TIER_RAM, 1'000);
+  env.manager->ReleaseLease(lease.lease_id());
+
+  victim = env.manager->LeastRecentlyUsed(TIER_RAM);
+  ASSERT_TRUE(victim.has_value());
+  EXPECT_EQ(victim->value(), second.value());
+
+  EXPECT_FALSE(env.manager->LeastRecentlyUsed(TIER_DISK).has_value());
+}
+
+TEST(PayloadManagerControlBlock, LeastRecentlyUsedSkipsExemptPinnedAndUncommitted) {
+  Env  env;
+  auto exempt = env.manager->Commit(env.manager->Allocate(64, TIER_RAM, 0, /*no_evict=*/true).payload_id()).payload_id();
+  auto pinned = env.MakeRam();
+  env.manager->Pin(pinned, 0);
+  (void)env.manager->Allocate(64, TIER_RAM); // still ALLOCATED
+  auto candidate = env.MakeRam();
+
+  auto victim = env.manager->LeastRecentlyUsed(TIER_RAM);
+  ASSERT_TRUE(victim.has_value());
+  EXPECT_EQ(victim->value(), candidate.value());
+
+  // The predicate can veto candidates; nothing else is eligible.
+  EXPECT_FALSE(env.manager->LeastRecentlyUsed(TIER_RAM, [](const payload::manager::v1::PayloadID&) { return false; }).has_value());
+
+  env.manager->Unpin(pinned);
+  victim = env.manager->LeastRecentlyUsed(TIER_RAM, [&](const payload::manager::v1::PayloadID& id) { return id.value() != candidate.value(); });
+  ASSERT_TRUE(victim.has_value());
+  EXPECT_EQ(victim->value(), pinned.value());
+  EXPECT_TRUE(env.manager->IsEvictionExempt(exempt));
+}
+
+TEST(PayloadManagerControlBlock, LeastRecentlyUsedSweepsPastRejectedSamples) {
+  Env                                          env;
+  std::vector<payload::manager::v1::PayloadID> ids;
+  for (int i = 0; i < 200; ++i) {
+    ids.push_back(env.MakeRam());
+  }
+
+  // Far more candidates than one sample; the only acceptable one is found anyway.
+  const auto& wanted = ids[137];
+  const auto  only   = [&](const payload::manager::v1::PayloadID& id) { return id.value() == wanted.value(); };
+  const auto  victim = env.manager->LeastRecentlyUsed(TIER_RAM, only);
+  ASSERT_TRUE(victim.has_value());
+  EXPECT_EQ(victim->value(), wanted.value());
+
+  std::size_t offered = 0;
+  EXPECT_FALSE(env.manager
+                   ->LeastRecentlyUsed(TIER_RAM,
+                                       [&](const payload::manager::v1::PayloadID&) {
+                                         ++offered;
+                                         return false;
+                                       })
+                   .has_value());
+  EXPECT_GE(offered, ids.size());
+}
+
+TEST(PayloadManagerControlBlock, DescriptorIsRebuiltFromControlBlock) {
+  Env        env;
+  const auto allocated = env.manager->Allocate(64, TIER_RAM);
+  const auto committed = env.manager->Commit(allocated.payload_id());
+  const auto resolved  = env.manager->ResolveSnapshot(committed.payload_id());
+
+  EXPECT_EQ(resolved.tier(), committed.tier());
+  EXPECT_EQ(resolved.state(), committed.state());
+  EXPECT_EQ(resolved.version(), committed.version());
+  ASSERT_TRUE(resolved.has_ram());
+  EXPECT_EQ(resolved.ram().length_bytes(), committed.ram().length_bytes());
+  EXPECT_EQ(resolved.ram().shm_name(), committed.ram().shm_name());
+
+  env.manager->ExecuteSpill(committed.payload_id(), TIER_DISK, false);
+  const auto spilled = env.manager->ResolveSnapshot(committed.payload_id());
+  ASSERT_TRUE(spilled.has_disk());
+  EXPECT_EQ(spilled.disk().path(), payload::util::ToString(payload::util::FromProto(committed.payload_id())) + ".bin");
+  EXPECT_EQ(spilled.disk().length_bytes(), 64u);
+}
@@ -110,6 +110,10 @@ class LoggingRepository final : public payload::db::Repository {
   std::vector<payload::db::model::PayloadRecord> ListExpiredPayloads(payload::db::Transaction& t, uint64_t now_ms) override {
     return inner_->ListExpiredPayloads(Unwrap(t), now_ms);
   }
+  std::optional<payload::db::model::PayloadRecord> FindContentReference(payload::db::Transaction& t, const std::string& content_hash,
+                                                                         payload::manager::v1::Tier tier) override {
+    return inner_->FindContentReference(Unwrap(t), content_hash, tier);
+  }
   payload::db::Result UpsertMetadata(payload::db::Transaction& t, const payload::db::model::MetadataRecord& r) override {
     return inner_->UpsertMetadata(Unwrap(t), r);
   }
@@ -188,6 +192,15 @@ class LoggingRepository final : public payload::db::Repository {
     bool IsCommitted() const override {
       return inner_->IsCommitted();
     }
+    void Savepoint() override {
+      inner_->Savepoint();
+    }
+    void RollbackToSavepoint() override {
+      inner_->RollbackToSavepoint();
+    }
+    void ReleaseSavepoint() override {
+      inner_->ReleaseSavepoint();
+    }
 
     payload::db::Transaction& Inner() {
       return *inner_;
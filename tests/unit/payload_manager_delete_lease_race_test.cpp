@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 
 #include <atomic>
+#include <chrono>
 #include <memory>
 #include <stdexcept>
 #include <thread>
@@ -9,6 +10,7 @@
 #include "internal/db/memory/memory_repository.hpp"
 #include "internal/lease/lease_manager.hpp"
 #include "internal/storage/storage_backend.hpp"
+#include "internal/util/errors.hpp"
 
 namespace {
 
@@ -107,3 +109,37 @@ TEST(DeleteLeaseRace, AcquireAndDeleteNeverProducesStaleDescriptor) {
     }
   }
 }
+
+// A force Delete blocked in WaitUntilNoLeases on one payload must not stall
+// lease acquisition on unrelated payloads, while new leases on the payload
+// being deleted are refused.
+TEST(DeleteLeaseRace, ForceDeleteDrainOnlyBlocksItsOwnPayload) {
+  auto lease_mgr = std::make_shared<LeaseManager>(20'000, 120'000);
+  auto manager   = MakeManager(lease_mgr);
+
+  const auto victim    = manager.Commit(manager.Allocate(64, TIER_RAM).payload_id()).payload_id();
+  const auto bystander = manager.Commit(manager.Allocate(64, TIER_RAM).payload_id()).payload_id();
+
+  const auto        held = manager.AcquireReadLease(victim, TIER_RAM, 5'000);
+  std::atomic<bool> delete_done{false};
+  std::thread       t_delete([&] {
+    manager.Delete(victim, /*force=*/true);
+    delete_done.store(true);
+  });
+
+  // Wait for the delete to start draining the held lease.
+  while (lease_mgr->HasActiveLeases(victim)) std::this_thread::yield();
+  ASSERT_FALSE(delete_done.load());
+
+  const auto start = std::chrono::steady_clock::now();
+  const auto lease = manager.AcquireReadLease(bystander, TIER_RAM, 1'000);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(500));
+  manager.ReleaseLease(lease.lease_id());
+
+  EXPECT_THROW(manager.AcquireReadLease(victim, TIER_RAM, 1'000), payload::util::NotFound);
+  EXPECT_FALSE(delete_done.load());
+
+  manager.ReleaseLease(held.lease_id());
+  t_delete.join();
+  EXPECT_THROW(manager.ResolveSnapshot(victim), payload::util::NotFound);
+}
@@ -0,0 +1,309 @@
+/*
+  Chunked tier-to-tier transfer tests.
+
+  Covers CopyPayload's pipelined path with in-memory fake backends (chunk
+  boundaries, bounded read-ahead, chunks sized to the reader's preference,
+  failures on either side leaving nothing committed), the fallback to Read + Write, reads landing directly in a
+  RAM segment, and a DISK → RAM promotion through PayloadManager.
+*/
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "internal/core/payload_manager.hpp"
+#include "internal/db/memory/memory_repository.hpp"
+#include "internal/lease/lease_manager.hpp"
+#include "internal/storage/disk/disk_arrow_store.hpp"
+#include "internal/storage/payload_transfer.hpp"
+#include "internal/storage/ram/ram_arrow_store.hpp"
+#include "internal/util/uuid.hpp"
+#include "payload/manager/v1.hpp"
+
+namespace {
+
+using payload::core::PayloadManager;
+using payload::manager::v1::PayloadID;
+using payload::manager::v1::TIER_DISK;
+using payload::manager::v1::TIER_RAM;
+using payload::storage::CopyPayload;
+using payload::storage::PayloadReader;
+using payload::storage::PayloadWriter;
+using payload::storage::StorageBackend;
+using payload::storage::TransferOptions;
+
+std::vector<uint8_t> Pattern(uint64_t size) {
+  std::vector<uint8_t> bytes(size);
+  for (uint64_t i = 0; i < size; ++i) {
+    bytes[i] = static_cast<uint8_t>(i * 131 + 7);
+  }
+  return bytes;
+}
+
+PayloadID NewId() {
+  return payload::util::ToProto(payload::util::GenerateUUID());
+}
+
+// Shared between a FakeTier and the readers / writers it hands out.
+struct Counters {
+  std::atomic<int>      chunks_read{0};
+  std::atomic<int>      chunks_written{0};
+  std::atomic<int>      max_ahead{0}; // chunks read but not yet written
+  std::atomic<uint64_t> max_chunk{0};
+  int                   fail_read_at  = -1; // chunk index that throws
+  int                   fail_write_at = -1;
+  bool                  streaming     = true; // offer reader / writer
+  std::atomic<int>      whole_reads{0};
+  const uint8_t*        first_out = nullptr; // destination of chunk 0
+  uint64_t              preferred_read_bytes = 0;
+};
+
+/*
+  In-memory tier. Readers record how far they run ahead of the writer;
+  writers stage into a side buffer that only replaces the stored bytes on
+  Commit.
+*/
+class FakeTier final : public StorageBackend {
+ public:
+  explicit FakeTier(Counters& counters) : counters_(counters) {
+  }
+
+  std::shared_ptr<arrow::Buffer> Allocate(const PayloadID&, uint64_t) override {
+    throw std::runtime_error("not used");
+  }
+
+  std::shared_ptr<arrow::Buffer> Read(const PayloadID&) override {
+    counters_.whole_reads.fetch_add(1);
+    return std::make_shared<arrow::Buffer>(bytes_.data(), static_cast<int64_t>(bytes_.size()));
+  }
+
+  void Write(const PayloadID&, const std::shared_ptr<arrow::Buffer>& buffer, bool) override {
+    bytes_.assign(buffer->data(), buffer->data() + buffer->size());
+  }
+
+  std::unique_ptr<PayloadReader> OpenReader(const PayloadID&) override;
+  std::unique_ptr<PayloadWriter> OpenWriter(const PayloadID&, uint64_t, bool) override;
+
+  void Remove(const PayloadID&) override {
+    bytes_.clear();
+  }
+
+  payload::manager::v1::Tier TierType() const override {
+    return TIER_DISK;
+  }
+
+  std::vector<uint8_t> bytes_;
+  Counters&            counters_;
+};
+
+class FakeReader final : public PayloadReader {
+ public:
+  explicit FakeReader(FakeTier& tier) : tier_(tier) {
+  }
+
+  uint64_t Size() const override {
+    return tier_.bytes_.size();
+  }
+
+  void ReadAt(uint64_t offset, uint8_t* out, uint64_t length) override {
+    auto&     c     = tier_.counters_;
+    const int index = c.chunks_read.fetch_add(1);
+    if (index == c.fail_read_at) throw std::runtime_error("injected read failure");
+    if (index == 0) c.first_out = out;
+    std::memcpy(out, tier_.bytes_.data() + offset, length);
+
+    const int ahead = index + 1 - c.chunks_written.load();
+    for (int seen = c.max_ahead.load(); ahead > seen && !c.max_ahead.compare_exchange_weak(seen, ahead);) {
+    }
+  }
+
+  uint64_t PreferredReadBytes() const override {
+    return tier_.counters_.preferred_read_bytes;
+  }
+
+ private:
+  FakeTier& tier_;
+};
+
+class FakeWriter final : public PayloadWriter {
+ public:
+  explicit FakeWriter(FakeTier& tier) : tier_(tier) {
+  }
+
+  void Append(const uint8_t* data, uint64_t length) override {
+    auto&     c     = tier_.counters_;
+    const int index = c.chunks_written.load();
+    if (index == c.fail_write_at) throw std::runtime_error("injected write failure");
+    // Slow consumer, so an unbounded reader would race ahead.
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    staged_.insert(staged_.end(), data, data + length);
+    for (uint64_t seen = c.max_chunk.load(); length > seen && !c.max_chunk.compare_exchange_weak(seen, length);) {
+    }
+    c.chunks_written.fetch_add(1);
+  }
+
+  void Commit() override {
+    tier_.bytes_ = std::move(staged_);
+  }
+
+ private:
+  FakeTier&            tier_;
+  std::vector<uint8_t> staged_;
+};
+
+std::unique_ptr<PayloadReader> FakeTier::OpenReader(const PayloadID&) {
+  return counters_.streaming ? std::make_unique<FakeReader>(*this) : nullptr;
+}
+
+std::unique_ptr<PayloadWriter> FakeTier::OpenWriter(const PayloadID&, uint64_t, bool) {
+  return counters_.streaming ? std::make_unique<FakeWriter>(*this) : nullptr;
+}
+
+TransferOptions Chunks(uint64_t chunk_bytes, uint32_t depth) {
+  TransferOptions options;
+  options.chunk_bytes = chunk_bytes;
+  options.depth       = depth;
+  return options;
+}
+
+} // namespace
+
+TEST(PayloadTransfer, PipelinedCopyHoldsAtMostDepthChunks) {
+  Counters counters;
+  FakeTier source(counters);
+  FakeTier target(counters);
+  source.bytes_ = Pattern(100 * 1000 + 17);
+
+  CopyPayload(source, target, NewId(), /*fsync=*/false, Chunks(1000, 3));
+
+  EXPECT_EQ(target.bytes_, source.bytes_);
+  EXPECT_EQ(counters.chunks_read.load(), 101);
+  EXPECT_EQ(counters.max_chunk.load(), 1000u);
+  EXPECT_EQ(counters.whole_reads.load(), 0);
+  // A chunk counts as written once Append returns, so the reader can be
+  // one chunk past depth while the writer is still inside Append.
+  EXPECT_LE(counters.max_ahead.load(), 3 + 1);
+  EXPECT_GE(counters.max_ahead.load(), 2) << "no read overlapped a write";
+}
+
+TEST(PayloadTransfer, ChunksGrowToTheReadersPreferredSize) {
+  Counters counters;
+  FakeTier source(counters);
+  FakeTier target(counters);
+  counters.preferred_read_bytes = 4000;
+  source.bytes_                 = Pattern(10 * 1000);
+
+  CopyPayload(source, target, NewId(), /*fsync=*/false, Chunks(1000, 2));
+
+  EXPECT_EQ(target.bytes_, source.bytes_);
+  EXPECT_EQ(counters.chunks_read.load(), 3);
+  EXPECT_EQ(counters.max_chunk.load(), 4000u);
+}
+
+TEST(PayloadTransfer, ReadFailureCommitsNothing) {
+  Counters counters;
+  counters.fail_read_at = 5;
+  FakeTier source(counters);
+  FakeTier target(counters);
+  source.bytes_ = Pattern(50 * 1000);
+  target.bytes_ = {1, 2, 3};
+
+  EXPECT_THROW(CopyPayload(source, target, NewId(), /*fsync=*/false, Chunks(1000, 2)), std::runtime_error);
+  EXPECT_EQ(target.bytes_, (std::vector<uint8_t>{1, 2, 3}));
+}
+
+TEST(PayloadTransfer, WriteFailureStopsTheReader) {
+  Counters counters;
+  counters.fail_write_at = 3;
+  FakeTier source(counters);
+  FakeTier target(counters);
+  source.bytes_ = Pattern(500 * 1000);
+
+  EXPECT_THROW(CopyPayload(source, target, NewId(), /*fsync=*/false, Chunks(1000, 2)), std::runtime_error);
+  EXPECT_TRUE(target.bytes_.empty());
+  EXPECT_LT(counters.chunks_read.load(), 10);
+}
+
+TEST(PayloadTransfer, FallsBackToWholeBufferWithoutStreaming) {
+  Counters source_counters;
+  Counters target_counters;
+  target_counters.streaming = false;
+  FakeTier source(source_counters);
+  FakeTier target(target_counters);
+  source.bytes_ = Pattern(10 * 1000);
+
+  CopyPayload(source, target, NewId(), /*fsync=*/false, Chunks(1000, 2));
+  EXPECT_EQ(target.bytes_, source.bytes_);
+  EXPECT_EQ(source_counters.whole_reads.load(), 1);
+}
+
+TEST(PayloadTransfer, ReadsLandInTheRamMapping) {
+  Counters                        counters;
+  FakeTier                        source(counters);
+  payload::storage::RamArrowStore ram("pm-transfer-inplace-" + std::to_string(getpid()));
+  source.bytes_ = Pattern((uint64_t{1} << 20) + 3);
+
+  const auto id = NewId();
+  CopyPayload(source, ram, id, /*fsync=*/false, Chunks(64 * 1024, 2));
+
+  auto placed = ram.Read(id);
+  ASSERT_EQ(static_cast<uint64_t>(placed->size()), source.bytes_.size());
+  EXPECT_EQ(std::memcmp(placed->data(), source.bytes_.data(), source.bytes_.size()), 0);
+  EXPECT_EQ(counters.first_out, placed->data()) << "chunk 0 was staged instead of read in place";
+  EXPECT_EQ(counters.chunks_read.load(), 17);
+  ram.Remove(id);
+}
+
+TEST(PayloadTransfer, FailedInPlaceReadRemovesTheRamPlacement) {
+  Counters                        counters;
+  FakeTier                        source(counters);
+  payload::storage::RamArrowStore ram("pm-transfer-inplace-fail-" + std::to_string(getpid()));
+  counters.fail_read_at = 2;
+  source.bytes_         = Pattern(uint64_t{1} << 20);
+
+  const auto id = NewId();
+  EXPECT_THROW(CopyPayload(source, ram, id, /*fsync=*/false, Chunks(64 * 1024, 2)), std::runtime_error);
+  EXPECT_THROW(ram.Read(id), std::runtime_error);
+}
+
+TEST(PayloadTransfer, PromoteStreamsDiskIntoShm) {
+  const std::string prefix    = "pm-transfer-promote-" + std::to_string(getpid());
+  const auto        disk_root = std::filesystem::temp_directory_path() / prefix;
+  auto              ram       = std::make_shared<payload::storage::RamArrowStore>(prefix);
+  auto              disk      = std::make_shared<payload::storage::DiskArrowStore>(disk_root);
+
+  payload::storage::StorageFactory::TierMap storage;
+  storage[TIER_RAM]  = ram;
+  storage[TIER_DISK] = disk;
+  PayloadManager manager(storage, std::make_shared<payload::lease::LeaseManager>(), std::make_shared<payload::db::memory::MemoryRepository>());
+  manager.SetTransferOptions(Chunks(64 * 1024, 2));
+
+  const uint64_t size      = (uint64_t{3} << 20) + 5;
+  const auto     pattern   = Pattern(size);
+  const auto     allocated = manager.Allocate(size, TIER_RAM);
+  std::memcpy(ram->Read(allocated.payload_id())->mutable_data(), pattern.data(), size);
+  const auto id = manager.Commit(allocated.payload_id()).payload_id();
+
+  manager.ExecuteSpill(id, TIER_DISK, /*fsync=*/false);
+  ASSERT_EQ(manager.ResolveSnapshot(id).tier(), TIER_DISK);
+
+  manager.Promote(id, TIER_RAM);
+  EXPECT_EQ(manager.ResolveSnapshot(id).tier(), TIER_RAM);
+  auto promoted = ram->Read(id);
+  ASSERT_EQ(static_cast<uint64_t>(promoted->size()), size);
+  EXPECT_EQ(std::memcmp(promoted->data(), pattern.data(), size), 0);
+  EXPECT_TRUE(std::filesystem::is_empty(disk_root));
+
+  manager.Delete(id, /*force=*/true);
+  std::error_code ec;
+  std::filesystem::remove_all(disk_root, ec);
+}
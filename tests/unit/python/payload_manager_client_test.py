@@ -384,6 +384,36 @@ class TestDiskBuffer(unittest.TestCase):
 
             mock_open.assert_called_once_with(path, os.O_RDONLY)
 
+    def test_open_readable_packed_disk_buffer(self):
+        client, _ = _make_client()
+
+        with tempfile.TemporaryDirectory() as tmp:
+            path = os.path.join(tmp, "0000000000000001.pack")
+            with open(path, "wb") as segment:
+                segment.write(b"x" * 5000 + b"packed payload" + b"y" * 100)
+            desc = _make_disk_descriptor(path=path, length_bytes=14, offset_bytes=5000)
+            mapped, buf = client._OpenReadableBuffer(desc)
+            try:
+                self.assertEqual(buf.to_pybytes(), b"packed payload")
+            finally:
+                del buf
+                mapped.close()
+
+    def test_compressed_disk_copy_raises(self):
+        client, _ = _make_client()
+        desc = _make_disk_descriptor(path="/nonexistent/payload.bin")
+        desc.disk.codec = types_pb2.PAYLOAD_CODEC_ZSTD
+        with patch("os.open") as mock_open:
+            with self.assertRaisesRegex(NotImplementedError, "promote to RAM"):
+                client._OpenReadableBuffer(desc)
+            with self.assertRaisesRegex(NotImplementedError, "promote to RAM"):
+                client._OpenMutableBuffer(desc)
+        mock_open.assert_not_called()
+
+        desc.tier = types_pb2.TIER_OBJECT
+        with self.assertRaises(NotImplementedError):
+            client._OpenReadableBuffer(desc)
+
     def test_unsupported_tier_raises(self):
         client, _ = _make_client()
         desc = placement_pb2.PayloadDescriptor(tier=types_pb2.TIER_OBJECT)
@@ -0,0 +1,147 @@
+/*
+  Kernel-side RAM → DISK transfer tests.
+
+  Covers RamArrowStore::TransferTo into DiskArrowStore for dedicated
+  segments and slab blocks, the false return that sends callers back to
+  Read + Write (kernel_copy off, or a target that is not file-backed), and
+  ExecuteSpill moving a payload between the real RAM and disk stores.
+*/
+
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "internal/core/payload_manager.hpp"
+#include "internal/db/memory/memory_repository.hpp"
+#include "internal/lease/lease_manager.hpp"
+#include "internal/storage/common/path_utils.hpp"
+#include "internal/storage/disk/disk_arrow_store.hpp"
+#include "internal/storage/ram/ram_arrow_store.hpp"
+#include "internal/util/uuid.hpp"
+#include "payload/manager/v1.hpp"
+
+namespace {
+
+using payload::core::PayloadManager;
+using payload::manager::v1::PayloadID;
+using payload::manager::v1::TIER_DISK;
+using payload::manager::v1::TIER_RAM;
+using payload::storage::DiskArrowStore;
+using payload::storage::DiskStoreOptions;
+using payload::storage::RamArrowStore;
+
+// Unique shm prefix and disk root per test; both are removed on exit.
+struct Scratch {
+  std::string           prefix;
+  std::filesystem::path disk_root;
+
+  Scratch() {
+    static std::atomic<int> next{0};
+    prefix    = "pm-transfer-test-" + std::to_string(getpid()) + "-" + std::to_string(next.fetch_add(1));
+    disk_root = std::filesystem::temp_directory_path() / prefix;
+  }
+
+  ~Scratch() {
+    std::error_code ec;
+    std::filesystem::remove_all(disk_root, ec);
+    for (std::filesystem::directory_iterator it("/dev/shm", ec); !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+      const auto file = it->path().filename().string();
+      if (file.rfind(prefix + "-", 0) == 0) {
+        shm_unlink(("/" + file).c_str());
+      }
+    }
+  }
+};
+
+PayloadID NewId() {
+  return payload::util::ToProto(payload::util::GenerateUUID());
+}
+
+std::vector<uint8_t> Pattern(uint64_t size) {
+  std::vector<uint8_t> bytes(size);
+  for (uint64_t i = 0; i < size; ++i) {
+    bytes[i] = static_cast<uint8_t>(i * 131 + 7);
+  }
+  return bytes;
+}
+
+std::vector<uint8_t> FileBytes(const std::filesystem::path& path) {
+  std::ifstream in(path, std::ios::binary);
+  return std::vector<uint8_t>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+DiskStoreOptions KernelCopy() {
+  DiskStoreOptions options;
+  options.kernel_copy = true;
+  return options;
+}
+
+std::filesystem::path DiskPath(const std::filesystem::path& root, const PayloadID& id) {
+  return payload::storage::common::PayloadPath(root, payload::util::ToString(payload::util::FromProto(id)));
+}
+
+} // namespace
+
+TEST(RamDiskTransfer, DedicatedAndSlabPayloadsCopyInKernel) {
+  Scratch        scratch;
+  RamArrowStore  ram(scratch.prefix);
+  DiskArrowStore disk(scratch.disk_root, KernelCopy());
+
+  for (const uint64_t size : {uint64_t{3000}, uint64_t{5} << 20}) {
+    const auto id      = NewId();
+    const auto pattern = Pattern(size);
+    auto       buf     = ram.Allocate(id, size);
+    std::memcpy(buf->mutable_data(), pattern.data(), size);
+
+    ASSERT_TRUE(ram.TransferTo(disk, id, /*fsync=*/true)) << size;
+    EXPECT_EQ(FileBytes(DiskPath(scratch.disk_root, id)), pattern) << size;
+    EXPECT_FALSE(std::filesystem::exists(DiskPath(scratch.disk_root, id).string() + ".tmp"));
+  }
+}
+
+TEST(RamDiskTransfer, TargetsWithoutKernelCopyDecline) {
+  Scratch        scratch;
+  RamArrowStore  ram(scratch.prefix);
+  RamArrowStore  other(scratch.prefix + "-other");
+  DiskArrowStore disk(scratch.disk_root);
+
+  const auto id = NewId();
+  ram.Allocate(id, 4096);
+  EXPECT_FALSE(ram.TransferTo(other, id, /*fsync=*/false));
+  EXPECT_THROW(other.Read(id), std::runtime_error);
+  EXPECT_FALSE(ram.TransferTo(disk, id, /*fsync=*/false));
+  EXPECT_FALSE(std::filesystem::exists(DiskPath(scratch.disk_root, id)));
+}
+
+TEST(RamDiskTransfer, ExecuteSpillMovesBytesToDisk) {
+  Scratch scratch;
+  auto    ram = std::make_shared<RamArrowStore>(scratch.prefix);
+
+  payload::storage::StorageFactory::TierMap storage;
+  storage[TIER_RAM]  = ram;
+  storage[TIER_DISK] = std::make_shared<DiskArrowStore>(scratch.disk_root, KernelCopy());
+  PayloadManager manager(storage, std::make_shared<payload::lease::LeaseManager>(), std::make_shared<payload::db::memory::MemoryRepository>());
+
+  const uint64_t size      = uint64_t{2} << 20;
+  const auto     pattern   = Pattern(size);
+  const auto     allocated = manager.Allocate(size, TIER_RAM);
+  std::memcpy(ram->Read(allocated.payload_id())->mutable_data(), pattern.data(), size);
+  const auto id = manager.Commit(allocated.payload_id()).payload_id();
+
+  manager.ExecuteSpill(id, TIER_DISK, /*fsync=*/false);
+
+  EXPECT_EQ(manager.ResolveSnapshot(id).tier(), TIER_DISK);
+  EXPECT_EQ(FileBytes(DiskPath(scratch.disk_root, id)), pattern);
+  EXPECT_EQ(shm_open(ram->ShmName(id).c_str(), O_RDONLY, 0), -1);
+}
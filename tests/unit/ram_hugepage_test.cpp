@@ -0,0 +1,126 @@
+/*
+  RamArrowStore huge-page segment tests.
+
+  Covers the fallback to base-page shm when the configured mount is not
+  hugetlbfs, and — when the host has a hugetlbfs mount with free pages —
+  huge-page placement, size rounding, re-open after a restart and unlink
+  on Remove. Hosts without huge pages skip the latter.
+*/
+
+#include <arrow/buffer.h>
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "internal/storage/ram/ram_arrow_store.hpp"
+#include "internal/util/uuid.hpp"
+#include "payload/manager/v1.hpp"
+
+namespace {
+
+using payload::manager::v1::PayloadID;
+using payload::storage::RamArrowStore;
+using payload::storage::RamHugePageOptions;
+using payload::storage::RamSlabOptions;
+
+std::string UniquePrefix() {
+  static std::atomic<int> next{0};
+  return "pm-hugepage-test-" + std::to_string(getpid()) + "-" + std::to_string(next.fetch_add(1));
+}
+
+PayloadID NewId() {
+  return payload::util::ToProto(payload::util::GenerateUUID());
+}
+
+RamHugePageOptions HugePages(std::string mount_path) {
+  RamHugePageOptions options;
+  options.enabled    = true;
+  options.mount_path = std::move(mount_path);
+  return options;
+}
+
+} // namespace
+
+TEST(RamHugePage, NonHugetlbfsMountFallsBackToShm) {
+  const auto    dir = std::filesystem::temp_directory_path();
+  RamArrowStore store(UniquePrefix(), RamSlabOptions{}, HugePages(dir.string()));
+  EXPECT_EQ(store.HugePageBytes(), 0u);
+
+  const auto     id   = NewId();
+  const uint64_t size = uint64_t{4} << 20;
+  auto           buf  = store.Allocate(id, size);
+  ASSERT_EQ(buf->size(), static_cast<int64_t>(size));
+
+  const auto location = store.Locate(id, size);
+  EXPECT_TRUE(location.file_path().empty());
+  EXPECT_EQ(location.page_size_bytes(), 0u);
+  EXPECT_EQ(location.shm_name(), store.ShmName(id));
+
+  const auto stats = store.SegmentStats();
+  EXPECT_EQ(stats.dedicated_segments, 1u);
+  EXPECT_EQ(stats.huge_page_segments, 0u);
+  EXPECT_EQ(stats.huge_page_fallbacks, 0u);
+
+  buf.reset();
+  store.Remove(id);
+  EXPECT_EQ(shm_open(location.shm_name().c_str(), O_RDONLY, 0), -1);
+}
+
+TEST(RamHugePage, SegmentsLiveOnHugetlbfsAndSurviveRestart) {
+  const char* env    = std::getenv("PAYLOAD_TEST_HUGETLBFS");
+  const auto  mount  = std::string(env != nullptr ? env : "/dev/hugepages");
+  const auto  prefix = UniquePrefix();
+
+  const auto                        id = NewId();
+  payload::manager::v1::RamLocation location;
+  uint64_t                          huge = 0;
+  uint64_t                          size = 0;
+  {
+    RamArrowStore store(prefix, RamSlabOptions{}, HugePages(mount));
+    huge = store.HugePageBytes();
+    if (huge == 0) {
+      GTEST_SKIP() << mount << " is not a hugetlbfs mount";
+    }
+
+    // Small payloads stay on base pages.
+    const auto small = NewId();
+    store.Allocate(small, huge / 2);
+    EXPECT_TRUE(store.Locate(small, huge / 2).file_path().empty());
+    store.Remove(small);
+
+    // Leaves no room for the length footer in two pages.
+    size     = 2 * huge - 4;
+    auto buf = store.Allocate(id, size);
+    location = store.Locate(id, size);
+    if (location.page_size_bytes() == 0) {
+      EXPECT_EQ(store.SegmentStats().huge_page_fallbacks, 1u);
+      store.Remove(id);
+      GTEST_SKIP() << "huge page pool exhausted";
+    }
+    std::memset(buf->mutable_data(), 0x7E, size);
+
+    EXPECT_EQ(location.page_size_bytes(), huge);
+    EXPECT_EQ(location.file_path(), store.HugePagePath(id));
+    EXPECT_EQ(std::filesystem::file_size(location.file_path()), 3 * huge);
+    EXPECT_EQ(store.SegmentStats().huge_page_segments, 1u);
+  }
+
+  RamArrowStore restarted(prefix, RamSlabOptions{}, HugePages(mount));
+  auto          buf = restarted.Read(id);
+  ASSERT_EQ(buf->size(), static_cast<int64_t>(size));
+  EXPECT_EQ(std::vector<uint8_t>(buf->data(), buf->data() + size), std::vector<uint8_t>(size, 0x7E));
+  EXPECT_EQ(restarted.Locate(id, size).file_path(), location.file_path());
+
+  buf.reset();
+  restarted.Remove(id);
+  EXPECT_FALSE(std::filesystem::exists(location.file_path()));
+  EXPECT_EQ(restarted.SegmentStats().huge_page_segments, 0u);
+}
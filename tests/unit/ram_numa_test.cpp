@@ -0,0 +1,174 @@
+/*
+  RamArrowStore NUMA placement tests.
+
+  Covers node hints, capacity-balanced placement of unhinted payloads,
+  per-node usage accounting, per-node slab arenas, recovery of arena nodes
+  by a restarted store, and the memory policy applied to bound segments.
+  Node 1 need not exist on the host: binding to it fails softly and only
+  the accounting is checked.
+*/
+
+#include <arrow/buffer.h>
+#include <gtest/gtest.h>
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+
+#include "internal/storage/ram/ram_arrow_store.hpp"
+#include "internal/util/errors.hpp"
+#include "internal/util/uuid.hpp"
+#include "payload/manager/v1.hpp"
+
+namespace {
+
+using payload::manager::v1::PayloadID;
+using payload::storage::RamArrowStore;
+using payload::storage::RamHugePageOptions;
+using payload::storage::RamNumaOptions;
+using payload::storage::RamSlabOptions;
+
+constexpr uint64_t kMiB = uint64_t{1} << 20;
+
+// Unique shm prefix per test; unlinks every segment it created on exit.
+struct ShmPrefix {
+  std::string value;
+
+  ShmPrefix() {
+    static std::atomic<int> next{0};
+    value = "pm-numa-test-" + std::to_string(getpid()) + "-" + std::to_string(next.fetch_add(1));
+  }
+
+  ~ShmPrefix() {
+    std::error_code ec;
+    for (std::filesystem::directory_iterator it("/dev/shm", ec); !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+      const auto file = it->path().filename().string();
+      if (file.rfind(value + "-", 0) == 0) {
+        shm_unlink(("/" + file).c_str());
+      }
+    }
+  }
+};
+
+PayloadID NewId() {
+  return payload::util::ToProto(payload::util::GenerateUUID());
+}
+
+RamNumaOptions TwoNodes() {
+  RamNumaOptions options;
+  options.nodes = {{0, 8 * kMiB}, {1, 8 * kMiB}};
+  return options;
+}
+
+} // namespace
+
+TEST(RamNuma, HintsPlaceAndUnhintedPayloadsBalance) {
+  ShmPrefix     prefix;
+  RamArrowStore store(prefix.value, RamSlabOptions{}, RamHugePageOptions{}, TwoNodes());
+
+  const auto hinted = NewId();
+  store.Allocate(hinted, 2 * kMiB, 1u);
+  EXPECT_EQ(store.NumaNode(hinted), 1u);
+  const auto location = store.Locate(hinted, 2 * kMiB);
+  ASSERT_TRUE(location.has_numa_node());
+  EXPECT_EQ(location.numa_node(), 1u);
+
+  // Node 0 has more capacity left, then the nodes alternate.
+  const auto first = NewId();
+  store.Allocate(first, 3 * kMiB, std::nullopt);
+  EXPECT_EQ(store.NumaNode(first), 0u);
+  const auto second = NewId();
+  store.Allocate(second, 1 * kMiB, std::nullopt);
+  EXPECT_EQ(store.NumaNode(second), 1u);
+
+  auto usage = store.NodeUsage();
+  ASSERT_EQ(usage.size(), 2u);
+  EXPECT_EQ(usage[0].node, 0u);
+  EXPECT_EQ(usage[0].used_bytes, 3 * kMiB);
+  EXPECT_EQ(usage[1].capacity_bytes, 8 * kMiB);
+  EXPECT_EQ(usage[1].used_bytes, 3 * kMiB);
+
+  store.Remove(hinted);
+  EXPECT_EQ(store.NodeUsage()[1].used_bytes, 1 * kMiB);
+
+  EXPECT_THROW(store.Allocate(NewId(), kMiB, 2u), payload::util::InvalidArgument);
+}
+
+TEST(RamNuma, UnsplitStoreIgnoresHints) {
+  ShmPrefix     prefix;
+  RamArrowStore store(prefix.value);
+
+  const auto id = NewId();
+  store.Allocate(id, kMiB, 3u);
+  EXPECT_FALSE(store.NumaNode(id).has_value());
+  EXPECT_FALSE(store.Locate(id, kMiB).has_numa_node());
+  EXPECT_TRUE(store.NodeUsage().empty());
+}
+
+TEST(RamNuma, RejectsInvalidNodeConfiguration) {
+  ShmPrefix      prefix;
+  RamNumaOptions duplicate;
+  duplicate.nodes = {{0, kMiB}, {0, kMiB}};
+  EXPECT_THROW(RamArrowStore(prefix.value, RamSlabOptions{}, RamHugePageOptions{}, duplicate), std::invalid_argument);
+
+  RamNumaOptions out_of_range;
+  out_of_range.nodes = {{64, kMiB}};
+  EXPECT_THROW(RamArrowStore(prefix.value, RamSlabOptions{}, RamHugePageOptions{}, out_of_range), std::invalid_argument);
+}
+
+TEST(RamNuma, SlabArenasArePerNodeAndRecoverTheirNode) {
+  ShmPrefix  prefix;
+  const auto on_zero = NewId();
+  const auto on_one  = NewId();
+
+  uint32_t zero_slab = 0;
+  {
+    RamArrowStore store(prefix.value, RamSlabOptions{}, RamHugePageOptions{}, TwoNodes());
+    store.Allocate(on_zero, 1000, 0u);
+    store.Allocate(on_one, 1000, 1u);
+    zero_slab = store.Locate(on_zero, 1000).slab_id();
+    EXPECT_NE(zero_slab, 0u);
+    EXPECT_NE(store.Locate(on_one, 1000).slab_id(), zero_slab);
+    EXPECT_EQ(store.SegmentStats().slab_count, 2u);
+  }
+
+  RamArrowStore restarted(prefix.value, RamSlabOptions{}, RamHugePageOptions{}, TwoNodes());
+  EXPECT_EQ(restarted.NumaNode(on_zero), 0u);
+  EXPECT_EQ(restarted.NumaNode(on_one), 1u);
+  EXPECT_EQ(restarted.NodeUsage()[0].used_bytes, 1000u);
+  EXPECT_EQ(restarted.NodeUsage()[1].used_bytes, 1000u);
+
+  // New node-0 payloads keep filling the recovered node-0 arena.
+  const auto next = NewId();
+  restarted.Allocate(next, 1000, 0u);
+  EXPECT_EQ(restarted.Locate(next, 1000).slab_id(), zero_slab);
+}
+
+TEST(RamNuma, BoundSegmentsCarryAPreferredPolicy) {
+  ShmPrefix      prefix;
+  RamNumaOptions node_zero;
+  node_zero.nodes = {{0, 64 * kMiB}};
+  RamArrowStore store(prefix.value, RamSlabOptions{}, RamHugePageOptions{}, node_zero);
+
+  const auto id  = NewId();
+  auto       buf = store.Allocate(id, 4 * kMiB, 0u);
+
+  int           mode = -1;
+  unsigned long mask = 0;
+  if (syscall(SYS_get_mempolicy, &mode, &mask, sizeof(mask) * 8 + 1, buf->data(), MPOL_F_ADDR) != 0) {
+    GTEST_SKIP() << "get_mempolicy unavailable: " << std::strerror(errno);
+  }
+  EXPECT_EQ(mode, MPOL_PREFERRED);
+  EXPECT_EQ(mask, 1ul);
+
+  std::memset(buf->mutable_data(), 0x11, 4 * kMiB);
+  int node = -1;
+  ASSERT_EQ(syscall(SYS_get_mempolicy, &node, nullptr, 0, buf->data(), MPOL_F_NODE | MPOL_F_ADDR), 0);
+  EXPECT_EQ(node, 0);
+}
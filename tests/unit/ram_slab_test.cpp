@@ -0,0 +1,310 @@
+/*
+  RamArrowStore slab arena tests.
+
+  Covers size-class placement of small payloads in shared arenas, dedicated
+  segments for large payloads, block reuse and arena release, quarantine of
+  freed blocks that a reader or a (revoked) lease still holds, fragmentation
+  stats, recovery of slab placements by a restarted store, and the slab
+  location PayloadManager publishes in descriptors and rebuilds on a
+  resolve hit.
+*/
+
+#include <arrow/buffer.h>
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "internal/core/payload_manager.hpp"
+#include "internal/db/memory/memory_repository.hpp"
+#include "internal/lease/lease_manager.hpp"
+#include "internal/storage/ram/ram_arrow_store.hpp"
+#include "internal/util/uuid.hpp"
+#include "payload/manager/v1.hpp"
+
+namespace {
+
+using payload::core::PayloadManager;
+using payload::manager::v1::PayloadID;
+using payload::manager::v1::TIER_RAM;
+using payload::storage::RamArrowStore;
+using payload::storage::RamSlabOptions;
+
+// Unique shm prefix per test; unlinks every segment it created on exit.
+struct ShmPrefix {
+  std::string value;
+
+  ShmPrefix() {
+    static std::atomic<int> next{0};
+    value = "pm-slab-test-" + std::to_string(getpid()) + "-" + std::to_string(next.fetch_add(1));
+  }
+
+  ~ShmPrefix() {
+    std::error_code ec;
+    for (std::filesystem::directory_iterator it("/dev/shm", ec); !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+      const auto file = it->path().filename().string();
+      if (file.rfind(value + "-", 0) == 0) {
+        shm_unlink(("/" + file).c_str());
+      }
+    }
+  }
+};
+
+PayloadID NewId() {
+  return payload::util::ToProto(payload::util::GenerateUUID());
+}
+
+RamSlabOptions SmallArenas() {
+  RamSlabOptions options;
+  options.max_block_bytes = 4096;
+  options.arena_bytes     = 64 * 1024; // 15 blocks of 4 KiB
+  return options;
+}
+
+// Maps [offset, offset + length) of a segment the way an external client does.
+std::vector<uint8_t> ReadSegment(const std::string& name, uint64_t offset, uint64_t length) {
+  const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+  EXPECT_GE(fd, 0) << name;
+  if (fd < 0) return {};
+  const uint64_t page       = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+  const uint64_t map_offset = offset / page * page;
+  const size_t   map_size   = static_cast<size_t>(offset - map_offset + length);
+  void*          base       = mmap(nullptr, map_size, PROT_READ, MAP_SHARED, fd, static_cast<off_t>(map_offset));
+  close(fd);
+  EXPECT_NE(base, MAP_FAILED);
+  if (base == MAP_FAILED) return {};
+  const auto*          begin = static_cast<const uint8_t*>(base) + (offset - map_offset);
+  std::vector<uint8_t> bytes(begin, begin + length);
+  munmap(base, map_size);
+  return bytes;
+}
+
+} // namespace
+
+TEST(RamSlab, SmallPayloadsShareAnArena) {
+  ShmPrefix     prefix;
+  RamArrowStore store(prefix.value);
+
+  const auto first  = NewId();
+  const auto second = NewId();
+  auto       buf    = store.Allocate(first, 1000);
+  store.Allocate(second, 1000);
+  std::memset(buf->mutable_data(), 0xAB, 1000);
+
+  const auto a = store.Locate(first, 1000);
+  const auto b = store.Locate(second, 1000);
+  EXPECT_NE(a.slab_id(), 0u);
+  EXPECT_EQ(a.slab_id(), b.slab_id());
+  EXPECT_EQ(a.shm_name(), store.SlabName(a.slab_id()));
+  EXPECT_NE(a.block_index(), b.block_index());
+  EXPECT_EQ(b.offset_bytes() - a.offset_bytes(), (b.block_index() - a.block_index()) * 1024);
+
+  const auto bytes = ReadSegment(a.shm_name(), a.offset_bytes(), 1000);
+  EXPECT_EQ(bytes, std::vector<uint8_t>(1000, 0xAB));
+  EXPECT_EQ(store.Read(first)->size(), 1000);
+}
+
+TEST(RamSlab, LargeAndDisabledPayloadsGetDedicatedSegments) {
+  ShmPrefix     prefix;
+  RamArrowStore store(prefix.value, SmallArenas());
+
+  const auto large = NewId();
+  store.Allocate(large, 8192);
+  const auto location = store.Locate(large, 8192);
+  EXPECT_EQ(location.slab_id(), 0u);
+  EXPECT_EQ(location.offset_bytes(), 0u);
+  EXPECT_EQ(location.shm_name(), store.ShmName(large));
+
+  RamSlabOptions disabled;
+  disabled.enabled = false;
+  RamArrowStore plain(prefix.value + "-plain", disabled);
+  const auto    small = NewId();
+  plain.Allocate(small, 64);
+  EXPECT_EQ(plain.Locate(small, 64).slab_id(), 0u);
+  EXPECT_EQ(plain.SegmentStats().slab_count, 0u);
+  EXPECT_EQ(plain.SegmentStats().dedicated_segments, 1u);
+  plain.Remove(small);
+}
+
+TEST(RamSlab, FreedBlocksAreReusedAndSurplusArenasReleased) {
+  ShmPrefix     prefix;
+  RamArrowStore store(prefix.value, SmallArenas());
+
+  std::vector<PayloadID> ids;
+  for (int i = 0; i < 16; ++i) {
+    ids.push_back(NewId());
+    store.Allocate(ids.back(), 4096);
+  }
+  const auto overflow = store.Locate(ids.back(), 4096);
+  EXPECT_NE(overflow.slab_id(), store.Locate(ids.front(), 4096).slab_id());
+  EXPECT_EQ(store.SegmentStats().slab_count, 2u);
+
+  const auto freed = store.Locate(ids[3], 4096);
+  store.Remove(ids[3]);
+
+  // With a free block left in the first arena, emptying the second unlinks it.
+  store.Remove(ids.back());
+  EXPECT_EQ(store.SegmentStats().slab_count, 1u);
+  EXPECT_EQ(shm_open(overflow.shm_name().c_str(), O_RDONLY, 0), -1);
+
+  const auto reused = NewId();
+  store.Allocate(reused, 3000);
+  const auto location = store.Locate(reused, 3000);
+  EXPECT_EQ(location.slab_id(), freed.slab_id());
+  EXPECT_EQ(location.block_index(), freed.block_index());
+}
+
+TEST(RamSlab, FreedBlocksWaitForInProcessReaders) {
+  ShmPrefix     prefix;
+  RamArrowStore store(prefix.value, SmallArenas());
+
+  const auto held = NewId();
+  store.Allocate(held, 4096);
+  const auto freed  = store.Locate(held, 4096);
+  auto       reader = store.Read(held);
+  store.Remove(held);
+  EXPECT_EQ(store.SegmentStats().quarantined_blocks, 1u);
+
+  const auto next = NewId();
+  store.Allocate(next, 4096);
+  EXPECT_NE(store.Locate(next, 4096).block_index(), freed.block_index());
+
+  // Once the reader lets go, the next allocation takes the block back.
+  reader.reset();
+  const auto reused = NewId();
+  store.Allocate(reused, 4096);
+  EXPECT_EQ(store.Locate(reused, 4096).block_index(), freed.block_index());
+  EXPECT_EQ(store.SegmentStats().quarantined_blocks, 0u);
+}
+
+TEST(RamSlab, RevokedLeasesKeepFreedBlocksOutOfReuse) {
+  ShmPrefix prefix;
+  auto      ram       = std::make_shared<RamArrowStore>(prefix.value, SmallArenas());
+  auto      lease_mgr = std::make_shared<payload::lease::LeaseManager>();
+
+  // The manager hands the store its lease table.
+  payload::storage::StorageFactory::TierMap storage;
+  storage[TIER_RAM] = ram;
+  PayloadManager manager(storage, lease_mgr, std::make_shared<payload::db::memory::MemoryRepository>());
+
+  const auto id = NewId();
+  ram->Allocate(id, 4096);
+  const auto freed = ram->Locate(id, 4096);
+  const auto lease = lease_mgr->Acquire(id, {}, 60'000);
+
+  // What a forced delete does: revoke, then remove while the client may
+  // still be mapping the block.
+  lease_mgr->InvalidateAll(id);
+  ram->Remove(id);
+  for (int i = 0; i < 3; ++i) {
+    const auto other = NewId();
+    ram->Allocate(other, 4096);
+    EXPECT_NE(ram->Locate(other, 4096).block_index(), freed.block_index());
+  }
+
+  lease_mgr->Release(lease.lease_id);
+  const auto reused = NewId();
+  ram->Allocate(reused, 4096);
+  EXPECT_EQ(ram->Locate(reused, 4096).block_index(), freed.block_index());
+}
+
+TEST(RamSlab, StatsReportFragmentation) {
+  ShmPrefix     prefix;
+  RamArrowStore store(prefix.value, SmallArenas());
+
+  store.Allocate(NewId(), 300);  // 512-byte block
+  store.Allocate(NewId(), 4096); // exact fit
+  store.Allocate(NewId(), 9000); // dedicated
+
+  const auto stats = store.SegmentStats();
+  EXPECT_EQ(stats.slab_count, 2u);
+  EXPECT_EQ(stats.dedicated_segments, 1u);
+  EXPECT_EQ(stats.requested_bytes, 300u + 4096u);
+  EXPECT_EQ(stats.allocated_bytes, 512u + 4096u);
+  EXPECT_GT(stats.capacity_bytes, stats.allocated_bytes);
+  EXPECT_NEAR(stats.InternalFragmentation(), 1.0 - 4396.0 / 4608.0, 1e-9);
+  EXPECT_GT(stats.ExternalFragmentation(), 0.9);
+}
+
+TEST(RamSlab, RestartedStoreRecoversSlabPlacements) {
+  ShmPrefix  prefix;
+  const auto kept    = NewId();
+  const auto dropped = NewId();
+
+  payload::manager::v1::RamLocation before;
+  {
+    RamArrowStore store(prefix.value);
+    auto          buf = store.Allocate(kept, 2000);
+    std::memset(buf->mutable_data(), 0x5C, 2000);
+    store.Allocate(dropped, 2000);
+    store.Remove(dropped);
+    before = store.Locate(kept, 2000);
+  }
+
+  RamArrowStore restarted(prefix.value);
+  const auto    after = restarted.Locate(kept, 2000);
+  EXPECT_EQ(after.slab_id(), before.slab_id());
+  EXPECT_EQ(after.block_index(), before.block_index());
+  EXPECT_EQ(after.offset_bytes(), before.offset_bytes());
+
+  auto buf = restarted.Read(kept);
+  ASSERT_EQ(buf->size(), 2000);
+  EXPECT_EQ(std::vector<uint8_t>(buf->data(), buf->data() + 2000), std::vector<uint8_t>(2000, 0x5C));
+  EXPECT_EQ(restarted.Locate(dropped, 2000).slab_id(), 0u);
+
+  // New payloads never land on a recovered block.
+  const auto fresh = NewId();
+  restarted.Allocate(fresh, 2000);
+  const auto placed = restarted.Locate(fresh, 2000);
+  EXPECT_FALSE(placed.slab_id() == after.slab_id() && placed.block_index() == after.block_index());
+  EXPECT_EQ(restarted.SegmentStats().requested_bytes, 4000u);
+}
+
+TEST(RamSlab, PayloadManagerDescriptorsCarrySlabPlacement) {
+  ShmPrefix prefix;
+  auto      ram = std::make_shared<RamArrowStore>(prefix.value);
+
+  payload::storage::StorageFactory::TierMap storage;
+  storage[TIER_RAM] = ram;
+  PayloadManager manager(storage, std::make_shared<payload::lease::LeaseManager>(), std::make_shared<payload::db::memory::MemoryRepository>());
+
+  const auto allocated = manager.Allocate(64, TIER_RAM);
+  ASSERT_TRUE(allocated.has_ram());
+  EXPECT_NE(allocated.ram().slab_id(), 0u);
+  EXPECT_EQ(allocated.ram().shm_name(), ram->SlabName(allocated.ram().slab_id()));
+  EXPECT_EQ(allocated.ram().length_bytes(), 64u);
+
+  const auto committed = manager.Commit(allocated.payload_id());
+  const auto resolved  = manager.ResolveSnapshot(committed.payload_id());
+  EXPECT_EQ(resolved.ram().slab_id(), allocated.ram().slab_id());
+  EXPECT_EQ(resolved.ram().block_index(), allocated.ram().block_index());
+  EXPECT_EQ(resolved.ram().offset_bytes(), allocated.ram().offset_bytes());
+
+  manager.Delete(committed.payload_id(), /*force=*/false);
+  EXPECT_EQ(ram->SegmentStats().allocated_bytes, 0u);
+}
+
+TEST(RamSlab, ResolveHitsRebuildTheStoresLocation) {
+  ShmPrefix prefix;
+  auto      ram = std::make_shared<RamArrowStore>(prefix.value);
+
+  payload::storage::StorageFactory::TierMap storage;
+  storage[TIER_RAM] = ram;
+  PayloadManager manager(storage, std::make_shared<payload::lease::LeaseManager>(), std::make_shared<payload::db::memory::MemoryRepository>());
+
+  // A slab block and a dedicated segment; hits rebuild both from the cached placement.
+  for (const uint64_t size : {uint64_t{64}, uint64_t{4} << 20}) {
+    const auto id       = manager.Commit(manager.Allocate(size, TIER_RAM).payload_id()).payload_id();
+    const auto resolved = manager.ResolveSnapshot(id);
+    ASSERT_TRUE(resolved.has_ram());
+    EXPECT_EQ(resolved.ram().SerializeAsString(), ram->Locate(id, size).SerializeAsString()) << size;
+    EXPECT_EQ(manager.ResolveSnapshot(id).ram().SerializeAsString(), resolved.ram().SerializeAsString());
+  }
+}
@@ -0,0 +1,321 @@
+/*
+  Sidecar format tests.
+
+  Covers binary <uuid>.meta.pb sidecars on disk, and manifest segments:
+  segments written every manifest_max_entries entries or once the window
+  passes, no per-payload files, tombstones for removed payloads, the
+  object tier flushing on destruction, a failed segment write being
+  retried, and ReadManifestCatalog rebuilding the catalog in order, with
+  segment sequences continuing across restarts (and above segments named
+  by write time) so replay order never depends on the clock. Compaction
+  rewrites the live catalog as one segment once enough segments pile up or
+  enough written entries are dead.
+*/
+
+#include <arrow/filesystem/localfs.h>
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "internal/storage/common/sidecar.hpp"
+#include "internal/storage/disk/disk_arrow_store.hpp"
+#include "internal/storage/object/object_arrow_store.hpp"
+#include "internal/util/uuid.hpp"
+#include "payload/manager/catalog/v1/archive_metadata.pb.h"
+
+namespace {
+
+using payload::manager::catalog::v1::PayloadArchiveMetadata;
+using payload::manager::v1::PayloadID;
+using payload::storage::DiskArrowStore;
+using payload::storage::DiskStoreOptions;
+using payload::storage::ObjectArrowStore;
+using payload::storage::common::ManifestWriter;
+using payload::storage::common::ReadManifestCatalog;
+using payload::storage::common::SidecarFormat;
+using payload::storage::common::SidecarOptions;
+
+struct TempDir {
+  std::filesystem::path path;
+
+  TempDir() {
+    static std::atomic<int> next{0};
+    path = std::filesystem::temp_directory_path() / ("pm-manifest-test-" + std::to_string(getpid()) + "-" + std::to_string(next.fetch_add(1)));
+    std::filesystem::create_directories(path);
+  }
+
+  ~TempDir() {
+    std::error_code ec;
+    std::filesystem::remove_all(path, ec);
+  }
+
+  int Files(const std::filesystem::path& dir, const std::string& suffix) const {
+    int             count = 0;
+    std::error_code ec;
+    for (std::filesystem::directory_iterator it(dir, ec); !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+      const auto name = it->path().filename().string();
+      if (name.size() > suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0) ++count;
+    }
+    return count;
+  }
+
+  int Segments() const {
+    return Files(path / "manifests", ".manifest");
+  }
+};
+
+PayloadArchiveMetadata Meta(const PayloadID& id, const std::string& dataset) {
+  PayloadArchiveMetadata meta;
+  *meta.mutable_uuid() = id;
+  meta.set_metadata_version(1);
+  meta.set_dataset(dataset);
+  return meta;
+}
+
+SidecarOptions Manifest(uint32_t max_entries, std::chrono::milliseconds window = std::chrono::hours(1)) {
+  SidecarOptions options;
+  options.format               = SidecarFormat::kManifest;
+  options.manifest_max_entries = max_entries;
+  options.manifest_window      = window;
+  return options;
+}
+
+payload::storage::common::ManifestCatalog Catalog(const std::filesystem::path& root) {
+  arrow::fs::LocalFileSystem fs;
+  return ReadManifestCatalog(fs, root.string());
+}
+
+} // namespace
+
+TEST(SidecarManifest, BinarySidecarRoundTrips) {
+  TempDir          tmp;
+  DiskStoreOptions options;
+  options.sidecars.format = SidecarFormat::kBinary;
+  DiskArrowStore store(tmp.path, options);
+
+  const auto uuid = payload::util::GenerateUUID();
+  const auto id   = payload::util::ToProto(uuid);
+  store.Allocate(id, 64);
+  store.WriteSidecar(id, Meta(id, "radio"));
+
+  const auto path = payload::storage::common::SidecarPath(tmp.path, payload::util::ToString(uuid), SidecarFormat::kBinary);
+  EXPECT_EQ(path.filename().string(), payload::util::ToString(uuid) + ".meta.pb");
+  std::ifstream      in(path, std::ios::binary);
+  std::ostringstream bytes;
+  bytes << in.rdbuf();
+  PayloadArchiveMetadata parsed;
+  ASSERT_TRUE(parsed.ParseFromString(bytes.str()));
+  EXPECT_EQ(parsed.dataset(), "radio");
+  EXPECT_EQ(tmp.Files(tmp.path, ".meta.json"), 0);
+
+  store.Remove(id);
+  EXPECT_FALSE(std::filesystem::exists(path));
+}
+
+TEST(SidecarManifest, DiskBatchesEntriesIntoSegments) {
+  TempDir          tmp;
+  DiskStoreOptions options;
+  options.sidecars = Manifest(/*max_entries=*/4);
+  DiskArrowStore store(tmp.path, options);
+
+  std::vector<PayloadID> ids;
+  for (int i = 0; i < 10; ++i) {
+    ids.push_back(payload::util::ToProto(payload::util::GenerateUUID()));
+    store.WriteSidecar(ids.back(), Meta(ids.back(), "d" + std::to_string(i)));
+  }
+  EXPECT_EQ(tmp.Segments(), 2);
+  EXPECT_EQ(tmp.Files(tmp.path, ".meta.json"), 0);
+  EXPECT_EQ(tmp.Files(tmp.path, ".meta.pb"), 0);
+  EXPECT_EQ(Catalog(tmp.path).Entries().size(), 8u);
+
+  store.FlushSidecars();
+  EXPECT_EQ(tmp.Segments(), 3);
+  const auto catalog = Catalog(tmp.path);
+  ASSERT_EQ(catalog.Entries().size(), 10u);
+  EXPECT_EQ(catalog.Entries().at(payload::util::ToString(payload::util::FromProto(ids[9]))).dataset(), "d9");
+
+  // A later entry replaces an earlier one; a removal drops the payload.
+  store.WriteSidecar(ids[0], Meta(ids[0], "rewritten"));
+  store.Remove(ids[1]);
+  store.FlushSidecars();
+  const auto rebuilt = Catalog(tmp.path);
+  EXPECT_EQ(rebuilt.Entries().size(), 9u);
+  EXPECT_EQ(rebuilt.Entries().at(payload::util::ToString(payload::util::FromProto(ids[0]))).dataset(), "rewritten");
+  EXPECT_EQ(rebuilt.Entries().count(payload::util::ToString(payload::util::FromProto(ids[1]))), 0u);
+}
+
+TEST(SidecarManifest, WindowFlushesAPartialSegment) {
+  TempDir          tmp;
+  DiskStoreOptions options;
+  options.sidecars = Manifest(/*max_entries=*/1000, std::chrono::milliseconds(20));
+  DiskArrowStore store(tmp.path, options);
+
+  const auto id = payload::util::ToProto(payload::util::GenerateUUID());
+  store.WriteSidecar(id, Meta(id, "late"));
+  for (int i = 0; i < 500 && tmp.Segments() == 0; ++i) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(tmp.Segments(), 1);
+  EXPECT_EQ(Catalog(tmp.path).Entries().size(), 1u);
+}
+
+TEST(SidecarManifest, ObjectStoreWritesOneSegmentPerBatch) {
+  TempDir tmp;
+  {
+    ObjectArrowStore store(std::make_shared<arrow::fs::LocalFileSystem>(), tmp.path.string(), /*is_s3=*/false, {}, {}, Manifest(/*max_entries=*/64));
+    for (int i = 0; i < 100; ++i) {
+      const auto id = payload::util::ToProto(payload::util::GenerateUUID());
+      store.WriteSidecar(id, Meta(id, "object"));
+    }
+    EXPECT_EQ(tmp.Segments(), 1);
+  }
+  // The rest is written when the store goes away.
+  EXPECT_EQ(tmp.Segments(), 2);
+  EXPECT_EQ(tmp.Files(tmp.path, ".meta.json"), 0);
+  EXPECT_EQ(Catalog(tmp.path).Entries().size(), 100u);
+}
+
+TEST(SidecarManifest, SequenceContinuesAcrossRestarts) {
+  TempDir    tmp;
+  const auto id = payload::util::ToProto(payload::util::GenerateUUID());
+
+  // A segment from an older release, named by its write time: far ahead of
+  // any sequence a new writer would start from.
+  std::string legacy;
+  {
+    ManifestWriter writer(Manifest(/*max_entries=*/1000), [&](const std::string&, const std::string& bytes) { legacy = bytes; });
+    writer.Put(Meta(id, "legacy"));
+    writer.Flush();
+  }
+  std::filesystem::create_directories(tmp.path / "manifests");
+  std::ofstream(tmp.path / "manifests" / "00000001900000000000-0badcafe-0000000007.manifest", std::ios::binary) << legacy;
+
+  DiskStoreOptions options;
+  options.sidecars = Manifest(/*max_entries=*/1000);
+  for (const auto* dataset : {"first run", "second run"}) {
+    DiskArrowStore store(tmp.path, options);
+    store.WriteSidecar(id, Meta(id, dataset));
+    store.FlushSidecars();
+    const auto listed = store.ReadManifest();
+    ASSERT_EQ(listed.size(), 1u);
+    EXPECT_EQ(listed[0].dataset(), dataset);
+  }
+  EXPECT_EQ(tmp.Segments(), 3);
+
+  arrow::fs::LocalFileSystem fs;
+  EXPECT_EQ(payload::storage::common::NextManifestSequence(fs, tmp.path.string()), uint64_t{1900000000000} + 3);
+}
+
+TEST(SidecarManifest, CompactsOnceSegmentsPileUp) {
+  TempDir          tmp;
+  DiskStoreOptions options;
+  options.sidecars                             = Manifest(/*max_entries=*/1);
+  options.sidecars.manifest_compact_segments   = 4;
+  options.sidecars.manifest_compact_dead_ratio = 0;
+  DiskArrowStore store(tmp.path, options);
+
+  std::vector<PayloadID> ids;
+  for (int i = 0; i < 3; ++i) {
+    ids.push_back(payload::util::ToProto(payload::util::GenerateUUID()));
+    store.WriteSidecar(ids.back(), Meta(ids.back(), "d" + std::to_string(i)));
+  }
+  EXPECT_EQ(tmp.Segments(), 3);
+
+  ids.push_back(payload::util::ToProto(payload::util::GenerateUUID()));
+  store.WriteSidecar(ids.back(), Meta(ids.back(), "d3"));
+  EXPECT_EQ(tmp.Segments(), 1);
+  const auto catalog = Catalog(tmp.path);
+  ASSERT_EQ(catalog.Entries().size(), 4u);
+  EXPECT_EQ(catalog.Entries().at(payload::util::ToString(payload::util::FromProto(ids[3]))).dataset(), "d3");
+
+  // Later segments still sort after the compacted one.
+  store.WriteSidecar(ids[0], Meta(ids[0], "rewritten"));
+  EXPECT_EQ(tmp.Segments(), 2);
+  EXPECT_EQ(Catalog(tmp.path).Entries().at(payload::util::ToString(payload::util::FromProto(ids[0]))).dataset(), "rewritten");
+}
+
+TEST(SidecarManifest, CompactsOnceEnoughEntriesAreDead) {
+  TempDir          tmp;
+  DiskStoreOptions options;
+  options.sidecars                           = Manifest(/*max_entries=*/2);
+  options.sidecars.manifest_compact_segments = 1000;
+  DiskArrowStore store(tmp.path, options);
+
+  const auto a = payload::util::ToProto(payload::util::GenerateUUID());
+  const auto b = payload::util::ToProto(payload::util::GenerateUUID());
+  const auto c = payload::util::ToProto(payload::util::GenerateUUID());
+  store.WriteSidecar(a, Meta(a, "a"));
+  store.WriteSidecar(b, Meta(b, "b"));
+  store.WriteSidecar(c, Meta(c, "c"));
+  EXPECT_EQ(tmp.Segments(), 1);
+
+  // The removal and the entry it removes are 2 of 4 entries written.
+  store.Remove(a);
+  EXPECT_EQ(tmp.Segments(), 1);
+  const auto catalog = Catalog(tmp.path);
+  EXPECT_EQ(catalog.Entries().size(), 2u);
+  EXPECT_EQ(catalog.Entries().count(payload::util::ToString(payload::util::FromProto(a))), 0u);
+}
+
+TEST(SidecarManifest, CompactRewritesPendingAndWrittenEntries) {
+  TempDir    tmp;
+  const auto dir = tmp.path / "manifests";
+  std::filesystem::create_directories(dir);
+  ManifestWriter writer(
+      Manifest(/*max_entries=*/1), [&](const std::string& name, const std::string& bytes) { std::ofstream(dir / name, std::ios::binary) << bytes; },
+      /*first_sequence=*/0, std::make_shared<arrow::fs::LocalFileSystem>(), tmp.path.string());
+
+  const auto id = payload::util::ToProto(payload::util::GenerateUUID());
+  writer.Put(Meta(id, "first"));
+  writer.Put(Meta(id, "second"));
+  EXPECT_EQ(tmp.Segments(), 2);
+
+  writer.Compact();
+  EXPECT_EQ(tmp.Segments(), 1);
+  const auto catalog = Catalog(tmp.path);
+  ASSERT_EQ(catalog.Entries().size(), 1u);
+  EXPECT_EQ(catalog.Entries().begin()->second.dataset(), "second");
+}
+
+TEST(SidecarManifest, FailedSegmentStaysPending) {
+  std::vector<std::string> written;
+  bool                     fail = true;
+  ManifestWriter           writer(Manifest(/*max_entries=*/1000), [&](const std::string&, const std::string& bytes) {
+    if (fail) throw std::runtime_error("unavailable");
+    written.push_back(bytes);
+  });
+
+  const auto first  = payload::util::ToProto(payload::util::GenerateUUID());
+  const auto second = payload::util::ToProto(payload::util::GenerateUUID());
+  writer.Put(Meta(first, "first"));
+  EXPECT_THROW(writer.Flush(), std::runtime_error);
+  EXPECT_EQ(writer.PendingEntries(), 1u);
+
+  fail = false;
+  writer.Put(Meta(second, "second"));
+  writer.Flush();
+  EXPECT_EQ(writer.PendingEntries(), 0u);
+  ASSERT_EQ(written.size(), 1u);
+
+  payload::storage::common::ManifestCatalog catalog;
+  catalog.Apply(written[0]);
+  EXPECT_EQ(catalog.Entries().size(), 2u);
+}
+
+TEST(SidecarManifest, MalformedSegmentIsRejected) {
+  TempDir tmp;
+  std::filesystem::create_directories(tmp.path / "manifests");
+  std::ofstream(tmp.path / "manifests" / "0001.manifest", std::ios::binary) << "PMM1\x05\x0a";
+  EXPECT_THROW(Catalog(tmp.path), std::runtime_error);
+
+  payload::storage::common::ManifestCatalog catalog;
+  EXPECT_THROW(catalog.Apply("JSON{}"), std::runtime_error);
+}
@@ -0,0 +1,283 @@
+/*
+  Spill scheduler tests.
+
+  Covers handing out the most urgent priority class first (oldest first
+  within a class), merging duplicate tasks for a payload (including a
+  priority upgrade), holding back a payload a worker is already moving
+  until Complete() (and running a task it covered when that move fails),
+  cancelling on delete versus on a new lease (one at a time and for a
+  batch of leases), the enqueue time behind the queue-wait metric, and
+  many producers and workers draining the queue with each payload handed
+  out once.
+*/
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "internal/spill/spill_scheduler.hpp"
+#include "internal/util/uuid.hpp"
+#include "payload/manager/v1.hpp"
+
+namespace {
+
+using payload::manager::v1::PayloadID;
+using payload::manager::v1::TIER_DISK;
+using payload::manager::v1::TIER_OBJECT;
+using payload::spill::SpillPriority;
+using payload::spill::SpillScheduler;
+using payload::spill::SpillTask;
+
+PayloadID NewId() {
+  return payload::util::ToProto(payload::util::GenerateUUID());
+}
+
+SpillTask Task(const PayloadID& id, SpillPriority priority, payload::manager::v1::Tier target = TIER_DISK, bool fsync = false) {
+  SpillTask task;
+  task.id          = id;
+  task.target_tier = target;
+  task.fsync       = fsync;
+  task.priority    = priority;
+  return task;
+}
+
+// Takes whatever is ready without blocking on an empty queue.
+std::optional<SpillTask> Take(SpillScheduler& scheduler) {
+  const std::atomic<bool> stopped{false};
+  return scheduler.Dequeue(stopped);
+}
+
+} // namespace
+
+TEST(SpillScheduler, MostUrgentClassFirstThenOldest) {
+  SpillScheduler scheduler;
+  const auto     requested_a = NewId();
+  const auto     requested_b = NewId();
+  const auto     evict_a     = NewId();
+  const auto     evict_b     = NewId();
+  scheduler.Enqueue(Task(requested_a, SpillPriority::kExplicit));
+  scheduler.Enqueue(Task(evict_a, SpillPriority::kEviction));
+  scheduler.Enqueue(Task(requested_b, SpillPriority::kExplicit));
+  scheduler.Enqueue(Task(evict_b, SpillPriority::kEviction));
+  EXPECT_EQ(scheduler.QueueDepth(), 4u);
+
+  for (const auto& expected : {evict_a, evict_b, requested_a, requested_b}) {
+    const auto task = Take(scheduler);
+    ASSERT_TRUE(task.has_value());
+    EXPECT_EQ(task->id.value(), expected.value());
+    scheduler.Complete(*task);
+  }
+  EXPECT_FALSE(Take(scheduler).has_value());
+  EXPECT_EQ(scheduler.QueueDepth(), 0u);
+}
+
+TEST(SpillScheduler, DuplicatesMergeIntoTheQueuedTask) {
+  SpillScheduler scheduler;
+  const auto     id    = NewId();
+  const auto     other = NewId();
+  EXPECT_TRUE(scheduler.Enqueue(Task(id, SpillPriority::kExplicit, TIER_DISK)));
+  EXPECT_TRUE(scheduler.Enqueue(Task(other, SpillPriority::kEviction)));
+  EXPECT_FALSE(scheduler.Enqueue(Task(id, SpillPriority::kExplicit, TIER_OBJECT, /*fsync=*/true)));
+  EXPECT_FALSE(scheduler.Enqueue(Task(id, SpillPriority::kEviction, TIER_OBJECT)));
+  EXPECT_EQ(scheduler.QueueDepth(), 2u);
+
+  // The upgrade queues it behind the eviction already waiting.
+  auto first = Take(scheduler);
+  ASSERT_TRUE(first.has_value());
+  EXPECT_EQ(first->id.value(), other.value());
+  auto merged = Take(scheduler);
+  ASSERT_TRUE(merged.has_value());
+  EXPECT_EQ(merged->id.value(), id.value());
+  EXPECT_EQ(merged->priority, SpillPriority::kEviction);
+  EXPECT_EQ(merged->target_tier, TIER_OBJECT);
+  EXPECT_TRUE(merged->fsync);
+
+  // Its old explicit entry is skipped, not handed out again.
+  EXPECT_FALSE(Take(scheduler).has_value());
+  const auto stats = scheduler.GetStats();
+  EXPECT_EQ(stats.queued, 2u);
+  EXPECT_EQ(stats.coalesced, 2u);
+}
+
+TEST(SpillScheduler, RunningPayloadIsHeldUntilComplete) {
+  SpillScheduler scheduler;
+  const auto     id = NewId();
+  scheduler.Enqueue(Task(id, SpillPriority::kEviction, TIER_DISK));
+  const auto running = Take(scheduler);
+  ASSERT_TRUE(running.has_value());
+
+  // Covered by the move already under way.
+  EXPECT_FALSE(scheduler.Enqueue(Task(id, SpillPriority::kEviction, TIER_DISK)));
+  EXPECT_EQ(scheduler.QueueDepth(), 0u);
+
+  // A different target waits for it rather than running alongside.
+  EXPECT_TRUE(scheduler.Enqueue(Task(id, SpillPriority::kExplicit, TIER_OBJECT)));
+  EXPECT_EQ(scheduler.QueueDepth(), 1u);
+  EXPECT_FALSE(Take(scheduler).has_value());
+
+  scheduler.Complete(*running);
+  const auto next = Take(scheduler);
+  ASSERT_TRUE(next.has_value());
+  EXPECT_EQ(next->target_tier, TIER_OBJECT);
+  scheduler.Complete(*next);
+
+  EXPECT_TRUE(scheduler.Enqueue(Task(id, SpillPriority::kEviction, TIER_DISK)));
+}
+
+TEST(SpillScheduler, CoveredTaskRunsWhenTheMoveFails) {
+  SpillScheduler scheduler;
+  const auto     id = NewId();
+  scheduler.Enqueue(Task(id, SpillPriority::kEviction, TIER_DISK));
+  auto running = Take(scheduler);
+  ASSERT_TRUE(running.has_value());
+
+  // Covered while it runs; the move succeeds, so nothing is left to do.
+  EXPECT_FALSE(scheduler.Enqueue(Task(id, SpillPriority::kExplicit, TIER_DISK)));
+  scheduler.Complete(*running, /*succeeded=*/true);
+  EXPECT_FALSE(Take(scheduler).has_value());
+
+  // This time the move fails: the covered task is queued in its own right.
+  scheduler.Enqueue(Task(id, SpillPriority::kEviction, TIER_DISK));
+  running = Take(scheduler);
+  ASSERT_TRUE(running.has_value());
+  EXPECT_FALSE(scheduler.Enqueue(Task(id, SpillPriority::kExplicit, TIER_DISK)));
+  EXPECT_EQ(scheduler.QueueDepth(), 0u);
+  scheduler.Complete(*running, /*succeeded=*/false);
+  EXPECT_EQ(scheduler.QueueDepth(), 1u);
+  const auto retry = Take(scheduler);
+  ASSERT_TRUE(retry.has_value());
+  EXPECT_EQ(retry->target_tier, TIER_DISK);
+  EXPECT_EQ(retry->priority, SpillPriority::kExplicit);
+
+  // Deleted while its move runs: the covered task goes with it.
+  EXPECT_FALSE(scheduler.Enqueue(Task(id, SpillPriority::kEviction, TIER_DISK)));
+  EXPECT_FALSE(scheduler.Cancel(id));
+  scheduler.Complete(*retry, /*succeeded=*/false);
+  EXPECT_FALSE(Take(scheduler).has_value());
+  EXPECT_EQ(scheduler.QueueDepth(), 0u);
+}
+
+TEST(SpillScheduler, CancelOnDeleteAndOnLease) {
+  SpillScheduler scheduler;
+  const auto     deleted   = NewId();
+  const auto     evicted   = NewId();
+  const auto     requested = NewId();
+  scheduler.Enqueue(Task(deleted, SpillPriority::kExplicit));
+  scheduler.Enqueue(Task(evicted, SpillPriority::kEviction));
+  scheduler.Enqueue(Task(requested, SpillPriority::kExplicit));
+
+  EXPECT_TRUE(scheduler.Cancel(deleted));
+  EXPECT_FALSE(scheduler.Cancel(deleted));
+  EXPECT_TRUE(scheduler.CancelEviction(evicted));
+  EXPECT_FALSE(scheduler.CancelEviction(requested)) << "a client asked for this one";
+  EXPECT_EQ(scheduler.QueueDepth(), 1u);
+  EXPECT_EQ(scheduler.GetStats().cancelled, 2u);
+
+  // Queued again after a cancel: only the new task comes out.
+  scheduler.Enqueue(Task(evicted, SpillPriority::kExplicit));
+  auto task = Take(scheduler);
+  ASSERT_TRUE(task.has_value());
+  EXPECT_EQ(task->id.value(), requested.value());
+  scheduler.Complete(*task);
+  task = Take(scheduler);
+  ASSERT_TRUE(task.has_value());
+  EXPECT_EQ(task->id.value(), evicted.value());
+  EXPECT_EQ(task->priority, SpillPriority::kExplicit);
+  scheduler.Complete(*task);
+  EXPECT_FALSE(Take(scheduler).has_value());
+}
+
+TEST(SpillScheduler, CancelsEvictionsForABatchOfLeases) {
+  SpillScheduler scheduler;
+  const auto     evicted_a = NewId();
+  const auto     evicted_b = NewId();
+  const auto     requested = NewId();
+  const auto     idle      = NewId();
+
+  // Nothing queued: the lease path returns without touching the queue.
+  EXPECT_FALSE(scheduler.CancelEviction(idle));
+  EXPECT_EQ(scheduler.CancelEvictions({idle, evicted_a}), 0u);
+
+  scheduler.Enqueue(Task(evicted_a, SpillPriority::kEviction));
+  scheduler.Enqueue(Task(requested, SpillPriority::kExplicit));
+  scheduler.Enqueue(Task(evicted_b, SpillPriority::kEviction));
+
+  EXPECT_EQ(scheduler.CancelEvictions({evicted_a, requested, evicted_b, idle}), 2u);
+  EXPECT_EQ(scheduler.QueueDepth(), 1u);
+  EXPECT_EQ(scheduler.GetStats().cancelled, 2u);
+  EXPECT_FALSE(scheduler.CancelEviction(requested));
+
+  // A kExplicit task merged into an eviction becomes withdrawable.
+  scheduler.Enqueue(Task(requested, SpillPriority::kEviction));
+  EXPECT_TRUE(scheduler.CancelEviction(requested));
+  EXPECT_EQ(scheduler.QueueDepth(), 0u);
+}
+
+TEST(SpillScheduler, KeepsTheFirstEnqueueTime) {
+  SpillScheduler scheduler;
+  const auto     id     = NewId();
+  const auto     before = std::chrono::steady_clock::now();
+  scheduler.Enqueue(Task(id, SpillPriority::kExplicit));
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  scheduler.Enqueue(Task(id, SpillPriority::kEviction));
+
+  const auto task = Take(scheduler);
+  ASSERT_TRUE(task.has_value());
+  EXPECT_GE(task->enqueued_at, before);
+  EXPECT_GE(std::chrono::steady_clock::now() - task->enqueued_at, std::chrono::milliseconds(5));
+}
+
+TEST(SpillScheduler, ManyWorkersTakeEachPayloadOnce) {
+  constexpr int  kProducers = 4;
+  constexpr int  kWorkers   = 8;
+  constexpr int  kPayloads  = 2000;
+  SpillScheduler scheduler;
+
+  std::vector<PayloadID> ids(kPayloads);
+  for (auto& id : ids) id = NewId();
+
+  // Every producer offers every payload, as the tiering loop does tick after tick.
+  std::vector<std::thread> threads;
+  for (int p = 0; p < kProducers; ++p) {
+    threads.emplace_back([&, p] {
+      for (int i = 0; i < kPayloads; ++i) {
+        scheduler.Enqueue(Task(ids[(i + p * 37) % kPayloads], static_cast<SpillPriority>(i % payload::spill::kSpillPriorityCount)));
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  threads.clear();
+  EXPECT_EQ(scheduler.QueueDepth(), static_cast<std::size_t>(kPayloads));
+
+  std::atomic<bool>          running{true};
+  std::mutex                 taken_mutex;
+  std::multiset<std::string> taken;
+  std::atomic<int>           done{0};
+  for (int w = 0; w < kWorkers; ++w) {
+    threads.emplace_back([&] {
+      while (auto task = scheduler.Dequeue(running)) {
+        {
+          std::lock_guard lock(taken_mutex);
+          taken.insert(task->id.value());
+        }
+        scheduler.Complete(*task);
+        if (done.fetch_add(1) + 1 == kPayloads) scheduler.Shutdown();
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  EXPECT_EQ(taken.size(), static_cast<std::size_t>(kPayloads));
+  for (const auto& id : ids) EXPECT_EQ(taken.count(id.value()), 1u);
+  const auto stats = scheduler.GetStats();
+  EXPECT_EQ(stats.queued, static_cast<uint64_t>(kPayloads));
+  EXPECT_EQ(stats.coalesced, static_cast<uint64_t>((kProducers - 1) * kPayloads));
+  EXPECT_EQ(scheduler.QueueDepth(), 0u);
+}
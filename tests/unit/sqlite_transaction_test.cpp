@@ -23,6 +23,8 @@
       subsequent use of the connection succeeds.
     - Destructor after an exception-interrupted transaction rolls back and
       the connection is usable for a new transaction.
+    - RollbackToSavepoint() discards only the writes since Savepoint(), and
+      ReleaseSavepoint() keeps them; both leave the transaction usable.
 */
 
 #include <gtest/gtest.h>
@@ -120,3 +122,26 @@ TEST(SqliteTransaction, DestructorRollsBackAbortedTransaction) {
     tx2.Commit();
   }
 }
+
+TEST(SqliteTransaction, RollbackToSavepointKeepsEarlierWrites) {
+  auto db = MakeDB();
+  db->Exec("CREATE TABLE t5 (x INTEGER);");
+
+  {
+    SqliteTransaction tx(db);
+    db->Exec("INSERT INTO t5 VALUES (1);");
+    tx.Savepoint();
+    db->Exec("INSERT INTO t5 VALUES (2);");
+    tx.RollbackToSavepoint();
+    tx.Savepoint();
+    db->Exec("INSERT INTO t5 VALUES (3);");
+    tx.ReleaseSavepoint();
+    tx.Commit();
+  }
+
+  auto* stmt = db->Prepare("SELECT SUM(x) FROM t5;");
+  ASSERT_EQ(sqlite3_step(stmt), SQLITE_ROW);
+  const int sum = sqlite3_column_int(stmt, 0);
+  sqlite3_finalize(stmt);
+  EXPECT_EQ(sum, 4) << "only the rows outside the rolled-back savepoint must be committed";
+}
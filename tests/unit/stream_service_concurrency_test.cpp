@@ -69,6 +69,11 @@ class HookedRepository : public Repository {
     return inner_.ListExpiredPayloads(tx, now_ms);
   }
 
+  std::optional<payload::db::model::PayloadRecord> FindContentReference(Transaction& tx, const std::string& content_hash,
+                                                                         payload::manager::v1::Tier tier) override {
+    return inner_.FindContentReference(tx, content_hash, tier);
+  }
+
   Result UpsertMetadata(Transaction& tx, const payload::db::model::MetadataRecord& record) override {
     return inner_.UpsertMetadata(tx, record);
   }
@@ -16,6 +16,7 @@
 #include <vector>
 
 #include "internal/core/payload_manager.hpp"
+#include "internal/core/tier_counters.hpp"
 #include "internal/db/memory/memory_repository.hpp"
 #include "internal/lease/lease_manager.hpp"
 #include "internal/storage/storage_backend.hpp"
@@ -96,3 +97,37 @@ TEST(TierAccountingStress, BytesAndCountReturnToZeroAfterConcurrentAllocDelete)
   EXPECT_EQ(ram_bytes, 0u) << "RAM tier byte total must be zero after all Allocate/Delete pairs complete; "
                               "a non-zero value indicates an accounting leak or missed decrement.";
 }
+
+// Increments and decrements for the same payload may land on different CPU
+// stripes; only the summed totals must balance.
+TEST(TierAccountingStress, StripedCountersBalanceAcrossThreads) {
+  payload::core::TierCounters counters;
+
+  constexpr int            kThreads = 8;
+  constexpr int            kOps     = 10'000;
+  std::vector<std::thread> threads;
+  threads.reserve(kThreads);
+  for (int i = 0; i < kThreads; ++i) {
+    threads.emplace_back([&, i] {
+      for (int j = 0; j < kOps; ++j) {
+        counters.Add(TIER_RAM, 4096, 1);
+        if ((i + j) % 2 == 0) std::this_thread::yield();
+        counters.Add(TIER_RAM, -4096, -1);
+      }
+      counters.Add(payload::manager::v1::TIER_DISK, 100, 1);
+    });
+  }
+  for (auto& t : threads) t.join();
+
+  const auto totals = counters.Read();
+  EXPECT_EQ(totals.bytes[TIER_RAM], 0);
+  EXPECT_EQ(totals.count[TIER_RAM], 0);
+  EXPECT_EQ(counters.Bytes(payload::manager::v1::TIER_DISK), 100 * kThreads);
+  EXPECT_EQ(totals.count[payload::manager::v1::TIER_DISK], kThreads);
+
+  payload::core::TierCounters::Totals reset;
+  reset.bytes[TIER_RAM] = 7;
+  counters.Reset(reset);
+  EXPECT_EQ(counters.Bytes(TIER_RAM), 7);
+  EXPECT_EQ(counters.Bytes(payload::manager::v1::TIER_DISK), 0);
+}
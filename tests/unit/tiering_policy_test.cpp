@@ -3,6 +3,7 @@
 #include <gtest/gtest.h>
 
 #include <memory>
+#include <optional>
 
 #include "internal/metadata/metadata_cache.hpp"
 #include "internal/tiering/pressure_state.hpp"
@@ -137,3 +138,32 @@ TEST(TieringPolicy, RamPredicateRejectingAllYieldsNoVictim) {
   EXPECT_FALSE(policy.ChooseRamEviction(state).has_value());
   EXPECT_FALSE(policy.ChooseGpuEviction(state).has_value());
 }
+
+TEST(TieringPolicy, NodePressureEvictsFromThatNode) {
+  auto cache  = std::make_shared<MetadataCache>();
+  auto policy = TieringPolicy(cache);
+  policy.SetRamNodeSource([](const PayloadID& id) -> std::optional<uint32_t> { return id.value() == "payload-b" ? 1u : 0u; });
+
+  // payload-a is least recently used but lives on node 0.
+  PutMetadata(*cache, "payload-a");
+  PutMetadata(*cache, "payload-b");
+
+  PressureState state;
+  state.ram_limit = 1000;
+  state.ram_bytes.store(10);
+  state.ram_node_limit[0] = 100;
+  state.ram_node_limit[1] = 5;
+  state.ram_node_bytes[0].store(4);
+  state.ram_node_bytes[1].store(6);
+
+  const auto victim = policy.ChooseRamEviction(state);
+  ASSERT_TRUE(victim.has_value());
+  EXPECT_EQ(victim->value(), "payload-b");
+
+  // A pressured node with nothing to evict does not spill over to another node.
+  state.ram_node_limit[1] = 100;
+  state.ram_node_limit[2] = 1;
+  state.ram_node_bytes[2].store(2);
+  EXPECT_TRUE(state.RamPressure());
+  EXPECT_FALSE(policy.ChooseRamEviction(state).has_value());
+}